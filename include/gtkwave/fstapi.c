@@ -783,6 +783,7 @@ unsigned section_header_only : 1;
 unsigned flush_context_pending : 1;
 unsigned parallel_enabled : 1;
 unsigned parallel_was_enabled : 1;
+unsigned int compress_threads; /* value change blocks pack across this many threads */
 
 /* should really be semaphores, but are bytes to cut down on read-modify-write window size */
 unsigned char already_in_flush; /* in case control-c handlers interrupt */
@@ -1265,6 +1266,357 @@ if(xc)
 }
 
 
+/*
+ * value change block encoding, split out of fstWriterFlushContextPrivate()
+ * so that blocks can also be encoded and packed on several threads
+ */
+/*
+ * expand a packed value (most significant bit first in the first byte,
+ * as stored in a value change block) to len '0'/'1' characters
+ */
+static void fstWriterUnpackValue(unsigned char *dst, const unsigned char *packed, uint32_t len)
+{
+uint32_t i;
+
+for(i=0;i<len;i++)
+        {
+        dst[i] = '0' | ((packed[i >> 3] >> (7 - (i & 7))) & 1);
+        }
+}
+
+
+static unsigned char *fstWriterVchgBuild(struct fstWriterContext *xc, uint32_t *vm4ip, uint32_t offs, unsigned char *scratchpad, unsigned int *wrlenp)
+{
+unsigned char *vchg_mem = xc->vchg_mem;
+unsigned char *scratchpnt;
+uint32_t next_offs;
+unsigned int wrlen;
+
+        scratchpnt = scratchpad + xc->vchg_siz;         /* build this buffer backwards */
+        if(vm4ip[1] <= 1)
+                {
+                if(vm4ip[1] == 1)
+                        {
+                        wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
+#ifndef FST_REMOVE_DUPLICATE_VC
+                        xc->curval_mem[vm4ip[0]] = vchg_mem[offs + 4 + wrlen]; /* checkpoint variable */
+#endif
+                        while(offs)
+                                {
+                                unsigned char val;
+                                uint32_t time_delta, rcv;
+                                next_offs = fstGetUint32(vchg_mem + offs);
+                                offs += 4;
+
+                                time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+                                val = vchg_mem[offs+wrlen];
+                                offs = next_offs;
+
+                                switch(val)
+                                        {
+                                        case '0':
+                                        case '1':               rcv = ((val&1)<<1) | (time_delta<<2);
+                                                                break; /* pack more delta bits in for 0/1 vchs */
+
+                                        case 'x': case 'X':     rcv = FST_RCV_X | (time_delta<<4); break;
+                                        case 'z': case 'Z':     rcv = FST_RCV_Z | (time_delta<<4); break;
+                                        case 'h': case 'H':     rcv = FST_RCV_H | (time_delta<<4); break;
+                                        case 'u': case 'U':     rcv = FST_RCV_U | (time_delta<<4); break;
+                                        case 'w': case 'W':     rcv = FST_RCV_W | (time_delta<<4); break;
+                                        case 'l': case 'L':     rcv = FST_RCV_L | (time_delta<<4); break;
+                                        default:                rcv = FST_RCV_D | (time_delta<<4); break;
+                                        }
+
+                                scratchpnt = fstCopyVarint32ToLeft(scratchpnt, rcv);
+                                }
+                        }
+                        else
+                        {
+                        /* variable length */
+                        /* fstGetUint32 (next_offs) + fstGetVarint32 (time_delta) + fstGetVarint32 (len) + payload */
+                        unsigned char *pnt;
+                        uint32_t record_len;
+                        uint32_t time_delta;
+
+                        while(offs)
+                                {
+                                next_offs = fstGetUint32(vchg_mem + offs);
+                                offs += 4;
+                                pnt = vchg_mem + offs;
+                                offs = next_offs;
+                                time_delta = fstGetVarint32(pnt, (int *)&wrlen);
+                                pnt += wrlen;
+                                record_len = fstGetVarint32(pnt, (int *)&wrlen);
+                                pnt += wrlen;
+
+                                scratchpnt -= record_len;
+                                memcpy(scratchpnt, pnt, record_len);
+
+                                scratchpnt = fstCopyVarint32ToLeft(scratchpnt, record_len);
+                                scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1)); /* reserve | 1 case for future expansion */
+                                }
+                        }
+                }
+                else
+                {
+#ifndef FST_REMOVE_DUPLICATE_VC
+                if(fstGetVarint32(vchg_mem + offs + 4, (int *)&wrlen) & 1) /* checkpoint variable */
+                        {
+                        fstWriterUnpackValue(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]);
+                        }
+                        else
+                        {
+                        memcpy(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]);
+                        }
+#endif
+                while(offs)
+                        {
+                        unsigned int idx;
+                        char is_binary = 1;
+                        unsigned char *pnt;
+                        uint32_t time_delta;
+
+                        next_offs = fstGetUint32(vchg_mem + offs);
+                        offs += 4;
+
+                        time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+
+                        pnt = vchg_mem+offs+wrlen;
+                        offs = next_offs;
+
+                        if(time_delta & 1) /* already packed by fstWriterEmitValueChangePacked */
+                                {
+                                unsigned int plen = (vm4ip[1] + 7) / 8;
+                                scratchpnt -= plen;
+                                memcpy(scratchpnt, pnt, plen);
+
+                                scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta >> 1) << 1);
+                                continue;
+                                }
+                        time_delta >>= 1;
+
+                        for(idx=0;idx<vm4ip[1];idx++)
+                                {
+                                if((pnt[idx] == '0') || (pnt[idx] == '1'))
+                                        {
+                                        continue;
+                                        }
+                                        else
+                                        {
+                                        is_binary = 0;
+                                        break;
+                                        }
+                                }
+
+                        if(is_binary)
+                                {
+                                unsigned char acc = 0;
+                                /* new algorithm */
+                                idx = ((vm4ip[1]+7) & ~7);
+                                switch(vm4ip[1] & 7)
+                                        {
+                                        case 0: do {    acc  = (pnt[idx+7-8] & 1) << 0; /* fallthrough */
+                                        case 7:         acc |= (pnt[idx+6-8] & 1) << 1; /* fallthrough */
+                                        case 6:         acc |= (pnt[idx+5-8] & 1) << 2; /* fallthrough */
+                                        case 5:         acc |= (pnt[idx+4-8] & 1) << 3; /* fallthrough */
+                                        case 4:         acc |= (pnt[idx+3-8] & 1) << 4; /* fallthrough */
+                                        case 3:         acc |= (pnt[idx+2-8] & 1) << 5; /* fallthrough */
+                                        case 2:         acc |= (pnt[idx+1-8] & 1) << 6; /* fallthrough */
+                                        case 1:         acc |= (pnt[idx+0-8] & 1) << 7;
+                                                        *(--scratchpnt) = acc;
+                                                        idx -= 8;
+                                                } while(idx);
+                                        }
+
+                                scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1));
+                                }
+                                else
+                                {
+                                scratchpnt -= vm4ip[1];
+                                memcpy(scratchpnt, pnt, vm4ip[1]);
+
+                                scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1) | 1);
+                                }
+                        }
+                }
+
+
+*wrlenp = scratchpad + xc->vchg_siz - scratchpnt;
+return(scratchpnt);
+}
+
+
+/*
+ * pack an encoded value change block, returns the data to write and sets
+ * *prefixp to the uncompressed length, or to zero when stored uncompressed
+ */
+static unsigned char *fstWriterVchgPack(struct fstWriterContext *xc, unsigned char *scratchpnt, unsigned int wrlen,
+        unsigned char **packmemp, unsigned int *packmemlenp, unsigned int *prefixp, unsigned int *lenp)
+{
+*prefixp = 0;
+*lenp = wrlen;
+
+if(wrlen > 32)
+        {
+        unsigned long destlen = wrlen;
+        unsigned char *dmem;
+        unsigned int rc;
+
+        if(!xc->fastpack)
+                {
+                if(wrlen <= *packmemlenp)
+                        {
+                        dmem = *packmemp;
+                        }
+                        else
+                        {
+                        free(*packmemp);
+                        dmem = *packmemp = (unsigned char *)malloc(compressBound(*packmemlenp = wrlen));
+                        }
+
+                rc = compress2(dmem, &destlen, scratchpnt, wrlen, 4);
+                if(rc == Z_OK)
+                        {
+                        *prefixp = wrlen;
+                        *lenp = destlen;
+                        return(dmem);
+                        }
+                }
+                else
+                {
+                /* this is extremely conservative: fastlz needs +5% for worst case, lz4 needs siz+(siz/255)+16 */
+                if(((wrlen * 2) + 2) <= *packmemlenp)
+                        {
+                        dmem = *packmemp;
+                        }
+                        else
+                        {
+                        free(*packmemp);
+                        dmem = *packmemp = (unsigned char *)malloc(*packmemlenp = (wrlen * 2) + 2);
+                        }
+
+                rc = (xc->fourpack) ? LZ4_compress((char *)scratchpnt, (char *)dmem, wrlen) : fastlz_compress(scratchpnt, wrlen, dmem);
+                if(rc < destlen)
+                        {
+                        *prefixp = wrlen;
+                        *lenp = rc;
+                        return(dmem);
+                        }
+                }
+        }
+
+return(scratchpnt);
+}
+
+
+/*
+ * write a packed value change block, or alias it to an identical earlier one
+ */
+#ifndef FST_DYNAMIC_ALIAS_DISABLE
+#ifndef _WAVE_HAVE_JUDY
+static off_t fstWriterVchgEmit(FILE *f, Pvoid_t *PJHSArrayp, uint32_t hashmask, uint32_t *vm4ip, unsigned int i, unsigned int prefix, unsigned char *datap, unsigned int len)
+#else
+static off_t fstWriterVchgEmit(FILE *f, Pvoid_t *PJHSArrayp, uint32_t *vm4ip, unsigned int i, unsigned int prefix, unsigned char *datap, unsigned int len)
+#endif
+#else
+static off_t fstWriterVchgEmit(FILE *f, uint32_t *vm4ip, unsigned int i, unsigned int prefix, unsigned char *datap, unsigned int len)
+#endif
+{
+off_t fpos = 0;
+#ifndef FST_DYNAMIC_ALIAS_DISABLE
+PPvoid_t pv = JudyHSIns(PJHSArrayp, datap, len, NULL);
+if(*pv)
+        {
+        uint32_t pvi = (intptr_t)(*pv);
+        vm4ip[2] = -pvi;
+        }
+        else
+        {
+        *pv = (void *)(intptr_t)(i+1);
+#else
+(void)vm4ip; (void)i;
+#endif
+        fpos += fstWriterVarint(f, prefix);
+        fpos += len;
+        fstFwrite(datap, len, 1, f);
+#ifndef FST_DYNAMIC_ALIAS_DISABLE
+        }
+#endif
+return(fpos);
+}
+
+#ifndef FST_DYNAMIC_ALIAS_DISABLE
+#ifndef _WAVE_HAVE_JUDY
+#define FST_VCHG_EMIT(f, vm4ip, i, prefix, datap, len) fstWriterVchgEmit((f), &PJHSArray, hashmask, (vm4ip), (i), (prefix), (datap), (len))
+#else
+#define FST_VCHG_EMIT(f, vm4ip, i, prefix, datap, len) fstWriterVchgEmit((f), &PJHSArray, (vm4ip), (i), (prefix), (datap), (len))
+#endif
+#else
+#define FST_VCHG_EMIT(f, vm4ip, i, prefix, datap, len) fstWriterVchgEmit((f), (vm4ip), (i), (prefix), (datap), (len))
+#endif
+
+
+#ifdef FST_WRITER_PARALLEL
+/*
+ * a range of handles whose value change blocks are encoded and packed
+ * together on one thread; results are kept in an arena and written out
+ * in handle order afterwards, so the file is the same as when packed
+ * serially
+ */
+struct fstWriterVchgShard
+{
+struct fstWriterContext *xc;
+pthread_t thread;
+unsigned int first, last;
+unsigned char *arena;
+size_t arena_len, arena_siz;
+uint32_t *meta; /* per handle: prefix, arena offset, length */
+off_t unc_memreq;
+};
+
+
+static void *fstWriterVchgShardMain(void *ctx)
+{
+struct fstWriterVchgShard *sh = (struct fstWriterVchgShard *)ctx;
+struct fstWriterContext *xc = sh->xc;
+unsigned char *scratchpad = (unsigned char *)malloc(xc->vchg_siz);
+unsigned int packmemlen = 1024;
+unsigned char *packmem = (unsigned char *)malloc(packmemlen);
+unsigned int i;
+
+for(i=sh->first;i<sh->last;i++)
+        {
+        uint32_t *vm4ip = &(xc->valpos_mem[4*i]);
+        uint32_t *meta = &(sh->meta[3*(i-sh->first)]);
+
+        if(vm4ip[2])
+                {
+                unsigned int wrlen, prefix, len;
+                unsigned char *scratchpnt = fstWriterVchgBuild(xc, vm4ip, vm4ip[2], scratchpad, &wrlen);
+                unsigned char *datap = fstWriterVchgPack(xc, scratchpnt, wrlen, &packmem, &packmemlen, &prefix, &len);
+
+                sh->unc_memreq += wrlen;
+                if((sh->arena_len + len) > sh->arena_siz)
+                        {
+                        sh->arena_siz = (sh->arena_len + len) * 2;
+                        sh->arena = (unsigned char *)realloc(sh->arena, sh->arena_siz);
+                        }
+                memcpy(sh->arena + sh->arena_len, datap, len);
+                meta[0] = prefix;
+                meta[1] = sh->arena_len;
+                meta[2] = len;
+                sh->arena_len += len;
+                }
+        }
+
+free(packmem);
+free(scratchpad);
+return(NULL);
+}
+#endif
+
+
+
 /*
  * only to be called directly by fst code...otherwise must
  * be synced up with time changes
@@ -1279,7 +1631,6 @@ static void fstWriterFlushContextPrivate(void *ctx)
 int cnt = 0;
 #endif
 unsigned int i;
-unsigned char *vchg_mem;
 FILE *f;
 off_t fpos, indxpos, endpos;
 uint32_t prevpos;
@@ -1317,8 +1668,6 @@ xc->already_in_flush = 1; /* should really do this with a semaphore */
 xc->section_header_only = 0;
 scratchpad = (unsigned char *)malloc(xc->vchg_siz);
 
-vchg_mem = xc->vchg_mem;
-
 f = xc->handle;
 fstWriterVarint(f, xc->maxhandle);      /* emit current number of handles */
 fputc(xc->fourpack ? '4' : (xc->fastpack ? 'F' : 'Z'), f);
@@ -1327,287 +1676,71 @@ fpos = 1;
 packmemlen = 1024;                      /* maintain a running "longest" allocation to */
 packmem = (unsigned char *)malloc(packmemlen);           /* prevent continual malloc...free every loop iter */
 
-for(i=0;i<xc->maxhandle;i++)
+#ifdef FST_WRITER_PARALLEL
+if((xc->compress_threads > 1) && (xc->maxhandle >= (fstHandle)(xc->compress_threads * 64)))
         {
-        vm4ip = &(xc->valpos_mem[4*i]);
+        unsigned int nshards = xc->compress_threads;
+        unsigned int s;
+        struct fstWriterVchgShard *shards = (struct fstWriterVchgShard *)calloc(nshards, sizeof(struct fstWriterVchgShard));
 
-        if(vm4ip[2])
+        for(s=0;s<nshards;s++)
                 {
-                uint32_t offs = vm4ip[2];
-                uint32_t next_offs;
-                unsigned int wrlen;
-
-                vm4ip[2] = fpos;
+                shards[s].xc = xc;
+                shards[s].first = (unsigned int)(((uint64_t)xc->maxhandle * s) / nshards);
+                shards[s].last = (unsigned int)(((uint64_t)xc->maxhandle * (s+1)) / nshards);
+                shards[s].meta = (uint32_t *)calloc(3 * (shards[s].last - shards[s].first) + 1, sizeof(uint32_t));
+                }
+        for(s=1;s<nshards;s++)
+                {
+                pthread_create(&shards[s].thread, NULL, fstWriterVchgShardMain, &shards[s]);
+                }
+        fstWriterVchgShardMain(&shards[0]);
+        for(s=1;s<nshards;s++)
+                {
+                pthread_join(shards[s].thread, NULL);
+                }
 
-                scratchpnt = scratchpad + xc->vchg_siz;         /* build this buffer backwards */
-                if(vm4ip[1] <= 1)
+        for(s=0;s<nshards;s++)
+                {
+                for(i=shards[s].first;i<shards[s].last;i++)
                         {
-                        if(vm4ip[1] == 1)
-                                {
-                                wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
-#ifndef FST_REMOVE_DUPLICATE_VC
-                                xc->curval_mem[vm4ip[0]] = vchg_mem[offs + 4 + wrlen]; /* checkpoint variable */
-#endif
-                                while(offs)
-                                        {
-                                        unsigned char val;
-                                        uint32_t time_delta, rcv;
-                                        next_offs = fstGetUint32(vchg_mem + offs);
-                                        offs += 4;
-
-                                        time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
-                                        val = vchg_mem[offs+wrlen];
-                                        offs = next_offs;
+                        vm4ip = &(xc->valpos_mem[4*i]);
 
-                                        switch(val)
-                                                {
-                                                case '0':
-                                                case '1':               rcv = ((val&1)<<1) | (time_delta<<2);
-                                                                        break; /* pack more delta bits in for 0/1 vchs */
-
-                                                case 'x': case 'X':     rcv = FST_RCV_X | (time_delta<<4); break;
-                                                case 'z': case 'Z':     rcv = FST_RCV_Z | (time_delta<<4); break;
-                                                case 'h': case 'H':     rcv = FST_RCV_H | (time_delta<<4); break;
-                                                case 'u': case 'U':     rcv = FST_RCV_U | (time_delta<<4); break;
-                                                case 'w': case 'W':     rcv = FST_RCV_W | (time_delta<<4); break;
-                                                case 'l': case 'L':     rcv = FST_RCV_L | (time_delta<<4); break;
-                                                default:                rcv = FST_RCV_D | (time_delta<<4); break;
-                                                }
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, rcv);
-                                        }
-                                }
-                                else
+                        if(vm4ip[2])
                                 {
-                                /* variable length */
-                                /* fstGetUint32 (next_offs) + fstGetVarint32 (time_delta) + fstGetVarint32 (len) + payload */
-                                unsigned char *pnt;
-                                uint32_t record_len;
-                                uint32_t time_delta;
+                                uint32_t *meta = &(shards[s].meta[3*(i-shards[s].first)]);
 
-                                while(offs)
-                                        {
-                                        next_offs = fstGetUint32(vchg_mem + offs);
-                                        offs += 4;
-                                        pnt = vchg_mem + offs;
-                                        offs = next_offs;
-                                        time_delta = fstGetVarint32(pnt, (int *)&wrlen);
-                                        pnt += wrlen;
-                                        record_len = fstGetVarint32(pnt, (int *)&wrlen);
-                                        pnt += wrlen;
-
-                                        scratchpnt -= record_len;
-                                        memcpy(scratchpnt, pnt, record_len);
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, record_len);
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1)); /* reserve | 1 case for future expansion */
-                                        }
+                                vm4ip[2] = fpos;
+                                fpos += FST_VCHG_EMIT(f, vm4ip, i, meta[0], shards[s].arena + meta[1], meta[2]);
+#ifdef FST_DEBUG
+                                cnt++;
+#endif
                                 }
                         }
-                        else
-                        {
-                        wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
-#ifndef FST_REMOVE_DUPLICATE_VC
-                        memcpy(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]); /* checkpoint variable */
+                unc_memreq += shards[s].unc_memreq;
+                free(shards[s].arena);
+                free(shards[s].meta);
+                }
+        free(shards);
+        }
+        else
 #endif
-                        while(offs)
-                                {
-                                unsigned int idx;
-                                char is_binary = 1;
-                                unsigned char *pnt;
-                                uint32_t time_delta;
-
-                                next_offs = fstGetUint32(vchg_mem + offs);
-                                offs += 4;
-
-                                time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
-
-                                pnt = vchg_mem+offs+wrlen;
-                                offs = next_offs;
-
-                                for(idx=0;idx<vm4ip[1];idx++)
-                                        {
-                                        if((pnt[idx] == '0') || (pnt[idx] == '1'))
-                                                {
-                                                continue;
-                                                }
-                                                else
-                                                {
-                                                is_binary = 0;
-                                                break;
-                                                }
-                                        }
-
-                                if(is_binary)
-                                        {
-                                        unsigned char acc = 0;
-                                        /* new algorithm */
-                                        idx = ((vm4ip[1]+7) & ~7);
-                                        switch(vm4ip[1] & 7)
-                                                {
-                                                case 0: do {    acc  = (pnt[idx+7-8] & 1) << 0; /* fallthrough */
-                                                case 7:         acc |= (pnt[idx+6-8] & 1) << 1; /* fallthrough */
-                                                case 6:         acc |= (pnt[idx+5-8] & 1) << 2; /* fallthrough */
-                                                case 5:         acc |= (pnt[idx+4-8] & 1) << 3; /* fallthrough */
-                                                case 4:         acc |= (pnt[idx+3-8] & 1) << 4; /* fallthrough */
-                                                case 3:         acc |= (pnt[idx+2-8] & 1) << 5; /* fallthrough */
-                                                case 2:         acc |= (pnt[idx+1-8] & 1) << 6; /* fallthrough */
-                                                case 1:         acc |= (pnt[idx+0-8] & 1) << 7;
-                                                                *(--scratchpnt) = acc;
-                                                                idx -= 8;
-                                                        } while(idx);
-                                                }
+for(i=0;i<xc->maxhandle;i++)
+        {
+        vm4ip = &(xc->valpos_mem[4*i]);
 
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1));
-                                        }
-                                        else
-                                        {
-                                        scratchpnt -= vm4ip[1];
-                                        memcpy(scratchpnt, pnt, vm4ip[1]);
+        if(vm4ip[2])
+                {
+                uint32_t offs = vm4ip[2];
+                unsigned int wrlen, prefix, len;
+                unsigned char *datap;
 
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1) | 1);
-                                        }
-                                }
-                        }
+                vm4ip[2] = fpos;
 
-                wrlen = scratchpad + xc->vchg_siz - scratchpnt;
+                scratchpnt = fstWriterVchgBuild(xc, vm4ip, offs, scratchpad, &wrlen);
                 unc_memreq += wrlen;
-                if(wrlen > 32)
-                        {
-                        unsigned long destlen = wrlen;
-                        unsigned char *dmem;
-                        unsigned int rc;
-
-                        if(!xc->fastpack)
-                                {
-                                if(wrlen <= packmemlen)
-                                        {
-                                        dmem = packmem;
-                                        }
-                                        else
-                                        {
-                                        free(packmem);
-                                        dmem = packmem = (unsigned char *)malloc(compressBound(packmemlen = wrlen));
-                                        }
-
-                                rc = compress2(dmem, &destlen, scratchpnt, wrlen, 4);
-                                if(rc == Z_OK)
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, destlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, wrlen);
-                                                fpos += destlen;
-                                                fstFwrite(dmem, destlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                        else
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, 0);
-                                                fpos += wrlen;
-                                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                }
-                                else
-                                {
-                                /* this is extremely conservative: fastlz needs +5% for worst case, lz4 needs siz+(siz/255)+16 */
-                                if(((wrlen * 2) + 2) <= packmemlen)
-                                        {
-                                        dmem = packmem;
-                                        }
-                                        else
-                                        {
-                                        free(packmem);
-                                        dmem = packmem = (unsigned char *)malloc(packmemlen = (wrlen * 2) + 2);
-                                        }
-
-                                rc = (xc->fourpack) ? LZ4_compress((char *)scratchpnt, (char *)dmem, wrlen) : fastlz_compress(scratchpnt, wrlen, dmem);
-                                if(rc < destlen)
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, rc, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, wrlen);
-                                                fpos += rc;
-                                                fstFwrite(dmem, rc, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                        else
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, 0);
-                                                fpos += wrlen;
-                                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                }
-                        }
-                        else
-                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                        if(*pv)
-                                {
-                                uint32_t pvi = (intptr_t)(*pv);
-                                vm4ip[2] = -pvi;
-                                }
-                                else
-                                {
-                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                fpos += fstWriterVarint(f, 0);
-                                fpos += wrlen;
-                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                }
-#endif
-                        }
+                datap = fstWriterVchgPack(xc, scratchpnt, wrlen, &packmem, &packmemlen, &prefix, &len);
+                fpos += FST_VCHG_EMIT(f, vm4ip, i, prefix, datap, len);
 
                 /* vm4ip[3] = 0; ...redundant with clearing below */
 #ifdef FST_DEBUG
@@ -2548,6 +2681,23 @@ if(xc)
 }
 
 
+void fstWriterSetCompressThreads(void *ctx, int threads)
+{
+struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
+if(xc)
+        {
+        xc->compress_threads = (threads > 1) ? threads : 0;
+#ifndef FST_WRITER_PARALLEL
+        if(xc->compress_threads)
+                {
+                fprintf(stderr, FST_APIMESS "fstWriterSetCompressThreads(), FST_WRITER_PARALLEL not enabled during compile, exiting.\n");
+                exit(255);
+                }
+#endif
+        }
+}
+
+
 void fstWriterSetDumpSizeLimit(void *ctx, uint64_t numbytes)
 {
 struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
@@ -2997,7 +3147,8 @@ if(FST_LIKELY((xc) && (handle <= xc->maxhandle)))
                                 *(xc->curval_mem + offs) = *buf;
                                 }
 #endif
-                        xc->vchg_siz += fstWriterUint32WithVarint32(xc, &vm4ip[2], xc->tchn_idx - vm4ip[3], buf, len); /* do one fwrite op only */
+                        /* multi-bit time deltas are shifted left, bit 0 flags a packed value (see fstWriterEmitValueChangePacked) */
+                        xc->vchg_siz += fstWriterUint32WithVarint32(xc, &vm4ip[2], (len == 1) ? (xc->tchn_idx - vm4ip[3]) : ((xc->tchn_idx - vm4ip[3]) << 1), buf, len); /* do one fwrite op only */
                         vm4ip[3] = xc->tchn_idx;
                         vm4ip[2] = fpos;
                         }
@@ -3010,27 +3161,95 @@ if(FST_LIKELY((xc) && (handle <= xc->maxhandle)))
         }
 }
 
+/*
+ * emit a value already packed as in a value change block, most significant
+ * bit first in the first byte, saving fstWriterEmitValueChange converting
+ * the value to characters and fstWriterVchgBuild packing them back again
+ */
+static void fstWriterEmitValueChangePacked(void *ctx, fstHandle handle, uint32_t bits, const unsigned char *packed)
+{
+struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
+
+if(FST_LIKELY((xc) && (handle <= xc->maxhandle)))
+        {
+        uint32_t fpos;
+        uint32_t *vm4ip;
+        uint32_t len;
+
+        if(FST_UNLIKELY(!xc->valpos_mem))
+                {
+                xc->vc_emitted = 1;
+                fstWriterCreateMmaps(xc);
+                }
+
+        vm4ip = &(xc->valpos_mem[4*(handle-1)]);
+        len = vm4ip[1];
+#ifndef FST_REMOVE_DUPLICATE_VC
+        if(FST_LIKELY((len == bits) && (len > 1)))
+#else
+        if(0) /* duplicate removal compares values as characters */
+#endif
+                {
+                uint32_t plen = (len + 7) / 8;
+
+                if(FST_LIKELY(!xc->is_initial_time))
+                        {
+                        fpos = xc->vchg_siz;
+
+                        if(FST_UNLIKELY((fpos + plen + 10) > xc->vchg_alloc_siz))
+                                {
+                                xc->vchg_alloc_siz += (xc->fst_break_add_size + plen);
+                                xc->vchg_mem = (unsigned char *)realloc(xc->vchg_mem, xc->vchg_alloc_siz);
+                                if(FST_UNLIKELY(!xc->vchg_mem))
+                                        {
+                                        fprintf(stderr, FST_APIMESS "Could not realloc() in fstWriterEmitValueChangePacked, exiting.\n");
+                                        exit(255);
+                                        }
+                                }
+                        xc->vchg_siz += fstWriterUint32WithVarint32(xc, &vm4ip[2], ((xc->tchn_idx - vm4ip[3]) << 1) | 1, packed, plen);
+                        vm4ip[3] = xc->tchn_idx;
+                        vm4ip[2] = fpos;
+                        }
+                        else
+                        {
+                        fstWriterUnpackValue(xc->curval_mem + vm4ip[0], packed, len);
+                        }
+                }
+                else if(len)
+                {
+                /* single bits and mismatched widths go as characters */
+                unsigned char buf[64];
+                unsigned char *s = (bits <= sizeof(buf)) ? buf : (unsigned char *)malloc(bits);
+                fstWriterUnpackValue(s, packed, bits);
+                fstWriterEmitValueChange(ctx, handle, s);
+                if(s != buf) free(s);
+                }
+        }
+}
+
 void fstWriterEmitValueChange32(void *ctx, fstHandle handle,
                                 uint32_t bits, uint32_t val) {
-        char buf[32];
-        char *s = buf;
+        unsigned char buf[4];
+        uint32_t plen = (bits + 7) / 8;
         uint32_t i;
-        for (i = 0; i < bits; ++i)
+        val <<= (plen * 8 - bits) & 7;
+        for (i = 0; i < plen; ++i)
         {
-                *s++ = '0' + ((val >> (bits - i - 1)) & 1);
+                buf[i] = (unsigned char)(val >> (8 * (plen - 1 - i)));
         }
-        fstWriterEmitValueChange(ctx, handle, buf);
+        fstWriterEmitValueChangePacked(ctx, handle, bits, buf);
 }
 void fstWriterEmitValueChange64(void *ctx, fstHandle handle,
                                 uint32_t bits, uint64_t val) {
-        char buf[64];
-        char *s = buf;
+        unsigned char buf[8];
+        uint32_t plen = (bits + 7) / 8;
         uint32_t i;
-        for (i = 0; i < bits; ++i)
+        val <<= (plen * 8 - bits) & 7;
+        for (i = 0; i < plen; ++i)
         {
-                *s++ = '0' + ((val >> (bits - i - 1)) & 1);
+                buf[i] = (unsigned char)(val >> (8 * (plen - 1 - i)));
         }
-        fstWriterEmitValueChange(ctx, handle, buf);
+        fstWriterEmitValueChangePacked(ctx, handle, bits, buf);
 }
 void fstWriterEmitValueChangeVec32(void *ctx, fstHandle handle,
                                    uint32_t bits, const uint32_t *val) {
@@ -3041,15 +3260,11 @@ void fstWriterEmitValueChangeVec32(void *ctx, fstHandle handle,
         }
         else if(FST_LIKELY(xc))
         {
-                int bq = bits / 32;
-                int br = bits & 31;
-                int i;
-                int w;
-                uint32_t v;
-                unsigned char* s;
-                if (FST_UNLIKELY(bits > xc->outval_alloc_siz))
+                uint32_t plen = (bits + 7) / 8;
+                uint32_t i;
+                if (FST_UNLIKELY(plen > xc->outval_alloc_siz))
                 {
-                        xc->outval_alloc_siz = bits*2 + 1;
+                        xc->outval_alloc_siz = plen*2 + 1;
                         xc->outval_mem = (unsigned char*)realloc(xc->outval_mem, xc->outval_alloc_siz);
                         if (FST_UNLIKELY(!xc->outval_mem))
                         {
@@ -3058,27 +3273,25 @@ void fstWriterEmitValueChangeVec32(void *ctx, fstHandle handle,
                                 exit(255);
                         }
                 }
-                s = xc->outval_mem;
+                /* byte i holds value bits [pos+7:pos], where the last pos is negative if padded */
+                for (i = 0; i < plen; ++i)
                 {
-                        w = bq;
-                        v = val[w];
-                        for (i = 0; i < br; ++i)
+                        int pos = (int)bits - 8 * (int)(i + 1);
+                        uint32_t v;
+                        if (FST_LIKELY(pos >= 0))
                         {
-                                *s++ = '0' + ((v >> (br - i - 1)) & 1);
+                                uint32_t w = pos >> 5;
+                                uint32_t sh = pos & 31;
+                                v = val[w] >> sh;
+                                if (sh > 24) v |= val[w + 1] << (32 - sh);
                         }
-                }
-                for (w = bq - 1; w >= 0; --w)
-                {
-                        v = val[w];
-                        for (i = (32 - 4); i >= 0; i -= 4) {
-                                s[0] = '0' + ((v >> (i + 3)) & 1);
-                                s[1] = '0' + ((v >> (i + 2)) & 1);
-                                s[2] = '0' + ((v >> (i + 1)) & 1);
-                                s[3] = '0' + ((v >> (i + 0)) & 1);
-                                s += 4;
+                        else
+                        {
+                                v = val[0] << -pos;
                         }
+                        xc->outval_mem[i] = (unsigned char)v;
                 }
-                fstWriterEmitValueChange(ctx, handle, xc->outval_mem);
+                fstWriterEmitValueChangePacked(ctx, handle, bits, xc->outval_mem);
         }
 }
 void fstWriterEmitValueChangeVec64(void *ctx, fstHandle handle,
@@ -3090,15 +3303,11 @@ void fstWriterEmitValueChangeVec64(void *ctx, fstHandle handle,
         }
         else if(FST_LIKELY(xc))
         {
-                int bq = bits / 64;
-                int br = bits & 63;
-                int i;
-                int w;
-                uint32_t v;
-                unsigned char* s;
-                if (FST_UNLIKELY(bits > xc->outval_alloc_siz))
+                uint32_t plen = (bits + 7) / 8;
+                uint32_t i;
+                if (FST_UNLIKELY(plen > xc->outval_alloc_siz))
                 {
-                        xc->outval_alloc_siz = bits*2 + 1;
+                        xc->outval_alloc_siz = plen*2 + 1;
                         xc->outval_mem = (unsigned char*)realloc(xc->outval_mem, xc->outval_alloc_siz);
                         if (FST_UNLIKELY(!xc->outval_mem))
                         {
@@ -3107,27 +3316,25 @@ void fstWriterEmitValueChangeVec64(void *ctx, fstHandle handle,
                                 exit(255);
                         }
                 }
-                s = xc->outval_mem;
+                /* byte i holds value bits [pos+7:pos], where the last pos is negative if padded */
+                for (i = 0; i < plen; ++i)
                 {
-                        w = bq;
-                        v = val[w];
-                        for (i = 0; i < br; ++i)
+                        int pos = (int)bits - 8 * (int)(i + 1);
+                        uint64_t v;
+                        if (FST_LIKELY(pos >= 0))
                         {
-                                *s++ = '0' + ((v >> (br - i - 1)) & 1);
+                                uint32_t w = pos >> 6;
+                                uint32_t sh = pos & 63;
+                                v = val[w] >> sh;
+                                if (sh > 56) v |= val[w + 1] << (64 - sh);
                         }
-                }
-                for (w = bq - 1; w >= 0; --w) {
-                        v = val[w];
-                        for (i = (64 - 4); i >= 0; i -= 4)
+                        else
                         {
-                                s[0] = '0' + ((v >> (i + 3)) & 1);
-                                s[1] = '0' + ((v >> (i + 2)) & 1);
-                                s[2] = '0' + ((v >> (i + 1)) & 1);
-                                s[3] = '0' + ((v >> (i + 0)) & 1);
-                                s += 4;
+                                v = val[0] << -pos;
                         }
+                        xc->outval_mem[i] = (unsigned char)v;
                 }
-                fstWriterEmitValueChange(ctx, handle, xc->outval_mem);
+                fstWriterEmitValueChangePacked(ctx, handle, bits, xc->outval_mem);
         }
 }
 
@@ -374,6 +374,7 @@ void            fstWriterSetAttrBegin(void *ctx, enum fstAttrType attrtype, int
                         const char *attrname, uint64_t arg);
 void            fstWriterSetAttrEnd(void *ctx);
 void            fstWriterSetComment(void *ctx, const char *comm);
+void            fstWriterSetCompressThreads(void *ctx, int threads);
 void            fstWriterSetDate(void *ctx, const char *dat);
 void            fstWriterSetDumpSizeLimit(void *ctx, uint64_t numbytes);
 void            fstWriterSetEnvVar(void *ctx, const char *envvar);
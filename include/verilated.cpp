@@ -36,10 +36,27 @@
 // clang-format off
 #if defined(_WIN32) || defined(__MINGW32__)
 # include <direct.h>  // mkdir
+#else
+# include <csignal>  // snapshot
+# include <fcntl.h>  // snapshot
+# include <sys/wait.h>  // snapshot
+# include <unistd.h>  // snapshot
+#endif
+#if !defined(_WIN32) || defined(__CYGWIN__)
+# include <sys/mman.h>
+# define VL_HAVE_MMAP 1  // $readmem files and sparse arrays are mapped
+#endif
+#if defined(__linux__) && defined(VL_HAVE_MMAP) && defined(MREMAP_FIXED)
+# define VL_SPARSE_LAZY 1  // Sparse arrays are randomized as each page is first touched
+#endif
+#ifdef VL_THREADED
+# include <atomic>
+# include <thread>
 #endif
 // clang-format on
 
 #define VL_VALUE_STRING_MAX_WIDTH 8192  ///< Max static char array for VL_VALUE_STRING
+#define VL_READMEM_PARALLEL_BYTES (64 * 1024 * 1024)  ///< Min $readmem file to parse in parallel
 
 //===========================================================================
 // Static sanity checks (when get C++11 can use static_assert)
@@ -225,12 +242,19 @@ void VL_PRINTF_MT(const char* formatp, ...) VL_MT_SAFE {
     va_start(ap, formatp);
     std::string out = _vl_string_vprintf(formatp, ap);
     va_end(ap);
-    VerilatedThreadMsgQueue::post(VerilatedMsg([=]() {  //
-        VL_PRINTF("%s", out.c_str());
-    }));
+    VerilatedThreadMsgQueue::postPrint(out);
 }
 #endif
 
+// Print already formatted output; as VL_PRINTF_MT("%s", ...) but without reformatting
+static void _vl_puts_mt(const std::string& out) VL_MT_SAFE {
+#ifdef VL_THREADED
+    VerilatedThreadMsgQueue::postPrint(out);
+#else
+    VL_PRINTF("%s", out.c_str());
+#endif
+}
+
 //===========================================================================
 // Overall class init
 
@@ -251,13 +275,41 @@ Verilated::Serialized::Serialized() {
 Verilated::NonSerialized::NonSerialized() {
     s_profThreadsStart = 1;
     s_profThreadsWindow = 2;
+    s_profThreadsSample = 0;
+    s_profThreadsDumpReq = false;
+    s_profThreadsCounters = false;
+    s_threadsWait = 1;
     s_profThreadsFilenamep = strdup("profile_threads.dat");
+    s_profBlocksFilenamep = strdup("profile_blocks.dat");
+    s_profEvalFilenamep = strdup("profile_eval.dat");
+    s_evalStatsp = NULL;
+    s_liveStatsp = NULL;
+    s_profLiveFilenamep = strdup("profile_live.dat");
+    s_profBranchesFilenamep = strdup("profile_branches.dat");
+    s_threadsAffinityp = NULL;
 }
 Verilated::NonSerialized::~NonSerialized() {
     if (s_profThreadsFilenamep) {
         VL_DO_CLEAR(free(const_cast<char*>(s_profThreadsFilenamep)),
                     s_profThreadsFilenamep = NULL);
     }
+    if (s_profBlocksFilenamep) {
+        VL_DO_CLEAR(free(const_cast<char*>(s_profBlocksFilenamep)),
+                    s_profBlocksFilenamep = NULL);
+    }
+    if (s_profEvalFilenamep) {
+        VL_DO_CLEAR(free(const_cast<char*>(s_profEvalFilenamep)), s_profEvalFilenamep = NULL);
+    }
+    if (s_profLiveFilenamep) {
+        VL_DO_CLEAR(free(const_cast<char*>(s_profLiveFilenamep)), s_profLiveFilenamep = NULL);
+    }
+    if (s_profBranchesFilenamep) {
+        VL_DO_CLEAR(free(const_cast<char*>(s_profBranchesFilenamep)),
+                    s_profBranchesFilenamep = NULL);
+    }
+    if (s_threadsAffinityp) {
+        VL_DO_CLEAR(free(const_cast<char*>(s_threadsAffinityp)), s_threadsAffinityp = NULL);
+    }
 }
 
 size_t Verilated::serialized2Size() VL_PURE { return sizeof(VerilatedImp::s_s.m_ser); }
@@ -277,39 +329,89 @@ static vluint32_t vl_sys_rand32() VL_MT_UNSAFE {
 #endif
 }
 
-vluint64_t vl_rand64() VL_MT_SAFE {
+static inline vluint64_t vl_rand_rotl(vluint64_t x, int k) VL_PURE {
+    return (x << k) | (x >> (64 - k));
+}
+
+static vluint64_t vl_rand_splitmix64(vluint64_t& xr) {
+    // SplitMix64, spreads a seed across the generator's state
+    xr += VL_ULL(0x9e3779b97f4a7c15);
+    vluint64_t z = xr;
+    z = (z ^ (z >> 30)) * VL_ULL(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * VL_ULL(0x94d049bb133111eb);
+    return z ^ (z >> 31);
+}
+
+// Each thread has its own generator, so threads never contend.  With a
+// +verilator+seed each thread pool worker's stream depends only on the
+// seed and the worker's index, so runs are repeatable.
+static VL_THREAD_LOCAL struct {
+    bool m_seeded;
+    vluint64_t m_state[4];
+} t_rand = {false, {0, 0, 0, 0}};
+
+static void vl_rand_seed() VL_MT_SAFE {
     static VerilatedMutex s_mutex;
-    static VL_THREAD_LOCAL bool t_seeded = false;
-    static VL_THREAD_LOCAL vluint64_t t_state[2];
-    if (VL_UNLIKELY(!t_seeded)) {
-        t_seeded = true;
-        {
-            VerilatedLockGuard lock(s_mutex);
-            if (Verilated::randSeed() != 0) {
-                t_state[0] = ((static_cast<vluint64_t>(Verilated::randSeed()) << 32)
-                              ^ (static_cast<vluint64_t>(Verilated::randSeed())));
-                t_state[1] = ((static_cast<vluint64_t>(Verilated::randSeed()) << 32)
-                              ^ (static_cast<vluint64_t>(Verilated::randSeed())));
-            } else {
-                t_state[0] = ((static_cast<vluint64_t>(vl_sys_rand32()) << 32)
-                              ^ (static_cast<vluint64_t>(vl_sys_rand32())));
-                t_state[1] = ((static_cast<vluint64_t>(vl_sys_rand32()) << 32)
-                              ^ (static_cast<vluint64_t>(vl_sys_rand32())));
-            }
-            // Fix state as algorithm is slow to randomize if many zeros
-            // This causes a loss of ~ 1 bit of seed entropy, no big deal
-            if (VL_COUNTONES_I(t_state[0]) < 10) t_state[0] = ~t_state[0];
-            if (VL_COUNTONES_I(t_state[1]) < 10) t_state[1] = ~t_state[1];
+    static vluint32_t s_otherThreads = 0;  // Threads seeded that are not pool workers
+    vluint64_t stream = 0;
+    vluint64_t x;
+    {
+        VerilatedLockGuard lock(s_mutex);
+#ifdef VL_THREADED
+        stream = Verilated::threadSlot();
+#endif
+        // The first other thread, normally the one calling eval, is stream 0;
+        // with a VerilatedContext, the thread evaluating its model is
+        if (!stream && !Verilated::threadContextp() && s_otherThreads++) {
+            stream = (VL_ULL(1) << 32) + s_otherThreads;
+        }
+        if (Verilated::randSeed() != 0) {
+            x = static_cast<vluint64_t>(static_cast<vluint32_t>(Verilated::randSeed()));
+        } else {
+            x = ((static_cast<vluint64_t>(vl_sys_rand32()) << 32)
+                 ^ (static_cast<vluint64_t>(vl_sys_rand32())));
         }
     }
-    // Xoroshiro128+ algorithm
-    vluint64_t result = t_state[0] + t_state[1];
-    t_state[1] ^= t_state[0];
-    t_state[0] = (((t_state[0] << 55) | (t_state[0] >> 9)) ^ t_state[1] ^ (t_state[1] << 14));
-    t_state[1] = (t_state[1] << 36) | (t_state[1] >> 28);
+    x ^= stream * VL_ULL(0xd1b54a32d192ed03);
+    for (int i = 0; i < 4; ++i) t_rand.m_state[i] = vl_rand_splitmix64(x);
+    t_rand.m_seeded = true;
+}
+
+static inline vluint64_t vl_rand_next(vluint64_t* s) VL_MT_SAFE {
+    // Xoshiro256** algorithm
+    const vluint64_t result = vl_rand_rotl(s[1] * 5, 7) * 9;
+    const vluint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = vl_rand_rotl(s[3], 45);
     return result;
 }
 
+vluint64_t vl_rand64() VL_MT_SAFE {
+    if (VL_UNLIKELY(!t_rand.m_seeded)) vl_rand_seed();
+    return vl_rand_next(t_rand.m_state);
+}
+
+static void vl_rand_fill(vluint8_t* bytep, size_t bytes) VL_MT_SAFE {
+    if (VL_UNLIKELY(!t_rand.m_seeded)) vl_rand_seed();
+    // Work on a copy of the state, so it stays in registers
+    vluint64_t s[4] = {t_rand.m_state[0], t_rand.m_state[1], t_rand.m_state[2],
+                       t_rand.m_state[3]};
+    size_t i = 0;
+    for (; i + sizeof(vluint64_t) <= bytes; i += sizeof(vluint64_t)) {
+        const vluint64_t rand = vl_rand_next(s);
+        memcpy(bytep + i, &rand, sizeof(rand));
+    }
+    if (i < bytes) {
+        const vluint64_t rand = vl_rand_next(s);
+        memcpy(bytep + i, &rand, bytes - i);
+    }
+    for (int w = 0; w < 4; ++w) t_rand.m_state[w] = s[w];
+}
+
 IData VL_RANDOM_I(int obits) VL_MT_SAFE { return vl_rand64() & VL_MASK_I(obits); }
 QData VL_RANDOM_Q(int obits) VL_MT_SAFE { return vl_rand64() & VL_MASK_Q(obits); }
 // VL_RANDOM_W currently unused as $random always 32 bits
@@ -325,33 +427,64 @@ WDataOutP VL_RANDOM_W(int obits, WDataOutP outwp) VL_MT_SAFE {
 }
 
 IData VL_RAND_RESET_I(int obits) VL_MT_SAFE {
-    if (Verilated::randReset() == 0) return 0;
+    const int mode = Verilated::randReset();
+    if (mode == 0) return 0;
     IData data = ~0;
-    if (Verilated::randReset() != 1) {  // if 2, randomize
-        data = VL_RANDOM_I(obits);
+    if (mode != 1) {  // if 2, randomize
+        data = static_cast<IData>(vl_rand64());
     }
     data &= VL_MASK_I(obits);
     return data;
 }
 QData VL_RAND_RESET_Q(int obits) VL_MT_SAFE {
-    if (Verilated::randReset() == 0) return 0;
+    const int mode = Verilated::randReset();
+    if (mode == 0) return 0;
     QData data = VL_ULL(~0);
-    if (Verilated::randReset() != 1) {  // if 2, randomize
-        data = VL_RANDOM_Q(obits);
+    if (mode != 1) {  // if 2, randomize
+        data = vl_rand64();
     }
     data &= VL_MASK_Q(obits);
     return data;
 }
 WDataOutP VL_RAND_RESET_W(int obits, WDataOutP outwp) VL_MT_SAFE {
-    for (int i = 0; i < VL_WORDS_I(obits); ++i) {
-        if (i < (VL_WORDS_I(obits) - 1)) {
-            outwp[i] = VL_RAND_RESET_I(32);
-        } else {
-            outwp[i] = VL_RAND_RESET_I(32) & VL_MASK_E(obits);
-        }
-    }
+    VL_RAND_RESET_N(obits, 1, outwp);
     return outwp;
 }
+void VL_RAND_RESET_N(int obits, size_t rows, void* datap) VL_MT_SAFE {
+    const size_t rowBytes = (obits <= 8 ? sizeof(CData)
+                             : obits <= 16 ? sizeof(SData)
+                             : obits <= VL_IDATASIZE ? sizeof(IData)
+                             : obits <= VL_QUADSIZE ? sizeof(QData)
+                             : VL_WORDS_I(obits) * sizeof(EData));
+    const size_t bytes = rowBytes * rows;
+    vluint8_t* bytep = static_cast<vluint8_t*>(datap);
+    if (Verilated::randReset() == 0) {
+        memset(bytep, 0, bytes);
+        return;
+    } else if (Verilated::randReset() == 1) {
+        memset(bytep, 0xff, bytes);
+    } else {  // if 2, randomize, using all 64 bits of each random number
+        vl_rand_fill(bytep, bytes);
+    }
+    // Clear the bits above obits in each row
+    if (obits <= 8) {
+        CData* rowp = static_cast<CData*>(datap);
+        for (size_t r = 0; r < rows; ++r) rowp[r] &= VL_MASK_I(obits);
+    } else if (obits <= 16) {
+        SData* rowp = static_cast<SData*>(datap);
+        for (size_t r = 0; r < rows; ++r) rowp[r] &= VL_MASK_I(obits);
+    } else if (obits <= VL_IDATASIZE) {
+        IData* rowp = static_cast<IData*>(datap);
+        for (size_t r = 0; r < rows; ++r) rowp[r] &= VL_MASK_I(obits);
+    } else if (obits <= VL_QUADSIZE) {
+        QData* rowp = static_cast<QData*>(datap);
+        for (size_t r = 0; r < rows; ++r) rowp[r] &= VL_MASK_Q(obits);
+    } else {
+        EData* wordp = static_cast<EData*>(datap);
+        const int words = VL_WORDS_I(obits);
+        for (size_t r = 0; r < rows; ++r) wordp[r * words + words - 1] &= VL_MASK_E(obits);
+    }
+}
 
 WDataOutP VL_ZERO_RESET_W(int obits, WDataOutP outwp) VL_MT_SAFE {
     for (int i = 0; i < VL_WORDS_I(obits); ++i) outwp[i] = 0;
@@ -370,6 +503,178 @@ void _VL_DEBUG_PRINT_W(int lbits, WDataInP iwp) VL_MT_SAFE {
 //===========================================================================
 // Slow math
 
+#ifdef VL_HAVE_LIMB64
+static WDataOutP _vl_moddiv_limb64(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp,
+                                   bool is_modulus) VL_MT_SAFE {
+    // Knuth Algorithm D as in _vl_moddiv_w, on 64-bit limbs with 128-bit
+    // intermediates; requires the divisor to have at least two limbs.
+    // owp is already zero.
+    int limbs = (words + 1) / 2;
+    int m = limbs;  // Dividend limbs
+    while (!_VL_LIMB64_LD(words, lwp, m - 1)) --m;
+    int n = limbs;  // Divisor limbs
+    while (!_VL_LIMB64_LD(words, rwp, n - 1)) --n;
+    if (m < n) {  // Divisor larger than dividend
+        if (is_modulus) {
+            for (int i = 0; i < words; ++i) owp[i] = lwp[i];
+        }
+        return owp;
+    }
+
+    static VL_THREAD_LOCAL std::vector<vluint64_t> t_un;
+    static VL_THREAD_LOCAL std::vector<vluint64_t> t_vn;
+    t_un.resize(m + 1);
+    t_vn.resize(n);
+    vluint64_t* un = &t_un[0];
+    vluint64_t* vn = &t_vn[0];
+
+    // Normalize so the divisor MSB is set
+    int s = __builtin_clzll(_VL_LIMB64_LD(words, rwp, n - 1));  // Nonzero, checked above
+    for (int i = n - 1; i > 0; --i) {
+        QData v = _VL_LIMB64_LD(words, rwp, i);
+        vn[i] = s ? ((v << s) | (_VL_LIMB64_LD(words, rwp, i - 1) >> (64 - s))) : v;
+    }
+    vn[0] = _VL_LIMB64_LD(words, rwp, 0) << s;
+    un[m] = s ? (_VL_LIMB64_LD(words, lwp, m - 1) >> (64 - s)) : 0;
+    for (int i = m - 1; i > 0; --i) {
+        QData u = _VL_LIMB64_LD(words, lwp, i);
+        un[i] = s ? ((u << s) | (_VL_LIMB64_LD(words, lwp, i - 1) >> (64 - s))) : u;
+    }
+    un[0] = _VL_LIMB64_LD(words, lwp, 0) << s;
+
+    const vluint128_t base = static_cast<vluint128_t>(1) << 64;
+    for (int j = m - n; j >= 0; --j) {
+        // Estimate
+        vluint128_t unw128 = (static_cast<vluint128_t>(un[j + n]) << 64) | un[j + n - 1];
+        vluint128_t qhat = unw128 / vn[n - 1];
+        vluint128_t rhat = unw128 - qhat * vn[n - 1];
+        while (qhat >= base || (qhat * vn[n - 2]) > ((rhat << 64) | un[j + n - 2])) {
+            --qhat;
+            rhat += vn[n - 1];
+            if (rhat >= base) break;
+        }
+        // Multiply and subtract
+        vluint64_t carry = 0;
+        vluint64_t borrow = 0;
+        for (int i = 0; i < n; ++i) {
+            vluint128_t p = qhat * vn[i] + carry;
+            carry = static_cast<vluint64_t>(p >> 64);
+            vluint128_t t = static_cast<vluint128_t>(un[i + j]) - static_cast<vluint64_t>(p)
+                            - borrow;
+            un[i + j] = static_cast<vluint64_t>(t);
+            borrow = static_cast<vluint64_t>(t >> 64) ? 1 : 0;
+        }
+        vluint128_t t = static_cast<vluint128_t>(un[j + n]) - carry - borrow;
+        un[j + n] = static_cast<vluint64_t>(t);
+        vluint64_t q = static_cast<vluint64_t>(qhat);
+        if (static_cast<vluint64_t>(t >> 64)) {
+            // Over subtracted; correct by adding back
+            --q;
+            vluint64_t k = 0;
+            for (int i = 0; i < n; ++i) {
+                vluint128_t sum = static_cast<vluint128_t>(un[i + j]) + vn[i] + k;
+                un[i + j] = static_cast<vluint64_t>(sum);
+                k = static_cast<vluint64_t>(sum >> 64);
+            }
+            un[j + n] += k;
+        }
+        if (!is_modulus) _VL_LIMB64_ST(words, owp, j, q);  // Save quotient digit
+    }
+
+    if (is_modulus) {
+        // Need to reverse normalization on copy to output
+        for (int i = 0; i < n; ++i) {
+            _VL_LIMB64_ST(words, owp, i, s ? ((un[i] >> s) | (un[i + 1] << (64 - s))) : un[i]);
+        }
+    }
+    return owp;
+}
+
+// Internal usage: a[n] * b[n] into r[2n], with scratch t
+static void _vl_mul_school64(vluint64_t* rp, const vluint64_t* ap, const vluint64_t* bp,
+                             int n) VL_MT_SAFE {
+    for (int i = 0; i < 2 * n; ++i) rp[i] = 0;
+    for (int i = 0; i < n; ++i) {
+        vluint64_t carry = 0;
+        for (int j = 0; j < n; ++j) {
+            vluint128_t mul = static_cast<vluint128_t>(ap[i]) * bp[j] + rp[i + j] + carry;
+            rp[i + j] = static_cast<vluint64_t>(mul);
+            carry = static_cast<vluint64_t>(mul >> 64);
+        }
+        rp[i + n] = carry;
+    }
+}
+static void _vl_mul_kara64(vluint64_t* rp, const vluint64_t* ap, const vluint64_t* bp, int n,
+                           vluint64_t* tp) VL_MT_SAFE {
+    if (n < VL_MUL_KARATSUBA_LIMBS) {
+        _vl_mul_school64(rp, ap, bp, n);
+        return;
+    }
+    // a = a1*B^lo + a0, so a*b = z2*B^2lo + ((a0+a1)(b0+b1) - z2 - z0)*B^lo + z0
+    int lo = n / 2;
+    int hi = n - lo;
+    _vl_mul_kara64(rp, ap, bp, lo, tp);  // z0
+    _vl_mul_kara64(rp + 2 * lo, ap + lo, bp + lo, hi, tp);  // z2
+    vluint64_t* sap = tp;
+    vluint64_t* sbp = sap + hi + 1;
+    vluint64_t* z1p = sbp + hi + 1;
+    vluint64_t ca = 0;
+    vluint64_t cb = 0;
+    for (int i = 0; i < hi; ++i) {
+        vluint128_t suma = static_cast<vluint128_t>(ap[lo + i]) + (i < lo ? ap[i] : 0) + ca;
+        sap[i] = static_cast<vluint64_t>(suma);
+        ca = static_cast<vluint64_t>(suma >> 64);
+        vluint128_t sumb = static_cast<vluint128_t>(bp[lo + i]) + (i < lo ? bp[i] : 0) + cb;
+        sbp[i] = static_cast<vluint64_t>(sumb);
+        cb = static_cast<vluint64_t>(sumb >> 64);
+    }
+    sap[hi] = ca;
+    sbp[hi] = cb;
+    int z1limbs = 2 * (hi + 1);
+    _vl_mul_kara64(z1p, sap, sbp, hi + 1, z1p + z1limbs);
+    // z1 -= z0, z1 -= z2
+    vluint64_t borrow0 = 0;
+    vluint64_t borrow2 = 0;
+    for (int i = 0; i < z1limbs; ++i) {
+        vluint128_t t = static_cast<vluint128_t>(z1p[i]) - (i < 2 * lo ? rp[i] : 0) - borrow0;
+        borrow0 = static_cast<vluint64_t>(t >> 64) ? 1 : 0;
+        t = static_cast<vluint128_t>(static_cast<vluint64_t>(t))
+            - (i < 2 * hi ? rp[2 * lo + i] : 0) - borrow2;
+        borrow2 = static_cast<vluint64_t>(t >> 64) ? 1 : 0;
+        z1p[i] = static_cast<vluint64_t>(t);
+    }
+    // Middle term fits in the product, so carry out of the top is zero
+    vluint64_t carry = 0;
+    for (int i = 0; lo + i < 2 * n; ++i) {
+        vluint128_t sum
+            = static_cast<vluint128_t>(rp[lo + i]) + (i < z1limbs ? z1p[i] : 0) + carry;
+        rp[lo + i] = static_cast<vluint64_t>(sum);
+        carry = static_cast<vluint64_t>(sum >> 64);
+        if (i >= z1limbs && !carry) break;
+    }
+}
+
+WDataOutP _vl_mul_karatsuba_w(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp,
+                              int limbs) VL_MT_SAFE {
+    // Multiply the low limbs of each operand (higher limbs must be zero)
+    // into owp, truncated to words.  owp is already zero.
+    static VL_THREAD_LOCAL std::vector<vluint64_t> t_buf;
+    t_buf.resize(12 * limbs + 64);
+    vluint64_t* ap = &t_buf[0];
+    vluint64_t* bp = ap + limbs;
+    vluint64_t* rp = bp + limbs;
+    vluint64_t* tp = rp + 2 * limbs;  // Recursion scratch, under 8*limbs+64
+    int wlimbs = (words + 1) / 2;
+    for (int i = 0; i < limbs; ++i) {
+        ap[i] = _VL_LIMB64_LD(words, lwp, i);
+        bp[i] = _VL_LIMB64_LD(words, rwp, i);
+    }
+    _vl_mul_kara64(rp, ap, bp, limbs, tp);
+    for (int i = 0; i < wlimbs && i < 2 * limbs; ++i) _VL_LIMB64_ST(words, owp, i, rp[i]);
+    return owp;
+}
+#endif
+
 WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp,
                        bool is_modulus) VL_MT_SAFE {
     // See Knuth Algorithm D.  Computes u/v = q.r
@@ -403,13 +708,19 @@ WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp,
         return owp;
     }
 
-    // +1 word as we may shift during normalization
-    vluint32_t un[VL_MULS_MAX_WORDS + 1];  // Fixed size, as MSVC++ doesn't allow [words] here
-    vluint32_t vn[VL_MULS_MAX_WORDS + 1];  // v normalized
+#ifdef VL_HAVE_LIMB64
+    if (vmsbp1 > VL_QUADSIZE) return _vl_moddiv_limb64(words, owp, lwp, rwp, is_modulus);
+#endif
 
+    // +1 word as we may shift during normalization
     // Zero for ease of debugging and to save having to zero for shifts
     // Note +1 as loop will use extra word
-    for (int i = 0; i < words + 1; ++i) { un[i] = vn[i] = 0; }
+    static VL_THREAD_LOCAL std::vector<vluint32_t> t_un;
+    static VL_THREAD_LOCAL std::vector<vluint32_t> t_vn;  // v normalized
+    t_un.assign(words + 1, 0);
+    t_vn.assign(words + 1, 0);
+    vluint32_t* un = &t_un[0];
+    vluint32_t* vn = &t_vn[0];
 
     // Algorithm requires divisor MSB to be set
     // Copy and shift to normalize divisor so MSB of vn[vw-1] is set
@@ -580,8 +891,8 @@ QData VL_POWSS_QQW(int obits, int, int rbits, QData lhs, WDataInP rwp, bool lsig
 //===========================================================================
 // Formatting
 
-/// Output a string representation of a wide number
-std::string VL_DECIMAL_NW(int width, WDataInP lwp) VL_MT_SAFE {
+// Write decimal digits of a wide number ending just before endp, returning the first digit
+static char* _vl_vsformat_decimal_w(char* endp, int width, WDataInP lwp) VL_MT_SAFE {
     int maxdecwidth = (width + 3) * 4 / 3;
     // Or (maxdecwidth+7)/8], but can't have more than 4 BCD bits per word
     WData bcd[VL_VALUE_STRING_MAX_WIDTH / 4 + 2];
@@ -608,20 +919,38 @@ std::string VL_DECIMAL_NW(int width, WDataInP lwp) VL_MT_SAFE {
         // bcd[0] = lwp[from_bit]
         if (VL_BITISSET_W(lwp, from_bit)) bcd[0] |= 1;
     }
-    std::string output;
     int lsb = (maxdecwidth - 1) & ~3;
     for (; lsb > 0; lsb -= 4) {  // Skip leading zeros
         if (VL_BITRSHIFT_W(bcd, lsb) & 0xf) break;
     }
-    for (; lsb >= 0; lsb -= 4) {
-        output += ('0' + (VL_BITRSHIFT_W(bcd, lsb) & 0xf));  // 0..9
+    char* digitsp = endp - (lsb / 4 + 1);
+    for (char* destp = digitsp; lsb >= 0; lsb -= 4) {
+        *destp++ = static_cast<char>('0' + (VL_BITRSHIFT_W(bcd, lsb) & 0xf));  // 0..9
     }
-    return output;
+    return digitsp;
 }
 
-std::string _vl_vsformat_time(char* tmp, double ld, bool left, size_t width) {
+/// Output a string representation of a wide number
+std::string VL_DECIMAL_NW(int width, WDataInP lwp) VL_MT_SAFE {
+    char digits[VL_VALUE_STRING_MAX_WIDTH / 2];
+    char* endp = digits + sizeof(digits);
+    char* digitsp = _vl_vsformat_decimal_w(endp, width, lwp);
+    return std::string(digitsp, endp - digitsp);
+}
+
+// Append a field padded to width, with the padding on the left unless left
+static inline void _vl_vsformat_pad(std::string& output, const char* fieldp, size_t len,
+                                    bool left, size_t width, char pad) VL_MT_SAFE {
+    size_t needmore = width > len ? width - len : 0;
+    if (!left && needmore) output.append(needmore, pad);
+    output.append(fieldp, len);
+    if (left && needmore) output.append(needmore, pad);
+}
+
+static void _vl_vsformat_time(std::string& output, char* tmp, double ld, bool left,
+                              size_t width) VL_MT_SAFE {
     // Double may lose precision, but sc_time_stamp has similar limit
-    std::string suffix = VerilatedImp::timeFormatSuffix();
+    const std::string suffix = VerilatedImp::timeFormatSuffix();
     int userUnits = VerilatedImp::timeFormatUnits();  // 0..-15
     int fracDigits = VerilatedImp::timeFormatPrecision();  // 0..N
     int prec = Verilated::timeprecision();  // 0..-15
@@ -638,15 +967,21 @@ std::string _vl_vsformat_time(char* tmp, double ld, bool left, size_t width) {
         digits = sprintf(tmp, "%" VL_PRI64 "u.%0*" VL_PRI64 "u%s", whole, fracDigits, fraction,
                          suffix.c_str());
     }
-    int needmore = width - digits;
-    std::string padding;
-    if (needmore > 0) padding.append(needmore, ' ');  // Pad with spaces
-    return left ? (tmp + padding) : (padding + tmp);
+    _vl_vsformat_pad(output, tmp, digits, left, width, ' ');
 }
 
 // Do a va_arg returning a quad, assuming input argument is anything less than wide
 #define _VL_VA_ARG_Q(ap, bits) (((bits) <= VL_IDATASIZE) ? va_arg(ap, IData) : va_arg(ap, QData))
 
+// Write decimal digits of ld ending just before endp, returning the first digit
+static inline char* _vl_vsformat_udec(char* endp, QData ld) VL_PURE {
+    do {
+        *--endp = static_cast<char>('0' + ld % 10);
+        ld /= 10;
+    } while (ld);
+    return endp;
+}
+
 void _vl_vsformat(std::string& output, const char* formatp, va_list ap) VL_MT_SAFE {
     // Format a Verilog $write style format into the output list
     // The format must be pre-processed (and lower cased) by Verilator
@@ -710,9 +1045,7 @@ void _vl_vsformat(std::string& output, const char* formatp, va_list ap) VL_MT_SA
             case '@': {  // Verilog/C++ string
                 va_arg(ap, int);  // # bits is ignored
                 const std::string* cstrp = va_arg(ap, const std::string*);
-                std::string padding;
-                if (width > cstrp->size()) padding.append(width - cstrp->size(), ' ');
-                output += left ? (*cstrp + padding) : (padding + *cstrp);
+                _vl_vsformat_pad(output, cstrp->data(), cstrp->size(), left, width, ' ');
                 break;
             }
             case 'e':
@@ -725,13 +1058,17 @@ void _vl_vsformat(std::string& output, const char* formatp, va_list ap) VL_MT_SA
                 switch (fmt) {
                 case '^': {  // Realtime
                     if (!widthSet) width = VerilatedImp::timeFormatWidth();
-                    output += _vl_vsformat_time(tmp, d, left, width);
+                    _vl_vsformat_time(output, tmp, d, left, width);
                     break;
                 }
                 default: {
-                    std::string fmt(pctp, pos - pctp + 1);
-                    sprintf(tmp, fmt.c_str(), d);
-                    output += tmp;
+                    // Format is %[-][digits][.digits]{e,f,g}, so short
+                    char fmt[32];
+                    const size_t len = std::min(static_cast<size_t>(pos - pctp + 1),
+                                                sizeof(fmt) - 1);
+                    memcpy(fmt, pctp, len);
+                    fmt[len] = '\0';
+                    output.append(tmp, sprintf(tmp, fmt, d));
                     break;
                 }  //
                 break;
@@ -763,75 +1100,63 @@ void _vl_vsformat(std::string& output, const char* formatp, va_list ap) VL_MT_SA
                     break;
                 }
                 case 's': {
-                    std::string field;
+                    size_t chars = lsb / 8 + 1;
+                    size_t needmore = width > chars ? width - chars : 0;
+                    if (!left && needmore) output.append(needmore, ' ');
                     for (; lsb >= 0; --lsb) {
                         lsb = (lsb / 8) * 8;  // Next digit
                         IData charval = VL_BITRSHIFT_W(lwp, lsb) & 0xff;
-                        field += (charval == 0) ? ' ' : charval;
+                        output += (charval == 0) ? ' ' : charval;
                     }
-                    std::string padding;
-                    if (width > field.size()) padding.append(width - field.size(), ' ');
-                    output += left ? (field + padding) : (padding + field);
+                    if (left && needmore) output.append(needmore, ' ');
                     break;
                 }
-                case 'd': {  // Signed decimal
-                    int digits;
-                    std::string append;
+                case 'd':  // Signed decimal
+                case '#': {  // Unsigned decimal
+                    // %0 pads with zeros, and also does so when left justified
+                    char pad = (pctp && pctp[0] && pctp[1] == '0') ? '0' : ' ';
                     if (lbits <= VL_QUADSIZE) {
-                        digits = sprintf(tmp, "%" VL_PRI64 "d",
-                                         static_cast<vlsint64_t>(VL_EXTENDS_QQ(lbits, lbits, ld)));
-                        append = tmp;
-                    } else {
-                        if (VL_SIGN_E(lbits, lwp[VL_WORDS_I(lbits) - 1])) {
-                            WData neg[VL_VALUE_STRING_MAX_WIDTH / 4 + 2];
-                            VL_NEGATE_W(VL_WORDS_I(lbits), neg, lwp);
-                            append = std::string("-") + VL_DECIMAL_NW(lbits, neg);
-                        } else {
-                            append = VL_DECIMAL_NW(lbits, lwp);
-                        }
-                        digits = append.length();
-                    }
-                    int needmore = width - digits;
-                    std::string padding;
-                    if (needmore > 0) {
-                        if (pctp && pctp[0] && pctp[1] == '0') {  // %0
-                            padding.append(needmore, '0');  // Pre-pad zero
+                        char* endp = tmp + 24;
+                        char* digitsp;
+                        vlsint64_t sld = (fmt == 'd')
+                                             ? static_cast<vlsint64_t>(VL_EXTENDS_QQ(lbits, lbits, ld))
+                                             : 0;
+                        if (sld < 0) {
+                            // Unsigned negate, as -sld overflows for the most negative value
+                            digitsp = _vl_vsformat_udec(endp, 0 - static_cast<QData>(sld));
+                            *--digitsp = '-';
                         } else {
-                            padding.append(needmore, ' ');  // Pre-pad spaces
+                            digitsp = _vl_vsformat_udec(endp, ld);
                         }
-                    }
-                    output += left ? (append + padding) : (padding + append);
-                    break;
-                }
-                case '#': {  // Unsigned decimal
-                    int digits;
-                    std::string append;
-                    if (lbits <= VL_QUADSIZE) {
-                        digits = sprintf(tmp, "%" VL_PRI64 "u", ld);
-                        append = tmp;
+                        _vl_vsformat_pad(output, digitsp, endp - digitsp, left, width, pad);
                     } else {
-                        append = VL_DECIMAL_NW(lbits, lwp);
-                        digits = append.length();
-                    }
-                    int needmore = width - digits;
-                    std::string padding;
-                    if (needmore > 0) {
-                        if (pctp && pctp[0] && pctp[1] == '0') {  // %0
-                            padding.append(needmore, '0');  // Pre-pad zero
+                        char* endp = tmp + sizeof(tmp);
+                        char* digitsp;
+                        if (fmt == 'd' && VL_SIGN_E(lbits, lwp[VL_WORDS_I(lbits) - 1])) {
+                            WData neg[VL_VALUE_STRING_MAX_WIDTH / 4 + 2];
+                            VL_NEGATE_W(VL_WORDS_I(lbits), neg, lwp);
+                            digitsp = _vl_vsformat_decimal_w(endp, lbits, neg);
+                            *--digitsp = '-';
                         } else {
-                            padding.append(needmore, ' ');  // Pre-pad spaces
+                            digitsp = _vl_vsformat_decimal_w(endp, lbits, lwp);
                         }
+                        _vl_vsformat_pad(output, digitsp, endp - digitsp, left, width, pad);
                     }
-                    output += left ? (append + padding) : (padding + append);
                     break;
                 }
                 case 't': {  // Time
                     if (!widthSet) width = VerilatedImp::timeFormatWidth();
-                    output += _vl_vsformat_time(tmp, static_cast<double>(ld), left, width);
+                    _vl_vsformat_time(output, tmp, static_cast<double>(ld), left, width);
                     break;
                 }
                 case 'b':
-                    for (; lsb >= 0; --lsb) output += (VL_BITRSHIFT_W(lwp, lsb) & 1) + '0';
+                    if (lbits <= VL_QUADSIZE) {
+                        char* fieldp = tmp;
+                        for (; lsb >= 0; --lsb) *fieldp++ = ((ld >> lsb) & 1) + '0';
+                        output.append(tmp, fieldp - tmp);
+                    } else {
+                        for (; lsb >= 0; --lsb) output += (VL_BITRSHIFT_W(lwp, lsb) & 1) + '0';
+                    }
                     break;
                 case 'o':
                     for (; lsb >= 0; --lsb) {
@@ -873,10 +1198,18 @@ void _vl_vsformat(std::string& output, const char* formatp, va_list ap) VL_MT_SA
                     }
                     break;
                 case 'x':
-                    for (; lsb >= 0; --lsb) {
-                        lsb = (lsb / 4) * 4;  // Next digit
-                        IData charval = VL_BITRSHIFT_W(lwp, lsb) & 0xf;
-                        output += "0123456789abcdef"[charval];
+                    if (lbits <= VL_QUADSIZE) {
+                        char* fieldp = tmp;
+                        for (lsb = (lsb / 4) * 4; lsb >= 0; lsb -= 4) {
+                            *fieldp++ = "0123456789abcdef"[(ld >> lsb) & 0xf];
+                        }
+                        output.append(tmp, fieldp - tmp);
+                    } else {
+                        for (; lsb >= 0; --lsb) {
+                            lsb = (lsb / 4) * 4;  // Next digit
+                            IData charval = VL_BITRSHIFT_W(lwp, lsb) & 0xf;
+                            output += "0123456789abcdef"[charval];
+                        }
                     }
                     break;
                 default:
@@ -1230,12 +1563,25 @@ IData VL_FOPEN_S(const char* filenamep, const char* modep) VL_MT_SAFE {
 
 void VL_FCLOSE_I(IData fdi) VL_MT_SAFE {
     // While threadsafe, each thread can only access different file handles
+#ifdef VL_THREADED
+    // Close after any $fwrite this thread has buffered to the file
+    if (VerilatedThreadMsgQueue::postFclose(fdi)) return;
+#endif
     FILE* fp = VL_CVT_I_FP(fdi);
     if (VL_UNLIKELY(!fp)) return;
     fclose(fp);
     VerilatedImp::fdDelete(fdi);
 }
 
+void VL_FFLUSH_I(IData fdi) VL_MT_SAFE {
+#ifdef VL_THREADED
+    // Flush after any $fwrite this thread has buffered to the file
+    if (VerilatedThreadMsgQueue::postFflush(fdi)) return;
+#endif
+    FILE* fp = VL_CVT_I_FP(fdi);
+    if (VL_LIKELY(fp)) fflush(fp);
+}
+
 void VL_FFLUSH_ALL() VL_MT_SAFE { fflush(stdout); }
 
 void VL_SFORMAT_X(int obits, CData& destr, const char* formatp, ...) VL_MT_SAFE {
@@ -1321,22 +1667,30 @@ void VL_WRITEF(const char* formatp, ...) VL_MT_SAFE {
     _vl_vsformat(output, formatp, ap);
     va_end(ap);
 
-    VL_PRINTF_MT("%s", output.c_str());
+    _vl_puts_mt(output);
 }
 
 void VL_FWRITEF(IData fpi, const char* formatp, ...) VL_MT_SAFE {
     // While threadsafe, each thread can only access different file handles
     static VL_THREAD_LOCAL std::string output;  // static only for speed
     output = "";
+#ifndef VL_THREADED
     FILE* fp = VL_CVT_I_FP(fpi);
     if (VL_UNLIKELY(!fp)) return;
+#endif
 
     va_list ap;
     va_start(ap, formatp);
     _vl_vsformat(output, formatp, ap);
     va_end(ap);
 
+#ifdef VL_THREADED
+    // Buffered per thread and written at end of mtask, in mtask order,
+    // so threads don't contend on the descriptor table and stdio locks
+    VerilatedThreadMsgQueue::postWrite(fpi, output);
+#else
     fputs(output.c_str(), fp);
+#endif
 }
 
 IData VL_FSCANF_IX(IData fpi, const char* formatp, ...) VL_MT_SAFE {
@@ -1631,12 +1985,17 @@ std::string VL_SUBSTR_N(const std::string& lhs, IData rhs, IData ths) VL_PURE {
 }
 
 IData VL_ATOI_N(const std::string& str, int base) VL_PURE {
-    std::string str_mod = str;
-    // IEEE 1800-2017 6.16.9 says '_' may exist.
-    str_mod.erase(std::remove(str_mod.begin(), str_mod.end(), '_'), str_mod.end());
+    // IEEE 1800-2017 6.16.9 says '_' may exist; copy only if so
+    std::string str_mod;
+    const char* strp = str.c_str();
+    if (VL_UNLIKELY(str.find('_') != std::string::npos)) {
+        str_mod = str;
+        str_mod.erase(std::remove(str_mod.begin(), str_mod.end(), '_'), str_mod.end());
+        strp = str_mod.c_str();
+    }
 
     errno = 0;
-    long v = std::strtol(str_mod.c_str(), NULL, base);
+    long v = std::strtol(strp, NULL, base);
     if (errno != 0) v = 0;
     return static_cast<IData>(v);
 }
@@ -1686,25 +2045,68 @@ VlReadMem::VlReadMem(bool hex, int bits, const std::string& filename, QData star
     , m_bits(bits)
     , m_filename(filename)
     , m_end(end)
+    , m_datap(NULL)
+    , m_endp(NULL)
+    , m_cp(NULL)
+    , m_valuep(NULL)
+    , m_mapBytes(0)
     , m_addr(start)
-    , m_linenum(0) {
-    m_fp = fopen(filename.c_str(), "r");
-    if (VL_UNLIKELY(!m_fp)) {
-        // We don't report the Verilog source filename as it slow to have to pass it down
-        VL_FATAL_MT(filename.c_str(), 0, "", "$readmem file not found");
-        // cppcheck-suppress resourceLeak  // m_fp is NULL - bug in cppcheck
-        return;
+    , m_linenum(0)
+    , m_part(false)
+    , m_failed(false)
+    , m_sawAddr(false) {
+#ifdef VL_HAVE_MMAP
+    // Map the file rather than reading it, so large images aren't copied
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (0 == fstat(fd, &st) && st.st_size > 0) {
+            void* mapp = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapp != MAP_FAILED) {
+                m_mapBytes = st.st_size;
+                m_datap = static_cast<const char*>(mapp);
+            }
+        }
+        ::close(fd);
     }
-}
+#endif
+    if (!m_datap) {
+        FILE* fp = fopen(filename.c_str(), "rb");
+        if (VL_UNLIKELY(!fp)) {
+            // We don't report the Verilog source filename as it slow to have to pass it down
+            VL_FATAL_MT(filename.c_str(), 0, "", "$readmem file not found");
+            return;
+        }
+        char buf[65536];
+        while (size_t got = fread(buf, 1, sizeof(buf), fp)) m_buf.append(buf, got);
+        fclose(fp);
+        m_datap = m_buf.data();
+    }
+    m_endp = m_datap + (m_mapBytes ? m_mapBytes : m_buf.size());
+    m_cp = m_datap;
+}
+VlReadMem::VlReadMem(const VlReadMem& file, const char* begp, const char* endp, QData addr)
+    : m_hex(file.m_hex)
+    , m_bits(file.m_bits)
+    , m_filename(file.m_filename)
+    , m_end(file.m_end)
+    , m_datap(begp)
+    , m_endp(endp)
+    , m_cp(begp)
+    , m_valuep(NULL)
+    , m_mapBytes(0)
+    , m_addr(addr)
+    , m_linenum(0)
+    , m_part(true)
+    , m_failed(false)
+    , m_sawAddr(false) {}
 VlReadMem::~VlReadMem() {
-    if (m_fp) {
-        fclose(m_fp);
-        m_fp = NULL;
-    }
+#ifdef VL_HAVE_MMAP
+    if (m_mapBytes) munmap(const_cast<char*>(m_datap), m_mapBytes);
+#endif
 }
-bool VlReadMem::get(QData& addrr, std::string& valuer) {
-    if (VL_UNLIKELY(!m_fp)) return false;
-    valuer = "";
+bool VlReadMem::get(QData& addrr) {
+    if (VL_UNLIKELY(!m_datap)) return false;
     // Prep for reading
     bool indata = false;
     bool ignore_to_eol = false;
@@ -1712,22 +2114,15 @@ bool VlReadMem::get(QData& addrr, std::string& valuer) {
     bool reading_addr = false;
     int lastc = ' ';
     // Read the data
-    // We process a character at a time, as then we don't need to deal
-    // with changing buffer sizes dynamically, etc.
-    while (true) {
-        int c = fgetc(m_fp);
-        if (VL_UNLIKELY(c == EOF)) break;
+    // We process a character at a time from the file contents, as then we
+    // don't need to deal with changing buffer sizes dynamically, etc.
+    for (; m_cp < m_endp; ++m_cp) {
+        int c = static_cast<unsigned char>(*m_cp);
         // printf("%d: Got '%c' Addr%lx IN%d IgE%d IgC%d\n",
         //        m_linenum, c, m_addr, indata, ignore_to_eol, ignore_to_cmt);
         // See if previous data value has completed, and if so return
         if (c == '_') continue;  // Ignore _ e.g. inside a number
-        if (indata && !isxdigit(c) && c != 'x' && c != 'X') {
-            // printf("Got data @%lx = %s\n", m_addr, valuer.c_str());
-            ungetc(c, m_fp);
-            addrr = m_addr;
-            ++m_addr;
-            return true;
-        }
+        if (indata && !isxdigit(c) && c != 'x' && c != 'X') break;
         // Parse line
         if (c == '\n') {
             ++m_linenum;
@@ -1750,70 +2145,90 @@ bool VlReadMem::get(QData& addrr, std::string& valuer) {
                 ignore_to_eol = true;
             } else if (c == '@') {
                 reading_addr = true;
+                m_sawAddr = true;
                 m_addr = 0;
             }
             // Check for hex or binary digits as file format requests
             else if (isxdigit(c) || (!reading_addr && (c == 'x' || c == 'X'))) {
                 c = tolower(c);
-                int value
-                    = (c >= 'a' ? (c == 'x' ? VL_RAND_RESET_I(4) : (c - 'a' + 10)) : (c - '0'));
+                int value = (c >= 'a' ? (c == 'x' ? 0 : (c - 'a' + 10)) : (c - '0'));
                 if (reading_addr) {
                     // Decode @ addresses
                     m_addr = (m_addr << 4) + value;
                 } else {
+                    if (!indata) m_valuep = m_cp;
                     indata = true;
-                    valuer += c;
                     // printf(" Value width=%d  @%x = %c\n", width, m_addr, c);
                     if (VL_UNLIKELY(value > 1 && !m_hex)) {
+                        if (m_part) {
+                            fail();
+                            return false;
+                        }
                         VL_FATAL_MT(m_filename.c_str(), m_linenum, "",
                                     "$readmemb (binary) file contains hex characters");
                     }
                 }
             } else {
+                if (m_part) {
+                    fail();
+                    return false;
+                }
                 VL_FATAL_MT(m_filename.c_str(), m_linenum, "", "$readmem file syntax error");
             }
         }
         lastc = c;
     }
+    if (indata) {
+        // printf("Got data @%lx\n", m_addr);
+        addrr = m_addr;
+        ++m_addr;
+        return true;
+    }
 
-    if (VL_UNLIKELY(m_end != ~VL_ULL(0) && m_addr <= m_end)) {
+    if (VL_UNLIKELY(!m_part && m_end != ~VL_ULL(0) && m_addr <= m_end)) {
         VL_FATAL_MT(m_filename.c_str(), m_linenum, "",
                     "$readmem file ended before specified final address (IEEE 2017 21.4)");
     }
 
     return false;  // EOF
 }
-void VlReadMem::setData(void* valuep, const std::string& rhs) {
-    QData shift = m_hex ? VL_ULL(4) : VL_ULL(1);
-    bool innum = false;
-    // Shift value in
-    for (std::string::const_iterator it = rhs.begin(); it != rhs.end(); ++it) {
-        char c = tolower(*it);
-        int value = (c >= 'a' ? (c == 'x' ? VL_RAND_RESET_I(4) : (c - 'a' + 10)) : (c - '0'));
+void VlReadMem::setData(void* valuep, const char* begp, const char* endp) {
+    // Convert from the least significant (last) digit, dropping bits above m_bits
+    const int shift = m_hex ? 4 : 1;
+    if (m_bits <= VL_QUADSIZE) {
+        QData data = 0;
+        int lsb = 0;
+        for (const char* cp = endp; cp != begp && lsb < m_bits;) {
+            const int c = tolower(*--cp);
+            if (c == '_') continue;
+            const QData value
+                = (c >= 'a' ? (c == 'x' ? VL_RAND_RESET_I(shift) : (c - 'a' + 10)) : (c - '0'));
+            data |= value << lsb;
+            lsb += shift;
+        }
         if (m_bits <= 8) {
-            CData* datap = reinterpret_cast<CData*>(valuep);
-            if (!innum) { *datap = 0; }
-            *datap = ((*datap << shift) + value) & VL_MASK_I(m_bits);
+            *reinterpret_cast<CData*>(valuep) = data & VL_MASK_I(m_bits);
         } else if (m_bits <= 16) {
-            SData* datap = reinterpret_cast<SData*>(valuep);
-            if (!innum) { *datap = 0; }
-            *datap = ((*datap << shift) + value) & VL_MASK_I(m_bits);
+            *reinterpret_cast<SData*>(valuep) = data & VL_MASK_I(m_bits);
         } else if (m_bits <= VL_IDATASIZE) {
-            IData* datap = reinterpret_cast<IData*>(valuep);
-            if (!innum) { *datap = 0; }
-            *datap = ((*datap << shift) + value) & VL_MASK_I(m_bits);
-        } else if (m_bits <= VL_QUADSIZE) {
-            QData* datap = reinterpret_cast<QData*>(valuep);
-            if (!innum) { *datap = 0; }
-            *datap = ((*datap << static_cast<QData>(shift)) + static_cast<QData>(value))
-                     & VL_MASK_Q(m_bits);
+            *reinterpret_cast<IData*>(valuep) = data & VL_MASK_I(m_bits);
         } else {
-            WDataOutP datap = reinterpret_cast<WDataOutP>(valuep);
-            if (!innum) VL_ZERO_RESET_W(m_bits, datap);
-            _VL_SHIFTL_INPLACE_W(m_bits, datap, static_cast<IData>(shift));
-            datap[0] |= value;
+            *reinterpret_cast<QData*>(valuep) = data & VL_MASK_Q(m_bits);
+        }
+    } else {
+        WDataOutP datap = reinterpret_cast<WDataOutP>(valuep);
+        VL_ZERO_RESET_W(m_bits, datap);
+        int lsb = 0;
+        for (const char* cp = endp; cp != begp && lsb < m_bits;) {
+            const int c = tolower(*--cp);
+            if (c == '_') continue;
+            const EData value
+                = (c >= 'a' ? (c == 'x' ? VL_RAND_RESET_I(shift) : (c - 'a' + 10)) : (c - '0'));
+            // Digits are 1 or 4 bits so never straddle words
+            datap[VL_BITWORD_E(lsb)] |= value << VL_BITBIT_E(lsb);
+            lsb += shift;
         }
-        innum = true;
+        datap[VL_WORDS_I(m_bits) - 1] &= VL_MASK_E(m_bits);
     }
 }
 
@@ -1892,6 +2307,114 @@ void VlWriteMem::print(QData addr, bool addrstamp, const void* valuep) {
     }
 }
 
+static void* _vl_readmem_rowp(int bits, void* memp, QData entry) VL_PURE {
+    if (bits <= 8) {
+        return &(reinterpret_cast<CData*>(memp))[entry];
+    } else if (bits <= 16) {
+        return &(reinterpret_cast<SData*>(memp))[entry];
+    } else if (bits <= VL_IDATASIZE) {
+        return &(reinterpret_cast<IData*>(memp))[entry];
+    } else if (bits <= VL_QUADSIZE) {
+        return &(reinterpret_cast<QData*>(memp))[entry];
+    } else {
+        return &(reinterpret_cast<WDataOutP>(memp))[entry * VL_WORDS_I(bits)];
+    }
+}
+
+#ifdef VL_THREADED
+static bool _vl_readmem_parallel(VlReadMem& rmem, int bits, QData depth, int array_lsb,
+                                 void* memp, QData start, QData end) VL_MT_SAFE {
+    // Load a large file split into parts by line, one part per thread.
+    // Returns false if the caller must load serially, including to report errors.
+    const char* const datap = rmem.datap();
+    const char* const endp = rmem.endp();
+    const size_t bytes = endp - datap;
+    if (bytes < VL_READMEM_PARALLEL_BYTES) return false;
+    // Parts must not start inside a /* comment
+    for (const char* cp = datap;
+         (cp = static_cast<const char*>(memchr(cp, '/', endp - cp))) != NULL; ++cp) {
+        if (cp + 1 < endp && (cp[1] == '*' || cp[1] == '_')) return false;
+    }
+    size_t parts = std::thread::hardware_concurrency();
+    parts = std::min(parts, bytes / (VL_READMEM_PARALLEL_BYTES / 4));
+    if (parts < 2) return false;
+    std::vector<const char*> begps(parts + 1, endp);
+    begps[0] = datap;
+    for (size_t i = 1; i < parts; ++i) {
+        const char* cp = std::max(datap + bytes / parts * i, begps[i - 1]);
+        cp = static_cast<const char*>(memchr(cp, '\n', endp - cp));
+        begps[i] = cp ? cp + 1 : endp;
+    }
+    // Runs of consecutive addresses; relative to part start until the first @
+    typedef std::vector<std::pair<QData, QData> > Runs;  // Start address, count
+    std::vector<Runs> runs(parts);
+    std::vector<size_t> relRuns(parts, 0);  // Number of relative runs
+    std::vector<QData> addrs(parts + 1, 0);  // Address each part starts at
+    std::vector<QData> endAddrs(parts, 0);
+    std::vector<char> sawAddrs(parts, 0);
+    std::vector<char> faileds(parts, 0);
+    std::vector<std::thread> threads;
+    // First pass finds addresses, as a part without @ starts where the previous ended
+    for (size_t i = 0; i < parts; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            VlReadMem part(rmem, begps[i], begps[i + 1], 0);
+            Runs& partRuns = runs[i];
+            QData addr;
+            while (part.get(addr /*ref*/)) {
+                if (partRuns.empty() || addr != partRuns.back().first + partRuns.back().second
+                    || (part.sawAddr() && partRuns.size() == relRuns[i])) {
+                    partRuns.push_back(std::make_pair(addr, 0));
+                    if (!part.sawAddr()) ++relRuns[i];
+                }
+                ++partRuns.back().second;
+            }
+            endAddrs[i] = part.addr();
+            sawAddrs[i] = part.sawAddr();
+            faileds[i] = part.failed();
+        }));
+    }
+    for (size_t i = 0; i < parts; ++i) threads[i].join();
+    threads.clear();
+    addrs[0] = start;
+    Runs allRuns;
+    for (size_t i = 0; i < parts; ++i) {
+        if (faileds[i]) return false;
+        addrs[i + 1] = sawAddrs[i] ? endAddrs[i] : addrs[i] + endAddrs[i];
+        for (size_t r = 0; r < runs[i].size(); ++r) {
+            const QData runAddr = runs[i][r].first + (r < relRuns[i] ? addrs[i] : 0);
+            allRuns.push_back(std::make_pair(runAddr, runs[i][r].second));
+        }
+    }
+    if (end != ~VL_ULL(0) && addrs[parts] <= end) return false;
+    // Rows written twice must be written in file order, so load those serially
+    std::sort(allRuns.begin(), allRuns.end());
+    for (size_t r = 1; r < allRuns.size(); ++r) {
+        if (allRuns[r - 1].first + allRuns[r - 1].second > allRuns[r].first) return false;
+    }
+    // Second pass converts values into the array
+    for (size_t i = 0; i < parts; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            VlReadMem part(rmem, begps[i], begps[i + 1], addrs[i]);
+            QData addr;
+            while (part.get(addr /*ref*/)) {
+                if (VL_UNLIKELY(addr < static_cast<QData>(array_lsb)
+                                || addr >= static_cast<QData>(array_lsb + depth))) {
+                    part.fail();
+                    break;
+                }
+                part.setData(_vl_readmem_rowp(bits, memp, addr - array_lsb));
+            }
+            faileds[i] = part.failed();
+        }));
+    }
+    for (size_t i = 0; i < parts; ++i) threads[i].join();
+    for (size_t i = 0; i < parts; ++i) {
+        if (faileds[i]) return false;
+    }
+    return true;
+}
+#endif
+
 void VL_READMEM_N(bool hex,  // Hex format, else binary
                   int bits,  // M_Bits of each array row
                   QData depth,  // Number of rows
@@ -1906,33 +2429,18 @@ void VL_READMEM_N(bool hex,  // Hex format, else binary
 
     VlReadMem rmem(hex, bits, filename, start, end);
     if (VL_UNLIKELY(!rmem.isOpen())) return;
+#ifdef VL_THREADED
+    if (_vl_readmem_parallel(rmem, bits, depth, array_lsb, memp, start, end)) return;
+#endif
     while (true) {
         QData addr;
-        std::string value;
-        if (rmem.get(addr /*ref*/, value /*ref*/)) {
+        if (rmem.get(addr /*ref*/)) {
             if (VL_UNLIKELY(addr < static_cast<QData>(array_lsb)
                             || addr >= static_cast<QData>(array_lsb + depth))) {
                 VL_FATAL_MT(filename.c_str(), rmem.linenum(), "",
                             "$readmem file address beyond bounds of array");
             } else {
-                QData entry = addr - array_lsb;
-                if (bits <= 8) {
-                    CData* datap = &(reinterpret_cast<CData*>(memp))[entry];
-                    rmem.setData(datap, value);
-                } else if (bits <= 16) {
-                    SData* datap = &(reinterpret_cast<SData*>(memp))[entry];
-                    rmem.setData(datap, value);
-                } else if (bits <= VL_IDATASIZE) {
-                    IData* datap = &(reinterpret_cast<IData*>(memp))[entry];
-                    rmem.setData(datap, value);
-                } else if (bits <= VL_QUADSIZE) {
-                    QData* datap = &(reinterpret_cast<QData*>(memp))[entry];
-                    rmem.setData(datap, value);
-                } else {
-                    WDataOutP datap
-                        = &(reinterpret_cast<WDataOutP>(memp))[entry * VL_WORDS_I(bits)];
-                    rmem.setData(datap, value);
-                }
+                rmem.setData(_vl_readmem_rowp(bits, memp, addr - array_lsb));
             }
         } else {
             break;
@@ -1979,6 +2487,428 @@ void VL_WRITEMEM_N(bool hex,  // Hex format, else binary
     }
 }
 
+static inline size_t _vl_memraw_storage_bytes(int bits) VL_PURE {
+    if (bits <= 8) {
+        return sizeof(CData);
+    } else if (bits <= 16) {
+        return sizeof(SData);
+    } else if (bits <= VL_IDATASIZE) {
+        return sizeof(IData);
+    } else if (bits <= VL_QUADSIZE) {
+        return sizeof(QData);
+    } else {
+        return VL_WORDS_I(bits) * sizeof(EData);
+    }
+}
+
+// Raw images store each row as (bits+7)/8 bytes, least significant byte first
+static void _vl_memraw_unpack(int bits, void* rowp, const vluint8_t* bytesp) VL_MT_SAFE {
+    int nbytes = (bits + 7) / 8;
+    if (bits <= VL_QUADSIZE) {
+        QData value = 0;
+        for (int i = nbytes - 1; i >= 0; --i) value = (value << 8) | bytesp[i];
+        value &= VL_MASK_Q(bits);
+        if (bits <= 8) {
+            *reinterpret_cast<CData*>(rowp) = static_cast<CData>(value);
+        } else if (bits <= 16) {
+            *reinterpret_cast<SData*>(rowp) = static_cast<SData>(value);
+        } else if (bits <= VL_IDATASIZE) {
+            *reinterpret_cast<IData*>(rowp) = static_cast<IData>(value);
+        } else {
+            *reinterpret_cast<QData*>(rowp) = value;
+        }
+    } else {
+        WDataOutP datap = reinterpret_cast<WDataOutP>(rowp);
+        for (int w = 0; w < VL_WORDS_I(bits); ++w) datap[w] = 0;
+        for (int i = 0; i < nbytes; ++i) {
+            datap[i / sizeof(EData)] |= static_cast<EData>(bytesp[i]) << ((i % sizeof(EData)) * 8);
+        }
+        datap[VL_WORDS_I(bits) - 1] &= VL_MASK_E(bits);
+    }
+}
+
+static void _vl_memraw_pack(int bits, vluint8_t* bytesp, const void* rowp) VL_MT_SAFE {
+    int nbytes = (bits + 7) / 8;
+    if (bits <= VL_QUADSIZE) {
+        QData value;
+        if (bits <= 8) {
+            value = *reinterpret_cast<const CData*>(rowp);
+        } else if (bits <= 16) {
+            value = *reinterpret_cast<const SData*>(rowp);
+        } else if (bits <= VL_IDATASIZE) {
+            value = *reinterpret_cast<const IData*>(rowp);
+        } else {
+            value = *reinterpret_cast<const QData*>(rowp);
+        }
+        value &= VL_MASK_Q(bits);
+        for (int i = 0; i < nbytes; ++i, value >>= 8) bytesp[i] = static_cast<vluint8_t>(value);
+    } else {
+        WDataInP datap = reinterpret_cast<WDataInP>(rowp);
+        for (int i = 0; i < nbytes; ++i) {
+            EData data = datap[i / sizeof(EData)];
+            if (i / sizeof(EData) == static_cast<size_t>(VL_WORDS_I(bits) - 1)) {
+                data &= VL_MASK_E(bits);
+            }
+            bytesp[i] = static_cast<vluint8_t>(data >> ((i % sizeof(EData)) * 8));
+        }
+    }
+}
+
+// When the host is little endian and each row fills its storage exactly, a
+// raw image has the same layout as the array, so is copied with no conversion
+static inline bool _vl_memraw_direct(int bits) VL_PURE {
+    bool littleEndian = false;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    littleEndian = true;
+#endif
+    return littleEndian && (bits % 8) == 0
+           && static_cast<size_t>(bits / 8) == _vl_memraw_storage_bytes(bits);
+}
+
+void VL_READMEMRAW_N(int bits,  // M_Bits of each array row
+                     QData depth,  // Number of rows
+                     int array_lsb,  // Index of first row. Valid row addresses
+                     //              //  range from array_lsb up to (array_lsb + depth - 1)
+                     const std::string& filename,  // Input file name
+                     void* memp,  // Array state
+                     QData start,  // First array row address to read
+                     QData end  // Last row address to read, or ~0 when not specified
+                     ) VL_MT_SAFE {
+    QData addr_max = array_lsb + depth - 1;
+    if (start < static_cast<QData>(array_lsb)) start = array_lsb;
+    if (VL_UNLIKELY(start > end)) {
+        VL_FATAL_MT(filename.c_str(), 0, "", "$readmemraw invalid address range");
+        return;
+    }
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if (VL_UNLIKELY(!fp)) {
+        VL_FATAL_MT(filename.c_str(), 0, "", "$readmemraw file not found");
+        return;
+    }
+    const size_t rowBytes = (bits + 7) / 8;
+    fseek(fp, 0, SEEK_END);
+    long fileBytes = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    QData rows = fileBytes > 0 ? (static_cast<QData>(fileBytes) + rowBytes - 1) / rowBytes : 0;
+    if (end != ~VL_ULL(0) && (end - start + 1) < rows) rows = end - start + 1;
+    if (VL_UNLIKELY(rows && (start > addr_max || rows - 1 > addr_max - start))) {
+        VL_FATAL_MT(filename.c_str(), 0, "", "$readmemraw file address beyond bounds of array");
+    } else if (rows) {
+        vluint8_t* rowp = reinterpret_cast<vluint8_t*>(_vl_readmem_rowp(bits, memp,
+                                                                        start - array_lsb));
+        if (_vl_memraw_direct(bits)) {
+            // A short final row is zero padded, as when converted below
+            size_t got = fread(rowp, 1, rows * rowBytes, fp);
+            if (got < rows * rowBytes) memset(rowp + got, 0, rows * rowBytes - got);
+        } else {
+            const size_t storageBytes = _vl_memraw_storage_bytes(bits);
+            std::vector<vluint8_t> buf(rowBytes * 4096);
+            for (QData done = 0; done < rows;) {
+                size_t chunk = static_cast<size_t>(std::min<QData>(rows - done, 4096));
+                size_t got = fread(&buf[0], 1, chunk * rowBytes, fp);
+                if (got < chunk * rowBytes) memset(&buf[got], 0, chunk * rowBytes - got);
+                for (size_t i = 0; i < chunk; ++i, rowp += storageBytes) {
+                    _vl_memraw_unpack(bits, rowp, &buf[i * rowBytes]);
+                }
+                done += chunk;
+            }
+        }
+    }
+    if (VL_UNLIKELY(end != ~VL_ULL(0) && start + rows <= end)) {
+        VL_FATAL_MT(filename.c_str(), 0, "",
+                    "$readmemraw file ended before specified final address (IEEE 2017 21.4)");
+    }
+    fclose(fp);
+}
+
+void VL_WRITEMEMRAW_N(int bits,  // Width of each array row
+                      QData depth,  // Number of rows
+                      int array_lsb,  // Index of first row. Valid row addresses
+                      //              //  range from array_lsb up to (array_lsb + depth - 1)
+                      const std::string& filename,  // Output file name
+                      const void* memp,  // Array state
+                      QData start,  // First array row address to write
+                      QData end  // Last address to write, or ~0 when not specified
+                      ) VL_MT_SAFE {
+    QData addr_max = array_lsb + depth - 1;
+    if (start < static_cast<QData>(array_lsb)) start = array_lsb;
+    if (end > addr_max) end = addr_max;
+    if (VL_UNLIKELY(start > end)) {
+        VL_FATAL_MT(filename.c_str(), 0, "", "$writememraw invalid address range");
+        return;
+    }
+    FILE* fp = fopen(filename.c_str(), "wb");
+    if (VL_UNLIKELY(!fp)) {
+        VL_FATAL_MT(filename.c_str(), 0, "", "$writememraw file not found");
+        return;
+    }
+    const size_t rowBytes = (bits + 7) / 8;
+    const QData rows = end - start + 1;
+    const vluint8_t* rowp = reinterpret_cast<const vluint8_t*>(
+        _vl_readmem_rowp(bits, const_cast<void*>(memp), start - array_lsb));
+    if (_vl_memraw_direct(bits)) {
+        fwrite(rowp, 1, rows * rowBytes, fp);
+    } else {
+        const size_t storageBytes = _vl_memraw_storage_bytes(bits);
+        std::vector<vluint8_t> buf(rowBytes * 4096);
+        for (QData done = 0; done < rows;) {
+            size_t chunk = static_cast<size_t>(std::min<QData>(rows - done, 4096));
+            for (size_t i = 0; i < chunk; ++i, rowp += storageBytes) {
+                _vl_memraw_pack(bits, &buf[i * rowBytes], rowp);
+            }
+            fwrite(&buf[0], 1, chunk * rowBytes, fp);
+            done += chunk;
+        }
+    }
+    fclose(fp);
+}
+
+//===========================================================================
+// Sparse arrays
+
+#ifdef VL_HAVE_MMAP
+# ifndef MAP_ANONYMOUS
+#  define MAP_ANONYMOUS MAP_ANON
+# endif
+# ifndef MAP_NORESERVE
+#  define MAP_NORESERVE 0
+# endif
+static void* _vl_sparse_map(void* addrp, size_t bytes, int flags) VL_MT_SAFE {
+    // Anonymous pages are zero, and only take memory once written
+    void* datap = mmap(addrp, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | flags, -1, 0);
+    if (VL_UNLIKELY(datap == MAP_FAILED)) {
+        VL_FATAL_MT(__FILE__, __LINE__, "", "Out of address space for sparse array");
+        return NULL;
+    }
+    return datap;
+}
+#endif
+
+// Sparse arrays reset to ones or random values.  Each page's contents
+// depend only on the seed, the array's name, and the page's index, so
+// pages may be filled in whatever order they are first touched.
+struct VlSparseReset {
+    vluint8_t* m_datap;  // Start of the array's mapping
+    size_t m_bytes;  // Size of the mapping
+    size_t m_pageBytes;  // Bytes per operating system page
+    int m_obits;  // Bits in each element
+    bool m_ones;  // Reset to ones, else random
+    vluint64_t m_seed;  // Seed for the array
+    vluint8_t* m_filledp;  // Per page, whether the page has been filled
+};
+
+static void _vl_sparse_fill(const VlSparseReset* resetp, size_t off, vluint8_t* pagep,
+                            size_t len) VL_MT_SAFE {
+    // Fill len bytes at array offset off; off is a multiple of 8
+    if (resetp->m_ones) {
+        memset(pagep, 0xff, len);
+    } else {
+        vluint64_t x = resetp->m_seed ^ (off * VL_ULL(0xd1b54a32d192ed03));
+        vluint64_t s[4];
+        for (int i = 0; i < 4; ++i) s[i] = vl_rand_splitmix64(x);
+        for (size_t i = 0; i < len; i += sizeof(vluint64_t)) {
+            const vluint64_t rand = vl_rand_next(s);
+            memcpy(pagep + i, &rand, std::min(sizeof(rand), len - i));
+        }
+    }
+    // Clear the bits above obits in each element
+    const int obits = resetp->m_obits;
+    if (obits <= 8) {
+        CData* rowp = reinterpret_cast<CData*>(pagep);
+        for (size_t r = 0; r < len / sizeof(CData); ++r) rowp[r] &= VL_MASK_I(obits);
+    } else if (obits <= 16) {
+        SData* rowp = reinterpret_cast<SData*>(pagep);
+        for (size_t r = 0; r < len / sizeof(SData); ++r) rowp[r] &= VL_MASK_I(obits);
+    } else if (obits <= VL_IDATASIZE) {
+        IData* rowp = reinterpret_cast<IData*>(pagep);
+        for (size_t r = 0; r < len / sizeof(IData); ++r) rowp[r] &= VL_MASK_I(obits);
+    } else if (obits <= VL_QUADSIZE) {
+        QData* rowp = reinterpret_cast<QData*>(pagep);
+        for (size_t r = 0; r < len / sizeof(QData); ++r) rowp[r] &= VL_MASK_Q(obits);
+    } else {
+        // Wide rows may straddle pages, so find each row's top word
+        EData* wordp = reinterpret_cast<EData*>(pagep);
+        const size_t words = VL_WORDS_I(obits);
+        const size_t firstWord = off / sizeof(EData);
+        size_t w = words - 1 - (firstWord % words);
+        for (; w < len / sizeof(EData); w += words) wordp[w] &= VL_MASK_E(obits);
+    }
+}
+
+// The arrays with a reset, found by address.  The lock is a spin lock, as
+// the fault handler may not block on a mutex.
+static std::vector<VlSparseReset*> s_sparseResets;
+#ifdef VL_THREADED
+static std::atomic_flag s_sparseLock = ATOMIC_FLAG_INIT;
+static void _vl_sparse_lock() VL_MT_SAFE {
+    while (s_sparseLock.test_and_set(std::memory_order_acquire)) {}
+}
+static void _vl_sparse_unlock() VL_MT_SAFE { s_sparseLock.clear(std::memory_order_release); }
+#else
+static void _vl_sparse_lock() VL_MT_SAFE {}
+static void _vl_sparse_unlock() VL_MT_SAFE {}
+#endif
+
+static VlSparseReset* _vl_sparse_find(const void* addrp) VL_MT_SAFE {
+    // Must hold the lock
+    const vluint8_t* bytep = static_cast<const vluint8_t*>(addrp);
+    for (std::vector<VlSparseReset*>::const_iterator it = s_sparseResets.begin();
+         it != s_sparseResets.end(); ++it) {
+        if (bytep >= (*it)->m_datap && bytep < (*it)->m_datap + (*it)->m_bytes) return *it;
+    }
+    return NULL;
+}
+
+#ifdef VL_SPARSE_LAZY
+// The arrays awaiting reset start inaccessible; the first access to each
+// page faults, and the handler installs the page's reset contents.
+static struct sigaction s_sparseOldAction;
+
+static void _vl_sparse_fault(int sig, siginfo_t* infop, void* contextp) {
+    _vl_sparse_lock();
+    VlSparseReset* resetp = _vl_sparse_find(infop->si_addr);
+    if (VL_UNLIKELY(!resetp)) {
+        // Not ours; restore the previous handler, which then sees the fault again
+        _vl_sparse_unlock();
+        sigaction(SIGSEGV, &s_sparseOldAction, NULL);
+        return;
+    }
+    const size_t page
+        = (static_cast<vluint8_t*>(infop->si_addr) - resetp->m_datap) / resetp->m_pageBytes;
+    if (!resetp->m_filledp[page]) {
+        // Fill a new page, then move it into place, so other threads never
+        // see a partially filled page
+        void* newp = mmap(NULL, resetp->m_pageBytes, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (VL_UNLIKELY(newp == MAP_FAILED)) abort();
+        _vl_sparse_fill(resetp, page * resetp->m_pageBytes, static_cast<vluint8_t*>(newp),
+                        resetp->m_pageBytes);
+        if (VL_UNLIKELY(mremap(newp, resetp->m_pageBytes, resetp->m_pageBytes,
+                               MREMAP_MAYMOVE | MREMAP_FIXED,
+                               resetp->m_datap + page * resetp->m_pageBytes)
+                        == MAP_FAILED)) {
+            abort();
+        }
+        resetp->m_filledp[page] = 1;
+    }
+    _vl_sparse_unlock();
+    if (0 && sig && contextp) {}
+}
+#endif
+
+static void _vl_sparse_reset(VlSparseReset* resetp) VL_MT_SAFE {
+#ifdef VL_SPARSE_LAZY
+    // Replace the pages with inaccessible ones, releasing any written
+    if (VL_UNLIKELY(mmap(resetp->m_datap, resetp->m_bytes, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0)
+                    == MAP_FAILED)) {
+        VL_FATAL_MT(__FILE__, __LINE__, "", "Out of address space for sparse array");
+    }
+    memset(resetp->m_filledp, 0, resetp->m_bytes / resetp->m_pageBytes);
+#else
+    // Without fault handling fill every page now, with the same contents
+    for (size_t off = 0; off < resetp->m_bytes; off += resetp->m_pageBytes) {
+        const size_t len = std::min(resetp->m_pageBytes, resetp->m_bytes - off);
+        _vl_sparse_fill(resetp, off, resetp->m_datap + off, len);
+    }
+#endif
+}
+
+void* VL_SPARSE_ALLOC(size_t bytes) VL_MT_SAFE {
+#ifdef VL_HAVE_MMAP
+    return _vl_sparse_map(NULL, bytes, 0);
+#else
+    void* datap = calloc(bytes, 1);
+    if (VL_UNLIKELY(!datap)) VL_FATAL_MT(__FILE__, __LINE__, "", "Out of memory for sparse array");
+    return datap;
+#endif
+}
+
+void VL_SPARSE_RAND_RESET(int obits, const char* scopep, const char* varp, void* datap,
+                          size_t bytes) VL_MT_SAFE {
+    const int mode = Verilated::randReset();
+    if (mode == 0) return;
+    VlSparseReset* resetp = new VlSparseReset;
+    resetp->m_datap = static_cast<vluint8_t*>(datap);
+    resetp->m_bytes = bytes;
+    resetp->m_pageBytes = VL_SPARSE_PAGE_BYTES;
+    resetp->m_obits = obits;
+    resetp->m_ones = (mode == 1);
+    resetp->m_filledp = NULL;
+    // Seed from the array's name, so instances of a module differ
+    vluint64_t x = (Verilated::randSeed() != 0
+                        ? static_cast<vluint64_t>(static_cast<vluint32_t>(Verilated::randSeed()))
+                        : vl_rand64());
+    for (const char* cp = scopep; *cp; ++cp) x = vl_rand_splitmix64(x) ^ *cp;
+    x ^= '.';
+    for (const char* cp = varp; *cp; ++cp) x = vl_rand_splitmix64(x) ^ *cp;
+    resetp->m_seed = vl_rand_splitmix64(x);
+#ifdef VL_SPARSE_LAZY
+    resetp->m_pageBytes = sysconf(_SC_PAGESIZE);
+    resetp->m_bytes = ((bytes + resetp->m_pageBytes - 1) / resetp->m_pageBytes
+                       * resetp->m_pageBytes);
+    resetp->m_filledp = new vluint8_t[resetp->m_bytes / resetp->m_pageBytes];
+#endif
+    _vl_sparse_lock();
+#ifdef VL_SPARSE_LAZY
+    if (s_sparseResets.empty()) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = _vl_sparse_fault;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &s_sparseOldAction);
+    }
+#endif
+    _vl_sparse_reset(resetp);
+    s_sparseResets.push_back(resetp);
+    _vl_sparse_unlock();
+}
+
+void VL_SPARSE_CLEAR(void* datap, size_t bytes) VL_MT_SAFE {
+    _vl_sparse_lock();
+    VlSparseReset* resetp = _vl_sparse_find(datap);
+    if (resetp) _vl_sparse_reset(resetp);
+    _vl_sparse_unlock();
+    if (resetp) return;
+#ifdef VL_HAVE_MMAP
+    // Replacing the mapping releases the written pages
+    _vl_sparse_map(datap, bytes, MAP_FIXED);
+#else
+    memset(datap, 0, bytes);
+#endif
+}
+
+int VL_SPARSE_PAGE_FILLED(const void* datap, size_t offset) VL_MT_SAFE {
+    _vl_sparse_lock();
+    const VlSparseReset* resetp = _vl_sparse_find(datap);
+    int filled = -1;
+    if (resetp) filled = resetp->m_filledp ? resetp->m_filledp[offset / resetp->m_pageBytes] : 1;
+    _vl_sparse_unlock();
+    return filled;
+}
+
+void VL_SPARSE_FREE(void* datap, size_t bytes) VL_MT_SAFE {
+    _vl_sparse_lock();
+    VlSparseReset* resetp = _vl_sparse_find(datap);
+    if (resetp) {
+        s_sparseResets.erase(std::find(s_sparseResets.begin(), s_sparseResets.end(), resetp));
+        bytes = resetp->m_bytes;
+    }
+    _vl_sparse_unlock();
+    if (resetp) {
+        delete[] resetp->m_filledp;
+        delete resetp;
+    }
+#ifdef VL_HAVE_MMAP
+    if (datap) munmap(datap, bytes);
+#else
+    if (0 && bytes) {}
+    free(datap);
+#endif
+}
+
 //===========================================================================
 // Timescale conversion
 
@@ -2069,6 +2999,36 @@ void VL_TIMEFORMAT_IINI(int units, int precision, const std::string& suffix,
     VerilatedImp::timeFormatWidth(width);
 }
 
+//===========================================================================
+// VerilatedContext:: Methods
+
+VerilatedContext::VerilatedContext() VL_MT_SAFE
+    : m_time(0)
+    , m_gotFinish(false)
+    , m_errorCount(0)
+    , m_randSeed(Verilated::randSeed()) {}
+
+VerilatedContext::~VerilatedContext() VL_MT_SAFE {
+    if (Verilated::threadContextp() == this) Verilated::threadContextp(NULL);
+}
+
+void VerilatedContext::gotFinish(bool flag) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    m_gotFinish = flag;
+}
+void VerilatedContext::errorCount(int val) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    m_errorCount = val;
+}
+void VerilatedContext::errorCountInc() VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    ++m_errorCount;
+}
+void VerilatedContext::randSeed(int val) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    m_randSeed = val;
+}
+
 //===========================================================================
 // Verilated:: Methods
 
@@ -2077,9 +3037,11 @@ Verilated::ThreadLocal::ThreadLocal()
 #ifdef VL_THREADED
     t_mtaskId(0)
     , t_endOfEvalReqd(0)
+    , t_threadSlot(0)
     ,
 #endif
-    t_dpiScopep(NULL)
+    t_contextp(NULL)
+    , t_dpiScopep(NULL)
     , t_dpiFilename(0)
     , t_dpiLineno(0) {
 }
@@ -2104,6 +3066,10 @@ void Verilated::randReset(int val) VL_MT_SAFE {
     s_s.s_randReset = val;
 }
 void Verilated::randSeed(int val) VL_MT_SAFE {
+    if (VL_UNLIKELY(t_s.t_contextp)) {
+        t_s.t_contextp->randSeed(val);
+        return;
+    }
     VerilatedLockGuard lock(m_mutex);
     s_s.s_randSeed = val;
 }
@@ -2112,10 +3078,18 @@ void Verilated::calcUnusedSigs(bool flag) VL_MT_SAFE {
     s_s.s_calcUnusedSigs = flag;
 }
 void Verilated::errorCount(int val) VL_MT_SAFE {
+    if (VL_UNLIKELY(t_s.t_contextp)) {
+        t_s.t_contextp->errorCount(val);
+        return;
+    }
     VerilatedLockGuard lock(m_mutex);
     s_s.s_errorCount = val;
 }
 void Verilated::errorCountInc() VL_MT_SAFE {
+    if (VL_UNLIKELY(t_s.t_contextp)) {
+        t_s.t_contextp->errorCountInc();
+        return;
+    }
     VerilatedLockGuard lock(m_mutex);
     ++s_s.s_errorCount;
 }
@@ -2124,6 +3098,10 @@ void Verilated::errorLimit(int val) VL_MT_SAFE {
     s_s.s_errorLimit = val;
 }
 void Verilated::gotFinish(bool flag) VL_MT_SAFE {
+    if (VL_UNLIKELY(t_s.t_contextp)) {
+        t_s.t_contextp->gotFinish(flag);
+        return;
+    }
     VerilatedLockGuard lock(m_mutex);
     s_s.s_gotFinish = flag;
 }
@@ -2180,11 +3158,144 @@ void Verilated::profThreadsWindow(vluint64_t flag) VL_MT_SAFE {
     VerilatedLockGuard lock(m_mutex);
     s_ns.s_profThreadsWindow = flag;
 }
+void Verilated::profThreadsSample(vluint32_t flag) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    s_ns.s_profThreadsSample = flag;
+}
+void Verilated::profThreadsDumpReq(bool flag) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    s_ns.s_profThreadsDumpReq = flag;
+}
+void Verilated::profThreadsCounters(bool flag) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    s_ns.s_profThreadsCounters = flag;
+}
 void Verilated::profThreadsFilenamep(const char* flagp) VL_MT_SAFE {
     VerilatedLockGuard lock(m_mutex);
     if (s_ns.s_profThreadsFilenamep) free(const_cast<char*>(s_ns.s_profThreadsFilenamep));
     s_ns.s_profThreadsFilenamep = strdup(flagp);
 }
+void Verilated::profBlocksFilenamep(const char* flagp) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    if (s_ns.s_profBlocksFilenamep) free(const_cast<char*>(s_ns.s_profBlocksFilenamep));
+    s_ns.s_profBlocksFilenamep = strdup(flagp);
+}
+void Verilated::profBlocksDump(const vluint64_t* countsp, const char* const* namesp,
+                               size_t blocks) VL_MT_SAFE {
+    std::string filename;
+    {
+        VerilatedLockGuard lock(m_mutex);
+        filename = s_ns.s_profBlocksFilenamep;
+    }
+    VL_DEBUG_IF(VL_DBG_MSGF("+prof+blocks writing to '%s'\n", filename.c_str()););
+    FILE* fp = fopen(filename.c_str(), "w");
+    if (VL_UNLIKELY(!fp)) {
+        VL_FATAL_MT(filename.c_str(), 0, "", "+prof+blocks+file file not writable");
+        return;
+    }
+    fprintf(fp, "VLPROF blocks %" VL_PRI64 "u\n", static_cast<vluint64_t>(blocks));
+    for (size_t i = 0; i < blocks; ++i) {
+        fprintf(fp, "VLPROF block %" VL_PRI64 "u cycles %" VL_PRI64 "u calls %" VL_PRI64 "u %s\n",
+                static_cast<vluint64_t>(i), countsp[i * 2], countsp[i * 2 + 1], namesp[i]);
+    }
+    fclose(fp);
+}
+void Verilated::profEvalFilenamep(const char* flagp) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    if (s_ns.s_profEvalFilenamep) free(const_cast<char*>(s_ns.s_profEvalFilenamep));
+    s_ns.s_profEvalFilenamep = strdup(flagp);
+}
+VerilatedEvalStats* Verilated::evalStatsp() VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    return s_ns.s_evalStatsp;
+}
+void Verilated::evalStatsp(VerilatedEvalStats* statsp) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    s_ns.s_evalStatsp = statsp;
+}
+void Verilated::profEvalDump(VerilatedEvalStats* statsp) VL_MT_SAFE {
+    std::string filename;
+    {
+        VerilatedLockGuard lock(m_mutex);
+        filename = s_ns.s_profEvalFilenamep;
+        if (s_ns.s_evalStatsp == statsp) s_ns.s_evalStatsp = NULL;
+    }
+    VL_DEBUG_IF(VL_DBG_MSGF("+prof+eval writing to '%s'\n", filename.c_str()););
+    FILE* fp = fopen(filename.c_str(), "w");
+    if (VL_UNLIKELY(!fp)) {
+        VL_FATAL_MT(filename.c_str(), 0, "", "+prof+eval+file file not writable");
+        return;
+    }
+    fprintf(fp, "VLPROF eval evals %" VL_PRI64 "u\n", statsp->m_evals);
+    for (int i = 1; i <= VerilatedEvalStats::ITERATIONS_MAX; ++i) {
+        fprintf(fp, "VLPROF eval iterations %d%s count %" VL_PRI64 "u\n", i,
+                i == VerilatedEvalStats::ITERATIONS_MAX ? "+" : "", statsp->m_iterations[i]);
+    }
+    fprintf(fp, "VLPROF eval settle_iterations %" VL_PRI64 "u\n", statsp->m_settleIterations);
+    fprintf(fp, "VLPROF eval mtasks %" VL_PRI64 "u\n", statsp->m_mtasks);
+    for (size_t i = 0; i < statsp->m_domains; ++i) {
+        fprintf(fp, "VLPROF eval domain %" VL_PRI64 "u triggers %" VL_PRI64 "u %s\n",
+                static_cast<vluint64_t>(i), statsp->m_domainTriggersp[i],
+                statsp->m_domainNamesp[i]);
+    }
+    fclose(fp);
+}
+const char* VerilatedMemoryUsage::categoryName(Category cat) VL_PURE {
+    static const char* const names[]
+        = {"design state", "memories",  "delayed assignments", "change detection",
+           "temporaries",  "coverage",  "trace",               "other"};
+    return names[cat];
+}
+void VerilatedMemoryUsage::print() const VL_MT_SAFE {
+    for (int i = 0; i < CATEGORIES; ++i) {
+        VL_PRINTF_MT("  %-20s %14" VL_PRI64 "u bytes\n", categoryName(static_cast<Category>(i)),
+                     static_cast<vluint64_t>(m_bytes[i]));
+    }
+    VL_PRINTF_MT("  %-20s %14" VL_PRI64 "u bytes\n", "total",
+                 static_cast<vluint64_t>(total()));
+}
+void Verilated::profLiveFilenamep(const char* flagp) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    if (s_ns.s_profLiveFilenamep) free(const_cast<char*>(s_ns.s_profLiveFilenamep));
+    s_ns.s_profLiveFilenamep = strdup(flagp);
+}
+void Verilated::liveStatsp(VerilatedLiveStats* statsp) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    s_ns.s_liveStatsp = statsp;
+}
+void Verilated::profBranchesFilenamep(const char* flagp) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    if (s_ns.s_profBranchesFilenamep) free(const_cast<char*>(s_ns.s_profBranchesFilenamep));
+    s_ns.s_profBranchesFilenamep = strdup(flagp);
+}
+void Verilated::profBranchesDump(const vluint64_t* countsp, size_t branches) VL_MT_SAFE {
+    std::string filename;
+    {
+        VerilatedLockGuard lock(m_mutex);
+        filename = s_ns.s_profBranchesFilenamep;
+    }
+    VL_DEBUG_IF(VL_DBG_MSGF("+prof+branches writing to '%s'\n", filename.c_str()););
+    FILE* fp = fopen(filename.c_str(), "w");
+    if (VL_UNLIKELY(!fp)) {
+        VL_FATAL_MT(filename.c_str(), 0, "", "+prof+branches+file file not writable");
+        return;
+    }
+    fprintf(fp, "VLPROF branches %" VL_PRI64 "u\n", static_cast<vluint64_t>(branches));
+    for (size_t i = 0; i < branches; ++i) {
+        fprintf(fp, "VLPROF branch %" VL_PRI64 "u taken %" VL_PRI64 "u nottaken %" VL_PRI64 "u\n",
+                static_cast<vluint64_t>(i), countsp[i * 2], countsp[i * 2 + 1]);
+    }
+    fclose(fp);
+}
+void Verilated::threadsWait(int val) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    s_ns.s_threadsWait = val;
+}
+void Verilated::threadsAffinity(const char* cpulistp) VL_MT_SAFE {
+    VerilatedLockGuard lock(m_mutex);
+    if (s_ns.s_threadsAffinityp) free(const_cast<char*>(s_ns.s_threadsAffinityp));
+    s_ns.s_threadsAffinityp = strdup(cpulistp);
+}
 
 const char* Verilated::catName(const char* n1, const char* n2, const char* delimiter) VL_MT_SAFE {
     // Returns new'ed data
@@ -2222,6 +3333,11 @@ void Verilated::flushCall() VL_MT_SAFE {
     fflush(stdout);
 }
 
+void Verilated::timeEventAdd(vluint64_t time) VL_MT_SAFE { VerilatedImp::timeEventAdd(time); }
+vluint64_t Verilated::timeEventNext() VL_MT_SAFE {
+    return VerilatedImp::timeEventNext(VL_TIME_Q());
+}
+
 const char* Verilated::productName() VL_PURE { return VERILATOR_PRODUCT; }
 const char* Verilated::productVersion() VL_PURE { return VERILATOR_VERSION; }
 
@@ -2270,6 +3386,16 @@ void Verilated::quiesce() VL_MT_SAFE {
 #endif
 }
 
+int Verilated::snapshot() VL_MT_UNSAFE { return VerilatedImp::snapshot(); }
+void Verilated::rewind(int id, int value) VL_MT_UNSAFE { VerilatedImp::rewind(id, value); }
+int Verilated::rewindValue() VL_MT_UNSAFE { return VerilatedImp::rewindValue(); }
+void Verilated::snapshotCbAdd(VerilatedSnapshotCb cb, void* datap) VL_MT_SAFE {
+    VerilatedImp::snapshotCbAdd(cb, datap);
+}
+void Verilated::snapshotCbRemove(VerilatedSnapshotCb cb, void* datap) VL_MT_SAFE {
+    VerilatedImp::snapshotCbRemove(cb, datap);
+}
+
 void Verilated::internalsDump() VL_MT_SAFE { VerilatedImp::internalsDump(); }
 
 void Verilated::scopesDump() VL_MT_SAFE { VerilatedImp::scopesDump(); }
@@ -2286,6 +3412,55 @@ const VerilatedScopeNameMap* Verilated::scopeNameMap() VL_MT_SAFE {
     return VerilatedImp::scopeNameMap();
 }
 
+static bool vl_scope_match(const char* patternp, const char* namep) VL_PURE {
+    // '*' and '?' wildcard match, where '*' may also match across scopes
+    const char* starp = NULL;  // Last '*' seen
+    const char* resumep = NULL;  // Where in the name that '*' matches up to
+    while (*namep) {
+        if (*patternp == '*') {
+            starp = patternp++;
+            resumep = namep;
+        } else if (*patternp == '?' || *patternp == *namep) {
+            ++patternp;
+            ++namep;
+        } else if (starp) {
+            patternp = starp + 1;
+            namep = ++resumep;
+        } else {
+            return false;
+        }
+    }
+    while (*patternp == '*') ++patternp;
+    return !*patternp;
+}
+
+static int vl_scope_off(const char* patternp, int bit, bool flag) VL_MT_UNSAFE {
+    // Each scope with assertions or covers has a public variable of their
+    // disables, see V3Assert
+    int matches = 0;
+    const VerilatedScopeNameMap* mapp = VerilatedImp::scopeNameMap();
+    for (VerilatedScopeNameMap::const_iterator it = mapp->begin(); it != mapp->end(); ++it) {
+        const VerilatedScope* scopep = it->second;
+        if (!vl_scope_match(patternp, scopep->name())) continue;
+        const VerilatedVar* varp = scopep->varFind("__Vassert_off");
+        if (!varp) continue;
+        CData* offp = reinterpret_cast<CData*>(varp->datap());
+        if (flag) {
+            *offp &= ~(1U << bit);
+        } else {
+            *offp |= (1U << bit);
+        }
+        ++matches;
+    }
+    return matches;
+}
+int Verilated::assertScopeOn(const char* patternp, bool flag) VL_MT_UNSAFE {
+    return vl_scope_off(patternp, 0, flag);
+}
+int Verilated::coverScopeOn(const char* patternp, bool flag) VL_MT_UNSAFE {
+    return vl_scope_off(patternp, 1, flag);
+}
+
 #ifdef VL_THREADED
 void Verilated::endOfThreadMTaskGuts(VerilatedEvalMsgQueue* evalMsgQp) VL_MT_SAFE {
     VL_DEBUG_IF(VL_DBG_MSGF("End of thread mtask\n"););
@@ -2296,6 +3471,53 @@ void Verilated::endOfEvalGuts(VerilatedEvalMsgQueue* evalMsgQp) VL_MT_SAFE {
     VL_DEBUG_IF(VL_DBG_MSGF("End-of-eval cleanup\n"););
     evalMsgQp->process();
 }
+
+void VerilatedMsgChunk::run() const {
+    VL_DEBUG_IF(VL_DBG_MSGF("Executing messages from mtaskId=%d\n", m_mtaskId););
+    for (std::vector<Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        switch (it->m_kind) {
+        case PRINT:
+            VL_PRINTF("%.*s", static_cast<int>(it->m_length), m_text.data() + it->m_offset);
+            break;
+        case WRITE: {
+            FILE* fp = VL_CVT_I_FP(it->m_fd);
+            if (VL_LIKELY(fp)) fwrite(m_text.data() + it->m_offset, 1, it->m_length, fp);
+            break;
+        }
+        case FFLUSH: {
+            FILE* fp = VL_CVT_I_FP(it->m_fd);
+            if (VL_LIKELY(fp)) fflush(fp);
+            break;
+        }
+        case FCLOSE: {
+            FILE* fp = VL_CVT_I_FP(it->m_fd);
+            if (VL_UNLIKELY(!fp)) break;
+            fclose(fp);
+            VerilatedImp::fdDelete(it->m_fd);
+            break;
+        }
+        case CALLBACK: m_cbs[it->m_offset](); break;
+        }
+    }
+}
+
+void VerilatedEvalMsgQueue::process() {
+    VerilatedMsgChunk* listp = m_pendingp.exchange(NULL, std::memory_order_acquire);
+    if (VL_LIKELY(!listp)) return;
+    // The stack is newest first; chunks of the same mtask stay in posting order
+    m_sorted.clear();
+    for (VerilatedMsgChunk* chunkp = listp; chunkp; chunkp = chunkp->m_nextp) {
+        m_sorted.push_back(chunkp);
+    }
+    std::reverse(m_sorted.begin(), m_sorted.end());
+    std::stable_sort(m_sorted.begin(), m_sorted.end(), VerilatedMsgChunk::Cmp());
+    for (std::vector<VerilatedMsgChunk*>::const_iterator it = m_sorted.begin();
+         it != m_sorted.end(); ++it) {
+        (*it)->run();
+        (*it)->m_ownerp->recycle(*it);
+    }
+    m_sorted.clear();
+}
 #endif
 
 //===========================================================================
@@ -2367,8 +3589,24 @@ void VerilatedImp::commandArgVl(const std::string& arg) {
             Verilated::profThreadsStart(atoll(value.c_str()));
         } else if (commandArgVlValue(arg, "+verilator+prof+threads+window+", value /*ref*/)) {
             Verilated::profThreadsWindow(atol(value.c_str()));
+        } else if (commandArgVlValue(arg, "+verilator+prof+threads+counters+", value /*ref*/)) {
+            Verilated::profThreadsCounters(atoi(value.c_str()) != 0);
+        } else if (commandArgVlValue(arg, "+verilator+prof+threads+sample+", value /*ref*/)) {
+            Verilated::profThreadsSample(atol(value.c_str()));
         } else if (commandArgVlValue(arg, "+verilator+prof+threads+file+", value /*ref*/)) {
             Verilated::profThreadsFilenamep(value.c_str());
+        } else if (commandArgVlValue(arg, "+verilator+prof+blocks+file+", value /*ref*/)) {
+            Verilated::profBlocksFilenamep(value.c_str());
+        } else if (commandArgVlValue(arg, "+verilator+prof+eval+file+", value /*ref*/)) {
+            Verilated::profEvalFilenamep(value.c_str());
+        } else if (commandArgVlValue(arg, "+verilator+prof+live+file+", value /*ref*/)) {
+            Verilated::profLiveFilenamep(value.c_str());
+        } else if (commandArgVlValue(arg, "+verilator+prof+branches+file+", value /*ref*/)) {
+            Verilated::profBranchesFilenamep(value.c_str());
+        } else if (commandArgVlValue(arg, "+verilator+threads+affinity+", value /*ref*/)) {
+            Verilated::threadsAffinity(value.c_str());
+        } else if (commandArgVlValue(arg, "+verilator+threads+wait+", value /*ref*/)) {
+            Verilated::threadsWait(atoi(value.c_str()));
         } else if (commandArgVlValue(arg, "+verilator+rand+reset+", value /*ref*/)) {
             Verilated::randReset(atoi(value.c_str()));
         } else if (commandArgVlValue(arg, "+verilator+seed+", value /*ref*/)) {
@@ -2399,6 +3637,158 @@ bool VerilatedImp::commandArgVlValue(const std::string& arg, const std::string&
     }
 }
 
+//======================================================================
+// VerilatedImp:: Snapshots
+//
+// Each snapshot is a fork()ed copy of the process, frozen waiting for its
+// child, which continues the simulation, to exit.  The child may take more
+// snapshots, so the frozen processes form a chain of parents.  rewind()
+// sends a command byte down the pipe to each snapshot it discards and to
+// the one it continues from, then exits; as each frozen process sees its
+// child exit, it reads its command, and either exits too, or forks a new
+// child continuing from the snapshot.  If the child exits without a
+// command, the simulation is over, and the frozen processes exit the same
+// way, so the original process ends with the simulation's status.
+
+void VerilatedImp::snapshotCbAdd(VerilatedSnapshotCb cb, void* datap) VL_MT_SAFE {
+    VerilatedLockGuard lock(s_s.m_snapCbMutex);
+    s_s.m_snapCbs.push_back(std::make_pair(cb, datap));
+}
+void VerilatedImp::snapshotCbRemove(VerilatedSnapshotCb cb, void* datap) VL_MT_SAFE {
+    VerilatedLockGuard lock(s_s.m_snapCbMutex);
+    SnapshotCbs::iterator it
+        = std::find(s_s.m_snapCbs.begin(), s_s.m_snapCbs.end(), std::make_pair(cb, datap));
+    if (it != s_s.m_snapCbs.end()) s_s.m_snapCbs.erase(it);
+}
+void VerilatedImp::snapshotCall(const SnapshotCbs& cbs, bool after) {
+    // Threads are stopped in reverse order of creation, and restarted in order
+    if (after) {
+        for (SnapshotCbs::const_iterator it = cbs.begin(); it != cbs.end(); ++it) {
+            (*it->first)(it->second, true);
+        }
+    } else {
+        for (SnapshotCbs::const_reverse_iterator it = cbs.rbegin(); it != cbs.rend(); ++it) {
+            (*it->first)(it->second, false);
+        }
+    }
+}
+
+#if defined(_WIN32) || defined(__MINGW32__)
+int VerilatedImp::snapshot() VL_MT_UNSAFE {
+    VL_FATAL_MT("", 0, "", "Verilated::snapshot is not supported on this platform");
+    return 0;
+}
+void VerilatedImp::rewind(int, int) VL_MT_UNSAFE {
+    VL_FATAL_MT("", 0, "", "Verilated::rewind is not supported on this platform");
+    abort();
+}
+#else
+int VerilatedImp::snapshot() VL_MT_UNSAFE {
+    // Flush output, so neither process repeats it, and note where each
+    // $fopen file was, to go back there on a rewind
+    Verilated::flushCall();
+    std::vector<std::pair<FILE*, off_t> > files;
+    {
+        VerilatedLockGuard lock(s_s.m_fdMutex);
+        for (size_t i = 3; i < s_s.m_fdps.size(); ++i) {
+            FILE* fp = s_s.m_fdps[i];
+            if (!fp) continue;
+            fflush(fp);
+            const off_t pos = ftello(fp);
+            if (pos >= 0) files.push_back(std::make_pair(fp, pos));
+        }
+    }
+    SnapshotCbs cbs;
+    {
+        VerilatedLockGuard lock(s_s.m_snapCbMutex);
+        cbs = s_s.m_snapCbs;
+    }
+    int fds[2];
+    if (VL_UNLIKELY(pipe(fds))) {
+        const std::string msg = std::string("Verilated::snapshot: pipe: ") + strerror(errno);
+        VL_FATAL_MT("", 0, "", msg.c_str());
+        return 0;
+    }
+    // Commands are read only once the child has exited, so never wait
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    const int id = ++s_s.m_snapNext;
+    s_s.m_snaps.push_back(Snapshot(id, fds[1]));
+
+    // fork() copies only the calling thread, so stop the others first
+    snapshotCall(cbs, false);
+    pid_t pid = fork();
+    if (VL_UNLIKELY(pid < 0)) {
+        const int err = errno;
+        snapshotCall(cbs, true);
+        s_s.m_snaps.pop_back();
+        close(fds[0]);
+        close(fds[1]);
+        const std::string msg = std::string("Verilated::snapshot: fork: ") + strerror(err);
+        VL_FATAL_MT("", 0, "", msg.c_str());
+        return 0;
+    }
+    bool rewound = false;
+    while (pid > 0) {
+        // Frozen; _exit as the simulation already ran its exit handlers
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        char cmd[1 + sizeof(int)];
+        if (read(fds[0], cmd, sizeof(cmd)) < 1) cmd[0] = 0;
+        if (cmd[0] == 'R') {
+            rewound = true;
+            memcpy(&s_s.m_rewindValue, cmd + 1, sizeof(int));
+            pid = fork();
+            if (VL_UNLIKELY(pid < 0)) {
+                VL_PRINTF_MT("%%Error: Verilated::rewind: fork: %s\n", strerror(errno));
+                _exit(1);
+            }
+        } else if (cmd[0] == 'Q') {
+            _exit(0);
+        } else if (WIFSIGNALED(status)) {
+            signal(WTERMSIG(status), SIG_DFL);
+            raise(WTERMSIG(status));
+            _exit(1);
+        } else {
+            _exit(WIFEXITED(status) ? WEXITSTATUS(status) : 1);
+        }
+    }
+    close(fds[0]);
+    snapshotCall(cbs, true);
+    if (!rewound) return id;
+    for (size_t i = 0; i < files.size(); ++i) {
+        // Also drop what was written after the snapshot, if only written
+        FILE* fp = files[i].first;
+        fseeko(fp, files[i].second, SEEK_SET);
+        const int flags = fcntl(fileno(fp), F_GETFL);
+        if (flags >= 0 && (flags & O_ACCMODE) == O_WRONLY) {
+            if (ftruncate(fileno(fp), files[i].second)) {}
+        }
+    }
+    return -id;
+}
+
+void VerilatedImp::rewind(int id, int value) VL_MT_UNSAFE {
+    size_t i = 0;
+    while (i < s_s.m_snaps.size() && s_s.m_snaps[i].m_id != id) ++i;
+    if (VL_UNLIKELY(i == s_s.m_snaps.size())) {
+        std::ostringstream msg;
+        msg << "Verilated::rewind: No snapshot " << id << " to rewind to";
+        VL_FATAL_MT("", 0, "", msg.str().c_str());
+        abort();
+    }
+    Verilated::flushCall();
+    for (size_t later = i + 1; later < s_s.m_snaps.size(); ++later) {
+        if (write(s_s.m_snaps[later].m_fd, "Q", 1) != 1) {}
+    }
+    // Pipe writes this small are atomic, so the value arrives with the command
+    char cmd[1 + sizeof(int)];
+    cmd[0] = 'R';
+    memcpy(cmd + 1, &value, sizeof(int));
+    if (write(s_s.m_snaps[i].m_fd, cmd, sizeof(cmd)) != sizeof(cmd)) {}
+    _exit(0);
+}
+#endif
+
 //======================================================================
 // VerilatedSyms:: Methods
 
@@ -2408,6 +3798,7 @@ VerilatedSyms::VerilatedSyms() {
 #endif
 }
 VerilatedSyms::~VerilatedSyms() {
+    VerilatedImp::varsUndefer(this);
 #ifdef VL_THREADED
     delete __Vm_evalMsgQp;
 #endif
@@ -2553,10 +3944,29 @@ void VerilatedScope::varInsert(int finalize, const char* namep, void* datap,
     va_end(ap);
 
     m_varsp->insert(std::make_pair(namep, var));
+    VerilatedImp::scopeVarsChanged();
+}
+
+void VerilatedScope::varChangeFlag(int finalize, const char* namep,
+                                   CData* changep) VL_MT_UNSAFE {
+    if (!finalize || !m_varsp) return;
+    // Not varFind, as this may be called while inserting deferred variables
+    VerilatedVarNameMap::iterator it = m_varsp->find(namep);
+    if (it != m_varsp->end()) it->second.m_changep = changep;
+}
+
+void VerilatedScope::varsDefer(VerilatedSyms* symsp, VarsCb cb) VL_MT_SAFE {
+    VerilatedImp::varsDefer(symsp, cb);
+}
+
+VerilatedVarNameMap* VerilatedScope::varsp() const VL_MT_SAFE_POSTINIT {
+    VerilatedImp::varsRealize();
+    return m_varsp;
 }
 
 // cppcheck-suppress unusedFunction  // Used by applications
 VerilatedVar* VerilatedScope::varFind(const char* namep) const VL_MT_SAFE_POSTINIT {
+    VerilatedImp::varsRealize();
     if (VL_LIKELY(m_varsp)) {
         VerilatedVarNameMap::iterator it = m_varsp->find(namep);
         if (VL_LIKELY(it != m_varsp->end())) return &(it->second);
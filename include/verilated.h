@@ -25,6 +25,7 @@
 
 // clang-format off
 #include "verilatedos.h"
+#include "verilated_intrinsics.h"
 #if VM_SC
 # include "verilated_sc.h"  // Get SYSTEMC_VERSION and time declarations
 #endif
@@ -85,11 +86,15 @@ typedef const WData* WDataInP;  ///< Array input to a function
 typedef WData* WDataOutP;  ///< Array output from a function
 
 typedef void (*VerilatedVoidCb)(void);
+/// Called around snapshot forks, see Verilated::snapshotCbAdd
+typedef void (*VerilatedSnapshotCb)(void* datap, bool after);
 
 class SpTraceVcd;
 class SpTraceVcdCFile;
 class VerilatedEvalMsgQueue;
+class VerilatedLiveStats;
 class VerilatedScopeNameMap;
+class VerilatedTraceBuffer;
 class VerilatedVar;
 class VerilatedVarNameMap;
 class VerilatedVcd;
@@ -334,6 +339,7 @@ private:
     Type m_type;  ///< Type of the scope
 
 public:  // But internals only - called from VerilatedModule's
+    typedef void (*VarsCb)(VerilatedSyms* symsp);  ///< Calls varInsert for a model
     VerilatedScope();
     ~VerilatedScope();
     void configure(VerilatedSyms* symsp, const char* prefixp, const char* suffixp,
@@ -341,13 +347,17 @@ public:  // But internals only - called from VerilatedModule's
     void exportInsert(int finalize, const char* namep, void* cb) VL_MT_UNSAFE;
     void varInsert(int finalize, const char* namep, void* datap, VerilatedVarType vltype,
                    int vlflags, int dims, ...) VL_MT_UNSAFE;
+    /// Set flag the model sets on writes of a variable, see --vpi-change-hooks
+    void varChangeFlag(int finalize, const char* namep, CData* changep) VL_MT_UNSAFE;
+    /// Have the varInsert's for a model run at its first variable lookup
+    static void varsDefer(VerilatedSyms* symsp, VarsCb cb) VL_MT_SAFE;
     // ACCESSORS
     const char* name() const { return m_namep; }
     const char* identifier() const { return m_identifierp; }
     vlsint8_t timeunit() const { return m_timeunit; }
     inline VerilatedSyms* symsp() const { return m_symsp; }
     VerilatedVar* varFind(const char* namep) const VL_MT_SAFE_POSTINIT;
-    VerilatedVarNameMap* varsp() const VL_MT_SAFE_POSTINIT { return m_varsp; }
+    VerilatedVarNameMap* varsp() const VL_MT_SAFE_POSTINIT;
     void scopeDump() const;
     void* exportFindError(int funcnum) const;
     static void* exportFindNullError(int funcnum) VL_MT_SAFE;
@@ -368,6 +378,133 @@ public:
     void add(VerilatedScope* fromp, VerilatedScope* top);
 };
 
+//===========================================================================
+/// Evaluation loop counters of a model built with --prof-eval
+
+class VerilatedEvalStats {
+public:
+    enum { ITERATIONS_MAX = 16 };  ///< Last histogram bucket, counts this many or more
+    // MEMBERS
+    vluint64_t m_evals;  ///< Calls to eval()
+    vluint64_t m_iterations[ITERATIONS_MAX + 1];  ///< Evals by change loop iterations
+    vluint64_t m_settleIterations;  ///< Iterations of the initial settle loop
+    vluint64_t m_mtasks;  ///< MTasks run, with --threads
+    size_t m_domains;  ///< Number of clock domains counted
+    const char* const* m_domainNamesp;  ///< Sensitivity of each domain
+    vluint64_t* m_domainTriggersp;  ///< Times logic under each domain was triggered
+    // CONSTRUCTORS
+    VerilatedEvalStats()
+        : m_domains(0)
+        , m_domainNamesp(NULL)
+        , m_domainTriggersp(NULL) {
+        clear();
+    }
+    // METHODS
+    /// Zero all counts, e.g. after a warmup period
+    void clear() {
+        m_evals = 0;
+        for (int i = 0; i <= ITERATIONS_MAX; ++i) m_iterations[i] = 0;
+        m_settleIterations = 0;
+        m_mtasks = 0;
+        for (size_t i = 0; i < m_domains; ++i) m_domainTriggersp[i] = 0;
+    }
+    /// Count an eval() that needed the given change loop iterations
+    void countEval(int iterations) {
+        ++m_evals;
+        ++m_iterations[iterations < ITERATIONS_MAX ? iterations : ITERATIONS_MAX];
+    }
+};
+
+//===========================================================================
+/// Bytes of memory used by models and trace files, by category, as
+/// collected by a model's memoryUsage() and a trace file's memoryUsage().
+/// Strings, queues and associative arrays count only their fixed part.
+
+class VerilatedMemoryUsage {
+public:
+    enum Category {
+        DESIGN,  ///< Signals and variables of the design
+        MEMORIES,  ///< Unpacked arrays
+        DELAYED,  ///< __Vdly temporaries for non-blocking assignments
+        CHANGE_DETECT,  ///< Previous values for change and edge detection
+        TEMPS,  ///< Other temporaries created by Verilator
+        COVERAGE,  ///< Coverage counters
+        TRACE,  ///< Previous values and buffers of trace files
+        OTHER,  ///< Symbol table, scopes and padding
+        CATEGORIES
+    };
+
+private:
+    size_t m_bytes[CATEGORIES];
+
+public:
+    // CONSTRUCTORS
+    VerilatedMemoryUsage() { clear(); }
+    // METHODS
+    void clear() {
+        for (int i = 0; i < CATEGORIES; ++i) m_bytes[i] = 0;
+    }
+    void add(Category cat, size_t bytes) { m_bytes[cat] += bytes; }
+    void add(const VerilatedMemoryUsage& other) {
+        for (int i = 0; i < CATEGORIES; ++i) m_bytes[i] += other.m_bytes[i];
+    }
+    size_t bytes(Category cat) const { return m_bytes[cat]; }
+    size_t total() const {
+        size_t bytes = 0;
+        for (int i = 0; i < CATEGORIES; ++i) bytes += m_bytes[i];
+        return bytes;
+    }
+    /// Name of a category, for printing
+    static const char* categoryName(Category cat) VL_PURE;
+    /// Print the bytes of each category
+    void print() const VL_MT_SAFE;
+};
+
+//===========================================================================
+/// State of one simulation, so independent models may run in one process.
+/// A model given a context with its contextp() method keeps its time,
+/// $finish, error count and random seed there, rather than in the
+/// process-wide state, so models on different threads neither share nor
+/// contend on them.  Verilated's accessors of this state reach the context
+/// of the model that last evaluated on the calling thread, if any.
+
+class VerilatedContext {
+    // MEMBERS
+    VerilatedMutex m_mutex;  ///< Mutex for slow path members, when VL_THREADED
+    // Fast path
+    vluint64_t m_time;  ///< Simulation time, in time precision units
+    bool m_gotFinish;  ///< A $finish statement executed
+    // Slow path
+    int m_errorCount;  ///< Number of errors
+    int m_randSeed;  ///< Random seed: 0=random
+
+    VL_UNCOPYABLE(VerilatedContext);
+
+public:
+    // CONSTRUCTORS
+    /// The random seed starts as Verilated::randSeed()
+    VerilatedContext() VL_MT_SAFE;
+    /// Also stops the calling thread using this context, see
+    /// Verilated::threadContextp()
+    ~VerilatedContext() VL_MT_SAFE;
+    // METHODS
+    /// Simulation time $time returns, instead of sc_time_stamp(), in models
+    /// not built for SystemC or VL_TIME_STAMP64.  Set only between evals.
+    vluint64_t time() const VL_MT_SAFE { return m_time; }
+    void time(vluint64_t value) VL_MT_SAFE { m_time = value; }
+    void timeInc(vluint64_t add) VL_MT_SAFE { m_time += add; }
+    /// Did the simulation $finish?
+    bool gotFinish() const VL_MT_SAFE { return m_gotFinish; }
+    void gotFinish(bool flag) VL_MT_SAFE;
+    /// Current number of errors/assertions
+    int errorCount() const VL_MT_SAFE { return m_errorCount; }
+    void errorCount(int val) VL_MT_SAFE;
+    void errorCountInc() VL_MT_SAFE;
+    /// Random seed of the threads evaluating the models, set before the first eval
+    int randSeed() const VL_MT_SAFE { return m_randSeed; }
+    void randSeed(int val) VL_MT_SAFE;
+};
+
 //===========================================================================
 /// Verilator global static information class
 
@@ -401,8 +538,19 @@ class Verilated {
         // Fast path
         vluint64_t s_profThreadsStart;  ///< +prof+threads starting time
         vluint32_t s_profThreadsWindow;  ///< +prof+threads window size
+        vluint32_t s_profThreadsSample;  ///< +prof+threads sample interval, 0=window mode
+        bool s_profThreadsDumpReq;  ///< Dump sampled profile at next eval
+        bool s_profThreadsCounters;  ///< +prof+threads record hardware counters
+        int s_threadsWait;  ///< +threads+wait policy, see threadsWait()
+        VerilatedLiveStats* s_liveStatsp;  ///< --prof-live statistics, or NULL
         // Slow path
+        const char* s_profBlocksFilenamep;  ///< +prof+blocks filename
+        const char* s_profEvalFilenamep;  ///< +prof+eval filename
+        VerilatedEvalStats* s_evalStatsp;  ///< Last created --prof-eval model's counters
+        const char* s_profLiveFilenamep;  ///< +prof+live filename
+        const char* s_profBranchesFilenamep;  ///< +prof+branches filename
         const char* s_profThreadsFilenamep;  ///< +prof+threads filename
+        const char* s_threadsAffinityp;  ///< +threads+affinity CPU list, or NULL
         NonSerialized();
         ~NonSerialized();
     } s_ns;
@@ -424,7 +572,9 @@ class Verilated {
 #ifdef VL_THREADED
         vluint32_t t_mtaskId;  ///< Current mtask# executing on this thread
         vluint32_t t_endOfEvalReqd;  ///< Messages may be pending, thread needs endOf-eval calls
+        vluint32_t t_threadSlot;  ///< 1 + index of thread pool worker, or 0 for other threads
 #endif
+        VerilatedContext* t_contextp;  ///< Context of the model last evaluated, or NULL
         const VerilatedScope* t_dpiScopep;  ///< DPI context scope
         const char* t_dpiFilename;  ///< DPI context filename
         int t_dpiLineno;  ///< DPI context line number
@@ -448,7 +598,9 @@ public:
     static void randReset(int val) VL_MT_SAFE;
     static int randReset() VL_MT_SAFE { return s_s.s_randReset; }  ///< Return randReset value
     static void randSeed(int val) VL_MT_SAFE;
-    static int randSeed() VL_MT_SAFE { return s_s.s_randSeed; }  ///< Return randSeed value
+    static int randSeed() VL_MT_SAFE {  ///< Return randSeed value
+        return VL_UNLIKELY(t_s.t_contextp) ? t_s.t_contextp->randSeed() : s_s.s_randSeed;
+    }
 
     /// Enable debug of internal verilated code
     static void debug(int level) VL_MT_SAFE;
@@ -469,13 +621,17 @@ public:
     /// Current number of errors/assertions
     static void errorCount(int val) VL_MT_SAFE;
     static void errorCountInc() VL_MT_SAFE;
-    static int errorCount() VL_MT_SAFE { return s_s.s_errorCount; }
+    static int errorCount() VL_MT_SAFE {
+        return VL_UNLIKELY(t_s.t_contextp) ? t_s.t_contextp->errorCount() : s_s.s_errorCount;
+    }
     /// Set number of errors/assertions before stop
     static void errorLimit(int val) VL_MT_SAFE;
     static int errorLimit() VL_MT_SAFE { return s_s.s_errorLimit; }
     /// Did the simulation $finish?
     static void gotFinish(bool flag) VL_MT_SAFE;
-    static bool gotFinish() VL_MT_SAFE { return s_s.s_gotFinish; }  ///< Return if got a $finish
+    static bool gotFinish() VL_MT_SAFE {  ///< Return if got a $finish
+        return VL_UNLIKELY(t_s.t_contextp) ? t_s.t_contextp->gotFinish() : s_s.s_gotFinish;
+    }
     /// Allow traces to at some point be enabled (disables some optimizations)
     static void traceEverOn(bool flag) VL_MT_SAFE {
         if (flag) { calcUnusedSigs(flag); }
@@ -483,6 +639,12 @@ public:
     /// Enable/disable assertions
     static void assertOn(bool flag) VL_MT_SAFE;
     static bool assertOn() VL_MT_SAFE { return s_s.s_assertOn; }
+    /// Enable/disable assertions in scopes matching a '*' and '?' pattern,
+    /// e.g. "top.cpu.*", when Verilated with --assert-scopes.  Returns the
+    /// number of scopes matched.
+    static int assertScopeOn(const char* patternp, bool flag) VL_MT_UNSAFE;
+    /// Enable/disable cover statements in scopes matching a pattern, as above
+    static int coverScopeOn(const char* patternp, bool flag) VL_MT_UNSAFE;
     /// Enable/disable vpi fatal
     static void fatalOnVpiError(bool flag) VL_MT_SAFE;
     static bool fatalOnVpiError() VL_MT_SAFE { return s_s.s_fatalOnVpiError; }
@@ -498,8 +660,65 @@ public:
     static vluint64_t profThreadsStart() VL_MT_SAFE { return s_ns.s_profThreadsStart; }
     static void profThreadsWindow(vluint64_t flag) VL_MT_SAFE;
     static vluint32_t profThreadsWindow() VL_MT_SAFE { return s_ns.s_profThreadsWindow; }
+    /// Profile every Nth eval() continuously into a bounded buffer,
+    /// rather than a single window; 0 = window mode, the default
+    static void profThreadsSample(vluint32_t flag) VL_MT_SAFE;
+    static vluint32_t profThreadsSample() VL_MT_SAFE { return s_ns.s_profThreadsSample; }
+    /// Request the sampled profile be written out at the next eval()
+    static void profThreadsDumpReq(bool flag) VL_MT_SAFE;
+    static bool profThreadsDumpReq() VL_MT_SAFE { return s_ns.s_profThreadsDumpReq; }
+    /// Record hardware performance counters with each profiled mtask
+    static void profThreadsCounters(bool flag) VL_MT_SAFE;
+    static bool profThreadsCounters() VL_MT_SAFE { return s_ns.s_profThreadsCounters; }
     static void profThreadsFilenamep(const char* flagp) VL_MT_SAFE;
     static const char* profThreadsFilenamep() VL_MT_SAFE { return s_ns.s_profThreadsFilenamep; }
+    static void profBlocksFilenamep(const char* flagp) VL_MT_SAFE;
+    static const char* profBlocksFilenamep() VL_MT_SAFE { return s_ns.s_profBlocksFilenamep; }
+    /// Write --prof-blocks cycles and calls for each block
+    static void profBlocksDump(const vluint64_t* countsp, const char* const* namesp,
+                               size_t blocks) VL_MT_SAFE;
+    static void profEvalFilenamep(const char* flagp) VL_MT_SAFE;
+    static const char* profEvalFilenamep() VL_MT_SAFE { return s_ns.s_profEvalFilenamep; }
+    /// Evaluation loop counters of the last created model built with
+    /// --prof-eval, or NULL
+    static VerilatedEvalStats* evalStatsp() VL_MT_SAFE;
+    static void evalStatsp(VerilatedEvalStats* statsp) VL_MT_SAFE;  ///< Internal
+    /// Write --prof-eval counters, and stop returning them from evalStatsp()
+    static void profEvalDump(VerilatedEvalStats* statsp) VL_MT_SAFE;
+    static void profLiveFilenamep(const char* flagp) VL_MT_SAFE;
+    static const char* profLiveFilenamep() VL_MT_SAFE { return s_ns.s_profLiveFilenamep; }
+    /// Live statistics of models built with --prof-live, or NULL.  Read
+    /// without a lock as it is checked on every eval; set only as the first
+    /// such model is created and the last deleted.
+    static VerilatedLiveStats* liveStatsp() VL_MT_SAFE { return s_ns.s_liveStatsp; }
+    static void liveStatsp(VerilatedLiveStats* statsp) VL_MT_SAFE;  ///< Internal
+    static void profBranchesFilenamep(const char* flagp) VL_MT_SAFE;
+    static const char* profBranchesFilenamep() VL_MT_SAFE {
+        return s_ns.s_profBranchesFilenamep;
+    }
+    /// Write --prof-branches counts, taken and not taken for each branch
+    static void profBranchesDump(const vluint64_t* countsp, size_t branches) VL_MT_SAFE;
+    /// Select how --threads models wait for mtasks on other threads
+    ////
+    /// 0 = Spin using the CPU pause instruction, never giving up the CPU
+    /// 1 = Spin for a while, then yield the CPU between spins (default)
+    /// 2 = Spin for a while, then sleep until the mtask is done
+    static void threadsWait(int val) VL_MT_SAFE;
+    static int threadsWait() VL_MT_SAFE { return s_ns.s_threadsWait; }
+    /// Pin --threads worker threads to CPUs, e.g. "0-3,8".  Worker N
+    /// runs on the Nth CPU of the list, wrapping around.  Empty for no
+    /// pinning, the default.  Must be set before the model is constructed.
+    static void threadsAffinity(const char* cpulistp) VL_MT_SAFE;
+    static const char* threadsAffinity() VL_MT_SAFE {
+        return s_ns.s_threadsAffinityp ? s_ns.s_threadsAffinityp : "";
+    }
+
+    /// Register a time an idle testbench must not skip past, see the
+    /// model's nextTimeSlot().  Each time is reported once.
+    static void timeEventAdd(vluint64_t time) VL_MT_SAFE;
+    /// Earliest registered time after the current time, or ~0 if none;
+    /// forgets the times already reached
+    static vluint64_t timeEventNext() VL_MT_SAFE;
 
     /// Flush callback for VCD waves
     static void flushCb(VerilatedVoidCb cb) VL_MT_SAFE;
@@ -524,6 +743,22 @@ public:
     /// Convenience OS utilities
     static void mkdir(const char* dirname) VL_MT_UNSAFE;
 
+    /// Snapshot the simulation by keeping a frozen fork() of the process
+    /// (POSIX only).  Returns the snapshot's identifier, which is > 0.
+    /// After a later rewind() to this snapshot, returns again with the
+    /// identifier negated.  Call only between evals, from the eval thread.
+    static int snapshot() VL_MT_UNSAFE;
+    /// Continue from snapshot 'id' taken by this process or its ancestors,
+    /// ending this process and discarding snapshots taken after 'id'.
+    /// 'value' is passed to the continuing process, see rewindValue().
+    static void rewind(int id, int value = 0) VL_ATTR_NORETURN VL_MT_UNSAFE;
+    /// Value passed to the rewind() that continued this process, else 0
+    static int rewindValue() VL_MT_UNSAFE;
+    /// Internal: Register a callback called with 'after' false before each
+    /// snapshot fork, to stop threads, and true in the continuing process
+    static void snapshotCbAdd(VerilatedSnapshotCb cb, void* datap) VL_MT_SAFE;
+    static void snapshotCbRemove(VerilatedSnapshotCb cb, void* datap) VL_MT_SAFE;
+
     /// When multithreaded, quiesce the model to prepare for trace/saves/coverage
     /// This may only be called when no locks are held.
     static void quiesce() VL_MT_SAFE;
@@ -552,6 +787,12 @@ public:
     static const VerilatedScope* scopeFind(const char* namep) VL_MT_SAFE;
     static const VerilatedScopeNameMap* scopeNameMap() VL_MT_SAFE;
 
+    // Internal: Get and set the context of the model evaluating on this thread
+    static VerilatedContext* threadContextp() VL_MT_SAFE { return t_s.t_contextp; }
+    static void threadContextp(VerilatedContext* contextp) VL_MT_SAFE {
+        t_s.t_contextp = contextp;
+    }
+
     // Internal: Get and set DPI context
     static const VerilatedScope* dpiScope() VL_MT_SAFE { return t_s.t_dpiScopep; }
     static void dpiScope(const VerilatedScope* scopep) VL_MT_SAFE { t_s.t_dpiScopep = scopep; }
@@ -575,6 +816,10 @@ public:
     /// Set the mtaskId, called when an mtask starts
     static void mtaskId(vluint32_t id) VL_MT_SAFE { t_s.t_mtaskId = id; }
     static vluint32_t mtaskId() VL_MT_SAFE { return t_s.t_mtaskId; }
+    /// Set the thread slot, called when a thread pool worker starts
+    static void threadSlot(vluint32_t slot) VL_MT_SAFE { t_s.t_threadSlot = slot; }
+    /// Slot of the executing thread in per-thread data, see --coverage-per-thread
+    static vluint32_t threadSlot() VL_MT_SAFE { return t_s.t_threadSlot; }
     static void endOfEvalReqdInc() VL_MT_SAFE { ++t_s.t_endOfEvalReqd; }
     static void endOfEvalReqdDec() VL_MT_SAFE { --t_s.t_endOfEvalReqd; }
 
@@ -652,6 +897,8 @@ extern WDataOutP VL_RANDOM_W(int obits, WDataOutP outwp);  ///< Randomize a sign
 extern IData VL_RAND_RESET_I(int obits);  ///< Random reset a signal
 extern QData VL_RAND_RESET_Q(int obits);  ///< Random reset a signal
 extern WDataOutP VL_RAND_RESET_W(int obits, WDataOutP outwp);  ///< Random reset a signal
+/// Random reset an array of rows, obits wide, stored contiguously
+extern void VL_RAND_RESET_N(int obits, size_t rows, void* datap);
 /// Zero reset a signal (slow - else use VL_ZERO_W)
 extern WDataOutP VL_ZERO_RESET_W(int obits, WDataOutP outwp);
 
@@ -669,6 +916,10 @@ extern void VL_PRINTTIMESCALE(const char* namep, const char* timeunitp) VL_MT_SA
 /// Math
 extern WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp,
                               bool is_modulus);
+#ifdef VL_HAVE_LIMB64
+extern WDataOutP _vl_mul_karatsuba_w(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp,
+                                     int limbs);
+#endif
 
 /// File I/O
 extern IData VL_FGETS_IXI(int obits, void* destp, IData fpi);
@@ -681,6 +932,7 @@ inline IData VL_FOPEN_II(IData filename, IData mode) VL_MT_SAFE {
 }
 
 extern void VL_FCLOSE_I(IData fdi);
+extern void VL_FFLUSH_I(IData fdi);
 
 extern IData VL_FREAD_I(int width, int array_lsb, int array_size, void* memp, IData fpi,
                         IData start, IData count);
@@ -739,6 +991,27 @@ extern const char* vl_mc_scan_plusargs(const char* prefixp);  // PLIish
 /// Return FILE* from IData
 extern FILE* VL_CVT_I_FP(IData lhs);
 
+/// Count a branch condition for --prof-branches, and return it
+/// Not atomic; with --threads counts are approximate
+static inline bool VL_PROF_BRANCH(vluint64_t* countsp, bool cond) VL_MT_UNSAFE {
+    ++countsp[cond ? 0 : 1];
+    return cond;
+}
+
+/// Time a block for --prof-blocks; countsp[0] accumulates cycles, countsp[1] calls
+/// Not atomic; with --threads a block only runs on one thread at a time
+static inline void VL_PROF_BLOCK_START(vluint64_t* countsp) VL_MT_UNSAFE {
+    vluint64_t val;
+    VL_RDTSC(val);
+    countsp[0] -= val;
+}
+static inline void VL_PROF_BLOCK_END(vluint64_t* countsp) VL_MT_UNSAFE {
+    vluint64_t val;
+    VL_RDTSC(val);
+    countsp[0] += val;
+    ++countsp[1];
+}
+
 // clang-format off
 // Use a union to avoid cast-to-different-size warnings
 /// Return void* from QData
@@ -835,7 +1108,10 @@ inline vluint64_t vl_time_stamp64() { return static_cast<vluint64_t>(sc_time_sta
 extern vluint64_t vl_time_stamp64();
 # else
 extern double sc_time_stamp();  // Verilator 4.032 and newer
-inline vluint64_t vl_time_stamp64() { return static_cast<vluint64_t>(sc_time_stamp()); }
+inline vluint64_t vl_time_stamp64() {
+    if (const VerilatedContext* contextp = Verilated::threadContextp()) return contextp->time();
+    return static_cast<vluint64_t>(sc_time_stamp());
+}
 # endif
 #endif
 
@@ -974,10 +1250,11 @@ static inline void VL_ASSIGNBIT_WO(int, int bit, WDataOutP owp, IData) VL_MT_SAF
                 | (svar).read().get_word(0)) \
                & VL_MASK_Q(obits); \
     }
+// sc_bv words have the layout of WData, so copy them directly
 #define VL_ASSIGN_WSW(obits, owp, svar) \
     { \
         int words = VL_WORDS_I(obits); \
-        for (int i = 0; i < words; ++i) (owp)[i] = (svar).read().get_word(i); \
+        memcpy((owp), VL_SC_BV_DATAP((svar).read()), words * sizeof(EData)); \
         (owp)[words - 1] &= VL_MASK_E(obits); \
     }
 
@@ -986,15 +1263,34 @@ static inline void VL_ASSIGNBIT_WO(int, int bit, WDataOutP owp, IData) VL_MT_SAF
 #define VL_ASSIGN_QSU(obits, vvar, svar) \
     { (vvar) = VL_CLEAN_QQ((obits), (obits), (svar).read().to_uint64()); }
 #define VL_ASSIGN_WSB(obits, owp, svar) \
+    { VL_SC_DIGITS_TO_W((obits), (owp), (svar).read().get_raw(), BITS_PER_DIGIT); }
+
+/// Pack the digits of a sc_biguint, each of digitBits, into WData words
+template <class T_Digit>
+static inline void VL_SC_DIGITS_TO_W(int obits, WDataOutP owp, const T_Digit* dp,
+                                     int digitBits) VL_MT_SAFE {
+    int words = VL_WORDS_I(obits);
+    for (int i = 0; i < words; ++i) owp[i] = 0;
+    for (int bit = 0; bit < obits; bit += digitBits, ++dp) {
+        const vluint64_t digit = *dp;
+        const int word = VL_BITWORD_E(bit);
+        owp[word] |= static_cast<EData>(digit << VL_BITBIT_E(bit));
+        if (VL_BITBIT_E(bit) + digitBits > VL_EDATASIZE && word + 1 < words) {
+            owp[word + 1] |= static_cast<EData>(digit >> (VL_EDATASIZE - VL_BITBIT_E(bit)));
+        }
+    }
+    owp[words - 1] &= VL_MASK_E(obits);
+}
+
+// Get a wide SystemC input only when it changed, for inputs eval() is
+// sensitive to; "synced" is false until every input has been read once
+#define VL_ASSIGN_WSW_EVT(obits, owp, svar, synced) \
     { \
-        int words = VL_WORDS_I(obits); \
-        sc_biguint<(obits)> _butemp = (svar).read(); \
-        for (int i = 0; i < words; ++i) { \
-            int msb = ((i + 1) * VL_IDATASIZE) - 1; \
-            msb = (msb >= (obits)) ? ((obits)-1) : msb; \
-            (owp)[i] = _butemp.range(msb, i * VL_IDATASIZE).to_uint(); \
-        } \
-        (owp)[words - 1] &= VL_MASK_E(obits); \
+        if (VL_UNLIKELY(!(synced) || (svar).event())) VL_ASSIGN_WSW((obits), (owp), (svar)); \
+    }
+#define VL_ASSIGN_WSB_EVT(obits, owp, svar, synced) \
+    { \
+        if (VL_UNLIKELY(!(synced) || (svar).event())) VL_ASSIGN_WSB((obits), (owp), (svar)); \
     }
 
 // Copying verilog format from systemc integers and bit vectors.
@@ -1021,7 +1317,7 @@ static inline void VL_ASSIGNBIT_WO(int, int bit, WDataOutP owp, IData) VL_MT_SAF
 #define VL_ASSIGN_SWW(obits, svar, rwp) \
     { \
         sc_bv<(obits)> _bvtemp; \
-        for (int i = 0; i < VL_WORDS_I(obits); ++i) _bvtemp.set_word(i, (rwp)[i]); \
+        memcpy(VL_SC_BV_DATAP_W(_bvtemp), (rwp), VL_WORDS_I(obits) * sizeof(EData)); \
         (svar).write(_bvtemp); \
     }
 
@@ -1044,6 +1340,45 @@ static inline void VL_ASSIGNBIT_WO(int, int bit, WDataOutP owp, IData) VL_MT_SAF
         (svar).write(_butemp); \
     }
 
+// Set a SystemC output only when its value changed, keeping the value last
+// set in "shadow"; "synced" is false until every output has been set once
+#define VL_ASSIGN_SCHG_(kind, type, obits, svar, shadow, synced, rd) \
+    { \
+        const type _vtemp = (rd); \
+        if (VL_UNLIKELY(!(synced) || (shadow) != _vtemp)) { \
+            (shadow) = _vtemp; \
+            VL_ASSIGN_##kind((obits), (svar), _vtemp); \
+        } \
+    }
+#define VL_ASSIGN_SCHGW_(kind, obits, svar, shadow, synced, rwp) \
+    { \
+        WDataInP const _rwp = (rwp); \
+        if (VL_UNLIKELY(!(synced) || VL_NEQ_W(VL_WORDS_I(obits), (shadow), _rwp))) { \
+            VL_ASSIGN_W((obits), (shadow), _rwp); \
+            VL_ASSIGN_##kind((obits), (svar), (shadow)); \
+        } \
+    }
+#define VL_ASSIGN_SII_CHG(obits, svar, shadow, synced, rd) \
+    VL_ASSIGN_SCHG_(SII, IData, obits, svar, shadow, synced, rd)
+#define VL_ASSIGN_SQQ_CHG(obits, svar, shadow, synced, rd) \
+    VL_ASSIGN_SCHG_(SQQ, QData, obits, svar, shadow, synced, rd)
+#define VL_ASSIGN_SWI_CHG(obits, svar, shadow, synced, rd) \
+    VL_ASSIGN_SCHG_(SWI, IData, obits, svar, shadow, synced, rd)
+#define VL_ASSIGN_SWQ_CHG(obits, svar, shadow, synced, rd) \
+    VL_ASSIGN_SCHG_(SWQ, QData, obits, svar, shadow, synced, rd)
+#define VL_ASSIGN_SWW_CHG(obits, svar, shadow, synced, rwp) \
+    VL_ASSIGN_SCHGW_(SWW, obits, svar, shadow, synced, rwp)
+#define VL_ASSIGN_SUI_CHG(obits, svar, shadow, synced, rd) \
+    VL_ASSIGN_SCHG_(SUI, IData, obits, svar, shadow, synced, rd)
+#define VL_ASSIGN_SUQ_CHG(obits, svar, shadow, synced, rd) \
+    VL_ASSIGN_SCHG_(SUQ, QData, obits, svar, shadow, synced, rd)
+#define VL_ASSIGN_SBI_CHG(obits, svar, shadow, synced, rd) \
+    VL_ASSIGN_SCHG_(SBI, IData, obits, svar, shadow, synced, rd)
+#define VL_ASSIGN_SBQ_CHG(obits, svar, shadow, synced, rd) \
+    VL_ASSIGN_SCHG_(SBQ, QData, obits, svar, shadow, synced, rd)
+#define VL_ASSIGN_SBW_CHG(obits, svar, shadow, synced, rwp) \
+    VL_ASSIGN_SCHGW_(SBW, obits, svar, shadow, synced, rwp)
+
 //===================================================================
 // Extending sizes
 
@@ -1131,6 +1466,181 @@ static inline IData VL_REDOR_W(int words, WDataInP lwp) VL_MT_SAFE {
     return (equal != 0);
 }
 
+//===================================================================
+// Wide word SIMD helpers
+//
+// Loops over words of wide data four (SSE2/NEON), eight (AVX2) or sixteen
+// (AVX-512) words at a time, leaving i at the first word for the scalar
+// tail loop to finish.  Wide data is only word aligned, so these use
+// unaligned loads and stores.
+
+// clang-format off
+#if defined(VL_HAVE_AVX512)
+# define _VL_SIMD_LD512(p, i) _mm512_loadu_si512(reinterpret_cast<const void*>((p) + (i)))
+# define _VL_SIMD_OP512_and(l, r, i) _mm512_and_si512(_VL_SIMD_LD512(l, i), _VL_SIMD_LD512(r, i))
+# define _VL_SIMD_OP512_or(l, r, i) _mm512_or_si512(_VL_SIMD_LD512(l, i), _VL_SIMD_LD512(r, i))
+# define _VL_SIMD_OP512_xor(l, r, i) _mm512_xor_si512(_VL_SIMD_LD512(l, i), _VL_SIMD_LD512(r, i))
+# define _VL_SIMD_OP512_xnor(l, r, i) \
+    _mm512_xor_si512(_VL_SIMD_OP512_xor(l, r, i), _mm512_set1_epi32(-1))
+# define _VL_SIMD_OP512_not(l, r, i) _mm512_xor_si512(_VL_SIMD_LD512(l, i), _mm512_set1_epi32(-1))
+# define _VL_SIMD_LOOP512_W(op, words, i, owp, lwp, rwp) \
+    for (; (i) + 16 <= (words); (i) += 16) { \
+        _mm512_storeu_si512(reinterpret_cast<void*>((owp) + (i)), \
+                            _VL_SIMD_OP512_##op(lwp, rwp, i)); \
+    }
+#else
+# define _VL_SIMD_LOOP512_W(op, words, i, owp, lwp, rwp)
+#endif
+#if defined(VL_HAVE_AVX2)
+# define _VL_SIMD_LD256(p, i) _mm256_loadu_si256(reinterpret_cast<const __m256i*>((p) + (i)))
+# define _VL_SIMD_OP256_and(l, r, i) _mm256_and_si256(_VL_SIMD_LD256(l, i), _VL_SIMD_LD256(r, i))
+# define _VL_SIMD_OP256_or(l, r, i) _mm256_or_si256(_VL_SIMD_LD256(l, i), _VL_SIMD_LD256(r, i))
+# define _VL_SIMD_OP256_xor(l, r, i) _mm256_xor_si256(_VL_SIMD_LD256(l, i), _VL_SIMD_LD256(r, i))
+# define _VL_SIMD_OP256_xnor(l, r, i) \
+    _mm256_xor_si256(_VL_SIMD_OP256_xor(l, r, i), _mm256_set1_epi32(-1))
+# define _VL_SIMD_OP256_not(l, r, i) _mm256_xor_si256(_VL_SIMD_LD256(l, i), _mm256_set1_epi32(-1))
+# define _VL_SIMD_LOOP256_W(op, words, i, owp, lwp, rwp) \
+    for (; (i) + 8 <= (words); (i) += 8) { \
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>((owp) + (i)), \
+                            _VL_SIMD_OP256_##op(lwp, rwp, i)); \
+    }
+#else
+# define _VL_SIMD_LOOP256_W(op, words, i, owp, lwp, rwp)
+#endif
+#if defined(VL_HAVE_SSE2)
+# define _VL_SIMD_LD128(p, i) _mm_loadu_si128(reinterpret_cast<const __m128i*>((p) + (i)))
+# define _VL_SIMD_OP128_and(l, r, i) _mm_and_si128(_VL_SIMD_LD128(l, i), _VL_SIMD_LD128(r, i))
+# define _VL_SIMD_OP128_or(l, r, i) _mm_or_si128(_VL_SIMD_LD128(l, i), _VL_SIMD_LD128(r, i))
+# define _VL_SIMD_OP128_xor(l, r, i) _mm_xor_si128(_VL_SIMD_LD128(l, i), _VL_SIMD_LD128(r, i))
+# define _VL_SIMD_OP128_xnor(l, r, i) \
+    _mm_xor_si128(_VL_SIMD_OP128_xor(l, r, i), _mm_set1_epi32(-1))
+# define _VL_SIMD_OP128_not(l, r, i) _mm_xor_si128(_VL_SIMD_LD128(l, i), _mm_set1_epi32(-1))
+# define _VL_SIMD_ST128(p, i, v) _mm_storeu_si128(reinterpret_cast<__m128i*>((p) + (i)), (v))
+#elif defined(VL_HAVE_NEON)
+# define _VL_SIMD_LD128(p, i) vld1q_u32((p) + (i))
+# define _VL_SIMD_OP128_and(l, r, i) vandq_u32(_VL_SIMD_LD128(l, i), _VL_SIMD_LD128(r, i))
+# define _VL_SIMD_OP128_or(l, r, i) vorrq_u32(_VL_SIMD_LD128(l, i), _VL_SIMD_LD128(r, i))
+# define _VL_SIMD_OP128_xor(l, r, i) veorq_u32(_VL_SIMD_LD128(l, i), _VL_SIMD_LD128(r, i))
+# define _VL_SIMD_OP128_xnor(l, r, i) vmvnq_u32(_VL_SIMD_OP128_xor(l, r, i))
+# define _VL_SIMD_OP128_not(l, r, i) vmvnq_u32(_VL_SIMD_LD128(l, i))
+# define _VL_SIMD_ST128(p, i, v) vst1q_u32((p) + (i), (v))
+#endif
+#if defined(VL_HAVE_SSE2) || defined(VL_HAVE_NEON)
+# define _VL_SIMD_LOOP128_W(op, words, i, owp, lwp, rwp) \
+    for (; (i) + 4 <= (words); (i) += 4) _VL_SIMD_ST128(owp, i, _VL_SIMD_OP128_##op(lwp, rwp, i));
+#else
+# define _VL_SIMD_LOOP128_W(op, words, i, owp, lwp, rwp)
+#endif
+/// Set owp[n] = lwp[n] op rwp[n] over full vectors
+#define _VL_SIMD_LOOP_W(op, words, i, owp, lwp, rwp) \
+    do { \
+        _VL_SIMD_LOOP512_W(op, words, i, owp, lwp, rwp) \
+        _VL_SIMD_LOOP256_W(op, words, i, owp, lwp, rwp) \
+        _VL_SIMD_LOOP128_W(op, words, i, owp, lwp, rwp) \
+    } while (0)
+
+/// Set owp[n] = (hwp[n] << hshift) | (lwp[n] >> lshift) over full vectors
+#if defined(VL_HAVE_AVX2)
+# define _VL_SIMD_SHIFT256_W(words, i, owp, hwp, lwp, hshift, lshift) \
+    for (; (i) + 8 <= (words); (i) += 8) { \
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>((owp) + (i)), \
+                            _mm256_or_si256(_mm256_sll_epi32(_VL_SIMD_LD256(hwp, i), hcnt), \
+                                            _mm256_srl_epi32(_VL_SIMD_LD256(lwp, i), lcnt))); \
+    }
+#else
+# define _VL_SIMD_SHIFT256_W(words, i, owp, hwp, lwp, hshift, lshift)
+#endif
+#if defined(VL_HAVE_SSE2)
+# define _VL_SIMD_SHIFT_W(words, i, owp, hwp, lwp, hshift, lshift) \
+    do { \
+        const __m128i hcnt = _mm_cvtsi32_si128(hshift); \
+        const __m128i lcnt = _mm_cvtsi32_si128(lshift); \
+        _VL_SIMD_SHIFT256_W(words, i, owp, hwp, lwp, hshift, lshift) \
+        for (; (i) + 4 <= (words); (i) += 4) { \
+            _VL_SIMD_ST128(owp, i, _mm_or_si128(_mm_sll_epi32(_VL_SIMD_LD128(hwp, i), hcnt), \
+                                                _mm_srl_epi32(_VL_SIMD_LD128(lwp, i), lcnt))); \
+        } \
+    } while (0)
+#elif defined(VL_HAVE_NEON)
+# define _VL_SIMD_SHIFT_W(words, i, owp, hwp, lwp, hshift, lshift) \
+    do { \
+        const int32x4_t hcnt = vdupq_n_s32(hshift); \
+        const int32x4_t lcnt = vdupq_n_s32(-(lshift)); \
+        for (; (i) + 4 <= (words); (i) += 4) { \
+            _VL_SIMD_ST128(owp, i, vorrq_u32(vshlq_u32(_VL_SIMD_LD128(hwp, i), hcnt), \
+                                             vshlq_u32(_VL_SIMD_LD128(lwp, i), lcnt))); \
+        } \
+    } while (0)
+#else
+# define _VL_SIMD_SHIFT_W(words, i, owp, hwp, lwp, hshift, lshift)
+#endif
+// clang-format on
+
+/// OR reduce (lwp[n] ^ rwp[n]) over full vectors, leaving i at the first word not reduced
+static inline EData _vl_simd_reduce_or(int words, int& i, WDataInP lwp, WDataInP rwp) VL_PURE {
+#if defined(VL_HAVE_SSE2)
+    __m128i acc = _mm_setzero_si128();
+# if defined(VL_HAVE_AVX2)
+    __m256i acc256 = _mm256_setzero_si256();
+#  if defined(VL_HAVE_AVX512)
+    __m512i acc512 = _mm512_setzero_si512();
+    for (; i + 16 <= words; i += 16) {
+        acc512 = _mm512_or_si512(acc512, _VL_SIMD_OP512_xor(lwp, rwp, i));
+    }
+    EData fold[16];  // Through memory, as GCC warns on 512-bit extracts
+    _mm512_storeu_si512(reinterpret_cast<void*>(fold), acc512);
+    acc256 = _mm256_or_si256(_VL_SIMD_LD256(fold, 0), _VL_SIMD_LD256(fold, 8));
+#  endif
+    for (; i + 8 <= words; i += 8) {
+        acc256 = _mm256_or_si256(acc256, _VL_SIMD_OP256_xor(lwp, rwp, i));
+    }
+    acc = _mm_or_si128(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+# endif
+    for (; i + 4 <= words; i += 4) acc = _mm_or_si128(acc, _VL_SIMD_OP128_xor(lwp, rwp, i));
+    acc = _mm_or_si128(acc, _mm_shuffle_epi32(acc, 0x4e));
+    acc = _mm_or_si128(acc, _mm_shuffle_epi32(acc, 0xb1));
+    return static_cast<EData>(_mm_cvtsi128_si32(acc));
+#elif defined(VL_HAVE_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 4 <= words; i += 4) acc = vorrq_u32(acc, _VL_SIMD_OP128_xor(lwp, rwp, i));
+    const uint32x2_t half = vorr_u32(vget_low_u32(acc), vget_high_u32(acc));
+    return vget_lane_u32(half, 0) | vget_lane_u32(half, 1);
+#else
+    if (0 && words && i && lwp && rwp) {}
+    return 0;
+#endif
+}
+/// XOR reduce lwp[n] over full vectors, leaving i at the first word not reduced
+static inline EData _vl_simd_reduce_xor(int words, int& i, WDataInP lwp) VL_PURE {
+#if defined(VL_HAVE_SSE2)
+    __m128i acc = _mm_setzero_si128();
+# if defined(VL_HAVE_AVX2)
+    __m256i acc256 = _mm256_setzero_si256();
+#  if defined(VL_HAVE_AVX512)
+    __m512i acc512 = _mm512_setzero_si512();
+    for (; i + 16 <= words; i += 16) acc512 = _mm512_xor_si512(acc512, _VL_SIMD_LD512(lwp, i));
+    EData fold[16];  // Through memory, as GCC warns on 512-bit extracts
+    _mm512_storeu_si512(reinterpret_cast<void*>(fold), acc512);
+    acc256 = _mm256_xor_si256(_VL_SIMD_LD256(fold, 0), _VL_SIMD_LD256(fold, 8));
+#  endif
+    for (; i + 8 <= words; i += 8) acc256 = _mm256_xor_si256(acc256, _VL_SIMD_LD256(lwp, i));
+    acc = _mm_xor_si128(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+# endif
+    for (; i + 4 <= words; i += 4) acc = _mm_xor_si128(acc, _VL_SIMD_LD128(lwp, i));
+    acc = _mm_xor_si128(acc, _mm_shuffle_epi32(acc, 0x4e));
+    acc = _mm_xor_si128(acc, _mm_shuffle_epi32(acc, 0xb1));
+    return static_cast<EData>(_mm_cvtsi128_si32(acc));
+#elif defined(VL_HAVE_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 4 <= words; i += 4) acc = veorq_u32(acc, _VL_SIMD_LD128(lwp, i));
+    const uint32x2_t half = veor_u32(vget_low_u32(acc), vget_high_u32(acc));
+    return vget_lane_u32(half, 0) ^ vget_lane_u32(half, 1);
+#else
+    if (0 && words && i && lwp) {}
+    return 0;
+#endif
+}
+
 // EMIT_RULE: VL_REDXOR:  oclean=dirty; obits=1;
 static inline IData VL_REDXOR_2(IData r) VL_PURE {
     // Experiments show VL_REDXOR_2 is faster than __builtin_parityl
@@ -1193,22 +1703,31 @@ static inline IData VL_REDXOR_64(QData r) VL_PURE {
 #endif
 }
 static inline IData VL_REDXOR_W(int words, WDataInP lwp) VL_MT_SAFE {
-    EData r = lwp[0];
-    for (int i = 1; i < words; ++i) r ^= lwp[i];
+    int i = 0;
+    EData r = _vl_simd_reduce_xor(words, i, lwp);
+    for (; i < words; ++i) r ^= lwp[i];
     return VL_REDXOR_32(r);
 }
 
 // EMIT_RULE: VL_COUNTONES_II:  oclean = false; lhs clean
 static inline IData VL_COUNTONES_I(IData lhs) VL_PURE {
-    // This is faster than __builtin_popcountl
+#if defined(VL_HAVE_POPCNT)
+    return __builtin_popcount(lhs);
+#else
+    // This is faster than __builtin_popcountl without a popcnt instruction
     IData r = lhs - ((lhs >> 1) & 033333333333) - ((lhs >> 2) & 011111111111);
     r = (r + (r >> 3)) & 030707070707;
     r = (r + (r >> 6));
     r = (r + (r >> 12) + (r >> 24)) & 077;
     return r;
+#endif
 }
 static inline IData VL_COUNTONES_Q(QData lhs) VL_PURE {
+#if defined(VL_HAVE_POPCNT)
+    return __builtin_popcountll(lhs);
+#else
     return VL_COUNTONES_I(static_cast<IData>(lhs)) + VL_COUNTONES_I(static_cast<IData>(lhs >> 32));
+#endif
 }
 #define VL_COUNTONES_E VL_COUNTONES_I
 static inline IData VL_COUNTONES_W(int words, WDataInP lwp) VL_MT_SAFE {
@@ -1224,6 +1743,10 @@ static inline IData VL_ONEHOT_Q(QData lhs) VL_PURE {
     return (((lhs & (lhs - 1)) == 0) & (lhs != 0));
 }
 static inline IData VL_ONEHOT_W(int words, WDataInP lwp) VL_MT_SAFE {
+#if defined(VL_HAVE_POPCNT)
+    // Branch free, as bits in ECC or one-hot state are unpredictable
+    return VL_COUNTONES_W(words, lwp) == 1;
+#else
     EData one = 0;
     for (int i = 0; (i < words); ++i) {
         if (lwp[i]) {
@@ -1233,11 +1756,15 @@ static inline IData VL_ONEHOT_W(int words, WDataInP lwp) VL_MT_SAFE {
         }
     }
     return one;
+#endif
 }
 
 static inline IData VL_ONEHOT0_I(IData lhs) VL_PURE { return ((lhs & (lhs - 1)) == 0); }
 static inline IData VL_ONEHOT0_Q(QData lhs) VL_PURE { return ((lhs & (lhs - 1)) == 0); }
 static inline IData VL_ONEHOT0_W(int words, WDataInP lwp) VL_MT_SAFE {
+#if defined(VL_HAVE_POPCNT)
+    return VL_COUNTONES_W(words, lwp) <= 1;
+#else
     bool one = false;
     for (int i = 0; (i < words); ++i) {
         if (lwp[i]) {
@@ -1247,33 +1774,46 @@ static inline IData VL_ONEHOT0_W(int words, WDataInP lwp) VL_MT_SAFE {
         }
     }
     return 1;
+#endif
 }
 
 static inline IData VL_CLOG2_I(IData lhs) VL_PURE {
-    // There are faster algorithms, or fls GCC4 builtins, but rarely used
-    if (VL_UNLIKELY(!lhs)) return 0;
+    if (VL_UNLIKELY(lhs <= 1)) return 0;
+#if defined(__GNUC__) && !defined(VL_NO_BUILTINS)
+    // lzcnt, or bsr without it
+    return VL_IDATASIZE - __builtin_clz(lhs - 1);
+#else
     lhs--;
     int shifts = 0;
     for (; lhs != 0; ++shifts) lhs = lhs >> 1;
     return shifts;
+#endif
 }
 static inline IData VL_CLOG2_Q(QData lhs) VL_PURE {
-    if (VL_UNLIKELY(!lhs)) return 0;
+    if (VL_UNLIKELY(lhs <= 1)) return 0;
+#if defined(__GNUC__) && !defined(VL_NO_BUILTINS)
+    return VL_QUADSIZE - __builtin_clzll(lhs - 1);
+#else
     lhs--;
     int shifts = 0;
     for (; lhs != 0; ++shifts) lhs = lhs >> VL_ULL(1);
     return shifts;
+#endif
 }
 static inline IData VL_CLOG2_W(int words, WDataInP lwp) VL_MT_SAFE {
     EData adjust = (VL_COUNTONES_W(words, lwp) == 1) ? 0 : 1;
     for (int i = words - 1; i >= 0; --i) {
         if (VL_UNLIKELY(lwp[i])) {  // Shorter worst case if predict not taken
+#if defined(__GNUC__) && !defined(VL_NO_BUILTINS)
+            return i * VL_EDATASIZE + (VL_EDATASIZE - 1 - __builtin_clz(lwp[i])) + adjust;
+#else
             for (int bit = VL_EDATASIZE - 1; bit >= 0; --bit) {
                 if (VL_UNLIKELY(VL_BITISSET_E(lwp[i], bit))) {
                     return i * VL_EDATASIZE + bit + adjust;
                 }
             }
             // Can't get here - one bit must be set
+#endif
         }
     }
     return 0;
@@ -1283,10 +1823,14 @@ static inline IData VL_MOSTSETBITP1_W(int words, WDataInP lwp) VL_MT_SAFE {
     // MSB set bit plus one; similar to FLS.  0=value is zero
     for (int i = words - 1; i >= 0; --i) {
         if (VL_UNLIKELY(lwp[i])) {  // Shorter worst case if predict not taken
+#if defined(__GNUC__) && !defined(VL_NO_BUILTINS)
+            return i * VL_EDATASIZE + (VL_EDATASIZE - __builtin_clz(lwp[i]));
+#else
             for (int bit = VL_EDATASIZE - 1; bit >= 0; --bit) {
                 if (VL_UNLIKELY(VL_BITISSET_E(lwp[i], bit))) { return i * VL_EDATASIZE + bit + 1; }
             }
             // Can't get here - one bit must be set
+#endif
         }
     }
     return 0;
@@ -1297,34 +1841,45 @@ static inline IData VL_MOSTSETBITP1_W(int words, WDataInP lwp) VL_MT_SAFE {
 
 // EMIT_RULE: VL_AND:  oclean=lclean||rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_AND_W(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) VL_MT_SAFE {
-    for (int i = 0; (i < words); ++i) owp[i] = (lwp[i] & rwp[i]);
+    int i = 0;
+    _VL_SIMD_LOOP_W(and, words, i, owp, lwp, rwp);
+    for (; (i < words); ++i) owp[i] = (lwp[i] & rwp[i]);
     return owp;
 }
 // EMIT_RULE: VL_OR:   oclean=lclean&&rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_OR_W(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) VL_MT_SAFE {
-    for (int i = 0; (i < words); ++i) owp[i] = (lwp[i] | rwp[i]);
+    int i = 0;
+    _VL_SIMD_LOOP_W(or, words, i, owp, lwp, rwp);
+    for (; (i < words); ++i) owp[i] = (lwp[i] | rwp[i]);
     return owp;
 }
 // EMIT_RULE: VL_CHANGEXOR:  oclean=1; obits=32; lbits==rbits;
 static inline IData VL_CHANGEXOR_W(int words, WDataInP lwp, WDataInP rwp) VL_MT_SAFE {
-    IData od = 0;
-    for (int i = 0; (i < words); ++i) od |= (lwp[i] ^ rwp[i]);
+    int i = 0;
+    IData od = _vl_simd_reduce_or(words, i, lwp, rwp);
+    for (; (i < words); ++i) od |= (lwp[i] ^ rwp[i]);
     return od;
 }
 // EMIT_RULE: VL_XOR:  oclean=lclean&&rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_XOR_W(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) VL_MT_SAFE {
-    for (int i = 0; (i < words); ++i) owp[i] = (lwp[i] ^ rwp[i]);
+    int i = 0;
+    _VL_SIMD_LOOP_W(xor, words, i, owp, lwp, rwp);
+    for (; (i < words); ++i) owp[i] = (lwp[i] ^ rwp[i]);
     return owp;
 }
 // EMIT_RULE: VL_XNOR:  oclean=dirty; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_XNOR_W(int words, WDataOutP owp, WDataInP lwp,
                                   WDataInP rwp) VL_MT_SAFE {
-    for (int i = 0; (i < words); ++i) owp[i] = (lwp[i] ^ ~rwp[i]);
+    int i = 0;
+    _VL_SIMD_LOOP_W(xnor, words, i, owp, lwp, rwp);
+    for (; (i < words); ++i) owp[i] = (lwp[i] ^ ~rwp[i]);
     return owp;
 }
 // EMIT_RULE: VL_NOT:  oclean=dirty; obits=lbits;
 static inline WDataOutP VL_NOT_W(int words, WDataOutP owp, WDataInP lwp) VL_MT_SAFE {
-    for (int i = 0; i < words; ++i) owp[i] = ~(lwp[i]);
+    int i = 0;
+    _VL_SIMD_LOOP_W(not, words, i, owp, lwp, lwp);
+    for (; i < words; ++i) owp[i] = ~(lwp[i]);
     return owp;
 }
 
@@ -1345,8 +1900,9 @@ static inline WDataOutP VL_NOT_W(int words, WDataOutP owp, WDataInP lwp) VL_MT_S
 
 // Output clean, <lhs> AND <rhs> MUST BE CLEAN
 static inline IData VL_EQ_W(int words, WDataInP lwp, WDataInP rwp) VL_MT_SAFE {
-    EData nequal = 0;
-    for (int i = 0; (i < words); ++i) nequal |= (lwp[i] ^ rwp[i]);
+    int i = 0;
+    EData nequal = _vl_simd_reduce_or(words, i, lwp, rwp);
+    for (; (i < words); ++i) nequal |= (lwp[i] ^ rwp[i]);
     return (nequal == 0);
 }
 
@@ -1455,9 +2011,58 @@ static void VL_NEGATE_INPLACE_W(int words, WDataOutP owp_lwp) VL_MT_SAFE {
 #define VL_MODDIV_QQQ(lbits, lhs, rhs) (((rhs) == 0) ? 0 : (lhs) % (rhs))
 #define VL_MODDIV_WWW(lbits, owp, lwp, rwp) (_vl_moddiv_w(lbits, owp, lwp, rwp, 1))
 
+// Wide divide by constant, emitted when the divisor is a non-zero constant
+// that fits in a word, so the compiler can replace the divide with a multiply
+static inline WDataOutP VL_DIV_WWI(int lbits, WDataOutP owp, WDataInP lwp, IData rd) VL_MT_SAFE {
+    vluint64_t k = 0;
+    for (int j = VL_WORDS_I(lbits) - 1; j >= 0; --j) {
+        vluint64_t unw64 = ((k << VL_ULL(32)) | static_cast<vluint64_t>(lwp[j]));
+        owp[j] = static_cast<EData>(unw64 / rd);
+        k = unw64 % rd;
+    }
+    return owp;
+}
+static inline WDataOutP VL_MODDIV_WWI(int lbits, WDataOutP owp, WDataInP lwp,
+                                      IData rd) VL_MT_SAFE {
+    vluint64_t k = 0;
+    for (int j = VL_WORDS_I(lbits) - 1; j >= 0; --j) {
+        k = ((k << VL_ULL(32)) | static_cast<vluint64_t>(lwp[j])) % rd;
+    }
+    owp[0] = static_cast<EData>(k);
+    for (int i = 1; i < VL_WORDS_I(lbits); ++i) owp[i] = 0;
+    return owp;
+}
+
+#ifdef VL_HAVE_LIMB64
+// Internal usage: 64-bit limb of wide data, where the last limb may
+// be a single word.  Memcpy is used as WData is only word aligned.
+static inline QData _VL_LIMB64_LD(int words, WDataInP lwp, int limb) VL_PURE {
+    if (VL_UNLIKELY(limb * 2 + 1 >= words)) return static_cast<QData>(lwp[limb * 2]);
+    QData v;
+    memcpy(&v, lwp + limb * 2, sizeof(v));
+    return v;
+}
+static inline void _VL_LIMB64_ST(int words, WDataOutP owp, int limb, QData v) VL_MT_SAFE {
+    if (VL_UNLIKELY(limb * 2 + 1 >= words)) {
+        owp[limb * 2] = static_cast<EData>(v);
+    } else {
+        memcpy(owp + limb * 2, &v, sizeof(v));
+    }
+}
+#endif
+
 static inline WDataOutP VL_ADD_W(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) VL_MT_SAFE {
     QData carry = 0;
-    for (int i = 0; i < words; ++i) {
+    int i = 0;
+#ifdef VL_HAVE_LIMB64
+    for (; i + 2 <= words; i += 2) {
+        vluint128_t sum = static_cast<vluint128_t>(_VL_LIMB64_LD(words, lwp, i / 2))
+                                + _VL_LIMB64_LD(words, rwp, i / 2) + carry;
+        _VL_LIMB64_ST(words, owp, i / 2, static_cast<QData>(sum));
+        carry = static_cast<QData>(sum >> 64);
+    }
+#endif
+    for (; i < words; ++i) {
         carry = carry + static_cast<QData>(lwp[i]) + static_cast<QData>(rwp[i]);
         owp[i] = (carry & VL_ULL(0xffffffff));
         carry = (carry >> VL_ULL(32)) & VL_ULL(0xffffffff);
@@ -1467,11 +2072,19 @@ static inline WDataOutP VL_ADD_W(int words, WDataOutP owp, WDataInP lwp, WDataIn
 }
 
 static inline WDataOutP VL_SUB_W(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) VL_MT_SAFE {
-    QData carry = 0;
-    for (int i = 0; i < words; ++i) {
+    QData carry = 1;  // Negation of rwp
+    int i = 0;
+#ifdef VL_HAVE_LIMB64
+    for (; i + 2 <= words; i += 2) {
+        vluint128_t sum = static_cast<vluint128_t>(_VL_LIMB64_LD(words, lwp, i / 2))
+                                + ~_VL_LIMB64_LD(words, rwp, i / 2) + carry;
+        _VL_LIMB64_ST(words, owp, i / 2, static_cast<QData>(sum));
+        carry = static_cast<QData>(sum >> 64);
+    }
+#endif
+    for (; i < words; ++i) {
         carry = (carry + static_cast<QData>(lwp[i])
                  + static_cast<QData>(static_cast<IData>(~rwp[i])));
-        if (i == 0) ++carry;  // Negation of rwp
         owp[i] = (carry & VL_ULL(0xffffffff));
         carry = (carry >> VL_ULL(32)) & VL_ULL(0xffffffff);
     }
@@ -1481,6 +2094,33 @@ static inline WDataOutP VL_SUB_W(int words, WDataOutP owp, WDataInP lwp, WDataIn
 
 static inline WDataOutP VL_MUL_W(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) VL_MT_SAFE {
     for (int i = 0; i < words; ++i) owp[i] = 0;
+#ifdef VL_HAVE_LIMB64
+    // Each 64x64 multiply replaces four 32x32; a partial last limb is truncated
+    // on store, which only loses bits above the output width
+    int limbs = (words + 1) / 2;
+    // Only significant limbs contribute, e.g. when multiplying zero extended operands
+    int llimbs = limbs;
+    while (llimbs && !_VL_LIMB64_LD(words, lwp, llimbs - 1)) --llimbs;
+    int rlimbs = limbs;
+    while (rlimbs && !_VL_LIMB64_LD(words, rwp, rlimbs - 1)) --rlimbs;
+    if (VL_UNLIKELY(llimbs >= VL_MUL_KARATSUBA_LIMBS && rlimbs >= VL_MUL_KARATSUBA_LIMBS)) {
+        return _vl_mul_karatsuba_w(words, owp, lwp, rwp, llimbs > rlimbs ? llimbs : rlimbs);
+    }
+    for (int llimb = 0; llimb < llimbs; ++llimb) {
+        QData lhs = _VL_LIMB64_LD(words, lwp, llimb);
+        if (!lhs) continue;
+        QData carry = 0;
+        int olimb = llimb;
+        for (; olimb < limbs && olimb - llimb < rlimbs; ++olimb) {
+            vluint128_t mul
+                = static_cast<vluint128_t>(lhs) * _VL_LIMB64_LD(words, rwp, olimb - llimb)
+                  + _VL_LIMB64_LD(words, owp, olimb) + carry;
+            _VL_LIMB64_ST(words, owp, olimb, static_cast<QData>(mul));
+            carry = static_cast<QData>(mul >> 64);
+        }
+        if (olimb < limbs) _VL_LIMB64_ST(words, owp, olimb, carry);  // Not yet written
+    }
+#else
     for (int lword = 0; lword < words; ++lword) {
         for (int rword = 0; rword < words; ++rword) {
             QData mul = static_cast<QData>(lwp[lword]) * static_cast<QData>(rwp[rword]);
@@ -1491,6 +2131,7 @@ static inline WDataOutP VL_MUL_W(int words, WDataOutP owp, WDataInP lwp, WDataIn
             }
         }
     }
+#endif
     // Last output word is dirty
     return owp;
 }
@@ -1883,7 +2524,11 @@ static inline IData VL_STREAML_FAST_III(int, int lbits, int, IData ld, IData rd_
     case 0: ret = ((ret >> 1) & VL_UL(0x55555555)) | ((ret & VL_UL(0x55555555)) << 1);  // FALLTHRU
     case 1: ret = ((ret >> 2) & VL_UL(0x33333333)) | ((ret & VL_UL(0x33333333)) << 2);  // FALLTHRU
     case 2: ret = ((ret >> 4) & VL_UL(0x0f0f0f0f)) | ((ret & VL_UL(0x0f0f0f0f)) << 4);  // FALLTHRU
+#if defined(__GNUC__) && !defined(VL_NO_BUILTINS)
+    case 3: ret = __builtin_bswap32(ret); break;  // Same as the byte and half swaps
+#else
     case 3: ret = ((ret >> 8) & VL_UL(0x00ff00ff)) | ((ret & VL_UL(0x00ff00ff)) << 8);  // FALLTHRU
+#endif
     case 4: ret = ((ret >> 16) | (ret << 16));
     }
     return ret >> (VL_IDATASIZE - lbits);
@@ -1908,9 +2553,13 @@ static inline QData VL_STREAML_FAST_QQI(int, int lbits, int, QData ld, IData rd_
     case 2:
         ret = (((ret >> 4) & VL_ULL(0x0f0f0f0f0f0f0f0f))
                | ((ret & VL_ULL(0x0f0f0f0f0f0f0f0f)) << 4));  // FALLTHRU
+#if defined(__GNUC__) && !defined(VL_NO_BUILTINS)
+    case 3: ret = __builtin_bswap64(ret); break;  // Same as the byte, half and word swaps
+#else
     case 3:
         ret = (((ret >> 8) & VL_ULL(0x00ff00ff00ff00ff))
                | ((ret & VL_ULL(0x00ff00ff00ff00ff)) << 8));  // FALLTHRU
+#endif
     case 4:
         ret = (((ret >> 16) & VL_ULL(0x0000ffff0000ffff))
                | ((ret & VL_ULL(0x0000ffff0000ffff)) << 16));  // FALLTHRU
@@ -1944,8 +2593,36 @@ static inline QData VL_STREAML_QQI(int, int lbits, int, QData ld, IData rd) VL_P
     return ret;
 }
 
+static inline EData _vl_bitreverse_e(EData v, bool bytesOnly) VL_PURE {
+    if (!bytesOnly) {
+        v = ((v >> 1) & VL_UL(0x55555555)) | ((v & VL_UL(0x55555555)) << 1);
+        v = ((v >> 2) & VL_UL(0x33333333)) | ((v & VL_UL(0x33333333)) << 2);
+        v = ((v >> 4) & VL_UL(0x0f0f0f0f)) | ((v & VL_UL(0x0f0f0f0f)) << 4);
+    }
+#if defined(__GNUC__) && !defined(VL_NO_BUILTINS)
+    return __builtin_bswap32(v);
+#else
+    v = ((v >> 8) & VL_UL(0x00ff00ff)) | ((v & VL_UL(0x00ff00ff)) << 8);
+    return (v >> 16) | (v << 16);
+#endif
+}
+
 static inline WDataOutP VL_STREAML_WWI(int, int lbits, int, WDataOutP owp, WDataInP lwp,
                                        IData rd) VL_MT_SAFE {
+    if (rd == 1 || (rd == 8 && !(lbits & 7))) {
+        // Bit or byte reversal: reverse each word into the mirrored word,
+        // then shift down over the unused bits of the top word
+        const int words = VL_WORDS_I(lbits);
+        const int pad = words * VL_EDATASIZE - lbits;
+        for (int i = 0; i < words; ++i) owp[words - 1 - i] = _vl_bitreverse_e(lwp[i], rd == 8);
+        if (pad) {
+            for (int i = 0; i < words - 1; ++i) {
+                owp[i] = (owp[i] >> pad) | (owp[i + 1] << (VL_EDATASIZE - pad));
+            }
+            owp[words - 1] >>= pad;
+        }
+        return owp;
+    }
     VL_ZERO_W(lbits, owp);
     // Slice size should never exceed the lhs width
     int ssize = (rd < static_cast<IData>(lbits)) ? rd : (static_cast<IData>(lbits));
@@ -2071,8 +2748,17 @@ static inline WDataOutP VL_SHIFTL_WWI(int obits, int, int, WDataOutP owp, WDataI
         for (int i = 0; i < word_shift; ++i) owp[i] = 0;
         for (int i = word_shift; i < VL_WORDS_I(obits); ++i) owp[i] = lwp[i - word_shift];
     } else {
-        for (int i = 0; i < VL_WORDS_I(obits); ++i) owp[i] = 0;
-        _VL_INSERT_WW(obits, owp, lwp, obits - 1, rd);
+        int loffset = rd & VL_SIZEBITS_E;
+        int nbitsonright = VL_EDATASIZE - loffset;  // bits that end up in lword (know loffset!=0)
+        for (int i = 0; i < word_shift; ++i) owp[i] = 0;
+        owp[word_shift] = lwp[0] << loffset;
+        int j = 0;  // Words done above word_shift
+        _VL_SIMD_SHIFT_W(VL_WORDS_I(obits) - word_shift - 1, j, owp + word_shift + 1, lwp + 1, lwp,
+                         loffset, nbitsonright);
+        for (int i = word_shift + 1 + j; i < VL_WORDS_I(obits); ++i) {
+            owp[i] = (lwp[i - word_shift] << loffset) | (lwp[i - word_shift - 1] >> nbitsonright);
+        }
+        owp[VL_WORDS_I(obits) - 1] &= VL_MASK_E(obits);
     }
     return owp;
 }
@@ -2121,7 +2807,13 @@ static inline WDataOutP VL_SHIFTR_WWI(int obits, int, int, WDataOutP owp, WDataI
         int nbitsonright = VL_EDATASIZE - loffset;  // bits that end up in lword (know loffset!=0)
         // Middle words
         int words = VL_WORDS_I(obits - rd);
-        for (int i = 0; i < words; ++i) {
+        int i = 0;
+        // Vectors only where upperword is always in range
+        _VL_SIMD_SHIFT_W(VL_WORDS_I(obits) - word_shift - 1 < words
+                             ? VL_WORDS_I(obits) - word_shift - 1
+                             : words,
+                         i, owp, lwp + word_shift + 1, lwp + word_shift, nbitsonright, loffset);
+        for (; i < words; ++i) {
             owp[i] = lwp[i + word_shift] >> loffset;
             int upperword = i + word_shift + 1;
             if (upperword < VL_WORDS_I(obits)) owp[i] |= lwp[upperword] << nbitsonright;
@@ -2202,7 +2894,13 @@ static inline WDataOutP VL_SHIFTRS_WWI(int obits, int lbits, int, WDataOutP owp,
         int nbitsonright = VL_EDATASIZE - loffset;  // bits that end up in lword (know loffset!=0)
         // Middle words
         int words = VL_WORDS_I(obits - rd);
-        for (int i = 0; i < words; ++i) {
+        int i = 0;
+        // Vectors only where upperword is always in range
+        _VL_SIMD_SHIFT_W(VL_WORDS_I(obits) - word_shift - 1 < words
+                             ? VL_WORDS_I(obits) - word_shift - 1
+                             : words,
+                         i, owp, lwp + word_shift + 1, lwp + word_shift, nbitsonright, loffset);
+        for (; i < words; ++i) {
             owp[i] = lwp[i + word_shift] >> loffset;
             int upperword = i + word_shift + 1;
             if (upperword < VL_WORDS_I(obits)) owp[i] |= lwp[upperword] << nbitsonright;
@@ -0,0 +1,526 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief Co-simulation of a partitioned design in several processes, see --cosim
+///
+/// This file must be compiled and linked against all objects
+/// created from Verilator with --cosim.
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated_cosim.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+// clang-format off
+#if defined(_WIN32) || defined(__MINGW32__)
+# define VL_COSIM_NO_POSIX  // No sockets or mmap(); co-simulation is not supported
+#else
+# include <fcntl.h>
+# include <netdb.h>
+# include <netinet/in.h>
+# include <netinet/tcp.h>
+# include <sched.h>
+# include <sys/mman.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0  // Not on all platforms; then SIGPIPE is left to the user
+#endif
+// clang-format on
+
+// Protocol, any change must increment VERSION
+static const vluint32_t VL_COSIM_MAGIC = 0x564c4353;  // "VLCS"
+static const vluint32_t VL_COSIM_VERSION = 1;
+static const int VL_COSIM_CONNECT_SECS = 60;  ///< Time to wait for the partner to start
+static const size_t VL_COSIM_SHM_CAPACITY = 1 << 20;  ///< Bytes in each shared memory ring
+
+//=============================================================================
+/// Connection to the partner
+
+class VerilatedCosimChannel {
+public:
+    virtual ~VerilatedCosimChannel() {}
+    /// Write all the bytes, false if the partner closed
+    virtual bool send(const void* datap, size_t bytes) = 0;
+    /// Read all the bytes, false if the partner closed
+    virtual bool recv(void* datap, size_t bytes) = 0;
+    /// Bytes that may be in flight without the receiver reading, or 0 if unknown
+    virtual size_t capacity() const = 0;
+};
+
+#ifndef VL_COSIM_NO_POSIX
+
+//=============================================================================
+// VerilatedCosimTcp
+
+class VerilatedCosimTcp : public VerilatedCosimChannel {
+    int m_fd;  ///< Connected socket
+public:
+    explicit VerilatedCosimTcp(int fd)
+        : m_fd(fd) {
+        int one = 1;  // Batches are small, send each at once
+        setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    virtual ~VerilatedCosimTcp() { ::close(m_fd); }
+    virtual bool send(const void* datap, size_t bytes) {
+        const char* bufp = static_cast<const char*>(datap);
+        while (bytes) {
+            const ssize_t got = ::send(m_fd, bufp, bytes, MSG_NOSIGNAL);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            bufp += got;
+            bytes -= got;
+        }
+        return true;
+    }
+    virtual bool recv(void* datap, size_t bytes) {
+        char* bufp = static_cast<char*>(datap);
+        while (bytes) {
+            const ssize_t got = ::recv(m_fd, bufp, bytes, 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            bufp += got;
+            bytes -= got;
+        }
+        return true;
+    }
+    virtual size_t capacity() const { return 0; }
+};
+
+//=============================================================================
+// VerilatedCosimShm - Two single producer, single consumer byte rings in a
+// memory mapped file.  Ring N is written by side N; side 0 creates the file.
+
+struct VerilatedCosimShmRing {
+    vluint64_t m_head;  ///< Bytes written, only stored by the sender
+    char m_pad1[VL_CACHE_LINE_BYTES - sizeof(vluint64_t)];
+    vluint64_t m_tail;  ///< Bytes read, only stored by the receiver
+    char m_pad2[VL_CACHE_LINE_BYTES - sizeof(vluint64_t)];
+};
+
+struct VerilatedCosimShmHeader {
+    vluint32_t m_magic;  ///< VL_COSIM_MAGIC, written last when the file is set up
+    vluint32_t m_version;  ///< VL_COSIM_VERSION
+    vluint64_t m_capacity;  ///< Bytes in each ring
+    vluint64_t m_closed[2];  ///< Non-zero once side N closed
+    char m_pad[VL_CACHE_LINE_BYTES - 4 * sizeof(vluint64_t)];
+    VerilatedCosimShmRing m_rings[2];
+};
+
+class VerilatedCosimShm : public VerilatedCosimChannel {
+    VerilatedCosimShmHeader* m_hdrp;  ///< Mapped file
+    size_t m_size;  ///< Bytes mapped
+    int m_side;  ///< 0 if created the file, else 1
+
+public:
+    static inline vluint64_t load(const vluint64_t& var) {
+#ifdef __GNUC__
+        return __atomic_load_n(&var, __ATOMIC_ACQUIRE);
+#else
+        return *static_cast<const volatile vluint64_t*>(&var);
+#endif
+    }
+    static inline void store(vluint64_t& var, vluint64_t value) {
+#ifdef __GNUC__
+        __atomic_store_n(&var, value, __ATOMIC_RELEASE);
+#else
+        *static_cast<volatile vluint64_t*>(&var) = value;
+#endif
+    }
+
+private:
+    static void wait(int& spins) {
+#ifdef VL_CPU_RELAX
+        // Partners are usually running in step, so spin briefly first
+        if (++spins < 1000) {
+            VL_CPU_RELAX();
+            return;
+        }
+#endif
+        sched_yield();
+    }
+    char* ringDatap(int ring) const {
+        return reinterpret_cast<char*>(m_hdrp + 1) + ring * m_hdrp->m_capacity;
+    }
+
+public:
+    VerilatedCosimShm(void* mapp, size_t size, int side)
+        : m_hdrp(static_cast<VerilatedCosimShmHeader*>(mapp))
+        , m_size(size)
+        , m_side(side) {}
+    virtual ~VerilatedCosimShm() {
+        store(m_hdrp->m_closed[m_side], 1);
+        munmap(m_hdrp, m_size);
+    }
+    virtual bool send(const void* datap, size_t bytes) {
+        VerilatedCosimShmRing& ring = m_hdrp->m_rings[m_side];
+        const vluint64_t capacity = m_hdrp->m_capacity;
+        char* const basep = ringDatap(m_side);
+        const char* bufp = static_cast<const char*>(datap);
+        vluint64_t head = ring.m_head;  // Only this side stores it
+        while (bytes) {
+            vluint64_t space;
+            int spins = 0;
+            while (!(space = capacity - (head - load(ring.m_tail)))) {
+                if (load(m_hdrp->m_closed[!m_side])) return false;
+                wait(spins);
+            }
+            const size_t pos = head % capacity;
+            size_t chunk = bytes;
+            if (chunk > space) chunk = space;
+            if (chunk > capacity - pos) chunk = capacity - pos;
+            memcpy(basep + pos, bufp, chunk);
+            head += chunk;
+            bufp += chunk;
+            bytes -= chunk;
+            store(ring.m_head, head);
+        }
+        return true;
+    }
+    virtual bool recv(void* datap, size_t bytes) {
+        VerilatedCosimShmRing& ring = m_hdrp->m_rings[!m_side];
+        const vluint64_t capacity = m_hdrp->m_capacity;
+        const char* const basep = ringDatap(!m_side);
+        char* bufp = static_cast<char*>(datap);
+        vluint64_t tail = ring.m_tail;  // Only this side stores it
+        while (bytes) {
+            vluint64_t avail;
+            int spins = 0;
+            while (!(avail = load(ring.m_head) - tail)) {
+                // The partner's bytes before it closed are still read
+                if (load(m_hdrp->m_closed[!m_side]) && load(ring.m_head) == tail) return false;
+                wait(spins);
+            }
+            const size_t pos = tail % capacity;
+            size_t chunk = bytes;
+            if (chunk > avail) chunk = avail;
+            if (chunk > capacity - pos) chunk = capacity - pos;
+            memcpy(bufp, basep + pos, chunk);
+            tail += chunk;
+            bufp += chunk;
+            bytes -= chunk;
+            store(ring.m_tail, tail);
+        }
+        return true;
+    }
+    virtual size_t capacity() const { return m_hdrp->m_capacity; }
+};
+
+#endif  // VL_COSIM_NO_POSIX
+
+//=============================================================================
+// VerilatedCosimLink
+
+VerilatedCosimLink::VerilatedCosimLink()
+    : m_channelp(NULL)
+    , m_lookahead(0)
+    , m_exchanges(0) {}
+
+VerilatedCosimLink::~VerilatedCosimLink() { close(); }
+
+size_t VerilatedCosimLink::bitsBytes(int bits) VL_PURE {
+    if (bits <= 8) return sizeof(CData);
+    if (bits <= 16) return sizeof(SData);
+    if (bits <= VL_IDATASIZE) return sizeof(IData);
+    if (bits <= VL_QUADSIZE) return sizeof(QData);
+    return VL_WORDS_I(bits) * sizeof(EData);
+}
+
+void VerilatedCosimLink::fatal(const std::string& msg) VL_MT_UNSAFE {
+    const std::string where = m_where.empty() ? "VerilatedCosimLink" : m_where;
+    VL_FATAL_MT(where.c_str(), 0, "", msg.c_str());
+}
+
+void VerilatedCosimLink::addOutput(const char* namep, const void* datap, int bits) VL_MT_UNSAFE {
+    if (VL_UNLIKELY(m_channelp)) fatal("addOutput() after connecting");
+    Port port = {namep, const_cast<void*>(datap), bits, bitsBytes(bits)};
+    m_outputs.push_back(port);
+    m_sendBuf.resize(m_sendBuf.size() + port.m_bytes);
+}
+
+void VerilatedCosimLink::addInput(const char* namep, void* datap, int bits) VL_MT_UNSAFE {
+    if (VL_UNLIKELY(m_channelp)) fatal("addInput() after connecting");
+    Port port = {namep, datap, bits, bitsBytes(bits)};
+    m_inputs.push_back(port);
+}
+
+#ifdef VL_COSIM_NO_POSIX
+
+void VerilatedCosimLink::listenTcp(int) VL_MT_UNSAFE {
+    fatal("Unsupported: --cosim links on this platform");
+}
+void VerilatedCosimLink::connectTcp(const char*, int) VL_MT_UNSAFE {
+    fatal("Unsupported: --cosim links on this platform");
+}
+void VerilatedCosimLink::openShm(const char*, bool) VL_MT_UNSAFE {
+    fatal("Unsupported: --cosim links on this platform");
+}
+
+#else
+
+void VerilatedCosimLink::listenTcp(int port) VL_MT_UNSAFE {
+    close();
+    char buf[32];
+    VL_SNPRINTF(buf, sizeof(buf), "tcp:%d", port);
+    m_where = buf;
+    const int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (VL_UNLIKELY(listenFd < 0)) fatal(std::string("socket() failed: ") + strerror(errno));
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (VL_UNLIKELY(bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0
+                    || listen(listenFd, 1) < 0)) {
+        const std::string msg = std::string("Cannot listen: ") + strerror(errno);
+        ::close(listenFd);
+        fatal(msg);
+        return;
+    }
+    int fd;
+    while ((fd = accept(listenFd, NULL, NULL)) < 0 && errno == EINTR) {}
+    ::close(listenFd);
+    if (VL_UNLIKELY(fd < 0)) {
+        fatal(std::string("accept() failed: ") + strerror(errno));
+        return;
+    }
+    m_channelp = new VerilatedCosimTcp(fd);
+    handshake();
+}
+
+void VerilatedCosimLink::connectTcp(const char* hostp, int port) VL_MT_UNSAFE {
+    close();
+    char buf[32];
+    VL_SNPRINTF(buf, sizeof(buf), "%d", port);
+    m_where = std::string("tcp:") + hostp + ":" + buf;
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* infop = NULL;
+    const int err = getaddrinfo(hostp, buf, &hints, &infop);
+    if (VL_UNLIKELY(err)) {
+        fatal(std::string("Cannot resolve host: ") + gai_strerror(err));
+        return;
+    }
+    // The partner may not be listening yet
+    const time_t deadline = time(NULL) + VL_COSIM_CONNECT_SECS;
+    int fd = -1;
+    while (fd < 0) {
+        for (struct addrinfo* aip = infop; aip && fd < 0; aip = aip->ai_next) {
+            fd = socket(aip->ai_family, aip->ai_socktype, aip->ai_protocol);
+            if (fd >= 0 && connect(fd, aip->ai_addr, aip->ai_addrlen) < 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        if (fd < 0) {
+            if (time(NULL) > deadline) break;
+            usleep(100 * 1000);
+        }
+    }
+    freeaddrinfo(infop);
+    if (VL_UNLIKELY(fd < 0)) {
+        fatal(std::string("Cannot connect: ") + strerror(errno));
+        return;
+    }
+    m_channelp = new VerilatedCosimTcp(fd);
+    handshake();
+}
+
+void VerilatedCosimLink::openShm(const char* filenamep, bool create) VL_MT_UNSAFE {
+    close();
+    m_where = filenamep;
+    const size_t size = sizeof(VerilatedCosimShmHeader) + 2 * VL_COSIM_SHM_CAPACITY;
+    void* mapp = MAP_FAILED;
+    if (create) {
+        // A new file, so a partner still mapping a stale one can't see it as ready
+        unlink(filenamep);
+        const int fd = open(filenamep, O_RDWR | O_CREAT | O_EXCL, 0666);
+        if (fd >= 0 && !ftruncate(fd, size)) {
+            mapp = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (fd >= 0) ::close(fd);  // The mapping stays valid
+        if (VL_UNLIKELY(mapp == MAP_FAILED)) {
+            fatal(std::string("Cannot create co-simulation file: ") + strerror(errno));
+            return;
+        }
+        VerilatedCosimShmHeader* hdrp = static_cast<VerilatedCosimShmHeader*>(mapp);
+        hdrp->m_version = VL_COSIM_VERSION;
+        hdrp->m_capacity = VL_COSIM_SHM_CAPACITY;
+#ifdef __GNUC__
+        __atomic_store_n(&hdrp->m_magic, VL_COSIM_MAGIC, __ATOMIC_RELEASE);
+#else
+        hdrp->m_magic = VL_COSIM_MAGIC;
+#endif
+    } else {
+        // Wait for the partner to create and set up the file
+        const time_t deadline = time(NULL) + VL_COSIM_CONNECT_SECS;
+        while (true) {
+            const int fd = open(filenamep, O_RDWR);
+            struct stat st;
+            if (fd >= 0 && !fstat(fd, &st) && static_cast<size_t>(st.st_size) == size) {
+                mapp = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            if (fd >= 0) ::close(fd);
+            if (mapp != MAP_FAILED) {
+                VerilatedCosimShmHeader* hdrp = static_cast<VerilatedCosimShmHeader*>(mapp);
+#ifdef __GNUC__
+                const vluint32_t magic = __atomic_load_n(&hdrp->m_magic, __ATOMIC_ACQUIRE);
+#else
+                const vluint32_t magic = hdrp->m_magic;
+#endif
+                // A file whose creator closed it is from an earlier run
+                if (magic == VL_COSIM_MAGIC && !VerilatedCosimShm::load(hdrp->m_closed[0])) break;
+                munmap(mapp, size);
+                mapp = MAP_FAILED;
+            }
+            if (time(NULL) > deadline) {
+                fatal("Timeout waiting for the partner to create the co-simulation file");
+                return;
+            }
+            usleep(10 * 1000);
+        }
+        const VerilatedCosimShmHeader* hdrp = static_cast<VerilatedCosimShmHeader*>(mapp);
+        if (VL_UNLIKELY(hdrp->m_version != VL_COSIM_VERSION
+                        || hdrp->m_capacity != VL_COSIM_SHM_CAPACITY)) {
+            munmap(mapp, size);
+            fatal("Co-simulation file is from a different Verilator version");
+            return;
+        }
+    }
+    m_channelp = new VerilatedCosimShm(mapp, size, create ? 0 : 1);
+    handshake();
+}
+
+#endif  // VL_COSIM_NO_POSIX
+
+void VerilatedCosimLink::handshake() VL_MT_UNSAFE {
+    // Each side sends the list of its outputs, then reads the partner's
+    std::vector<vluint32_t> words;
+    words.push_back(VL_COSIM_MAGIC);
+    words.push_back(VL_COSIM_VERSION);
+    words.push_back(m_lookahead);
+    words.push_back(m_outputs.size());
+    std::string names;
+    for (std::vector<Port>::const_iterator it = m_outputs.begin(); it != m_outputs.end(); ++it) {
+        words.push_back(it->m_bits);
+        words.push_back(it->m_name.size());
+        names += it->m_name;
+    }
+    if (VL_UNLIKELY(!m_channelp->send(&words[0], words.size() * sizeof(vluint32_t))
+                    || !m_channelp->send(names.data(), names.size()))) {
+        fatal("Partner closed the link during connection");
+        return;
+    }
+
+    vluint32_t hdr[4];
+    if (VL_UNLIKELY(!m_channelp->recv(hdr, sizeof(hdr)))) {
+        fatal("Partner closed the link during connection");
+        return;
+    }
+    if (VL_UNLIKELY(hdr[0] != VL_COSIM_MAGIC || hdr[1] != VL_COSIM_VERSION)) {
+        fatal("Partner is not a Verilated co-simulation of this version");
+        return;
+    }
+    if (VL_UNLIKELY(hdr[2] != static_cast<vluint32_t>(m_lookahead))) {
+        fatal("Partner uses a different lookahead");
+        return;
+    }
+    std::vector<vluint32_t> ports(2 * hdr[3]);
+    if (VL_UNLIKELY(!ports.empty()
+                    && !m_channelp->recv(&ports[0], ports.size() * sizeof(vluint32_t)))) {
+        fatal("Partner closed the link during connection");
+        return;
+    }
+    m_maps.clear();
+    std::vector<bool> driven(m_inputs.size());
+    size_t offset = 0;
+    for (size_t i = 0; i < hdr[3]; ++i) {
+        const int bits = ports[2 * i];
+        std::string name(ports[2 * i + 1], '\0');
+        if (VL_UNLIKELY(!name.empty() && !m_channelp->recv(&name[0], name.size()))) {
+            fatal("Partner closed the link during connection");
+            return;
+        }
+        for (size_t in = 0; in < m_inputs.size(); ++in) {
+            if (m_inputs[in].m_name != name) continue;
+            if (VL_UNLIKELY(m_inputs[in].m_bits != bits)) {
+                fatal("Input '" + name + "' has a different width to the partner's output");
+                return;
+            }
+            Map map = {offset, m_inputs[in].m_datap, m_inputs[in].m_bytes};
+            m_maps.push_back(map);
+            driven[in] = true;
+        }
+        offset += bitsBytes(bits);
+    }
+    m_recvBuf.resize(offset);
+    for (size_t in = 0; in < m_inputs.size(); ++in) {
+        if (!driven[in]) {
+            VL_PRINTF_MT("%%Warning: %s: Input '%s' is not an output of the partner\n",
+                         m_where.c_str(), m_inputs[in].m_name.c_str());
+        }
+    }
+
+    // Both sides send up to lookahead + 1 batches before reading
+    const size_t capacity = m_channelp->capacity();
+    const size_t batch = offset > m_sendBuf.size() ? offset : m_sendBuf.size();
+    if (VL_UNLIKELY(capacity && batch * (m_lookahead + 1) > capacity)) {
+        fatal("Lookahead too large for the batch size; the link would deadlock");
+        return;
+    }
+    m_exchanges = 0;
+}
+
+void VerilatedCosimLink::close() VL_MT_UNSAFE {
+    if (m_channelp) {
+        delete m_channelp;
+        m_channelp = NULL;
+    }
+}
+
+bool VerilatedCosimLink::exchange() VL_MT_UNSAFE {
+    if (VL_UNLIKELY(!m_channelp)) {
+        fatal("exchange() before connecting");
+        return false;
+    }
+    if (!m_sendBuf.empty()) {
+        char* bufp = &m_sendBuf[0];
+        for (std::vector<Port>::const_iterator it = m_outputs.begin(); it != m_outputs.end();
+             ++it) {
+            memcpy(bufp, it->m_datap, it->m_bytes);
+            bufp += it->m_bytes;
+        }
+        if (VL_UNLIKELY(!m_channelp->send(&m_sendBuf[0], m_sendBuf.size()))) return false;
+    }
+    ++m_exchanges;
+    if (m_exchanges <= static_cast<vluint64_t>(m_lookahead)) return true;
+    if (!m_recvBuf.empty()) {
+        if (VL_UNLIKELY(!m_channelp->recv(&m_recvBuf[0], m_recvBuf.size()))) return false;
+        for (std::vector<Map>::const_iterator it = m_maps.begin(); it != m_maps.end(); ++it) {
+            memcpy(it->m_datap, &m_recvBuf[it->m_offset], it->m_bytes);
+        }
+    }
+    return true;
+}
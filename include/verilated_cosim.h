@@ -0,0 +1,115 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief Co-simulation of a partitioned design in several processes, see --cosim
+///
+/// Each process simulates one partition, and exchanges the values of its
+/// boundary ports with a partner process once per cycle, over a TCP socket
+/// (any host) or a memory mapped file (same host).
+///
+//=============================================================================
+
+#ifndef _VERILATED_COSIM_H_
+#define _VERILATED_COSIM_H_ 1
+
+#include "verilatedos.h"
+#include "verilated.h"
+
+#include <string>
+#include <vector>
+
+class VerilatedCosimChannel;
+
+//=============================================================================
+/// Link between partitions simulated in separate processes.
+///
+/// Each side registers the ports it exchanges, usually with the model's
+/// cosimPorts(link), connects to its partner, then calls exchange() once
+/// per cycle.  That sends the values of the side's outputs as one batch,
+/// and sets each of its inputs from the partner's output of the same name.
+/// With a lookahead of N the inputs are from the partner's batch sent N
+/// exchanges earlier, so the sides only wait on each other when one is
+/// more than N cycles ahead; use this for links whose logic tolerates the
+/// latency.  Both sides must use the same lookahead, and the same byte
+/// order.
+
+class VerilatedCosimLink {
+    // TYPES
+    struct Port {
+        std::string m_name;
+        void* m_datap;
+        int m_bits;
+        size_t m_bytes;  ///< Bytes of C storage for m_bits
+    };
+    struct Map {
+        size_t m_offset;  ///< Offset in the partner's batch
+        void* m_datap;  ///< Input to set
+        size_t m_bytes;
+    };
+    // MEMBERS
+    std::vector<Port> m_outputs;  ///< Values sent, in batch order
+    std::vector<Port> m_inputs;  ///< Values received
+    std::vector<Map> m_maps;  ///< Partner's outputs this side has as inputs
+    std::vector<char> m_sendBuf;  ///< Batch being sent
+    std::vector<char> m_recvBuf;  ///< Batch being received
+    VerilatedCosimChannel* m_channelp;  ///< Connection, or NULL
+    std::string m_where;  ///< Address of the connection, for messages
+    int m_lookahead;  ///< Exchanges the partner's values may lag
+    vluint64_t m_exchanges;  ///< Batches sent
+
+public:
+    // CONSTRUCTORS
+    VerilatedCosimLink();
+    ~VerilatedCosimLink();
+
+private:
+    VL_UNCOPYABLE(VerilatedCosimLink);
+
+public:
+    // METHODS
+    /// Register an output, whose value is sent on each exchange()
+    void addOutput(const char* namep, const void* datap, int bits) VL_MT_UNSAFE;
+    /// Register an input, set from the partner's output of the same name
+    void addInput(const char* namep, void* datap, int bits) VL_MT_UNSAFE;
+    /// Set exchanges the partner's values may lag, 0 for lockstep.  Set
+    /// before connecting.
+    void lookahead(int cycles) VL_MT_UNSAFE { m_lookahead = cycles < 0 ? 0 : cycles; }
+    int lookahead() const VL_MT_SAFE { return m_lookahead; }
+
+    /// Wait for the partner to connect to TCP 'port' on this host
+    void listenTcp(int port) VL_MT_UNSAFE;
+    /// Connect to the partner listening on 'hostp' TCP 'port', retrying
+    /// while it starts up
+    void connectTcp(const char* hostp, int port) VL_MT_UNSAFE;
+    /// Connect through a memory mapped file, best for partners on the same
+    /// host.  One side creates the file, and the other opens it, waiting
+    /// for it to be created.
+    void openShm(const char* filenamep, bool create) VL_MT_UNSAFE;
+    bool isOpen() const VL_MT_SAFE { return m_channelp != NULL; }
+    /// Close the connection; the partner's next exchange() returns false
+    void close() VL_MT_UNSAFE;
+
+    /// Send the outputs and receive the inputs, once per cycle.  Returns
+    /// false if the partner closed the link, leaving the inputs unchanged.
+    bool exchange() VL_MT_UNSAFE;
+    /// Number of exchanges made
+    vluint64_t exchanges() const VL_MT_SAFE { return m_exchanges; }
+
+private:
+    void handshake() VL_MT_UNSAFE;
+    void fatal(const std::string& msg) VL_MT_UNSAFE;
+    static size_t bitsBytes(int bits) VL_PURE;
+};
+
+#endif  // Guard
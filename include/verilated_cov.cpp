@@ -21,9 +21,23 @@
 #include "verilated_cov.h"
 #include "verilated_cov_key.h"
 
+#include <cstdio>
 #include <deque>
 #include <fstream>
 #include <map>
+#include <vector>
+
+//=============================================================================
+// A binary coverage file is, all numbers in host byte order:
+//   VL_COV_BINARY_MAGIC
+//   32-bit number of strings, then each a 32-bit length and the characters
+//   64-bit number of points, then each a 32-bit number of key/value pairs,
+//   and each pair as two 32-bit string indexes
+//   64-bit count of each point
+// The text format name of a point is each pair as "\001key\002value".
+// Keys are short keys, and strings are quoted as in the text format.
+
+#define VL_COV_BINARY_MAGIC "VLCOVB01"
 
 //=============================================================================
 // VerilatedCovImpBase
@@ -55,6 +69,8 @@ public:  // But only local to this file
     virtual ~VerilatedCovImpItem() {}
     virtual vluint64_t count() const = 0;
     virtual void zero() const = 0;
+    /// Counter if it is a single 32-bit counter, so may be copied as part of an array
+    virtual const vluint32_t* count32p() const { return NULL; }
 };
 
 //=============================================================================
@@ -72,6 +88,7 @@ public:
     // cppcheck-suppress truncLongCastReturn
     virtual vluint64_t count() const VL_OVERRIDE { return *m_countp; }
     virtual void zero() const VL_OVERRIDE { *m_countp = 0; }
+    virtual const vluint32_t* count32p() const VL_OVERRIDE { return asCount32p(m_countp); }
     // CONSTRUCTORS
     // cppcheck-suppress noExplicitConstructor
     explicit VerilatedCoverItemSpec(T* countp)
@@ -79,6 +96,40 @@ public:
         *m_countp = 0;
     }
     virtual ~VerilatedCoverItemSpec() VL_OVERRIDE {}
+
+private:
+    static const vluint32_t* asCount32p(const vluint32_t* countp) { return countp; }
+    static const vluint32_t* asCount32p(const vluint64_t*) { return NULL; }
+};
+
+//=============================================================================
+/// VerilatedCoverItemSum is a coverage item counted in several places,
+/// such as one counter per thread, so threads don't share cache lines.
+
+template <class T> class VerilatedCoverItemSum : public VerilatedCovImpItem {
+private:
+    // MEMBERS
+    T* m_countp;  ///< First count value
+    size_t m_stride;  ///< Distance between count values
+    int m_copies;  ///< Number of count values
+public:
+    // METHODS
+    virtual vluint64_t count() const VL_OVERRIDE {
+        vluint64_t sum = 0;
+        for (int i = 0; i < m_copies; ++i) sum += m_countp[i * m_stride];
+        return sum;
+    }
+    virtual void zero() const VL_OVERRIDE {
+        for (int i = 0; i < m_copies; ++i) m_countp[i * m_stride] = 0;
+    }
+    // CONSTRUCTORS
+    VerilatedCoverItemSum(T* countp, size_t stride, int copies)
+        : m_countp(countp)
+        , m_stride(stride)
+        , m_copies(copies) {
+        zero();
+    }
+    virtual ~VerilatedCoverItemSum() VL_OVERRIDE {}
 };
 
 //=============================================================================
@@ -93,6 +144,19 @@ private:
     typedef std::map<std::string, int> ValueIndexMap;
     typedef std::map<int, std::string> IndexValueMap;
     typedef std::deque<VerilatedCovImpItem*> ItemList;
+    /// Consecutive items, whose counters are consecutive 32-bit counters
+    /// if m_count32p, so snapshots can copy them as one array
+    struct ItemRun {
+        size_t m_first;  ///< Index in m_items of first item
+        size_t m_items;  ///< Number of items
+        const vluint32_t* m_count32p;  ///< First counter, or NULL if items are read one by one
+    };
+    typedef std::vector<ItemRun> ItemRunList;
+    /// Totaled coverage point, for writeBinary
+    struct BinaryPoint {
+        std::string m_hier;  ///< Combined hierarchy
+        vluint64_t m_count;  ///< Total count
+    };
 
 private:
     // MEMBERS
@@ -100,6 +164,8 @@ private:
     ValueIndexMap m_valueIndexes VL_GUARDED_BY(m_mutex);  ///< Unique arbitrary value for values
     IndexValueMap m_indexValues VL_GUARDED_BY(m_mutex);  ///< Unique arbitrary value for keys
     ItemList m_items VL_GUARDED_BY(m_mutex);  ///< List of all items
+    ItemRunList m_itemRuns VL_GUARDED_BY(m_mutex);  ///< m_items as runs for snapshots
+    vluint32_t m_itemsGeneration VL_GUARDED_BY(m_mutex);  ///< Changed when items are removed
 
     VerilatedCovImpItem* m_insertp VL_GUARDED_BY(m_mutex);  ///< Item about to insert
     const char* m_insertFilenamep VL_GUARDED_BY(m_mutex);  ///< Filename about to insert
@@ -110,6 +176,7 @@ private:
         m_insertp = NULL;
         m_insertFilenamep = NULL;
         m_insertLineno = 0;
+        m_itemsGeneration = 0;
     }
     VL_UNCOPYABLE(VerilatedCovImp);
 
@@ -244,6 +311,26 @@ private:
         m_items.clear();
         m_indexValues.clear();
         m_valueIndexes.clear();
+        itemsRemoved();
+    }
+    void itemsRemoved() VL_REQUIRES(m_mutex) {
+        // Snapshots no longer line up with the items
+        ++m_itemsGeneration;
+        m_itemRuns.clear();
+        for (size_t i = 0; i < m_items.size(); ++i) itemRunsAdd(i);
+    }
+    void itemRunsAdd(size_t index) VL_REQUIRES(m_mutex) {
+        const vluint32_t* count32p = m_items[index]->count32p();
+        if (!m_itemRuns.empty()) {
+            ItemRun& run = m_itemRuns.back();
+            if (count32p ? (run.m_count32p && run.m_count32p + run.m_items == count32p)
+                         : !run.m_count32p) {
+                ++run.m_items;
+                return;
+            }
+        }
+        const ItemRun run = {index, 1, count32p};
+        m_itemRuns.push_back(run);
     }
 
 public:
@@ -266,7 +353,10 @@ public:
                     newlist.push_back(itemp);
                 }
             }
-            m_items = newlist;
+            if (newlist.size() != m_items.size()) {
+                m_items = newlist;
+                itemsRemoved();
+            }
         }
     }
     void zero() VL_EXCLUDES(m_mutex) {
@@ -276,6 +366,27 @@ public:
             (*it)->zero();
         }
     }
+    void snapshot(VerilatedCovSnapshot& snap) VL_EXCLUDES(m_mutex) {
+        Verilated::quiesce();
+        VerilatedLockGuard lock(m_mutex);
+        snapshotGuts(snap);
+    }
+    void snapshotGuts(VerilatedCovSnapshot& snap) VL_REQUIRES(m_mutex) {
+        snap.m_generation = m_itemsGeneration;
+        snap.m_counts.resize(m_items.size());
+        vluint64_t* countsp = snap.m_counts.empty() ? NULL : &snap.m_counts[0];
+        for (ItemRunList::const_iterator it = m_itemRuns.begin(); it != m_itemRuns.end(); ++it) {
+            vluint64_t* const dstp = countsp + it->m_first;
+            if (const vluint32_t* const srcp = it->m_count32p) {
+                // Generated code's counters are an array, so this is a simple copy
+                for (size_t i = 0; i < it->m_items; ++i) dstp[i] = srcp[i];
+            } else {
+                for (size_t i = 0; i < it->m_items; ++i) {
+                    dstp[i] = m_items[it->m_first + i]->count();
+                }
+            }
+        }
+    }
 
     // We assume there's always call to i/f/p in that order
     void inserti(VerilatedCovImpItem* itemp) VL_EXCLUDES(m_mutex) {
@@ -341,6 +452,7 @@ public:
             }
         }
         m_items.push_back(m_insertp);
+        itemRunsAdd(m_items.size() - 1);
         // Prepare for next
         m_insertp = NULL;
     }
@@ -348,6 +460,35 @@ public:
     void write(const char* filename) VL_EXCLUDES(m_mutex) {
         Verilated::quiesce();
         VerilatedLockGuard lock(m_mutex);
+        writeGuts(filename, NULL);
+    }
+    void writeDelta(const char* filename, const VerilatedCovSnapshot& from,
+                    const VerilatedCovSnapshot* top) VL_EXCLUDES(m_mutex) {
+        Verilated::quiesce();
+        VerilatedLockGuard lock(m_mutex);
+        VerilatedCovSnapshot now;
+        if (!top) {
+            snapshotGuts(now);
+            top = &now;
+        }
+        if (from.m_generation != m_itemsGeneration || top->m_generation != m_itemsGeneration) {
+            VL_FATAL_MT("", 0, "",
+                        "%Error: VerilatedCov::writeDelta snapshot taken before items were "
+                        "cleared\n");
+        }
+        // Items inserted after a snapshot count from zero
+        std::vector<vluint64_t> deltas(top->m_counts.size());
+        for (size_t i = 0; i < deltas.size(); ++i) {
+            const vluint64_t before = i < from.m_counts.size() ? from.m_counts[i] : 0;
+            // If zeroed between the snapshots, all of the later count is new
+            const vluint64_t after = top->m_counts[i];
+            deltas[i] = after >= before ? after - before : after;
+        }
+        writeGuts(filename, &deltas);
+    }
+    // Write the items, or if deltasp, only items with a nonzero delta count
+    void writeGuts(const char* filename, const std::vector<vluint64_t>* deltasp)
+        VL_REQUIRES(m_mutex) {
 #ifndef VM_COVERAGE
         VL_FATAL_MT("", 0, "", "%Error: Called VerilatedCov::write when VM_COVERAGE disabled\n");
 #endif
@@ -364,8 +505,15 @@ public:
         // Build list of events; totalize if collapsing hierarchy
         typedef std::map<std::string, std::pair<std::string, vluint64_t> > EventMap;
         EventMap eventCounts;
-        for (ItemList::iterator it = m_items.begin(); it != m_items.end(); ++it) {
-            VerilatedCovImpItem* itemp = *(it);
+        for (size_t index = 0; index < m_items.size(); ++index) {
+            VerilatedCovImpItem* itemp = m_items[index];
+            vluint64_t count;
+            if (deltasp) {
+                if (index >= deltasp->size() || !(*deltasp)[index]) continue;
+                count = (*deltasp)[index];
+            } else {
+                count = itemp->count();
+            }
             std::string name;
             std::string hier;
             bool per_instance = false;
@@ -399,10 +547,10 @@ public:
             EventMap::iterator cit = eventCounts.find(name);
             if (cit != eventCounts.end()) {
                 const std::string& oldhier = cit->second.first;
-                cit->second.second += itemp->count();
+                cit->second.second += count;
                 cit->second.first = combineHier(oldhier, hier);
             } else {
-                eventCounts.insert(std::make_pair(name, make_pair(hier, itemp->count())));
+                eventCounts.insert(std::make_pair(name, make_pair(hier, count)));
             }
         }
 
@@ -415,6 +563,122 @@ public:
             os << std::endl;
         }
     }
+
+    void writeBinary(const char* filename) VL_EXCLUDES(m_mutex) {
+        Verilated::quiesce();
+        VerilatedLockGuard lock(m_mutex);
+#ifndef VM_COVERAGE
+        VL_FATAL_MT("", 0, "", "%Error: Called VerilatedCov::write when VM_COVERAGE disabled\n");
+#endif
+        // Same points as write(), but the items' value indexes are used
+        // as is, so no per-point strings are made.  The file's string
+        // table is made of the values that are used, after quoting.
+        std::vector<vluint32_t> fileIndex;  // File string index + 1 of each value index, or 0
+        std::vector<std::string> strings;  // File string table
+        const int hierIndex = valueIndex(VL_CIK_HIER);
+        const int perIndex = valueIndex(VL_CIK_PER_INSTANCE);
+        const vluint32_t hierKey = fileString(fileIndex, strings, hierIndex);
+
+        // Points are the items' key/value pairs, less the hier unless
+        // per_instance; items with the same pairs are totaled
+        typedef std::vector<vluint32_t> Pairs;
+        typedef std::map<Pairs, BinaryPoint> PointMap;
+        PointMap points;
+        std::vector<int> shortKeys;  // Value index of short key for each key, or 0
+        for (ItemList::iterator it = m_items.begin(); it != m_items.end(); ++it) {
+            VerilatedCovImpItem* itemp = *(it);
+            Pairs pairs;
+            int hierVal = KEY_UNDEF;
+            bool per_instance = false;
+            for (int i = 0; i < MAX_KEYS; ++i) {
+                int key = itemp->m_keys[i];
+                if (key == KEY_UNDEF) continue;
+                const int val = itemp->m_vals[i];
+                if (key >= static_cast<int>(shortKeys.size())) shortKeys.resize(key + 1);
+                if (!shortKeys[key]) {
+                    shortKeys[key] = valueIndex(VerilatedCovKey::shortKey(m_indexValues[key]));
+                }
+                key = shortKeys[key];
+                if (key == perIndex && m_indexValues[val] != "0") per_instance = true;
+                if (key == hierIndex) {
+                    hierVal = val;
+                } else {
+                    pairs.push_back(fileString(fileIndex, strings, key));
+                    pairs.push_back(fileString(fileIndex, strings, val));
+                }
+            }
+            std::string hier = hierVal == KEY_UNDEF ? "" : m_indexValues[hierVal];
+            if (per_instance) {  // Not collapsing hierarchies
+                pairs.push_back(hierKey);
+                pairs.push_back(fileString(fileIndex, strings, valueIndex(hier)));
+                hier = "";
+            }
+            std::pair<PointMap::iterator, bool> got
+                = points.insert(std::make_pair(pairs, BinaryPoint()));
+            BinaryPoint& point = got.first->second;
+            if (got.second) {
+                point.m_hier = hier;
+                point.m_count = itemp->count();
+            } else {
+                point.m_hier = combineHier(point.m_hier, hier);
+                point.m_count += itemp->count();
+            }
+        }
+
+        // Output
+        std::string out = VL_COV_BINARY_MAGIC;
+        std::vector<vluint64_t> counts;
+        counts.reserve(points.size());
+        std::string body;
+        const vluint64_t npoints = points.size();
+        binaryPut(body, &npoints, sizeof(npoints));
+        for (PointMap::iterator it = points.begin(); it != points.end(); ++it) {
+            const Pairs& pairs = it->first;
+            vluint32_t npairs = pairs.size() / 2;
+            if (!it->second.m_hier.empty()) ++npairs;
+            binaryPut(body, &npairs, sizeof(npairs));
+            if (!pairs.empty()) binaryPut(body, &pairs[0], pairs.size() * sizeof(pairs[0]));
+            if (!it->second.m_hier.empty()) {
+                const vluint32_t hier[2] = {hierKey, static_cast<vluint32_t>(strings.size())};
+                strings.push_back(dequote(it->second.m_hier));
+                binaryPut(body, hier, sizeof(hier));
+            }
+            counts.push_back(it->second.m_count);
+        }
+        const vluint32_t nstrings = strings.size();
+        binaryPut(out, &nstrings, sizeof(nstrings));
+        for (std::vector<std::string>::const_iterator it = strings.begin(); it != strings.end();
+             ++it) {
+            const vluint32_t len = it->size();
+            binaryPut(out, &len, sizeof(len));
+            out += *it;
+        }
+        out += body;
+        if (!counts.empty()) binaryPut(out, &counts[0], counts.size() * sizeof(counts[0]));
+
+        std::FILE* fp = std::fopen(filename, "wb");
+        bool ok = fp && std::fwrite(out.data(), 1, out.size(), fp) == out.size();
+        if (fp && std::fclose(fp)) ok = false;
+        if (!ok) {
+            std::string msg = std::string("%Error: Can't write '") + filename + "'";
+            VL_FATAL_MT("", 0, "", msg.c_str());
+        }
+    }
+
+private:
+    // Index in the binary file's string table of the given value index
+    vluint32_t fileString(std::vector<vluint32_t>& fileIndex, std::vector<std::string>& strings,
+                          int value) VL_REQUIRES(m_mutex) {
+        if (value >= static_cast<int>(fileIndex.size())) fileIndex.resize(value + 1);
+        if (!fileIndex[value]) {
+            strings.push_back(dequote(m_indexValues[value]));
+            fileIndex[value] = strings.size();
+        }
+        return fileIndex[value] - 1;
+    }
+    static void binaryPut(std::string& out, const void* datap, size_t size) {
+        out.append(static_cast<const char*>(datap), size);
+    }
 };
 
 //=============================================================================
@@ -428,12 +692,28 @@ void VerilatedCov::zero() VL_MT_SAFE { VerilatedCovImp::imp().zero(); }
 void VerilatedCov::write(const char* filenamep) VL_MT_SAFE {
     VerilatedCovImp::imp().write(filenamep);
 }
+void VerilatedCov::writeBinary(const char* filenamep) VL_MT_SAFE {
+    VerilatedCovImp::imp().writeBinary(filenamep);
+}
+void VerilatedCov::snapshot(VerilatedCovSnapshot& snap) VL_MT_SAFE {
+    VerilatedCovImp::imp().snapshot(snap);
+}
+void VerilatedCov::writeDelta(const char* filenamep, const VerilatedCovSnapshot& from) VL_MT_SAFE {
+    VerilatedCovImp::imp().writeDelta(filenamep, from, NULL);
+}
+void VerilatedCov::writeDelta(const char* filenamep, const VerilatedCovSnapshot& from,
+                              const VerilatedCovSnapshot& to) VL_MT_SAFE {
+    VerilatedCovImp::imp().writeDelta(filenamep, from, &to);
+}
 void VerilatedCov::_inserti(vluint32_t* itemp) VL_MT_SAFE {
     VerilatedCovImp::imp().inserti(new VerilatedCoverItemSpec<vluint32_t>(itemp));
 }
 void VerilatedCov::_inserti(vluint64_t* itemp) VL_MT_SAFE {
     VerilatedCovImp::imp().inserti(new VerilatedCoverItemSpec<vluint64_t>(itemp));
 }
+void VerilatedCov::_inserti(vluint32_t* itemp, size_t stride, int copies) VL_MT_SAFE {
+    VerilatedCovImp::imp().inserti(new VerilatedCoverItemSum<vluint32_t>(itemp, stride, copies));
+}
 void VerilatedCov::_insertf(const char* filename, int lineno) VL_MT_SAFE {
     VerilatedCovImp::imp().insertf(filename, lineno);
 }
@@ -24,6 +24,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 //=============================================================================
 /// Conditionally compile coverage code
@@ -72,6 +73,14 @@
     VL_IF_COVER(VerilatedCov::_inserti(countp); VerilatedCov::_insertf(__FILE__, __LINE__); \
                 VerilatedCov::_insertp("hier", name(), __VA_ARGS__))
 
+/// Insert an item whose count is the sum of several counters, such as one
+/// per thread.  countp points to the first of 'copies' counters, each
+/// 'stride' counters after the previous.
+#define VL_COVER_INSERT_SUM(countp, stride, copies, ...) \
+    VL_IF_COVER(VerilatedCov::_inserti(countp, stride, copies); \
+                VerilatedCov::_insertf(__FILE__, __LINE__); \
+                VerilatedCov::_insertp("hier", name(), __VA_ARGS__))
+
 //=============================================================================
 /// Convert VL_COVER_INSERT value arguments to strings
 
@@ -81,6 +90,22 @@ template <class T> std::string vlCovCvtToStr(const T& t) VL_PURE {
     return os.str();
 }
 
+//=============================================================================
+//  VerilatedCovSnapshot
+///  Copy of all coverage counts at one time, see VerilatedCov::snapshot
+
+class VerilatedCovSnapshot {
+    friend class VerilatedCovImp;
+    std::vector<vluint64_t> m_counts;  ///< Count of each item
+    vluint32_t m_generation;  ///< Items generation the snapshot is of
+
+public:
+    VerilatedCovSnapshot()
+        : m_generation(0) {}
+    /// Number of coverage items in the snapshot
+    size_t size() const { return m_counts.size(); }
+};
+
 //=============================================================================
 //  VerilatedCov
 ///  Verilator coverage global class
@@ -97,6 +122,18 @@ public:
     static const char* defaultFilename() VL_PURE { return "coverage.dat"; }
     /// Write all coverage data to a file
     static void write(const char* filenamep = defaultFilename()) VL_MT_SAFE;
+    /// Write all coverage data to a file in binary, which is much faster
+    /// to write for large numbers of points.  verilator_coverage reads
+    /// either format, and its --write converts to the text format.
+    static void writeBinary(const char* filenamep = defaultFilename()) VL_MT_SAFE;
+    /// Copy all coverage counts to snap, much faster than a write, for
+    /// later passing to writeDelta
+    static void snapshot(VerilatedCovSnapshot& snap) VL_MT_SAFE;
+    /// Write only the coverage points with hits since snapshot 'from', or
+    /// between snapshots 'from' and 'to', to a file
+    static void writeDelta(const char* filenamep, const VerilatedCovSnapshot& from) VL_MT_SAFE;
+    static void writeDelta(const char* filenamep, const VerilatedCovSnapshot& from,
+                           const VerilatedCovSnapshot& to) VL_MT_SAFE;
     /// Insert a coverage item
     /// We accept from 1-30 key/value pairs, all as strings.
     /// Call _insert1, followed by _insert2 and _insert3
@@ -104,6 +141,7 @@ public:
     // _insert1: Remember item pointer with count.  (Not const, as may add zeroing function)
     static void _inserti(vluint32_t* itemp) VL_MT_SAFE;
     static void _inserti(vluint64_t* itemp) VL_MT_SAFE;
+    static void _inserti(vluint32_t* itemp, size_t stride, int copies) VL_MT_SAFE;
     // _insert2: Set default filename and line number
     static void _insertf(const char* filename, int lineno) VL_MT_SAFE;
     // _insert3: Set parameters
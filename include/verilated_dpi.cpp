@@ -34,6 +34,11 @@
 
 #include "vltstd/svdpi.h"
 
+#include <vector>
+#ifdef VL_THREADED
+# include <condition_variable>
+#endif
+
 //======================================================================
 // Internal macros
 
@@ -216,6 +221,35 @@ int svSizeOfArray(const svOpenArrayHandle h) {
     return static_cast<int>(varp->totalSize());
 }
 
+//======================================================================
+// Open array direct access
+
+VerilatedDpiOpenArrayView::VerilatedDpiOpenArrayView(const svOpenArrayHandle h) VL_MT_SAFE
+    : m_datap(NULL)
+    , m_offset(0)
+    , m_entSize(0)
+    , m_dims(0) {
+    const VerilatedDpiOpenVar* varp = _vl_openhandle_varp(h);
+    int dims = varp->udims();
+    m_strides[0] = m_strides[1] = m_strides[2] = 0;
+    if (VL_UNLIKELY(dims < 1 || dims > 3)) {
+        _VL_SVDPI_WARN("%%Warning: DPI VerilatedDpiOpenArrayView constructed on"
+                       " %d dimensional array; must have 1 to 3 dimensions.\n",
+                       dims);
+        return;
+    }
+    m_entSize = varp->entSize();
+    // Same layout as datapAdjustIndex: the last dimension is contiguous
+    ptrdiff_t stride = static_cast<ptrdiff_t>(m_entSize);
+    for (int dim = dims; dim >= 1; --dim) {
+        m_strides[dim - 1] = stride;
+        m_offset -= varp->low(dim) * stride;
+        stride *= varp->elements(dim);
+    }
+    m_datap = static_cast<vluint8_t*>(varp->datap());
+    m_dims = dims;
+}
+
 //======================================================================
 // Open array access internals
 
@@ -847,3 +881,118 @@ int svIsDisabledState() {
 void svAckDisabledState() {
     // Disables not implemented
 }
+
+//======================================================================
+// Asynchronous DPI imports
+
+#ifdef VL_THREADED
+
+// Calls queued by one producer thread, consumed under s_dpiAsync.m_drainMutex.
+// Each call is a word holding the Func, a word holding the argument
+// count, then the argument words.
+struct VerilatedDpiAsyncQueue {
+    enum { WORDS = 1 << 14 };  // Power of two
+    std::atomic<size_t> m_head;  // Next word to drain, written by consumer
+    std::atomic<size_t> m_tail;  // Next word to push, written by producer
+    vluint64_t m_words[WORDS];
+    VerilatedDpiAsyncQueue()
+        : m_head(0)
+        , m_tail(0) {}
+};
+
+static struct {
+    VerilatedMutex m_queuesMutex;  // Protects m_queues
+    std::vector<VerilatedDpiAsyncQueue*> m_queues VL_GUARDED_BY(m_queuesMutex);
+    VerilatedMutex m_drainMutex;  // One drain at a time
+    VerilatedMutex m_flushMutex;  // Protects m_flushes
+    std::condition_variable_any m_flushCv;  // Signals change of m_flushes
+    vluint64_t m_flushes VL_GUARDED_BY(m_flushMutex);  // Count of flush() and wakeup()
+    std::atomic<bool> m_pending;  // Calls pushed since last flush()
+} s_dpiAsync;
+
+// Queue of this thread, created on first push.  Queues are never freed, as the
+// consumer may still be reading them when a thread exits.
+static VL_THREAD_LOCAL VerilatedDpiAsyncQueue* t_dpiAsyncQueuep = NULL;
+
+static VerilatedDpiAsyncQueue* dpiAsyncQueueAt(size_t index) VL_MT_SAFE {
+    VerilatedLockGuard lock(s_dpiAsync.m_queuesMutex);
+    return index < s_dpiAsync.m_queues.size() ? s_dpiAsync.m_queues[index] : NULL;
+}
+
+void VerilatedDpiAsync::push(Func funcp, int nargs, const vluint64_t* argsp) VL_MT_SAFE {
+    VerilatedDpiAsyncQueue* qp = t_dpiAsyncQueuep;
+    if (VL_UNLIKELY(!qp)) {
+        qp = t_dpiAsyncQueuep = new VerilatedDpiAsyncQueue;
+        VerilatedLockGuard lock(s_dpiAsync.m_queuesMutex);
+        s_dpiAsync.m_queues.push_back(qp);
+    }
+    const size_t mask = VerilatedDpiAsyncQueue::WORDS - 1;
+    const size_t need = 2 + nargs;
+    size_t tail = qp->m_tail.load(std::memory_order_relaxed);
+    while (VL_UNLIKELY(tail + need - qp->m_head.load(std::memory_order_acquire)
+                       > VerilatedDpiAsyncQueue::WORDS)) {
+        drain();  // Full; make the calls ourself rather than wait for the consumer
+    }
+    qp->m_words[tail & mask] = pack(funcp);
+    qp->m_words[(tail + 1) & mask] = nargs;
+    for (int i = 0; i < nargs; ++i) qp->m_words[(tail + 2 + i) & mask] = argsp[i];
+    qp->m_tail.store(tail + need, std::memory_order_release);
+    if (!s_dpiAsync.m_pending.load(std::memory_order_relaxed)) {
+        s_dpiAsync.m_pending.store(true, std::memory_order_relaxed);
+    }
+}
+
+void VerilatedDpiAsync::flush() VL_MT_SAFE {
+    if (!s_dpiAsync.m_pending.load(std::memory_order_relaxed)) return;
+    s_dpiAsync.m_pending.store(false, std::memory_order_relaxed);
+    wakeup();
+}
+
+void VerilatedDpiAsync::wakeup() VL_MT_SAFE {
+    {
+        VerilatedLockGuard lock(s_dpiAsync.m_flushMutex);
+        ++s_dpiAsync.m_flushes;
+    }
+    s_dpiAsync.m_flushCv.notify_all();
+}
+
+void VerilatedDpiAsync::waitFlush() VL_MT_SAFE {
+    VerilatedLockGuard lock(s_dpiAsync.m_flushMutex);
+    vluint64_t flushes = s_dpiAsync.m_flushes;
+    while (flushes == s_dpiAsync.m_flushes) s_dpiAsync.m_flushCv.wait(lock);
+}
+
+size_t VerilatedDpiAsync::drain() VL_MT_SAFE {
+    VerilatedLockGuard lock(s_dpiAsync.m_drainMutex);
+    const size_t mask = VerilatedDpiAsyncQueue::WORDS - 1;
+    size_t calls = 0;
+    for (size_t q = 0; VerilatedDpiAsyncQueue* qp = dpiAsyncQueueAt(q); ++q) {
+        size_t head = qp->m_head.load(std::memory_order_relaxed);
+        size_t tail = qp->m_tail.load(std::memory_order_acquire);
+        while (head != tail) {
+            Func funcp;
+            unpack(qp->m_words[head & mask], funcp);
+            int nargs = static_cast<int>(qp->m_words[(head + 1) & mask]);
+            vluint64_t args[VL_DPI_ASYNC_ARGS_MAX];
+            for (int i = 0; i < nargs; ++i) args[i] = qp->m_words[(head + 2 + i) & mask];
+            head += 2 + nargs;
+            // Free the space before the call, which may be slow
+            qp->m_head.store(head, std::memory_order_release);
+            funcp(args);
+            ++calls;
+        }
+    }
+    return calls;
+}
+
+#else  // !VL_THREADED
+
+void VerilatedDpiAsync::push(Func funcp, int, const vluint64_t* argsp) VL_MT_SAFE {
+    funcp(argsp);
+}
+void VerilatedDpiAsync::flush() VL_MT_SAFE {}
+void VerilatedDpiAsync::wakeup() VL_MT_SAFE {}
+void VerilatedDpiAsync::waitFlush() VL_MT_SAFE {}
+size_t VerilatedDpiAsync::drain() VL_MT_SAFE { return 0; }
+
+#endif  // VL_THREADED
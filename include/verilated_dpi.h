@@ -29,6 +29,8 @@
 
 #include "svdpi.h"
 
+#include <cstddef>
+
 //===================================================================
 // SETTING OPERATORS
 
@@ -87,6 +89,82 @@ static inline void VL_SET_SVLV_Q(int, svLogicVecVal* owp, QData ld) VL_MT_SAFE {
     owp[1].bval = 0;
 }
 
+//===================================================================
+// Verilator extension: direct open array element access
+
+/// Base pointer and strides of an open array, so DPI code may access many
+/// elements directly after one call, instead of calling svGetArrElemPtr
+/// for each element.  Elements are in Verilator's internal representation
+/// (CData, SData, IData, QData, or EData words when wider than 64 bits).
+/// Element pointers are not range checked; see svLow/svHigh for limits.
+
+class VerilatedDpiOpenArrayView {
+    vluint8_t* m_datap;  // Array data
+    ptrdiff_t m_offset;  // Bytes from m_datap to index zero in every dimension
+    ptrdiff_t m_strides[3];  // Bytes between successive indices of each dimension
+    size_t m_entSize;  // Bytes in each element
+    int m_dims;  // Unpacked dimensions
+
+public:
+    /// Look up an open array; ok() is false if the handle is not an array
+    /// of 1 to 3 unpacked dimensions
+    explicit VerilatedDpiOpenArrayView(const svOpenArrayHandle h) VL_MT_SAFE;
+    ~VerilatedDpiOpenArrayView() {}
+    bool ok() const { return m_dims != 0; }
+    int dims() const { return m_dims; }
+    size_t entSize() const { return m_entSize; }
+    /// Bytes between elements with successive indices of dimension 1 to 3
+    ptrdiff_t stride(int dim) const { return m_strides[dim - 1]; }
+    void* elemp(int indx1) const { return m_datap + (m_offset + indx1 * m_strides[0]); }
+    void* elemp(int indx1, int indx2) const {
+        return m_datap + (m_offset + indx1 * m_strides[0] + indx2 * m_strides[1]);
+    }
+    void* elemp(int indx1, int indx2, int indx3) const {
+        return m_datap
+               + (m_offset + indx1 * m_strides[0] + indx2 * m_strides[1]
+                  + indx3 * m_strides[2]);
+    }
+};
+
+//===================================================================
+// Verilator extension: asynchronous DPI imports
+
+/// Queues calls to DPI imports given the "async" configuration file
+/// directive.  With --threads, each call appends its arguments to a
+/// lock-free queue owned by the calling thread, and returns without calling
+/// the import.  A consumer thread provided by the application makes the
+/// calls with drain(), typically looping on waitFlush(), which returns after
+/// each eval() that queued calls.  Calls made by one thread are made in
+/// order.  Should a queue fill, the calling thread drains the queues
+/// itself.  Without --threads, the imports are called immediately.
+
+class VerilatedDpiAsync {
+public:
+    // TYPES
+    typedef void (*Func)(const vluint64_t* argsp);  ///< Calls an import with queued arguments
+
+    // METHODS - for the consumer
+    /// Call all queued imports, returning the number of calls made
+    static size_t drain() VL_MT_SAFE;
+    /// Wait until an eval() that queued calls has finished, or wakeup()
+    static void waitFlush() VL_MT_SAFE;
+    /// Release any waitFlush(), e.g. at shutdown
+    static void wakeup() VL_MT_SAFE;
+
+    // METHODS - internal, called by generated code
+    static void push(Func funcp, int nargs, const vluint64_t* argsp) VL_MT_SAFE;
+    static void flush() VL_MT_SAFE;
+    /// Convert an argument of at most 8 bytes to and from a queue word
+    template <class T> static vluint64_t pack(const T& value) {
+        vluint64_t word = 0;
+        memcpy(&word, &value, sizeof(T));
+        return word;
+    }
+    template <class T> static void unpack(vluint64_t word, T& valuer) {
+        memcpy(&valuer, &word, sizeof(T));
+    }
+};
+
 //======================================================================
 
 #endif  // Guard
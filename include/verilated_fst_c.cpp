@@ -64,13 +64,11 @@
 
 VerilatedFst::VerilatedFst(void* fst)
     : m_fst(fst)
-    , m_symbolp(NULL)
-    , m_strbuf(NULL) {}
+    , m_symbolp(NULL) {}
 
 VerilatedFst::~VerilatedFst() {
     if (m_fst) fstWriterClose(m_fst);
     if (m_symbolp) VL_DO_CLEAR(delete[] m_symbolp, m_symbolp = NULL);
-    if (m_strbuf) VL_DO_CLEAR(delete[] m_strbuf, m_strbuf = NULL);
 }
 
 void VerilatedFst::open(const char* filename) VL_MT_UNSAFE {
@@ -81,6 +79,9 @@ void VerilatedFst::open(const char* filename) VL_MT_UNSAFE {
 #ifdef VL_TRACE_FST_WRITER_THREAD
     fstWriterSetParallelMode(m_fst, 1);
 #endif
+#ifdef VL_TRACE_FST_COMPRESS_THREADS
+    fstWriterSetCompressThreads(m_fst, VL_TRACE_FST_COMPRESS_THREADS);
+#endif
 
     m_curScope.clear();
 
@@ -102,9 +103,6 @@ void VerilatedFst::open(const char* filename) VL_MT_UNSAFE {
         }
     }
     m_code2symbol.clear();
-
-    // Allocate string buffer for arrays
-    if (!m_strbuf) { m_strbuf = new char[maxBits() + 32]; }
 }
 
 void VerilatedFst::close() {
@@ -136,7 +134,7 @@ void VerilatedFst::declare(vluint32_t code, const char* name, int dtypenum, fstV
                            fstVarType vartype, bool array, int arraynum, int msb, int lsb) {
     const int bits = ((msb > lsb) ? (msb - lsb) : (lsb - msb)) + 1;
 
-    VerilatedTrace<VerilatedFst>::declCode(code, bits, false);
+    if (!VerilatedTrace<VerilatedFst>::declCode(code, name, bits, false)) return;
 
     std::pair<Code2SymbolType::iterator, bool> p
         = m_code2symbol.insert(std::make_pair(code, static_cast<fstHandle>(NULL)));
@@ -213,7 +211,8 @@ void VerilatedFst::declDouble(vluint32_t code, const char* name, int dtypenum, f
 
 // Note: emit* are only ever called from one place (full* in
 // verilated_trace_imp.cpp, which is included in this file at the top),
-// so always inline them.
+// so always inline them.  Values are passed as integers, which the FST
+// writer packs directly, rather than as strings of '0'/'1' characters.
 
 VL_ATTR_ALWINLINE
 void VerilatedFst::emitBit(vluint32_t code, CData newval) {
@@ -222,46 +221,27 @@ void VerilatedFst::emitBit(vluint32_t code, CData newval) {
 
 VL_ATTR_ALWINLINE
 void VerilatedFst::emitCData(vluint32_t code, CData newval, int bits) {
-    char buf[VL_BYTESIZE];
-    cvtCDataToStr(buf, newval << (VL_BYTESIZE - bits));
-    fstWriterEmitValueChange(m_fst, m_symbolp[code], buf);
+    fstWriterEmitValueChange32(m_fst, m_symbolp[code], bits, newval);
 }
 
 VL_ATTR_ALWINLINE
 void VerilatedFst::emitSData(vluint32_t code, SData newval, int bits) {
-    char buf[VL_SHORTSIZE];
-    cvtSDataToStr(buf, newval << (VL_SHORTSIZE - bits));
-    fstWriterEmitValueChange(m_fst, m_symbolp[code], buf);
+    fstWriterEmitValueChange32(m_fst, m_symbolp[code], bits, newval);
 }
 
 VL_ATTR_ALWINLINE
 void VerilatedFst::emitIData(vluint32_t code, IData newval, int bits) {
-    char buf[VL_IDATASIZE];
-    cvtIDataToStr(buf, newval << (VL_IDATASIZE - bits));
-    fstWriterEmitValueChange(m_fst, m_symbolp[code], buf);
+    fstWriterEmitValueChange32(m_fst, m_symbolp[code], bits, newval);
 }
 
 VL_ATTR_ALWINLINE
 void VerilatedFst::emitQData(vluint32_t code, QData newval, int bits) {
-    char buf[VL_QUADSIZE];
-    cvtQDataToStr(buf, newval << (VL_QUADSIZE - bits));
-    fstWriterEmitValueChange(m_fst, m_symbolp[code], buf);
+    fstWriterEmitValueChange64(m_fst, m_symbolp[code], bits, newval);
 }
 
 VL_ATTR_ALWINLINE
 void VerilatedFst::emitWData(vluint32_t code, const WData* newvalp, int bits) {
-    int words = VL_WORDS_I(bits);
-    char* wp = m_strbuf;
-    // Convert the most significant word
-    const int bitsInMSW = VL_BITBIT_E(bits) ? VL_BITBIT_E(bits) : VL_EDATASIZE;
-    cvtEDataToStr(wp, newvalp[--words] << (VL_EDATASIZE - bitsInMSW));
-    wp += bitsInMSW;
-    // Convert the remaining words
-    while (words > 0) {
-        cvtEDataToStr(wp, newvalp[--words]);
-        wp += VL_EDATASIZE;
-    }
-    fstWriterEmitValueChange(m_fst, m_symbolp[code], m_strbuf);
+    fstWriterEmitValueChangeVec32(m_fst, m_symbolp[code], bits, newvalp);
 }
 
 VL_ATTR_ALWINLINE
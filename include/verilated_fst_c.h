@@ -51,7 +51,6 @@ private:
     Local2FstDtype m_local2fstdtype;
     std::list<std::string> m_curScope;
     fstHandle* m_symbolp;  ///< same as m_code2symbol, but as an array
-    char* m_strbuf;  ///< String buffer long enough to hold maxBits() chars
 
     // CONSTRUCTORS
     VL_UNCOPYABLE(VerilatedFst);
@@ -124,6 +123,8 @@ template <> void VerilatedTrace<VerilatedFst>::set_time_unit(const char* unitp);
 template <> void VerilatedTrace<VerilatedFst>::set_time_unit(const std::string& unit);
 template <> void VerilatedTrace<VerilatedFst>::set_time_resolution(const char* unitp);
 template <> void VerilatedTrace<VerilatedFst>::set_time_resolution(const std::string& unit);
+template <> void VerilatedTrace<VerilatedFst>::windowLimits(size_t steps, size_t bytes);
+template <> void VerilatedTrace<VerilatedFst>::flushWindow();
 
 //=============================================================================
 // VerilatedFstC
@@ -154,6 +155,24 @@ public:
     void close() VL_MT_UNSAFE_ONE { m_sptrace.close(); }
     /// Flush dump
     void flush() VL_MT_UNSAFE_ONE { m_sptrace.flush(); }
+    /// Keep only the last 'steps' time steps in memory, writing them on flushWindow()
+    void windowSteps(size_t steps) VL_MT_UNSAFE_ONE { m_sptrace.windowSteps(steps); }
+    /// Keep only about the last 'bytes' of changes in memory, writing them on flushWindow()
+    void windowBytes(size_t bytes) VL_MT_UNSAFE_ONE { m_sptrace.windowBytes(bytes); }
+    /// Write the kept window of changes to the file
+    void flushWindow() VL_MT_UNSAFE_ONE { m_sptrace.flushWindow(); }
+    /// Trace only signals matching a '*' and '?' pattern, call before open()
+    void filterGlob(const char* patternp) VL_MT_UNSAFE_ONE { m_sptrace.filterGlob(patternp); }
+    /// Trace only signals under at most 'levels' scopes, call before open()
+    void filterDepth(int levels) VL_MT_UNSAFE_ONE { m_sptrace.filterDepth(levels); }
+    /// Trace only signals at most 'bits' wide, call before open()
+    void filterMaxWidth(int bits) VL_MT_UNSAFE_ONE { m_sptrace.filterMaxWidth(bits); }
+    /// Count changes per signal, writing a ranked report on close(), call before open()
+    void toggleReport(const char* filenamep, bool waves = true) VL_MT_UNSAFE_ONE {
+        m_sptrace.toggleReport(filenamep, waves);
+    }
+    /// Add the bytes used by tracing to 'usage'
+    void memoryUsage(VerilatedMemoryUsage& usage) const { m_sptrace.memoryUsage(usage); }
     /// Write one cycle of dump data
     void dump(vluint64_t timeui) { m_sptrace.dump(timeui); }
     /// Write one cycle of dump data - backward compatible and to reduce
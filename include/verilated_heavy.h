@@ -26,10 +26,17 @@
 
 #include "verilated.h"
 
-#include <deque>
+#include <algorithm>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201103L
+# include <type_traits>
+#endif
 
 //===================================================================
 // String formatters (required by below containers)
@@ -49,16 +56,39 @@ class VlReadMem {
     int m_bits;  // Bit width of values
     const std::string& m_filename;  // Filename
     QData m_end;  // End address (as specified by user)
-    FILE* m_fp;  // File handle for filename
+    const char* m_datap;  // File contents, NULL if not open
+    const char* m_endp;  // End of file contents, or of range for a part
+    const char* m_cp;  // Next character to parse
+    const char* m_valuep;  // Start of value returned by last get()
+    size_t m_mapBytes;  // Bytes mapped at m_datap, or 0 if in m_buf
+    std::string m_buf;  // File contents if not mapped
     QData m_addr;  // Next address to read
     int m_linenum;  // Line number last read from file
+    bool m_part;  // Parsing part of the file; report errors with failed()
+    bool m_failed;  // Error seen parsing a part
+    bool m_sawAddr;  // Saw an @ address parsing a part
 public:
     VlReadMem(bool hex, int bits, const std::string& filename, QData start, QData end);
+    // Parse the lines in [begp, endp) of file, starting at address addr
+    VlReadMem(const VlReadMem& file, const char* begp, const char* endp, QData addr);
     ~VlReadMem();
-    bool isOpen() const { return m_fp != NULL; }
+    bool isOpen() const { return m_datap != NULL; }
     int linenum() const { return m_linenum; }
-    bool get(QData& addrr, std::string& valuer);
-    void setData(void* valuep, const std::string& rhs);
+    // Read next value's address, false at end of file
+    bool get(QData& addrr);
+    // Convert value of last get() into valuep
+    void setData(void* valuep) { setData(valuep, m_valuep, m_cp); }
+    // For parts
+    const char* datap() const { return m_datap; }
+    const char* endp() const { return m_endp; }
+    QData addr() const { return m_addr; }
+    bool failed() const { return m_failed; }
+    bool sawAddr() const { return m_sawAddr; }
+    void fail() { m_failed = true; }
+
+private:
+    void setData(void* valuep, const char* begp, const char* endp);
+    VL_UNCOPYABLE(VlReadMem);
 };
 
 class VlWriteMem {
@@ -95,6 +125,9 @@ public:
     bool operator<(const VlWide<T_Words>& rhs) const {
         return VL_LT_W(T_Words, data(), rhs.data());
     }
+    bool operator==(const VlWide<T_Words>& rhs) const {
+        return VL_EQ_W(T_Words, data(), rhs.data());
+    }
 };
 
 // Convert a C array to std::array reference by pointer magic, without copy.
@@ -107,6 +140,128 @@ template <std::size_t T_Words> std::string VL_TO_STRING(const VlWide<T_Words>& o
     return VL_TO_STRING_W(T_Words, obj.data());
 }
 
+//===================================================================
+// Node allocator for the associative array container
+// Hands out single nodes from a free list refilled in growing chunks,
+// avoiding a heap allocation per element.  The free list and chunks
+// belong to the container, as copies of its allocator share them, so
+// they have no thread affinity, and are freed with the container.
+
+template <class T> class VlAssocPoolAllocator {
+private:
+    // TYPES
+    template <class U> friend class VlAssocPoolAllocator;
+    struct FreeNode {
+        FreeNode* m_nextp;
+    };
+    enum { CHUNK_NODES_MIN = 8, CHUNK_NODES_MAX = 256 };  // Nodes allocated per refill
+    struct Pool {
+        int m_refs;  // Allocators sharing this pool
+        FreeNode* m_freep;  // Free nodes
+        size_t m_chunkNodes;  // Nodes in the next chunk
+        std::vector<void*> m_chunks;  // Chunks to free when done
+        Pool()
+            : m_refs(1)
+            , m_freep(NULL)
+            , m_chunkNodes(CHUNK_NODES_MIN) {}
+        ~Pool() {
+            for (size_t i = 0; i < m_chunks.size(); ++i) ::operator delete(m_chunks[i]);
+        }
+    };
+    // MEMBERS
+    mutable Pool* m_poolp;  // Pool, created on first use
+
+public:
+    // TYPES
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    template <class U> struct rebind { typedef VlAssocPoolAllocator<U> other; };
+#if __cplusplus >= 201103L
+    // Nodes must stay with the pool they came from
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+#endif
+    // CONSTRUCTORS
+    VlAssocPoolAllocator()
+        : m_poolp(NULL) {}
+    // Copies share the pool, as either may free the other's nodes
+    VlAssocPoolAllocator(const VlAssocPoolAllocator& rhs)
+        : m_poolp(rhs.poolp()) {
+        ++m_poolp->m_refs;
+    }
+    // Other node types have a pool of their own
+    template <class U>
+    VlAssocPoolAllocator(const VlAssocPoolAllocator<U>&)
+        : m_poolp(NULL) {}
+    ~VlAssocPoolAllocator() { release(); }
+    VlAssocPoolAllocator& operator=(const VlAssocPoolAllocator& rhs) {
+        Pool* poolp = rhs.poolp();
+        ++poolp->m_refs;
+        release();
+        m_poolp = poolp;
+        return *this;
+    }
+    // A copied container gets its own pool
+    VlAssocPoolAllocator select_on_container_copy_construction() const {
+        return VlAssocPoolAllocator();
+    }
+    // METHODS
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+    size_type max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+    void construct(pointer p, const T& value) { new (static_cast<void*>(p)) T(value); }
+    void destroy(pointer p) { p->~T(); }
+    pointer allocate(size_type n, const void* = 0) {
+        if (VL_UNLIKELY(n != 1)) return static_cast<pointer>(::operator new(n * sizeof(T)));
+        Pool* poolp = this->poolp();
+        if (VL_UNLIKELY(!poolp->m_freep)) refill(poolp);
+        FreeNode* nodep = poolp->m_freep;
+        poolp->m_freep = nodep->m_nextp;
+        return reinterpret_cast<pointer>(nodep);
+    }
+    void deallocate(pointer p, size_type n) {
+        if (VL_UNLIKELY(n != 1)) {
+            ::operator delete(p);
+            return;
+        }
+        FreeNode* nodep = reinterpret_cast<FreeNode*>(p);
+        nodep->m_nextp = m_poolp->m_freep;
+        m_poolp->m_freep = nodep;
+    }
+    bool operator==(const VlAssocPoolAllocator& rhs) const { return poolp() == rhs.poolp(); }
+    bool operator!=(const VlAssocPoolAllocator& rhs) const { return !(*this == rhs); }
+
+private:
+    Pool* poolp() const {
+        if (VL_UNLIKELY(!m_poolp)) m_poolp = new Pool;
+        return m_poolp;
+    }
+    void release() {
+        if (m_poolp && --m_poolp->m_refs == 0) delete m_poolp;
+        m_poolp = NULL;
+    }
+    static void refill(Pool* poolp) {
+        // Round up so every node can hold an aligned free list pointer
+        const size_t nodeBytes
+            = (sizeof(T) + sizeof(FreeNode) - 1) / sizeof(FreeNode) * sizeof(FreeNode);
+        const size_t nodes = poolp->m_chunkNodes;
+        char* chunkp = static_cast<char*>(::operator new(nodeBytes * nodes));
+        poolp->m_chunks.push_back(chunkp);
+        // Small arrays stay small, big ones refill less often
+        if (nodes < CHUNK_NODES_MAX) poolp->m_chunkNodes = nodes * 2;
+        for (size_t i = nodes; i-- > 0;) {
+            FreeNode* nodep = reinterpret_cast<FreeNode*>(chunkp + i * nodeBytes);
+            nodep->m_nextp = poolp->m_freep;
+            poolp->m_freep = nodep;
+        }
+    }
+};
+
 //===================================================================
 // Verilog associative array container
 // There are no multithreaded locks on this; the base variable must
@@ -115,7 +270,9 @@ template <std::size_t T_Words> std::string VL_TO_STRING(const VlWide<T_Words>& o
 template <class T_Key, class T_Value> class VlAssocArray {
 private:
     // TYPES
-    typedef std::map<T_Key, T_Value> Map;
+    typedef std::map<T_Key, T_Value, std::less<T_Key>,
+                     VlAssocPoolAllocator<std::pair<const T_Key, T_Value> > >
+        Map;
 
 public:
     typedef typename Map::const_iterator const_iterator;
@@ -189,7 +346,7 @@ public:
     }
     // Accessing. Verilog: v = assoc[index]
     const T_Value& at(const T_Key& index) const {
-        typename Map::iterator it = m_map.find(index);
+        typename Map::const_iterator it = m_map.find(index);
         if (it == m_map.end()) {
             return m_defaultValue;
         } else {
@@ -225,9 +382,8 @@ void VL_READMEM_N(bool hex, int bits, const std::string& filename,
     if (VL_UNLIKELY(!rmem.isOpen())) return;
     while (true) {
         QData addr;
-        std::string data;
-        if (rmem.get(addr /*ref*/, data /*ref*/)) {
-            rmem.setData(&(obj.at(addr)), data);
+        if (rmem.get(addr /*ref*/)) {
+            rmem.setData(&(obj.at(addr)));
         } else {
             break;
         }
@@ -246,8 +402,197 @@ void VL_WRITEMEM_N(bool hex, int bits, const std::string& filename,
     }
 }
 
+//===================================================================
+// Verilog associative array container, unordered
+// Open addressed hash table with linear probing.  Used instead of
+// VlAssocArray for variables that are never iterated in key order, see
+// WidthAssocVisitor, so has no first/last/next/prev.
+// There are no multithreaded locks on this; the base variable must
+// be protected by other means
+//
+template <class T_Key> inline vluint64_t VL_ASSOC_HASH(const T_Key& key) {
+    return static_cast<vluint64_t>(key);
+}
+template <std::size_t T_Words> inline vluint64_t VL_ASSOC_HASH(const VlWide<T_Words>& key) {
+    vluint64_t hash = 0;
+    for (size_t i = 0; i < T_Words; ++i) hash = (hash ^ key.at(i)) * VL_ULL(0x100000001b3);
+    return hash;
+}
+inline vluint64_t VL_ASSOC_HASH(const std::string& key) {
+    vluint64_t hash = VL_ULL(0xcbf29ce484222325);  // FNV-1a
+    for (size_t i = 0; i < key.size(); ++i) {
+        hash = (hash ^ static_cast<vluint8_t>(key[i])) * VL_ULL(0x100000001b3);
+    }
+    return hash;
+}
+
+template <class T_Key, class T_Value> class VlAssocHashArray {
+private:
+    // TYPES
+    typedef std::pair<T_Key, T_Value> Slot;
+    typedef std::vector<Slot> Slots;
+
+public:
+    class const_iterator {
+        // Iterates occupied slots, in hash (not key) order
+        const VlAssocHashArray* m_arrayp;  // Array iterating
+        size_t m_index;  // Slot index, m_slots.size() at end
+        void skipUnused() {
+            while (m_index < m_arrayp->m_used.size() && !m_arrayp->m_used[m_index]) ++m_index;
+        }
+
+    public:
+        const_iterator(const VlAssocHashArray* arrayp, size_t index)
+            : m_arrayp(arrayp)
+            , m_index(index) {
+            skipUnused();
+        }
+        const Slot& operator*() const { return m_arrayp->m_slots[m_index]; }
+        const Slot* operator->() const { return &m_arrayp->m_slots[m_index]; }
+        const_iterator& operator++() {
+            ++m_index;
+            skipUnused();
+            return *this;
+        }
+        bool operator==(const const_iterator& rhs) const { return m_index == rhs.m_index; }
+        bool operator!=(const const_iterator& rhs) const { return m_index != rhs.m_index; }
+    };
+
+private:
+    // MEMBERS
+    Slots m_slots;  // Hash table, size is zero or a power of two
+    std::vector<vluint8_t> m_used;  // True if same index in m_slots is occupied
+    size_t m_size;  // Number of occupied slots
+    int m_shift;  // Shift of hash to get slot index
+    T_Value m_defaultValue;  // Default value
+
+public:
+    // CONSTRUCTORS
+    VlAssocHashArray()
+        : m_size(0)
+        , m_shift(64) {
+        // m_defaultValue isn't defaulted. Caller's constructor must do it.
+    }
+    ~VlAssocHashArray() {}
+    // Standard copy constructor works. Verilog: assoca = assocb
+
+    // METHODS
+    T_Value& atDefault() { return m_defaultValue; }
+
+    // Size of array. Verilog: function int size(), or int num()
+    int size() const { return m_size; }
+    // Clear array. Verilog: function void delete([input index])
+    void clear() {
+        Slots().swap(m_slots);
+        std::vector<vluint8_t>().swap(m_used);
+        m_size = 0;
+        m_shift = 64;
+    }
+    void erase(const T_Key& index) {
+        size_t i = find(index);
+        if (i == npos()) return;
+        // Backward shift deletion; move up later entries whose probe passed this slot
+        const size_t mask = m_slots.size() - 1;
+        for (size_t j = (i + 1) & mask; m_used[j]; j = (j + 1) & mask) {
+            const size_t home = slotOf(m_slots[j].first);
+            const bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+            if (stays) continue;
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+        m_used[i] = 0;
+        m_slots[i] = Slot();
+        --m_size;
+    }
+    // Return 0/1 if element exists. Verilog: function int exists(input index)
+    int exists(const T_Key& index) const { return find(index) != npos(); }
+    // Setting. Verilog: assoc[index] = v
+    T_Value& at(const T_Key& index) {
+        size_t i = find(index);
+        if (i != npos()) return m_slots[i].second;
+        if (VL_UNLIKELY((m_size + 1) * 4 > m_slots.size() * 3)) grow();
+        i = insertSlot(index);
+        m_slots[i].second = m_defaultValue;
+        return m_slots[i].second;
+    }
+    // Accessing. Verilog: v = assoc[index]
+    const T_Value& at(const T_Key& index) const {
+        const size_t i = find(index);
+        return (i == npos()) ? m_defaultValue : m_slots[i].second;
+    }
+    // For save/restore
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_slots.size()); }
+
+    // Dumping. Verilog: str = $sformatf("%p", assoc)
+    std::string to_string() const {
+        // Print in key order, same as VlAssocArray
+        std::vector<const Slot*> sorted;
+        sorted.reserve(m_size);
+        for (const_iterator it = begin(); it != end(); ++it) sorted.push_back(&(*it));
+        std::sort(sorted.begin(), sorted.end(), keyLess);
+        std::string out = "'{";
+        std::string comma;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            out += comma + VL_TO_STRING(sorted[i]->first) + ":" + VL_TO_STRING(sorted[i]->second);
+            comma = ", ";
+        }
+        // Default not printed - maybe random init data
+        return out + "} ";
+    }
+
+private:
+    static size_t npos() { return static_cast<size_t>(-1); }
+    static bool keyLess(const Slot* lhsp, const Slot* rhsp) { return lhsp->first < rhsp->first; }
+    size_t slotOf(const T_Key& index) const {
+        // Fibonacci hashing, mixes the high bits of the key hash into the index
+        return static_cast<size_t>((VL_ASSOC_HASH(index) * VL_ULL(11400714819323198485))
+                                   >> m_shift);
+    }
+    size_t find(const T_Key& index) const {
+        if (!m_size) return npos();
+        const size_t mask = m_slots.size() - 1;
+        for (size_t i = slotOf(index); m_used[i]; i = (i + 1) & mask) {
+            if (m_slots[i].first == index) return i;
+        }
+        return npos();
+    }
+    size_t insertSlot(const T_Key& index) {
+        // Caller ensures index isn't present and there is a free slot
+        const size_t mask = m_slots.size() - 1;
+        size_t i = slotOf(index);
+        while (m_used[i]) i = (i + 1) & mask;
+        m_used[i] = 1;
+        m_slots[i].first = index;
+        ++m_size;
+        return i;
+    }
+    void grow() {
+        const size_t newSize = m_slots.empty() ? 16 : m_slots.size() * 2;
+        Slots oldSlots;
+        std::vector<vluint8_t> oldUsed;
+        oldSlots.swap(m_slots);
+        oldUsed.swap(m_used);
+        m_slots.resize(newSize);
+        m_used.assign(newSize, 0);
+        m_size = 0;
+        m_shift = 64;
+        for (size_t n = m_slots.size(); n > 1; n >>= 1) --m_shift;
+        for (size_t i = 0; i < oldSlots.size(); ++i) {
+            if (!oldUsed[i]) continue;
+            std::swap(m_slots[insertSlot(oldSlots[i].first)].second, oldSlots[i].second);
+        }
+    }
+};
+
+template <class T_Key, class T_Value>
+std::string VL_TO_STRING(const VlAssocHashArray<T_Key, T_Value>& obj) {
+    return obj.to_string();
+}
+
 //===================================================================
 // Verilog queue and dynamic array container
+// Ring buffer, held in the object while small to avoid heap allocation.
 // There are no multithreaded locks on this; the base variable must
 // be protected by other means
 //
@@ -256,19 +601,48 @@ void VL_WRITEMEM_N(bool hex, int bits, const std::string& filename,
 template <class T_Value, size_t T_MaxSize = 0> class VlQueue {
 private:
     // TYPES
-    typedef std::deque<T_Value> Deque;
+    typedef std::vector<T_Value> Heap;
+    // Elements stored in the object itself.  Bounded queues that fit are
+    // never heap allocated; others move to the heap when they outgrow it.
+    enum {
+        INLINE_SIZE = ((T_MaxSize != 0 && T_MaxSize * sizeof(T_Value) <= VL_QUEUE_INLINE_BYTES)
+                           ? T_MaxSize
+                           : (64 / sizeof(T_Value)) ? (64 / sizeof(T_Value)) : 1)
+    };
 
 public:
-    typedef typename Deque::const_iterator const_iterator;
+    class const_iterator {
+        const VlQueue* m_queuep;  // Queue iterating
+        size_t m_index;  // Element index, size() at end
+
+    public:
+        const_iterator(const VlQueue* queuep, size_t index)
+            : m_queuep(queuep)
+            , m_index(index) {}
+        const T_Value& operator*() const { return m_queuep->at(m_index); }
+        const T_Value* operator->() const { return &m_queuep->at(m_index); }
+        const_iterator& operator++() {
+            ++m_index;
+            return *this;
+        }
+        bool operator==(const const_iterator& rhs) const { return m_index == rhs.m_index; }
+        bool operator!=(const const_iterator& rhs) const { return m_index != rhs.m_index; }
+    };
 
 private:
     // MEMBERS
-    Deque m_deque;  // State of the assoc array
+    // Ring buffer in m_inline, or m_heap once grown; no pointers so copies work
+    T_Value m_inline[INLINE_SIZE];  // Storage while m_heap is empty
+    Heap m_heap;  // Storage once outgrown m_inline
+    size_t m_head;  // Storage index of front element
+    size_t m_size;  // Number of elements
     T_Value m_defaultValue;  // Default value
 
 public:
     // CONSTRUCTORS
-    VlQueue() {
+    VlQueue()
+        : m_head(0)
+        , m_size(0) {
         // m_defaultValue isn't defaulted. Caller's constructor must do it.
     }
     ~VlQueue() {}
@@ -276,19 +650,29 @@ public:
 
     // METHODS
     T_Value& atDefault() { return m_defaultValue; }
+    const T_Value& atDefault() const { return m_defaultValue; }
 
     // Size. Verilog: function int size(), or int num()
-    int size() const { return m_deque.size(); }
+    int size() const { return m_size; }
     // Clear array. Verilog: function void delete([input index])
-    void clear() { m_deque.clear(); }
+    void clear() {
+        // Release element resources, e.g. class references
+        for (size_t i = 0; i < m_size; ++i) storep()[slot(i)] = T_Value();
+        Heap().swap(m_heap);
+        m_head = 0;
+        m_size = 0;
+    }
     void erase(size_t index) {
-        if (VL_LIKELY(index < m_deque.size())) m_deque.erase(index);
+        if (VL_UNLIKELY(index >= m_size)) return;
+        for (size_t i = index; i + 1 < m_size; ++i) storep()[slot(i)] = storep()[slot(i + 1)];
+        storep()[slot(m_size - 1)] = T_Value();
+        --m_size;
     }
 
     // Dynamic array new[] becomes a renew()
     void renew(size_t size) {
         clear();
-        m_deque.resize(size, atDefault());
+        resize(size, atDefault());
     }
     // Dynamic array new[]() becomes a renew_copy()
     void renew_copy(size_t size, const VlQueue<T_Value, T_MaxSize>& rhs) {
@@ -296,31 +680,42 @@ public:
             clear();
         } else {
             *this = rhs;
-            m_deque.resize(size, atDefault());
+            resize(size, atDefault());
         }
     }
 
     // function void q.push_front(value)
     void push_front(const T_Value& value) {
-        m_deque.push_front(value);
-        if (VL_UNLIKELY(T_MaxSize != 0 && m_deque.size() > T_MaxSize)) m_deque.pop_back();
+        if (VL_UNLIKELY(T_MaxSize != 0 && m_size >= T_MaxSize)) pop_back();
+        reserve(m_size + 1);
+        m_head = m_head ? m_head - 1 : capacity() - 1;
+        storep()[m_head] = value;
+        ++m_size;
     }
     // function void q.push_back(value)
     void push_back(const T_Value& value) {
-        if (VL_LIKELY(T_MaxSize == 0 || m_deque.size() < T_MaxSize)) m_deque.push_back(value);
+        if (VL_UNLIKELY(T_MaxSize != 0 && m_size >= T_MaxSize)) return;
+        reserve(m_size + 1);
+        storep()[slot(m_size)] = value;
+        ++m_size;
     }
     // function value_t q.pop_front();
     T_Value pop_front() {
-        if (m_deque.empty()) return m_defaultValue;
-        T_Value v = m_deque.front();
-        m_deque.pop_front();
+        if (m_size == 0) return m_defaultValue;
+        T_Value& frontr = storep()[m_head];
+        T_Value v = frontr;
+        frontr = T_Value();
+        m_head = slot(1);
+        --m_size;
         return v;
     }
     // function value_t q.pop_back();
     T_Value pop_back() {
-        if (m_deque.empty()) return m_defaultValue;
-        T_Value v = m_deque.back();
-        m_deque.pop_back();
+        if (m_size == 0) return m_defaultValue;
+        T_Value& backr = storep()[slot(m_size - 1)];
+        T_Value v = backr;
+        backr = T_Value();
+        --m_size;
         return v;
     }
 
@@ -330,49 +725,121 @@ public:
     T_Value& at(size_t index) {
         static T_Value s_throwAway;
         // Needs to work for dynamic arrays, so does not use T_MaxSize
-        if (VL_UNLIKELY(index >= m_deque.size())) {
+        if (VL_UNLIKELY(index >= m_size)) {
             s_throwAway = atDefault();
             return s_throwAway;
         } else {
-            return m_deque[index];
+            return storep()[slot(index)];
         }
     }
     // Accessing. Verilog: v = assoc[index]
     const T_Value& at(size_t index) const {
-        static T_Value s_throwAway;
         // Needs to work for dynamic arrays, so does not use T_MaxSize
-        if (VL_UNLIKELY(index >= m_deque.size())) {
+        if (VL_UNLIKELY(index >= m_size)) {
             return atDefault();
         } else {
-            return m_deque[index];
+            return storep()[slot(index)];
         }
     }
     // function void q.insert(index, value);
     void insert(size_t index, const T_Value& value) {
-        if (VL_UNLIKELY(index >= m_deque.size())) return;
-        m_deque[index] = value;
+        if (VL_UNLIKELY(index >= m_size)) return;
+        storep()[slot(index)] = value;
     }
 
     // For save/restore
-    const_iterator begin() const { return m_deque.begin(); }
-    const_iterator end() const { return m_deque.end(); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
 
     // Dumping. Verilog: str = $sformatf("%p", assoc)
     std::string to_string() const {
         std::string out = "'{";
         std::string comma;
-        for (typename Deque::const_iterator it = m_deque.begin(); it != m_deque.end(); ++it) {
-            out += comma + VL_TO_STRING(*it);
+        for (size_t i = 0; i < m_size; ++i) {
+            out += comma + VL_TO_STRING(at(i));
             comma = ", ";
         }
         return out + "} ";
     }
+
+private:
+    size_t capacity() const {
+        return m_heap.empty() ? static_cast<size_t>(INLINE_SIZE) : m_heap.size();
+    }
+    T_Value* storep() { return m_heap.empty() ? m_inline : &m_heap[0]; }
+    const T_Value* storep() const { return m_heap.empty() ? m_inline : &m_heap[0]; }
+    // Storage index of element index
+    size_t slot(size_t index) const {
+        const size_t i = m_head + index;
+        return (i >= capacity()) ? i - capacity() : i;
+    }
+    void reserve(size_t size) {
+        if (VL_LIKELY(size <= capacity())) return;
+        size_t newCapacity = capacity() * 2;
+        if (newCapacity < size) newCapacity = size;
+        Heap heap(newCapacity);
+        // Swap leaves default values behind, releasing any resources
+        for (size_t i = 0; i < m_size; ++i) std::swap(heap[i], storep()[slot(i)]);
+        m_heap.swap(heap);
+        m_head = 0;
+    }
+    void resize(size_t size, const T_Value& value) {
+        reserve(size);
+        for (size_t i = size; i < m_size; ++i) storep()[slot(i)] = T_Value();
+        for (size_t i = m_size; i < size; ++i) storep()[slot(i)] = value;
+        m_size = size;
+    }
 };
 
-template <class T_Value> std::string VL_TO_STRING(const VlQueue<T_Value>& obj) {
+template <class T_Value, size_t T_MaxSize>
+std::string VL_TO_STRING(const VlQueue<T_Value, T_MaxSize>& obj) {
     return obj.to_string();
 }
 
+//===================================================================
+// Verilog sparse unpacked array container
+// Storage for an unpacked array declared /*verilator sparse*/.  The rows
+// are reserved but not committed, so the operating system allocates each
+// page on first write, and unwritten rows read as zero.  When reset to
+// ones or random values, each page is instead filled when first touched.
+// Converts to a pointer to the first row, so it is indexed exactly as a
+// C array.
+
+extern void* VL_SPARSE_ALLOC(size_t bytes) VL_MT_SAFE;
+extern void VL_SPARSE_RAND_RESET(int obits, const char* scopep, const char* varp, void* datap,
+                                 size_t bytes) VL_MT_SAFE;
+extern void VL_SPARSE_CLEAR(void* datap, size_t bytes) VL_MT_SAFE;
+/// Return if the page at offset has been filled, or -1 if the array's pages are not filled
+extern int VL_SPARSE_PAGE_FILLED(const void* datap, size_t offset) VL_MT_SAFE;
+extern void VL_SPARSE_FREE(void* datap, size_t bytes) VL_MT_SAFE;
+
+template <class T_Value, size_t T_Depth> class VlSparseArray {
+private:
+    // MEMBERS
+    T_Value* m_datap;  // Rows, reserved with VL_SPARSE_ALLOC
+
+public:
+    // CONSTRUCTORS
+    VlSparseArray()
+        : m_datap(static_cast<T_Value*>(VL_SPARSE_ALLOC(bytes()))) {}
+    ~VlSparseArray() { VL_SPARSE_FREE(m_datap, bytes()); }
+    // METHODS
+    static size_t bytes() { return sizeof(T_Value) * T_Depth; }
+    T_Value* data() { return m_datap; }
+    const T_Value* data() const { return m_datap; }
+    operator T_Value*() { return m_datap; }
+    operator const T_Value*() const { return m_datap; }
+    // Reset rows per +verilator+rand+reset, as each page is first touched
+    void randReset(int obits, const char* scopep, const char* varp) {
+        VL_SPARSE_RAND_RESET(obits, scopep, varp, m_datap, bytes());
+    }
+    // Return all rows to their reset value, releasing their pages
+    void clear() { VL_SPARSE_CLEAR(m_datap, bytes()); }
+
+private:
+    VL_UNCOPYABLE(VlSparseArray);
+};
+
 //===================================================================
 // Verilog class reference container
 // There are no multithreaded locks on this; the base variable must
@@ -381,12 +848,178 @@ template <class T_Value> std::string VL_TO_STRING(const VlQueue<T_Value>& obj) {
 
 // clang-format off
 #if (defined(_MSC_VER) && _MSC_VER >= 1900) || (__cplusplus >= 201103L)
-# define VlClassRef std::shared_ptr
+# define VL_HAVE_CLASSES 1
 #else
 # define VlClassRef VlClassRef__SystemVerilog_class_support_requires_a_C11_or_newer_compiler
 #endif
 // clang-format on
 
+#ifdef VL_HAVE_CLASSES
+
+/// Base of every Verilog class, holding the count of VlClassRef handles
+/// to the object.  The count is only atomic in threaded models, as
+/// otherwise a handle is only ever used from one thread.
+class VlClass {
+public:
+    // TYPES
+    typedef void (*PoolFree)(void* memp);
+
+private:
+    // MEMBERS
+#ifdef VL_THREADED
+    std::atomic<vluint32_t> m_refs;  ///< Handles to this object
+#else
+    vluint32_t m_refs;  ///< Handles to this object
+#endif
+    PoolFree m_poolFreep;  ///< Pool to return memory to, or NULL if from new
+
+public:
+    // CONSTRUCTORS
+    VlClass()
+        : m_refs(0)
+        , m_poolFreep(NULL) {}
+    // A copy, as from a Verilog shallow copy, starts with no handles
+    VlClass(const VlClass&)
+        : m_refs(0)
+        , m_poolFreep(NULL) {}
+    VlClass& operator=(const VlClass&) { return *this; }
+    virtual ~VlClass() {}
+    // METHODS
+    // Static so class members of the same name can't hide them
+    static void refIncrement(VlClass* objp) { ++objp->m_refs; }
+    static void refDecrement(VlClass* objp) {
+        if (--objp->m_refs == 0) objp->destroy();
+    }
+    static void poolFree(VlClass* objp, PoolFree freep) { objp->m_poolFreep = freep; }
+
+private:
+    void destroy() {
+        if (!m_poolFreep) {
+            delete this;
+            return;
+        }
+        const PoolFree freep = m_poolFreep;
+        void* memp = dynamic_cast<void*>(this);  // Start of the most derived object
+        this->~VlClass();
+        freep(memp);
+    }
+};
+
+/// Intrusive reference to a Verilog class object, or null
+template <class T> class VlClassRef {
+    // MEMBERS
+    T* m_objp;  ///< Object, or NULL
+    template <class U> friend class VlClassRef;
+
+public:
+    // CONSTRUCTORS
+    VlClassRef()
+        : m_objp(NULL) {}
+    VlClassRef(std::nullptr_t)
+        : m_objp(NULL) {}
+    explicit VlClassRef(T* objp)
+        : m_objp(objp) {
+        if (m_objp) VlClass::refIncrement(m_objp);
+    }
+    VlClassRef(const VlClassRef& rhs)
+        : m_objp(rhs.m_objp) {
+        if (m_objp) VlClass::refIncrement(m_objp);
+    }
+    VlClassRef(VlClassRef&& rhs)
+        : m_objp(rhs.m_objp) {
+        rhs.m_objp = NULL;
+    }
+    // Reference to a derived class
+    template <class U>
+    VlClassRef(const VlClassRef<U>& rhs)
+        : m_objp(rhs.m_objp) {
+        if (m_objp) VlClass::refIncrement(m_objp);
+    }
+    template <class U>
+    VlClassRef(VlClassRef<U>&& rhs)
+        : m_objp(rhs.m_objp) {
+        rhs.m_objp = NULL;
+    }
+    ~VlClassRef() {
+        if (m_objp) VlClass::refDecrement(m_objp);
+    }
+    VlClassRef& operator=(VlClassRef rhs) {
+        std::swap(m_objp, rhs.m_objp);
+        return *this;
+    }
+    // METHODS
+    T* get() const { return m_objp; }
+    T* operator->() const { return m_objp; }
+    T& operator*() const { return *m_objp; }
+    explicit operator bool() const { return m_objp != NULL; }
+    template <class U> bool operator==(const VlClassRef<U>& rhs) const {
+        return m_objp == rhs.m_objp;
+    }
+    template <class U> bool operator!=(const VlClassRef<U>& rhs) const {
+        return m_objp != rhs.m_objp;
+    }
+    template <class U> bool operator<(const VlClassRef<U>& rhs) const {
+        return m_objp < rhs.m_objp;
+    }
+    bool operator==(std::nullptr_t) const { return m_objp == NULL; }
+    bool operator!=(std::nullptr_t) const { return m_objp != NULL; }
+    friend bool operator==(std::nullptr_t, const VlClassRef& rhs) { return !rhs.m_objp; }
+    friend bool operator!=(std::nullptr_t, const VlClassRef& rhs) { return rhs.m_objp != NULL; }
+};
+
+/// Memory for the objects of one Verilog class.  Hands out objects from a
+/// per-thread free list refilled in chunks, so transaction heavy tests
+/// reuse freed objects rather than going to the heap for each new.
+template <class T> class VlClassPool {
+    // TYPES
+    struct FreeNode {
+        FreeNode* m_nextp;
+    };
+    enum { CHUNK_OBJS = 64 };  // Objects allocated per refill
+    // MEMBERS
+    static VL_THREAD_LOCAL FreeNode* t_freep;  // Free objects for this thread
+
+public:
+    // METHODS
+    static void* allocate() {
+        if (VL_UNLIKELY(!t_freep)) refill();
+        FreeNode* nodep = t_freep;
+        t_freep = nodep->m_nextp;
+        return nodep;
+    }
+    static void deallocate(void* memp) {
+        FreeNode* nodep = static_cast<FreeNode*>(memp);
+        nodep->m_nextp = t_freep;
+        t_freep = nodep;
+    }
+
+private:
+    static void refill() {
+        // Round up so every object is aligned, and can hold a free list pointer
+        const size_t align = alignof(T) > alignof(FreeNode) ? alignof(T) : alignof(FreeNode);
+        const size_t objBytes = (sizeof(T) + align - 1) / align * align;
+        char* chunkp = static_cast<char*>(::operator new(objBytes * CHUNK_OBJS));
+        for (int i = CHUNK_OBJS - 1; i >= 0; --i) {
+            FreeNode* nodep = reinterpret_cast<FreeNode*>(chunkp + i * objBytes);
+            nodep->m_nextp = t_freep;
+            t_freep = nodep;
+        }
+    }
+};
+
+template <class T>
+VL_THREAD_LOCAL typename VlClassPool<T>::FreeNode* VlClassPool<T>::t_freep = NULL;
+
+/// Construct a Verilog class object from its pool, for new
+template <class T, class... T_Args> inline VlClassRef<T> VL_NEW(T_Args&&... args) {
+    void* memp = VlClassPool<T>::allocate();
+    T* objp = new (memp) T(std::forward<T_Args>(args)...);
+    VlClass::poolFree(objp, &VlClassPool<T>::deallocate);
+    return VlClassRef<T>(objp);
+}
+
+#endif  // VL_HAVE_CLASSES
+
 template <class T>  // T typically of type VlClassRef<x>
 inline T VL_NULL_CHECK(T t, const char* filename, int linenum) {
     if (VL_UNLIKELY(!t)) Verilated::nullPointerError(filename, linenum);
@@ -434,6 +1067,10 @@ extern void VL_READMEM_N(bool hex, int bits, QData depth, int array_lsb,
 extern void VL_WRITEMEM_N(bool hex, int bits, QData depth, int array_lsb,
                           const std::string& filename, const void* memp, QData start,
                           QData end) VL_MT_SAFE;
+extern void VL_READMEMRAW_N(int bits, QData depth, int array_lsb, const std::string& filename,
+                            void* memp, QData start, QData end) VL_MT_SAFE;
+extern void VL_WRITEMEMRAW_N(int bits, QData depth, int array_lsb, const std::string& filename,
+                             const void* memp, QData start, QData end) VL_MT_SAFE;
 extern IData VL_SSCANF_INX(int lbits, const std::string& ld, const char* formatp, ...) VL_MT_SAFE;
 extern void VL_SFORMAT_X(int obits_ignored, std::string& output, const char* formatp,
                          ...) VL_MT_SAFE;
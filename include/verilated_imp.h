@@ -33,8 +33,8 @@
 #include <set>
 #include <vector>
 #ifdef VL_THREADED
+# include <atomic>
 # include <functional>
-# include <queue>
 #endif
 // clang-format on
 
@@ -46,14 +46,6 @@ class VerilatedScope;
 #ifdef VL_THREADED
 /// Message, enqueued on an mtask, and consumed on the main eval thread
 class VerilatedMsg {
-public:
-    // TYPES
-    struct Cmp {
-        bool operator()(const VerilatedMsg& a, const VerilatedMsg& b) const {
-            return a.mtaskId() < b.mtaskId();
-        }
-    };
-
 private:
     // MEMBERS
     vluint32_t m_mtaskId;  ///< MTask that did enqueue
@@ -66,25 +58,97 @@ public:
     ~VerilatedMsg() {}
     // METHODS
     vluint32_t mtaskId() const { return m_mtaskId; }
+    const std::function<void()>& cb() const { return m_cb; }
     /// Execute the lambda function
     void run() const { m_cb(); }
 };
 
-/// Each thread has a queue it pushes to
+class VerilatedThreadMsgQueue;
+
+/// Messages from one mtask, built by its thread and run on the eval thread.
+/// Text is kept in one string and callbacks only for the rarer actions, so
+/// once a chunk is reused it does no heap allocation for $display/$fwrite.
+class VerilatedMsgChunk {
+public:
+    // TYPES
+    struct Cmp {
+        bool operator()(const VerilatedMsgChunk* ap, const VerilatedMsgChunk* bp) const {
+            return ap->m_mtaskId < bp->m_mtaskId;
+        }
+    };
+
+private:
+    friend class VerilatedEvalMsgQueue;
+    friend class VerilatedThreadMsgQueue;
+    enum Kind { PRINT, WRITE, FFLUSH, FCLOSE, CALLBACK };
+    struct Entry {
+        Kind m_kind;
+        IData m_fd;  ///< Descriptor for WRITE/FFLUSH/FCLOSE
+        size_t m_offset;  ///< Offset of text in m_text, or index in m_cbs
+        size_t m_length;  ///< Length of text
+    };
+    // MEMBERS
+    VerilatedThreadMsgQueue* m_ownerp;  ///< Thread queue the chunk is returned to
+    VerilatedMsgChunk* m_nextp;  ///< Next in a pending or free list
+    vluint32_t m_mtaskId;  ///< MTask that did enqueue
+    std::string m_text;  ///< Text of all PRINT and WRITE entries
+    std::vector<Entry> m_entries;  ///< Messages in order
+    std::vector<std::function<void()> > m_cbs;  ///< Callbacks of CALLBACK entries
+
+    // CONSTRUCTORS
+    explicit VerilatedMsgChunk(VerilatedThreadMsgQueue* ownerp)
+        : m_ownerp(ownerp)
+        , m_nextp(NULL)
+        , m_mtaskId(0) {
+        m_text.reserve(4096);
+        m_entries.reserve(64);
+    }
+    ~VerilatedMsgChunk() {}
+    VL_UNCOPYABLE(VerilatedMsgChunk);
+
+    // METHODS
+    bool empty() const { return m_entries.empty(); }
+    void addText(Kind kind, IData fdi, const std::string& text) {
+        // Consecutive text to the same place becomes a single entry
+        if (!m_entries.empty() && m_entries.back().m_kind == kind
+            && m_entries.back().m_fd == fdi) {
+            m_entries.back().m_length += text.size();
+        } else {
+            Entry entry = {kind, fdi, m_text.size(), text.size()};
+            m_entries.push_back(entry);
+        }
+        m_text += text;
+    }
+    void addFd(Kind kind, IData fdi) {
+        Entry entry = {kind, fdi, 0, 0};
+        m_entries.push_back(entry);
+    }
+    void addCb(const std::function<void()>& cb) {
+        Entry entry = {CALLBACK, 0, m_cbs.size(), 0};
+        m_entries.push_back(entry);
+        m_cbs.push_back(cb);
+    }
+    void clear() {
+        // Keeps the capacity, for the next mtask to reuse
+        m_text.clear();
+        m_entries.clear();
+        m_cbs.clear();
+    }
+    void run() const;  // Execute the entries, in verilated.cpp
+};
+
+/// Each model's eval has a queue mtask threads push their chunks to;
+/// pushing doesn't lock, and the eval thread takes all chunks at end of eval.
 /// This assumes no thread starts pushing the next tick until the previous has drained.
-/// If more aggressiveness is needed, a double-buffered scheme might work well.
 class VerilatedEvalMsgQueue {
-    typedef std::multiset<VerilatedMsg, VerilatedMsg::Cmp> VerilatedThreadQueue;
+    std::atomic<VerilatedMsgChunk*> m_pendingp;  ///< Lock-free stack of chunks to run
+    std::vector<VerilatedMsgChunk*> m_sorted;  ///< Chunks being run, only used by process()
 
-    std::atomic<vluint64_t> m_depth;  ///< Current depth of queue (see comments below)
-
-    VerilatedMutex m_mutex;  ///< Mutex protecting queue
-    VerilatedThreadQueue m_queue VL_GUARDED_BY(m_mutex);  ///< Message queue
 public:
     // CONSTRUCTORS
     VerilatedEvalMsgQueue()
-        : m_depth(0) {
-        assert(atomic_is_lock_free(&m_depth));
+        : m_pendingp(NULL) {
+        assert(atomic_is_lock_free(&m_pendingp));
     }
     ~VerilatedEvalMsgQueue() {}
 
@@ -93,47 +157,37 @@ private:
 
 public:
     // METHODS
-    //// Add message to queue (called by producer)
-    void post(const VerilatedMsg& msg) VL_EXCLUDES(m_mutex) {
-        VerilatedLockGuard lock(m_mutex);
-        m_queue.insert(msg);  // Pass by value to copy the message into queue
-        ++m_depth;
-    }
-    /// Service queue until completion (called by consumer)
-    void process() VL_EXCLUDES(m_mutex) {
-        // Tracking m_depth is redundant to e.g. getting the mutex and looking at queue size,
-        // but on the reader side it's 4x faster to test an atomic then getting a mutex
-        while (m_depth) {
-            // Wait for a message to be added to the queue
-            // We don't use unique_lock as want to unlock with the message copy still in scope
-            m_mutex.lock();
-            assert(!m_queue.empty());  // Otherwise m_depth is wrong
-            // Unfortunately to release the lock we need to copy the message
-            // (Or have the message be a pointer, but then new/delete cost on each message)
-            // We assume messages are small, so copy
-            auto it = m_queue.begin();
-            const VerilatedMsg msg = *(it);
-            m_queue.erase(it);
-            m_mutex.unlock();
-            m_depth--;  // Ok if outside critical section as only this code checks the value
-            {
-                VL_DEBUG_IF(VL_DBG_MSGF("Executing callback from mtaskId=%d\n", msg.mtaskId()););
-                msg.run();
-            }
-        }
+    /// Add chunk of messages to queue (called by producer)
+    void post(VerilatedMsgChunk* chunkp) VL_MT_SAFE {
+        VerilatedMsgChunk* headp = m_pendingp.load(std::memory_order_relaxed);
+        do {
+            chunkp->m_nextp = headp;
+        } while (!m_pendingp.compare_exchange_weak(headp, chunkp, std::memory_order_release,
+                                                   std::memory_order_relaxed));
     }
+    /// Run all queued messages in mtask order (called by consumer), in verilated.cpp
+    void process();
 };
 
-/// Each thread has a local queue to build up messages until the end of the eval() call
+/// Each thread has a local chunk to build up messages until the end of its mtask
 class VerilatedThreadMsgQueue {
-    std::queue<VerilatedMsg> m_queue;
+    friend class VerilatedEvalMsgQueue;
+    VerilatedMsgChunk* m_curp;  ///< Chunk of the running mtask, or NULL
+    VerilatedMsgChunk* m_freep;  ///< Chunks ready for reuse, only used by this thread
+    std::atomic<VerilatedMsgChunk*> m_returnedp;  ///< Chunks run by eval threads, to reuse
 
 public:
     // CONSTRUCTORS
-    VerilatedThreadMsgQueue() {}
+    VerilatedThreadMsgQueue()
+        : m_curp(NULL)
+        , m_freep(NULL)
+        , m_returnedp(NULL) {}
     ~VerilatedThreadMsgQueue() {
-        // The only call of this with a non-empty queue is a fatal error.
-        // So this does not flush the queue, as the destination queue is not known to this class.
+        // The only call of this with a non-empty chunk is a fatal error.
+        // So this does not flush it, as the destination queue is not known to this class.
+        deleteList(m_curp);
+        deleteList(m_freep);
+        deleteList(m_returnedp.exchange(NULL));
     }
 
 private:
@@ -143,6 +197,41 @@ private:
         static VL_THREAD_LOCAL VerilatedThreadMsgQueue t_s;
         return t_s;
     }
+    static void deleteList(VerilatedMsgChunk* chunkp) {
+        while (chunkp) {
+            VerilatedMsgChunk* nextp = chunkp->m_nextp;
+            delete chunkp;
+            chunkp = nextp;
+        }
+    }
+    /// Chunk to add to, started from a reused chunk when possible
+    static VerilatedMsgChunk* curChunkp() VL_MT_SAFE {
+        VerilatedThreadMsgQueue& t_s = threadton();
+        if (VL_LIKELY(t_s.m_curp)) return t_s.m_curp;
+        // Paired with the Dec when the chunk is flushed
+        Verilated::endOfEvalReqdInc();
+        if (VL_UNLIKELY(!t_s.m_freep)) {
+            // Only this thread takes from the returned list, so taking it all is safe
+            t_s.m_freep = t_s.m_returnedp.exchange(NULL, std::memory_order_acquire);
+        }
+        if (t_s.m_freep) {
+            t_s.m_curp = t_s.m_freep;
+            t_s.m_freep = t_s.m_freep->m_nextp;
+        } else {
+            t_s.m_curp = new VerilatedMsgChunk(&t_s);
+        }
+        t_s.m_curp->m_mtaskId = Verilated::mtaskId();
+        return t_s.m_curp;
+    }
+    /// Give a run chunk back to its thread (called by consumer)
+    void recycle(VerilatedMsgChunk* chunkp) VL_MT_SAFE {
+        chunkp->clear();
+        VerilatedMsgChunk* headp = m_returnedp.load(std::memory_order_relaxed);
+        do {
+            chunkp->m_nextp = headp;
+        } while (!m_returnedp.compare_exchange_weak(headp, chunkp, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+    }
 
 public:
     /// Add message to queue, called by producer
@@ -153,18 +242,47 @@ public:
             // No queueing, just do the action immediately
             msg.run();
         } else {
-            Verilated::endOfEvalReqdInc();
-            threadton().m_queue.push(msg);  // Pass by value to copy the message into queue
+            curChunkp()->addCb(msg.cb());
         }
     }
-    /// Push all messages to the eval's queue
-    static void flush(VerilatedEvalMsgQueue* evalMsgQp) VL_MT_SAFE {
-        while (!threadton().m_queue.empty()) {
-            evalMsgQp->post(threadton().m_queue.front());
-            threadton().m_queue.pop();
-            Verilated::endOfEvalReqdDec();
+    /// Add text for VL_PRINTF, called by producer
+    static void postPrint(const std::string& text) VL_MT_SAFE {
+        if (Verilated::mtaskId() == 0) {
+            VL_PRINTF("%s", text.c_str());
+        } else {
+            curChunkp()->addText(VerilatedMsgChunk::PRINT, 0, text);
+        }
+    }
+    /// Add file write, called by producer
+    /// Consecutive writes to the same descriptor become a single write.
+    static void postWrite(IData fdi, const std::string& text) VL_MT_SAFE {
+        if (Verilated::mtaskId() == 0) {
+            FILE* fp = VL_CVT_I_FP(fdi);
+            if (VL_LIKELY(fp)) fwrite(text.data(), 1, text.size(), fp);
+        } else {
+            curChunkp()->addText(VerilatedMsgChunk::WRITE, fdi, text);
         }
     }
+    /// Add $fflush, after the writes before it, called by producer
+    static bool postFflush(IData fdi) VL_MT_SAFE {
+        if (Verilated::mtaskId() == 0) return false;  // Caller does it now
+        curChunkp()->addFd(VerilatedMsgChunk::FFLUSH, fdi);
+        return true;
+    }
+    /// Add $fclose, after the writes before it, called by producer
+    static bool postFclose(IData fdi) VL_MT_SAFE {
+        if (Verilated::mtaskId() == 0) return false;  // Caller does it now
+        curChunkp()->addFd(VerilatedMsgChunk::FCLOSE, fdi);
+        return true;
+    }
+    /// Push the mtask's messages to the eval's queue
+    static void flush(VerilatedEvalMsgQueue* evalMsgQp) VL_MT_SAFE {
+        VerilatedThreadMsgQueue& t_s = threadton();
+        if (!t_s.m_curp) return;
+        evalMsgQp->post(t_s.m_curp);
+        t_s.m_curp = NULL;
+        Verilated::endOfEvalReqdDec();
+    }
 };
 #endif  // VL_THREADED
 
@@ -180,6 +298,16 @@ protected:
     typedef std::vector<std::string> ArgVec;
     typedef std::map<std::pair<const void*, void*>, void*> UserMap;
     typedef std::map<const char*, int, VerilatedCStrCmp> ExportNameMap;
+    typedef std::vector<std::pair<VerilatedSnapshotCb, void*> > SnapshotCbs;
+    typedef std::vector<const VerilatedScope*> ScopeVec;
+    typedef std::vector<std::pair<VerilatedSyms*, VerilatedScope::VarsCb> > VarsDeferred;
+    struct Snapshot {
+        int m_id;  ///< Identifier returned by snapshot()
+        int m_fd;  ///< Pipe to the frozen process, to send it commands
+        Snapshot(int id, int fd)
+            : m_id(id)
+            , m_fd(fd) {}
+    };
 
     // MEMBERS
     static VerilatedImp s_s;  ///< Static Singleton; One and only static this
@@ -214,6 +342,14 @@ protected:
     VerilatedMutex m_nameMutex;  ///< Protect m_nameMap
     /// Map of <scope_name, scope pointer>
     VerilatedScopeNameMap m_nameMap VL_GUARDED_BY(m_nameMutex);
+    /// Scopes configured but not yet put into m_nameMap, see scopeNameRealize
+    ScopeVec m_namePending VL_GUARDED_BY(m_nameMutex);
+    /// Incremented when scopes or their variables are added or removed
+    vluint64_t m_nameGeneration VL_GUARDED_BY(m_nameMutex);
+
+    VerilatedMutex m_varsDeferMutex;  ///< Protect m_varsDeferred
+    /// Variable insertions to run on the first variable lookup
+    VarsDeferred m_varsDeferred VL_GUARDED_BY(m_varsDeferMutex);
 
     VerilatedMutex m_hierMapMutex;  ///< Protect m_hierMap
     /// Map the represents scope hierarchy
@@ -231,11 +367,25 @@ protected:
     /// List of free descriptors (SLOW - FOPEN/CLOSE only)
     std::deque<IData> m_fdFree VL_GUARDED_BY(m_fdMutex);
 
+    // Time events
+    VerilatedMutex m_timeEventMutex;  ///< Protect m_timeEvents
+    std::set<vluint64_t> m_timeEvents VL_GUARDED_BY(m_timeEventMutex);  ///< Registered times
+
+    // Snapshots (eval thread only, except the callbacks)
+    std::vector<Snapshot> m_snaps;  ///< Snapshots that may be rewound to, oldest first
+    int m_snapNext;  ///< Last snapshot identifier used
+    int m_rewindValue;  ///< Value passed by the last rewind()
+    VerilatedMutex m_snapCbMutex;  ///< Protect m_snapCbs
+    SnapshotCbs m_snapCbs VL_GUARDED_BY(m_snapCbMutex);  ///< Callbacks around fork()
+
 public:  // But only for verilated*.cpp
     // CONSTRUCTORS
     VerilatedImp()
         : m_argVecLoaded(false)
-        , m_exportNext(0) {
+        , m_nameGeneration(0)
+        , m_exportNext(0)
+        , m_snapNext(0)
+        , m_rewindValue(0) {
         m_fdps.resize(3);
         m_fdps[0] = stdin;
         m_fdps[1] = stdout;
@@ -300,6 +450,18 @@ public:
         return it->second;
     }
 
+    // METHODS - time events
+    static void timeEventAdd(vluint64_t time) VL_MT_SAFE {
+        VerilatedLockGuard lock(s_s.m_timeEventMutex);
+        s_s.m_timeEvents.insert(time);
+    }
+    static vluint64_t timeEventNext(vluint64_t now) VL_MT_SAFE {
+        VerilatedLockGuard lock(s_s.m_timeEventMutex);
+        s_s.m_timeEvents.erase(s_s.m_timeEvents.begin(), s_s.m_timeEvents.upper_bound(now));
+        if (s_s.m_timeEvents.empty()) return ~VL_ULL(0);
+        return *s_s.m_timeEvents.begin();
+    }
+
 private:
     /// Symbol table destruction cleans up the entries for each scope.
     static void userEraseScope(const VerilatedScope* scopep) VL_MT_SAFE {
@@ -328,16 +490,28 @@ private:
 
 public:  // But only for verilated*.cpp
     // METHODS - scope name
+    static void scopeNameRealize() VL_REQUIRES(s_s.m_nameMutex) {
+        // Put scopes configured since the last lookup into the name map.  Deferring
+        // this keeps model construction linear in the number of scopes.
+        for (ScopeVec::const_iterator pit = s_s.m_namePending.begin();
+             pit != s_s.m_namePending.end(); ++pit) {
+            const VerilatedScope* scopep = *pit;
+            VerilatedScopeNameMap::iterator it = s_s.m_nameMap.find(scopep->name());
+            if (it == s_s.m_nameMap.end()) {
+                s_s.m_nameMap.insert(it, std::make_pair(scopep->name(), scopep));
+            }
+        }
+        s_s.m_namePending.clear();
+    }
     static void scopeInsert(const VerilatedScope* scopep) VL_MT_SAFE {
         // Slow ok - called once/scope at construction
         VerilatedLockGuard lock(s_s.m_nameMutex);
-        VerilatedScopeNameMap::iterator it = s_s.m_nameMap.find(scopep->name());
-        if (it == s_s.m_nameMap.end()) {
-            s_s.m_nameMap.insert(it, std::make_pair(scopep->name(), scopep));
-        }
+        s_s.m_namePending.push_back(scopep);
+        ++s_s.m_nameGeneration;
     }
     static inline const VerilatedScope* scopeFind(const char* namep) VL_MT_SAFE {
         VerilatedLockGuard lock(s_s.m_nameMutex);
+        if (VL_UNLIKELY(!s_s.m_namePending.empty())) scopeNameRealize();
         // If too slow, can assume this is only VL_MT_SAFE_POSINIT
         VerilatedScopeNameMap::const_iterator it = s_s.m_nameMap.find(namep);
         if (VL_UNLIKELY(it == s_s.m_nameMap.end())) return NULL;
@@ -347,11 +521,30 @@ public:  // But only for verilated*.cpp
         // Slow ok - called once/scope at destruction
         VerilatedLockGuard lock(s_s.m_nameMutex);
         userEraseScope(scopep);
+        ++s_s.m_nameGeneration;
+        // Scopes are usually destroyed in reverse order, so if never looked up
+        // may be dropped from the end of the pending list
+        if (!s_s.m_namePending.empty() && s_s.m_namePending.back() == scopep) {
+            s_s.m_namePending.pop_back();
+            return;
+        }
+        scopeNameRealize();
         VerilatedScopeNameMap::iterator it = s_s.m_nameMap.find(scopep->name());
-        if (it != s_s.m_nameMap.end()) s_s.m_nameMap.erase(it);
+        if (it != s_s.m_nameMap.end() && it->second == scopep) s_s.m_nameMap.erase(it);
+    }
+    static void scopeVarsChanged() VL_MT_SAFE {
+        // Slow ok - called once/variable at construction
+        VerilatedLockGuard lock(s_s.m_nameMutex);
+        ++s_s.m_nameGeneration;
+    }
+    static vluint64_t scopeNameGeneration() VL_MT_SAFE {
+        VerilatedLockGuard lock(s_s.m_nameMutex);
+        return s_s.m_nameGeneration;
     }
     static void scopesDump() VL_MT_SAFE {
+        varsRealize();  // Before the lock, as inserting variables takes it
         VerilatedLockGuard lock(s_s.m_nameMutex);
+        scopeNameRealize();
         VL_PRINTF_MT("  scopesDump:\n");
         for (VerilatedScopeNameMap::const_iterator it = s_s.m_nameMap.begin();
              it != s_s.m_nameMap.end(); ++it) {
@@ -362,9 +555,43 @@ public:  // But only for verilated*.cpp
     }
     static const VerilatedScopeNameMap* scopeNameMap() VL_MT_SAFE_POSTINIT {
         // Thread save only assuming this is called only after model construction completed
+        {
+            VerilatedLockGuard lock(s_s.m_nameMutex);
+            scopeNameRealize();
+        }
         return &s_s.m_nameMap;
     }
 
+public:  // But only for verilated*.cpp
+    // METHODS - scope variables
+    static void varsDefer(VerilatedSyms* symsp, VerilatedScope::VarsCb cb) VL_MT_SAFE {
+        // Slow ok - called once/model at construction
+        VerilatedLockGuard lock(s_s.m_varsDeferMutex);
+        s_s.m_varsDeferred.push_back(std::make_pair(symsp, cb));
+    }
+    static void varsUndefer(VerilatedSyms* symsp) VL_MT_SAFE {
+        // Slow ok - called once/model at destruction
+        VerilatedLockGuard lock(s_s.m_varsDeferMutex);
+        for (VarsDeferred::iterator it = s_s.m_varsDeferred.begin();
+             it != s_s.m_varsDeferred.end();) {
+            if (it->first == symsp) {
+                it = s_s.m_varsDeferred.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    static void varsRealize() VL_MT_SAFE {
+        // Run the deferred variable insertions; called before any variable lookup
+        VerilatedLockGuard lock(s_s.m_varsDeferMutex);
+        if (VL_LIKELY(s_s.m_varsDeferred.empty())) return;
+        VarsDeferred deferred;
+        deferred.swap(s_s.m_varsDeferred);
+        for (VarsDeferred::const_iterator it = deferred.begin(); it != deferred.end(); ++it) {
+            it->second(it->first);
+        }
+    }
+
 public:  // But only for verilated*.cpp
     // METHODS - hierarchy
     static void hierarchyAdd(const VerilatedScope* fromp, const VerilatedScope* top) VL_MT_SAFE {
@@ -479,6 +706,17 @@ public:  // But only for verilated*.cpp
         if (VL_UNLIKELY(!(fdi & (VL_ULL(1) << 31)) || idx >= s_s.m_fdps.size())) return NULL;
         return s_s.m_fdps[idx];
     }
+
+public:  // But only for verilated*.cpp
+    // METHODS - snapshots, see Verilated::snapshot
+    static int snapshot() VL_MT_UNSAFE;
+    static void rewind(int id, int value) VL_ATTR_NORETURN VL_MT_UNSAFE;
+    static int rewindValue() VL_MT_UNSAFE { return s_s.m_rewindValue; }
+    static void snapshotCbAdd(VerilatedSnapshotCb cb, void* datap) VL_MT_SAFE;
+    static void snapshotCbRemove(VerilatedSnapshotCb cb, void* datap) VL_MT_SAFE;
+
+private:
+    static void snapshotCall(const SnapshotCbs& cbs, bool after);
 };
 
 //======================================================================
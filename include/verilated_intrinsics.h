@@ -34,6 +34,23 @@
 #  define VL_HAVE_AVX2 1
 #  include <immintrin.h>
 # endif
+# if defined(__AVX512F__) && defined(VL_HAVE_AVX2) && !defined(VL_DISABLE_AVX512)
+#  define VL_HAVE_AVX512 1
+# endif
+# if defined(__SSSE3__) && defined(VL_HAVE_SSE2) && !defined(VL_DISABLE_SSSE3)
+#  define VL_HAVE_SSSE3 1
+#  include <tmmintrin.h>
+# endif
+// Population count, used through the GCC builtin which is only faster
+// than the portable code when it is a single instruction
+# if defined(__POPCNT__) && defined(__GNUC__) && !defined(VL_NO_BUILTINS) \
+     && !defined(VL_DISABLE_POPCNT)
+#  define VL_HAVE_POPCNT 1
+# endif
+# if defined(__ARM_NEON) && !defined(VL_DISABLE_NEON)
+#  define VL_HAVE_NEON 1
+#  include <arm_neon.h>
+# endif
 #endif
 
 // clang-format on
@@ -0,0 +1,125 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief Live statistics of a running simulation, see --prof-live
+///
+/// This file must be compiled and linked against all objects
+/// created from Verilator with --prof-live.
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated_live.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+// clang-format off
+#if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
+# define VL_LIVE_NO_MMAP  // No mmap(); the statistics are not supported
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/time.h>
+# include <unistd.h>
+#endif
+// clang-format on
+
+//=============================================================================
+// Global state
+
+static VerilatedMutex s_liveMutex;  ///< Protects the below
+static int s_liveModels = 0;  ///< Models using the statistics
+static VerilatedLiveStats* s_liveStatsp = NULL;  ///< Mapped file, kept after the last close
+
+#ifndef VL_LIVE_NO_MMAP
+static vluint64_t liveWallUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<vluint64_t>(tv.tv_sec) * 1000000ULL + tv.tv_usec;
+}
+#endif
+
+//=============================================================================
+// VerilatedLive
+
+void VerilatedLive::open(const char* namep, int threads) VL_MT_SAFE {
+    const VerilatedLockGuard lock(s_liveMutex);
+    if (s_liveModels++) {
+        if (Verilated::liveStatsp()) {
+            VerilatedLiveStats::store(s_liveStatsp->m_threads,
+                                      std::max<vluint64_t>(s_liveStatsp->m_threads, threads));
+        }
+        return;
+    }
+#ifdef VL_LIVE_NO_MMAP
+    static int warnedOnce = 0;
+    if (!warnedOnce++) {
+        VL_PRINTF_MT("%%Warning: --prof-live not supported on this platform; ignored\n");
+    }
+#else
+    const std::string filename = Verilated::profLiveFilenamep();
+    VL_DEBUG_IF(VL_DBG_MSGF("+prof+live writing to '%s'\n", filename.c_str()););
+    if (!s_liveStatsp) {
+        const int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+        void* datap = MAP_FAILED;
+        if (fd >= 0 && !ftruncate(fd, sizeof(VerilatedLiveStats))) {
+            datap = mmap(NULL, sizeof(VerilatedLiveStats), PROT_READ | PROT_WRITE, MAP_SHARED,
+                         fd, 0);
+        }
+        if (fd >= 0) ::close(fd);  // The mapping stays valid
+        if (VL_UNLIKELY(datap == MAP_FAILED)) {
+            const std::string msg
+                = std::string("+prof+live+file file not writable: ") + strerror(errno);
+            VL_FATAL_MT(filename.c_str(), 0, "", msg.c_str());
+            s_liveModels = 0;
+            return;
+        }
+        s_liveStatsp = static_cast<VerilatedLiveStats*>(datap);
+    }
+    // A model created after the last was deleted reuses the file.  The
+    // file stays mapped after close, as other threads may still hold the
+    // pointer; it is small.
+    VerilatedLiveStats* const statsp = s_liveStatsp;
+    memset(statsp, 0, sizeof(VerilatedLiveStats));
+    statsp->m_version = VerilatedLiveStats::VERSION;
+    statsp->m_pid = getpid();
+    statsp->m_running = 1;
+    statsp->m_startUs = liveWallUs();
+    VL_RDTSC(statsp->m_startTicks);
+    statsp->m_ticks = statsp->m_startTicks;
+    statsp->m_threads = threads;
+    strncpy(statsp->m_name, namep, VerilatedLiveStats::NAME_SIZE - 1);
+#ifdef __GNUC__
+    __atomic_store_n(&statsp->m_magic, VerilatedLiveStats::MAGIC, __ATOMIC_RELEASE);
+#else
+    statsp->m_magic = VerilatedLiveStats::MAGIC;
+#endif
+    Verilated::liveStatsp(statsp);
+#endif
+}
+
+void VerilatedLive::close() VL_MT_SAFE {
+    const VerilatedLockGuard lock(s_liveMutex);
+    if (!s_liveModels || --s_liveModels) return;
+    Verilated::liveStatsp(NULL);
+#ifndef VL_LIVE_NO_MMAP
+    if (s_liveStatsp) {
+        VerilatedLiveStats::store(s_liveStatsp->m_endUs, liveWallUs());
+        VerilatedLiveStats::store(s_liveStatsp->m_running, 0);
+    }
+#endif
+}
@@ -0,0 +1,136 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief Live statistics of a running simulation, see --prof-live
+///
+/// The statistics are kept in a file mapped into memory, so a viewer such
+/// as verilator_top may read them while the simulation runs.
+///
+//=============================================================================
+
+#ifndef _VERILATED_LIVE_H_
+#define _VERILATED_LIVE_H_ 1
+
+#include "verilatedos.h"
+#include "verilated.h"
+
+//=============================================================================
+/// Layout of the live statistics file.  Any change to the layout must
+/// increment VERSION, and be made in verilator_top too.  All values are in
+/// host byte order.  Each counter is written with relaxed atomic stores, so
+/// readers see every counter whole, but not the counters as one snapshot.
+
+class VerilatedLiveStats {
+public:
+    enum { MAGIC = 0x564c4956 };  ///< "VLIV", written last when the file is set up
+    enum { VERSION = 1 };
+    enum { THREADS_MAX = 64 };  ///< Thread pool workers with their own busy counter
+    enum { NAME_SIZE = 64 };
+    enum CheckpointState { CHECKPOINT_IDLE = 0, CHECKPOINT_SAVING, CHECKPOINT_WRITING };
+
+    // MEMBERS
+    vluint32_t m_magic;  ///< MAGIC
+    vluint32_t m_version;  ///< VERSION
+    vluint64_t m_pid;  ///< Process writing the statistics
+    vluint64_t m_running;  ///< Non-zero until the last model is deleted
+    vluint64_t m_startUs;  ///< Wall clock time opened, microseconds since the epoch
+    vluint64_t m_endUs;  ///< Wall clock time closed, or 0
+    vluint64_t m_threads;  ///< Thread pool workers, 0 if not --threads
+    vluint64_t m_evals;  ///< Calls to eval() of all models
+    vluint64_t m_simTime;  ///< Simulation time at the last eval(), from sc_time_stamp()
+    vluint64_t m_startTicks;  ///< Cycle counter when opened, see VL_RDTSC
+    vluint64_t m_ticks;  ///< Cycle counter at the last eval()
+    vluint64_t m_traceBytes;  ///< Bytes written to trace files
+    vluint64_t m_checkpoints;  ///< Save files closed
+    vluint64_t m_checkpointTime;  ///< Simulation time of the last save
+    vluint64_t m_checkpointBytes;  ///< Uncompressed bytes of the last save
+    vluint64_t m_checkpointState;  ///< CheckpointState of the current save
+    vluint64_t m_threadBusy[THREADS_MAX];  ///< Cycle counter ticks each worker ran mtasks
+    char m_name[NAME_SIZE];  ///< Name of the first model, nul terminated
+
+    // METHODS
+    static inline vluint64_t load(const vluint64_t& var) {
+#ifdef __GNUC__
+        return __atomic_load_n(&var, __ATOMIC_RELAXED);
+#else
+        return *static_cast<const volatile vluint64_t*>(&var);
+#endif
+    }
+    static inline void store(vluint64_t& var, vluint64_t value) {
+#ifdef __GNUC__
+        __atomic_store_n(&var, value, __ATOMIC_RELAXED);
+#else
+        *static_cast<volatile vluint64_t*>(&var) = value;
+#endif
+    }
+    /// Add to a counter that more than one thread may update
+    static inline void add(vluint64_t& var, vluint64_t value) {
+#ifdef __GNUC__
+        __atomic_fetch_add(&var, value, __ATOMIC_RELAXED);
+#else
+        store(var, load(var) + value);
+#endif
+    }
+
+    /// Called by the model at the end of each eval()
+    inline void evalDone() {
+        add(m_evals, 1);
+        store(m_simTime, VL_TIME_Q());
+        vluint64_t ticks;
+        VL_RDTSC(ticks);
+        store(m_ticks, ticks);
+    }
+    /// Called by each thread pool worker after it ran mtasks
+    inline void threadBusy(int index, vluint64_t ticks) {
+        // Models with their own pools share the worker indexes
+        if (VL_LIKELY(index < THREADS_MAX)) add(m_threadBusy[index], ticks);
+    }
+    /// Called by trace files after writing to the file
+    inline void traceWrote(vluint64_t bytes) { add(m_traceBytes, bytes); }
+    /// Called by VerilatedSave when a save file is opened
+    inline void checkpointBegin() {
+        store(m_checkpointTime, VL_TIME_Q());
+        store(m_checkpointState, CHECKPOINT_SAVING);
+    }
+    /// Called by VerilatedSave when a save file is closed, but perhaps
+    /// still being written by a background thread
+    inline void checkpointEnd(vluint64_t bytes, bool writing) {
+        store(m_checkpointBytes, bytes);
+        add(m_checkpoints, 1);
+        store(m_checkpointState, writing ? CHECKPOINT_WRITING : CHECKPOINT_IDLE);
+    }
+    /// Called by VerilatedSave once a background write finished
+    inline void checkpointWritten() { store(m_checkpointState, CHECKPOINT_IDLE); }
+};
+
+//=============================================================================
+/// Creation of the live statistics file, called by models built with
+/// --prof-live.  The file is created by the first model, from
+/// Verilated::profLiveFilenamep(), and marked finished once the last is
+/// deleted.  The statistics of the process are from Verilated::liveStatsp().
+
+class VerilatedLive {
+public:
+    /// Open the statistics, or count another model using them
+    static void open(const char* namep, int threads) VL_MT_SAFE;
+    /// Close after the last model using the statistics
+    static void close() VL_MT_SAFE;
+    /// Count one eval() of a model, where the statistics are open
+    static inline void evalDone() VL_MT_SAFE {
+        VerilatedLiveStats* const statsp = Verilated::liveStatsp();
+        if (VL_LIKELY(statsp)) statsp->evalDone();
+    }
+};
+
+#endif  // Guard
@@ -19,9 +19,12 @@
 #include "verilatedos.h"
 #include "verilated.h"
 #include "verilated_save.h"
+#include "verilated_live.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <fcntl.h>
+#include <vector>
 
 // clang-format off
 #if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
@@ -39,12 +42,558 @@
 #ifndef O_CLOEXEC
 # define O_CLOEXEC 0
 #endif
+
+// Include the GTKWave LZ4 implementation directly.  The FST and VBT trace
+// writers also include it, so rename its functions to allow linking both.
+# define LZ4_compress vlsave_LZ4_compress
+# define LZ4_compressBound vlsave_LZ4_compressBound
+# define LZ4_compress_continue vlsave_LZ4_compress_continue
+# define LZ4_compress_default vlsave_LZ4_compress_default
+# define LZ4_compress_destSize vlsave_LZ4_compress_destSize
+# define LZ4_compress_fast vlsave_LZ4_compress_fast
+# define LZ4_compress_fast_continue vlsave_LZ4_compress_fast_continue
+# define LZ4_compress_fast_extState vlsave_LZ4_compress_fast_extState
+# define LZ4_compress_fast_force vlsave_LZ4_compress_fast_force
+# define LZ4_compress_forceExtDict vlsave_LZ4_compress_forceExtDict
+# define LZ4_compress_limitedOutput vlsave_LZ4_compress_limitedOutput
+# define LZ4_compress_limitedOutput_continue vlsave_LZ4_compress_limitedOutput_continue
+# define LZ4_compress_limitedOutput_withState vlsave_LZ4_compress_limitedOutput_withState
+# define LZ4_compress_withState vlsave_LZ4_compress_withState
+# define LZ4_create vlsave_LZ4_create
+# define LZ4_createStream vlsave_LZ4_createStream
+# define LZ4_createStreamDecode vlsave_LZ4_createStreamDecode
+# define LZ4_decompress_fast vlsave_LZ4_decompress_fast
+# define LZ4_decompress_fast_continue vlsave_LZ4_decompress_fast_continue
+# define LZ4_decompress_fast_usingDict vlsave_LZ4_decompress_fast_usingDict
+# define LZ4_decompress_fast_withPrefix64k vlsave_LZ4_decompress_fast_withPrefix64k
+# define LZ4_decompress_safe vlsave_LZ4_decompress_safe
+# define LZ4_decompress_safe_continue vlsave_LZ4_decompress_safe_continue
+# define LZ4_decompress_safe_forceExtDict vlsave_LZ4_decompress_safe_forceExtDict
+# define LZ4_decompress_safe_partial vlsave_LZ4_decompress_safe_partial
+# define LZ4_decompress_safe_usingDict vlsave_LZ4_decompress_safe_usingDict
+# define LZ4_decompress_safe_withPrefix64k vlsave_LZ4_decompress_safe_withPrefix64k
+# define LZ4_freeStream vlsave_LZ4_freeStream
+# define LZ4_freeStreamDecode vlsave_LZ4_freeStreamDecode
+# define LZ4_loadDict vlsave_LZ4_loadDict
+# define LZ4_resetStream vlsave_LZ4_resetStream
+# define LZ4_resetStreamState vlsave_LZ4_resetStreamState
+# define LZ4_saveDict vlsave_LZ4_saveDict
+# define LZ4_setStreamDecode vlsave_LZ4_setStreamDecode
+# define LZ4_sizeofState vlsave_LZ4_sizeofState
+# define LZ4_sizeofStreamState vlsave_LZ4_sizeofStreamState
+# define LZ4_slideInputBuffer vlsave_LZ4_slideInputBuffer
+# define LZ4_uncompress vlsave_LZ4_uncompress
+# define LZ4_uncompress_unknownOutputSize vlsave_LZ4_uncompress_unknownOutputSize
+# define LZ4_versionNumber vlsave_LZ4_versionNumber
+#include "gtkwave/lz4.c"
+
+#if !defined(_WIN32) || defined(__CYGWIN__)
+# include <sys/mman.h>
+# include <sys/stat.h>
+# define VL_SAVE_MMAP 1  // Large arrays may be mapped on restore
+#endif
+
+#ifdef VL_THREADED
+# include <condition_variable>
+# include <deque>
+# include <mutex>
+# include <thread>
+#endif
 // clang-format on
 
 // CONSTANTS
 static const char* const VLTSAVE_HEADER_STR
-    = "verilatorsave01\n";  ///< Value of first bytes of each file
+    = "verilatorsave02\n";  ///< Value of first bytes of each file
 static const char* const VLTSAVE_TRAILER_STR = "vltsaved";  ///< Value of last bytes of each file
+static const char* const VLTSAVE_SCOPES_STR = "vlscopes";  ///< Value before the model's sections
+static const vluint64_t VLTSAVE_SECTION_END = ~VL_ULL(0);  ///< Part length ending a section
+static const char* const VLTSAVE_DELTA_STR
+    = "verilatordelta01";  ///< Value of first bytes of each delta file
+static const char* const VLTSAVE_DELTA_END_STR = "vltdelta";  ///< Value of last bytes of delta
+static const size_t VLTSAVE_DELTA_PAGE = 4096;  ///< Bytes of saved data per delta page
+static const vluint64_t VLTSAVE_DELTA_LAST = ~VL_ULL(0);  ///< Page index ending page records
+static const size_t VLTSAVE_DELTA_FOOTER = 24;  ///< Bytes of footer, see below
+
+// A delta file is, all numbers 64 bits in host byte order:
+//   VLTSAVE_DELTA_STR, parent filename length, parent filename
+//   For each page that differs from the parent: page index, page data
+//   VLTSAVE_DELTA_LAST
+//   Hash of each page
+//   Saved data bytes, file offset of the hashes, VLTSAVE_DELTA_END_STR
+// Pages are VLTSAVE_DELTA_PAGE bytes, except for the last which may be shorter.
+// Concatenating the pages gives what open() would have saved.
+
+static const char* const VLTSAVE_LZ4_STR
+    = "verilatorlz4s01\n";  ///< Value of first bytes of each compressed file
+static const size_t VLTSAVE_LZ4_BLOCK = 64 * 1024;  ///< Maximum saved data bytes per block
+
+static const size_t VLTSAVE_ALIGN = 4096;  ///< Alignment of large arrays in saved data
+static const size_t VLTSAVE_ALIGN_MIN = 64 * 1024;  ///< Smallest array written aligned
+
+// An array of at least VLTSAVE_ALIGN_MIN bytes is saved as a 64-bit pad
+// size, that many zeros, then the array.  The pad makes the array's offset
+// in the saved data have the same misalignment to VLTSAVE_ALIGN as the
+// array had in memory, so on restore, if the array is at the same
+// misalignment, its whole pages can be mapped from an uncompressed file.
+
+// A model's state is VLTSAVE_SCOPES_STR, then a section per scope, then
+// VLTSAVE_SECTION_END.  A section is the scope name's length, the name
+// padded to 8 bytes, a hash of the names and widths of the scope's
+// variables, then parts each a 64-bit length and that many bytes, then
+// VLTSAVE_SECTION_END.  An array written aligned is a part to itself, so
+// the pad above is from the start of the part's data.  Restoring reads the
+// sections by name, and skips those not wanted after the layout hash.
+
+// A compressed file is VLTSAVE_LZ4_STR, then blocks each of a 32-bit saved
+// data size, 32-bit compressed size, and the LZ4 compressed data.  Blocks
+// that don't compress have both sizes equal, and the data stored as is.
+
+//=============================================================================
+// File helpers
+
+// Write all of the data, returns errno or 0
+static int vlSaveWrite(int fd, const void* datap, size_t size) {
+    const vluint8_t* dp = static_cast<const vluint8_t*>(datap);
+    while (size) {
+        errno = 0;
+        ssize_t got = ::write(fd, dp, size);
+        if (got > 0) {
+            dp += got;
+            size -= got;
+        } else if (got < 0 && errno != EAGAIN && errno != EINTR) {
+            return errno;
+        }
+    }
+    return 0;
+}
+
+// Read up to size bytes, stopping early only at EOF; returns bytes or -1 on error
+static ssize_t vlSaveRead(int fd, void* datap, size_t size) {
+    vluint8_t* dp = static_cast<vluint8_t*>(datap);
+    size_t done = 0;
+    while (done < size) {
+        errno = 0;
+        ssize_t got = ::read(fd, dp + done, size - done);
+        if (got > 0) {
+            done += got;
+        } else if (got == 0) {
+            break;
+        } else if (errno != EAGAIN && errno != EINTR) {
+            return -1;
+        }
+    }
+    return done;
+}
+
+static bool vlSaveReadAt(int fd, vluint64_t offset, void* datap, size_t size) {
+    if (::lseek(fd, static_cast<off_t>(offset), SEEK_SET) == static_cast<off_t>(-1)) return false;
+    return vlSaveRead(fd, datap, size) == static_cast<ssize_t>(size);
+}
+
+//=============================================================================
+// Delta checkpoint helpers
+
+static inline vluint64_t vlSaveMix(vluint64_t x) {
+    // Finalizer from splitmix64
+    x ^= x >> 30;
+    x *= VL_ULL(0xbf58476d1ce4e5b9);
+    x ^= x >> 27;
+    x *= VL_ULL(0x94d049bb133111eb);
+    x ^= x >> 31;
+    return x;
+}
+
+static vluint64_t vlSaveHash(const vluint8_t* datap, size_t size) {
+    vluint64_t hash = vlSaveMix(size);
+    for (; size >= 8; datap += 8, size -= 8) {
+        vluint64_t word;
+        memcpy(&word, datap, 8);
+        hash = vlSaveMix(hash ^ word) + word;
+    }
+    if (size) {
+        vluint64_t word = 0;
+        memcpy(&word, datap, size);
+        hash = vlSaveMix(hash ^ word) + word;
+    }
+    return hash;
+}
+
+static vluint64_t vlSavePages(vluint64_t bytes) {
+    return (bytes + VLTSAVE_DELTA_PAGE - 1) / VLTSAVE_DELTA_PAGE;
+}
+
+// Check a delta file's signatures, and read the footer
+static bool vlSaveReadFooter(int fd, vluint64_t& imageBytes, vluint64_t& hashOffset) {
+    const off_t fileBytes = ::lseek(fd, 0, SEEK_END);
+    if (fileBytes < static_cast<off_t>(strlen(VLTSAVE_DELTA_STR) + VLTSAVE_DELTA_FOOTER)) {
+        return false;
+    }
+    char magic[16];
+    if (!vlSaveReadAt(fd, 0, magic, sizeof(magic))) return false;
+    if (memcmp(magic, VLTSAVE_DELTA_STR, sizeof(magic))) return false;
+    vluint64_t footer[3];
+    if (!vlSaveReadAt(fd, fileBytes - VLTSAVE_DELTA_FOOTER, footer, sizeof(footer))) return false;
+    if (memcmp(&footer[2], VLTSAVE_DELTA_END_STR, 8)) return false;
+    imageBytes = footer[0];
+    hashOffset = footer[1];
+    return hashOffset + vlSavePages(imageBytes) * 8 <= static_cast<vluint64_t>(fileBytes);
+}
+
+// Read the page hashes of a delta file
+static bool vlSaveReadHashes(const char* filenamep, std::vector<vluint64_t>& hashes) {
+    const int fd = ::open(filenamep, O_RDONLY | O_LARGEFILE | O_CLOEXEC);
+    if (fd < 0) return false;
+    vluint64_t imageBytes;
+    vluint64_t hashOffset;
+    bool ok = vlSaveReadFooter(fd, imageBytes, hashOffset);
+    if (ok) {
+        hashes.resize(vlSavePages(imageBytes));
+        if (!hashes.empty()) ok = vlSaveReadAt(fd, hashOffset, &hashes[0], hashes.size() * 8);
+    }
+    ::close(fd);
+    return ok;
+}
+
+//=============================================================================
+// VerilatedSaveDelta - state of a delta checkpoint being written
+
+class VerilatedSaveDelta {
+public:
+    std::vector<vluint64_t> m_parentHashes;  ///< Hash of each page in the parent
+    std::vector<vluint64_t> m_hashes;  ///< Hash of each page written so far
+    std::vector<vluint8_t> m_page;  ///< Page being assembled
+    size_t m_pageUsed;  ///< Bytes in m_page
+    vluint64_t m_imageBytes;  ///< Saved data bytes, in pages written so far
+    vluint64_t m_fileBytes;  ///< Bytes of file written, including m_out
+    std::vector<vluint8_t> m_out;  ///< File data not yet written
+    VerilatedSaveDelta()
+        : m_page(VLTSAVE_DELTA_PAGE)
+        , m_pageUsed(0)
+        , m_imageBytes(0)
+        , m_fileBytes(0) {}
+    void out(const void* datap, size_t size) {
+        const vluint8_t* dp = static_cast<const vluint8_t*>(datap);
+        m_out.insert(m_out.end(), dp, dp + size);
+        m_fileBytes += size;
+    }
+};
+
+//=============================================================================
+// VerilatedRestoreChain - a delta checkpoint and its parents being read
+
+class VerilatedRestoreChain {
+    struct Link {
+        int m_fd;  ///< File descriptor we're reading
+        std::string m_filename;  ///< Filename, for error messages
+        vluint64_t m_imageBytes;  ///< Saved data bytes
+        vluint64_t m_nextPage;  ///< Index of next page record in file
+        std::vector<vluint8_t> m_buf;  ///< Read buffer
+        size_t m_pos;  ///< Next byte to use in m_buf
+        size_t m_end;  ///< End of valid data in m_buf
+    };
+    std::vector<Link> m_links;  ///< Files of the chain, newest first
+    std::vector<vluint8_t> m_skip;  ///< Scratch for pages replaced by newer files
+    vluint64_t m_page;  ///< Index of next page to return
+    std::string m_error;  ///< Error message, or empty
+
+    bool fail(const std::string& msg) {
+        if (m_error.empty()) m_error = msg;
+        return false;
+    }
+    bool linkRead(Link& link, void* datap, size_t size) {
+        vluint8_t* dp = static_cast<vluint8_t*>(datap);
+        while (size) {
+            if (link.m_pos == link.m_end) {
+                errno = 0;
+                ssize_t got = ::read(link.m_fd, &link.m_buf[0], link.m_buf.size());
+                if (got < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                if (got <= 0) return fail("Can't restore; delta checkpoint is truncated: "
+                                          + link.m_filename);
+                link.m_pos = 0;
+                link.m_end = got;
+            }
+            const size_t blk = std::min(size, link.m_end - link.m_pos);
+            memcpy(dp, &link.m_buf[link.m_pos], blk);
+            link.m_pos += blk;
+            dp += blk;
+            size -= blk;
+        }
+        return true;
+    }
+
+public:
+    VerilatedRestoreChain()
+        : m_skip(VLTSAVE_DELTA_PAGE)
+        , m_page(0) {}
+    ~VerilatedRestoreChain() {
+        for (std::vector<Link>::iterator it = m_links.begin(); it != m_links.end(); ++it) {
+            ::close(it->m_fd);
+        }
+    }
+    const std::string& error() const { return m_error; }
+    // Open the file and all of its parents; false and error() if fails
+    bool open(const char* filenamep) {
+        std::string filename = filenamep;
+        while (!filename.empty()) {
+            for (std::vector<Link>::const_iterator it = m_links.begin(); it != m_links.end();
+                 ++it) {
+                if (it->m_filename == filename) {
+                    return fail("Can't restore; delta checkpoint chain loops: " + filename);
+                }
+            }
+            Link link;
+            link.m_fd = ::open(filename.c_str(), O_RDONLY | O_LARGEFILE | O_CLOEXEC);
+            if (link.m_fd < 0) {
+                return fail("Can't restore; can't open delta checkpoint parent: " + filename);
+            }
+            link.m_filename = filename;
+            link.m_nextPage = VLTSAVE_DELTA_LAST;
+            link.m_pos = 0;
+            link.m_end = 0;
+            m_links.push_back(link);
+            Link& newLink = m_links.back();
+            vluint64_t hashOffset;
+            if (!vlSaveReadFooter(newLink.m_fd, newLink.m_imageBytes, hashOffset)
+                || ::lseek(newLink.m_fd, strlen(VLTSAVE_DELTA_STR), SEEK_SET)
+                       == static_cast<off_t>(-1)) {
+                return fail("Can't restore; file is not a complete delta checkpoint: "
+                            + filename);
+            }
+            newLink.m_buf.resize(64 * 1024);
+            vluint64_t parentLen;
+            if (!linkRead(newLink, &parentLen, sizeof(parentLen))) return false;
+            if (parentLen > hashOffset) {
+                return fail("Can't restore; delta checkpoint is corrupt: " + filename);
+            }
+            std::string parent(parentLen, '\0');
+            if (parentLen && !linkRead(newLink, &parent[0], parentLen)) return false;
+            if (!linkRead(newLink, &newLink.m_nextPage, sizeof(newLink.m_nextPage))) {
+                return false;
+            }
+            filename = parent;
+        }
+        return true;
+    }
+    // Read the next page of saved data, return its size, or 0 at end or error()
+    size_t readPage(vluint8_t* datap) {
+        const vluint64_t start = m_page * VLTSAVE_DELTA_PAGE;
+        const vluint64_t imageBytes = m_links.front().m_imageBytes;
+        if (start >= imageBytes) return 0;
+        const size_t size = std::min<vluint64_t>(VLTSAVE_DELTA_PAGE, imageBytes - start);
+        bool found = false;
+        // The newest file with the page has its data, older ones are skipped over
+        for (std::vector<Link>::iterator it = m_links.begin(); it != m_links.end(); ++it) {
+            if (it->m_nextPage != m_page) continue;
+            if (it->m_imageBytes <= start) {
+                fail("Can't restore; delta checkpoint is corrupt: " + it->m_filename);
+                return 0;
+            }
+            const size_t linkSize = std::min<vluint64_t>(VLTSAVE_DELTA_PAGE,
+                                                         it->m_imageBytes - start);
+            if (found) {
+                if (!linkRead(*it, &m_skip[0], linkSize)) return 0;
+            } else {
+                if (linkSize != size) {
+                    fail("Can't restore; delta checkpoint is corrupt: " + it->m_filename);
+                    return 0;
+                }
+                if (!linkRead(*it, datap, size)) return 0;
+                found = true;
+            }
+            if (!linkRead(*it, &it->m_nextPage, sizeof(it->m_nextPage))) return 0;
+        }
+        if (!found) {
+            fail("Can't restore; delta checkpoint parent is missing data, was it replaced?: "
+                 + m_links.back().m_filename);
+            return 0;
+        }
+        ++m_page;
+        return size;
+    }
+};
+
+//=============================================================================
+// VerilatedSaveWriter - compress and/or write a file from a background thread
+
+class VerilatedSaveWriter {
+    int m_fd;  ///< File descriptor we're writing to, closed when done
+    bool m_compress;  ///< Compress with LZ4
+    std::vector<char> m_block;  ///< Compressed block being written
+    int m_errno;  ///< First write error, or 0
+#ifdef VL_THREADED
+    typedef std::vector<vluint8_t> Buffer;
+    std::deque<Buffer*> m_pend;  ///< Data for the writer thread, oldest first
+    std::vector<Buffer*> m_free;  ///< Written buffers, for reuse
+    bool m_closing;  ///< No more data; the thread closes the file once idle
+    std::mutex m_mutex;  ///< Protects the above and m_errno
+    std::condition_variable m_cond;  ///< Signalled when m_pend or m_closing change
+    std::unique_ptr<std::thread> m_thread;  ///< The writer thread, if async
+#endif
+
+    // Write data, compressing if needed; returns errno or 0
+    int process(const vluint8_t* datap, size_t size) {
+        if (!m_compress) return vlSaveWrite(m_fd, datap, size);
+        while (size) {
+            const size_t raw = std::min(size, VLTSAVE_LZ4_BLOCK);
+            m_block.resize(8 + LZ4_compressBound(raw));
+            int comp = LZ4_compress_default(reinterpret_cast<const char*>(datap), &m_block[8],
+                                            raw, m_block.size() - 8);
+            if (comp <= 0 || static_cast<size_t>(comp) >= raw) {  // Store as is
+                comp = raw;
+                memcpy(&m_block[8], datap, raw);
+            }
+            const vluint32_t sizes[2]
+                = {static_cast<vluint32_t>(raw), static_cast<vluint32_t>(comp)};
+            memcpy(&m_block[0], sizes, sizeof(sizes));
+            if (const int err = vlSaveWrite(m_fd, &m_block[0], 8 + comp)) return err;
+            datap += raw;
+            size -= raw;
+        }
+        return 0;
+    }
+    void closeFd() {
+        if (m_fd >= 0) ::close(m_fd);  // May get error, just ignore it
+        m_fd = -1;
+    }
+#ifdef VL_THREADED
+    void threadMain() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            while (m_pend.empty() && !m_closing) m_cond.wait(lock);
+            if (m_pend.empty()) break;  // Closing, and nothing left to write
+            Buffer* const bufp = m_pend.front();
+            m_pend.pop_front();
+            const bool skip = m_errno;  // Nothing more is written after an error
+            lock.unlock();
+            const int err = skip ? 0 : process(&(*bufp)[0], bufp->size());
+            lock.lock();
+            if (err) m_errno = err;
+            m_free.push_back(bufp);
+        }
+        lock.unlock();
+        closeFd();
+        if (VerilatedLiveStats* const livep = Verilated::liveStatsp()) livep->checkpointWritten();
+    }
+#endif
+
+public:
+    VerilatedSaveWriter(int fd, bool compress, bool async)
+        : m_fd(fd)
+        , m_compress(compress)
+        , m_errno(0) {
+        if (m_compress) m_errno = vlSaveWrite(m_fd, VLTSAVE_LZ4_STR, strlen(VLTSAVE_LZ4_STR));
+#ifdef VL_THREADED
+        m_closing = false;
+        if (async) m_thread.reset(new std::thread(&VerilatedSaveWriter::threadMain, this));
+#endif
+    }
+    ~VerilatedSaveWriter() {
+        wait();
+#ifdef VL_THREADED
+        for (std::vector<Buffer*>::iterator it = m_free.begin(); it != m_free.end(); ++it) {
+            delete *it;
+        }
+#endif
+    }
+    // Write data, or with a thread queue a copy of it; returns errno of
+    // this or an earlier write, or 0
+    int write(const void* datap, size_t size) {
+        if (!size) return m_errno;
+        const vluint8_t* dp = static_cast<const vluint8_t*>(datap);
+#ifdef VL_THREADED
+        if (m_thread) {
+            Buffer* bufp = NULL;
+            {
+                const std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_free.empty()) {
+                    bufp = m_free.back();
+                    m_free.pop_back();
+                }
+            }
+            if (!bufp) bufp = new Buffer;
+            bufp->assign(dp, dp + size);
+            int err;
+            {
+                const std::lock_guard<std::mutex> lock(m_mutex);
+                m_pend.push_back(bufp);
+                err = m_errno;
+            }
+            m_cond.notify_all();
+            return err;
+        }
+#endif
+        if (!m_errno) m_errno = process(dp, size);
+        return m_errno;
+    }
+    // Whether the file is written from a background thread
+    bool async() const {
+#ifdef VL_THREADED
+        if (m_thread) return true;
+#endif
+        return false;
+    }
+    // No more data; close the file once it is written
+    void close() {
+#ifdef VL_THREADED
+        if (m_thread) {
+            {
+                const std::lock_guard<std::mutex> lock(m_mutex);
+                m_closing = true;
+            }
+            m_cond.notify_all();
+            return;
+        }
+#endif
+        closeFd();
+    }
+    // Wait for the file to be written and closed; returns errno of any write, or 0
+    int wait() {
+#ifdef VL_THREADED
+        if (m_thread) {
+            close();
+            m_thread->join();
+            m_thread.reset();
+        }
+#endif
+        closeFd();
+        return m_errno;
+    }
+};
+
+//=============================================================================
+// VerilatedRestoreLz4 - decompression of a compressed file being read
+
+class VerilatedRestoreLz4 {
+    std::vector<char> m_block;  ///< Compressed block being read
+    std::string m_error;  ///< Error message, or empty
+
+public:
+    const std::string& error() const { return m_error; }
+    // Read and decompress the next block, return its size, or 0 at end or error()
+    size_t readBlock(int fd, const std::string& filename, vluint8_t* datap) {
+        vluint32_t sizes[2];
+        const ssize_t got = vlSaveRead(fd, sizes, sizeof(sizes));
+        if (got == 0) return 0;  // EOF
+        if (got != sizeof(sizes) || !sizes[1] || sizes[0] > VLTSAVE_LZ4_BLOCK
+            || sizes[1] > sizes[0]) {
+            m_error = "Can't restore; compressed file is corrupt: " + filename;
+            return 0;
+        }
+        if (sizes[1] == sizes[0]) {  // Stored as is
+            if (vlSaveRead(fd, datap, sizes[0]) == static_cast<ssize_t>(sizes[0])) return sizes[0];
+        } else {
+            m_block.resize(sizes[1]);
+            if (vlSaveRead(fd, &m_block[0], sizes[1]) == static_cast<ssize_t>(sizes[1])
+                && LZ4_decompress_safe(&m_block[0], reinterpret_cast<char*>(datap), sizes[1],
+                                       sizes[0])
+                       == static_cast<int>(sizes[0])) {
+                return sizes[0];
+            }
+        }
+        m_error = "Can't restore; compressed file is corrupt: " + filename;
+        return 0;
+    }
+};
 
 //=============================================================================
 //=============================================================================
@@ -113,6 +662,174 @@ void VerilatedDeserialize::trailer() VL_MT_UNSAFE_ONE {
     }
 }
 
+//=============================================================================
+// Sections
+
+void VerilatedSerialize::scopesBegin() VL_MT_UNSAFE_ONE {
+    assert((strlen(VLTSAVE_SCOPES_STR) & 7) == 0);  // Keep aligned
+    write(VLTSAVE_SCOPES_STR, strlen(VLTSAVE_SCOPES_STR));
+}
+
+void VerilatedSerialize::scopesEnd() VL_MT_UNSAFE_ONE {
+    write(&VLTSAVE_SECTION_END, sizeof(VLTSAVE_SECTION_END));
+}
+
+void VerilatedSerialize::sectionBegin(const char* namep, vluint64_t layout) VL_MT_UNSAFE_ONE {
+    static const vluint8_t s_zeros[8] = {};
+    const vluint64_t len = strlen(namep);
+    write(&len, sizeof(len));
+    write(namep, len);
+    write(s_zeros, (8 - len % 8) % 8);
+    write(&layout, sizeof(layout));
+    partOpen();
+}
+
+void VerilatedSerialize::sectionEnd() VL_MT_UNSAFE_ONE {
+    partClose();
+    write(&VLTSAVE_SECTION_END, sizeof(VLTSAVE_SECTION_END));
+}
+
+void VerilatedSerialize::partOpen() VL_MT_UNSAFE_ONE {
+    // The length is filled in by partClose, so the part is held in the
+    // buffer until then, see bufferHold()
+    const vluint64_t len = 0;
+    write(&len, sizeof(len));
+    m_partp = m_cp - sizeof(len);
+}
+
+void VerilatedSerialize::partClose() VL_MT_UNSAFE_ONE {
+    if (!m_partp) return;
+    const vluint64_t len = m_cp - m_partp - sizeof(len);
+    memcpy(m_partp, &len, sizeof(len));
+    m_partp = NULL;
+}
+
+void VerilatedSerialize::bufferHold() VL_MT_UNSAFE_ONE {
+    // Flush the data before the open part, and move the part to the start
+    // of the buffer, growing the buffer if the part alone fills it
+    const size_t held = m_cp - m_partp;
+    m_cp = m_partp;
+    flush();
+    if (m_cp != m_partp) memmove(m_cp, m_partp, held);
+    m_partp = m_cp;
+    m_cp += held;
+    if (m_cp > (m_bufp + (m_bufSize - bufferInsertSize()))) {
+        const size_t newSize = m_bufSize * 2;
+        vluint8_t* const newp = new vluint8_t[newSize];
+        memcpy(newp, m_bufp, m_cp - m_bufp);
+        m_partp = newp + (m_partp - m_bufp);
+        m_cp = newp + (m_cp - m_bufp);
+        VL_DO_CLEAR(delete[] m_bufp, m_bufp = newp);
+        m_bufSize = newSize;
+    }
+}
+
+void VerilatedDeserialize::scopesBegin() VL_MT_UNSAFE_ONE {
+    readAssert(VLTSAVE_SCOPES_STR, strlen(VLTSAVE_SCOPES_STR));
+    m_sectionsRestored = 0;
+    m_sectionsSkipped = 0;
+}
+
+void VerilatedDeserialize::scopesEnd(size_t modelScopes) VL_MT_UNSAFE_ONE {
+    if (VL_UNLIKELY(!m_partial && m_scopePrefix.empty() && m_sectionsRestored != modelScopes)) {
+        std::string fn = filename();
+        std::string msg
+            = "Can't deserialize save-restore file as model has scopes not in file: " + filename();
+        VL_FATAL_MT(fn.c_str(), 0, "", msg.c_str());
+        close();
+    }
+}
+
+const char* VerilatedDeserialize::sectionNext() VL_MT_UNSAFE_ONE {
+    vluint64_t len;
+    read(&len, sizeof(len));
+    if (len == VLTSAVE_SECTION_END || !isOpen()) return NULL;
+    if (VL_UNLIKELY(len > bufferInsertSize())) {
+        m_sectionName = "";
+        sectionFail("has a corrupt name");
+        return NULL;
+    }
+    m_sectionName.resize(len + (8 - len % 8) % 8);
+    read(&m_sectionName[0], m_sectionName.size());
+    m_sectionName.resize(len);
+    return m_sectionName.c_str();
+}
+
+bool VerilatedDeserialize::sectionWanted() const {
+    return m_scopePrefix.empty() || m_sectionName == m_scopePrefix
+           || (m_sectionName.size() > m_scopePrefix.size()
+               && m_sectionName.compare(0, m_scopePrefix.size(), m_scopePrefix) == 0
+               && m_sectionName[m_scopePrefix.size()] == '.');
+}
+
+bool VerilatedDeserialize::sectionLayout(vluint64_t layout) VL_MT_UNSAFE_ONE {
+    vluint64_t saved;
+    vluint64_t len;
+    read(&saved, sizeof(saved));
+    read(&len, sizeof(len));
+    if (sectionWanted() && VL_UNLIKELY(saved != layout) && !m_partial) {
+        sectionFail("was made from different model");
+    }
+    if (!sectionWanted() || saved != layout) {
+        skipParts(len);
+        ++m_sectionsSkipped;
+        return false;
+    }
+    m_inSection = true;
+    ++m_sectionsRestored;
+    return true;
+}
+
+void VerilatedDeserialize::sectionSkip() VL_MT_UNSAFE_ONE {
+    vluint64_t saved;
+    vluint64_t len;
+    read(&saved, sizeof(saved));
+    read(&len, sizeof(len));
+    if (VL_UNLIKELY(sectionWanted() && !m_partial)) sectionFail("is not in model");
+    skipParts(len);
+    ++m_sectionsSkipped;
+}
+
+void VerilatedDeserialize::sectionEnd() VL_MT_UNSAFE_ONE {
+    vluint64_t len;
+    read(&len, sizeof(len));
+    if (VL_UNLIKELY(len != VLTSAVE_SECTION_END)) sectionFail("is corrupt");
+    m_inSection = false;
+}
+
+void VerilatedDeserialize::sectionFail(const char* whyp) VL_MT_UNSAFE_ONE {
+    if (!isOpen()) return;  // Already reported
+    std::string fn = filename();
+    std::string msg = "Can't deserialize save-restore file as scope '" + m_sectionName + "' "
+                      + whyp + ": " + filename();
+    VL_FATAL_MT(fn.c_str(), 0, "", msg.c_str());
+    close();
+}
+
+void VerilatedDeserialize::skipParts(vluint64_t len) VL_MT_UNSAFE_ONE {
+    // Empty parts are never adjacent, so two in a row are past the end of file
+    bool wasEmpty = false;
+    while (len != VLTSAVE_SECTION_END && isOpen()) {
+        if (VL_UNLIKELY(!len && wasEmpty)) {
+            sectionFail("is corrupt");
+            return;
+        }
+        wasEmpty = !len;
+        skip(len);
+        read(&len, sizeof(len));
+    }
+}
+
+void VerilatedDeserialize::skip(vluint64_t size) VL_MT_UNSAFE_ONE {
+    while (size) {
+        bufferCheck();
+        size_t blk = bufferInsertSize();
+        if (blk > size) blk = static_cast<size_t>(size);
+        m_cp += blk;
+        size -= blk;
+    }
+}
+
 //=============================================================================
 //=============================================================================
 //=============================================================================
@@ -121,6 +838,7 @@ void VerilatedDeserialize::trailer() VL_MT_UNSAFE_ONE {
 void VerilatedSave::open(const char* filenamep) VL_MT_UNSAFE_ONE {
     m_assertOne.check();
     if (isOpen()) return;
+    wait();  // For any earlier background write
     VL_DEBUG_IF(VL_DBG_MSGF("- save: opening save file %s\n", filenamep););
 
     if (filenamep[0] == '|') {
@@ -134,10 +852,16 @@ void VerilatedSave::open(const char* filenamep) VL_MT_UNSAFE_ONE {
             m_isOpen = false;
             return;
         }
+        // Delta checkpoints are not compressed, as restoring them seeks
+        const bool compress = m_compress && !m_deltap;
+        if (compress || m_async) m_writerp = new VerilatedSaveWriter(m_fd, compress, m_async);
     }
     m_isOpen = true;
     m_filename = filenamep;
     m_cp = m_bufp;
+    m_partp = NULL;
+    m_flushed = 0;
+    if (VerilatedLiveStats* const livep = Verilated::liveStatsp()) livep->checkpointBegin();
     header();
 }
 
@@ -156,20 +880,96 @@ void VerilatedRestore::open(const char* filenamep) VL_MT_UNSAFE_ONE {
             m_isOpen = false;
             return;
         }
+        char magic[16];
+        const bool gotMagic = vlSaveReadAt(m_fd, 0, magic, sizeof(magic));
+        if (gotMagic && !memcmp(magic, VLTSAVE_LZ4_STR, sizeof(magic))) {
+            m_lz4p = new VerilatedRestoreLz4;  // Blocks follow the signature
+        } else if (gotMagic && !memcmp(magic, VLTSAVE_DELTA_STR, sizeof(magic))) {
+            // A delta checkpoint is read back along with its parents
+            ::close(m_fd);
+            m_fd = -1;
+            m_chainp = new VerilatedRestoreChain;
+            if (!m_chainp->open(filenamep)) {
+                std::string msg = m_chainp->error();
+                VL_DO_CLEAR(delete m_chainp, m_chainp = NULL);
+                VL_FATAL_MT(filenamep, 0, "", msg.c_str());
+                m_isOpen = false;
+                return;
+            }
+        } else {
+            ::lseek(m_fd, 0, SEEK_SET);
+        }
     }
     m_isOpen = true;
     m_filename = filenamep;
     m_cp = m_bufp;
     m_endp = m_bufp;
+    m_bufOffset = 0;
+    m_inSection = false;
     header();
 }
 
+void VerilatedSave::openDelta(const char* filenamep, const char* parentp) VL_MT_UNSAFE_ONE {
+    m_assertOne.check();
+    if (isOpen()) return;
+    wait();  // The parent may be an earlier background write
+    const std::string parent = parentp ? parentp : "";
+    std::vector<vluint64_t> parentHashes;
+    if (!parent.empty() && !vlSaveReadHashes(parent.c_str(), parentHashes)) {
+        std::string msg
+            = "Can't open delta checkpoint parent, or it was not made with openDelta(): "
+              + parent;
+        VL_FATAL_MT(filenamep, 0, "", msg.c_str());
+        return;
+    }
+    // Create the delta state before open() so the header is paged
+    m_deltap = new VerilatedSaveDelta;
+    m_deltap->m_parentHashes.swap(parentHashes);
+    const vluint64_t parentLen = parent.size();
+    m_deltap->out(VLTSAVE_DELTA_STR, strlen(VLTSAVE_DELTA_STR));
+    m_deltap->out(&parentLen, sizeof(parentLen));
+    m_deltap->out(parent.data(), parent.size());
+    open(filenamep);
+    if (!isOpen()) VL_DO_CLEAR(delete m_deltap, m_deltap = NULL);
+}
+
 void VerilatedSave::close() VL_MT_UNSAFE_ONE {
     if (!isOpen()) return;
     trailer();
     flush();
+    if (m_deltap) {
+        VerilatedSaveDelta& delta = *m_deltap;
+        writeDeltaPage();  // Last, partial page
+        delta.out(&VLTSAVE_DELTA_LAST, sizeof(VLTSAVE_DELTA_LAST));
+        const vluint64_t hashOffset = delta.m_fileBytes;
+        if (!delta.m_hashes.empty()) delta.out(&delta.m_hashes[0], delta.m_hashes.size() * 8);
+        delta.out(&delta.m_imageBytes, sizeof(delta.m_imageBytes));
+        delta.out(&hashOffset, sizeof(hashOffset));
+        delta.out(VLTSAVE_DELTA_END_STR, strlen(VLTSAVE_DELTA_END_STR));
+        writeFd(&delta.m_out[0], delta.m_out.size());
+        VL_DO_CLEAR(delete m_deltap, m_deltap = NULL);
+    }
     m_isOpen = false;
-    ::close(m_fd);  // May get error, just ignore it
+    if (VerilatedLiveStats* const livep = Verilated::liveStatsp()) {
+        livep->checkpointEnd(m_flushed, m_writerp && m_writerp->async());
+    }
+    if (m_writerp) {
+        m_writerp->close();  // Finished by wait()
+    } else {
+        ::close(m_fd);  // May get error, just ignore it
+    }
+}
+
+void VerilatedSave::wait() VL_MT_UNSAFE_ONE {
+    m_assertOne.check();
+    if (!m_writerp) return;
+    const int err = m_writerp->wait();
+    VL_DO_CLEAR(delete m_writerp, m_writerp = NULL);
+    if (VL_UNLIKELY(err)) {
+        // write failed, presume error (perhaps out of disk space)
+        std::string msg = "Can't write save-restore file: " + m_filename + ": " + strerror(err);
+        VL_FATAL_MT(m_filename.c_str(), 0, "", msg.c_str());
+    }
 }
 
 void VerilatedRestore::close() VL_MT_UNSAFE_ONE {
@@ -177,7 +977,12 @@ void VerilatedRestore::close() VL_MT_UNSAFE_ONE {
     trailer();
     flush();
     m_isOpen = false;
-    ::close(m_fd);  // May get error, just ignore it
+    if (m_chainp) {
+        VL_DO_CLEAR(delete m_chainp, m_chainp = NULL);
+    } else {
+        if (m_lz4p) VL_DO_CLEAR(delete m_lz4p, m_lz4p = NULL);
+        ::close(m_fd);  // May get error, just ignore it
+    }
 }
 
 //=============================================================================
@@ -186,35 +991,85 @@ void VerilatedRestore::close() VL_MT_UNSAFE_ONE {
 void VerilatedSave::flush() VL_MT_UNSAFE_ONE {
     m_assertOne.check();
     if (VL_UNLIKELY(!isOpen())) return;
-    vluint8_t* wp = m_bufp;
-    while (true) {
-        ssize_t remaining = (m_cp - wp);
-        if (remaining == 0) break;
-        errno = 0;
-        ssize_t got = ::write(m_fd, wp, remaining);
-        if (got > 0) {
-            wp += got;
-        } else if (got < 0) {
-            if (errno != EAGAIN && errno != EINTR) {
-                // write failed, presume error (perhaps out of disk space)
-                std::string msg = std::string(__FUNCTION__) + ": " + strerror(errno);
-                VL_FATAL_MT("", 0, "", msg.c_str());
-                close();
-                break;
-            }
-        }
+    if (m_deltap) {
+        writeDelta(m_bufp, m_cp - m_bufp);
+    } else {
+        writeFd(m_bufp, m_cp - m_bufp);
     }
+    m_flushed += m_cp - m_bufp;
     m_cp = m_bufp;  // Reset buffer
 }
 
+void VerilatedSave::writeDelta(const vluint8_t* datap, size_t size) VL_MT_UNSAFE_ONE {
+    VerilatedSaveDelta& delta = *m_deltap;
+    while (size) {
+        const size_t blk = std::min(size, VLTSAVE_DELTA_PAGE - delta.m_pageUsed);
+        memcpy(&delta.m_page[delta.m_pageUsed], datap, blk);
+        delta.m_pageUsed += blk;
+        datap += blk;
+        size -= blk;
+        if (delta.m_pageUsed == VLTSAVE_DELTA_PAGE) writeDeltaPage();
+    }
+}
+
+void VerilatedSave::writeDeltaPage() VL_MT_UNSAFE_ONE {
+    // Write the assembled page, if differs from the parent's page
+    VerilatedSaveDelta& delta = *m_deltap;
+    if (!delta.m_pageUsed) return;
+    const vluint64_t index = delta.m_hashes.size();
+    const vluint64_t hash = vlSaveHash(&delta.m_page[0], delta.m_pageUsed);
+    delta.m_hashes.push_back(hash);
+    if (index >= delta.m_parentHashes.size() || delta.m_parentHashes[index] != hash) {
+        delta.out(&index, sizeof(index));
+        delta.out(&delta.m_page[0], delta.m_pageUsed);
+        if (delta.m_out.size() >= bufferSize()) {
+            writeFd(&delta.m_out[0], delta.m_out.size());
+            delta.m_out.clear();
+        }
+    }
+    delta.m_imageBytes += delta.m_pageUsed;
+    delta.m_pageUsed = 0;
+}
+
+void VerilatedSave::writeFd(const void* datap, size_t size) VL_MT_UNSAFE_ONE {
+    const int err = m_writerp ? m_writerp->write(datap, size) : vlSaveWrite(m_fd, datap, size);
+    if (VL_UNLIKELY(err)) {
+        // write failed, presume error (perhaps out of disk space)
+        std::string msg = std::string(__FUNCTION__) + ": " + strerror(err);
+        VL_FATAL_MT("", 0, "", msg.c_str());
+        close();
+    }
+}
+
 void VerilatedRestore::fill() VL_MT_UNSAFE_ONE {
     m_assertOne.check();
     if (VL_UNLIKELY(!isOpen())) return;
     // Move remaining characters down to start of buffer.  (No memcpy, overlaps allowed)
     vluint8_t* rp = m_bufp;
     for (vluint8_t* sp = m_cp; sp < m_endp; *rp++ = *sp++) {}  // Overlaps
+    m_bufOffset += m_cp - m_bufp;
     m_endp = m_bufp + (m_endp - m_cp);
     m_cp = m_bufp;  // Reset buffer
+    if (m_chainp || m_lz4p) {
+        // Read whole pages from the delta checkpoint chain, or whole
+        // blocks from the compressed file
+        const size_t blockSize = m_chainp ? VLTSAVE_DELTA_PAGE : VLTSAVE_LZ4_BLOCK;
+        size_t got = 1;
+        while (got && m_endp + blockSize <= m_bufp + bufferSize()) {
+            got = m_chainp ? m_chainp->readPage(m_endp)
+                           : m_lz4p->readBlock(m_fd, m_filename, m_endp);
+            m_endp += got;
+        }
+        const std::string& error = m_chainp ? m_chainp->error() : m_lz4p->error();
+        if (VL_UNLIKELY(!error.empty())) {
+            std::string msg = error;
+            VL_FATAL_MT(filename().c_str(), 0, "", msg.c_str());
+            close();
+        } else if (!got) {  // EOF, see below
+            while (m_endp < m_bufp + bufferSize()) *m_endp++ = '\0';
+        }
+        return;
+    }
     // Read into buffer starting at m_endp
     while (true) {
         ssize_t remaining = (m_bufp + bufferSize() - m_endp);
@@ -240,5 +1095,99 @@ void VerilatedRestore::fill() VL_MT_UNSAFE_ONE {
     }
 }
 
+//=============================================================================
+// Aligned arrays
+
+VerilatedSerialize& VerilatedSave::writeAligned(const void* datap,
+                                                size_t size) VL_MT_UNSAFE_ONE {
+    if (size < VLTSAVE_ALIGN_MIN) return write(datap, size);
+    static const vluint8_t s_zeros[VLTSAVE_ALIGN] = {};
+    // In a section the array is a part to itself, after its length
+    const bool inSection = m_partp;
+    partClose();
+    // Offset the array will be at, after the pad size
+    const vluint64_t offset = m_flushed + (m_cp - m_bufp) + sizeof(vluint64_t) * (1 + inSection);
+    const vluint64_t misalign = reinterpret_cast<uintptr_t>(datap) % VLTSAVE_ALIGN;
+    vluint64_t pad = (misalign + VLTSAVE_ALIGN - offset % VLTSAVE_ALIGN) % VLTSAVE_ALIGN;
+    if (inSection) {
+        const vluint64_t len = sizeof(pad) + pad + size;
+        write(&len, sizeof(len));
+    }
+    write(&pad, sizeof(pad));
+    write(s_zeros, pad);
+    write(datap, size);
+    if (inSection) partOpen();
+    return *this;
+}
+
+VerilatedDeserialize& VerilatedRestore::readAligned(void* datap, size_t size) VL_MT_UNSAFE_ONE {
+    if (size < VLTSAVE_ALIGN_MIN) return read(datap, size);
+    vluint64_t len;
+    if (m_inSection) read(&len, sizeof(len));  // Array's part, see writeAligned
+    vluint64_t pad;
+    read(&pad, sizeof(pad));
+    if (VL_UNLIKELY(pad >= VLTSAVE_ALIGN)) {
+        std::string fn = filename();
+        std::string msg = "Can't deserialize; array alignment is corrupt: " + filename();
+        VL_FATAL_MT(fn.c_str(), 0, "", msg.c_str());
+        close();
+        return *this;
+    }
+    vluint8_t zeros[VLTSAVE_ALIGN];
+    read(zeros, pad);
+    if (!mapAligned(datap, size)) read(datap, size);
+    if (m_inSection) read(&len, sizeof(len));  // Next part
+    return *this;
+}
+
+bool VerilatedRestore::mapAligned(void* datap, size_t size) VL_MT_UNSAFE_ONE {
+    // Map the whole pages of the array from the file, reading the partial
+    // pages at each end.  Returns false, having read nothing, if can't.
+#ifdef VL_SAVE_MMAP
+    if (m_chainp || m_lz4p || !isOpen()) return false;  // Saved data offsets aren't in file
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    struct stat st;
+    if (fstat(m_fd, &st) || !S_ISREG(st.st_mode)) return false;
+    // Offset in the file of the array, must not extend past EOF
+    const vluint64_t offset = m_bufOffset + (m_cp - m_bufp);
+    if (offset + size > static_cast<vluint64_t>(st.st_size)) return false;
+    vluint8_t* const dp = static_cast<vluint8_t*>(datap);
+    const size_t head = (page - reinterpret_cast<uintptr_t>(dp) % page) % page;
+    if ((offset + head) % page || head >= size) return false;
+    const size_t mapped = (size - head) / page * page;
+    if (!mapped) return false;
+
+    read(dp, head);
+    void* const mapp = mmap(dp + head, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+                            m_fd, static_cast<off_t>(offset + head));
+    if (VL_UNLIKELY(mapp == MAP_FAILED)) {
+        read(dp + head, size - head);
+        return true;
+    }
+    skip(mapped);
+    read(dp + head + mapped, size - head - mapped);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void VerilatedRestore::skip(vluint64_t size) VL_MT_UNSAFE_ONE {
+    // Skip data in the buffer, or seek the file past data not yet read
+    if (static_cast<vluint64_t>(m_endp - m_cp) >= size) {
+        m_cp += size;
+        return;
+    }
+    if (!m_chainp && !m_lz4p) {
+        const vluint64_t offset = m_bufOffset + (m_cp - m_bufp) + size;
+        if (::lseek(m_fd, static_cast<off_t>(offset), SEEK_SET) == static_cast<off_t>(offset)) {
+            m_bufOffset = offset;
+            m_cp = m_endp = m_bufp;
+            return;
+        }
+    }
+    VerilatedDeserialize::skip(size);  // Pipe, delta chain or compressed
+}
+
 //=============================================================================
 // Serialization of types
@@ -22,8 +22,14 @@
 #include "verilatedos.h"
 #include "verilated_heavy.h"
 
+#include <cstring>
 #include <string>
 
+class VerilatedSaveDelta;
+class VerilatedSaveWriter;
+class VerilatedRestoreChain;
+class VerilatedRestoreLz4;
+
 //=============================================================================
 // VerilatedSerialize - convert structures to a stream representation
 // This class is not thread safe, it must be called by a single thread
@@ -34,6 +40,8 @@ protected:
     // For speed, keep m_cp as the first member of this structure
     vluint8_t* m_cp;  ///< Current pointer into m_bufp buffer
     vluint8_t* m_bufp;  ///< Output buffer
+    size_t m_bufSize;  ///< Size of m_bufp, grows to hold a section part
+    vluint8_t* m_partp;  ///< Length of the open section part in m_bufp, or NULL
     bool m_isOpen;  ///< True indicates open file/stream
     std::string m_filename;  ///< Filename, for error messages
     VerilatedAssertOneThread m_assertOne;  ///< Assert only called from single thread
@@ -43,6 +51,8 @@ protected:
 
     void header() VL_MT_UNSAFE_ONE;
     void trailer() VL_MT_UNSAFE_ONE;
+    void partOpen() VL_MT_UNSAFE_ONE;
+    void partClose() VL_MT_UNSAFE_ONE;
 
     // CONSTRUCTORS
     VL_UNCOPYABLE(VerilatedSerialize);
@@ -50,12 +60,14 @@ protected:
 public:
     VerilatedSerialize() {
         m_isOpen = false;
-        m_bufp = new vluint8_t[bufferSize()];
+        m_bufSize = bufferSize();
+        m_bufp = new vluint8_t[m_bufSize];
         m_cp = m_bufp;
+        m_partp = NULL;
     }
     virtual ~VerilatedSerialize() {
         close();
-        if (m_bufp) VL_DO_CLEAR(delete m_bufp, m_bufp = NULL);
+        if (m_bufp) VL_DO_CLEAR(delete[] m_bufp, m_bufp = NULL);
     }
     // METHODS
     bool isOpen() const { return m_isOpen; }
@@ -68,18 +80,40 @@ public:
             bufferCheck();
             size_t blk = size;
             if (blk > bufferInsertSize()) blk = bufferInsertSize();
-            const vluint8_t* __restrict maxp = dp + blk;
-            for (; dp < maxp; *m_cp++ = *dp++) {}
+            memcpy(m_cp, dp, blk);
+            m_cp += blk;
+            dp += blk;
             size -= blk;
         }
         return *this;  // For function chaining
     }
+    /// Write an array in the layout it has in memory; VerilatedSave places
+    /// large arrays so VerilatedRestore may map them from the file
+    virtual VerilatedSerialize& writeAligned(const void* datap, size_t size) VL_MT_UNSAFE_ONE {
+        return write(datap, size);
+    }
+
+    // Internal: Sections framing the state of each scope of a model, written
+    // by the generated code.  Each section is the scope's name, a hash of
+    // its variables, then parts, each a length and data, and an end marker.
+    // The lengths let VerilatedDeserialize skip sections it doesn't need.
+    void scopesBegin() VL_MT_UNSAFE_ONE;
+    void scopesEnd() VL_MT_UNSAFE_ONE;
+    void sectionBegin(const char* namep, vluint64_t layout) VL_MT_UNSAFE_ONE;
+    void sectionEnd() VL_MT_UNSAFE_ONE;
 
 private:
+    void bufferHold() VL_MT_UNSAFE_ONE;
     VerilatedSerialize& bufferCheck() VL_MT_UNSAFE_ONE {
         // Flush the write buffer if there's not enough space left for new information
         // We only call this once per vector, so we need enough slop for a very wide "b###" line
-        if (VL_UNLIKELY(m_cp > (m_bufp + (bufferSize() - bufferInsertSize())))) flush();
+        if (VL_UNLIKELY(m_cp > (m_bufp + (m_bufSize - bufferInsertSize())))) {
+            if (m_partp) {
+                bufferHold();
+            } else {
+                flush();
+            }
+        }
         return *this;  // For function chaining
     }
 };
@@ -96,6 +130,12 @@ protected:
     vluint8_t* m_bufp;  ///< Output buffer
     vluint8_t* m_endp;  ///< Last valid byte in m_bufp buffer
     bool m_isOpen;  ///< True indicates open file/stream
+    bool m_inSection;  ///< Reading a section, see sectionLayout()
+    bool m_partial;  ///< Skip sections not matching the model, see partial()
+    size_t m_sectionsRestored;  ///< Sections restored since scopesBegin()
+    size_t m_sectionsSkipped;  ///< Sections skipped since scopesBegin()
+    std::string m_sectionName;  ///< Name of the section being read
+    std::string m_scopePrefix;  ///< Only restore scopes under this, see scopePrefix()
     std::string m_filename;  ///< Filename, for error messages
     VerilatedAssertOneThread m_assertOne;  ///< Assert only called from single thread
 
@@ -105,6 +145,8 @@ protected:
     virtual void fill() = 0;
     void header() VL_MT_UNSAFE_ONE;
     void trailer() VL_MT_UNSAFE_ONE;
+    /// Skip over saved data; VerilatedRestore seeks where it can
+    virtual void skip(vluint64_t size) VL_MT_UNSAFE_ONE;
 
     // CONSTRUCTORS
     VL_UNCOPYABLE(VerilatedDeserialize);
@@ -115,10 +157,14 @@ public:
         m_bufp = new vluint8_t[bufferSize()];
         m_cp = m_bufp;
         m_endp = NULL;
+        m_inSection = false;
+        m_partial = false;
+        m_sectionsRestored = 0;
+        m_sectionsSkipped = 0;
     }
     virtual ~VerilatedDeserialize() {
         close();
-        if (m_bufp) VL_DO_CLEAR(delete m_bufp, m_bufp = NULL);
+        if (m_bufp) VL_DO_CLEAR(delete[] m_bufp, m_bufp = NULL);
     }
     // METHODS
     bool isOpen() const { return m_isOpen; }
@@ -131,20 +177,50 @@ public:
             bufferCheck();
             size_t blk = size;
             if (blk > bufferInsertSize()) blk = bufferInsertSize();
-            const vluint8_t* __restrict maxp = dp + blk;
-            for (; dp < maxp; *dp++ = *m_cp++) {}
+            memcpy(dp, m_cp, blk);
+            m_cp += blk;
+            dp += blk;
             size -= blk;
         }
         return *this;  // For function chaining
     }
+    /// Read an array written by writeAligned()
+    virtual VerilatedDeserialize& readAligned(void* datap, size_t size) VL_MT_UNSAFE_ONE {
+        return read(datap, size);
+    }
     // Read a datum and compare with expected value
     VerilatedDeserialize& readAssert(const void* __restrict datap, size_t size) VL_MT_UNSAFE_ONE;
     VerilatedDeserialize& readAssert(vluint64_t data) VL_MT_UNSAFE_ONE {
         return readAssert(&data, sizeof(data));
     }
 
+    /// Restore models saved from a different version of the model: scopes
+    /// whose variables differ, or that are only in the model or the file,
+    /// are left unchanged rather than failing the restore
+    void partial(bool flag) VL_MT_UNSAFE_ONE { m_partial = flag; }
+    /// Restore only the scopes at and below the given hierarchical name,
+    /// e.g. "t.sub", leaving other scopes unchanged; empty to restore all.
+    /// The top module's own variables are scope "TOP"
+    void scopePrefix(const std::string& prefix) VL_MT_UNSAFE_ONE { m_scopePrefix = prefix; }
+    /// Number of scopes skipped when the last model was restored
+    size_t sectionsSkipped() const { return m_sectionsSkipped; }
+
+    // Internal: Sections written by VerilatedSerialize::sectionBegin()
+    void scopesBegin() VL_MT_UNSAFE_ONE;
+    void scopesEnd(size_t modelScopes) VL_MT_UNSAFE_ONE;
+    /// Name of the next section, or NULL after the last
+    const char* sectionNext() VL_MT_UNSAFE_ONE;
+    /// Start reading the section, or skip it returning false
+    bool sectionLayout(vluint64_t layout) VL_MT_UNSAFE_ONE;
+    /// Skip the section, which has no scope in the model
+    void sectionSkip() VL_MT_UNSAFE_ONE;
+    void sectionEnd() VL_MT_UNSAFE_ONE;
+
 private:
     bool readDiffers(const void* __restrict datap, size_t size) VL_MT_UNSAFE_ONE;
+    bool sectionWanted() const;
+    void sectionFail(const char* whyp) VL_MT_UNSAFE_ONE;
+    void skipParts(vluint64_t len) VL_MT_UNSAFE_ONE;
     VerilatedDeserialize& bufferCheck() VL_MT_UNSAFE_ONE {
         // Flush the write buffer if there's not enough space left for new information
         // We only call this once per vector, so we need enough slop for a very wide "b###" line
@@ -160,18 +236,56 @@ private:
 class VerilatedSave : public VerilatedSerialize {
 private:
     int m_fd;  ///< File descriptor we're writing to
+    VerilatedSaveDelta* m_deltap;  ///< Delta checkpoint state, if openDelta()
+    VerilatedSaveWriter* m_writerp;  ///< Compressing or background writer, if any
+    bool m_compress;  ///< Compress the next file opened
+    bool m_async;  ///< Write the next file opened from a background thread
+    vluint64_t m_flushed;  ///< Bytes of saved data flushed from m_bufp
+
+    void writeFd(const void* datap, size_t size) VL_MT_UNSAFE_ONE;
+    void writeDelta(const vluint8_t* datap, size_t size) VL_MT_UNSAFE_ONE;
+    void writeDeltaPage() VL_MT_UNSAFE_ONE;
 
 public:
     // CONSTRUCTORS
     VerilatedSave()
-        : m_fd(-1) {}
-    virtual ~VerilatedSave() VL_OVERRIDE { close(); }
+        : m_fd(-1)
+        , m_deltap(NULL)
+        , m_writerp(NULL)
+        , m_compress(false)
+        , m_async(false)
+        , m_flushed(0) {}
+    virtual ~VerilatedSave() VL_OVERRIDE {
+        close();
+        wait();
+    }
     // METHODS
     /// Open the file; call isOpen() to see if errors
     void open(const char* filenamep) VL_MT_UNSAFE_ONE;
     void open(const std::string& filename) VL_MT_UNSAFE_ONE { open(filename.c_str()); }
+    /// Open a delta checkpoint file, which holds only the pages of saved
+    /// data that differ from the parent checkpoint, and a reference to the
+    /// parent.  The parent must also have been made with openDelta(); with
+    /// an empty parent name a new chain is started and all data is saved.
+    /// VerilatedRestore reads a delta file back with the rest of its chain.
+    void openDelta(const char* filenamep, const char* parentp) VL_MT_UNSAFE_ONE;
+    void openDelta(const std::string& filename, const std::string& parent) VL_MT_UNSAFE_ONE {
+        openDelta(filename.c_str(), parent.c_str());
+    }
     virtual void close() VL_OVERRIDE VL_MT_UNSAFE_ONE;
     virtual void flush() VL_OVERRIDE VL_MT_UNSAFE_ONE;
+    /// Compress files opened after this with LZ4; ignored by openDelta()
+    void compress(bool flag) VL_MT_UNSAFE_ONE { m_compress = flag; }
+    /// Compress and write files opened after this from a background
+    /// thread, which holds a copy of the saved data.  close() then returns
+    /// before the file is complete; it is finished by wait(), the next
+    /// open(), or destroying this object.  Requires VL_THREADED, else
+    /// files are written without a thread
+    void async(bool flag) VL_MT_UNSAFE_ONE { m_async = flag; }
+    /// Wait for a background write to complete
+    void wait() VL_MT_UNSAFE_ONE;
+    virtual VerilatedSerialize& writeAligned(const void* datap,
+                                             size_t size) VL_OVERRIDE VL_MT_UNSAFE_ONE;
 };
 
 //=============================================================================
@@ -181,20 +295,35 @@ public:
 class VerilatedRestore : public VerilatedDeserialize {
 private:
     int m_fd;  ///< File descriptor we're writing to
+    VerilatedRestoreChain* m_chainp;  ///< Delta checkpoint chain, if restoring a delta
+    VerilatedRestoreLz4* m_lz4p;  ///< Decompression state, if restoring a compressed file
+    vluint64_t m_bufOffset;  ///< Offset in saved data of m_bufp
+
+    bool mapAligned(void* datap, size_t size) VL_MT_UNSAFE_ONE;
+    virtual void skip(vluint64_t size) VL_OVERRIDE VL_MT_UNSAFE_ONE;
 
 public:
     // CONSTRUCTORS
     VerilatedRestore()
-        : m_fd(-1) {}
+        : m_fd(-1)
+        , m_chainp(NULL)
+        , m_lz4p(NULL)
+        , m_bufOffset(0) {}
     virtual ~VerilatedRestore() VL_OVERRIDE { close(); }
 
     // METHODS
-    /// Open the file; call isOpen() to see if errors
+    /// Open the file, which may be from open() or openDelta(), and may be
+    /// compressed; call isOpen() to see if errors
     void open(const char* filenamep) VL_MT_UNSAFE_ONE;
     void open(const std::string& filename) VL_MT_UNSAFE_ONE { open(filename.c_str()); }
     virtual void close() VL_OVERRIDE VL_MT_UNSAFE_ONE;
     virtual void flush() VL_OVERRIDE VL_MT_UNSAFE_ONE {}
     virtual void fill() VL_OVERRIDE VL_MT_UNSAFE_ONE;
+    /// Read an array, mapping its whole pages from the file where possible.
+    /// Mapped pages are copy-on-write, so the file must not be changed while
+    /// the model exists.
+    virtual VerilatedDeserialize& readAligned(void* datap,
+                                              size_t size) VL_OVERRIDE VL_MT_UNSAFE_ONE;
 };
 
 //=============================================================================
@@ -281,4 +410,75 @@ VerilatedDeserialize& operator>>(VerilatedDeserialize& os, VlAssocArray<T_Key, T
     return os;
 }
 
+template <class T_Key, class T_Value>
+VerilatedSerialize& operator<<(VerilatedSerialize& os, VlAssocHashArray<T_Key, T_Value>& rhs) {
+    os << rhs.atDefault();
+    vluint32_t len = rhs.size();
+    os << len;
+    for (typename VlAssocHashArray<T_Key, T_Value>::const_iterator it = rhs.begin();
+         it != rhs.end(); ++it) {
+        T_Key index = it->first;  // Copy to get around const_iterator
+        T_Value value = it->second;
+        os << index << value;
+    }
+    return os;
+}
+template <class T_Key, class T_Value>
+VerilatedDeserialize& operator>>(VerilatedDeserialize& os,
+                                 VlAssocHashArray<T_Key, T_Value>& rhs) {
+    os >> rhs.atDefault();
+    vluint32_t len = 0;
+    os >> len;
+    rhs.clear();
+    for (vluint32_t i = 0; i < len; ++i) {
+        T_Key index;
+        T_Value value;
+        os >> index;
+        os >> value;
+        rhs.at(index) = value;
+    }
+    return os;
+}
+
+// Sparse arrays save only pages holding non-zero rows, each as its
+// offset then contents, ending with an all-ones offset.  Arrays reset to
+// ones or random values instead save the pages that have been touched, as
+// the others are refilled with the same values after restore.
+template <class T_Value, size_t T_Depth>
+VerilatedSerialize& operator<<(VerilatedSerialize& os, VlSparseArray<T_Value, T_Depth>& rhs) {
+    const vluint8_t* datap = reinterpret_cast<const vluint8_t*>(rhs.data());
+    const size_t bytes = rhs.bytes();
+    for (size_t off = 0; off < bytes; off += VL_SPARSE_PAGE_BYTES) {
+        const size_t len = std::min<size_t>(VL_SPARSE_PAGE_BYTES, bytes - off);
+        const vluint8_t* pagep = datap + off;
+        const int filled = VL_SPARSE_PAGE_FILLED(datap, off);
+        if (filled == 0) continue;
+        if (filled < 0) {
+            size_t i = 0;
+            while (i < len && !pagep[i]) ++i;
+            if (i == len) continue;
+        }
+        vluint64_t offset = off;
+        os << offset;
+        os.write(pagep, len);
+    }
+    vluint64_t endOffset = ~VL_ULL(0);
+    return os << endOffset;
+}
+template <class T_Value, size_t T_Depth>
+VerilatedDeserialize& operator>>(VerilatedDeserialize& os,
+                                 VlSparseArray<T_Value, T_Depth>& rhs) {
+    vluint8_t* datap = reinterpret_cast<vluint8_t*>(rhs.data());
+    const size_t bytes = rhs.bytes();
+    rhs.clear();
+    while (true) {
+        vluint64_t offset = 0;
+        os >> offset;
+        if (offset >= bytes) break;
+        os.read(datap + offset,
+                std::min<size_t>(VL_SPARSE_PAGE_BYTES, bytes - static_cast<size_t>(offset)));
+    }
+    return os;
+}
+
 #endif  // Guard
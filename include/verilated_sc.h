@@ -34,11 +34,15 @@
 // This class is thread safe (though most of SystemC is not).
 
 #define VL_SC_BV_DATAP(bv) (VlScBvExposer::sp_datap(bv))
+#define VL_SC_BV_DATAP_W(bv) (VlScBvExposer::sp_datap_w(bv))
 class VlScBvExposer : public sc_bv_base {
 public:
     static const vluint32_t* sp_datap(const sc_bv_base& base) VL_MT_SAFE {
         return static_cast<const VlScBvExposer*>(&base)->sp_datatp();
     }
+    static vluint32_t* sp_datap_w(sc_bv_base& base) VL_MT_SAFE {
+        return reinterpret_cast<vluint32_t*>(static_cast<VlScBvExposer*>(&base)->m_data);
+    }
     const vluint32_t* sp_datatp() const { return reinterpret_cast<vluint32_t*>(m_data); }
     // Above reads this protected element in sc_bv_base:
     //   sc_digit* m_data; // data array
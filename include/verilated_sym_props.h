@@ -217,6 +217,7 @@ public:
     int high(int dim) const { return m_propsp->high(dim); }
     int increment(int dim) const { return m_propsp->increment(dim); }
     int elements(int dim) const { return m_propsp->elements(dim); }
+    vluint32_t entSize() const { return m_propsp->entSize(); }
     size_t totalSize() const { return m_propsp->totalSize(); }
     void* datapAdjustIndex(void* datap, int dim, int indx) const {
         return m_propsp->datapAdjustIndex(datap, dim, indx);
@@ -231,6 +232,7 @@ class VerilatedVar : public VerilatedVarProps {
     // MEMBERS
     void* m_datap;  // Location of data
     const char* m_namep;  // Name - slowpath
+    vluint8_t* m_changep;  // Set by model when written, or NULL, see --vpi-change-hooks
 protected:
     friend class VerilatedScope;
     // CONSTRUCTORS
@@ -238,7 +240,8 @@ protected:
                  VerilatedVarFlags vlflags, int dims)
         : VerilatedVarProps(vltype, vlflags, (dims > 0 ? 1 : 0), ((dims > 1) ? dims - 1 : 0))
         , m_datap(datap)
-        , m_namep(namep) {}
+        , m_namep(namep)
+        , m_changep(NULL) {}
 
 public:
     ~VerilatedVar() {}
@@ -247,6 +250,8 @@ public:
     const VerilatedRange& range() const { return packed(); }  // Deprecated
     const VerilatedRange& array() const { return unpacked(); }  // Deprecated
     const char* name() const { return m_namep; }
+    /// Flag set when the model may have written the variable, or NULL if unknown
+    vluint8_t* changep() const { return m_changep; }
 };
 
 #endif  // Guard
@@ -16,12 +16,94 @@
 
 #include "verilatedos.h"
 #include "verilated_threads.h"
+#include "verilated_live.h"
 
 #include <cstdio>
+#include <cstring>
+
+// clang-format off
+#if defined(__linux)
+# include <linux/perf_event.h>  // For perf_event_attr
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+// clang-format on
 
 std::atomic<vluint64_t> VlMTaskVertex::s_yields;
+std::atomic<vluint64_t> VlMTaskVertex::s_parks;
+VlMTaskVertex::ParkBucket VlMTaskVertex::s_parkBuckets[VlMTaskVertex::PARK_BUCKETS];
 
 VL_THREAD_LOCAL VlThreadPool::ProfileTrace* VlThreadPool::t_profilep = NULL;
+VL_THREAD_LOCAL size_t VlThreadPool::t_profileNext = 0;
+VlThreadPool* VlThreadPool::s_modelPoolp = NULL;
+VL_THREAD_LOCAL VlThreadPool::DynSlot* VlThreadPool::t_dynSlotp = NULL;
+VL_THREAD_LOCAL int VlProfileRec::t_counterFds[VlProfileRec::CNT__MAX] = {-1, -1, -1, -1};
+
+//=============================================================================
+// VlProfileRec
+
+bool VlProfileRec::countersOpen() {
+#if defined(__linux)
+    // Indexed by CounterE
+    static const vluint64_t configs[CNT__MAX]
+        = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+           PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < CNT__MAX; ++i) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.disabled = (i == 0);  // Leader starts the whole group below
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // This thread, any CPU; all in one group so read together
+        t_counterFds[i] = static_cast<int>(
+            syscall(__NR_perf_event_open, &attr, 0, -1, (i == 0 ? -1 : t_counterFds[0]), 0));
+        if (VL_UNLIKELY(t_counterFds[i] < 0)) {
+            countersClose();
+            static int warnedOnce = 0;
+            if (!warnedOnce++) {
+                VL_PRINTF_MT("%%Warning: +verilator+prof+threads+counters: Can't open hardware"
+                             " counters (see /proc/sys/kernel/perf_event_paranoid); ignored\n");
+            }
+            return false;
+        }
+    }
+    ioctl(t_counterFds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    static int warnedOnce = 0;
+    if (!warnedOnce++) {
+        VL_PRINTF_MT("%%Warning: +verilator+prof+threads+counters not supported on this "
+                     "platform; ignored\n");
+    }
+    return false;
+#endif
+}
+
+void VlProfileRec::countersClose() {
+#if defined(__linux)
+    for (int i = 0; i < CNT__MAX; ++i) {
+        if (t_counterFds[i] >= 0) close(t_counterFds[i]);
+        t_counterFds[i] = -1;
+    }
+#endif
+}
+
+void VlProfileRec::countersRead(vluint64_t* countsp) {
+    // PERF_FORMAT_GROUP layout: number of counters, then each value
+    vluint64_t buf[1 + CNT__MAX];
+#if defined(__linux)
+    if (VL_LIKELY(read(t_counterFds[0], buf, sizeof(buf)) == sizeof(buf))) {
+        for (int i = 0; i < CNT__MAX; ++i) countsp[i] = buf[1 + i];
+        return;
+    }
+#endif
+    for (int i = 0; i < CNT__MAX; ++i) countsp[i] = 0;
+}
 
 //=============================================================================
 // VlMTaskVertex
@@ -32,14 +114,36 @@ VlMTaskVertex::VlMTaskVertex(vluint32_t upstreamDepCount)
     assert(atomic_is_lock_free(&m_upstreamDepsDone));
 }
 
+void VlMTaskVertex::parkUntilDone(bool evenCycle) const {
+    ++s_parks;  // Statistics
+    ParkBucket& bucket = parkBucket();
+    VerilatedLockGuard lk(bucket.m_mutex);
+    // Register before the final check; signalUpstreamDone updates the count
+    // before checking m_waiters, so one side always sees the other.
+    bucket.m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    vluint32_t target = evenCycle ? m_upstreamDepCount : 0;
+    while (m_upstreamDepsDone.load(std::memory_order_seq_cst) != target) bucket.m_cv.wait(lk);
+    bucket.m_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void VlMTaskVertex::unparkWaiters() const {
+    ParkBucket& bucket = parkBucket();
+    // Taking the lock ensures any waiter that missed our update is inside
+    // wait(), so sees the notify.  Other vertices share the bucket, hence
+    // notify_all; those waiters recheck and go back to sleep.
+    { VerilatedLockGuard lk(bucket.m_mutex); }
+    bucket.m_cv.notify_all();
+}
+
 //=============================================================================
 // VlWorkerThread
 
-VlWorkerThread::VlWorkerThread(VlThreadPool* poolp, bool profiling)
+VlWorkerThread::VlWorkerThread(VlThreadPool* poolp, bool profiling, int cpu, int index)
     : m_waiting(false)
-    , m_ready_size(0)
     , m_poolp(poolp)
     , m_profiling(profiling)
+    , m_cpu(cpu)
+    , m_index(index)
     , m_exiting(false)
     // Must init this last -- after setting up fields that it might read:
     , m_cthread(startWorker, this) {}
@@ -52,6 +156,26 @@ VlWorkerThread::~VlWorkerThread() {
 }
 
 void VlWorkerThread::workerLoop() {
+    Verilated::threadSlot(m_index + 1);  // 0 is the thread calling eval
+    if (m_cpu >= 0) {
+        // Pin before profiling setup, so our buffers are first touched,
+        // and so allocated, on our own CPU's memory node
+#if defined(__linux)
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(m_cpu, &cpuset);
+        if (VL_UNLIKELY(sched_setaffinity(0, sizeof(cpuset), &cpuset))) {
+            VL_PRINTF_MT("%%Warning: +verilator+threads+affinity: Can't pin thread to CPU %d\n",
+                         m_cpu);
+        }
+#else
+        static int warnedOnce = 0;
+        if (!warnedOnce++) {
+            VL_PRINTF_MT("%%Warning: +verilator+threads+affinity not supported on this "
+                         "platform; ignored\n");
+        }
+#endif
+    }
     if (VL_UNLIKELY(m_profiling)) m_poolp->setupProfilingClientThread();
 
     ExecRec work;
@@ -64,7 +188,17 @@ void VlWorkerThread::workerLoop() {
         if (VL_UNLIKELY(m_exiting.load(std::memory_order_acquire))) break;
 
         if (VL_LIKELY(work.m_fnp)) {
-            work.m_fnp(work.m_evenCycle, work.m_sym);
+            VerilatedLiveStats* const livep = Verilated::liveStatsp();
+            if (VL_UNLIKELY(livep)) {
+                vluint64_t startTicks;
+                vluint64_t endTicks;
+                VL_RDTSC(startTicks);
+                work.m_fnp(work.m_evenCycle, work.m_sym);
+                VL_RDTSC(endTicks);
+                livep->threadBusy(m_index, endTicks - startTicks);
+            } else {
+                work.m_fnp(work.m_evenCycle, work.m_sym);
+            }
             work.m_fnp = NULL;
         }
     }
@@ -78,37 +212,129 @@ void VlWorkerThread::startWorker(VlWorkerThread* workerp) { workerp->workerLoop(
 // VlThreadPool
 
 VlThreadPool::VlThreadPool(int nThreads, bool profiling)
-    : m_profiling(profiling) {
+    : m_profiling(profiling)
+    , m_dynActive(false)
+    , m_modelOwned(false)
+    , m_models(0) {
     // --threads N passes nThreads=N-1, as the "main" threads counts as 1
-    unsigned cpus = std::thread::hardware_concurrency();
-    if (cpus < nThreads + 1) {
+    unsigned hwCpus = std::thread::hardware_concurrency();
+    if (hwCpus < nThreads + 1) {
         static int warnedOnce = 0;
         if (!warnedOnce++) {
             VL_PRINTF_MT("%%Warning: System has %u CPUs but model Verilated with"
                          " --threads %d; may run slow.\n",
-                         cpus, nThreads + 1);
+                         hwCpus, nThreads + 1);
         }
     }
+    std::vector<int> cpus = parseCpuList(Verilated::threadsAffinity());
     // Create'em
     for (int i = 0; i < nThreads; ++i) {
-        m_workers.push_back(new VlWorkerThread(this, profiling));
+        int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        m_workers.push_back(new VlWorkerThread(this, profiling, cpu, i));
     }
     // Set up a profile buffer for the current thread too -- on the
     // assumption that it's the same thread that calls eval and may be
     // donated to run mtasks during the eval.
     if (VL_UNLIKELY(m_profiling)) setupProfilingClientThread();
+    Verilated::snapshotCbAdd(snapshotCb, this);
 }
 
 VlThreadPool::~VlThreadPool() {
+    Verilated::snapshotCbRemove(snapshotCb, this);
     for (int i = 0; i < m_workers.size(); ++i) {
         // Each ~WorkerThread will wait for its thread to exit.
         delete m_workers[i];
     }
+    for (int i = 0; i < m_dynSlots.size(); ++i) delete m_dynSlots[i];
     if (VL_UNLIKELY(m_profiling)) tearDownProfilingClientThread();
 }
 
+VlThreadPool* VlThreadPool::modelAttach(int nThreads, bool profiling) {
+    VlThreadPool* poolp = s_modelPoolp;
+    if (!poolp) {
+        poolp = new VlThreadPool(nThreads, profiling);
+        poolp->m_modelOwned = true;
+    } else {
+        // Each of the model's threads must be able to block independently
+        if (VL_UNLIKELY(poolp->numThreads() < nThreads)) {
+            VL_FATAL_MT(__FILE__, __LINE__, "",
+                        "Shared VlThreadPool has fewer threads than model Verilated --threads");
+        }
+        if (VL_UNLIKELY(profiling && !poolp->m_profiling)) {
+            VL_FATAL_MT(__FILE__, __LINE__, "",
+                        "Shared VlThreadPool must be profiling for model Verilated"
+                        " with --prof-threads");
+        }
+    }
+    poolp->m_models.fetch_add(1, std::memory_order_relaxed);
+    return poolp;
+}
+
+void VlThreadPool::modelDetach(VlThreadPool* poolp) {
+    if (poolp->m_models.fetch_sub(1, std::memory_order_relaxed) == 1 && poolp->m_modelOwned) {
+        delete poolp;
+    }
+}
+
+void VlThreadPool::snapshotCb(void* datap, bool after) {
+    // fork() copies only the calling thread, so the workers are stopped
+    // before it, and new ones started in the process continuing after it
+    VlThreadPool* poolp = static_cast<VlThreadPool*>(datap);
+    if (VL_UNLIKELY(poolp->m_profiling)) {
+        VL_FATAL_MT(__FILE__, __LINE__, "",
+                    "Verilated::snapshot is not supported with --prof-threads");
+    }
+    if (!after) {
+        poolp->m_snapCpus.clear();
+        for (int i = 0; i < poolp->m_workers.size(); ++i) {
+            poolp->m_snapCpus.push_back(poolp->m_workers[i]->cpu());
+            delete poolp->m_workers[i];
+        }
+        poolp->m_workers.clear();
+    } else {
+        for (int i = 0; i < poolp->m_snapCpus.size(); ++i) {
+            poolp->m_workers.push_back(
+                new VlWorkerThread(poolp, false, poolp->m_snapCpus[i], i));
+        }
+    }
+}
+
+std::vector<int> VlThreadPool::parseCpuList(const char* cpulistp) {
+    std::vector<int> cpus;
+    const char* cp = cpulistp;
+    while (*cp) {
+        char* endp;
+        long first = strtol(cp, &endp, 10);
+        long last = first;
+        if (endp != cp && *endp == '-') {
+            cp = endp + 1;
+            last = strtol(cp, &endp, 10);
+        }
+        if (endp == cp || first < 0 || last < first || (*endp && *endp != ',')) {
+            VL_PRINTF_MT("%%Warning: +verilator+threads+affinity: Bad CPU list '%s'; ignored\n",
+                         cpulistp);
+            cpus.clear();
+            break;
+        }
+#if defined(__linux)
+        // Larger CPU numbers don't fit in a cpu_set_t
+        if (last >= CPU_SETSIZE) {
+            VL_PRINTF_MT("%%Warning: +verilator+threads+affinity: CPU %ld above maximum %d;"
+                         " ignored\n",
+                         last, static_cast<int>(CPU_SETSIZE) - 1);
+            cpus.clear();
+            break;
+        }
+#endif
+        for (long cpu = first; cpu <= last; ++cpu) cpus.push_back(static_cast<int>(cpu));
+        cp = *endp ? endp + 1 : endp;
+    }
+    return cpus;
+}
+
 void VlThreadPool::tearDownProfilingClientThread() {
     assert(t_profilep);
+    VlProfileRec::countersClose();
     delete t_profilep;
     t_profilep = NULL;
 }
@@ -118,13 +344,78 @@ void VlThreadPool::setupProfilingClientThread() {
     t_profilep = new ProfileTrace;
     // Reserve some space in the thread-local profiling buffer;
     // try not to malloc while collecting profiling.
-    t_profilep->reserve(4096);
+    t_profilep->reserve(Verilated::profThreadsSample() ? PROFILE_RING_SIZE : 4096);
+    t_profileNext = 0;
+    if (Verilated::profThreadsCounters()) VlProfileRec::countersOpen();
     {
         VerilatedLockGuard lk(m_mutex);
         m_allProfiles.insert(t_profilep);
     }
 }
 
+void VlThreadPool::dynamicBegin(bool evenCycle) {
+    if (VL_UNLIKELY(m_dynSlots.empty())) {
+        // Only pay for the rings when dynamic scheduling is used
+        for (size_t i = 0; i <= m_workers.size(); ++i) {
+            m_dynSlots.push_back(new DynSlot(this, i));
+        }
+    }
+    t_dynSlotp = m_dynSlots.back();
+    m_dynActive.store(true, std::memory_order_seq_cst);
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        // A worker still stealing from the previous eval just carries on;
+        // don't queue a second loop behind it.
+        if (!m_dynSlots[i]->m_inLoop.exchange(true, std::memory_order_seq_cst)) {
+            m_workers[i]->addTask(dynamicWorker, evenCycle, m_dynSlots[i]);
+        }
+    }
+}
+
+void VlThreadPool::dynamicRun(const VlMTaskVertex* finalp, bool evenCycle) {
+    DynSlot* selfp = t_dynSlotp;
+    unsigned ct = 0;
+    while (!finalp->areUpstreamDepsDone(evenCycle)) {
+        if (dynamicTryRun(selfp)) {
+            ct = 0;
+        } else {
+            VL_CPU_RELAX();
+            if (VL_UNLIKELY(++ct > VL_LOCK_SPINS)) {
+                ct = 0;
+                VlMTaskVertex::spinThread();
+            }
+        }
+    }
+    // Let the workers return to sleep; any still stealing find empty rings
+    m_dynActive.store(false, std::memory_order_release);
+}
+
+void VlThreadPool::dynamicWorker(bool, VlThrSymTab slotp) {
+    DynSlot* selfp = static_cast<DynSlot*>(slotp);
+    VlThreadPool* poolp = selfp->m_poolp;
+    t_dynSlotp = selfp;
+    unsigned ct = 0;
+    while (true) {
+        while (poolp->m_dynActive.load(std::memory_order_acquire)) {
+            if (poolp->dynamicTryRun(selfp)) {
+                ct = 0;
+            } else {
+                VL_CPU_RELAX();
+                if (VL_UNLIKELY(++ct > VL_LOCK_SPINS)) {
+                    ct = 0;
+                    VlMTaskVertex::spinThread();
+                }
+            }
+        }
+        selfp->m_inLoop.store(false, std::memory_order_seq_cst);
+        // If another eval began meanwhile, dynamicBegin either saw m_inLoop
+        // set and skipped us, so stay, or has queued a new loop for us.
+        if (!poolp->m_dynActive.load(std::memory_order_seq_cst)
+            || selfp->m_inLoop.exchange(true, std::memory_order_seq_cst)) {
+            break;
+        }
+    }
+}
+
 void VlThreadPool::profileAppendAll(const VlProfileRec& rec) {
     VerilatedLockGuard lk(m_mutex);
     for (ProfileSet::iterator it = m_allProfiles.begin(); it != m_allProfiles.end(); ++it) {
@@ -133,7 +424,8 @@ void VlThreadPool::profileAppendAll(const VlProfileRec& rec) {
     }
 }
 
-void VlThreadPool::profileDump(const char* filenamep, vluint64_t ticksElapsed) {
+void VlThreadPool::profileDump(const char* filenamep, vluint64_t ticksElapsed,
+                               const char* mtaskInfop) {
     VerilatedLockGuard lk(m_mutex);
     VL_DEBUG_IF(VL_DBG_MSGF("+prof+threads writing to '%s'\n", filenamep););
 
@@ -151,14 +443,28 @@ void VlThreadPool::profileDump(const char* filenamep, vluint64_t ticksElapsed) {
     fprintf(fp, "VLPROF arg +verilator+prof+threads+start+%" VL_PRI64 "u\n",
             Verilated::profThreadsStart());
     fprintf(fp, "VLPROF arg +verilator+prof+threads+window+%u\n", Verilated::profThreadsWindow());
+    fprintf(fp, "VLPROF arg +verilator+prof+threads+sample+%u\n", Verilated::profThreadsSample());
+    fprintf(fp, "VLPROF arg +verilator+threads+wait+%d\n", Verilated::threadsWait());
+    if (Verilated::threadsAffinity()[0]) {
+        fprintf(fp, "VLPROF arg +verilator+threads+affinity+%s\n",
+                Verilated::threadsAffinity());
+    }
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        fprintf(fp, "VLPROF worker %u pinned_cpu %d\n", static_cast<unsigned>(i),
+                m_workers[i]->cpu());
+    }
     fprintf(fp, "VLPROF stat yields %" VL_PRI64 "u\n", VlMTaskVertex::yields());
+    fprintf(fp, "VLPROF stat parks %" VL_PRI64 "u\n", VlMTaskVertex::parks());
+    if (mtaskInfop) fputs(mtaskInfop, fp);
 
+    const bool counters = Verilated::profThreadsCounters();
     vluint32_t thread_id = 0;
     for (ProfileSet::const_iterator pit = m_allProfiles.begin(); pit != m_allProfiles.end();
          ++pit) {
         ++thread_id;
 
-        bool printing = false;  // False while in warmup phase
+        // False while in warmup phase; sampling has no warmup
+        bool printing = Verilated::profThreadsSample() != 0;
         for (ProfileTrace::const_iterator eit = (*pit)->begin(); eit != (*pit)->end(); ++eit) {
             switch (eit->m_type) {
             case VlProfileRec::TYPE_BARRIER:  //
@@ -169,10 +475,20 @@ void VlThreadPool::profileDump(const char* filenamep, vluint64_t ticksElapsed) {
                 fprintf(fp,
                         "VLPROF mtask %d"
                         " start %" VL_PRI64 "u end %" VL_PRI64 "u elapsed %" VL_PRI64 "u"
-                        " predict_time %u cpu %u on thread %u\n",
+                        " predict_time %u cpu %u on thread %u wait %" VL_PRI64 "u",
                         eit->m_mtaskId, eit->m_startTime, eit->m_endTime,
                         (eit->m_endTime - eit->m_startTime), eit->m_predictTime, eit->m_cpu,
-                        thread_id);
+                        thread_id, eit->m_waitTime);
+                if (counters) {
+                    fprintf(fp,
+                            " cycles %" VL_PRI64 "u instrs %" VL_PRI64 "u"
+                            " llc_misses %" VL_PRI64 "u branch_misses %" VL_PRI64 "u",
+                            eit->m_counters[VlProfileRec::CNT_CYCLES],
+                            eit->m_counters[VlProfileRec::CNT_INSTRS],
+                            eit->m_counters[VlProfileRec::CNT_LLC_MISSES],
+                            eit->m_counters[VlProfileRec::CNT_BRANCH_MISSES]);
+                }
+                fprintf(fp, "\n");
                 break;
             default: assert(false); break;  // LCOV_EXCL_LINE
             }
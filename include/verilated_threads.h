@@ -44,8 +44,28 @@ typedef void (*VlExecFnp)(bool, VlThrSymTab);
 
 /// Track dependencies for a single MTask.
 class VlMTaskVertex {
+public:
+    // TYPES
+    // Wait policies, see Verilated::threadsWait()
+    enum WaitPolicy { WAIT_SPIN = 0, WAIT_YIELD = 1, WAIT_PARK = 2 };
+
+private:
+    // Sleeping waiters, hashed by vertex address into a few buckets rather
+    // than having a mutex in every vertex.  A signaller only touches its
+    // bucket when the vertex becomes ready and the bucket has a waiter.
+    struct ParkBucket {
+        VerilatedMutex m_mutex;
+        std::condition_variable_any m_cv;
+        std::atomic<vluint32_t> m_waiters;  // Number of threads sleeping in bucket
+        ParkBucket()
+            : m_waiters(0) {}
+    };
+    enum { PARK_BUCKETS = 64 };
+
     // MEMBERS
     static std::atomic<vluint64_t> s_yields;  // Statistics
+    static std::atomic<vluint64_t> s_parks;  // Statistics
+    static ParkBucket s_parkBuckets[PARK_BUCKETS];
 
     // On even cycles, _upstreamDepsDone increases as upstream
     // dependencies complete. When it reaches _upstreamDepCount,
@@ -76,26 +96,42 @@ public:
     ~VlMTaskVertex() {}
 
     static vluint64_t yields() { return s_yields; }
+    static vluint64_t parks() { return s_parks; }
     static void yieldThread() {
         ++s_yields;  // Statistics
         std::this_thread::yield();
     }
+    // Called every VL_LOCK_SPINS when spinning on something other than a
+    // vertex, so cannot park.  Yields unless the policy is to spin.
+    static void spinThread() {
+        if (Verilated::threadsWait() != WAIT_SPIN) yieldThread();
+    }
 
     // Upstream mtasks must call this when they complete.
     // Returns true when the current MTaskVertex becomes ready to execute,
     // false while it's still waiting on more dependencies.
+    // This is acquire as well as release, so the caller that sees true may
+    // hand the mtask to another thread (dynamic scheduling) and that thread
+    // sees every upstream mtask's writes.
     inline bool signalUpstreamDone(bool evenCycle) {
+        // seq_cst, so the m_waiters check below can't be reordered before
+        // the count update (this is no extra cost over acq_rel on x86)
+        bool ready;
         if (evenCycle) {
             vluint32_t upstreamDepsDone
-                = 1 + m_upstreamDepsDone.fetch_add(1, std::memory_order_release);
+                = 1 + m_upstreamDepsDone.fetch_add(1, std::memory_order_seq_cst);
             assert(upstreamDepsDone <= m_upstreamDepCount);
-            return (upstreamDepsDone == m_upstreamDepCount);
+            ready = (upstreamDepsDone == m_upstreamDepCount);
         } else {
             vluint32_t upstreamDepsDone_prev
-                = m_upstreamDepsDone.fetch_sub(1, std::memory_order_release);
+                = m_upstreamDepsDone.fetch_sub(1, std::memory_order_seq_cst);
             assert(upstreamDepsDone_prev > 0);
-            return (upstreamDepsDone_prev == 1);
+            ready = (upstreamDepsDone_prev == 1);
+        }
+        if (ready && VL_UNLIKELY(parkBucket().m_waiters.load(std::memory_order_seq_cst))) {
+            unparkWaiters();
         }
+        return ready;
     }
     inline bool areUpstreamDepsDone(bool evenCycle) const {
         vluint32_t target = evenCycle ? m_upstreamDepCount : 0;
@@ -108,14 +144,30 @@ public:
             ++ct;
             if (VL_UNLIKELY(ct > VL_LOCK_SPINS)) {
                 ct = 0;
-                yieldThread();
+                switch (Verilated::threadsWait()) {
+                case WAIT_SPIN: break;
+                case WAIT_PARK: parkUntilDone(evenCycle); break;
+                default: yieldThread(); break;
+                }
             }
         }
     }
+
+private:
+    ParkBucket& parkBucket() const {
+        // Vertices are at least 8 bytes, so drop low bits before hashing
+        return s_parkBuckets[(reinterpret_cast<uintptr_t>(this) >> 3) % PARK_BUCKETS];
+    }
+    void parkUntilDone(bool evenCycle) const;
+    void unparkWaiters() const;
 };
 
 // Profiling support
 class VlProfileRec {
+public:
+    // Hardware counters, recorded with Verilated::profThreadsCounters()
+    enum CounterE { CNT_CYCLES, CNT_INSTRS, CNT_LLC_MISSES, CNT_BRANCH_MISSES, CNT__MAX };
+
 protected:
     friend class VlThreadPool;
     enum VlProfileE { TYPE_MTASK_RUN, TYPE_BARRIER };
@@ -124,7 +176,12 @@ protected:
     vluint32_t m_predictTime;  // How long scheduler predicted would take
     vluint64_t m_startTime;  // Tick at start of execution
     vluint64_t m_endTime;  // Tick at end of execution
+    vluint64_t m_waitTime;  // Ticks waiting for upstream mtasks before the start
     unsigned m_cpu;  // Execution CPU number (at start anyways)
+    vluint64_t m_counters[CNT__MAX];  // Counts over the execution
+    // Per-thread perf_event counter group; [0] is the leader, -1 if none
+    static VL_THREAD_LOCAL int t_counterFds[CNT__MAX];
+
 public:
     class Barrier {};
     VlProfileRec() {}
@@ -134,16 +191,38 @@ public:
         m_predictTime = 0;
         m_startTime = 0;
         m_endTime = 0;
+        m_waitTime = 0;
         m_cpu = getcpu();
+        for (int i = 0; i < CNT__MAX; ++i) m_counters[i] = 0;
     }
     void startRecord(vluint64_t time, uint32_t mtask, uint32_t predict) {
         m_type = VlProfileRec::TYPE_MTASK_RUN;
         m_mtaskId = mtask;
         m_predictTime = predict;
         m_startTime = time;
+        m_waitTime = 0;
         m_cpu = getcpu();
+        if (VL_UNLIKELY(t_counterFds[0] >= 0)) {
+            countersRead(m_counters);
+        } else {
+            for (int i = 0; i < CNT__MAX; ++i) m_counters[i] = 0;
+        }
     }
-    void endRecord(vluint64_t time) { m_endTime = time; }
+    // Record the tick the mtask started waiting on upstream mtasks, after startRecord()
+    void waitRecord(vluint64_t time) { m_waitTime = m_startTime > time ? m_startTime - time : 0; }
+    void endRecord(vluint64_t time) {
+        m_endTime = time;
+        if (VL_UNLIKELY(t_counterFds[0] >= 0)) {
+            vluint64_t ends[CNT__MAX];
+            countersRead(ends);
+            for (int i = 0; i < CNT__MAX; ++i) m_counters[i] = ends[i] - m_counters[i];
+        }
+    }
+    // Start/stop hardware counters for the calling thread; returns false
+    // if the platform or permissions don't allow it
+    static bool countersOpen();
+    static void countersClose();
+    static void countersRead(vluint64_t* countsp);
     static int getcpu() {  // Return current executing CPU
 #if defined(__linux)
         return sched_getcpu();
@@ -166,8 +245,77 @@ public:
 
 class VlThreadPool;
 
+/// Bounded lock-free queue, one producer and any number of consumers.
+/// Each cell carries a sequence number so that a consumer only reads a
+/// cell the producer has published, and the producer only reuses a cell
+/// after its consumer has released it.  A push or pop costs one or two
+/// atomic operations and never takes a lock.
+template <class T_Elem, size_t T_Size> class VlReadyRing {
+    // TYPES
+    struct Cell {
+        std::atomic<size_t> m_seq;  // Sequence number, see push()/tryPop()
+        T_Elem m_elem;  // Stored element
+    };
+    // MEMBERS
+    // Producer and consumer indices on separate lines to avoid false sharing
+    std::atomic<size_t> m_head VL_ATTR_ALIGNED(VL_CACHE_LINE_BYTES);  // Next cell to pop
+    size_t m_tail VL_ATTR_ALIGNED(VL_CACHE_LINE_BYTES);  // Next cell to push; producer only
+    Cell m_cells[T_Size];
+
+    VL_UNCOPYABLE(VlReadyRing);
+
+public:
+    // CONSTRUCTORS
+    VlReadyRing()
+        : m_head(0)
+        , m_tail(0) {
+        // Size must be a power of two, so index wraps are a mask
+        static_assert((T_Size & (T_Size - 1)) == 0, "VlReadyRing size must be power of 2");
+        for (size_t i = 0; i < T_Size; ++i) m_cells[i].m_seq.store(i, std::memory_order_relaxed);
+    }
+    ~VlReadyRing() {}
+
+    // METHODS
+    // Append an element; returns false if the ring is full.  Only the single
+    // producer thread may call this.
+    inline bool push(const T_Elem& elem) {
+        Cell* cellp = &m_cells[m_tail & (T_Size - 1)];
+        if (VL_UNLIKELY(cellp->m_seq.load(std::memory_order_acquire) != m_tail)) return false;
+        cellp->m_elem = elem;
+        cellp->m_seq.store(m_tail + 1, std::memory_order_release);
+        ++m_tail;
+        return true;
+    }
+    // Remove the oldest element into *elemp; returns false if the ring is
+    // empty.  Any thread may call this.
+    inline bool tryPop(T_Elem* elemp) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell* cellp = &m_cells[head & (T_Size - 1)];
+            size_t seq = cellp->m_seq.load(std::memory_order_acquire);
+            if (seq == head + 1) {
+                // Published; claim it (on failure head is reloaded)
+                if (m_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+                    *elemp = cellp->m_elem;
+                    // Hand the cell back to the producer for its next lap
+                    cellp->m_seq.store(head + T_Size, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq == head) {
+                return false;  // Not yet published, so empty
+            } else {
+                head = m_head.load(std::memory_order_relaxed);  // Lost a race, retry
+            }
+        }
+    }
+    inline bool empty() const {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        return m_cells[head & (T_Size - 1)].m_seq.load(std::memory_order_acquire) != head + 1;
+    }
+};
+
 class VlWorkerThread {
-private:
+public:
     // TYPES
     struct ExecRec {
         VlExecFnp m_fnp;  // Function to execute
@@ -183,22 +331,26 @@ private:
             , m_evenCycle(evenCycle) {}
     };
 
+private:
+    // We expect the pending list to be very short, typically 0, 1 or 2:
+    // one root mtask per eval, plus the exit wakeup.  The ring is sized well
+    // beyond that, and addTask() backs off if it ever fills.
+    enum { READY_RING_SIZE = 64 };
+
     // MEMBERS
+    // The ready ring is lock-free; the mutex and condition variable are only
+    // used to put the worker to sleep after it has spun without work.
+    VlReadyRing<ExecRec, READY_RING_SIZE> m_ready;
     VerilatedMutex m_mutex;
     std::condition_variable_any m_cv;
     // Only notify the condition_variable if the worker is waiting
-    bool m_waiting VL_GUARDED_BY(m_mutex);
-
-    // Why a vector? We expect the pending list to be very short, typically
-    // 0 or 1 or 2, so popping from the front shouldn't be
-    // expensive. Revisit if we ever have longer queues...
-    std::vector<ExecRec> m_ready VL_GUARDED_BY(m_mutex);
-    // Store the size atomically, so we can spin wait
-    std::atomic<size_t> m_ready_size;
+    std::atomic<bool> m_waiting;
 
     VlThreadPool* m_poolp;  // Our associated thread pool
 
     bool m_profiling;  // Is profiling enabled?
+    const int m_cpu;  // CPU requested to pin the thread to, or -1
+    const int m_index;  // Index in the pool's workers
     std::atomic<bool> m_exiting;  // Worker thread should exit
     std::thread m_cthread;  // Underlying C++ thread record
 
@@ -206,40 +358,38 @@ private:
 
 public:
     // CONSTRUCTORS
-    explicit VlWorkerThread(VlThreadPool* poolp, bool profiling);
+    VlWorkerThread(VlThreadPool* poolp, bool profiling, int cpu, int index);
     ~VlWorkerThread();
 
     // METHODS
+    int cpu() const { return m_cpu; }
     inline void dequeWork(ExecRec* workp) {
         // Spin for a while, waiting for new data
         for (int i = 0; i < VL_LOCK_SPINS; ++i) {
-            if (VL_LIKELY(m_ready_size.load(std::memory_order_relaxed))) {  //
-                break;
-            }
+            if (VL_LIKELY(m_ready.tryPop(workp))) return;
             VL_CPU_RELAX();
         }
+        // Nothing arrived; go to sleep until addTask notifies us.
         VerilatedLockGuard lk(m_mutex);
-        while (m_ready.empty()) {
-            m_waiting = true;
-            m_cv.wait(lk);
-        }
-        m_waiting = false;
-        // As noted above this is inefficient if our ready list is ever
-        // long (but it shouldn't be)
-        *workp = m_ready.front();
-        m_ready.erase(m_ready.begin());
-        m_ready_size.fetch_sub(1, std::memory_order_relaxed);
+        m_waiting.store(true, std::memory_order_relaxed);
+        // Order the m_waiting store before the ring check below; pairs with
+        // the fence in addTask so one side always sees the other.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!m_ready.tryPop(workp)) m_cv.wait(lk);
+        m_waiting.store(false, std::memory_order_relaxed);
     }
     inline void wakeUp() { addTask(nullptr, false, nullptr); }
     inline void addTask(VlExecFnp fnp, bool evenCycle, VlThrSymTab sym) {
-        bool notify;
-        {
-            VerilatedLockGuard lk(m_mutex);
-            m_ready.emplace_back(fnp, evenCycle, sym);
-            m_ready_size.fetch_add(1, std::memory_order_relaxed);
-            notify = m_waiting;
+        while (VL_UNLIKELY(!m_ready.push(ExecRec(fnp, evenCycle, sym)))) {
+            std::this_thread::yield();  // Full; wait for the worker to drain
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (VL_UNLIKELY(m_waiting.load(std::memory_order_relaxed))) {
+            // Taking the lock ensures the worker is inside wait(), not
+            // between its last ring check and wait(), so cannot miss this.
+            { VerilatedLockGuard lk(m_mutex); }
+            m_cv.notify_one();
         }
-        if (notify) m_cv.notify_one();
     }
     void workerLoop();
     static void startWorker(VlWorkerThread* workerp);
@@ -249,18 +399,51 @@ class VlThreadPool {
     // TYPES
     typedef std::vector<VlProfileRec> ProfileTrace;
     typedef std::set<ProfileTrace*> ProfileSet;
+    typedef VlWorkerThread::ExecRec ExecRec;
+    // Records kept per thread when sampling; older ones are overwritten
+    enum { PROFILE_RING_SIZE = 16384 };
+    // Per-thread state for --threads-schedule dynamic.  Each thread pushes
+    // the mtasks it makes ready onto its own ring, and pops from it first;
+    // idle threads steal from the other threads' rings.
+    enum { DYN_RING_SIZE = 1024 };
+    struct DynSlot {
+        VlThreadPool* m_poolp;  // Owning pool
+        size_t m_index;  // Index in m_dynSlots
+        std::atomic<bool> m_inLoop;  // Worker is in (or queued to enter) dynamicWorker
+        VlReadyRing<ExecRec, DYN_RING_SIZE> m_ring;  // Ready mtasks, produced by owner only
+        DynSlot(VlThreadPool* poolp, size_t index)
+            : m_poolp(poolp)
+            , m_index(index)
+            , m_inLoop(false) {}
+    };
 
     // MEMBERS
     std::vector<VlWorkerThread*> m_workers;  // our workers
+    std::vector<int> m_snapCpus;  // CPU of each worker stopped for a snapshot
     bool m_profiling;  // is profiling enabled?
 
+    // Dynamic scheduling; one slot per worker, then one for the eval() thread
+    std::vector<DynSlot*> m_dynSlots;
+    std::atomic<bool> m_dynActive;  // Workers keep stealing while set
+    static VL_THREAD_LOCAL DynSlot* t_dynSlotp;  // Slot of the executing thread
+
+    // Sharing between models, see modelPoolp()
+    static VlThreadPool* s_modelPoolp;  // Pool for models to share, or NULL
+    bool m_modelOwned;  // Created by modelAttach(), so deleted by modelDetach()
+    std::atomic<int> m_models;  // Number of models using this pool
+    VerilatedMutex m_evalMutex;  // Serializes evals of models sharing a pool
+
     // Support profiling -- we can append records of profiling events
     // to this vector with very low overhead, and then dump them out
     // later. This prevents the overhead of printf/malloc/IO from
     // corrupting the profiling data. It's super cheap to append
     // a VlProfileRec struct on the end of a pre-allocated vector;
     // this is the only cost we pay in real-time during a profiling cycle.
+    //
+    // With Verilated::profThreadsSample() the trace instead is a fixed
+    // size ring, so profiling can run for the whole simulation.
     static VL_THREAD_LOCAL ProfileTrace* t_profilep;
+    static VL_THREAD_LOCAL size_t t_profileNext;  // Ring position when full
     ProfileSet m_allProfiles VL_GUARDED_BY(m_mutex);
     VerilatedMutex m_mutex;
 
@@ -272,6 +455,38 @@ public:
     VlThreadPool(int nThreads, bool profiling);
     ~VlThreadPool();
 
+    // Serialize mtask graph execution of models sharing a pool.  The
+    // generated schedule blocks a worker waiting on mtasks of its own model,
+    // so graphs of two models interleaved on the same workers may deadlock.
+    class EvalGuard {
+        VlThreadPool* m_poolp;
+        bool m_locked;
+        VL_UNCOPYABLE(EvalGuard);
+
+    public:
+        // Lock for any pool the model doesn't own, even if no other model
+        // uses it yet, as another may attach and start an eval meanwhile
+        explicit EvalGuard(VlThreadPool* poolp)
+            : m_poolp(poolp)
+            , m_locked(!poolp->m_modelOwned) {
+            if (VL_UNLIKELY(m_locked)) m_poolp->m_evalMutex.lock();
+        }
+        ~EvalGuard() {
+            if (VL_UNLIKELY(m_locked)) m_poolp->m_evalMutex.unlock();
+        }
+        bool locked() const { return m_locked; }  // Pool may be shared with another model
+    };
+
+    // Sharing one pool between models.  Models constructed after
+    // modelPoolp(poolp) use poolp rather than each creating their own pool,
+    // until modelPoolp(NULL).  The caller owns poolp and must keep it until
+    // all models using it are destroyed.
+    static void modelPoolp(VlThreadPool* poolp) { s_modelPoolp = poolp; }
+    static VlThreadPool* modelPoolp() { return s_modelPoolp; }
+    // Called by the model constructor/destructor to get/release its pool
+    static VlThreadPool* modelAttach(int nThreads, bool profiling);
+    static void modelDetach(VlThreadPool* poolp);
+
     // METHODS
     inline int numThreads() const { return m_workers.size(); }
     inline VlWorkerThread* workerp(int index) {
@@ -280,17 +495,58 @@ public:
         return m_workers[index];
     }
     inline VlProfileRec* profileAppend() {
+        if (VL_UNLIKELY(t_profilep->size() >= PROFILE_RING_SIZE
+                        && Verilated::profThreadsSample())) {
+            // Full; overwrite the oldest record
+            if (t_profileNext >= t_profilep->size()) t_profileNext = 0;
+            return &(*t_profilep)[t_profileNext++];
+        }
         t_profilep->emplace_back();
         return &(t_profilep->back());
     }
     void profileAppendAll(const VlProfileRec& rec);
-    void profileDump(const char* filenamep, vluint64_t ticksElapsed);
+
+    // Dynamic (work stealing) scheduling, used by --threads-schedule dynamic.
+    // The eval() thread calls dynamicBegin(), then enqueueDynamic() for each
+    // root mtask, then dynamicRun() which executes and steals mtasks until
+    // 'finalp' is done.  Each mtask calls enqueueDynamic() for downstream
+    // mtasks it makes ready.
+    void dynamicBegin(bool evenCycle);
+    void dynamicRun(const VlMTaskVertex* finalp, bool evenCycle);
+    inline void enqueueDynamic(VlExecFnp fnp, bool evenCycle, VlThrSymTab sym) {
+        // If our ring is full, run it now rather than wait on other threads
+        if (VL_UNLIKELY(!t_dynSlotp->m_ring.push(ExecRec(fnp, evenCycle, sym)))) {
+            fnp(evenCycle, sym);
+        }
+    }
+    // Write the profile; mtaskInfop, if set, are "VLPROF" lines describing the mtasks
+    void profileDump(const char* filenamep, vluint64_t ticksElapsed,
+                     const char* mtaskInfop = NULL);
+    // Parse a CPU list such as "0-3,8" as used by Verilated::threadsAffinity
+    static std::vector<int> parseCpuList(const char* cpulistp);
     // In profiling mode, each executing thread must call
     // this once to setup profiling state:
     void setupProfilingClientThread();
     void tearDownProfilingClientThread();
 
 private:
+    inline bool dynamicTryRun(DynSlot* selfp) {
+        ExecRec work;
+        if (!selfp->m_ring.tryPop(&work)) {
+            // Steal, starting with the next thread to spread out thieves
+            const size_t n = m_dynSlots.size();
+            size_t i = 1;
+            for (; i < n; ++i) {
+                if (m_dynSlots[(selfp->m_index + i) % n]->m_ring.tryPop(&work)) break;
+            }
+            if (i == n) return false;
+        }
+        work.m_fnp(work.m_evenCycle, work.m_sym);
+        return true;
+    }
+    static void dynamicWorker(bool evenCycle, VlThrSymTab slotp);
+    static void snapshotCb(void* datap, bool after);
+
     VL_UNCOPYABLE(VlThreadPool);
 };
 
@@ -23,18 +23,45 @@
 // clang-format off
 
 #include "verilated.h"
+#include "verilated_intrinsics.h"
 
+#include <deque>
 #include <string>
 #include <vector>
 
 #ifdef VL_TRACE_THREADED
+# include <atomic>
 # include <condition_variable>
-# include <deque>
 # include <thread>
 #endif
 
 // clang-format on
 
+// Commands used by thread tracing, and to record changes of windowed
+// traces. Anonymous enum in class, as we want it scoped, but we also want
+// the automatic conversion to integer types.
+class VerilatedTraceCommand {
+public:
+    // These must all fit in 4 bit at the moment, as the tracing routines
+    // pack parameters in the top bits.
+    enum {
+        CHG_BIT_0 = 0x0,
+        CHG_BIT_1 = 0x1,
+        CHG_CDATA = 0x2,
+        CHG_SDATA = 0x3,
+        CHG_IDATA = 0x4,
+        CHG_QDATA = 0x5,
+        CHG_WDATA = 0x6,
+        CHG_FLOAT = 0x7,
+        CHG_DOUBLE = 0x8,
+        SKIP = 0x9,  // Skip over the number of words in the top bits
+        // TODO: full..
+        TIME_CHANGE = 0xd,
+        END = 0xe,  // End of buffer
+        SHUTDOWN = 0xf  // Shutdown worker thread, also marks end of buffer
+    };
+};
+
 #ifdef VL_TRACE_THREADED
 //=============================================================================
 // Threaded tracing
@@ -81,28 +108,134 @@ public:
     }
 };
 
-// Commands used by thread tracing. Anonymous enum in class, as we want
-// it scoped, but we also want the automatic conversion to integer types.
-class VerilatedTraceCommand {
+class VerilatedTraceChunk;
+
+// A region of a trace buffer being filled with commands. VerilatedTrace
+// itself owns the buffer of the current dump; chunks of it may be handed
+// to other threads, see chunkBegin/chunkEnd.
+class VerilatedTraceBuffer {
+protected:
+    vluint32_t* m_writep;  ///< Write pointer into buffer
+    vluint32_t* m_endp;  ///< End of buffer
+
 public:
-    // These must all fit in 4 bit at the moment, as the tracing routines
-    // pack parameters in the top bits.
-    enum {
-        CHG_BIT_0 = 0x0,
-        CHG_BIT_1 = 0x1,
-        CHG_CDATA = 0x2,
-        CHG_SDATA = 0x3,
-        CHG_IDATA = 0x4,
-        CHG_QDATA = 0x5,
-        CHG_WDATA = 0x6,
-        CHG_FLOAT = 0x7,
-        CHG_DOUBLE = 0x8,
-        // TODO: full..
-        TIME_CHANGE = 0xd,
-        END = 0xe,  // End of buffer
-        SHUTDOWN = 0xf  // Shutdown worker thread, also marks end of buffer
-    };
+    VerilatedTraceBuffer()
+        : m_writep(NULL)
+        , m_endp(NULL) {}
+
+    // Reserve the next 'words' words of this buffer for chunkp, to be
+    // filled by another thread.  Chunks must then be closed in order with
+    // chunkEnd once filled, before the buffer is handed to the worker.
+    inline void chunkBegin(VerilatedTraceChunk* chunkp, void* symsp, vluint32_t code,
+                           vluint32_t words);
+    inline void chunkEnd(VerilatedTraceChunk* chunkp);
+
+    // Threaded tracing. Just dump everything in the trace buffer
+    inline void chgBit(vluint32_t code, CData newval) {
+        m_writep[0] = VerilatedTraceCommand::CHG_BIT_0 | newval;
+        m_writep[1] = code;
+        m_writep += 2;
+        VL_DEBUG_IF(assert(m_writep <= m_endp););
+    }
+    inline void chgCData(vluint32_t code, CData newval, int bits) {
+        m_writep[0] = (bits << 4) | VerilatedTraceCommand::CHG_CDATA;
+        m_writep[1] = code;
+        m_writep[2] = newval;
+        m_writep += 3;
+        VL_DEBUG_IF(assert(m_writep <= m_endp););
+    }
+    inline void chgSData(vluint32_t code, SData newval, int bits) {
+        m_writep[0] = (bits << 4) | VerilatedTraceCommand::CHG_SDATA;
+        m_writep[1] = code;
+        m_writep[2] = newval;
+        m_writep += 3;
+        VL_DEBUG_IF(assert(m_writep <= m_endp););
+    }
+    inline void chgIData(vluint32_t code, IData newval, int bits) {
+        m_writep[0] = (bits << 4) | VerilatedTraceCommand::CHG_IDATA;
+        m_writep[1] = code;
+        m_writep[2] = newval;
+        m_writep += 3;
+        VL_DEBUG_IF(assert(m_writep <= m_endp););
+    }
+    inline void chgQData(vluint32_t code, QData newval, int bits) {
+        m_writep[0] = (bits << 4) | VerilatedTraceCommand::CHG_QDATA;
+        m_writep[1] = code;
+        *reinterpret_cast<QData*>(m_writep + 2) = newval;
+        m_writep += 4;
+        VL_DEBUG_IF(assert(m_writep <= m_endp););
+    }
+    inline void chgWData(vluint32_t code, const WData* newvalp, int bits) {
+        m_writep[0] = (bits << 4) | VerilatedTraceCommand::CHG_WDATA;
+        m_writep[1] = code;
+        m_writep += 2;
+        for (int i = 0; i < (bits + 31) / 32; ++i) { *m_writep++ = newvalp[i]; }
+        VL_DEBUG_IF(assert(m_writep <= m_endp););
+    }
+    inline void chgFloat(vluint32_t code, float newval) {
+        m_writep[0] = VerilatedTraceCommand::CHG_FLOAT;
+        m_writep[1] = code;
+        // cppcheck-suppress invalidPointerCast
+        *reinterpret_cast<float*>(m_writep + 2) = newval;
+        m_writep += 3;
+        VL_DEBUG_IF(assert(m_writep <= m_endp););
+    }
+    inline void chgDouble(vluint32_t code, double newval) {
+        m_writep[0] = VerilatedTraceCommand::CHG_DOUBLE;
+        m_writep[1] = code;
+        // cppcheck-suppress invalidPointerCast
+        *reinterpret_cast<double*>(m_writep + 2) = newval;
+        m_writep += 4;
+        VL_DEBUG_IF(assert(m_writep <= m_endp););
+    }
+};
+
+// One chunk of a model's change dump, filled by a thread pool worker
+// executing a Verilator generated chunk function.
+class VerilatedTraceChunk {
+    friend class VerilatedTraceBuffer;
+    VerilatedTraceBuffer m_buffer;  ///< Region of the dump buffer to fill
+    void* m_symsp;  ///< Symbol table of the model being dumped
+    vluint32_t m_code;  ///< Base code of the model being dumped
+    std::atomic<bool> m_done;  ///< Set once the region is filled
+
+public:
+    VerilatedTraceChunk()
+        : m_symsp(NULL)
+        , m_code(0)
+        , m_done(false) {}
+    VerilatedTraceBuffer* bufferp() { return &m_buffer; }
+    void* symsp() const { return m_symsp; }
+    vluint32_t code() const { return m_code; }
+    void done() { m_done.store(true, std::memory_order_release); }
 };
+
+inline void VerilatedTraceBuffer::chunkBegin(VerilatedTraceChunk* chunkp, void* symsp,
+                                             vluint32_t code, vluint32_t words) {
+    chunkp->m_symsp = symsp;
+    chunkp->m_code = code;
+    chunkp->m_done.store(false, std::memory_order_relaxed);
+    chunkp->m_buffer.m_writep = m_writep;
+    // One more word for the SKIP over whatever the chunk leaves unused
+    m_writep += words + 1;
+    chunkp->m_buffer.m_endp = m_writep;
+    VL_DEBUG_IF(assert(m_writep <= m_endp););
+}
+
+inline void VerilatedTraceBuffer::chunkEnd(VerilatedTraceChunk* chunkp) {
+    unsigned ct = 0;
+    while (VL_UNLIKELY(!chunkp->m_done.load(std::memory_order_acquire))) {
+        VL_CPU_RELAX();
+        if (VL_UNLIKELY(++ct > VL_LOCK_SPINS)) {
+            ct = 0;
+            std::this_thread::yield();
+        }
+    }
+    vluint32_t* const writep = chunkp->m_buffer.m_writep;
+    assert(writep < chunkp->m_buffer.m_endp);
+    const vluint32_t unused = chunkp->m_buffer.m_endp - writep - 1;
+    writep[0] = (unused << 4) | VerilatedTraceCommand::SKIP;
+}
 #endif
 
 class VerilatedTraceCallInfo;
@@ -113,7 +246,11 @@ class VerilatedTraceCallInfo;
 // VerilatedTrace uses F-bounded polymorphism to access duck-typed
 // implementations in the format specific derived class, which must be passed
 // as the type parameter T_Derived
+#ifdef VL_TRACE_THREADED
+template <class T_Derived> class VerilatedTrace : public VerilatedTraceBuffer {
+#else
 template <class T_Derived> class VerilatedTrace {
+#endif
 private:
     //=========================================================================
     // Generic tracing internals
@@ -130,6 +267,52 @@ private:
     double m_timeRes;  ///< Time resolution (ns/ms etc)
     double m_timeUnit;  ///< Time units (ns/ms etc)
 
+    // Windowed capture, see windowSteps(). Each step holds its time in the
+    // first two words, then change records as in VerilatedTraceCommand.
+    typedef std::vector<vluint32_t> WindowRecords;
+    bool m_windowing;  ///< Keeping changes in memory until flushWindow()
+    size_t m_windowMaxSteps;  ///< Time steps to keep, or 0 for no limit
+    size_t m_windowMaxBytes;  ///< Bytes of changes to keep, or 0 for no limit
+    size_t m_windowWords;  ///< Words in the completed steps in m_windowSteps
+    vluint64_t m_windowSnapTime;  ///< Time of m_windowSnap
+    bool m_windowSnapPending;  ///< m_windowSnap not yet written to the file
+    WindowRecords m_windowSnap;  ///< Value of every signal at window start
+    std::vector<vluint32_t> m_windowSnapIndex;  ///< Offset of each code in m_windowSnap
+    std::deque<WindowRecords> m_windowSteps;  ///< Steps in the window, oldest first
+    std::vector<WindowRecords> m_windowSpare;  ///< Emptied steps for reuse
+    WindowRecords* m_windowRecp;  ///< Records being appended to
+
+    // Runtime signal filter, see filterGlob()
+    std::vector<std::string> m_filterGlobs;  ///< Hierarchy patterns to trace
+    int m_filterDepth;  ///< Levels of hierarchy to trace, or 0 for all
+    int m_filterMaxWidth;  ///< Widest signal to trace, or 0 for all
+    bool m_filtering;  ///< Filter applied by the last traceInit
+    std::vector<bool> m_filterCodes;  ///< Code passed the filter, during traceInit
+    vluint32_t* m_filterTracedp;  ///< Count of traced codes below each code, if filtering
+    bool m_divertChanges;  ///< Filtering, windowing or toggle counting, see divertChange()
+
+    // Toggle counting, see toggleReport()
+    std::string m_toggleFilename;  ///< Report to write on close, or empty if not counting
+    bool m_toggleWaves;  ///< Also write the counted changes to the file
+    vluint64_t m_toggleDumps;  ///< Dumps since traceInit
+    vluint64_t m_toggleFullDumps;  ///< Full dumps since traceInit, each counted once per code
+    std::vector<vluint64_t> m_toggleCounts;  ///< Changes per code
+    std::vector<std::string> m_toggleNames;  ///< First traced name of each code
+    std::vector<vluint32_t> m_toggleBits;  ///< Width of each code
+
+    std::string hierName(const char* namep, int& levels) const;
+    bool filterSignal(const char* namep, vluint32_t bits) const;
+    bool divertChange(vluint32_t cmd, const vluint32_t* oldp, int words);
+    void toggleWrite();
+
+    void windowReset(vluint64_t timeui);
+    void windowStep(vluint64_t timeui);
+    void windowDropStep();
+    void windowRecord(vluint32_t cmd, const vluint32_t* oldp, int words);
+    void windowFold(const vluint32_t* recp, const vluint32_t* endp);
+    void windowReplay(const vluint32_t* recp, const vluint32_t* endp);
+    void windowLimits(size_t steps, size_t bytes);
+
     // Equivalent to 'this' but is of the sub-type 'T_Derived*'. Use 'self()->'
     // to access duck-typed functions to avoid a virtual function call.
     T_Derived* self() { return static_cast<T_Derived*>(this); }
@@ -149,11 +332,8 @@ private:
     // Get a new trace buffer that can be populated. May block if none available
     vluint32_t* getTraceBuffer();
 
-    // Write pointer into current buffer
-    vluint32_t* m_traceBufferWritep;
-
-    // End of trace buffer
-    vluint32_t* m_traceBufferEndp;
+    // Words reserved in each buffer for chunk SKIP commands, see declChunks
+    vluint32_t m_numChunks;
 
     // The worker thread itself
     std::unique_ptr<std::thread> m_workerThread;
@@ -166,6 +346,10 @@ private:
 
     // Shut down and join worker, if it's running, otherwise do nothing
     void shutdownWorker();
+
+    // Start the worker thread
+    void startWorker();
+    static void workerSnapshotCb(void* datap, bool after);
 #endif
 
     // CONSTRUCTORS
@@ -191,10 +375,12 @@ protected:
 
     void traceInit() VL_MT_UNSAFE;
 
-    void declCode(vluint32_t code, vluint32_t bits, bool tri);
+    // Declare a signal's code, returning false if the signal is filtered out
+    // at runtime, in which case it must not be written to the file
+    bool declCode(vluint32_t code, const char* namep, vluint32_t bits, bool tri);
 
     /// Is this an escape?
-    bool isScopeEscape(char c) { return isspace(c) || c == m_scopeEscape; }
+    bool isScopeEscape(char c) const { return isspace(c) || c == m_scopeEscape; }
     /// Character that splits scopes.  Note whitespace are ALWAYS escapes.
     char scopeEscape() { return m_scopeEscape; }
 
@@ -229,6 +415,51 @@ public:
     // Call
     void dump(vluint64_t timeui);
 
+    /// Keep changes of only the last 'steps' dumped time steps in memory,
+    /// along with the value of every signal at the start of that window,
+    /// and write them to the file only on flushWindow(), or if the
+    /// simulation stops on an error. 0 (the default) writes every dump.
+    void windowSteps(size_t steps) { windowLimits(steps, m_windowMaxBytes); }
+    /// As windowSteps(), but limit the window to about 'bytes' of changes
+    void windowBytes(size_t bytes) { windowLimits(m_windowMaxSteps, bytes); }
+    /// Write the window kept by windowSteps()/windowBytes(), and start a new one
+    void flushWindow();
+
+    /// Trace only signals whose '.' separated hierarchical name, starting
+    /// with the top module name, matches one of the given patterns, where
+    /// '*' matches any characters and '?' any one character.  The filters
+    /// below apply too, and all must be called before open().
+    void filterGlob(const char* patternp) { m_filterGlobs.push_back(patternp); }
+    /// Trace only signals under at most 'levels' scopes, so 1 traces only
+    /// the signals of the model's top scope. 0 (the default) traces all.
+    void filterDepth(int levels) { m_filterDepth = levels; }
+    /// Trace only signals at most 'bits' wide. 0 (the default) traces all.
+    void filterMaxWidth(int bits) { m_filterMaxWidth = bits; }
+
+    /// Count the changes of every traced signal, and on close() write them
+    /// to 'filenamep' ranked by number of changes.  If 'waves' is false the
+    /// changes are only counted, so the file holds only the initial values
+    /// and dumps do no formatting.  Must be called before open().
+    void toggleReport(const char* filenamep, bool waves = true) {
+        m_toggleFilename = filenamep;
+        m_toggleWaves = waves;
+    }
+    /// Add the bytes used for previous values, windows and buffers to 'usage'
+    void memoryUsage(VerilatedMemoryUsage& usage) const {
+        size_t bytes = 0;
+        if (m_sigs_oldvalp) bytes += m_nextCode * sizeof(vluint32_t);
+        if (m_filterTracedp) bytes += (m_nextCode + 1) * sizeof(vluint32_t);
+        bytes += m_filterCodes.size() / 8;
+        bytes += (m_windowWords + m_windowSnap.size() + m_windowSnapIndex.size())
+                 * sizeof(vluint32_t);
+        bytes += m_toggleCounts.size() * sizeof(vluint64_t);
+        bytes += m_toggleBits.size() * sizeof(vluint32_t);
+#ifdef VL_TRACE_THREADED
+        bytes += m_numTraceBuffers * (m_traceBufferSize + 16) * sizeof(vluint32_t);
+#endif
+        usage.add(VerilatedMemoryUsage::TRACE, bytes);
+    }
+
     //=========================================================================
     // Non-hot path internal interface to Verilator generated code
 
@@ -246,6 +477,12 @@ public:
 
     void scopeEscape(char flag) { m_scopeEscape = flag; }
 
+#ifdef VL_TRACE_THREADED
+    // Called from the init callback of models with parallel change dumps,
+    // with the number of chunks they split each change dump into
+    void declChunks(vluint32_t chunks) { m_numChunks += chunks; }
+#endif
+
     //=========================================================================
     // Hot path internal interface to Verilator generated code
 
@@ -266,6 +503,93 @@ public:
 
     vluint32_t* oldp(vluint32_t code) { return m_sigs_oldvalp + code; }
 
+    // Return whether any code from lo to below hi passed the runtime
+    // signal filter. Used to skip whole parts of dumps.
+    bool traced(vluint32_t lo, vluint32_t hi) const {
+        return VL_LIKELY(!m_filterTracedp) || m_filterTracedp[hi] != m_filterTracedp[lo];
+    }
+
+    // Return whether any of the given number of words at newvalp differs
+    // from the previous values at oldp. Used to check a whole wide signal
+    // or array at once, rather than per word or element.
+    static inline bool changedWords(const vluint32_t* oldp, const vluint32_t* newvalp,
+                                    int words) {
+        int i = 0;
+#ifdef VL_HAVE_AVX2
+        for (; i + 8 <= words; i += 8) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(oldp + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(newvalp + i));
+            const __m256i diff = _mm256_xor_si256(a, b);
+            if (!_mm256_testz_si256(diff, diff)) return true;
+        }
+#endif
+#if defined(VL_HAVE_SSE2)
+        for (; i + 4 <= words; i += 4) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(oldp + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(newvalp + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) != 0xffff) return true;
+        }
+#elif defined(VL_HAVE_NEON)
+        for (; i + 4 <= words; i += 4) {
+            const uint32x4_t diff = veorq_u32(vld1q_u32(oldp + i), vld1q_u32(newvalp + i));
+            const uint64x2_t diff64 = vreinterpretq_u64_u32(diff);
+            if (vgetq_lane_u64(diff64, 0) | vgetq_lane_u64(diff64, 1)) return true;
+        }
+#endif
+        for (; i < words; ++i) {
+            if (oldp[i] != newvalp[i]) return true;
+        }
+        return false;
+    }
+    // As above for an array of CData, each stored in one word at oldp
+    static inline bool changedCData(const vluint32_t* oldp, const CData* newvalp,
+                                    int elements) {
+        int i = 0;
+#ifdef VL_HAVE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= elements; i += 16) {
+            // Zero extend 16 bytes to 4 vectors of words to compare
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(newvalp + i));
+            const __m128i lo = _mm_unpacklo_epi8(v, zero);
+            const __m128i hi = _mm_unpackhi_epi8(v, zero);
+            const __m128i* const op = reinterpret_cast<const __m128i*>(oldp + i);
+            __m128i diff = _mm_xor_si128(_mm_unpacklo_epi16(lo, zero), _mm_loadu_si128(op));
+            diff = _mm_or_si128(
+                diff, _mm_xor_si128(_mm_unpackhi_epi16(lo, zero), _mm_loadu_si128(op + 1)));
+            diff = _mm_or_si128(
+                diff, _mm_xor_si128(_mm_unpacklo_epi16(hi, zero), _mm_loadu_si128(op + 2)));
+            diff = _mm_or_si128(
+                diff, _mm_xor_si128(_mm_unpackhi_epi16(hi, zero), _mm_loadu_si128(op + 3)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(diff, zero)) != 0xffff) return true;
+        }
+#endif
+        for (; i < elements; ++i) {
+            if (oldp[i] != newvalp[i]) return true;
+        }
+        return false;
+    }
+    // As above for an array of SData, each stored in one word at oldp
+    static inline bool changedSData(const vluint32_t* oldp, const SData* newvalp,
+                                    int elements) {
+        int i = 0;
+#ifdef VL_HAVE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= elements; i += 8) {
+            // Zero extend 8 halfwords to 2 vectors of words to compare
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(newvalp + i));
+            const __m128i* const op = reinterpret_cast<const __m128i*>(oldp + i);
+            __m128i diff = _mm_xor_si128(_mm_unpacklo_epi16(v, zero), _mm_loadu_si128(op));
+            diff = _mm_or_si128(
+                diff, _mm_xor_si128(_mm_unpackhi_epi16(v, zero), _mm_loadu_si128(op + 1)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(diff, zero)) != 0xffff) return true;
+        }
+#endif
+        for (; i < elements; ++i) {
+            if (oldp[i] != newvalp[i]) return true;
+        }
+        return false;
+    }
+
     // Write to previous value buffer value and emit trace entry.
     void fullBit(vluint32_t* oldp, CData newval);
     void fullCData(vluint32_t* oldp, CData newval, int bits);
@@ -277,65 +601,8 @@ public:
     void fullDouble(vluint32_t* oldp, double newval);
 
 #ifdef VL_TRACE_THREADED
-    // Threaded tracing. Just dump everything in the trace buffer
-    inline void chgBit(vluint32_t code, CData newval) {
-        m_traceBufferWritep[0] = VerilatedTraceCommand::CHG_BIT_0 | newval;
-        m_traceBufferWritep[1] = code;
-        m_traceBufferWritep += 2;
-        VL_DEBUG_IF(assert(m_traceBufferWritep <= m_traceBufferEndp););
-    }
-    inline void chgCData(vluint32_t code, CData newval, int bits) {
-        m_traceBufferWritep[0] = (bits << 4) | VerilatedTraceCommand::CHG_CDATA;
-        m_traceBufferWritep[1] = code;
-        m_traceBufferWritep[2] = newval;
-        m_traceBufferWritep += 3;
-        VL_DEBUG_IF(assert(m_traceBufferWritep <= m_traceBufferEndp););
-    }
-    inline void chgSData(vluint32_t code, SData newval, int bits) {
-        m_traceBufferWritep[0] = (bits << 4) | VerilatedTraceCommand::CHG_SDATA;
-        m_traceBufferWritep[1] = code;
-        m_traceBufferWritep[2] = newval;
-        m_traceBufferWritep += 3;
-        VL_DEBUG_IF(assert(m_traceBufferWritep <= m_traceBufferEndp););
-    }
-    inline void chgIData(vluint32_t code, IData newval, int bits) {
-        m_traceBufferWritep[0] = (bits << 4) | VerilatedTraceCommand::CHG_IDATA;
-        m_traceBufferWritep[1] = code;
-        m_traceBufferWritep[2] = newval;
-        m_traceBufferWritep += 3;
-        VL_DEBUG_IF(assert(m_traceBufferWritep <= m_traceBufferEndp););
-    }
-    inline void chgQData(vluint32_t code, QData newval, int bits) {
-        m_traceBufferWritep[0] = (bits << 4) | VerilatedTraceCommand::CHG_QDATA;
-        m_traceBufferWritep[1] = code;
-        *reinterpret_cast<QData*>(m_traceBufferWritep + 2) = newval;
-        m_traceBufferWritep += 4;
-        VL_DEBUG_IF(assert(m_traceBufferWritep <= m_traceBufferEndp););
-    }
-    inline void chgWData(vluint32_t code, const WData* newvalp, int bits) {
-        m_traceBufferWritep[0] = (bits << 4) | VerilatedTraceCommand::CHG_WDATA;
-        m_traceBufferWritep[1] = code;
-        m_traceBufferWritep += 2;
-        for (int i = 0; i < (bits + 31) / 32; ++i) { *m_traceBufferWritep++ = newvalp[i]; }
-        VL_DEBUG_IF(assert(m_traceBufferWritep <= m_traceBufferEndp););
-    }
-    inline void chgFloat(vluint32_t code, float newval) {
-        m_traceBufferWritep[0] = VerilatedTraceCommand::CHG_FLOAT;
-        m_traceBufferWritep[1] = code;
-        // cppcheck-suppress invalidPointerCast
-        *reinterpret_cast<float*>(m_traceBufferWritep + 2) = newval;
-        m_traceBufferWritep += 3;
-        VL_DEBUG_IF(assert(m_traceBufferWritep <= m_traceBufferEndp););
-    }
-    inline void chgDouble(vluint32_t code, double newval) {
-        m_traceBufferWritep[0] = VerilatedTraceCommand::CHG_DOUBLE;
-        m_traceBufferWritep[1] = code;
-        // cppcheck-suppress invalidPointerCast
-        *reinterpret_cast<double*>(m_traceBufferWritep + 2) = newval;
-        m_traceBufferWritep += 4;
-        VL_DEBUG_IF(assert(m_traceBufferWritep <= m_traceBufferEndp););
-    }
-
+    // Threaded tracing. The chg* commands writing the trace buffer are in
+    // VerilatedTraceBuffer
 #define CHG(name) chg##name##Impl
 #else
 #define CHG(name) chg##name
@@ -367,11 +634,8 @@ public:
         if (VL_UNLIKELY(diff)) fullQData(oldp, newval, bits);
     }
     inline void CHG(WData)(vluint32_t* oldp, const WData* newvalp, int bits) {
-        for (int i = 0; i < (bits + 31) / 32; ++i) {
-            if (VL_UNLIKELY(oldp[i] ^ newvalp[i])) {
-                fullWData(oldp, newvalp, bits);
-                return;
-            }
+        if (VL_UNLIKELY(changedWords(oldp, newvalp, VL_WORDS_I(bits)))) {
+            fullWData(oldp, newvalp, bits);
         }
     }
     inline void CHG(Float)(vluint32_t* oldp, float newval) {
@@ -26,6 +26,8 @@
 #include "verilated_intrinsics.h"
 #include "verilated_trace.h"
 
+#include <algorithm>
+
 #if 0
 # include <iostream>
 # define VL_TRACE_THREAD_DEBUG(msg) std::cout << "TRACE THREAD: " << msg << std::endl
@@ -98,6 +100,130 @@ public:  // This is in .cpp file so is not widely visible
     ~VerilatedTraceCallInfo() {}
 };
 
+//=============================================================================
+// Windowed capture
+
+// Number of value words following the command and code of a change record
+static inline int windowRecordWords(vluint32_t cmd) {
+    switch (cmd & 0xF) {
+    case VerilatedTraceCommand::CHG_BIT_0:
+    case VerilatedTraceCommand::CHG_BIT_1: return 0;
+    case VerilatedTraceCommand::CHG_QDATA:
+    case VerilatedTraceCommand::CHG_DOUBLE: return 2;
+    case VerilatedTraceCommand::CHG_WDATA: return VL_WORDS_I(cmd >> 4);
+    default: return 1;
+    }
+}
+
+static inline vluint64_t windowStepTime(const std::vector<vluint32_t>& step) {
+    return (static_cast<vluint64_t>(step[1]) << 32) | step[0];
+}
+
+template <>
+void VerilatedTrace<VL_DERIVED_T>::windowRecord(vluint32_t cmd, const vluint32_t* oldp,
+                                                int words) {
+    WindowRecords& rec = *m_windowRecp;
+    rec.push_back(cmd);
+    rec.push_back(oldp - m_sigs_oldvalp);
+    rec.insert(rec.end(), oldp, oldp + words);
+}
+
+template <> void VerilatedTrace<VL_DERIVED_T>::windowDropStep() {
+    WindowRecords& step = m_windowSteps.front();
+    m_windowWords -= step.size();
+    m_windowSpare.push_back(WindowRecords());
+    m_windowSpare.back().swap(step);
+    m_windowSpare.back().clear();
+    m_windowSteps.pop_front();
+}
+
+template <>
+void VerilatedTrace<VL_DERIVED_T>::windowFold(const vluint32_t* recp, const vluint32_t* endp) {
+    while (recp < endp) {
+        const int words = 2 + windowRecordWords(recp[0]);
+        std::copy(recp, recp + words, &m_windowSnap[m_windowSnapIndex[recp[1]]]);
+        recp += words;
+    }
+}
+
+template <> void VerilatedTrace<VL_DERIVED_T>::windowReset(vluint64_t timeui) {
+    // Full dump, recorded as the new snapshot
+    while (!m_windowSteps.empty()) windowDropStep();
+    m_windowWords = 0;
+    m_windowSnap.clear();
+    m_windowSnapTime = timeui;
+    m_windowSnapPending = true;
+    m_windowRecp = &m_windowSnap;
+}
+
+template <> void VerilatedTrace<VL_DERIVED_T>::windowStep(vluint64_t timeui) {
+    if (!m_windowSteps.empty()) m_windowWords += m_windowSteps.back().size();
+    // Fold the oldest steps that fall out of the window into the snapshot
+    while (!m_windowSteps.empty()
+           && ((m_windowMaxSteps && m_windowSteps.size() >= m_windowMaxSteps)
+               || (m_windowMaxBytes && m_windowWords * sizeof(vluint32_t) > m_windowMaxBytes))) {
+        const WindowRecords& step = m_windowSteps.front();
+        m_windowSnapTime = windowStepTime(step);
+        windowFold(&step[2], &step[0] + step.size());
+        m_windowSnapPending = true;
+        windowDropStep();
+    }
+    m_windowSteps.push_back(WindowRecords());
+    if (!m_windowSpare.empty()) {
+        m_windowSteps.back().swap(m_windowSpare.back());
+        m_windowSpare.pop_back();
+    }
+    m_windowRecp = &m_windowSteps.back();
+    m_windowRecp->push_back(static_cast<vluint32_t>(timeui));
+    m_windowRecp->push_back(static_cast<vluint32_t>(timeui >> 32));
+}
+
+template <>
+void VerilatedTrace<VL_DERIVED_T>::windowReplay(const vluint32_t* recp, const vluint32_t* endp) {
+    while (recp < endp) {
+        const vluint32_t cmd = recp[0];
+        const vluint32_t top = cmd >> 4;
+        const vluint32_t code = recp[1];
+        const vluint32_t* const valp = recp + 2;
+        switch (cmd & 0xF) {
+        case VerilatedTraceCommand::CHG_BIT_0:
+        case VerilatedTraceCommand::CHG_BIT_1: self()->emitBit(code, cmd & 1); break;
+        case VerilatedTraceCommand::CHG_CDATA: self()->emitCData(code, *valp, top); break;
+        case VerilatedTraceCommand::CHG_SDATA: self()->emitSData(code, *valp, top); break;
+        case VerilatedTraceCommand::CHG_IDATA: self()->emitIData(code, *valp, top); break;
+        case VerilatedTraceCommand::CHG_QDATA:
+            self()->emitQData(code, *reinterpret_cast<const QData*>(valp), top);
+            break;
+        case VerilatedTraceCommand::CHG_WDATA: self()->emitWData(code, valp, top); break;
+        case VerilatedTraceCommand::CHG_FLOAT:
+            // cppcheck-suppress invalidPointerCast
+            self()->emitFloat(code, *reinterpret_cast<const float*>(valp));
+            break;
+        case VerilatedTraceCommand::CHG_DOUBLE:
+            // cppcheck-suppress invalidPointerCast
+            self()->emitDouble(code, *reinterpret_cast<const double*>(valp));
+            break;
+        }
+        recp += 2 + windowRecordWords(cmd);
+    }
+}
+
+// Handle a change for the runtime filter, windowing or toggle counting,
+// returning true if it is not to be emitted now
+template <>
+bool VerilatedTrace<VL_DERIVED_T>::divertChange(vluint32_t cmd, const vluint32_t* oldp,
+                                                int words) {
+    const vluint32_t code = oldp - m_sigs_oldvalp;
+    if (!traced(code, code + 1)) return true;
+    if (VL_UNLIKELY(!m_toggleCounts.empty())) {
+        ++m_toggleCounts[code];
+        if (!m_toggleWaves) return true;
+    }
+    if (!m_windowing) return false;
+    windowRecord(cmd, oldp, words);
+    return true;
+}
+
 #ifdef VL_TRACE_THREADED
 //=========================================================================
 // Buffer management
@@ -209,10 +335,18 @@ template <> void VerilatedTrace<VL_DERIVED_T>::workerThreadMain() {
 
                 //===
                 // Rare commands
+            case VerilatedTraceCommand::SKIP:
+                VL_TRACE_THREAD_DEBUG("Command SKIP " << top);
+                readp = readp - 1 + top;  // No code in this command, undo increment
+                continue;
             case VerilatedTraceCommand::TIME_CHANGE:
                 VL_TRACE_THREAD_DEBUG("Command TIME_CHANGE " << top);
                 readp -= 1;  // No code in this command, undo increment
-                emitTimeChange(*reinterpret_cast<const vluint64_t*>(readp));
+                if (VL_UNLIKELY(m_windowing)) {
+                    windowStep(*reinterpret_cast<const vluint64_t*>(readp));
+                } else {
+                    emitTimeChange(*reinterpret_cast<const vluint64_t*>(readp));
+                }
                 readp += 2;
                 continue;
 
@@ -245,6 +379,14 @@ template <> void VerilatedTrace<VL_DERIVED_T>::workerThreadMain() {
     } while (VL_LIKELY(!shutdown));
 }
 
+// Declared here as used by both shutdownWorker() and startWorker()
+template <> void VerilatedTrace<VL_DERIVED_T>::workerSnapshotCb(void* datap, bool after);
+
+template <> void VerilatedTrace<VL_DERIVED_T>::startWorker() {
+    m_workerThread.reset(new std::thread(&VerilatedTrace<VL_DERIVED_T>::workerThreadMain, this));
+    Verilated::snapshotCbAdd(workerSnapshotCb, this);
+}
+
 template <> void VerilatedTrace<VL_DERIVED_T>::shutdownWorker() {
     // If the worker thread is not running, done..
     if (!m_workerThread) return;
@@ -258,6 +400,17 @@ template <> void VerilatedTrace<VL_DERIVED_T>::shutdownWorker() {
     // Join the thread and delete it
     m_workerThread->join();
     m_workerThread.reset(nullptr);
+    Verilated::snapshotCbRemove(workerSnapshotCb, this);
+}
+
+template <> void VerilatedTrace<VL_DERIVED_T>::workerSnapshotCb(void* datap, bool after) {
+    // fork() copies only the calling thread, so restart the worker after it
+    VerilatedTrace<VL_DERIVED_T>* tracep = static_cast<VerilatedTrace<VL_DERIVED_T>*>(datap);
+    if (!after) {
+        tracep->shutdownWorker();
+    } else {
+        tracep->startWorker();
+    }
 }
 
 #endif
@@ -265,6 +418,45 @@ template <> void VerilatedTrace<VL_DERIVED_T>::shutdownWorker() {
 //=============================================================================
 // Life cycle
 
+// Order a toggle report by most changes first, else declaration order
+static bool toggleMore(const std::pair<vluint64_t, vluint32_t>& a,
+                       const std::pair<vluint64_t, vluint32_t>& b) {
+    return a.first > b.first;
+}
+
+template <> void VerilatedTrace<VL_DERIVED_T>::toggleWrite() {
+    // Every full dump emitted each traced code once, which are not changes
+    std::vector<std::pair<vluint64_t, vluint32_t> > ranked;
+    for (vluint32_t code = 0; code < m_toggleNames.size(); ++code) {
+        if (m_toggleNames[code].empty()) continue;
+        const vluint64_t changes = m_toggleCounts[code] >= m_toggleFullDumps
+                                       ? m_toggleCounts[code] - m_toggleFullDumps
+                                       : 0;
+        ranked.push_back(std::make_pair(changes, code));
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), toggleMore);
+    FILE* fp = fopen(m_toggleFilename.c_str(), "w");
+    if (VL_UNLIKELY(!fp)) {
+        VL_FATAL_MT(m_toggleFilename.c_str(), 0, "", "Toggle report file not writable");
+        return;
+    }
+    // Changes are counted between dumps, so the rate is per dump after the first
+    const vluint64_t intervals = m_toggleDumps > 1 ? m_toggleDumps - 1 : 1;
+    fprintf(fp, "# Verilator toggle report\n");
+    fprintf(fp, "# dumps %" VL_PRI64 "u signals %" VL_PRI64 "u\n", m_toggleDumps,
+            static_cast<vluint64_t>(ranked.size()));
+    fprintf(fp, "# %12s %12s %6s  %s\n", "changes", "per_dump", "bits", "signal");
+    for (size_t i = 0; i < ranked.size(); ++i) {
+        const vluint32_t code = ranked[i].second;
+        fprintf(fp, "%14" VL_PRI64 "u %12.6f %6u  %s\n", ranked[i].first,
+                static_cast<double>(ranked[i].first) / intervals, m_toggleBits[code],
+                m_toggleNames[code].c_str());
+    }
+    fclose(fp);
+    m_toggleCounts.clear();
+    m_divertChanges = m_windowing || m_filterTracedp;
+}
+
 template <> void VerilatedTrace<VL_DERIVED_T>::close() {
 #ifdef VL_TRACE_THREADED
     shutdownWorker();
@@ -273,6 +465,7 @@ template <> void VerilatedTrace<VL_DERIVED_T>::close() {
         m_numTraceBuffers--;
     }
 #endif
+    if (!m_toggleCounts.empty()) toggleWrite();
 }
 
 template <> void VerilatedTrace<VL_DERIVED_T>::flush() {
@@ -287,6 +480,48 @@ template <> void VerilatedTrace<VL_DERIVED_T>::flush() {
 #endif
 }
 
+template <> void VerilatedTrace<VL_DERIVED_T>::windowLimits(size_t steps, size_t bytes) {
+    m_assertOne.check();
+#ifdef VL_TRACE_THREADED
+    // The worker records changes of windowed traces, so must be idle
+    if (m_workerThread) flush();
+#endif
+    m_windowMaxSteps = steps;
+    m_windowMaxBytes = bytes;
+    const bool windowing = steps || bytes;
+    if (windowing != m_windowing) {
+        // Either starting a window, which needs a snapshot, or the file
+        // needs all values again after the discarded window
+        m_windowing = windowing;
+        m_divertChanges = m_windowing || m_filterTracedp || !m_toggleCounts.empty();
+        fullDump(true);
+    }
+}
+
+template <> void VerilatedTrace<VL_DERIVED_T>::flushWindow() {
+    // Not asserting one thread, as called from Verilated::flushCall on errors
+    if (!m_windowing || m_windowSnapIndex.empty()) return;  // Nothing dumped yet
+    // Wait for the worker to record all changes
+    flush();
+    // Values at the start of the window, unless the file already has them
+    if (m_windowSnapPending && !m_windowSnap.empty()) {
+        emitTimeChange(m_windowSnapTime);
+        windowReplay(&m_windowSnap[0], &m_windowSnap[0] + m_windowSnap.size());
+    }
+    // Then the changes, leaving the snapshot at the end of the window
+    while (!m_windowSteps.empty()) {
+        const WindowRecords& step = m_windowSteps.front();
+        m_windowSnapTime = windowStepTime(step);
+        emitTimeChange(m_windowSnapTime);
+        windowReplay(&step[2], &step[0] + step.size());
+        windowFold(&step[2], &step[0] + step.size());
+        windowDropStep();
+    }
+    m_windowWords = 0;
+    m_windowSnapPending = false;
+    self()->flush();
+}
+
 //=============================================================================
 // VerilatedTrace
 
@@ -301,8 +536,24 @@ VerilatedTrace<VL_DERIVED_T>::VerilatedTrace()
     , m_scopeEscape('.')
     , m_timeRes(1e-9)
     , m_timeUnit(1e-9)
+    , m_windowing(false)
+    , m_windowMaxSteps(0)
+    , m_windowMaxBytes(0)
+    , m_windowWords(0)
+    , m_windowSnapTime(0)
+    , m_windowSnapPending(false)
+    , m_windowRecp(NULL)
+    , m_filterDepth(0)
+    , m_filterMaxWidth(0)
+    , m_filtering(false)
+    , m_filterTracedp(NULL)
+    , m_divertChanges(false)
+    , m_toggleWaves(true)
+    , m_toggleDumps(0)
+    , m_toggleFullDumps(0)
 #ifdef VL_TRACE_THREADED
     , m_numTraceBuffers(0)
+    , m_numChunks(0)
 #endif
 {
     set_time_unit(Verilated::timeunitString());
@@ -311,6 +562,7 @@ VerilatedTrace<VL_DERIVED_T>::VerilatedTrace()
 
 template <> VerilatedTrace<VL_DERIVED_T>::~VerilatedTrace() {
     if (m_sigs_oldvalp) VL_DO_CLEAR(delete[] m_sigs_oldvalp, m_sigs_oldvalp = NULL);
+    if (m_filterTracedp) VL_DO_CLEAR(delete[] m_filterTracedp, m_filterTracedp = NULL);
     while (!m_callbacks.empty()) {
         delete m_callbacks.back();
         m_callbacks.pop_back();
@@ -333,6 +585,13 @@ template <> void VerilatedTrace<VL_DERIVED_T>::traceInit() VL_MT_UNSAFE {
     m_nextCode = 1;
     m_numSignals = 0;
     m_maxBits = 0;
+#ifdef VL_TRACE_THREADED
+    m_numChunks = 0;
+#endif
+    m_filtering = !m_filterGlobs.empty() || m_filterDepth || m_filterMaxWidth;
+    m_filterCodes.clear();
+    m_toggleNames.clear();
+    m_toggleBits.clear();
 
     // Call all initialize callbacks, which will call decl* for each signal.
     for (vluint32_t ent = 0; ent < m_callbacks.size(); ++ent) {
@@ -350,21 +609,102 @@ template <> void VerilatedTrace<VL_DERIVED_T>::traceInit() VL_MT_UNSAFE {
     // holding previous signal values.
     if (!m_sigs_oldvalp) m_sigs_oldvalp = new vluint32_t[nextCode()];
 
+    // Count the codes passing the runtime filter, for traced()
+    if (m_filterTracedp) VL_DO_CLEAR(delete[] m_filterTracedp, m_filterTracedp = NULL);
+    if (m_filtering) {
+        m_filterCodes.resize(nextCode(), false);
+        m_filterTracedp = new vluint32_t[nextCode() + 1];
+        m_filterTracedp[0] = 0;
+        for (vluint32_t code = 0; code < nextCode(); ++code) {
+            m_filterTracedp[code + 1] = m_filterTracedp[code] + m_filterCodes[code];
+        }
+        m_filterCodes.clear();
+    }
+    // Count changes from scratch, as a reopened file starts with a full dump
+    m_toggleCounts.clear();
+    m_toggleDumps = 0;
+    m_toggleFullDumps = 0;
+    if (!m_toggleFilename.empty()) {
+        m_toggleCounts.resize(nextCode(), 0);
+        m_toggleNames.resize(nextCode());
+        m_toggleBits.resize(nextCode(), 0);
+    }
+    m_divertChanges = m_windowing || m_filterTracedp || !m_toggleCounts.empty();
+
 #ifdef VL_TRACE_THREADED
     // Compute trace buffer size. we need to be able to store a new value for
     // each signal, which is 'nextCode()' entries after the init callbacks
     // above have been run, plus up to 2 more words of metadata per signal,
     // plus fixed overhead of 1 for a termination flag and 3 for a time stamp
-    // update.
-    m_traceBufferSize = nextCode() + numSignals() * 2 + 4;
+    // update, plus 1 for the SKIP closing each chunk of parallel dumps.
+    m_traceBufferSize = nextCode() + numSignals() * 2 + 4 + m_numChunks;
 
     // Start the worker thread
-    m_workerThread.reset(new std::thread(&VerilatedTrace<VL_DERIVED_T>::workerThreadMain, this));
+    startWorker();
 #endif
 }
 
+// Match a name against a pattern of '*' for any characters and '?' for any
+// one character
+static bool filterMatch(const char* patternp, const char* namep) {
+    const char* starp = NULL;  // Last '*' seen
+    const char* resumep = NULL;  // Where in the name that '*' matches up to
+    while (*namep) {
+        if (*patternp == '*') {
+            starp = patternp++;
+            resumep = namep;
+        } else if (*patternp == '?' || *patternp == *namep) {
+            ++patternp;
+            ++namep;
+        } else if (starp) {
+            patternp = starp + 1;
+            namep = ++resumep;
+        } else {
+            return false;
+        }
+    }
+    while (*patternp == '*') ++patternp;
+    return !*patternp;
+}
+
+// Hierarchical name with '.' between scopes, as scope escapes vary by
+// caller, and the number of scopes the signal is under
 template <>
-void VerilatedTrace<VL_DERIVED_T>::declCode(vluint32_t code, vluint32_t bits, bool tri) {
+std::string VerilatedTrace<VL_DERIVED_T>::hierName(const char* namep, int& levels) const {
+    std::string hiername = moduleName();
+    levels = 0;
+    if (!hiername.empty()) {
+        hiername += '.';
+        ++levels;
+    }
+    for (const char* cp = namep; *cp; ++cp) {
+        if (isScopeEscape(*cp)) {
+            hiername += '.';
+            ++levels;
+        } else {
+            hiername += *cp;
+        }
+    }
+    return hiername;
+}
+
+template <>
+bool VerilatedTrace<VL_DERIVED_T>::filterSignal(const char* namep, vluint32_t bits) const {
+    if (m_filterMaxWidth && bits > static_cast<vluint32_t>(m_filterMaxWidth)) return false;
+    int levels;
+    const std::string hiername = hierName(namep, levels);
+    if (m_filterDepth && levels > m_filterDepth) return false;
+    if (m_filterGlobs.empty()) return true;
+    for (std::vector<std::string>::const_iterator it = m_filterGlobs.begin();
+         it != m_filterGlobs.end(); ++it) {
+        if (filterMatch(it->c_str(), hiername.c_str())) return true;
+    }
+    return false;
+}
+
+template <>
+bool VerilatedTrace<VL_DERIVED_T>::declCode(vluint32_t code, const char* namep, vluint32_t bits,
+                                            bool tri) {
     if (!code) {
         VL_FATAL_MT(__FILE__, __LINE__, "", "Internal: internal trace problem, code 0 is illegal");
     }
@@ -375,6 +715,26 @@ void VerilatedTrace<VL_DERIVED_T>::declCode(vluint32_t code, vluint32_t bits, bo
     m_nextCode = std::max(m_nextCode, code + codesNeeded);
     ++m_numSignals;
     m_maxBits = std::max(m_maxBits, bits);
+
+    if (VL_UNLIKELY(m_filtering)) {
+        if (!filterSignal(namep, bits)) return false;
+        // Trace the code if any of its aliases passes the filter
+        if (m_filterCodes.size() < m_nextCode) m_filterCodes.resize(m_nextCode, false);
+        for (int i = 0; i < codesNeeded; ++i) m_filterCodes[code + i] = true;
+    }
+    if (VL_UNLIKELY(!m_toggleFilename.empty())) {
+        // Report each code under the first of its aliases
+        if (m_toggleNames.size() < m_nextCode) {
+            m_toggleNames.resize(m_nextCode);
+            m_toggleBits.resize(m_nextCode, 0);
+        }
+        if (m_toggleNames[code].empty()) {
+            int levels;
+            m_toggleNames[code] = hierName(namep, levels);
+            m_toggleBits[code] = bits;
+        }
+    }
+    return true;
 }
 
 //=========================================================================
@@ -432,30 +792,54 @@ template <> void VerilatedTrace<VL_DERIVED_T>::dump(vluint64_t timeui) {
     if (VL_LIKELY(!m_fullDump)) {
         // Get the trace buffer we are about to fill
         bufferp = getTraceBuffer();
-        m_traceBufferWritep = bufferp;
-        m_traceBufferEndp = bufferp + m_traceBufferSize;
+        m_writep = bufferp;
+        m_endp = bufferp + m_traceBufferSize;
 
         // Tell worker to update time point
-        m_traceBufferWritep[0] = VerilatedTraceCommand::TIME_CHANGE;
-        *reinterpret_cast<vluint64_t*>(m_traceBufferWritep + 1) = timeui;
-        m_traceBufferWritep += 3;
+        m_writep[0] = VerilatedTraceCommand::TIME_CHANGE;
+        *reinterpret_cast<vluint64_t*>(m_writep + 1) = timeui;
+        m_writep += 3;
     } else {
         // Update time point
         flush();
-        emitTimeChange(timeui);
+        if (VL_UNLIKELY(m_windowing)) {
+            windowReset(timeui);
+        } else {
+            emitTimeChange(timeui);
+        }
     }
 #else
     // Update time point
-    emitTimeChange(timeui);
+    if (VL_UNLIKELY(m_windowing)) {
+        if (m_fullDump) {
+            windowReset(timeui);
+        } else {
+            windowStep(timeui);
+        }
+    } else {
+        emitTimeChange(timeui);
+    }
 #endif
 
+    ++m_toggleDumps;
+
     // Run the callbacks
     if (VL_UNLIKELY(m_fullDump)) {
+        ++m_toggleFullDumps;
         m_fullDump = false;  // No more need for next dump to be full
         for (vluint32_t ent = 0; ent < m_callbacks.size(); ++ent) {
             VerilatedTraceCallInfo* cip = m_callbacks[ent];
             (cip->m_fullcb)(self(), cip->m_userthis, cip->m_code);
         }
+        if (VL_UNLIKELY(m_windowing)) {
+            // Index the snapshot, so later changes can be folded into it
+            m_windowSnapIndex.assign(nextCode(), 0);
+            const vluint32_t* const basep = m_windowSnap.empty() ? NULL : &m_windowSnap[0];
+            for (size_t i = 0; i < m_windowSnap.size();) {
+                m_windowSnapIndex[basep[i + 1]] = i;
+                i += 2 + windowRecordWords(basep[i]);
+            }
+        }
     } else {
         for (vluint32_t ent = 0; ent < m_callbacks.size(); ++ent) {
             VerilatedTraceCallInfo* cip = m_callbacks[ent];
@@ -466,10 +850,10 @@ template <> void VerilatedTrace<VL_DERIVED_T>::dump(vluint64_t timeui) {
 #ifdef VL_TRACE_THREADED
     if (VL_LIKELY(bufferp)) {
         // Mark end of the trace buffer we just filled
-        *m_traceBufferWritep++ = VerilatedTraceCommand::END;
+        *m_writep++ = VerilatedTraceCommand::END;
 
         // Assert no buffer overflow
-        assert(m_traceBufferWritep - bufferp <= m_traceBufferSize);
+        assert(m_writep - bufferp <= m_traceBufferSize);
 
         // Pass it to the worker thread
         m_buffersToWorker.put(bufferp);
@@ -504,48 +888,80 @@ void VerilatedTrace<VL_DERIVED_T>::addCallback(callback_t initcb, callback_t ful
 
 template <> void VerilatedTrace<VL_DERIVED_T>::fullBit(vluint32_t* oldp, CData newval) {
     *oldp = newval;
+    if (VL_UNLIKELY(m_divertChanges)
+        && divertChange(VerilatedTraceCommand::CHG_BIT_0 | newval, oldp, 0)) {
+        return;
+    }
     self()->emitBit(oldp - m_sigs_oldvalp, newval);
 }
 
 template <>
 void VerilatedTrace<VL_DERIVED_T>::fullCData(vluint32_t* oldp, CData newval, int bits) {
     *oldp = newval;
+    if (VL_UNLIKELY(m_divertChanges)
+        && divertChange((bits << 4) | VerilatedTraceCommand::CHG_CDATA, oldp, 1)) {
+        return;
+    }
     self()->emitCData(oldp - m_sigs_oldvalp, newval, bits);
 }
 
 template <>
 void VerilatedTrace<VL_DERIVED_T>::fullSData(vluint32_t* oldp, SData newval, int bits) {
     *oldp = newval;
+    if (VL_UNLIKELY(m_divertChanges)
+        && divertChange((bits << 4) | VerilatedTraceCommand::CHG_SDATA, oldp, 1)) {
+        return;
+    }
     self()->emitSData(oldp - m_sigs_oldvalp, newval, bits);
 }
 
 template <>
 void VerilatedTrace<VL_DERIVED_T>::fullIData(vluint32_t* oldp, IData newval, int bits) {
     *oldp = newval;
+    if (VL_UNLIKELY(m_divertChanges)
+        && divertChange((bits << 4) | VerilatedTraceCommand::CHG_IDATA, oldp, 1)) {
+        return;
+    }
     self()->emitIData(oldp - m_sigs_oldvalp, newval, bits);
 }
 
 template <>
 void VerilatedTrace<VL_DERIVED_T>::fullQData(vluint32_t* oldp, QData newval, int bits) {
     *reinterpret_cast<QData*>(oldp) = newval;
+    if (VL_UNLIKELY(m_divertChanges)
+        && divertChange((bits << 4) | VerilatedTraceCommand::CHG_QDATA, oldp, 2)) {
+        return;
+    }
     self()->emitQData(oldp - m_sigs_oldvalp, newval, bits);
 }
 
 template <>
 void VerilatedTrace<VL_DERIVED_T>::fullWData(vluint32_t* oldp, const WData* newvalp, int bits) {
     for (int i = 0; i < VL_WORDS_I(bits); ++i) oldp[i] = newvalp[i];
+    if (VL_UNLIKELY(m_divertChanges)
+        && divertChange((bits << 4) | VerilatedTraceCommand::CHG_WDATA, oldp, VL_WORDS_I(bits))) {
+        return;
+    }
     self()->emitWData(oldp - m_sigs_oldvalp, newvalp, bits);
 }
 
 template <> void VerilatedTrace<VL_DERIVED_T>::fullFloat(vluint32_t* oldp, float newval) {
     // cppcheck-suppress invalidPointerCast
     *reinterpret_cast<float*>(oldp) = newval;
+    if (VL_UNLIKELY(m_divertChanges)
+        && divertChange(VerilatedTraceCommand::CHG_FLOAT, oldp, 1)) {
+        return;
+    }
     self()->emitFloat(oldp - m_sigs_oldvalp, newval);
 }
 
 template <> void VerilatedTrace<VL_DERIVED_T>::fullDouble(vluint32_t* oldp, double newval) {
     // cppcheck-suppress invalidPointerCast
     *reinterpret_cast<double*>(oldp) = newval;
+    if (VL_UNLIKELY(m_divertChanges)
+        && divertChange(VerilatedTraceCommand::CHG_DOUBLE, oldp, 2)) {
+        return;
+    }
     self()->emitDouble(oldp - m_sigs_oldvalp, newval);
 }
 
@@ -555,6 +971,21 @@ template <> void VerilatedTrace<VL_DERIVED_T>::fullDouble(vluint32_t* oldp, doub
 // All of these take a destination pointer where the string will be emitted,
 // and a value to convert. There are a couple of variants for efficiency.
 
+#ifndef VL_HAVE_SSE2
+// Characters of each byte value, most significant bit first, so bytes are
+// converted with a single copy where there are no vector instructions
+static const struct VerilatedTraceByteChars {
+    char m_chars[256][8];
+    VerilatedTraceByteChars() {
+        for (int value = 0; value < 256; ++value) {
+            for (int bit = 0; bit < 8; ++bit) {
+                m_chars[value][bit] = '0' | static_cast<char>((value >> (7 - bit)) & 1);
+            }
+        }
+    }
+} s_byteChars;
+#endif
+
 inline static void cvtCDataToStr(char* dstp, CData value) {
 #ifdef VL_HAVE_SSE2
     // Similar to cvtSDataToStr but only the bottom 8 byte lanes are used
@@ -566,14 +997,7 @@ inline static void cvtCDataToStr(char* dstp, CData value) {
     const __m128i result = _mm_sub_epi8(_mm_set1_epi8('0'), d);
     _mm_storel_epi64(reinterpret_cast<__m128i*>(dstp), result);
 #else
-    dstp[0] = '0' | static_cast<char>((value >> 7) & 1);
-    dstp[1] = '0' | static_cast<char>((value >> 6) & 1);
-    dstp[2] = '0' | static_cast<char>((value >> 5) & 1);
-    dstp[3] = '0' | static_cast<char>((value >> 4) & 1);
-    dstp[4] = '0' | static_cast<char>((value >> 3) & 1);
-    dstp[5] = '0' | static_cast<char>((value >> 2) & 1);
-    dstp[6] = '0' | static_cast<char>((value >> 1) & 1);
-    dstp[7] = '0' | static_cast<char>(value & 1);
+    memcpy(dstp, s_byteChars.m_chars[value], 8);
 #endif
 }
 
@@ -0,0 +1,369 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2001-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief C++ Tracing in Verilator Binary Trace (VBT) Format
+///
+//=============================================================================
+// SPDIFF_OFF
+
+// clang-format off
+
+#include "verilatedos.h"
+#include "verilated.h"
+#include "verilated_vbt_c.h"
+#include "verilated_live.h"
+
+// Include the GTKWave LZ4 implementation directly.  The FST trace writer
+// and VBT reader also include it, so rename its functions to allow linking
+// them together.
+# define LZ4_compress vlvbt_LZ4_compress
+# define LZ4_compressBound vlvbt_LZ4_compressBound
+# define LZ4_compress_continue vlvbt_LZ4_compress_continue
+# define LZ4_compress_default vlvbt_LZ4_compress_default
+# define LZ4_compress_destSize vlvbt_LZ4_compress_destSize
+# define LZ4_compress_fast vlvbt_LZ4_compress_fast
+# define LZ4_compress_fast_continue vlvbt_LZ4_compress_fast_continue
+# define LZ4_compress_fast_extState vlvbt_LZ4_compress_fast_extState
+# define LZ4_compress_fast_force vlvbt_LZ4_compress_fast_force
+# define LZ4_compress_forceExtDict vlvbt_LZ4_compress_forceExtDict
+# define LZ4_compress_limitedOutput vlvbt_LZ4_compress_limitedOutput
+# define LZ4_compress_limitedOutput_continue vlvbt_LZ4_compress_limitedOutput_continue
+# define LZ4_compress_limitedOutput_withState vlvbt_LZ4_compress_limitedOutput_withState
+# define LZ4_compress_withState vlvbt_LZ4_compress_withState
+# define LZ4_create vlvbt_LZ4_create
+# define LZ4_createStream vlvbt_LZ4_createStream
+# define LZ4_createStreamDecode vlvbt_LZ4_createStreamDecode
+# define LZ4_decompress_fast vlvbt_LZ4_decompress_fast
+# define LZ4_decompress_fast_continue vlvbt_LZ4_decompress_fast_continue
+# define LZ4_decompress_fast_usingDict vlvbt_LZ4_decompress_fast_usingDict
+# define LZ4_decompress_fast_withPrefix64k vlvbt_LZ4_decompress_fast_withPrefix64k
+# define LZ4_decompress_safe vlvbt_LZ4_decompress_safe
+# define LZ4_decompress_safe_continue vlvbt_LZ4_decompress_safe_continue
+# define LZ4_decompress_safe_forceExtDict vlvbt_LZ4_decompress_safe_forceExtDict
+# define LZ4_decompress_safe_partial vlvbt_LZ4_decompress_safe_partial
+# define LZ4_decompress_safe_usingDict vlvbt_LZ4_decompress_safe_usingDict
+# define LZ4_decompress_safe_withPrefix64k vlvbt_LZ4_decompress_safe_withPrefix64k
+# define LZ4_freeStream vlvbt_LZ4_freeStream
+# define LZ4_freeStreamDecode vlvbt_LZ4_freeStreamDecode
+# define LZ4_loadDict vlvbt_LZ4_loadDict
+# define LZ4_resetStream vlvbt_LZ4_resetStream
+# define LZ4_resetStreamState vlvbt_LZ4_resetStreamState
+# define LZ4_saveDict vlvbt_LZ4_saveDict
+# define LZ4_setStreamDecode vlvbt_LZ4_setStreamDecode
+# define LZ4_sizeofState vlvbt_LZ4_sizeofState
+# define LZ4_sizeofStreamState vlvbt_LZ4_sizeofStreamState
+# define LZ4_slideInputBuffer vlvbt_LZ4_slideInputBuffer
+# define LZ4_uncompress vlvbt_LZ4_uncompress
+# define LZ4_uncompress_unknownOutputSize vlvbt_LZ4_uncompress_unknownOutputSize
+# define LZ4_versionNumber vlvbt_LZ4_versionNumber
+#include "gtkwave/lz4.c"
+
+#include <algorithm>
+#include <cstring>
+
+// clang-format on
+
+//=============================================================================
+// Specialization of the generics for this trace format
+
+#define VL_DERIVED_T VerilatedVbt
+#include "verilated_trace_imp.cpp"
+#undef VL_DERIVED_T
+
+//=============================================================================
+// Serialization helpers
+
+static inline void vbtPut(std::string& out, const void* datap, size_t bytes) {
+    out.append(static_cast<const char*>(datap), bytes);
+}
+static inline void vbtPutU32(std::string& out, vluint32_t value) {
+    vbtPut(out, &value, sizeof(value));
+}
+static inline void vbtPutU64(std::string& out, vluint64_t value) {
+    vbtPut(out, &value, sizeof(value));
+}
+
+// Compress a column, storing it raw if it would not get smaller
+static void vbtCompress(const char* rawp, size_t raw, std::string& out) {
+    out.resize(LZ4_compressBound(raw));
+    const int comp = raw ? LZ4_compress_default(rawp, &out[0], raw, out.size()) : 0;
+    if (comp > 0 && static_cast<size_t>(comp) < raw) {
+        out.resize(comp);
+    } else {
+        out.assign(rawp, raw);
+    }
+}
+
+//=============================================================================
+// VerilatedVbt
+
+VerilatedVbt::VerilatedVbt()
+    : m_fp(NULL)
+    , m_wroteBytes(0)
+    , m_headerSigs(0)
+    , m_blockBytes(0)
+    , m_blockSize(16 * 1024 * 1024) {}
+
+VerilatedVbt::~VerilatedVbt() { close(); }
+
+void VerilatedVbt::open(const char* filename) VL_MT_UNSAFE {
+    m_assertOne.check();
+    if (isOpen()) return;
+    m_fp = std::fopen(filename, "wb");
+    if (!m_fp) return;  // User code can check isOpen()
+    m_wroteBytes = 0;
+    m_index.clear();
+    m_header.clear();
+    m_headerSigs = 0;
+    m_columns.clear();
+
+    VerilatedTrace<VerilatedVbt>::traceInit();
+
+    // Value stores, with a word per code as codes are allocated per word
+    m_columns.resize(nextCode());
+    m_lastVals.assign(nextCode() * sizeof(EData), 0);
+    m_blockVals.assign(nextCode() * sizeof(EData), 0);
+    m_lastValid.assign(nextCode(), false);
+    m_blockValid.assign(nextCode(), false);
+    m_times.clear();
+    m_blockBytes = 0;
+
+    std::fwrite(VerilatedVbtFormat::magic(), 1, 8, m_fp);
+    m_wroteBytes += 8;
+    std::string payload;
+    const std::string timescale = timeResStr();
+    vbtPutU32(payload, timescale.size());
+    payload += timescale;
+    vbtPutU32(payload, m_headerSigs);
+    payload += m_header;
+    writeRecord(VerilatedVbtFormat::HEADER, payload);
+    m_header.clear();
+}
+
+void VerilatedVbt::close() VL_MT_UNSAFE {
+    m_assertOne.check();
+    if (!isOpen()) return;
+    // Shut down the tracing thread, which first processes outstanding buffers
+    VerilatedTrace<VerilatedVbt>::close();
+    writeBlock();
+    // Index for random access, found from the trailer
+    const vluint64_t indexOffset = m_wroteBytes;
+    std::string payload;
+    vbtPutU32(payload, m_index.size());
+    for (std::vector<IndexEntry>::const_iterator it = m_index.begin(); it != m_index.end();
+         ++it) {
+        vbtPutU64(payload, it->m_offset);
+        vbtPutU64(payload, it->m_firstTime);
+        vbtPutU64(payload, it->m_lastTime);
+    }
+    writeRecord(VerilatedVbtFormat::INDEX, payload);
+    std::string trailer;
+    vbtPutU64(trailer, indexOffset);
+    trailer += VerilatedVbtFormat::endMagic();
+    std::fwrite(trailer.data(), 1, trailer.size(), m_fp);
+    std::fclose(m_fp);
+    m_fp = NULL;
+}
+
+void VerilatedVbt::flush() VL_MT_UNSAFE {
+    if (!isOpen()) return;
+    VerilatedTrace<VerilatedVbt>::flush();
+    writeBlock();
+    std::fflush(m_fp);
+}
+
+void VerilatedVbt::emitTimeChange(vluint64_t timeui) {
+    // Blocks always hold whole time steps
+    if (VL_UNLIKELY(m_blockBytes >= m_blockSize)) writeBlock();
+    m_times.push_back(timeui);
+}
+
+void VerilatedVbt::writeRecord(char type, const std::string& payload) {
+    std::string head(1, type);
+    vbtPutU64(head, payload.size());
+    std::fwrite(head.data(), 1, head.size(), m_fp);
+    std::fwrite(payload.data(), 1, payload.size(), m_fp);
+    m_wroteBytes += head.size() + payload.size();
+    if (VerilatedLiveStats* const livep = Verilated::liveStatsp()) {
+        livep->traceWrote(head.size() + payload.size());
+    }
+}
+
+void VerilatedVbt::writeBlock() {
+    if (m_times.empty()) return;
+    // Assemble and compress the columns
+    std::vector<vluint32_t> codes;
+    std::vector<vluint32_t> raws;
+    std::vector<std::string> comps;
+    std::string raw;
+    for (vluint32_t code = 0; code < m_columns.size(); ++code) {
+        Column& col = m_columns[code];
+        if (!col.m_declared) continue;
+        if (!m_blockValid[code] && col.m_data.empty()) continue;
+        raw.assign(1, static_cast<char>(m_blockValid[code]));
+        if (m_blockValid[code]) vbtPut(raw, &m_blockVals[code * sizeof(EData)], col.m_bytes);
+        if (!col.m_data.empty()) vbtPut(raw, &col.m_data[0], col.m_data.size());
+        codes.push_back(code);
+        raws.push_back(raw.size());
+        comps.push_back(std::string());
+        vbtCompress(raw.data(), raw.size(), comps.back());
+        col.m_data.clear();
+        col.m_lastIndex = 0;
+    }
+    std::string times;
+    vbtCompress(reinterpret_cast<const char*>(&m_times[0]), m_times.size() * sizeof(vluint64_t),
+                times);
+
+    // Header, directory, then data
+    const vluint32_t ncols = codes.size();
+    std::string payload;
+    vbtPutU64(payload, m_times.front());
+    vbtPutU64(payload, m_times.back());
+    vbtPutU32(payload, m_times.size());
+    vbtPutU32(payload, ncols);
+    vbtPutU32(payload, m_times.size() * sizeof(vluint64_t));
+    vbtPutU32(payload, times.size());
+    vluint64_t offset = payload.size() + ncols * (3 * sizeof(vluint32_t) + sizeof(vluint64_t))
+                        + times.size();
+    for (vluint32_t i = 0; i < ncols; ++i) {
+        vbtPutU32(payload, codes[i]);
+        vbtPutU32(payload, raws[i]);
+        vbtPutU32(payload, comps[i].size());
+        vbtPutU64(payload, offset);
+        offset += comps[i].size();
+    }
+    payload += times;
+    for (vluint32_t i = 0; i < ncols; ++i) payload += comps[i];
+
+    IndexEntry entry;
+    entry.m_offset = m_wroteBytes;
+    entry.m_firstTime = m_times.front();
+    entry.m_lastTime = m_times.back();
+    m_index.push_back(entry);
+    writeRecord(VerilatedVbtFormat::BLOCK, payload);
+
+    // Values at the end of this block start the next
+    m_blockVals = m_lastVals;
+    m_blockValid = m_lastValid;
+    m_times.clear();
+    m_blockBytes = 0;
+}
+
+//=============================================================================
+// Decl
+
+void VerilatedVbt::declare(vluint32_t code, const char* name, int kind, bool array,
+                           int arraynum, int msb, int lsb) {
+    const int bits = ((msb > lsb) ? (msb - lsb) : (lsb - msb)) + 1;
+
+    const bool traced = VerilatedTrace<VerilatedVbt>::declCode(code, name, bits, false);
+
+    if (m_columns.size() < nextCode()) m_columns.resize(nextCode());
+    if (!traced) return;  // Filtered out at runtime
+    m_columns[code].m_declared = true;
+    m_columns[code].m_bytes = VerilatedVbtFormat::valueBytes(bits, kind);
+
+    // Hierarchy as space separated scopes, as scope escapes may differ by caller
+    std::string nameasstr = name;
+    if (!moduleName().empty()) nameasstr = moduleName() + scopeEscape() + nameasstr;
+    std::string hiername;
+    for (const char* cp = nameasstr.c_str(); *cp; ++cp) {
+        hiername += isScopeEscape(*cp) ? ' ' : *cp;
+    }
+
+    vbtPutU32(m_header, code);
+    vbtPutU32(m_header, bits);
+    m_header += static_cast<char>(kind);
+    vbtPutU32(m_header, msb);
+    vbtPutU32(m_header, lsb);
+    vbtPutU32(m_header, array ? arraynum : -1);
+    vbtPutU32(m_header, hiername.size());
+    m_header += hiername;
+    ++m_headerSigs;
+}
+
+void VerilatedVbt::declBit(vluint32_t code, const char* name, bool array, int arraynum) {
+    declare(code, name, VerilatedVbtFormat::BIT, array, arraynum, 0, 0);
+}
+void VerilatedVbt::declBus(vluint32_t code, const char* name, bool array, int arraynum, int msb,
+                           int lsb) {
+    declare(code, name, VerilatedVbtFormat::BUS, array, arraynum, msb, lsb);
+}
+void VerilatedVbt::declQuad(vluint32_t code, const char* name, bool array, int arraynum, int msb,
+                            int lsb) {
+    declare(code, name, VerilatedVbtFormat::BUS, array, arraynum, msb, lsb);
+}
+void VerilatedVbt::declArray(vluint32_t code, const char* name, bool array, int arraynum, int msb,
+                             int lsb) {
+    declare(code, name, VerilatedVbtFormat::BUS, array, arraynum, msb, lsb);
+}
+void VerilatedVbt::declFloat(vluint32_t code, const char* name, bool array, int arraynum) {
+    declare(code, name, VerilatedVbtFormat::FLOAT, array, arraynum, 31, 0);
+}
+void VerilatedVbt::declDouble(vluint32_t code, const char* name, bool array, int arraynum) {
+    declare(code, name, VerilatedVbtFormat::DOUBLE, array, arraynum, 63, 0);
+}
+
+// Note: emit* are only ever called from one place (full* in
+// verilated_trace_imp.cpp, which is included in this file at the top),
+// so always inline them.
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitValue(vluint32_t code, const void* valuep) {
+    Column& col = m_columns[code];
+    const vluint32_t index = m_times.size() - 1;
+    vluint32_t delta = index - col.m_lastIndex;
+    col.m_lastIndex = index;
+    // Varint time index delta, then the value
+    const size_t pos = col.m_data.size();
+    col.m_data.resize(pos + 5 + col.m_bytes);
+    char* wp = &col.m_data[pos];
+    while (delta >= 0x80) {
+        *wp++ = static_cast<char>(delta | 0x80);
+        delta >>= 7;
+    }
+    *wp++ = static_cast<char>(delta);
+    std::memcpy(wp, valuep, col.m_bytes);
+    wp += col.m_bytes;
+    col.m_data.resize(wp - &col.m_data[0]);
+    m_blockBytes += wp - &col.m_data[pos];
+    std::memcpy(&m_lastVals[code * sizeof(EData)], valuep, col.m_bytes);
+    m_lastValid[code] = true;
+}
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitBit(vluint32_t code, CData newval) { emitValue(code, &newval); }
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitCData(vluint32_t code, CData newval, int) { emitValue(code, &newval); }
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitSData(vluint32_t code, SData newval, int) { emitValue(code, &newval); }
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitIData(vluint32_t code, IData newval, int) { emitValue(code, &newval); }
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitQData(vluint32_t code, QData newval, int) { emitValue(code, &newval); }
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitWData(vluint32_t code, const WData* newvalp, int) {
+    emitValue(code, newvalp);
+}
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitFloat(vluint32_t code, float newval) { emitValue(code, &newval); }
+
+VL_ATTR_ALWINLINE
+void VerilatedVbt::emitDouble(vluint32_t code, double newval) { emitValue(code, &newval); }
@@ -0,0 +1,248 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2001-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief C++ Tracing in Verilator Binary Trace (VBT) Format
+///
+/// VBT is a simple columnar format designed to be written as fast as
+/// possible.  Rather than interleaving all signals in time order, value
+/// changes are buffered per signal, and written as LZ4 compressed columns a
+/// block at a time.  See verilated_vbt_reader.h for reading these files
+/// back, and for conversion to VCD or FST.
+///
+/// All numbers are in host byte order.  The file consists of:
+///
+///   Magic "VLVBT01\n", then records, each a byte type and 64-bit length:
+///   HEADER  Timescale, then per signal its code, bits, kind, msb, lsb,
+///           array index or -1, and space separated hierarchical name.
+///   BLOCK   First and last time, number of times and columns, the column
+///           directory of code, raw size, compressed size and offset, then
+///           LZ4 compressed times table and columns.  A column starts with
+///           a flag and the value at the start of the block if it had one,
+///           then each change as a varint time index delta and value.
+///   INDEX   Offset and first/last time of each block, used for random
+///           access.  The file ends with the index offset and "VLVBTEND".
+///
+//=============================================================================
+
+#ifndef _VERILATED_VBT_C_H_
+#define _VERILATED_VBT_C_H_ 1
+
+#include "verilated.h"
+#include "verilated_trace.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//=============================================================================
+// VerilatedVbtFormat
+/// Constants shared by the VBT writer and reader
+
+class VerilatedVbtFormat {
+public:
+    static const char* magic() { return "VLVBT01\n"; }
+    static const char* endMagic() { return "VLVBTEND"; }
+    enum RecordType { HEADER = 'H', BLOCK = 'B', INDEX = 'I' };
+    enum Kind { BIT = 0, BUS = 1, FLOAT = 2, DOUBLE = 3 };
+    /// Bytes a value of the given signal occupies in a column
+    static size_t valueBytes(vluint32_t bits, int kind) {
+        if (kind == FLOAT) return 4;
+        if (kind == DOUBLE) return 8;
+        if (bits <= 8) return 1;
+        if (bits <= 16) return 2;
+        if (bits <= 32) return 4;
+        if (bits <= 64) return 8;
+        return VL_WORDS_I(bits) * sizeof(EData);
+    }
+};
+
+//=============================================================================
+// VerilatedVbt
+/// Base class to create a Verilator VBT dump
+/// This is an internally used class - see VerilatedVbtC for what to call from applications
+
+class VerilatedVbt : public VerilatedTrace<VerilatedVbt> {
+private:
+    // Give the superclass access to private bits (to avoid virtual functions)
+    friend class VerilatedTrace<VerilatedVbt>;
+
+    //=========================================================================
+    // VBT specific internals
+
+    struct Column {
+        std::vector<char> m_data;  ///< Changes in the current block
+        vluint32_t m_lastIndex;  ///< Time index of the last change in the block
+        vluint32_t m_bytes;  ///< Bytes per value
+        bool m_declared;  ///< Code is the first word of a declared signal
+        Column()
+            : m_lastIndex(0)
+            , m_bytes(0)
+            , m_declared(false) {}
+    };
+    struct IndexEntry {
+        vluint64_t m_offset;  ///< File offset of the block record
+        vluint64_t m_firstTime;  ///< First time in the block
+        vluint64_t m_lastTime;  ///< Last time in the block
+    };
+
+    std::FILE* m_fp;  ///< File we're writing to
+    vluint64_t m_wroteBytes;  ///< Bytes written to the file
+    std::string m_header;  ///< Signal declarations, written once open
+    vluint32_t m_headerSigs;  ///< Number of entries in m_header
+    std::vector<Column> m_columns;  ///< Per code change data
+    std::vector<char> m_lastVals;  ///< Most recent value, 4 bytes per code
+    std::vector<char> m_blockVals;  ///< Values at start of current block
+    std::vector<bool> m_lastValid;  ///< Code has a value in m_lastVals
+    std::vector<bool> m_blockValid;  ///< Code has a value in m_blockVals
+    std::vector<vluint64_t> m_times;  ///< Times in the current block
+    std::vector<IndexEntry> m_index;  ///< Blocks written so far
+    size_t m_blockBytes;  ///< Bytes of change data in the current block
+    size_t m_blockSize;  ///< Block size to write columns at
+
+    void declare(vluint32_t code, const char* name, int kind, bool array, int arraynum, int msb,
+                 int lsb);
+    void writeRecord(char type, const std::string& payload);
+    void writeBlock();
+    inline void emitValue(vluint32_t code, const void* valuep);
+
+    // CONSTRUCTORS
+    VL_UNCOPYABLE(VerilatedVbt);
+
+protected:
+    //=========================================================================
+    // Implementation of VerilatedTrace interface
+
+    // Implementations of protected virtual methods for VerilatedTrace
+    void emitTimeChange(vluint64_t timeui) VL_OVERRIDE;
+
+    // Hooks called from VerilatedTrace
+    bool preFullDump() VL_OVERRIDE { return isOpen(); }
+    bool preChangeDump() VL_OVERRIDE { return isOpen(); }
+
+    // Implementations of duck-typed methods for VerilatedTrace. These are
+    // called from only one place (namely full*) so always inline them.
+    inline void emitBit(vluint32_t code, CData newval);
+    inline void emitCData(vluint32_t code, CData newval, int bits);
+    inline void emitSData(vluint32_t code, SData newval, int bits);
+    inline void emitIData(vluint32_t code, IData newval, int bits);
+    inline void emitQData(vluint32_t code, QData newval, int bits);
+    inline void emitWData(vluint32_t code, const WData* newvalp, int bits);
+    inline void emitFloat(vluint32_t code, float newval);
+    inline void emitDouble(vluint32_t code, double newval);
+
+public:
+    //=========================================================================
+    // External interface to client code
+
+    VerilatedVbt();
+    ~VerilatedVbt();
+
+    /// Open the file; call isOpen() to see if errors
+    void open(const char* filename) VL_MT_UNSAFE;
+    /// Close the file
+    void close() VL_MT_UNSAFE;
+    /// Flush any remaining data to this file
+    void flush() VL_MT_UNSAFE;
+    /// Is file open?
+    bool isOpen() const { return m_fp != NULL; }
+    /// Set size of change data to buffer before writing a block (bytes)
+    void blockSize(size_t bytes) { m_blockSize = bytes; }
+
+    //=========================================================================
+    // Internal interface to Verilator generated code
+
+    /// Inside dumping routines, declare a signal
+    void declBit(vluint32_t code, const char* name, bool array, int arraynum);
+    void declBus(vluint32_t code, const char* name, bool array, int arraynum, int msb, int lsb);
+    void declQuad(vluint32_t code, const char* name, bool array, int arraynum, int msb, int lsb);
+    void declArray(vluint32_t code, const char* name, bool array, int arraynum, int msb, int lsb);
+    void declFloat(vluint32_t code, const char* name, bool array, int arraynum);
+    void declDouble(vluint32_t code, const char* name, bool array, int arraynum);
+};
+
+// Declare specialization here as it's used in VerilatedVbtC just below
+template <> void VerilatedTrace<VerilatedVbt>::dump(vluint64_t timeui);
+template <> void VerilatedTrace<VerilatedVbt>::set_time_unit(const char* unitp);
+template <> void VerilatedTrace<VerilatedVbt>::set_time_unit(const std::string& unit);
+template <> void VerilatedTrace<VerilatedVbt>::set_time_resolution(const char* unitp);
+template <> void VerilatedTrace<VerilatedVbt>::set_time_resolution(const std::string& unit);
+template <> void VerilatedTrace<VerilatedVbt>::windowLimits(size_t steps, size_t bytes);
+template <> void VerilatedTrace<VerilatedVbt>::flushWindow();
+
+//=============================================================================
+// VerilatedVbtC
+/// Create a VBT dump file in C standalone (no SystemC) simulations.
+/// Thread safety: Unless otherwise indicated, every function is VL_MT_UNSAFE_ONE
+
+class VerilatedVbtC {
+    VerilatedVbt m_sptrace;  ///< Trace file being created
+
+    // CONSTRUCTORS
+    VL_UNCOPYABLE(VerilatedVbtC);
+
+public:
+    VerilatedVbtC() {}
+    ~VerilatedVbtC() { close(); }
+    /// Routines can only be called from one thread; allow next call from different thread
+    void changeThread() { spTrace()->changeThread(); }
+
+    // ACCESSORS
+    /// Is file open?
+    bool isOpen() const { return m_sptrace.isOpen(); }
+    // METHODS
+    /// Open a new VBT file
+    void open(const char* filename) VL_MT_UNSAFE_ONE { m_sptrace.open(filename); }
+    /// Close dump
+    void close() VL_MT_UNSAFE_ONE { m_sptrace.close(); }
+    /// Flush dump
+    void flush() VL_MT_UNSAFE_ONE { m_sptrace.flush(); }
+    /// Keep only the last 'steps' time steps in memory, writing them on flushWindow()
+    void windowSteps(size_t steps) VL_MT_UNSAFE_ONE { m_sptrace.windowSteps(steps); }
+    /// Keep only about the last 'bytes' of changes in memory, writing them on flushWindow()
+    void windowBytes(size_t bytes) VL_MT_UNSAFE_ONE { m_sptrace.windowBytes(bytes); }
+    /// Write the kept window of changes to the file
+    void flushWindow() VL_MT_UNSAFE_ONE { m_sptrace.flushWindow(); }
+    /// Trace only signals matching a '*' and '?' pattern, call before open()
+    void filterGlob(const char* patternp) VL_MT_UNSAFE_ONE { m_sptrace.filterGlob(patternp); }
+    /// Trace only signals under at most 'levels' scopes, call before open()
+    void filterDepth(int levels) VL_MT_UNSAFE_ONE { m_sptrace.filterDepth(levels); }
+    /// Trace only signals at most 'bits' wide, call before open()
+    void filterMaxWidth(int bits) VL_MT_UNSAFE_ONE { m_sptrace.filterMaxWidth(bits); }
+    /// Count changes per signal, writing a ranked report on close(), call before open()
+    void toggleReport(const char* filenamep, bool waves = true) VL_MT_UNSAFE_ONE {
+        m_sptrace.toggleReport(filenamep, waves);
+    }
+    /// Add the bytes used by tracing to 'usage'
+    void memoryUsage(VerilatedMemoryUsage& usage) const { m_sptrace.memoryUsage(usage); }
+    /// Write one cycle of dump data
+    void dump(vluint64_t timeui) { m_sptrace.dump(timeui); }
+    /// Write one cycle of dump data - backward compatible and to reduce
+    /// conversion warnings.  It's better to use a vluint64_t time instead.
+    void dump(double timestamp) { dump(static_cast<vluint64_t>(timestamp)); }
+    void dump(vluint32_t timestamp) { dump(static_cast<vluint64_t>(timestamp)); }
+    void dump(int timestamp) { dump(static_cast<vluint64_t>(timestamp)); }
+    /// Set time units (s/ms, defaults to ns)
+    /// For Verilated models, these propage from the Verilated default --timeunit
+    void set_time_unit(const char* unitp) { m_sptrace.set_time_unit(unitp); }
+    void set_time_unit(const std::string& unit) { m_sptrace.set_time_unit(unit); }
+    /// Set time resolution (s/ms, defaults to ns)
+    /// For Verilated models, these propage from the Verilated default --timeunit
+    void set_time_resolution(const char* unitp) { m_sptrace.set_time_resolution(unitp); }
+    void set_time_resolution(const std::string& unit) { m_sptrace.set_time_resolution(unit); }
+
+    /// Internal class access
+    inline VerilatedVbt* spTrace() { return &m_sptrace; };
+};
+
+#endif  // guard
@@ -0,0 +1,48 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2001-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief Convert Verilator Binary Trace (VBT) files to VCD or FST
+///
+/// Build by compiling with verilated_vbt_reader.cpp and linking with -lz,
+/// from the $VERILATOR_ROOT/include directory:
+///    c++ -I. verilated_vbt_convert.cpp verilated_vbt_reader.cpp -lz -o verilated_vbt_convert
+///
+/// Usage:
+///    verilated_vbt_convert <input.vbt> <output.vcd|output.fst>
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated_vbt_reader.h"
+
+#include <cstdio>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s <input.vbt> <output.vcd|output.fst>\n", argv[0]);
+        return 1;
+    }
+    const std::string outname = argv[2];
+    const bool fst = outname.size() > 4 && outname.compare(outname.size() - 4, 4, ".fst") == 0;
+
+    VerilatedVbtReader reader;
+    bool ok = reader.open(argv[1]);
+    if (ok) ok = fst ? reader.writeFst(outname) : reader.writeVcd(outname);
+    if (!ok) {
+        std::fprintf(stderr, "%%Error: %s\n", reader.error().c_str());
+        return 1;
+    }
+    return 0;
+}
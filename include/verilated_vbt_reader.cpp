@@ -0,0 +1,578 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2001-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief Reader for Verilator Binary Trace (VBT) files
+///
+//=============================================================================
+
+// clang-format off
+
+#define __STDC_LIMIT_MACROS  // UINT64_MAX
+#include "verilatedos.h"
+#include "verilated_vbt_reader.h"
+
+// Include the GTKWave implementation directly
+#define FST_CONFIG_INCLUDE "fst_config.h"
+#include "gtkwave/fastlz.c"
+#include "gtkwave/fstapi.c"
+#include "gtkwave/lz4.c"
+
+#include <algorithm>
+#include <cstring>
+
+// clang-format on
+
+//=============================================================================
+// Parsing helpers
+
+static inline vluint32_t vbtGetU32(const char*& rp) {
+    vluint32_t value;
+    std::memcpy(&value, rp, sizeof(value));
+    rp += sizeof(value);
+    return value;
+}
+static inline vluint64_t vbtGetU64(const char*& rp) {
+    vluint64_t value;
+    std::memcpy(&value, rp, sizeof(value));
+    rp += sizeof(value);
+    return value;
+}
+static inline vluint32_t vbtGetVarint(const char*& rp) {
+    vluint32_t value = 0;
+    int shift = 0;
+    while (*rp & 0x80) {
+        value |= static_cast<vluint32_t>(*rp++ & 0x7f) << shift;
+        shift += 7;
+    }
+    value |= static_cast<vluint32_t>(*rp++ & 0x7f) << shift;
+    return value;
+}
+
+// Signals sorted for declaration as a hierarchy, keyed VCD style by space
+// separated scopes, then a tab, then the signal name
+typedef std::multimap<std::string, const VerilatedVbtReader::Signal*> VbtNameMap;
+
+static void vbtNameMap(const std::vector<VerilatedVbtReader::Signal>& signals,
+                       VbtNameMap& nameMap) {
+    for (std::vector<VerilatedVbtReader::Signal>::const_iterator it = signals.begin();
+         it != signals.end(); ++it) {
+        std::string key = it->m_name;
+        const size_t pos = key.rfind(' ');
+        if (pos == std::string::npos) {
+            key = "\t" + key;
+        } else {
+            key[pos] = '\t';
+        }
+        if (it->m_arraynum >= 0) {
+            char buf[20];
+            sprintf(buf, "(%d)", it->m_arraynum);
+            key += buf;
+        }
+        nameMap.insert(std::make_pair(key, &*it));
+    }
+}
+
+// Split a name map key into its scopes and signal name
+static void vbtSplitKey(const std::string& key, std::vector<std::string>& scopes,
+                        std::string& basename) {
+    scopes.clear();
+    const size_t tab = key.find('\t');
+    std::string scope;
+    for (size_t i = 0; i < tab; ++i) {
+        if (key[i] == ' ') {
+            scopes.push_back(scope);
+            scope.clear();
+        } else {
+            scope += key[i];
+        }
+    }
+    if (tab) scopes.push_back(scope);
+    basename = key.substr(tab + 1);
+}
+
+//=============================================================================
+// VerilatedVbtReader
+
+VerilatedVbtReader::VerilatedVbtReader()
+    : m_fp(NULL) {}
+
+bool VerilatedVbtReader::fail(const std::string& msg) {
+    m_error = msg;
+    return false;
+}
+
+bool VerilatedVbtReader::readAt(vluint64_t offset, void* datap, size_t bytes) {
+    if (std::fseek(m_fp, offset, SEEK_SET) != 0) return fail("Seek failed");
+    if (std::fread(datap, 1, bytes, m_fp) != bytes) return fail("Unexpected end of file");
+    return true;
+}
+
+bool VerilatedVbtReader::open(const std::string& filename) {
+    close();
+    m_fp = std::fopen(filename.c_str(), "rb");
+    if (!m_fp) return fail("Cannot open " + filename);
+    std::fseek(m_fp, 0, SEEK_END);
+    const vluint64_t fileBytes = std::ftell(m_fp);
+
+    char magic[8];
+    if (!readAt(0, magic, 8) || std::memcmp(magic, VerilatedVbtFormat::magic(), 8) != 0) {
+        return fail("Not a VBT file: " + filename);
+    }
+
+    // Header
+    char head[9];
+    if (!readAt(8, head, 9) || head[0] != VerilatedVbtFormat::HEADER) {
+        return fail("Missing VBT header: " + filename);
+    }
+    const char* hp = head + 1;
+    const vluint64_t len = vbtGetU64(hp);
+    std::string payload(len, '\0');
+    if (len && !readAt(8 + 9, &payload[0], len)) return false;
+    const char* rp = payload.data();
+    const vluint32_t tsLen = vbtGetU32(rp);
+    m_timescale.assign(rp, tsLen);
+    rp += tsLen;
+    const vluint32_t nsigs = vbtGetU32(rp);
+    m_signals.resize(nsigs);
+    for (vluint32_t i = 0; i < nsigs; ++i) {
+        Signal& sig = m_signals[i];
+        sig.m_code = vbtGetU32(rp);
+        sig.m_bits = vbtGetU32(rp);
+        sig.m_kind = *rp++;
+        sig.m_msb = vbtGetU32(rp);
+        sig.m_lsb = vbtGetU32(rp);
+        sig.m_arraynum = vbtGetU32(rp);
+        const vluint32_t nameLen = vbtGetU32(rp);
+        sig.m_name.assign(rp, nameLen);
+        rp += nameLen;
+    }
+
+    // Blocks, from the index if the file was closed, else by scanning
+    if (!readIndex(fileBytes)) {
+        m_blocks.clear();
+        if (!scanBlocks(8 + 9 + len, fileBytes)) return false;
+    }
+    m_error = "";
+    return true;
+}
+
+void VerilatedVbtReader::close() {
+    if (m_fp) std::fclose(m_fp);
+    m_fp = NULL;
+    m_signals.clear();
+    m_blocks.clear();
+    m_timescale = "";
+}
+
+bool VerilatedVbtReader::readIndex(vluint64_t fileBytes) {
+    char trailer[16];
+    if (fileBytes < 16 || !readAt(fileBytes - 16, trailer, 16)) return false;
+    if (std::memcmp(trailer + 8, VerilatedVbtFormat::endMagic(), 8) != 0) return false;
+    const char* tp = trailer;
+    const vluint64_t indexOffset = vbtGetU64(tp);
+    char head[9];
+    if (!readAt(indexOffset, head, 9) || head[0] != VerilatedVbtFormat::INDEX) return false;
+    const char* hp = head + 1;
+    std::string payload(vbtGetU64(hp), '\0');
+    if (!readAt(indexOffset + 9, &payload[0], payload.size())) return false;
+    const char* rp = payload.data();
+    const vluint32_t nblocks = vbtGetU32(rp);
+    m_blocks.resize(nblocks);
+    for (vluint32_t i = 0; i < nblocks; ++i) {
+        m_blocks[i].m_offset = vbtGetU64(rp);
+        m_blocks[i].m_firstTime = vbtGetU64(rp);
+        m_blocks[i].m_lastTime = vbtGetU64(rp);
+    }
+    return true;
+}
+
+bool VerilatedVbtReader::scanBlocks(vluint64_t offset, vluint64_t fileBytes) {
+    // Writer did not close the file, so recover all complete blocks
+    while (offset + 9 + 16 <= fileBytes) {
+        char head[9 + 16];
+        if (!readAt(offset, head, sizeof(head))) return false;
+        const char* rp = head + 1;
+        const vluint64_t len = vbtGetU64(rp);
+        if (offset + 9 + len > fileBytes) break;  // Truncated
+        if (head[0] == VerilatedVbtFormat::BLOCK) {
+            Block block;
+            block.m_offset = offset;
+            block.m_firstTime = vbtGetU64(rp);
+            block.m_lastTime = vbtGetU64(rp);
+            m_blocks.push_back(block);
+        } else if (head[0] != VerilatedVbtFormat::INDEX) {
+            return fail("Corrupt VBT record");
+        }
+        offset += 9 + len;
+    }
+    return true;
+}
+
+bool VerilatedVbtReader::readDir(const Block& block, BlockDir& dir) {
+    const vluint64_t payloadOffset = block.m_offset + 9;
+    char head[32];
+    if (!readAt(payloadOffset, head, sizeof(head))) return false;
+    const char* rp = head + 16;
+    const vluint32_t ntimes = vbtGetU32(rp);
+    const vluint32_t ncols = vbtGetU32(rp);
+    Column times;
+    times.m_raw = vbtGetU32(rp);
+    times.m_comp = vbtGetU32(rp);
+    const size_t entryBytes = 3 * sizeof(vluint32_t) + sizeof(vluint64_t);
+    times.m_offset = payloadOffset + sizeof(head) + ncols * entryBytes;
+    std::string entries(ncols * entryBytes, '\0');
+    if (ncols && !readAt(payloadOffset + sizeof(head), &entries[0], entries.size())) {
+        return false;
+    }
+    dir.m_columns.clear();
+    rp = entries.data();
+    for (vluint32_t i = 0; i < ncols; ++i) {
+        const vluint32_t code = vbtGetU32(rp);
+        Column& column = dir.m_columns[code];
+        column.m_raw = vbtGetU32(rp);
+        column.m_comp = vbtGetU32(rp);
+        column.m_offset = payloadOffset + vbtGetU64(rp);
+    }
+    std::string raw;
+    if (!readColumn(times, raw)) return false;
+    if (raw.size() != ntimes * sizeof(vluint64_t)) return fail("Corrupt VBT times");
+    dir.m_times.resize(ntimes);
+    if (ntimes) std::memcpy(&dir.m_times[0], raw.data(), raw.size());
+    return true;
+}
+
+bool VerilatedVbtReader::readColumn(const Column& column, std::string& raw) {
+    std::string comp(column.m_comp, '\0');
+    if (column.m_comp && !readAt(column.m_offset, &comp[0], comp.size())) return false;
+    if (column.m_comp == column.m_raw) {  // Stored uncompressed
+        raw.swap(comp);
+        return true;
+    }
+    raw.resize(column.m_raw);
+    const int got = LZ4_decompress_safe(comp.data(), &raw[0], comp.size(), raw.size());
+    if (got != static_cast<int>(column.m_raw)) return fail("Corrupt VBT column");
+    return true;
+}
+
+const VerilatedVbtReader::Signal* VerilatedVbtReader::findSignal(const std::string& name) const {
+    std::string hiername = name;
+    std::replace(hiername.begin(), hiername.end(), '.', ' ');
+    for (std::vector<Signal>::const_iterator it = m_signals.begin(); it != m_signals.end();
+         ++it) {
+        if (it->m_name == hiername) return &*it;
+    }
+    return NULL;
+}
+
+bool VerilatedVbtReader::readChanges(const Signal& sig, vluint64_t startTime,
+                                     vluint64_t endTime, std::vector<Change>& changes) {
+    changes.clear();
+    const size_t bytes = sig.valueBytes();
+    Change current;
+    bool haveCurrent = false;
+    bool startDone = false;
+    for (std::vector<Block>::const_iterator it = m_blocks.begin(); it != m_blocks.end(); ++it) {
+        if (it->m_lastTime < startTime) continue;
+        if (it->m_firstTime > endTime) break;
+        BlockDir dir;
+        if (!readDir(*it, dir)) return false;
+        ColumnMap::const_iterator cit = dir.m_columns.find(sig.m_code);
+        if (cit == dir.m_columns.end()) continue;  // Never had a value
+        std::string raw;
+        if (!readColumn(cit->second, raw)) return false;
+        const char* rp = raw.data();
+        const char* const endp = rp + raw.size();
+        if (*rp++) {  // Value at start of block
+            current.m_value.assign(rp, bytes);
+            haveCurrent = true;
+            rp += bytes;
+        }
+        vluint32_t index = 0;
+        while (rp < endp) {
+            index += vbtGetVarint(rp);
+            const vluint64_t time = dir.m_times[index];
+            if (time > endTime) break;
+            if (time <= startTime) {
+                current.m_value.assign(rp, bytes);
+                haveCurrent = true;
+            } else {
+                if (!startDone && haveCurrent) {
+                    current.m_time = startTime;
+                    changes.push_back(current);
+                }
+                startDone = true;
+                Change change;
+                change.m_time = time;
+                change.m_value.assign(rp, bytes);
+                changes.push_back(change);
+            }
+            rp += bytes;
+        }
+    }
+    if (!startDone && haveCurrent) {
+        current.m_time = startTime;
+        changes.push_back(current);
+    }
+    return true;
+}
+
+struct VerilatedVbtEvent {
+    vluint32_t m_index;  ///< Time index
+    const VerilatedVbtReader::Signal* m_sigp;  ///< Signal changing
+    const char* m_valuep;  ///< Value
+    bool operator<(const VerilatedVbtEvent& rhs) const { return m_index < rhs.m_index; }
+};
+
+bool VerilatedVbtReader::forEachChange(Visitor& visitor) {
+    // One signal per code, changes are recorded once for all aliases
+    std::map<vluint32_t, const Signal*> codeSigs;
+    for (std::vector<Signal>::const_iterator it = m_signals.begin(); it != m_signals.end();
+         ++it) {
+        codeSigs.insert(std::make_pair(it->m_code, &*it));
+    }
+    for (std::vector<Block>::const_iterator it = m_blocks.begin(); it != m_blocks.end(); ++it) {
+        BlockDir dir;
+        if (!readDir(*it, dir)) return false;
+        std::vector<std::string> raws(dir.m_columns.size());
+        std::vector<VerilatedVbtEvent> events;
+        size_t col = 0;
+        for (ColumnMap::const_iterator cit = dir.m_columns.begin(); cit != dir.m_columns.end();
+             ++cit, ++col) {
+            std::map<vluint32_t, const Signal*>::const_iterator sit = codeSigs.find(cit->first);
+            if (sit == codeSigs.end()) return fail("Corrupt VBT column code");
+            if (!readColumn(cit->second, raws[col])) return false;
+            const Signal* const sigp = sit->second;
+            const size_t bytes = sigp->valueBytes();
+            const char* rp = raws[col].data();
+            const char* const endp = rp + raws[col].size();
+            if (*rp++) rp += bytes;  // Value at start of block was already visited
+            vluint32_t index = 0;
+            while (rp < endp) {
+                index += vbtGetVarint(rp);
+                VerilatedVbtEvent event;
+                event.m_index = index;
+                event.m_sigp = sigp;
+                event.m_valuep = rp;
+                events.push_back(event);
+                rp += bytes;
+            }
+        }
+        std::stable_sort(events.begin(), events.end());
+        std::vector<VerilatedVbtEvent>::const_iterator eit = events.begin();
+        for (vluint32_t index = 0; index < dir.m_times.size(); ++index) {
+            visitor.time(dir.m_times[index]);
+            for (; eit != events.end() && eit->m_index == index; ++eit) {
+                visitor.change(*eit->m_sigp, eit->m_valuep);
+            }
+        }
+    }
+    return true;
+}
+
+std::string VerilatedVbtReader::binaryValue(const Signal& sig, const char* valuep) {
+    std::string out(sig.m_bits, '0');
+    const size_t bytes = sig.valueBytes();
+    if (bytes <= sizeof(vluint64_t)) {
+        vluint64_t value = 0;
+        if (bytes == 1) {
+            vluint8_t v;
+            std::memcpy(&v, valuep, 1);
+            value = v;
+        } else if (bytes == 2) {
+            vluint16_t v;
+            std::memcpy(&v, valuep, 2);
+            value = v;
+        } else if (bytes == 4) {
+            vluint32_t v;
+            std::memcpy(&v, valuep, 4);
+            value = v;
+        } else {
+            std::memcpy(&value, valuep, 8);
+        }
+        for (vluint32_t i = 0; i < sig.m_bits; ++i) {
+            if ((value >> i) & 1) out[sig.m_bits - 1 - i] = '1';
+        }
+    } else {
+        std::vector<EData> words(VL_WORDS_I(sig.m_bits));
+        std::memcpy(&words[0], valuep, bytes);
+        for (vluint32_t i = 0; i < sig.m_bits; ++i) {
+            if (VL_BITISSET_E(words[VL_BITWORD_E(i)], i)) out[sig.m_bits - 1 - i] = '1';
+        }
+    }
+    return out;
+}
+
+double VerilatedVbtReader::realValue(const Signal& sig, const char* valuep) {
+    if (sig.m_kind == VerilatedVbtFormat::FLOAT) {
+        float value;
+        std::memcpy(&value, valuep, sizeof(value));
+        return value;
+    }
+    double value;
+    std::memcpy(&value, valuep, sizeof(value));
+    return value;
+}
+
+//=============================================================================
+// Conversion
+
+// Write the VCD identifier of a code, as VerilatedVcd does
+static std::string vbtVcdCode(vluint32_t code) {
+    std::string out(1, static_cast<char>('!' + code % 94));
+    code /= 94;
+    while (code) {
+        code--;
+        out += static_cast<char>('!' + code % 94);
+        code /= 94;
+    }
+    return out;
+}
+
+class VerilatedVbtVcdVisitor : public VerilatedVbtReader::Visitor {
+    std::FILE* m_fp;
+
+public:
+    explicit VerilatedVbtVcdVisitor(std::FILE* fp)
+        : m_fp(fp) {}
+    virtual void time(vluint64_t timeui) VL_OVERRIDE {
+        std::fprintf(m_fp, "#%" VL_PRI64 "u\n", timeui);
+    }
+    virtual void change(const VerilatedVbtReader::Signal& sig, const char* valuep) VL_OVERRIDE {
+        const std::string code = vbtVcdCode(sig.m_code);
+        if (sig.m_kind == VerilatedVbtFormat::FLOAT || sig.m_kind == VerilatedVbtFormat::DOUBLE) {
+            std::fprintf(m_fp, "r%.16g %s\n", VerilatedVbtReader::realValue(sig, valuep),
+                         code.c_str());
+        } else if (sig.m_kind == VerilatedVbtFormat::BIT) {
+            std::fprintf(m_fp, "%s%s\n", VerilatedVbtReader::binaryValue(sig, valuep).c_str(),
+                         code.c_str());
+        } else {
+            std::fprintf(m_fp, "b%s %s\n", VerilatedVbtReader::binaryValue(sig, valuep).c_str(),
+                         code.c_str());
+        }
+    }
+};
+
+bool VerilatedVbtReader::writeVcd(const std::string& filename) {
+    std::FILE* fp = std::fopen(filename.c_str(), "w");
+    if (!fp) return fail("Cannot write " + filename);
+    std::fprintf(fp, "$version Generated by VerilatedVbtReader $end\n");
+    std::fprintf(fp, "$timescale %s $end\n\n", m_timescale.c_str());
+
+    VbtNameMap nameMap;
+    vbtNameMap(m_signals, nameMap);
+    std::vector<std::string> curScopes;
+    std::vector<std::string> scopes;
+    std::string basename;
+    for (VbtNameMap::const_iterator it = nameMap.begin(); it != nameMap.end(); ++it) {
+        vbtSplitKey(it->first, scopes, basename);
+        size_t common = 0;
+        while (common < curScopes.size() && common < scopes.size()
+               && curScopes[common] == scopes[common]) {
+            ++common;
+        }
+        for (; curScopes.size() > common; curScopes.pop_back()) {
+            std::fprintf(fp, "%*s$upscope $end\n", static_cast<int>(curScopes.size()), "");
+        }
+        for (; curScopes.size() < scopes.size();) {
+            std::string scope = scopes[curScopes.size()];
+            std::replace(scope.begin(), scope.end(), '[', '(');
+            std::replace(scope.begin(), scope.end(), ']', ')');
+            curScopes.push_back(scopes[curScopes.size()]);
+            std::fprintf(fp, "%*s$scope module %s $end\n", static_cast<int>(curScopes.size()),
+                         "", scope.c_str());
+        }
+        const Signal& sig = *it->second;
+        const bool real
+            = sig.m_kind == VerilatedVbtFormat::FLOAT || sig.m_kind == VerilatedVbtFormat::DOUBLE;
+        std::fprintf(fp, "%*s$var %s %2u %s %s", static_cast<int>(curScopes.size() + 1), "",
+                     real ? "real" : "wire", sig.m_bits, vbtVcdCode(sig.m_code).c_str(),
+                     basename.c_str());
+        if (sig.m_kind == VerilatedVbtFormat::BUS) {
+            std::fprintf(fp, " [%d:%d]", sig.m_msb, sig.m_lsb);
+        }
+        std::fprintf(fp, " $end\n");
+    }
+    for (; !curScopes.empty(); curScopes.pop_back()) {
+        std::fprintf(fp, "%*s$upscope $end\n", static_cast<int>(curScopes.size()), "");
+    }
+    std::fprintf(fp, "$enddefinitions $end\n\n\n");
+
+    VerilatedVbtVcdVisitor visitor(fp);
+    const bool ok = forEachChange(visitor);
+    std::fclose(fp);
+    return ok;
+}
+
+class VerilatedVbtFstVisitor : public VerilatedVbtReader::Visitor {
+    void* m_fst;
+    std::map<vluint32_t, fstHandle>& m_handles;
+
+public:
+    VerilatedVbtFstVisitor(void* fst, std::map<vluint32_t, fstHandle>& handles)
+        : m_fst(fst)
+        , m_handles(handles) {}
+    virtual void time(vluint64_t timeui) VL_OVERRIDE { fstWriterEmitTimeChange(m_fst, timeui); }
+    virtual void change(const VerilatedVbtReader::Signal& sig, const char* valuep) VL_OVERRIDE {
+        const fstHandle handle = m_handles[sig.m_code];
+        if (sig.m_kind == VerilatedVbtFormat::FLOAT || sig.m_kind == VerilatedVbtFormat::DOUBLE) {
+            const double value = VerilatedVbtReader::realValue(sig, valuep);
+            fstWriterEmitValueChange(m_fst, handle, &value);
+        } else {
+            fstWriterEmitValueChange(m_fst, handle,
+                                     VerilatedVbtReader::binaryValue(sig, valuep).c_str());
+        }
+    }
+};
+
+bool VerilatedVbtReader::writeFst(const std::string& filename) {
+    void* fst = fstWriterCreate(filename.c_str(), 1);
+    if (!fst) return fail("Cannot write " + filename);
+    fstWriterSetPackType(fst, FST_WR_PT_LZ4);
+    fstWriterSetTimescaleFromString(fst, m_timescale.c_str());
+
+    VbtNameMap nameMap;
+    vbtNameMap(m_signals, nameMap);
+    std::map<vluint32_t, fstHandle> handles;
+    std::vector<std::string> curScopes;
+    std::vector<std::string> scopes;
+    std::string basename;
+    for (VbtNameMap::const_iterator it = nameMap.begin(); it != nameMap.end(); ++it) {
+        vbtSplitKey(it->first, scopes, basename);
+        size_t common = 0;
+        while (common < curScopes.size() && common < scopes.size()
+               && curScopes[common] == scopes[common]) {
+            ++common;
+        }
+        for (; curScopes.size() > common; curScopes.pop_back()) fstWriterSetUpscope(fst);
+        for (; curScopes.size() < scopes.size();) {
+            curScopes.push_back(scopes[curScopes.size()]);
+            fstWriterSetScope(fst, FST_ST_VCD_SCOPE, curScopes.back().c_str(), NULL);
+        }
+        const Signal& sig = *it->second;
+        const bool real
+            = sig.m_kind == VerilatedVbtFormat::FLOAT || sig.m_kind == VerilatedVbtFormat::DOUBLE;
+        std::map<vluint32_t, fstHandle>::iterator hit = handles.find(sig.m_code);
+        const fstHandle alias = hit == handles.end() ? 0 : hit->second;
+        const fstHandle handle
+            = fstWriterCreateVar(fst, real ? FST_VT_VCD_REAL : FST_VT_VCD_WIRE, FST_VD_IMPLICIT,
+                                 real ? 64 : sig.m_bits, basename.c_str(), alias);
+        if (!alias) handles[sig.m_code] = handle;
+    }
+    for (; !curScopes.empty(); curScopes.pop_back()) fstWriterSetUpscope(fst);
+
+    VerilatedVbtFstVisitor visitor(fst, handles);
+    const bool ok = forEachChange(visitor);
+    fstWriterClose(fst);
+    return ok;
+}
@@ -0,0 +1,145 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2001-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file
+/// \brief Reader for Verilator Binary Trace (VBT) files
+///
+/// Reads files written by VerilatedVbtC, see verilated_vbt_c.h for the
+/// format.  Changes of individual signals over a time window can be read
+/// without decompressing other signals or other parts of the file, and
+/// whole files can be converted to VCD or FST.  This is a standalone
+/// utility, not part of a Verilated model, and should not be linked with
+/// verilated_fst_c.cpp or verilated_vbt_c.cpp as it includes the GTKWave
+/// sources directly.  See verilated_vbt_convert.cpp for a converter.
+///
+//=============================================================================
+
+#ifndef _VERILATED_VBT_READER_H_
+#define _VERILATED_VBT_READER_H_ 1
+
+#include "verilated_vbt_c.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+//=============================================================================
+// VerilatedVbtReader
+/// Read a VBT file
+
+class VerilatedVbtReader {
+public:
+    // TYPES
+    struct Signal {
+        vluint32_t m_code;  ///< Trace code, shared by aliased signals
+        vluint32_t m_bits;  ///< Width
+        int m_kind;  ///< VerilatedVbtFormat::Kind
+        int m_msb;  ///< Declared range
+        int m_lsb;
+        int m_arraynum;  ///< Array index, or -1 if not an array element
+        std::string m_name;  ///< Hierarchical name, space separated
+        /// Bytes each value occupies
+        size_t valueBytes() const { return VerilatedVbtFormat::valueBytes(m_bits, m_kind); }
+    };
+    struct Change {
+        vluint64_t m_time;  ///< Time of change
+        std::string m_value;  ///< Raw value, see binaryValue() and realValue()
+    };
+    /// Called for each time step and change in time order, see forEachChange()
+    class Visitor {
+    public:
+        virtual ~Visitor() {}
+        virtual void time(vluint64_t timeui) = 0;
+        virtual void change(const Signal& sig, const char* valuep) = 0;
+    };
+
+private:
+    struct Block {
+        vluint64_t m_offset;  ///< File offset of the block record
+        vluint64_t m_firstTime;  ///< First time in the block
+        vluint64_t m_lastTime;  ///< Last time in the block
+    };
+    struct Column {
+        vluint32_t m_raw;  ///< Uncompressed size
+        vluint32_t m_comp;  ///< Compressed size
+        vluint64_t m_offset;  ///< File offset of the data
+    };
+    typedef std::map<vluint32_t, Column> ColumnMap;
+    struct BlockDir {
+        std::vector<vluint64_t> m_times;  ///< Time of each time index
+        ColumnMap m_columns;  ///< Columns by code
+    };
+
+    // MEMBERS
+    std::FILE* m_fp;  ///< File being read
+    std::string m_error;  ///< Last error message
+    std::string m_timescale;  ///< Time resolution as written
+    std::vector<Signal> m_signals;  ///< Declared signals, in declaration order
+    std::vector<Block> m_blocks;  ///< Blocks in time order
+
+    // METHODS
+    bool fail(const std::string& msg);
+    bool readAt(vluint64_t offset, void* datap, size_t bytes);
+    bool readIndex(vluint64_t fileBytes);
+    bool scanBlocks(vluint64_t offset, vluint64_t fileBytes);
+    bool readDir(const Block& block, BlockDir& dir);
+    bool readColumn(const Column& column, std::string& raw);
+
+    // CONSTRUCTORS
+    VL_UNCOPYABLE(VerilatedVbtReader);
+
+public:
+    VerilatedVbtReader();
+    ~VerilatedVbtReader() { close(); }
+
+    // METHODS
+    /// Open a VBT file; returns false and sets error() on failure
+    bool open(const std::string& filename);
+    /// Close the file
+    void close();
+    /// Description of the last failure
+    const std::string& error() const { return m_error; }
+
+    // ACCESSORS
+    /// Time resolution, e.g. "1ps"
+    const std::string& timescale() const { return m_timescale; }
+    /// All declared signals
+    const std::vector<Signal>& signals() const { return m_signals; }
+    /// Find a signal by '.' separated hierarchical name, or NULL
+    const Signal* findSignal(const std::string& name) const;
+    /// First and last dumped time
+    vluint64_t startTime() const { return m_blocks.empty() ? 0 : m_blocks.front().m_firstTime; }
+    vluint64_t endTime() const { return m_blocks.empty() ? 0 : m_blocks.back().m_lastTime; }
+
+    /// Read the changes of one signal from startTime to endTime inclusive.
+    /// The first change is the value in effect at startTime, if any.  Only
+    /// the file blocks covering the window are read, and only this
+    /// signal's column of each is decompressed.
+    bool readChanges(const Signal& sig, vluint64_t startTime, vluint64_t endTime,
+                     std::vector<Change>& changes);
+    /// Call visitor for all time steps and changes, in time order, with
+    /// one of the aliases of each changing signal
+    bool forEachChange(Visitor& visitor);
+
+    /// Convert a raw vector value to binary digits, most significant first
+    static std::string binaryValue(const Signal& sig, const char* valuep);
+    /// Convert a raw real value to a double
+    static double realValue(const Signal& sig, const char* valuep);
+
+    /// Convert the whole file
+    bool writeVcd(const std::string& filename);
+    bool writeFst(const std::string& filename);
+};
+
+#endif  // guard
@@ -22,6 +22,7 @@
 #include "verilatedos.h"
 #include "verilated.h"
 #include "verilated_vcd_c.h"
+#include "verilated_live.h"
 
 #include <algorithm>
 #include <cerrno>
@@ -34,6 +35,11 @@
 #else
 # include <unistd.h>
 #endif
+#ifndef _WIN32
+# include <spawn.h>
+# include <sys/wait.h>
+extern char** environ;
+#endif
 
 #include "verilated_intrinsics.h"
 
@@ -62,6 +68,8 @@
 // cache-lines.
 #define VL_TRACE_SUFFIX_ENTRY_SIZE 8  ///< Size of a suffix entry
 
+#define VL_TRACE_VCD_MAX_COMPRESS 4  ///< Compressors to run at once, see rolloverCompress
+
 //=============================================================================
 // Specialization of the generics for this trace format
 
@@ -105,6 +113,8 @@ public:
         for (VcdVec::const_iterator it = singleton().s_vcdVecp.begin();
              it != singleton().s_vcdVecp.end(); ++it) {
             VerilatedVcd* vcdp = *it;
+            // Keep the window of windowed traces when stopping on an error
+            vcdp->flushWindow();
             vcdp->flush();
         }
     }
@@ -141,11 +151,24 @@ VerilatedVcd::VerilatedVcd(VerilatedVcdFile* filep)
     m_filep = m_fileNewed ? new VerilatedVcdFile : filep;
     m_namemapp = NULL;
     m_evcd = false;
-    m_wrChunkSize = 8 * 1024;
-    m_wrBufp = new char[m_wrChunkSize * 8];
-    m_wrFlushp = m_wrBufp + m_wrChunkSize * 6;
-    m_writep = m_wrBufp;
+    m_wrBufp = NULL;
+    m_writep = NULL;
     m_wroteBytes = 0;
+    m_compress = false;
+    m_segEmpty = true;
+    m_segFirstTime = 0;
+    m_segLastTime = 0;
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    m_wrSpareBufp = NULL;
+    m_wrPendp = NULL;
+    m_wrPendLen = 0;
+    m_wrErrno = 0;
+    m_wrShutdown = false;
+    // Writes don't stall dumping, so buffer more to make fewer of them
+    bufferAlloc(64 * 1024);
+#else
+    bufferAlloc(8 * 1024);
+#endif
     m_suffixesp = NULL;
 }
 
@@ -156,6 +179,11 @@ void VerilatedVcd::open(const char* filename) {
     // Set member variables
     m_filename = filename;  // "" is ok, as someone may overload open
     VerilatedVcdSingleton::pushVcd(this);
+    if (m_compress) {
+        // Start a new index
+        m_indexName = m_filename + ".idx";
+        if (FILE* fp = fopen(m_indexName.c_str(), "w")) fclose(fp);
+    }
 
     // SPDIFF_OFF
     // Set callback so an early exit will flush us
@@ -214,8 +242,12 @@ void VerilatedVcd::openNext(bool incFilename) {
         }
     }
     m_isOpen = true;
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    writerStart();
+#endif
     fullDump(true);  // First dump must be full
     m_wroteBytes = 0;
+    m_segEmpty = true;
 }
 
 bool VerilatedVcd::preChangeDump() {
@@ -224,9 +256,27 @@ bool VerilatedVcd::preChangeDump() {
 }
 
 void VerilatedVcd::emitTimeChange(vluint64_t timeui) {
-    printStr("#");
-    printQuad(timeui);
-    printStr("\n");
+    // Called every dump, so format directly into the buffer, which always
+    // has room for a line after m_wrFlushp
+    if (VL_UNLIKELY(m_segEmpty)) {
+        m_segEmpty = false;
+        m_segFirstTime = timeui;
+    }
+    m_segLastTime = timeui;
+    char digits[24];
+    char* const endp = digits + sizeof(digits);
+    char* dp = endp;
+    do {
+        *--dp = static_cast<char>('0' + timeui % 10);
+        timeui /= 10;
+    } while (timeui);
+    char* wp = m_writep;
+    *wp++ = '#';
+    memcpy(wp, dp, endp - dp);
+    wp += endp - dp;
+    *wp++ = '\n';
+    m_writep = wp;
+    bufferCheck();
 }
 
 void VerilatedVcd::makeNameMap() {
@@ -267,6 +317,9 @@ void VerilatedVcd::deleteNameMap() {
 VerilatedVcd::~VerilatedVcd() {
     close();
     if (m_wrBufp) VL_DO_CLEAR(delete[] m_wrBufp, m_wrBufp = NULL);
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    if (m_wrSpareBufp) VL_DO_CLEAR(delete[] m_wrSpareBufp, m_wrSpareBufp = NULL);
+#endif
     deleteNameMap();
     if (m_filep && m_fileNewed) VL_DO_CLEAR(delete m_filep, m_filep = NULL);
     VerilatedVcdSingleton::removeVcd(this);
@@ -278,8 +331,14 @@ void VerilatedVcd::closePrev() {
 
     VerilatedTrace<VerilatedVcd>::flush();
     bufferFlush();
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    writerSync();
+    if (!isOpen()) return;  // Write failed
+    writerStop();
+#endif
     m_isOpen = false;
     m_filep->close();
+    if (m_compress) compressPrev();
 }
 
 void VerilatedVcd::closeErr() {
@@ -289,6 +348,9 @@ void VerilatedVcd::closeErr() {
     if (!isOpen()) return;
 
     // No buffer flush, just fclose
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    writerStop();
+#endif
     m_isOpen = false;
     m_filep->close();  // May get error, just ignore it
 }
@@ -306,11 +368,85 @@ void VerilatedVcd::close() {
     // closePrev() called VerilatedTrace<VerilatedVcd>::flush(), so we just
     // need to shut down the tracing thread here.
     VerilatedTrace<VerilatedVcd>::close();
+    // Files are complete once close() returns
+    compressReap(0);
+}
+
+void VerilatedVcd::rolloverCompress(const char* commandp) {
+    m_assertOne.check();
+    if (isOpen()) return;  // Index would miss the files so far
+    m_compress = true;
+    m_compressCmd = commandp ? commandp : "";
+}
+
+void VerilatedVcd::compressPrev() {
+    // Called once each file is closed, to index it then compress it
+    if (!m_segEmpty) {
+        if (FILE* fp = fopen(m_indexName.c_str(), "a")) {
+            fprintf(fp, "%s %" VL_PRI64 "u %" VL_PRI64 "u\n", m_filename.c_str(), m_segFirstTime,
+                    m_segLastTime);
+            fclose(fp);
+        }
+    }
+    if (m_compressCmd.empty() || m_filename.empty()) return;
+    // If compressing falls behind, wait rather than filling the disk
+    compressReap(VL_TRACE_VCD_MAX_COMPRESS - 1);
+#ifdef _WIN32
+    const std::string cmd = m_compressCmd + " \"" + m_filename + "\"";
+    if (system(cmd.c_str())) {}  // Compressor reports its own errors
+#else
+    // Split the command into arguments, and add the filename
+    std::vector<std::string> args;
+    std::string arg;
+    for (const char* cp = m_compressCmd.c_str();; ++cp) {
+        if (*cp && !isspace(*cp)) {
+            arg += *cp;
+        } else {
+            if (!arg.empty()) args.push_back(arg);
+            arg = "";
+            if (!*cp) break;
+        }
+    }
+    args.push_back(m_filename);
+    std::vector<char*> argv;
+    for (std::vector<std::string>::iterator it = args.begin(); it != args.end(); ++it) {
+        argv.push_back(const_cast<char*>(it->c_str()));
+    }
+    argv.push_back(NULL);
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], NULL, NULL, &argv[0], environ) == 0) {
+        m_compressPids.push_back(pid);
+    } else {
+        VL_PRINTF_MT("%%Warning: VerilatedVcd: could not run '%s' to compress %s\n",
+                     m_compressCmd.c_str(), m_filename.c_str());
+    }
+#endif
+}
+
+void VerilatedVcd::compressReap(size_t maxRunning) {
+    // Wait until at most maxRunning compressors are running, oldest first
+#ifndef _WIN32
+    std::vector<int> running;
+    for (std::vector<int>::iterator it = m_compressPids.begin(); it != m_compressPids.end();
+         ++it) {
+        int status;
+        if (waitpid(*it, &status, WNOHANG) == 0) running.push_back(*it);
+    }
+    while (running.size() > maxRunning) {
+        int status;
+        waitpid(running.front(), &status, 0);
+        running.erase(running.begin());
+    }
+    m_compressPids.swap(running);
+#endif
 }
 
 void VerilatedVcd::flush() {
     VerilatedTrace<VerilatedVcd>::flush();
     bufferFlush();
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    writerSync();
+#endif
 }
 
 void VerilatedVcd::printStr(const char* str) {
@@ -327,18 +463,52 @@ void VerilatedVcd::printQuad(vluint64_t n) {
     printStr(buf);
 }
 
-void VerilatedVcd::bufferResize(vluint64_t minsize) {
-    // minsize is size of largest write.  We buffer at least 8 times as much data,
-    // writing when we are 3/4 full (with thus 2*minsize remaining free)
-    if (VL_UNLIKELY(minsize > m_wrChunkSize)) {
-        char* oldbufp = m_wrBufp;
-        m_wrChunkSize = minsize * 2;
-        m_wrBufp = new char[m_wrChunkSize * 8];
+void VerilatedVcd::bufferAlloc(vluint64_t chunkSize) {
+    // Allocate the output buffers, keeping any data buffered so far
+    char* oldbufp = m_wrBufp;
+    m_wrChunkSize = chunkSize;
+    m_wrBufp = new char[m_wrChunkSize * 8];
+    if (oldbufp) {
         memcpy(m_wrBufp, oldbufp, m_writep - oldbufp);
         m_writep = m_wrBufp + (m_writep - oldbufp);
-        m_wrFlushp = m_wrBufp + m_wrChunkSize * 6;
         VL_DO_CLEAR(delete[] oldbufp, oldbufp = NULL);
+    } else {
+        m_writep = m_wrBufp;
     }
+    m_wrFlushp = m_wrBufp + m_wrChunkSize * 6;
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    writerSync();  // The writer thread may be writing the spare buffer
+    if (m_wrSpareBufp) VL_DO_CLEAR(delete[] m_wrSpareBufp, m_wrSpareBufp = NULL);
+    m_wrSpareBufp = new char[m_wrChunkSize * 8];
+#endif
+}
+
+void VerilatedVcd::bufferResize(vluint64_t minsize) {
+    // minsize is size of largest write.  We buffer at least 8 times as much data,
+    // writing when we are 3/4 full (with thus 2*minsize remaining free)
+    if (VL_UNLIKELY(minsize > m_wrChunkSize)) bufferAlloc(minsize * 2);
+}
+
+void VerilatedVcd::writeChunkSize(vluint64_t bytes) {
+    m_assertOne.check();
+    if (isOpen()) return;  // Buffers are in use
+    // Declaring wide signals may grow the buffers later
+    bufferAlloc(std::max(bytes / 8, static_cast<vluint64_t>(1024)));
+}
+
+int VerilatedVcd::bufferWrite(VerilatedVcdFile* filep, const char* bufp, vluint64_t len) {
+    // Write all of the data, returning 0, or the errno of a failed write
+    while (len) {
+        errno = 0;
+        ssize_t got = filep->write(bufp, len);
+        if (got > 0) {
+            bufp += got;
+            len -= got;
+        } else if (got < 0) {
+            if (errno != EAGAIN && errno != EINTR) return errno;
+        }
+    }
+    return 0;
 }
 
 void VerilatedVcd::bufferFlush() VL_MT_UNSAFE_ONE {
@@ -349,30 +519,112 @@ void VerilatedVcd::bufferFlush() VL_MT_UNSAFE_ONE {
     // This is much faster than using buffered I/O
     m_assertOne.check();
     if (VL_UNLIKELY(!isOpen())) return;
-    char* wp = m_wrBufp;
-    while (true) {
-        ssize_t remaining = (m_writep - wp);
-        if (remaining == 0) break;
-        errno = 0;
-        ssize_t got = m_filep->write(wp, remaining);
-        if (got > 0) {
-            wp += got;
-            m_wroteBytes += got;
-        } else if (got < 0) {
-            if (errno != EAGAIN && errno != EINTR) {
-                // write failed, presume error (perhaps out of disk space)
-                std::string msg = std::string("VerilatedVcd::bufferFlush: ") + strerror(errno);
-                VL_FATAL_MT("", 0, "", msg.c_str());
-                closeErr();
-                break;
-            }
+    const vluint64_t len = m_writep - m_wrBufp;
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    if (m_wrThread) {
+        // Hand the buffer to the writer thread, and continue in the other one
+        writerSync();
+        if (VL_UNLIKELY(!isOpen()) || !len) return;
+        {
+            const std::lock_guard<std::mutex> lock(m_wrMutex);
+            m_wrPendp = m_wrBufp;
+            m_wrPendLen = len;
         }
+        m_wrCond.notify_all();
+        m_wroteBytes += len;
+        if (VerilatedLiveStats* const livep = Verilated::liveStatsp()) livep->traceWrote(len);
+        std::swap(m_wrBufp, m_wrSpareBufp);
+        m_wrFlushp = m_wrBufp + m_wrChunkSize * 6;
+        m_writep = m_wrBufp;
+        return;
+    }
+#endif
+    const int err = bufferWrite(m_filep, m_wrBufp, len);
+    if (VL_UNLIKELY(err)) {
+        // write failed, presume error (perhaps out of disk space)
+        std::string msg = std::string("VerilatedVcd::bufferFlush: ") + strerror(err);
+        VL_FATAL_MT("", 0, "", msg.c_str());
+        closeErr();
+    } else {
+        m_wroteBytes += len;
+        if (VerilatedLiveStats* const livep = Verilated::liveStatsp()) livep->traceWrote(len);
     }
 
     // Reset buffer
     m_writep = m_wrBufp;
 }
 
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+//=============================================================================
+// Writer thread
+
+void VerilatedVcd::writerStart() {
+    m_wrShutdown = false;
+    m_wrErrno = 0;
+    m_wrThread.reset(new std::thread(&VerilatedVcd::writerThreadMain, this));
+    Verilated::snapshotCbAdd(writerSnapshotCb, this);
+}
+
+void VerilatedVcd::writerStop() {
+    // Let the writer thread finish any pending write, then exit
+    if (!m_wrThread) return;
+    Verilated::snapshotCbRemove(writerSnapshotCb, this);
+    {
+        const std::lock_guard<std::mutex> lock(m_wrMutex);
+        m_wrShutdown = true;
+    }
+    m_wrCond.notify_all();
+    m_wrThread->join();
+    m_wrThread.reset();
+}
+
+void VerilatedVcd::writerSync() {
+    // Wait for the writer thread to finish any pending write
+    if (!m_wrThread) return;
+    int err;
+    {
+        std::unique_lock<std::mutex> lock(m_wrMutex);
+        while (m_wrPendp) m_wrCond.wait(lock);
+        err = m_wrErrno;
+        m_wrErrno = 0;
+    }
+    if (VL_UNLIKELY(err)) {
+        // write failed, presume error (perhaps out of disk space).  Close
+        // first, as the fatal error flushes all open traces.
+        closeErr();
+        std::string msg = std::string("VerilatedVcd::bufferFlush: ") + strerror(err);
+        VL_FATAL_MT("", 0, "", msg.c_str());
+    }
+}
+
+void VerilatedVcd::writerSnapshotCb(void* datap, bool after) {
+    // fork() copies only the calling thread, so restart the writer after it
+    VerilatedVcd* vcdp = static_cast<VerilatedVcd*>(datap);
+    if (!after) {
+        vcdp->writerSync();
+        vcdp->writerStop();
+    } else if (vcdp->isOpen()) {
+        vcdp->writerStart();
+    }
+}
+
+void VerilatedVcd::writerThreadMain() {
+    std::unique_lock<std::mutex> lock(m_wrMutex);
+    while (true) {
+        while (!m_wrPendp && !m_wrShutdown) m_wrCond.wait(lock);
+        if (!m_wrPendp) break;  // Shutdown, and nothing left to write
+        const char* const bufp = m_wrPendp;
+        const vluint64_t len = m_wrPendLen;
+        lock.unlock();
+        const int err = bufferWrite(m_filep, bufp, len);
+        lock.lock();
+        if (err) m_wrErrno = err;
+        m_wrPendp = NULL;
+        m_wrCond.notify_all();
+    }
+}
+#endif
+
 //=============================================================================
 // VCD string code
 
@@ -489,12 +741,14 @@ void VerilatedVcd::declare(vluint32_t code, const char* name, const char* wirep,
                            int arraynum, bool tri, bool bussed, int msb, int lsb) {
     const int bits = ((msb > lsb) ? (msb - lsb) : (lsb - msb)) + 1;
 
-    VerilatedTrace<VerilatedVcd>::declCode(code, bits, tri);
+    const bool traced = VerilatedTrace<VerilatedVcd>::declCode(code, name, bits, tri);
 
     if (m_suffixes.size() <= nextCode() * VL_TRACE_SUFFIX_ENTRY_SIZE) {
         m_suffixes.resize(nextCode() * VL_TRACE_SUFFIX_ENTRY_SIZE * 2, 0);
     }
 
+    if (!traced) return;  // Filtered out at runtime
+
     // Make sure write buffer is large enough (one character per bit), plus header
     bufferResize(bits + 1024);
 
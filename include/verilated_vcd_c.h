@@ -27,6 +27,13 @@
 #include <string>
 #include <vector>
 
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+# include <condition_variable>
+# include <memory>
+# include <mutex>
+# include <thread>
+#endif
+
 class VerilatedVcd;
 
 // SPDIFF_ON
@@ -74,14 +81,43 @@ private:
     vluint64_t m_wrChunkSize;  ///< Output buffer size
     vluint64_t m_wroteBytes;  ///< Number of bytes written to this file
 
+    // Compression of closed files, see rolloverCompress()
+    bool m_compress;  ///< Compress closed files, and index them
+    std::string m_compressCmd;  ///< Command compressing each closed file
+    std::string m_indexName;  ///< Filename of the index of files' times
+    std::vector<int> m_compressPids;  ///< Compressors that may still be running
+    bool m_segEmpty;  ///< No time written to this file yet
+    vluint64_t m_segFirstTime;  ///< First time written to this file
+    vluint64_t m_segLastTime;  ///< Last time written to this file
+
+#ifdef VL_TRACE_VCD_WRITER_THREAD
+    // Writer thread, which writes one buffer while the other is filled
+    char* m_wrSpareBufp;  ///< Output buffer not being filled, may be being written
+    const char* m_wrPendp;  ///< Data for the writer thread to write, NULL when idle
+    vluint64_t m_wrPendLen;  ///< Number of bytes at m_wrPendp
+    int m_wrErrno;  ///< Error the writer thread failed with, or 0
+    bool m_wrShutdown;  ///< Writer thread is to exit once idle
+    std::mutex m_wrMutex;  ///< Protects the above
+    std::condition_variable m_wrCond;  ///< Signalled when the above change
+    std::unique_ptr<std::thread> m_wrThread;  ///< The writer thread, if running
+
+    void writerStart();
+    void writerStop();
+    void writerSync();
+    void writerThreadMain();
+    static void writerSnapshotCb(void* datap, bool after);
+#endif
+
     std::vector<char> m_suffixes;  ///< VCD line end string codes + metadata
     const char* m_suffixesp;  ///< Pointer to first element of above
 
     typedef std::map<std::string, std::string> NameMap;
     NameMap* m_namemapp;  ///< List of names for the header
 
+    void bufferAlloc(vluint64_t chunkSize);
     void bufferResize(vluint64_t minsize);
     void bufferFlush() VL_MT_UNSAFE_ONE;
+    static int bufferWrite(VerilatedVcdFile* filep, const char* bufp, vluint64_t len);
     inline void bufferCheck() {
         // Flush the write buffer if there's not enough space left for new information
         // We only call this once per vector, so we need enough slop for a very wide "b###" line
@@ -89,6 +125,8 @@ private:
     }
     void closePrev();
     void closeErr();
+    void compressPrev();
+    void compressReap(size_t maxRunning);
     void openNext();
     void makeNameMap();
     void deleteNameMap();
@@ -143,6 +181,10 @@ public:
     // ACCESSORS
     /// Set size in megabytes after which new file should be created
     void rolloverMB(vluint64_t rolloverMB) { m_rolloverMB = rolloverMB; }
+    /// Set size in bytes of data to buffer for each write to the file
+    void writeChunkSize(vluint64_t bytes) VL_MT_UNSAFE_ONE;
+    /// Compress each closed file in the background, and index their times
+    void rolloverCompress(const char* commandp) VL_MT_UNSAFE_ONE;
 
     // METHODS
     /// Open the file; call isOpen() to see if errors
@@ -348,6 +390,8 @@ template <> void VerilatedTrace<VerilatedVcd>::set_time_unit(const char* unitp);
 template <> void VerilatedTrace<VerilatedVcd>::set_time_unit(const std::string& unit);
 template <> void VerilatedTrace<VerilatedVcd>::set_time_resolution(const char* unitp);
 template <> void VerilatedTrace<VerilatedVcd>::set_time_resolution(const std::string& unit);
+template <> void VerilatedTrace<VerilatedVcd>::windowLimits(size_t steps, size_t bytes);
+template <> void VerilatedTrace<VerilatedVcd>::flushWindow();
 
 //=============================================================================
 // VerilatedVcdC
@@ -383,10 +427,37 @@ public:
     void openNext(bool incFilename = true) VL_MT_UNSAFE_ONE { m_sptrace.openNext(incFilename); }
     /// Set size in megabytes after which new file should be created
     void rolloverMB(size_t rolloverMB) { m_sptrace.rolloverMB(rolloverMB); }
+    /// Set size in bytes of data to buffer for each write to the file, call before open()
+    void writeChunkSize(size_t bytes) VL_MT_UNSAFE_ONE { m_sptrace.writeChunkSize(bytes); }
+    /// Compress each file as openNext() or close() closes it, by running
+    /// 'commandp' (e.g. "gzip" or "zstd -q --rm") on it in the background,
+    /// and list the first and last time in each file in "<filename>.idx".
+    /// An empty command only writes the index.  Call before open().
+    void rolloverCompress(const char* commandp) VL_MT_UNSAFE_ONE {
+        m_sptrace.rolloverCompress(commandp);
+    }
     /// Close dump
     void close() VL_MT_UNSAFE_ONE { m_sptrace.close(); }
     /// Flush dump
     void flush() VL_MT_UNSAFE_ONE { m_sptrace.flush(); }
+    /// Keep only the last 'steps' time steps in memory, writing them on flushWindow()
+    void windowSteps(size_t steps) VL_MT_UNSAFE_ONE { m_sptrace.windowSteps(steps); }
+    /// Keep only about the last 'bytes' of changes in memory, writing them on flushWindow()
+    void windowBytes(size_t bytes) VL_MT_UNSAFE_ONE { m_sptrace.windowBytes(bytes); }
+    /// Write the kept window of changes to the file
+    void flushWindow() VL_MT_UNSAFE_ONE { m_sptrace.flushWindow(); }
+    /// Trace only signals matching a '*' and '?' pattern, call before open()
+    void filterGlob(const char* patternp) VL_MT_UNSAFE_ONE { m_sptrace.filterGlob(patternp); }
+    /// Trace only signals under at most 'levels' scopes, call before open()
+    void filterDepth(int levels) VL_MT_UNSAFE_ONE { m_sptrace.filterDepth(levels); }
+    /// Trace only signals at most 'bits' wide, call before open()
+    void filterMaxWidth(int bits) VL_MT_UNSAFE_ONE { m_sptrace.filterMaxWidth(bits); }
+    /// Count changes per signal, writing a ranked report on close(), call before open()
+    void toggleReport(const char* filenamep, bool waves = true) VL_MT_UNSAFE_ONE {
+        m_sptrace.toggleReport(filenamep, waves);
+    }
+    /// Add the bytes used by tracing to 'usage'
+    void memoryUsage(VerilatedMemoryUsage& usage) const { m_sptrace.memoryUsage(usage); }
     /// Write one cycle of dump data
     void dump(vluint64_t timeui) { m_sptrace.dump(timeui); }
     /// Write one cycle of dump data - backward compatible and to reduce
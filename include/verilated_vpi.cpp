@@ -27,10 +27,11 @@
 #include "verilated_vpi.h"
 #include "verilated_imp.h"
 
+#include <algorithm>
 #include <list>
 #include <map>
-#include <set>
 #include <sstream>
+#include <vector>
 
 //======================================================================
 // Internal constants
@@ -69,7 +70,7 @@ public:
         // To simplify our free list, we use a size large enough for all derived types
         // We reserve word zero for the next pointer, as that's safer in case a
         // dangling reference to the original remains around.
-        static const size_t chunk = 96;
+        static const size_t chunk = 104;
         if (VL_UNCOVERABLE(size > chunk)) VL_FATAL_MT(__FILE__, __LINE__, "", "increase chunk");
         if (VL_LIKELY(t_freeHead)) {
             vluint8_t* newp = t_freeHead;
@@ -102,16 +103,22 @@ public:
 
 typedef PLI_INT32 (*VerilatedPliCb)(struct t_cb_data*);
 
+class VerilatedVpioVar;
+
 class VerilatedVpioCb : public VerilatedVpio {
     t_cb_data m_cbData;
     s_vpi_value m_value;
     QData m_time;
+    VerilatedVpioVar* m_varop;  // cb_datap()->obj as a variable, for cbValueChange
+    vlsint32_t m_timedIndex;  // Position in VerilatedVpiTimedCbs, or -1 if not queued
 
 public:
     // cppcheck-suppress uninitVar  // m_value
     VerilatedVpioCb(const t_cb_data* cbDatap, QData time)
         : m_cbData(*cbDatap)
-        , m_time(time) {
+        , m_time(time)
+        , m_varop(NULL)
+        , m_timedIndex(-1) {
         m_value.format = cbDatap->value ? cbDatap->value->format : vpiSuppressVal;
         m_cbData.value = &m_value;
     }
@@ -124,6 +131,10 @@ public:
     VerilatedPliCb cb_rtnp() const { return m_cbData.cb_rtn; }
     t_cb_data* cb_datap() { return &(m_cbData); }
     QData time() const { return m_time; }
+    VerilatedVpioVar* varop() const { return m_varop; }
+    void varop(VerilatedVpioVar* varop) { m_varop = varop; }
+    vlsint32_t timedIndex() const { return m_timedIndex; }
+    void timedIndex(vlsint32_t index) { m_timedIndex = index; }
 };
 
 class VerilatedVpioConst : public VerilatedVpio {
@@ -188,6 +199,7 @@ class VerilatedVpioVar : public VerilatedVpio {
     const VerilatedVar* m_varp;
     const VerilatedScope* m_scopep;
     vluint8_t* m_prevDatap;  // Previous value of data, for cbValueChange
+    bool m_changePending;  // Change flag was set, for cbValueChange
     union {
         vluint8_t u8[4];
         vluint32_t u32;
@@ -207,6 +219,7 @@ public:
         , m_scopep(scopep)
         , m_index(0) {
         m_prevDatap = NULL;
+        m_changePending = false;
         m_mask.u32 = VL_MASK_I(varp->packed().elements());
         m_entSize = varp->entSize();
         m_varDatap = varp->datap();
@@ -236,6 +249,10 @@ public:
     }
     void* prevDatap() const { return m_prevDatap; }
     void* varDatap() const { return m_varDatap; }
+    /// Flag set when the model may have written the variable, or NULL if unknown
+    vluint8_t* changep() const { return m_varp->changep(); }
+    bool changePending() const { return m_changePending; }
+    void changePending(bool flag) { m_changePending = flag; }
     void createPrevDatap() {
         if (VL_UNLIKELY(!m_prevDatap)) {
             m_prevDatap = new vluint8_t[entSize()];
@@ -373,13 +390,223 @@ public:
 
 //======================================================================
 
-struct VerilatedVpiTimedCbsCmp {
-    /// Ordering sets keyed by time, then callback descriptor
-    bool operator()(const std::pair<QData, VerilatedVpioCb*>& a,
-                    const std::pair<QData, VerilatedVpioCb*>& b) const {
-        if (a.first < b.first) return 1;
-        if (a.first > b.first) return 0;
-        return a.second < b.second;
+/// Queue of cbAfterDelay callbacks, as a 4-ary min-heap ordered by time, then
+/// registration order.  Each callback records its heap position, so removal
+/// needs no search, and the heap storage is reused so scheduling does not
+/// allocate once the queue has grown to its working size.
+class VerilatedVpiTimedCbs {
+    struct Entry {
+        QData m_time;  // Time to call
+        vluint64_t m_seq;  // Registration order, for equal times
+        VerilatedVpioCb* m_cbp;  // Callback
+        bool operator<(const Entry& rhs) const {
+            return m_time < rhs.m_time || (m_time == rhs.m_time && m_seq < rhs.m_seq);
+        }
+    };
+    enum { ARITY = 4 };
+    std::vector<Entry> m_heap;
+    vluint64_t m_nextSeq;  // Next registration number
+
+    void place(size_t index, const Entry& ent) {
+        m_heap[index] = ent;
+        ent.m_cbp->timedIndex(static_cast<vlsint32_t>(index));
+    }
+    void siftUp(size_t index, const Entry& ent) {
+        while (index) {
+            size_t parent = (index - 1) / ARITY;
+            if (!(ent < m_heap[parent])) break;
+            place(index, m_heap[parent]);
+            index = parent;
+        }
+        place(index, ent);
+    }
+    void siftDown(size_t index, const Entry& ent) {
+        size_t size = m_heap.size();
+        while (true) {
+            size_t first = index * ARITY + 1;
+            if (first >= size) break;
+            size_t last = std::min(first + ARITY, size);
+            size_t best = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (m_heap[child] < m_heap[best]) best = child;
+            }
+            if (!(m_heap[best] < ent)) break;
+            place(index, m_heap[best]);
+            index = best;
+        }
+        place(index, ent);
+    }
+
+public:
+    VerilatedVpiTimedCbs()
+        : m_nextSeq(0) {}
+    ~VerilatedVpiTimedCbs() {}
+    bool empty() const { return m_heap.empty(); }
+    /// Time of the earliest callback; queue must not be empty
+    QData topTime() const { return m_heap[0].m_time; }
+    /// Registration number of the earliest callback; queue must not be empty
+    vluint64_t topSeq() const { return m_heap[0].m_seq; }
+    /// Registration number the next push() will use
+    vluint64_t nextSeq() const { return m_nextSeq; }
+    void push(VerilatedVpioCb* cbp) {
+        Entry ent;
+        ent.m_time = cbp->time();
+        ent.m_seq = m_nextSeq++;
+        ent.m_cbp = cbp;
+        m_heap.push_back(ent);
+        siftUp(m_heap.size() - 1, ent);
+    }
+    /// Remove a callback, if still queued
+    void remove(VerilatedVpioCb* cbp) {
+        vlsint32_t index = cbp->timedIndex();
+        if (VL_UNLIKELY(index < 0 || static_cast<size_t>(index) >= m_heap.size()
+                        || m_heap[index].m_cbp != cbp)) {
+            return;
+        }
+        cbp->timedIndex(-1);
+        Entry last = m_heap.back();
+        m_heap.pop_back();
+        if (static_cast<size_t>(index) == m_heap.size()) return;
+        if (index && last < m_heap[(index - 1) / ARITY]) {
+            siftUp(index, last);
+        } else {
+            siftDown(index, last);
+        }
+    }
+    /// Remove and return the earliest callback; queue must not be empty
+    VerilatedVpioCb* pop() {
+        VerilatedVpioCb* cbp = m_heap[0].m_cbp;
+        cbp->timedIndex(-1);
+        Entry last = m_heap.back();
+        m_heap.pop_back();
+        if (!m_heap.empty()) siftDown(0, last);
+        return cbp;
+    }
+};
+
+/// Hash of full hierarchical names to scopes and variables, for vpi_handle_by_name.
+/// Built on the first lookup, and rebuilt when scopes or variables are added or removed,
+/// so lookups after model construction neither lock the scope map nor allocate.
+class VerilatedVpiNameIndex {
+public:
+    struct Entry {
+        std::string m_name;  // Full hierarchical name
+        vluint32_t m_hash;  // hash() of m_name
+        const VerilatedScope* m_scopep;  // Scope, or scope containing m_varp
+        const VerilatedVar* m_varp;  // Variable, or NULL for a scope
+    };
+
+private:
+    std::vector<Entry> m_entries;
+    std::vector<vluint32_t> m_buckets;  // Open addressed; m_entries index + 1, 0 if empty
+    const VerilatedScope* m_topScopep;  // "TOP" scope, holding top ports
+    vluint64_t m_generation;  // VerilatedImp::scopeNameGeneration() when built
+    bool m_built;
+
+    static inline vluint32_t hashAdd(vluint32_t hash, const char* strp, size_t len) {
+        // FNV-1a
+        for (size_t i = 0; i < len; ++i) {
+            hash ^= static_cast<vluint8_t>(strp[i]);
+            hash *= 16777619U;
+        }
+        return hash;
+    }
+    static inline vluint32_t hashStart() { return 2166136261U; }
+    void add(const std::string& name, const VerilatedScope* scopep, const VerilatedVar* varp) {
+        vluint32_t hash = hashAdd(hashStart(), name.data(), name.size());
+        vluint32_t mask = static_cast<vluint32_t>(m_buckets.size() - 1);
+        for (vluint32_t b = hash & mask;; b = (b + 1) & mask) {
+            if (!m_buckets[b]) {
+                Entry ent;
+                ent.m_name = name;
+                ent.m_hash = hash;
+                ent.m_scopep = scopep;
+                ent.m_varp = varp;
+                m_entries.push_back(ent);
+                m_buckets[b] = static_cast<vluint32_t>(m_entries.size());
+                return;
+            }
+            Entry& ent = m_entries[m_buckets[b] - 1];
+            if (ent.m_hash == hash && ent.m_name == name) {
+                // A scope takes precedence over a variable of the same name
+                if (!varp) {
+                    ent.m_scopep = scopep;
+                    ent.m_varp = NULL;
+                }
+                return;
+            }
+        }
+    }
+    void build() {
+        m_entries.clear();
+        m_buckets.clear();
+        m_topScopep = NULL;
+        m_generation = VerilatedImp::scopeNameGeneration();
+        m_built = true;
+        const VerilatedScopeNameMap* mapp = VerilatedImp::scopeNameMap();
+        size_t entries = 0;
+        for (VerilatedScopeNameMap::const_iterator it = mapp->begin(); it != mapp->end(); ++it) {
+            const VerilatedScope* scopep = it->second;
+            entries += 1 + (scopep->varsp() ? scopep->varsp()->size() : 0);
+        }
+        size_t buckets = 16;
+        while (buckets < entries * 2) buckets *= 2;
+        m_buckets.resize(buckets, 0);
+        m_entries.reserve(entries);
+        std::string name;
+        for (VerilatedScopeNameMap::const_iterator it = mapp->begin(); it != mapp->end(); ++it) {
+            const VerilatedScope* scopep = it->second;
+            if (0 == strcmp(scopep->name(), "TOP")) m_topScopep = scopep;
+            add(scopep->name(), scopep, NULL);
+            if (VerilatedVarNameMap* varsp = scopep->varsp()) {
+                for (VerilatedVarNameMap::const_iterator vit = varsp->begin();
+                     vit != varsp->end(); ++vit) {
+                    name = scopep->name();
+                    name += '.';
+                    name += vit->first;
+                    add(name, scopep, &(vit->second));
+                }
+            }
+        }
+    }
+
+public:
+    VerilatedVpiNameIndex()
+        : m_topScopep(NULL)
+        , m_generation(0)
+        , m_built(false) {}
+    ~VerilatedVpiNameIndex() {}
+    void ensureBuilt() {
+        if (VL_UNLIKELY(!m_built || m_generation != VerilatedImp::scopeNameGeneration())) {
+            build();
+        }
+    }
+    const VerilatedScope* topScopep() const { return m_topScopep; }
+    /// Find "prefix.name", or just "name" if prefixp is NULL
+    const Entry* find(const char* prefixp, const char* namep) const {
+        size_t prefixLen = prefixp ? strlen(prefixp) : 0;
+        size_t nameLen = strlen(namep);
+        size_t len = nameLen;
+        vluint32_t hash = hashStart();
+        if (prefixp) {
+            hash = hashAdd(hash, prefixp, prefixLen);
+            hash = hashAdd(hash, ".", 1);
+            len += prefixLen + 1;
+        }
+        hash = hashAdd(hash, namep, nameLen);
+        if (VL_UNLIKELY(m_buckets.empty())) return NULL;
+        vluint32_t mask = static_cast<vluint32_t>(m_buckets.size() - 1);
+        for (vluint32_t b = hash & mask; m_buckets[b]; b = (b + 1) & mask) {
+            const Entry& ent = m_entries[m_buckets[b] - 1];
+            if (ent.m_hash != hash || ent.m_name.size() != len) continue;
+            const char* entp = ent.m_name.data();
+            if (prefixp) {
+                if (0 != memcmp(entp, prefixp, prefixLen) || entp[prefixLen] != '.') continue;
+                entp += prefixLen + 1;
+            }
+            if (0 == memcmp(entp, namep, nameLen)) return &ent;
+        }
+        return NULL;
     }
 };
 
@@ -388,14 +615,17 @@ class VerilatedVpiError;
 class VerilatedVpiImp {
     enum { CB_ENUM_MAX_VALUE = cbAtEndOfSimTime + 1 };  // Maxium callback reason
     typedef std::list<VerilatedVpioCb*> VpioCbList;
-    typedef std::set<std::pair<QData, VerilatedVpioCb*>, VerilatedVpiTimedCbsCmp> VpioTimedCbs;
+    typedef std::vector<VerilatedVpioVar*> VpioVarList;
 
     struct product_info {
         PLI_BYTE8* product;
     };
 
     VpioCbList m_cbObjLists[CB_ENUM_MAX_VALUE];  // Callbacks for each supported reason
-    VpioTimedCbs m_timedCbs;  // Time based callbacks
+    VerilatedVpiTimedCbs m_timedCbs;  // Time based callbacks
+    VpioVarList m_valueUpdates;  // Variables to update after value callbacks
+    std::vector<vluint8_t*> m_valueFlags;  // Change flags to clear in value callbacks
+    VerilatedVpiNameIndex m_nameIndex;  // Hierarchical names, for vpi_handle_by_name
     VerilatedVpiError* m_errorInfop;  // Container for vpi error info
     VerilatedAssertOneThread m_assertOne;  ///< Assert only called from single thread
 
@@ -405,10 +635,15 @@ public:
     VerilatedVpiImp() { m_errorInfop = NULL; }
     ~VerilatedVpiImp() {}
     static void assertOneCheck() { s_s.m_assertOne.check(); }
+    static const VerilatedVpiNameIndex& nameIndex() {
+        s_s.m_nameIndex.ensureBuilt();
+        return s_s.m_nameIndex;
+    }
     static void cbReasonAdd(VerilatedVpioCb* vop) {
         if (vop->reason() == cbValueChange) {
             if (VerilatedVpioVar* varop = VerilatedVpioVar::castp(vop->cb_datap()->obj)) {
                 varop->createPrevDatap();
+                vop->varop(varop);
             }
         }
         if (VL_UNCOVERABLE(vop->reason() >= CB_ENUM_MAX_VALUE)) {
@@ -416,9 +651,7 @@ public:
         }
         s_s.m_cbObjLists[vop->reason()].push_back(vop);
     }
-    static void cbTimedAdd(VerilatedVpioCb* vop) {
-        s_s.m_timedCbs.insert(std::make_pair(vop->time(), vop));
-    }
+    static void cbTimedAdd(VerilatedVpioCb* vop) { s_s.m_timedCbs.push(vop); }
     static void cbReasonRemove(VerilatedVpioCb* cbp) {
         VpioCbList& cbObjList = s_s.m_cbObjLists[cbp->reason()];
         // We do not remove it now as we may be iterating the list,
@@ -427,29 +660,21 @@ public:
             if (*it == cbp) *it = NULL;
         }
     }
-    static void cbTimedRemove(VerilatedVpioCb* cbp) {
-        VpioTimedCbs::iterator it = s_s.m_timedCbs.find(std::make_pair(cbp->time(), cbp));
-        if (VL_LIKELY(it != s_s.m_timedCbs.end())) { s_s.m_timedCbs.erase(it); }
-    }
+    static void cbTimedRemove(VerilatedVpioCb* cbp) { s_s.m_timedCbs.remove(cbp); }
     static void callTimedCbs() VL_MT_UNSAFE_ONE {
         assertOneCheck();
         QData time = VL_TIME_Q();
-        for (VpioTimedCbs::iterator it = s_s.m_timedCbs.begin(); it != s_s.m_timedCbs.end();) {
-            if (VL_UNLIKELY(it->first <= time)) {
-                VerilatedVpioCb* vop = it->second;
-                VpioTimedCbs::iterator last_it = it;
-                ++it;  // Timed callbacks are one-shot
-                s_s.m_timedCbs.erase(last_it);
-                VL_DEBUG_IF_PLI(VL_DBG_MSGF("- vpi: timed_callback %p\n", vop););
-                (vop->cb_rtnp())(vop->cb_datap());
-            } else {
-                ++it;
-            }
+        // Callbacks registered by the callbacks below wait for the next call
+        vluint64_t endSeq = s_s.m_timedCbs.nextSeq();
+        while (!s_s.m_timedCbs.empty() && s_s.m_timedCbs.topTime() <= time
+               && s_s.m_timedCbs.topSeq() < endSeq) {
+            VerilatedVpioCb* vop = s_s.m_timedCbs.pop();  // Timed callbacks are one-shot
+            VL_DEBUG_IF_PLI(VL_DBG_MSGF("- vpi: timed_callback %p\n", vop););
+            (vop->cb_rtnp())(vop->cb_datap());
         }
     }
     static QData cbNextDeadline() {
-        VpioTimedCbs::const_iterator it = s_s.m_timedCbs.begin();
-        if (VL_LIKELY(it != s_s.m_timedCbs.end())) return it->first;
+        if (VL_LIKELY(!s_s.m_timedCbs.empty())) return s_s.m_timedCbs.topTime();
         return ~VL_ULL(0);  // maxquad
     }
     static bool callCbs(vluint32_t reason) VL_MT_UNSAFE_ONE {
@@ -470,15 +695,31 @@ public:
     static void callValueCbs() VL_MT_UNSAFE_ONE {
         assertOneCheck();
         VpioCbList& cbObjList = s_s.m_cbObjLists[cbValueChange];
-        typedef std::set<VerilatedVpioVar*> VpioVarSet;
-        VpioVarSet update;  // set of objects to update after callbacks
+        VpioVarList& update = s_s.m_valueUpdates;  // Objects to update after callbacks
+        update.clear();
+        // With --vpi-change-hooks, only compare variables the model flagged as
+        // written.  Flags are shared by all handles to a variable, so are
+        // cleared once every handle has seen them.
+        std::vector<vluint8_t*>& flags = s_s.m_valueFlags;
+        flags.clear();
+        for (VpioCbList::iterator it = cbObjList.begin(); it != cbObjList.end(); ++it) {
+            if (VL_UNLIKELY(!*it)) continue;
+            if (VerilatedVpioVar* varop = (*it)->varop()) {
+                if (vluint8_t* changep = varop->changep()) {
+                    varop->changePending(*changep);
+                    if (*changep) flags.push_back(changep);
+                }
+            }
+        }
+        for (size_t i = 0; i < flags.size(); ++i) *flags[i] = 0;
         for (VpioCbList::iterator it = cbObjList.begin(); it != cbObjList.end();) {
             if (VL_UNLIKELY(!*it)) {  // Deleted earlier, cleanup
                 it = cbObjList.erase(it);
                 continue;
             }
             VerilatedVpioCb* vop = *it++;
-            if (VerilatedVpioVar* varop = VerilatedVpioVar::castp(vop->cb_datap()->obj)) {
+            if (VerilatedVpioVar* varop = vop->varop()) {
+                if (varop->changep() && !varop->changePending()) continue;
                 void* newDatap = varop->varDatap();
                 void* prevDatap = varop->prevDatap();  // Was malloced when we added the callback
                 VL_DEBUG_IF_PLI(VL_DBG_MSGF("- vpi: value_test %s v[0]=%d/%d %p %p\n",
@@ -487,13 +728,13 @@ public:
                 if (memcmp(prevDatap, newDatap, varop->entSize()) != 0) {
                     VL_DEBUG_IF_PLI(VL_DBG_MSGF("- vpi: value_callback %p %s v[0]=%d\n", vop,
                                                 varop->fullname(), *((CData*)newDatap)););
-                    update.insert(varop);
+                    update.push_back(varop);
                     vpi_get_value(vop->cb_datap()->obj, vop->cb_datap()->value);
                     (vop->cb_rtnp())(vop->cb_datap());
                 }
             }
         }
-        for (VpioVarSet::const_iterator it = update.begin(); it != update.end(); ++it) {
+        for (VpioVarList::const_iterator it = update.begin(); it != update.end(); ++it) {
             memcpy((*it)->prevDatap(), (*it)->varDatap(), (*it)->entSize());
         }
     }
@@ -588,6 +829,74 @@ bool VerilatedVpi::callCbs(vluint32_t reason) VL_MT_UNSAFE_ONE {
 
 QData VerilatedVpi::cbNextDeadline() VL_MT_UNSAFE_ONE { return VerilatedVpiImp::cbNextDeadline(); }
 
+//======================================================================
+// VerilatedVpiBatch implementation
+
+int VerilatedVpiBatch::add(vpiHandle object) VL_MT_UNSAFE_ONE {
+    VerilatedVpiImp::assertOneCheck();
+    _VL_VPI_ERROR_RESET();
+    VerilatedVpioVar* vop = VerilatedVpioVar::castp(object);
+    if (VL_UNLIKELY(!vop || vop->type() == vpiMemory)) {
+        _VL_VPI_ERROR(__FILE__, __LINE__, "%s: Unsupported handle, need vpiReg or vpiMemoryWord",
+                      VL_FUNC);
+        return -1;
+    }
+    Entry ent;
+    ent.m_datap = vop->varDatap();
+    ent.m_changep = vop->changep();
+    ent.m_size = vop->entSize();
+    int bits = vop->varp()->packed().elements();
+    ent.m_writable = vop->varp()->isPublicRW();
+    switch (vop->varp()->vltype()) {
+    case VLVT_UINT8:
+    case VLVT_UINT16:
+    case VLVT_UINT32:
+    case VLVT_UINT64:
+        ent.m_wordSize = ent.m_size;
+        ent.m_mask = VL_MASK_Q(bits);
+        break;
+    case VLVT_WDATA:
+        ent.m_wordSize = sizeof(EData);
+        ent.m_mask = VL_MASK_E(bits);
+        break;
+    default:
+        _VL_VPI_ERROR(__FILE__, __LINE__, "%s: Unsupported variable type for %s", VL_FUNC,
+                      vop->fullname());
+        return -1;
+    }
+    // Align as the model does, so values may be accessed in place in the buffer
+    vluint32_t align = (ent.m_size >= sizeof(QData)) ? sizeof(QData) : ent.m_size;
+    ent.m_offset = (m_bytes + align - 1) & ~(align - 1);
+    m_bytes = ent.m_offset + ent.m_size;
+    m_entries.push_back(ent);
+    return static_cast<int>(m_entries.size() - 1);
+}
+
+void VerilatedVpiBatch::get(void* bufp) const VL_MT_UNSAFE_ONE {
+    vluint8_t* outp = static_cast<vluint8_t*>(bufp);
+    for (std::vector<Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        memcpy(outp + it->m_offset, it->m_datap, it->m_size);
+    }
+}
+
+void VerilatedVpiBatch::put(const void* bufp) VL_MT_UNSAFE_ONE {
+    const vluint8_t* inp = static_cast<const vluint8_t*>(bufp);
+    for (std::vector<Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (VL_UNLIKELY(!it->m_writable)) continue;
+        vluint8_t* datap = static_cast<vluint8_t*>(it->m_datap);
+        memcpy(datap, inp + it->m_offset, it->m_size);
+        // Clear unused bits of the most significant word, as vpi_put_value does
+        void* msbp = datap + it->m_size - it->m_wordSize;
+        switch (it->m_wordSize) {
+        case sizeof(CData): *static_cast<CData*>(msbp) &= it->m_mask; break;
+        case sizeof(SData): *static_cast<SData*>(msbp) &= it->m_mask; break;
+        case sizeof(IData): *static_cast<IData*>(msbp) &= it->m_mask; break;
+        default: *static_cast<QData*>(msbp) &= it->m_mask; break;
+        }
+        if (it->m_changep) *it->m_changep = 1;
+    }
+}
+
 //======================================================================
 // VerilatedVpiImp implementation
 
@@ -1059,45 +1368,34 @@ vpiHandle vpi_handle_by_name(PLI_BYTE8* namep, vpiHandle scope) {
     _VL_VPI_ERROR_RESET();
     if (VL_UNLIKELY(!namep)) return NULL;
     VL_DEBUG_IF_PLI(VL_DBG_MSGF("- vpi: vpi_handle_by_name %s %p\n", namep, scope););
-    const VerilatedVar* varp = NULL;
-    const VerilatedScope* scopep;
     VerilatedVpioScope* voScopep = VerilatedVpioScope::castp(scope);
-    std::string scopeAndName = namep;
-    if (voScopep) {
-        scopeAndName = std::string(voScopep->fullname()) + "." + namep;
-        namep = const_cast<PLI_BYTE8*>(scopeAndName.c_str());
-    }
-    {
-        // This doesn't yet follow the hierarchy in the proper way
-        scopep = Verilated::scopeFind(namep);
-        if (scopep) {  // Whole thing found as a scope
-            if (scopep->type() == VerilatedScope::SCOPE_MODULE) {
-                return (new VerilatedVpioModule(scopep))->castVpiHandle();
-            } else {
-                return (new VerilatedVpioScope(scopep))->castVpiHandle();
-            }
+    const char* prefixp = voScopep ? voScopep->fullname() : NULL;
+    // This doesn't yet follow the hierarchy in the proper way
+    const VerilatedVpiNameIndex& index = VerilatedVpiImp::nameIndex();
+    const VerilatedVpiNameIndex::Entry* entp = index.find(prefixp, namep);
+    if (entp && !entp->m_varp) {  // Whole thing found as a scope
+        if (entp->m_scopep->type() == VerilatedScope::SCOPE_MODULE) {
+            return (new VerilatedVpioModule(entp->m_scopep))->castVpiHandle();
+        } else {
+            return (new VerilatedVpioScope(entp->m_scopep))->castVpiHandle();
         }
-        const char* baseNamep = scopeAndName.c_str();
-        std::string scopename;
-        const char* dotp = strrchr(namep, '.');
-        if (VL_LIKELY(dotp)) {
-            baseNamep = dotp + 1;
-            scopename = std::string(namep, dotp - namep);
-        }
-
-        if (scopename.find('.') == std::string::npos) {
-            // This is a toplevel, hence search in our TOP ports first.
-            scopep = Verilated::scopeFind("TOP");
-            if (scopep) { varp = scopep->varFind(baseNamep); }
-        }
-        if (!varp) {
-            scopep = Verilated::scopeFind(scopename.c_str());
-            if (!scopep) return NULL;
-            varp = scopep->varFind(baseNamep);
+    }
+    const char* baseNamep = namep;
+    bool topLevel;
+    if (const char* dotp = strrchr(namep, '.')) {
+        baseNamep = dotp + 1;
+        topLevel = !prefixp && !memchr(namep, '.', dotp - namep);
+    } else {
+        topLevel = !prefixp || !strchr(prefixp, '.');
+    }
+    if (topLevel && index.topScopep()) {
+        // This is a toplevel, hence search in our TOP ports first.
+        if (const VerilatedVar* varp = index.topScopep()->varFind(baseNamep)) {
+            return (new VerilatedVpioVar(varp, index.topScopep()))->castVpiHandle();
         }
     }
-    if (!varp) return NULL;
-    return (new VerilatedVpioVar(varp, scopep))->castVpiHandle();
+    if (!entp) return NULL;
+    return (new VerilatedVpioVar(entp->m_varp, entp->m_scopep))->castVpiHandle();
 }
 
 vpiHandle vpi_handle_by_index(vpiHandle object, PLI_INT32 indx) {
@@ -1625,6 +1923,7 @@ vpiHandle vpi_put_value(vpiHandle object, p_vpi_value value_p, p_vpi_time /*time
                             vop->fullname());
             return 0;
         }
+        if (vluint8_t* changep = vop->changep()) *changep = 1;
         if (value_p->format == vpiVectorVal) {
             if (VL_UNLIKELY(!value_p->value.vector)) return NULL;
             switch (vop->varp()->vltype()) {
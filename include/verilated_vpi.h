@@ -31,6 +31,8 @@
 
 #include "vltstd/vpi_user.h"
 
+#include <vector>
+
 //======================================================================
 
 class VerilatedVpi {
@@ -46,9 +48,51 @@ public:
     static bool callCbs(vluint32_t reason) VL_MT_UNSAFE_ONE;
     /// Returns time of the next registered VPI callback, or
     /// ~(0) if none are registered
+    /// Main loops may advance time directly to this, instead of polling callTimedCbs
     static QData cbNextDeadline() VL_MT_UNSAFE_ONE;
     /// Self test, for internal use only
     static void selfTest() VL_MT_UNSAFE_ONE;
 };
 
+//======================================================================
+/// Verilator specific extension to read or write the values of many
+/// variables with one call, e.g. all ports of a vector testbench.
+/// Handles are registered once with add(); get() and put() then copy all
+/// values between the model and a user buffer of bytes() bytes.  Each
+/// value is stored at offset(index) in the model's native representation,
+/// as the CData, SData, IData, QData or EData words of the variable.
+
+class VerilatedVpiBatch {
+    struct Entry {
+        void* m_datap;  // Variable data in the model
+        vluint8_t* m_changep;  // Change flag of the variable, or NULL
+        vluint32_t m_offset;  // Byte offset in the user buffer
+        vluint32_t m_size;  // Bytes of data
+        QData m_mask;  // Mask of the most significant word
+        vluint8_t m_wordSize;  // Bytes of the most significant word
+        bool m_writable;  // Variable is public_flat_rw
+    };
+    std::vector<Entry> m_entries;
+    vluint32_t m_bytes;  // Size of the user buffer
+
+public:
+    VerilatedVpiBatch()
+        : m_bytes(0) {}
+    ~VerilatedVpiBatch() {}
+    /// Add a vpiReg or vpiMemoryWord handle, returning its index, or -1 on error
+    /// The handle may be released after adding it.
+    int add(vpiHandle object) VL_MT_UNSAFE_ONE;
+    /// Number of handles added
+    size_t size() const { return m_entries.size(); }
+    /// Bytes required in the user buffer
+    size_t bytes() const { return m_bytes; }
+    /// Byte offset of the value of the given index in the user buffer
+    size_t offset(int index) const { return m_entries[index].m_offset; }
+    /// Copy all values from the model into the user buffer
+    void get(void* bufp) const VL_MT_UNSAFE_ONE;
+    /// Copy all values from the user buffer into the model
+    /// Variables not marked public_flat_rw are skipped.
+    void put(const void* bufp) VL_MT_UNSAFE_ONE;
+};
+
 #endif  // Guard
@@ -58,8 +58,10 @@
 # define VL_UNREACHABLE __builtin_unreachable();
 # define VL_PREFETCH_RD(p) __builtin_prefetch((p), 0)
 # define VL_PREFETCH_RW(p) __builtin_prefetch((p), 1)
+# define VL_RESTRICT __restrict__
 #elif defined(_MSC_VER)
 # define VL_FUNC __FUNCTION__
+# define VL_RESTRICT __restrict
 #endif
 
 // Defaults for unsupported compiler features
@@ -111,6 +113,9 @@
 #ifndef VL_UNREACHABLE
 # define VL_UNREACHABLE  ///< Point that may never be reached
 #endif
+#ifndef VL_RESTRICT
+# define VL_RESTRICT  ///< Pointer is the only way its object is accessed in this scope
+#endif
 #ifndef VL_PREFETCH_RD
 # define VL_PREFETCH_RD(p)  ///< Prefetch data with read intent
 #endif
@@ -369,6 +374,16 @@ typedef unsigned long long vluint64_t;  ///< 64-bit unsigned type
 #define VL_EDATASIZE_LOG2 5  ///< log2(VL_EDATASIZE)
 #define VL_CACHE_LINE_BYTES 64  ///< Bytes in a cache line (for alignment)
 
+// Wide arithmetic may treat each pair of EData words as one 64-bit limb,
+// which requires a little endian host with a 128-bit integer type.
+// Use VL_DISABLE_LIMB64 to always use 32-bit limbs.
+#if defined(__SIZEOF_INT128__) && defined(__BYTE_ORDER__) \
+    && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ \
+    && !defined(VL_DISABLE_LIMB64) && !defined(VL_PORTABLE_ONLY)
+# define VL_HAVE_LIMB64 1  ///< Wide arithmetic uses 64-bit limbs
+__extension__ typedef unsigned __int128 vluint128_t;  ///< 128-bit unsigned type
+#endif
+
 /// Bytes this number of bits needs (1 bit=1 byte)
 #define VL_BYTES_I(nbits) (((nbits) + (VL_BYTESIZE - 1)) / VL_BYTESIZE)
 /// Words/EDatas this number of bits needs (1 bit=1 word)
@@ -388,7 +403,11 @@ typedef unsigned long long vluint64_t;  ///< 64-bit unsigned type
 // Verilated function size macros
 
 #define VL_MULS_MAX_WORDS 16  ///< Max size in words of MULS operation
+#define VL_MUL_KARATSUBA_LIMBS 32  ///< Min 64-bit limbs for Karatsuba multiply
 #define VL_TO_STRING_MAX_WORDS 64  ///< Max size in words of String conversion operation
+#define VL_DPI_ASYNC_ARGS_MAX 16  ///< Max arguments to an async DPI import
+#define VL_QUEUE_INLINE_BYTES 1024  ///< Max bytes of a bounded queue stored inline
+#define VL_SPARSE_PAGE_BYTES 4096  ///< Bytes per --savable page of a sparse array
 
 //=========================================================================
 // Base macros
@@ -39,6 +39,7 @@ private:
     // STATE
     AstNodeModule* m_modp;  // Last module
     AstBegin* m_beginp;  // Last begin
+    AstVar* m_scopeOffp;  // Module's scope disables, see --assert-scopes
     unsigned m_modPastNum;  // Module past numbering
     VDouble0 m_statCover;  // Statistic tracking
     VDouble0 m_statAsNotImm;  // Statistic tracking
@@ -66,18 +67,32 @@ private:
         }
     }
 
+    AstNode* newScopeOn(FileLine* fl, int bit) {
+        // With --assert-scopes, true unless Verilated::assertScopeOn (bit 0)
+        // or coverScopeOn (bit 1) turned off this scope's assertions or covers.
+        // The disables are a public variable of each scope, zero from reset.
+        if (!v3Global.opt.assertScopes() || VN_IS(m_modp, Class)) return NULL;
+        if (!m_scopeOffp) {
+            m_scopeOffp = new AstVar(fl, AstVarType::VAR, "__Vassert_off",
+                                     m_modp->findBitDType(2, 2, VSigning::UNSIGNED));
+            m_scopeOffp->sigUserRWPublic(true);
+            m_modp->addStmtp(m_scopeOffp);
+        }
+        return new AstLogNot(fl, new AstSel(fl, new AstVarRef(fl, m_scopeOffp, false), bit, 1));
+    }
+    AstNode* newAssertOnCond(FileLine* fl) {
+        // If assertions are off, have constant propagation rip them out later
+        // This allows syntax errors and such to be detected normally.
+        if (!v3Global.opt.assertOn()) return new AstConst(fl, AstConst::LogicFalse());
+        AstNode* condp = new AstCMath(fl, "Verilated::assertOn()", 1);
+        if (AstNode* scopeOnp = newScopeOn(fl, 0)) condp = new AstLogAnd(fl, condp, scopeOnp);
+        return condp;
+    }
     AstNode* newIfAssertOn(AstNode* nodep) {
         // Add a internal if to check assertions are on.
         // Don't make this a AND term, as it's unlikely to need to test this.
         FileLine* fl = nodep->fileline();
-        AstNode* newp
-            = new AstIf(fl,
-                        // If assertions are off, have constant propagation rip them out later
-                        // This allows syntax errors and such to be detected normally.
-                        (v3Global.opt.assertOn()
-                             ? static_cast<AstNode*>(new AstCMath(fl, "Verilated::assertOn()", 1))
-                             : static_cast<AstNode*>(new AstConst(fl, AstConst::LogicFalse()))),
-                        nodep, NULL);
+        AstNode* newp = new AstIf(fl, newAssertOnCond(fl), nodep, NULL);
         newp->user1(true);  // Don't assert/cover this if
         return newp;
     }
@@ -134,6 +149,11 @@ private:
             if (bodysp && passsp) bodysp = bodysp->addNext(passsp);
             ifp = new AstIf(nodep->fileline(), propp, bodysp, NULL);
             bodysp = ifp;
+            if (AstNode* scopeOnp = newScopeOn(nodep->fileline(), 1)) {
+                // Test before evaluating the property
+                bodysp = new AstIf(nodep->fileline(), scopeOnp, bodysp, NULL);
+                bodysp->user1(true);  // Don't assert/cover this if
+            }
         } else if (VN_IS(nodep, Assert)) {
             if (nodep->immediate()) {
                 ++m_statAsImm;
@@ -217,9 +237,13 @@ private:
             AstNode* ohot = ((allow_none || hasDefaultElse)
                                  ? static_cast<AstNode*>(new AstOneHot0(nodep->fileline(), propp))
                                  : static_cast<AstNode*>(new AstOneHot(nodep->fileline(), propp)));
+            // Test assertions are on first, so when off the check isn't evaluated
             AstIf* checkifp
-                = new AstIf(nodep->fileline(), new AstLogNot(nodep->fileline(), ohot),
-                            newFireAssert(nodep, "'unique if' statement violated"), newifp);
+                = new AstIf(nodep->fileline(),
+                            new AstLogAnd(nodep->fileline(), newAssertOnCond(nodep->fileline()),
+                                          new AstLogNot(nodep->fileline(), ohot)),
+                            newFireAssertUnchecked(nodep, "'unique if' statement violated"),
+                            newifp);
             checkifp->branchPred(VBranchPred::BP_UNLIKELY);
             nodep->replaceWith(checkifp);
             pushDeletep(nodep);
@@ -287,9 +311,11 @@ private:
                                ? static_cast<AstNode*>(new AstOneHot0(nodep->fileline(), propp))
                                : static_cast<AstNode*>(new AstOneHot(nodep->fileline(), propp)));
                     AstIf* ifp = new AstIf(
-                        nodep->fileline(), new AstLogNot(nodep->fileline(), ohot),
-                        newFireAssert(nodep,
-                                      "synthesis parallel_case, but multiple matches found"),
+                        nodep->fileline(),
+                        new AstLogAnd(nodep->fileline(), newAssertOnCond(nodep->fileline()),
+                                      new AstLogNot(nodep->fileline(), ohot)),
+                        newFireAssertUnchecked(
+                            nodep, "synthesis parallel_case, but multiple matches found"),
                         NULL);
                     ifp->branchPred(VBranchPred::BP_UNLIKELY);
                     nodep->addNotParallelp(ifp);
@@ -363,13 +389,16 @@ private:
 
     virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
         AstNodeModule* origModp = m_modp;
+        AstVar* origScopeOffp = m_scopeOffp;
         unsigned origPastNum = m_modPastNum;
         {
             m_modp = nodep;
+            m_scopeOffp = NULL;
             m_modPastNum = 0;
             iterateChildren(nodep);
         }
         m_modp = origModp;
+        m_scopeOffp = origScopeOffp;
         m_modPastNum = origPastNum;
     }
     virtual void visit(AstBegin* nodep) VL_OVERRIDE {
@@ -390,6 +419,7 @@ public:
     explicit AssertVisitor(AstNetlist* nodep) {
         m_beginp = NULL;
         m_modp = NULL;
+        m_scopeOffp = NULL;
         m_modPastNum = 0;
         // Process
         iterate(nodep);
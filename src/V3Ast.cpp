@@ -51,6 +51,9 @@ bool AstUser5InUse::s_userBusy = false;
 
 int AstNodeDType::s_uniqueNum = 0;
 
+// Default costs, see VInstrCost::en for the order
+int VInstrCost::s_costs[VInstrCost::_ENUM_END] = {4, 10, 1000, 2, 3, 20, 20, 8, 40, 200, 100, 1};
+
 //######################################################################
 // V3AstType
 
@@ -452,6 +455,7 @@ AstNode* AstNode::unlinkFrBackWithNext(AstNRelinker* linkerp) {
     UASSERT(oldp->m_backp, "Node has no back, already unlinked?");
     oldp->editCountInc();
     AstNode* backp = oldp->m_backp;
+    backp->editCountInc();  // So the remaining tree shows something was removed
     if (linkerp) {
         linkerp->m_oldp = oldp;
         linkerp->m_backp = backp;
@@ -512,6 +516,7 @@ AstNode* AstNode::unlinkFrBack(AstNRelinker* linkerp) {
     UASSERT(oldp->m_backp, "Node has no back, already unlinked?");
     oldp->editCountInc();
     AstNode* backp = oldp->m_backp;
+    backp->editCountInc();  // So the remaining tree shows something was removed
     if (linkerp) {
         linkerp->m_oldp = oldp;
         linkerp->m_backp = backp;
@@ -974,9 +979,10 @@ std::ostream& operator<<(std::ostream& os, const V3Hash& rhs) {
 }
 
 V3Hash::V3Hash(const string& name) {
-    uint32_t val = 0;
+    // FNV-1a
+    uint32_t val = 2166136261U;
     for (string::const_iterator it = name.begin(); it != name.end(); ++it) {
-        val = val * 31 + *it;
+        val = (val ^ static_cast<unsigned char>(*it)) * 16777619U;
     }
     setBoth(1, val);
 }
@@ -24,6 +24,7 @@
 #include "V3FileLine.h"
 #include "V3Number.h"
 #include "V3Global.h"
+#include "V3Pool.h"
 
 #include <cmath>
 #include VL_INCLUDE_UNORDERED_SET
@@ -198,7 +199,8 @@ public:
         TRACE_FULL,
         TRACE_FULL_SUB,
         TRACE_CHANGE,
-        TRACE_CHANGE_SUB
+        TRACE_CHANGE_SUB,
+        TRACE_CHANGE_CHUNK
     };
     enum en m_e;
     inline AstCFuncType()
@@ -212,7 +214,8 @@ public:
     // METHODS
     bool isTrace() const {
         return (m_e == TRACE_INIT || m_e == TRACE_INIT_SUB || m_e == TRACE_FULL
-                || m_e == TRACE_FULL_SUB || m_e == TRACE_CHANGE || m_e == TRACE_CHANGE_SUB);
+                || m_e == TRACE_FULL_SUB || m_e == TRACE_CHANGE || m_e == TRACE_CHANGE_SUB
+                || m_e == TRACE_CHANGE_CHUNK);
     }
 };
 inline bool operator==(const AstCFuncType& lhs, const AstCFuncType& rhs) {
@@ -346,9 +349,11 @@ public:
         VAR_PUBLIC_FLAT,                // V3LinkParse moves to AstVar::sigPublic
         VAR_PUBLIC_FLAT_RD,             // V3LinkParse moves to AstVar::sigPublic
         VAR_PUBLIC_FLAT_RW,             // V3LinkParse moves to AstVar::sigPublic
+        VAR_PUBLIC_OBSERVE,             // V3LinkParse makes a public snapshot AstVar
         VAR_ISOLATE_ASSIGNMENTS,        // V3LinkParse moves to AstVar::attrIsolateAssign
         VAR_SC_BV,                      // V3LinkParse moves to AstVar::attrScBv
         VAR_SFORMAT,                    // V3LinkParse moves to AstVar::attrSFormat
+        VAR_SPARSE,                     // V3LinkParse moves to AstVar::attrSparse
         VAR_CLOCKER,                    // V3LinkParse moves to AstVar::attrClocker
         VAR_NO_CLOCKER,                 // V3LinkParse moves to AstVar::attrClocker
         VAR_SPLIT_VAR                   // V3LinkParse moves to AstVar::attrSplitVar
@@ -367,8 +372,8 @@ public:
             "MEMBER_BASE",
             "TYPENAME",
             "VAR_BASE", "VAR_CLOCK", "VAR_CLOCK_ENABLE", "VAR_PUBLIC",
-            "VAR_PUBLIC_FLAT", "VAR_PUBLIC_FLAT_RD", "VAR_PUBLIC_FLAT_RW",
-            "VAR_ISOLATE_ASSIGNMENTS", "VAR_SC_BV", "VAR_SFORMAT", "VAR_CLOCKER",
+            "VAR_PUBLIC_FLAT", "VAR_PUBLIC_FLAT_RD", "VAR_PUBLIC_FLAT_RW", "VAR_PUBLIC_OBSERVE",
+            "VAR_ISOLATE_ASSIGNMENTS", "VAR_SC_BV", "VAR_SFORMAT", "VAR_SPARSE", "VAR_CLOCKER",
             "VAR_NO_CLOCKER", "VAR_SPLIT_VAR"
         };
         // clang-format on
@@ -1042,6 +1047,49 @@ inline std::ostream& operator<<(std::ostream& os, const VUseType& rhs) {
 
 //######################################################################
 
+class VInstrCost {
+public:
+    // Costs of the runtime's primitives, in instruction cycles, for V3InstrCount
+    enum en {
+        BRANCH,  // Branch
+        DIV,  // Integer divide
+        DPI,  // Call user function
+        LD,  // Load memory
+        MUL,  // Integer multiply
+        PLI,  // Call pli routine
+        DISPLAY,  // Format a $display or $sformat
+        DOUBLE,  // Convert or do floats
+        DOUBLE_DIV,  // Divide floats
+        DOUBLE_TRIG,  // Trigonomics
+        STRING,  // String op
+        WIDE,  // Each word of a wide op
+        _ENUM_END
+    };
+    enum en m_e;
+    // cppcheck-suppress noExplicitConstructor
+    inline VInstrCost(en _e)
+        : m_e(_e) {}
+    explicit inline VInstrCost(int _e)
+        : m_e(static_cast<en>(_e)) {}
+    operator en() const { return m_e; }
+    const char* ascii() const {
+        static const char* const names[]
+            = {"branch",  "div",    "dpi",        "ld",          "mul",    "pli",
+               "display", "double", "double_div", "double_trig", "string", "wide"};
+        return names[m_e];
+    }
+    int cost() const { return s_costs[m_e]; }
+    void cost(int value) { s_costs[m_e] = value; }
+
+private:
+    static int s_costs[_ENUM_END];  // Current costs, defaults or from --instr-costs
+};
+inline bool operator==(const VInstrCost& lhs, const VInstrCost& rhs) { return lhs.m_e == rhs.m_e; }
+inline bool operator==(const VInstrCost& lhs, VInstrCost::en rhs) { return lhs.m_e == rhs; }
+inline bool operator==(VInstrCost::en lhs, const VInstrCost& rhs) { return lhs == rhs.m_e; }
+
+//######################################################################
+
 class VBasicTypeKey {
 public:
     int m_width;  // From AstNodeDType: Bit width of operation
@@ -1300,7 +1348,11 @@ class V3Hash {
     void setBoth(uint32_t depth, uint32_t hshval) {
         if (depth == 0) depth = 1;
         if (depth > 255) depth = 255;
-        m_both = (depth << 24) | (hshval & M24);
+        m_both = (depth << 24) | ((hshval ^ (hshval >> 24)) & M24);  // Fold in upper bits
+    }
+    static uint32_t combine(uint32_t seed, uint32_t val) {
+        // Mixing so that operand order matters, unlike with a simple multiply-add
+        return seed ^ (val + 0x9e3779b9U + (seed << 6) + (seed >> 2));
     }
 
 public:
@@ -1320,7 +1372,7 @@ public:
     // Saving and restoring inside a userp
     explicit V3Hash(VNUser u) { m_both = u.toInt(); }
     V3Hash operator+=(const V3Hash& rh) {
-        setBoth(depth() + rh.depth(), (hshval() * 31 + rh.hshval()));
+        setBoth(depth() + rh.depth(), combine(hshval(), rh.hshval()));
         return *this;
     }
     // Creating from raw data (sameHash functions)
@@ -1331,12 +1383,13 @@ public:
     V3Hash(const void* vp) { setBoth(1, cvtToHash(vp)); }
     // cppcheck-suppress noExplicitConstructor
     V3Hash(const string& name);
-    V3Hash(V3Hash h1, V3Hash h2) { setBoth(1, h1.hshval() * 31 + h2.hshval()); }
+    V3Hash(V3Hash h1, V3Hash h2) { setBoth(1, combine(h1.hshval(), h2.hshval())); }
     V3Hash(V3Hash h1, V3Hash h2, V3Hash h3) {
-        setBoth(1, (h1.hshval() * 31 + h2.hshval()) * 31 + h3.hshval());
+        setBoth(1, combine(combine(h1.hshval(), h2.hshval()), h3.hshval()));
     }
     V3Hash(V3Hash h1, V3Hash h2, V3Hash h3, V3Hash h4) {
-        setBoth(1, ((h1.hshval() * 31 + h2.hshval()) * 31 + h3.hshval()) * 31 + h4.hshval());
+        setBoth(1, combine(combine(combine(h1.hshval(), h2.hshval()), h3.hshval()),
+                           h4.hshval()));
     }
 };
 std::ostream& operator<<(std::ostream& os, const V3Hash& rhs);
@@ -1375,8 +1428,6 @@ class AstNode {
 
     AstNode* m_headtailp;  // When at begin/end of list, the opposite end of the list
 
-    const AstType m_type;  // Node sub-type identifier
-
     FileLine* m_fileline;  // Where it was declared
     vluint64_t m_editCount;  // When it was last edited
     static vluint64_t s_editCntGbl;  // Global edit counter
@@ -1386,15 +1437,11 @@ class AstNode {
     AstNodeDType* m_dtypep;  // Data type of output or assignment (etc)
 
     AstNode* m_clonep;  // Pointer to clone of/ source of this module (for *LAST* cloneTree() ONLY)
+    // Pairs of 32 bit members, so there is no padding for 64 bit alignment
+    const AstType m_type;  // Node sub-type identifier
     int m_cloneCnt;  // Mark of when userp was set
     static int s_cloneCntGbl;  // Count of which userp is set
 
-    // Attributes
-    bool m_didWidth : 1;  // Did V3Width computation
-    bool m_doingWidth : 1;  // Inside V3Width
-    bool m_protect : 1;  // Protect name if protection is on
-    //          // Space for more bools here
-
     // This member ordering both allows 64 bit alignment and puts associated data together
     VNUser m_user1u;  // Contains any information the user iteration routine wants
     uint32_t m_user1Cnt;  // Mark of when userp was set
@@ -1407,6 +1454,12 @@ class AstNode {
     VNUser m_user5u;  // Contains any information the user iteration routine wants
     uint32_t m_user5Cnt;  // Mark of when userp was set
 
+    // Attributes, packed beside m_user5Cnt
+    bool m_didWidth : 1;  // Did V3Width computation
+    bool m_doingWidth : 1;  // Inside V3Width
+    bool m_protect : 1;  // Protect name if protection is on
+    //          // Space for more bools here
+
     // METHODS
     void op1p(AstNode* nodep) {
         m_op1p = nodep;
@@ -1515,19 +1568,38 @@ public:
 #ifdef VL_LEAK_CHECKS
     static void* operator new(size_t size);
     static void operator delete(void* obj, size_t size);
+#else
+    // Nodes are small and very numerous, so pool them
+    static void* operator new(size_t size) { return vPoolAllocThread().alloc(size); }
+    static void operator delete(void* objp, size_t size) { vPoolAllocThread().free(objp, size); }
 #endif
 
     // CONSTANT ACCESSORS
-    static int instrCountBranch() { return 4; }  ///< Instruction cycles to branch
-    static int instrCountDiv() { return 10; }  ///< Instruction cycles to divide
-    static int instrCountDpi() { return 1000; }  ///< Instruction cycles to call user function
-    static int instrCountLd() { return 2; }  ///< Instruction cycles to load memory
-    static int instrCountMul() { return 3; }  ///< Instruction cycles to multiply integers
-    static int instrCountPli() { return 20; }  ///< Instruction cycles to call pli routines
-    static int instrCountDouble() { return 8; }  ///< Instruction cycles to convert or do floats
-    static int instrCountDoubleDiv() { return 40; }  ///< Instruction cycles to divide floats
-    static int instrCountDoubleTrig() { return 200; }  ///< Instruction cycles to do trigonomics
-    static int instrCountString() { return 100; }  ///< Instruction cycles to do string ops
+    // Defaults are in V3Ast.cpp, replaced by --instr-costs
+    /// Instruction cycles to branch
+    static int instrCountBranch() { return VInstrCost(VInstrCost::BRANCH).cost(); }
+    /// Instruction cycles to divide
+    static int instrCountDiv() { return VInstrCost(VInstrCost::DIV).cost(); }
+    /// Instruction cycles to call user function
+    static int instrCountDpi() { return VInstrCost(VInstrCost::DPI).cost(); }
+    /// Instruction cycles to load memory
+    static int instrCountLd() { return VInstrCost(VInstrCost::LD).cost(); }
+    /// Instruction cycles to multiply integers
+    static int instrCountMul() { return VInstrCost(VInstrCost::MUL).cost(); }
+    /// Instruction cycles to call pli routines
+    static int instrCountPli() { return VInstrCost(VInstrCost::PLI).cost(); }
+    /// Instruction cycles to format a $display
+    static int instrCountDisplay() { return VInstrCost(VInstrCost::DISPLAY).cost(); }
+    /// Instruction cycles to convert or do floats
+    static int instrCountDouble() { return VInstrCost(VInstrCost::DOUBLE).cost(); }
+    /// Instruction cycles to divide floats
+    static int instrCountDoubleDiv() { return VInstrCost(VInstrCost::DOUBLE_DIV).cost(); }
+    /// Instruction cycles to do trigonomics
+    static int instrCountDoubleTrig() { return VInstrCost(VInstrCost::DOUBLE_TRIG).cost(); }
+    /// Instruction cycles to do string ops
+    static int instrCountString() { return VInstrCost(VInstrCost::STRING).cost(); }
+    /// Instruction cycles for each word of a wide op
+    static int instrCountWide() { return VInstrCost(VInstrCost::WIDE).cost(); }
     /// Instruction cycles to call subroutine
     static int instrCountCall() { return instrCountBranch() + 10; }
     /// Instruction cycles to determine simulation time
@@ -2230,7 +2302,7 @@ private:
     AstVar* m_varp;  // [AfterLink] Pointer to variable itself
     AstVarScope* m_varScopep;  // Varscope for hierarchy
     AstNodeModule* m_packagep;  // Package hierarchy
-    string m_name;  // Name of variable
+    VStringIntern m_name;  // Name of variable
     string m_hiername;  // Scope converted into name-> for emitting
     bool m_hierThis;  // Hiername points to "this" function
     void init();
@@ -2603,7 +2675,7 @@ public:
 
 class AstNodeFTask : public AstNode {
 private:
-    string m_name;  // Name of task
+    VStringIntern m_name;  // Name of task
     string m_cname;  // Name of task if DPI import
     uint64_t m_dpiOpenParent;  // DPI import open array, if !=0, how many callees
     bool m_taskPublic : 1;  // Public task
@@ -2615,6 +2687,8 @@ private:
     bool m_dpiContext : 1;  // DPI import context
     bool m_dpiOpenChild : 1;  // DPI import open array child wrapper
     bool m_dpiTask : 1;  // DPI import task (vs. void function)
+    bool m_dpiThreadsafe : 1;  // DPI import may be called concurrently
+    bool m_dpiAsync : 1;  // DPI import calls are queued, see VerilatedDpiAsync
     bool m_isConstructor : 1;  // Class constructor
     bool m_pure : 1;  // DPI import pure (vs. virtual pure)
     VLifetime m_lifetime;  // Lifetime
@@ -2632,6 +2706,8 @@ public:
         , m_dpiContext(false)
         , m_dpiOpenChild(false)
         , m_dpiTask(false)
+        , m_dpiThreadsafe(false)
+        , m_dpiAsync(false)
         , m_isConstructor(false)
         , m_pure(false) {
         addNOp3p(stmtsp);
@@ -2678,6 +2754,10 @@ public:
     bool dpiOpenChild() const { return m_dpiOpenChild; }
     void dpiTask(bool flag) { m_dpiTask = flag; }
     bool dpiTask() const { return m_dpiTask; }
+    void dpiThreadsafe(bool flag) { m_dpiThreadsafe = flag; }
+    bool dpiThreadsafe() const { return m_dpiThreadsafe; }
+    void dpiAsync(bool flag) { m_dpiAsync = flag; }
+    bool dpiAsync() const { return m_dpiAsync; }
     void isConstructor(bool flag) { m_isConstructor = flag; }
     bool isConstructor() const { return m_isConstructor; }
     void pure(bool flag) { m_pure = flag; }
@@ -2691,7 +2771,7 @@ class AstNodeFTaskRef : public AstNodeStmt {
     // Functions are not statements, while tasks are. AstNodeStmt needs isStatement() to deal.
 private:
     AstNodeFTask* m_taskp;  // [AfterLink] Pointer to task referenced
-    string m_name;  // Name of variable
+    VStringIntern m_name;  // Name of variable
     string m_dotted;  // Dotted part of scope the name()ed task/func is under or ""
     string m_inlinedDots;  // Dotted hierarchy flattened out
     AstNodeModule* m_packagep;  // Package hierarchy
@@ -2747,7 +2827,7 @@ class AstNodeModule : public AstNode {
     // something that can live directly under the TOP,
     // excluding $unit package stuff
 private:
-    string m_name;  // Name of the module
+    VStringIntern m_name;  // Name of the module
     string m_origName;  // Name of the module, ignoring name() changes, for dot lookup
     string m_hierName;  // Hierarchical name for errors, etc.
     bool m_modPublic : 1;  // Module has public references
@@ -2862,7 +2942,7 @@ inline bool AstNode::width1() const {  // V3Const uses to know it can optimize
     return dtypep() && dtypep()->width() == 1;
 }
 inline int AstNode::widthInstrs() const {
-    return (!dtypep() ? 1 : (dtypep()->isWide() ? dtypep()->widthWords() : 1));
+    return (!dtypep() ? 1 : (dtypep()->isWide() ? dtypep()->widthWords() * instrCountWide() : 1));
 }
 inline bool AstNode::isDouble() const {
     return dtypep() && VN_IS(dtypep(), BasicDType) && VN_CAST(dtypep(), BasicDType)->isDouble();
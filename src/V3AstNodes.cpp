@@ -321,7 +321,9 @@ AstVar::VlArgTypeRecursed AstVar::vlArgTypeRecurse(bool forFunc, const AstNodeDT
     if (const AstAssocArrayDType* adtypep = VN_CAST_CONST(dtypep, AssocArrayDType)) {
         const VlArgTypeRecursed key = vlArgTypeRecurse(false, adtypep->keyDTypep(), true);
         const VlArgTypeRecursed val = vlArgTypeRecurse(false, adtypep->subDTypep(), true);
-        info.m_type = "VlAssocArray<" + key.m_type + ", " + val.m_type + ">";
+        // Only the variable itself may be unordered; element types are always ordered
+        const string cls = (!compound && isAssocHash()) ? "VlAssocHashArray" : "VlAssocArray";
+        info.m_type = cls + "<" + key.m_type + ", " + val.m_type + ">";
     } else if (const AstDynArrayDType* adtypep = VN_CAST_CONST(dtypep, DynArrayDType)) {
         const VlArgTypeRecursed sub = vlArgTypeRecurse(false, adtypep->subDTypep(), true);
         info.m_type = "VlQueue<" + sub.m_type + ">";
@@ -338,8 +340,14 @@ AstVar::VlArgTypeRecursed AstVar::vlArgTypeRecurse(bool forFunc, const AstNodeDT
             v3fatalSrc("Dynamic arrays or queues with unpacked elements are not yet supported");
         }
         const VlArgTypeRecursed sub = vlArgTypeRecurse(false, adtypep->subDTypep(), compound);
-        info.m_type = sub.m_type;
-        info.m_dims = "[" + cvtToStr(adtypep->declRange().elements()) + "]" + sub.m_dims;
+        if (attrSparse() && dtypep == dtypeSkipRefp()) {
+            // Only the outermost dimension is sparse; rows are ordinary C types
+            info.m_type = "VlSparseArray<" + sub.m_type + sub.m_dims + ", "
+                          + cvtToStr(adtypep->declRange().elements()) + "> ";
+        } else {
+            info.m_type = sub.m_type;
+            info.m_dims = "[" + cvtToStr(adtypep->declRange().elements()) + "]" + sub.m_dims;
+        }
     } else if (const AstBasicDType* bdtypep = dtypep->basicp()) {
         // We don't print msb()/lsb() as multidim packed would require recursion,
         // and may confuse users as C++ data is stored always with bit 0 used
@@ -1427,12 +1435,14 @@ void AstVar::dump(std::ostream& str) const {
     if (attrClockEn()) str << " [aCLKEN]";
     if (attrIsolateAssign()) str << " [aISO]";
     if (attrFileDescr()) str << " [aFD]";
+    if (attrSparse()) str << " [aSPARSE]";
     if (isFuncReturn()) {
         str << " [FUNCRTN]";
     } else if (isFuncLocal()) {
         str << " [FUNC]";
     }
     if (isDpiOpenArray()) str << " [DPIOPENA]";
+    if (isAssocHash()) str << " [HASH]";
     if (!attrClocker().unknown()) str << " [" << attrClocker().ascii() << "] ";
     if (!lifetime().isNone()) str << " [" << lifetime().ascii() << "] ";
     str << " " << varType();
@@ -1487,6 +1497,8 @@ void AstNodeFTask::dump(std::ostream& str) const {
     if (prototype()) str << " [PROTOTYPE]";
     if (dpiImport()) str << " [DPII]";
     if (dpiExport()) str << " [DPIX]";
+    if (dpiThreadsafe()) str << " [DPITHREADSAFE]";
+    if (dpiAsync()) str << " [DPIASYNC]";
     if (dpiOpenChild()) str << " [DPIOPENCHILD]";
     if (dpiOpenParent()) str << " [DPIOPENPARENT]";
     if ((dpiImport() || dpiExport()) && cname() != name()) str << " [c=" << cname() << "]";
@@ -1549,6 +1561,7 @@ void AstCFile::dump(std::ostream& str) const {
     this->AstNode::dump(str);
     if (source()) str << " [SRC]";
     if (slow()) str << " [SLOW]";
+    if (complexityScore()) str << " cost=" << complexityScore();
 }
 void AstCFunc::dump(std::ostream& str) const {
     this->AstNode::dump(str);
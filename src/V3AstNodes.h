@@ -1750,8 +1750,8 @@ public:
 class AstVar : public AstNode {
     // A variable (in/out/wire/reg/param) inside a module
 private:
-    string m_name;  // Name of variable
-    string m_origName;  // Original name before dot addition
+    VStringIntern m_name;  // Name of variable
+    VStringIntern m_origName;  // Original name before dot addition
     string m_tag;  // Holds the string of the verilator tag -- used in XML output.
     AstVarType m_varType;  // Type of variable
     VDirection m_direction;  // Direction input/output etc
@@ -1768,6 +1768,7 @@ private:
     bool m_sigModPublic : 1;  // User C code accesses this signal and module
     bool m_sigUserRdPublic : 1;  // User C code accesses this signal, read only
     bool m_sigUserRWPublic : 1;  // User C code accesses this signal, read-write
+    bool m_sigObserve : 1;  // Read-only snapshot of a public_observe signal
     bool m_usedClock : 1;  // Signal used as a clock
     bool m_usedParam : 1;  // Parameter is referenced (on link; later signals not setup)
     bool m_usedLoopIdx : 1;  // Variable subject of for unrolling
@@ -1778,6 +1779,7 @@ private:
     bool m_attrIsolateAssign : 1;  // User isolate_assignments attribute
     bool m_attrSFormat : 1;  // User sformat attribute
     bool m_attrSplitVar : 1;  // declared with split_var metacomment
+    bool m_attrSparse : 1;  // declared with sparse metacomment
     bool m_fileDescr : 1;  // File descriptor
     bool m_isConst : 1;  // Table contains constant data
     bool m_isStatic : 1;  // Static C variable (for Verilog see instead isAutomatic)
@@ -1785,12 +1787,14 @@ private:
     bool m_isPullup : 1;  // Tri1
     bool m_isIfaceParent : 1;  // dtype is reference to interface present in this module
     bool m_isDpiOpenArray : 1;  // DPI import open array
+    bool m_isAssocHash : 1;  // Associative array needs no ordering, use hash table
     bool m_noReset : 1;  // Do not do automated reset/randomization
     bool m_noSubst : 1;  // Do not substitute out references
     bool m_trace : 1;  // Trace this variable
     VLifetime m_lifetime;  // Lifetime
     VVarAttrClocker m_attrClocker;
     MTaskIdSet m_mtaskIds;  // MTaskID's that read or write this var
+    MTaskIdSet m_mtaskWriteIds;  // MTaskID's that write this var
 
     void init() {
         m_ansi = false;
@@ -1807,6 +1811,7 @@ private:
         m_sigModPublic = false;
         m_sigUserRdPublic = false;
         m_sigUserRWPublic = false;
+        m_sigObserve = false;
         m_funcLocal = false;
         m_funcReturn = false;
         m_attrClockEn = false;
@@ -1814,6 +1819,7 @@ private:
         m_attrIsolateAssign = false;
         m_attrSFormat = false;
         m_attrSplitVar = false;
+        m_attrSparse = false;
         m_fileDescr = false;
         m_isConst = false;
         m_isStatic = false;
@@ -1821,6 +1827,7 @@ private:
         m_isPullup = false;
         m_isIfaceParent = false;
         m_isDpiOpenArray = false;
+        m_isAssocHash = false;
         m_noReset = false;
         m_noSubst = false;
         m_trace = false;
@@ -1883,6 +1890,7 @@ public:
         if (examplep->childDTypep()) { childDTypep(examplep->childDTypep()->cloneTree(true)); }
         dtypeFrom(examplep);
         m_declKwd = examplep->declKwd();
+        m_isAssocHash = examplep->isAssocHash();  // Must be same C++ type
     }
     ASTNODE_NODE_FUNCS(Var)
     virtual void dump(std::ostream& str) const;
@@ -1945,6 +1953,7 @@ public:
     void attrIsolateAssign(bool flag) { m_attrIsolateAssign = flag; }
     void attrSFormat(bool flag) { m_attrSFormat = flag; }
     void attrSplitVar(bool flag) { m_attrSplitVar = flag; }
+    void attrSparse(bool flag) { m_attrSparse = flag; }
     void usedClock(bool flag) { m_usedClock = flag; }
     void usedParam(bool flag) { m_usedParam = flag; }
     void usedLoopIdx(bool flag) { m_usedLoopIdx = flag; }
@@ -1958,6 +1967,10 @@ public:
         m_sigUserRWPublic = flag;
         if (flag) sigUserRdPublic(true);
     }
+    void sigObserve(bool flag) {
+        m_sigObserve = flag;
+        if (flag) sigUserRdPublic(true);
+    }
     void sc(bool flag) { m_sc = flag; }
     void scSensitive(bool flag) { m_scSensitive = flag; }
     void primaryIO(bool flag) { m_primaryIO = flag; }
@@ -1968,6 +1981,8 @@ public:
     void funcReturn(bool flag) { m_funcReturn = flag; }
     void isDpiOpenArray(bool flag) { m_isDpiOpenArray = flag; }
     bool isDpiOpenArray() const { return m_isDpiOpenArray; }
+    void isAssocHash(bool flag) { m_isAssocHash = flag; }
+    bool isAssocHash() const { return m_isAssocHash; }
     void noReset(bool flag) { m_noReset = flag; }
     bool noReset() const { return m_noReset; }
     void noSubst(bool flag) { m_noSubst = flag; }
@@ -2022,6 +2037,9 @@ public:
     bool isSigModPublic() const { return m_sigModPublic; }
     bool isSigUserRdPublic() const { return m_sigUserRdPublic; }
     bool isSigUserRWPublic() const { return m_sigUserRWPublic; }
+    bool isSigObserve() const { return m_sigObserve; }
+    // Suffix of a public_observe signal's snapshot, which C code sees by the signal's name
+    static string observeSuffix() { return "__Vobserve"; }
     bool isTrace() const { return m_trace; }
     bool isConst() const { return m_isConst; }
     bool isStatic() const { return m_isStatic; }
@@ -2035,6 +2053,7 @@ public:
     bool attrScClocked() const { return m_scClocked; }
     bool attrSFormat() const { return m_attrSFormat; }
     bool attrSplitVar() const { return m_attrSplitVar; }
+    bool attrSparse() const { return m_attrSparse; }
     bool attrIsolateAssign() const { return m_attrIsolateAssign; }
     VVarAttrClocker attrClocker() const { return m_attrClocker; }
     virtual string verilogKwd() const;
@@ -2072,7 +2091,9 @@ public:
     static AstVar* scVarRecurse(AstNode* nodep);
     void addProducingMTaskId(int id) { m_mtaskIds.insert(id); }
     void addConsumingMTaskId(int id) { m_mtaskIds.insert(id); }
+    void addWritingMTaskId(int id) { m_mtaskWriteIds.insert(id); }
     const MTaskIdSet& mtaskIds() const { return m_mtaskIds; }
+    const MTaskIdSet& mtaskWriteIds() const { return m_mtaskWriteIds; }
     string mtasksString() const;
 
 private:
@@ -2122,7 +2143,7 @@ class AstScope : public AstNode {
     // Children: NODEBLOCK
 private:
     // An AstScope->name() is special: . indicates an uninlined scope, __DOT__ an inlined scope
-    string m_name;  // Name
+    VStringIntern m_name;  // Name
     AstScope* m_aboveScopep;  // Scope above this one in the hierarchy (NULL if top)
     AstCell* m_aboveCellp;  // Cell above this in the hierarchy (NULL if top)
     AstNodeModule* m_modp;  // Module scope corresponds to
@@ -2297,7 +2318,7 @@ class AstPin : public AstNode {
     // A pin on a cell
 private:
     int m_pinNum;  // Pin number
-    string m_name;  // Pin name, or "" for number based interconnect
+    VStringIntern m_name;  // Pin name, or "" for number based interconnect
     AstVar* m_modVarp;  // Input/output this pin connects to on submodule.
     AstParamTypeDType* m_modPTypep;  // Param type this pin connects to on submodule.
     bool m_param;  // Pin connects to parameter
@@ -2618,7 +2639,7 @@ class AstCell : public AstNode {
     // A instantiation cell or interface call (don't know which until link)
 private:
     FileLine* m_modNameFileline;  // Where module the cell instances token was
-    string m_name;  // Cell name
+    VStringIntern m_name;  // Cell name
     string m_origName;  // Original name before dot addition
     string m_modName;  // Module the cell instances
     AstNodeModule* m_modp;  // [AfterLink] Pointer to module instanced
@@ -2684,7 +2705,7 @@ class AstCellInline : public AstNode {
     // It is augmented with the scope in V3Scope for VPI.
     // Children: When 2 levels inlined, other CellInline under this
 private:
-    string m_name;  // Cell name, possibly {a}__DOT__{b}...
+    VStringIntern m_name;  // Cell name, possibly {a}__DOT__{b}...
     string m_origModName;  // Original name of the module, ignoring name() changes, for dot lookup
     AstScope* m_scopep;  // The scope that the cell is inlined into
     VTimescale m_timeunit;  // Parent module time unit
@@ -3547,7 +3568,7 @@ public:
     }
     ASTNODE_NODE_FUNCS(SFormatF)
     virtual string name() const { return m_text; }
-    virtual int instrCount() const { return instrCountPli(); }
+    virtual int instrCount() const { return instrCountDisplay(); }
     virtual V3Hash sameHash() const { return V3Hash(text()); }
     virtual bool hasDType() const { return true; }
     virtual bool same(const AstNode* samep) const {
@@ -4011,11 +4032,13 @@ public:
 class AstNodeReadWriteMem : public AstNodeStmt {
 private:
     bool m_isHex;  // readmemh, not readmemb
+    bool m_isRaw;  // readmemraw/writememraw binary image, not text
 public:
     AstNodeReadWriteMem(AstType t, FileLine* fl, bool hex, AstNode* filenamep, AstNode* memp,
-                        AstNode* lsbp, AstNode* msbp)
+                        AstNode* lsbp, AstNode* msbp, bool raw)
         : AstNodeStmt(t, fl)
-        , m_isHex(hex) {
+        , m_isHex(hex)
+        , m_isRaw(raw) {
         setOp1p(filenamep);
         setOp2p(memp);
         setNOp3p(lsbp);
@@ -4028,9 +4051,11 @@ public:
     virtual bool isUnlikely() const { return true; }
     virtual V3Hash sameHash() const { return V3Hash(); }
     virtual bool same(const AstNode* samep) const {
-        return isHex() == static_cast<const AstNodeReadWriteMem*>(samep)->isHex();
+        const AstNodeReadWriteMem* asamep = static_cast<const AstNodeReadWriteMem*>(samep);
+        return isHex() == asamep->isHex() && isRaw() == asamep->isRaw();
     }
     bool isHex() const { return m_isHex; }
+    bool isRaw() const { return m_isRaw; }
     AstNode* filenamep() const { return op1p(); }
     AstNode* memp() const { return op2p(); }
     AstNode* lsbp() const { return op3p(); }
@@ -4041,20 +4066,29 @@ public:
 class AstReadMem : public AstNodeReadWriteMem {
 public:
     AstReadMem(FileLine* fl, bool hex, AstNode* filenamep, AstNode* memp, AstNode* lsbp,
-               AstNode* msbp)
-        : ASTGEN_SUPER(fl, hex, filenamep, memp, lsbp, msbp) {}
+               AstNode* msbp, bool raw = false)
+        : ASTGEN_SUPER(fl, hex, filenamep, memp, lsbp, msbp, raw) {}
     ASTNODE_NODE_FUNCS(ReadMem);
-    virtual string verilogKwd() const { return (isHex() ? "$readmemh" : "$readmemb"); }
-    virtual const char* cFuncPrefixp() const { return "VL_READMEM_"; }
+    virtual string verilogKwd() const {
+        return (isRaw() ? "$readmemraw" : isHex() ? "$readmemh" : "$readmemb");
+    }
+    virtual const char* cFuncPrefixp() const {
+        return isRaw() ? "VL_READMEMRAW_" : "VL_READMEM_";
+    }
 };
 
 class AstWriteMem : public AstNodeReadWriteMem {
 public:
-    AstWriteMem(FileLine* fl, AstNode* filenamep, AstNode* memp, AstNode* lsbp, AstNode* msbp)
-        : ASTGEN_SUPER(fl, true, filenamep, memp, lsbp, msbp) {}
+    AstWriteMem(FileLine* fl, AstNode* filenamep, AstNode* memp, AstNode* lsbp, AstNode* msbp,
+                bool raw = false)
+        : ASTGEN_SUPER(fl, !raw, filenamep, memp, lsbp, msbp, raw) {}
     ASTNODE_NODE_FUNCS(WriteMem)
-    virtual string verilogKwd() const { return (isHex() ? "$writememh" : "$writememb"); }
-    virtual const char* cFuncPrefixp() const { return "VL_WRITEMEM_"; }
+    virtual string verilogKwd() const {
+        return (isRaw() ? "$writememraw" : isHex() ? "$writememh" : "$writememb");
+    }
+    virtual const char* cFuncPrefixp() const {
+        return isRaw() ? "VL_WRITEMEMRAW_" : "VL_WRITEMEM_";
+    }
 };
 
 class AstSystemT : public AstNodeStmt {
@@ -8013,12 +8047,14 @@ private:
     bool m_slow : 1;  ///< Compile w/o optimization
     bool m_source : 1;  ///< Source file (vs header file)
     bool m_support : 1;  ///< Support file (non systemc)
+    int m_complexityScore;  ///< Estimated compile cost, to start large compiles first
 public:
     AstCFile(FileLine* fl, const string& name)
         : ASTGEN_SUPER(fl, name) {
         m_slow = false;
         m_source = false;
         m_support = false;
+        m_complexityScore = 0;
     }
     ASTNODE_NODE_FUNCS(CFile)
     virtual void dump(std::ostream& str = std::cout) const;
@@ -8028,6 +8064,8 @@ public:
     void source(bool flag) { m_source = flag; }
     bool support() const { return m_support; }
     void support(bool flag) { m_support = flag; }
+    int complexityScore() const { return m_complexityScore; }
+    void complexityScore(int value) { m_complexityScore = value; }
 };
 
 class AstCFunc : public AstNode {
@@ -8062,6 +8100,7 @@ private:
     bool m_dpiExportWrapper : 1;  // From dpi export; static function with dispatch table
     bool m_dpiImport : 1;  // From dpi import
     bool m_dpiImportWrapper : 1;  // Wrapper from dpi import
+    bool m_dpiThreadsafe : 1;  // Wrapper from dpi import that may be called concurrently
 public:
     AstCFunc(FileLine* fl, const string& name, AstScope* scopep, const string& rtnType = "")
         : ASTGEN_SUPER(fl) {
@@ -8089,6 +8128,7 @@ public:
         m_dpiExportWrapper = false;
         m_dpiImport = false;
         m_dpiImportWrapper = false;
+        m_dpiThreadsafe = false;
     }
     ASTNODE_NODE_FUNCS(CFunc)
     virtual string name() const { return m_name; }
@@ -8162,6 +8202,8 @@ public:
     void dpiImport(bool flag) { m_dpiImport = flag; }
     bool dpiImportWrapper() const { return m_dpiImportWrapper; }
     void dpiImportWrapper(bool flag) { m_dpiImportWrapper = flag; }
+    bool dpiThreadsafe() const { return m_dpiThreadsafe; }
+    void dpiThreadsafe(bool flag) { m_dpiThreadsafe = flag; }
     //
     // If adding node accessors, see below emptyBody
     AstNode* argsp() const { return op1p(); }
@@ -21,6 +21,14 @@
 //         Count calls into the function
 //      Then, if FTASK is called only once, add inline attribute
 //
+//      With --prof-branches-feedback, replace the prediction of each IF
+//      with one from the measured taken/not taken counts.
+//      With --prof-branches, wrap each IF's condition in a counter.
+//
+//      Then, mark as slow each CFUNC only called from unlikely branches,
+//      slow functions, or other such functions, so it is emitted cold
+//      into the slow files.
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -29,9 +37,14 @@
 #include "V3Global.h"
 #include "V3Branch.h"
 #include "V3Ast.h"
+#include "V3EmitCBase.h"
+#include "V3File.h"
+#include "V3Stats.h"
 
 #include <cstdarg>
+#include <fstream>
 #include <map>
+#include <memory>
 
 //######################################################################
 // Branch state, as a visitor of each AstNode
@@ -45,11 +58,14 @@ private:
 
     // TYPES
     typedef std::vector<AstCFunc*> CFuncVec;
+    typedef std::vector<AstNodeIf*> IfVec;
 
     // STATE
     int m_likely;  // Excuses for branch likely taken
     int m_unlikely;  // Excuses for branch likely not taken
     CFuncVec m_cfuncsp;  // List of all tasks
+    IfVec m_profIfps;  // IFs that may be profiled, in order of branch ID
+    AstCFunc* m_cfuncp;  // Current function, if it can reach vlSymsp
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -68,6 +84,7 @@ private:
     // VISITORS
     virtual void visit(AstNodeIf* nodep) VL_OVERRIDE {
         UINFO(4, " IF: " << nodep << endl);
+        if (m_cfuncp) m_profIfps.push_back(nodep);
         int lastLikely = m_likely;
         int lastUnlikely = m_unlikely;
         {
@@ -100,7 +117,15 @@ private:
     virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
         checkUnlikely(nodep);
         m_cfuncsp.push_back(nodep);
-        iterateChildren(nodep);
+        AstCFunc* lastCFuncp = m_cfuncp;
+        {
+            // Counters are found through vlSymsp, so the function must be passed it
+            bool hasSyms = (nodep->argTypes().find(EmitCBaseVisitor::symClassVar())
+                            != string::npos);
+            m_cfuncp = hasSyms ? nodep : NULL;
+            iterateChildren(nodep);
+        }
+        m_cfuncp = lastCFuncp;
     }
     virtual void visit(AstNode* nodep) VL_OVERRIDE {
         checkUnlikely(nodep);
@@ -114,21 +139,203 @@ private:
             if (!nodep->dontInline()) nodep->isInline(true);
         }
     }
+    void profFeedback(const string& filename) {
+        // Read back a --prof-branches profile. Branches are only identified by
+        // order, so the profile must come from the same design and options.
+        const vl_unique_ptr<std::ifstream> ifp(V3File::new_ifstream(filename));
+        if (ifp->fail()) {
+            v3fatal("Cannot open --prof-branches-feedback file: " << filename);
+            return;
+        }
+        typedef std::vector<std::pair<vluint64_t, vluint64_t> > CountVec;
+        CountVec counts;
+        uint32_t branches = 0;
+        string line;
+        while (std::getline(*ifp, line)) {
+            uint32_t id;
+            vluint64_t taken;
+            vluint64_t notTaken;
+            if (sscanf(line.c_str(),
+                       "VLPROF branch %u taken %" VL_PRI64 "u nottaken %" VL_PRI64 "u", &id,
+                       &taken, &notTaken)
+                == 3) {
+                if (id >= counts.size()) counts.resize(id + 1);
+                counts[id].first += taken;
+                counts[id].second += notTaken;
+            } else {
+                sscanf(line.c_str(), "VLPROF branches %u", &branches);
+            }
+        }
+        if (branches != m_profIfps.size() || counts.size() > m_profIfps.size()) {
+            v3warn(PROFOUTOFDATE, "--prof-branches-feedback profile does not match design ("
+                                      << branches << " branches), ignoring: " << filename);
+            return;
+        }
+        uint32_t changed = 0;
+        for (uint32_t id = 0; id < counts.size(); ++id) {
+            // Only trust a strong bias; an evenly split branch gets no hint
+            const vluint64_t taken = counts[id].first;
+            const vluint64_t notTaken = counts[id].second;
+            VBranchPred pred;
+            if (taken + notTaken == 0) continue;  // Never reached, keep static guess
+            if (taken >= 4 * notTaken) {
+                pred = VBranchPred::BP_LIKELY;
+            } else if (notTaken >= 4 * taken) {
+                pred = VBranchPred::BP_UNLIKELY;
+            }
+            AstNodeIf* ifp = m_profIfps[id];
+            if (pred != ifp->branchPred()) ++changed;
+            UINFO(6, "Feedback branch " << id << " taken " << taken << " nottaken " << notTaken
+                                        << " " << ifp << endl);
+            ifp->branchPred(pred);
+        }
+        V3Stats::addStat("Optimizations, Branch feedback predictions changed", changed);
+    }
+    void profInstrument() {
+        // Count each condition into vlSymsp->__Vm_profBranches[id]
+        for (uint32_t id = 0; id < m_profIfps.size(); ++id) {
+            AstNodeIf* ifp = m_profIfps[id];
+            FileLine* fl = ifp->condp()->fileline();
+            AstNode* condp = ifp->condp()->unlinkFrBack();
+            AstCMath* newp = new AstCMath(
+                fl, "VL_PROF_BRANCH(vlSymsp->__Vm_profBranches[" + cvtToStr(id) + "], ", 1);
+            newp->addBodysp(condp);
+            newp->addBodysp(new AstText(fl, ")"));
+            newp->pure(false);
+            ifp->condp(newp);
+        }
+        v3Global.profBranches(m_profIfps.size());
+    }
 
 public:
     // CONSTRUCTORS
-    explicit BranchVisitor(AstNetlist* nodep) {
+    explicit BranchVisitor(AstNetlist* nodep)
+        : m_cfuncp(NULL) {
         reset();
         iterateChildren(nodep);
         calc_tasks();
+        if (!v3Global.opt.profBranchesFeedback().empty()) {
+            profFeedback(v3Global.opt.profBranchesFeedback());
+        }
+        if (v3Global.opt.profBranches()) profInstrument();
     }
     virtual ~BranchVisitor() {}
 };
 
+//######################################################################
+// Find functions only called in cold code
+
+class BranchColdVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    // Entire netlist:
+    //  AstCFunc::user2()       -> bool.  Reached from hot code
+    //  AstCFunc::user3()       -> bool.  Called from somewhere
+    AstUser2InUse m_inuser2;
+    AstUser3InUse m_inuser3;
+
+    // TYPES
+    typedef std::vector<AstCFunc*> CFuncVec;
+    typedef std::vector<std::pair<AstCFunc*, AstCFunc*> > CallVec;
+
+    // STATE
+    CFuncVec m_cfuncsp;  // List of all functions
+    CallVec m_calls;  // Calls not under an unlikely branch, as (caller or NULL, callee)
+    AstCFunc* m_cfuncp;  // Current function
+    bool m_unlikely;  // Under a branch which is unlikely taken
+    VDouble0 m_statCold;  // Statistic tracking
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    static bool mayBeCold(const AstCFunc* nodep) {
+        // Functions called from outside the model must keep their declarations
+        return (!nodep->slow() && nodep->funcType() == AstCFuncType::FT_NORMAL
+                && !nodep->entryPoint() && !nodep->funcPublic() && !nodep->formCallTree()
+                && !nodep->isConstructor() && !nodep->isDestructor() && !nodep->dpiImport()
+                && !nodep->dpiExport() && !nodep->dpiExportWrapper()
+                && nodep->ifdef().empty());
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeIf* nodep) VL_OVERRIDE {
+        iterateAndNextNull(nodep->condp());
+        bool lastUnlikely = m_unlikely;
+        {
+            m_unlikely = lastUnlikely || nodep->branchPred().unlikely();
+            iterateAndNextNull(nodep->ifsp());
+            m_unlikely = lastUnlikely || nodep->branchPred().likely();
+            iterateAndNextNull(nodep->elsesp());
+        }
+        m_unlikely = lastUnlikely;
+    }
+    virtual void visit(AstNodeCCall* nodep) VL_OVERRIDE {
+        nodep->funcp()->user3(true);
+        if (!m_unlikely) m_calls.push_back(std::make_pair(m_cfuncp, nodep->funcp()));
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        m_cfuncsp.push_back(nodep);
+        AstCFunc* lastCFuncp = m_cfuncp;
+        bool lastUnlikely = m_unlikely;
+        {
+            m_cfuncp = nodep;
+            m_unlikely = false;
+            iterateChildren(nodep);
+        }
+        m_cfuncp = lastCFuncp;
+        m_unlikely = lastUnlikely;
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+    // METHODS
+    void calcHot() {
+        // Functions with no visible callers are called by name, so are roots
+        for (CFuncVec::iterator it = m_cfuncsp.begin(); it != m_cfuncsp.end(); ++it) {
+            AstCFunc* nodep = *it;
+            if (!nodep->slow() && (!nodep->user3() || !mayBeCold(nodep))) nodep->user2(true);
+        }
+        // Calls outside of functions are from mtask bodies, so hot
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (CallVec::iterator it = m_calls.begin(); it != m_calls.end(); ++it) {
+                AstCFunc* callerp = it->first;
+                AstCFunc* calleep = it->second;
+                if ((!callerp || callerp->user2()) && !calleep->user2() && !calleep->slow()) {
+                    calleep->user2(true);
+                    changed = true;
+                }
+            }
+        }
+        for (CFuncVec::iterator it = m_cfuncsp.begin(); it != m_cfuncsp.end(); ++it) {
+            AstCFunc* nodep = *it;
+            if (!nodep->slow() && !nodep->user2()) {
+                UINFO(4, "  COLD: " << nodep << endl);
+                nodep->slow(true);
+                ++m_statCold;
+            }
+        }
+    }
+
+public:
+    // CONSTRUCTORS
+    explicit BranchColdVisitor(AstNetlist* nodep)
+        : m_cfuncp(NULL)
+        , m_unlikely(false) {
+        iterateChildren(nodep);
+        calcHot();
+    }
+    virtual ~BranchColdVisitor() {
+        V3Stats::addStat("Optimizations, Cold CFuncs", m_statCold);
+    }
+};
+
 //######################################################################
 // Branch class functions
 
 void V3Branch::branchAll(AstNetlist* nodep) {
     UINFO(2, __FUNCTION__ << ": " << endl);
-    BranchVisitor visitor(nodep);
+    { BranchVisitor visitor(nodep); }
+    { BranchColdVisitor visitor(nodep); }
 }
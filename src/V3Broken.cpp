@@ -236,6 +236,9 @@ public:
 
 class BrokenCheckVisitor : public AstNVisitor {
 private:
+    // STATE
+    vluint64_t m_editCntMin;  // Only check nodes edited after this, 0=check all
+
     void checkWidthMin(const AstNode* nodep) {
         UASSERT_OBJ(nodep->width() == nodep->widthMin()
                         || v3Global.widthMinUsage() != VWidthMinUsage::MATCHES_WIDTH,
@@ -243,6 +246,11 @@ private:
     }
     void processAndIterate(AstNode* nodep) {
         BrokenTable::setUnder(nodep, true);
+        if (nodep->editCount() > m_editCntMin) checkNode(nodep);
+        iterateChildrenConst(nodep);
+        BrokenTable::setUnder(nodep, false);
+    }
+    void checkNode(AstNode* nodep) {
         const char* whyp = nodep->broken();
         UASSERT_OBJ(!whyp, nodep,
                     "Broken link in node (or something without maybePointedTo): " << whyp);
@@ -265,11 +273,10 @@ private:
             if (const AstNodeDType* dnodep = VN_CAST(nodep, NodeDType)) checkWidthMin(dnodep);
         }
         checkWidthMin(nodep);
-        iterateChildrenConst(nodep);
-        BrokenTable::setUnder(nodep, false);
     }
     virtual void visit(AstNodeAssign* nodep) VL_OVERRIDE {
         processAndIterate(nodep);
+        if (nodep->editCount() <= m_editCntMin) return;
         UASSERT_OBJ(!(v3Global.assertDTypesResolved() && nodep->brokeLhsMustBeLvalue()
                       && VN_IS(nodep->lhsp(), NodeVarRef)
                       && !VN_CAST(nodep->lhsp(), NodeVarRef)->lvalue()),
@@ -282,7 +289,10 @@ private:
 
 public:
     // CONSTRUCTORS
-    explicit BrokenCheckVisitor(AstNetlist* nodep) { iterate(nodep); }
+    BrokenCheckVisitor(AstNetlist* nodep, vluint64_t editCntMin)
+        : m_editCntMin(editCntMin) {
+        iterate(nodep);
+    }
     virtual ~BrokenCheckVisitor() {}
 };
 
@@ -297,9 +307,14 @@ void V3Broken::brokenAll(AstNetlist* nodep) {
         UINFO(1, "Broken called under broken, skipping recursion.\n");  // LCOV_EXCL_LINE
     } else {
         inBroken = true;
+        // With --debug-check-interval, between full checks only check the
+        // links of nodes edited since the previous check.  All nodes are
+        // still marked, so those links are checked against the whole tree.
+        static int s_checks = 0;
+        bool full = (s_checks++ % v3Global.opt.debugCheckInterval()) == 0;
         BrokenTable::prepForTree();
         BrokenMarkVisitor mvisitor(nodep);
-        BrokenCheckVisitor cvisitor(nodep);
+        BrokenCheckVisitor cvisitor(nodep, full ? 0 : AstNode::editCountLast());
         BrokenTable::doneWithTree();
         inBroken = false;
     }
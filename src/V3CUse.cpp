@@ -32,6 +32,7 @@
 #include "V3Ast.h"
 #include "V3EmitCBase.h"
 
+#include <set>
 #include VL_INCLUDE_UNORDERED_MAP
 
 //######################################################################
@@ -215,6 +216,80 @@ public:
     VL_UNCOPYABLE(CUseVisitor);
 };
 
+//######################################################################
+// With --syms-indirect, __Syms.h only forward declares the module classes,
+// so each module must include the classes it dereferences
+
+class CUseDerefVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    // Entire netlist:
+    //  AstVar::user3p()      -> AstNodeModule*.  Module declaring the variable
+    //  AstCFunc::user3p()    -> AstNodeModule*.  Module declaring the function
+    AstUser3InUse m_inuser3;
+
+    // MEMBERS
+    AstNodeModule* m_modInsertp;  // Current module to insert AstCUse under
+    std::set<AstNodeModule*> m_didUse;  // Modules already included by m_modInsertp
+    std::vector<AstCUse*> m_newps;  // Uses to add once done iterating the module
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    void derefModule(AstNode* nodep, AstNode* declp) {
+        AstNodeModule* modp = VN_CAST(declp->user3p(), NodeModule);
+        // The top is always complete, as __Syms.h needs it for TOPp
+        if (!modp || modp == m_modInsertp || modp->isTop() || VN_IS(modp, Class)) return;
+        if (!m_didUse.insert(modp).second) return;
+        AstCUse* newp = new AstCUse(nodep->fileline(), VUseType::IMP_INCLUDE, modp->name());
+        UINFO(8, "Insert " << newp << " for " << nodep << endl);
+        m_newps.push_back(newp);
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        AstNodeModule* origModp = m_modInsertp;
+        std::set<AstNodeModule*> origDidUse;
+        origDidUse.swap(m_didUse);
+        std::vector<AstCUse*> origNewps;
+        origNewps.swap(m_newps);
+        {
+            // A class is emitted into the file of its package
+            AstClass* classp = VN_CAST(nodep, Class);
+            m_modInsertp = (classp && classp->packagep()) ? classp->packagep() : nodep;
+            iterateChildren(nodep);
+            for (std::vector<AstCUse*>::iterator it = m_newps.begin(); it != m_newps.end();
+                 ++it) {
+                m_modInsertp->addStmtp(*it);
+            }
+        }
+        m_modInsertp = origModp;
+        m_didUse.swap(origDidUse);
+        m_newps.swap(origNewps);
+    }
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE { derefModule(nodep, nodep->varp()); }
+    virtual void visit(AstCCall* nodep) VL_OVERRIDE {
+        derefModule(nodep, nodep->funcp());
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit CUseDerefVisitor(AstNetlist* nodep)
+        : m_modInsertp(NULL) {
+        for (AstNodeModule* modp = nodep->modulesp(); modp;
+             modp = VN_CAST(modp->nextp(), NodeModule)) {
+            for (AstNode* stmtp = modp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+                if (VN_IS(stmtp, Var) || VN_IS(stmtp, CFunc)) stmtp->user3p(modp);
+            }
+        }
+        iterate(nodep);
+    }
+    virtual ~CUseDerefVisitor() {}
+    VL_UNCOPYABLE(CUseDerefVisitor);
+};
+
 //######################################################################
 // Class class functions
 
@@ -227,5 +302,6 @@ void V3CUse::cUseAll(AstNetlist* nodep) {
         // for each output file and put under that
         CUseVisitor visitor(modp);
     }
+    if (v3Global.opt.symsIndirect()) { CUseDerefVisitor visitor(nodep); }
     V3Global::dumpCheckGlobalTree("cuse", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
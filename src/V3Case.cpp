@@ -24,6 +24,11 @@
 //                                                  (other items))
 //                                              body
 //              Or, converts to a if/else tree.
+//          If every branch only sets the same variables to constants, and the
+//          if/else tree is deep enough, instead:
+//              VAR __Vcaseidx = v
+//              var1 = __Vcasetable_var1[__Vcaseidx]  (static const array)
+//              var2 = __Vcasetable_var2[__Vcaseidx]
 //      FUTURES:
 //          Large 16+ bit tables with constants and no masking (address muxes)
 //              Enter all into std::multimap, sort by value and use a tree of < and == compares.
@@ -40,14 +45,20 @@
 #include "V3Global.h"
 #include "V3Case.h"
 #include "V3Ast.h"
+#include "V3InstrCount.h"
 #include "V3Stats.h"
 
 #include <algorithm>
 #include <cstdarg>
+#include <map>
+#include <vector>
 
 #define CASE_OVERLAP_WIDTH 16  // Maximum width we can check for overlaps in
 #define CASE_BARF 999999  // Magic width when non-constant
 #define CASE_ENCODER_GROUP_DEPTH 8  // Levels of priority to be ORed together in top IF tree
+#define CASE_TABLE_MIN_INSTRS 16  // Minimum if/else tree depth in instructions to use a table
+#define CASE_TABLE_MAX_BYTES (64 * 1024)  // Maximum lookup table size, to stay in cache
+#define CASE_TABLE_SPACE_TIME_MULT 256  // Table bytes worth one instruction of tree depth
 
 //######################################################################
 
@@ -130,6 +141,9 @@ private:
     // STATE
     VDouble0 m_statCaseFast;  // Statistic tracking
     VDouble0 m_statCaseSlow;  // Statistic tracking
+    VDouble0 m_statCaseTable;  // Statistic tracking
+    AstScope* m_scopep;  // Current scope
+    int m_tableNum;  // Number of lookup tables created, for unique names
 
     // Per-CASE
     int m_caseWidth;  // Width of valueItems
@@ -137,6 +151,13 @@ private:
     bool m_caseNoOverlapsAllCovered;  // Proven to be synopsys parallel_case compliant
     // For each possible value, the case branch we need
     AstNode* m_valueItem[1 << CASE_OVERLAP_WIDTH];
+    // Lookup table candidate, see caseTableTest
+    typedef std::vector<AstConst*> TableValues;
+    AstNode* m_tableExprp;  // Clone of case expression, NULL if not a candidate
+    bool m_tableDly;  // Outputs are set with delayed assignments
+    std::vector<AstVarScope*> m_tableOutVscps;  // Output variables, in table order
+    std::vector<TableValues> m_tableBodies;  // Cloned output values for each unique body
+    std::vector<int> m_tableBodyIdx;  // For each possible value, index into m_tableBodies
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -226,6 +247,141 @@ private:
         return true;  // All is fine
     }
 
+    void clearTable() {
+        if (m_tableExprp) VL_DO_CLEAR(m_tableExprp->deleteTree(), m_tableExprp = NULL);
+        for (std::vector<TableValues>::iterator it = m_tableBodies.begin();
+             it != m_tableBodies.end(); ++it) {
+            for (TableValues::iterator vit = it->begin(); vit != it->end(); ++vit) {
+                if (*vit) (*vit)->deleteTree();
+            }
+        }
+        m_tableOutVscps.clear();
+        m_tableBodies.clear();
+        m_tableBodyIdx.clear();
+    }
+    bool caseTableTestBody(AstNode* bodyp) {
+        // Record the constants this branch sets, return false if not just constant sets
+        bool first = m_tableBodies.empty();
+        TableValues values(m_tableOutVscps.size(), NULL);
+        for (AstNode* stmtp = bodyp; stmtp; stmtp = stmtp->nextp()) {
+            if (!VN_IS(stmtp, Assign) && !VN_IS(stmtp, AssignDly)) return false;
+            AstNodeAssign* assp = VN_CAST(stmtp, NodeAssign);
+            AstVarRef* lhsp = VN_CAST(assp->lhsp(), VarRef);
+            AstConst* rhsp = VN_CAST(assp->rhsp(), Const);
+            if (!lhsp || !lhsp->varScopep() || !rhsp) return false;
+            if (lhsp->width() != rhsp->width() || !lhsp->dtypep()->basicp() || lhsp->isDouble()
+                || lhsp->isString()) {
+                return false;
+            }
+            bool dly = VN_IS(stmtp, AssignDly);
+            std::vector<AstVarScope*>::iterator it = std::find(
+                m_tableOutVscps.begin(), m_tableOutVscps.end(), lhsp->varScopep());
+            size_t outnum = it - m_tableOutVscps.begin();
+            if (first) {
+                if (it != m_tableOutVscps.end()) return false;  // Set twice
+                if (m_tableOutVscps.empty()) m_tableDly = dly;
+                m_tableOutVscps.push_back(lhsp->varScopep());
+                values.push_back(NULL);
+            } else if (it == m_tableOutVscps.end() || values[outnum]) {
+                return false;  // Not in first branch, or set twice
+            }
+            if (dly != m_tableDly) return false;
+            values[outnum] = rhsp;
+        }
+        if (values.empty()) return false;
+        for (TableValues::iterator vit = values.begin(); vit != values.end(); ++vit) {
+            if (!*vit) return false;  // Output not set in this branch
+            *vit = (*vit)->cloneTree(false);  // Case bodies are deleted by replaceCaseFast
+        }
+        m_tableBodies.push_back(values);
+        return true;
+    }
+    bool caseTableTest(AstCase* nodep) {
+        // After isCaseTreeFast, see if this case can instead be a set of lookup tables.
+        // Leaves the table values in m_table* for replaceCaseTable
+        if (!v3Global.opt.oTable() || !m_scopep) return false;
+        if (nodep->exprp()->width() != m_caseWidth || nodep->exprp()->isDouble()) return false;
+        std::map<AstNode*, int> bodyIdx;
+        for (uint32_t i = 0; i < (1UL << m_caseWidth); ++i) {
+            AstNode* bodyp = m_valueItem[i];
+            if (!bodyp) {
+                clearTable();
+                return false;
+            }
+            std::map<AstNode*, int>::iterator it = bodyIdx.find(bodyp);
+            if (it == bodyIdx.end()) {
+                if (!caseTableTestBody(bodyp)) {
+                    clearTable();
+                    return false;
+                }
+                it = bodyIdx.insert(make_pair(bodyp, int(m_tableBodies.size()) - 1)).first;
+            }
+            m_tableBodyIdx.push_back(it->second);
+        }
+        m_tableExprp = nodep->exprp()->cloneTree(false);
+        return true;
+    }
+    void replaceCaseTable(AstNode* ifrootp) {
+        // Replace if/else tree made by replaceCaseFast with lookup tables,
+        // when the tree is deep enough to be worth the space
+        FileLine* fl = m_tableExprp->fileline();
+        uint32_t treeInstrs = V3InstrCount::count(ifrootp, false);
+        double space = 0;
+        for (std::vector<AstVarScope*>::iterator it = m_tableOutVscps.begin();
+             it != m_tableOutVscps.end(); ++it) {
+            space += (*it)->varp()->dtypeSkipRefp()->widthTotalBytes();
+        }
+        space *= static_cast<double>(1UL << m_caseWidth);
+        UINFO(4, "  Case table test: treeInstrs=" << treeInstrs << " space=" << space << endl);
+        if (treeInstrs < CASE_TABLE_MIN_INSTRS || space > CASE_TABLE_MAX_BYTES
+            || space > static_cast<double>(treeInstrs) * CASE_TABLE_SPACE_TIME_MULT) {
+            clearTable();
+            return;
+        }
+        ++m_statCaseTable;
+        AstNodeModule* modp = m_scopep->modp();
+        const string tableNum = cvtToStr(m_tableNum++);
+        // Index into our tables
+        AstVar* indexVarp = new AstVar(fl, AstVarType::BLOCKTEMP, "__Vcaseidx" + tableNum,
+                                       VFlagBitPacked(), m_caseWidth);
+        modp->addStmtp(indexVarp);
+        AstVarScope* indexVscp = new AstVarScope(fl, m_scopep, indexVarp);
+        m_scopep->addVarp(indexVscp);
+        AstNode* stmtsp = new AstAssign(fl, new AstVarRef(fl, indexVscp, true), m_tableExprp);
+        m_tableExprp = NULL;
+        // Table for each output
+        for (size_t outnum = 0; outnum < m_tableOutVscps.size(); ++outnum) {
+            AstVarScope* outvscp = m_tableOutVscps[outnum];
+            AstNodeArrayDType* dtypep = new AstUnpackArrayDType(
+                fl, outvscp->varp()->dtypep(), new AstRange(fl, VL_MASK_I(m_caseWidth), 0));
+            v3Global.rootp()->typeTablep()->addTypesp(dtypep);
+            AstVar* tablevarp
+                = new AstVar(fl, AstVarType::MODULETEMP,
+                             "__Vcasetable" + tableNum + "_" + outvscp->varp()->name(), dtypep);
+            tablevarp->isConst(true);
+            tablevarp->isStatic(true);
+            AstInitArray* initp = new AstInitArray(fl, dtypep, NULL);
+            // Note InitArray requires us to have the values in index order
+            for (uint32_t i = 0; i < (1UL << m_caseWidth); ++i) {
+                initp->addValuep(m_tableBodies[m_tableBodyIdx[i]][outnum]->cloneTree(false));
+            }
+            tablevarp->valuep(initp);
+            modp->addStmtp(tablevarp);
+            AstVarScope* tablevscp = new AstVarScope(fl, m_scopep, tablevarp);
+            m_scopep->addVarp(tablevscp);
+            AstNode* alhsp = new AstVarRef(fl, outvscp, true);
+            AstNode* arhsp = new AstArraySel(fl, new AstVarRef(fl, tablevscp, false),
+                                             new AstVarRef(fl, indexVscp, false));
+            stmtsp->addNext(m_tableDly
+                                ? static_cast<AstNode*>(new AstAssignDly(fl, alhsp, arhsp))
+                                : static_cast<AstNode*>(new AstAssign(fl, alhsp, arhsp)));
+        }
+        clearTable();
+        ifrootp->addNextHere(stmtsp);
+        VL_DO_DANGLING(ifrootp->unlinkFrBack()->deleteTree(), ifrootp);
+        if (debug() >= 9) stmtsp->dumpTreeAndNext(cout, "    _table: ");
+    }
+
     AstNode* replaceCaseFastRecurse(AstNode* cexprp, int msb, uint32_t upperValue) {
         if (msb < 0) {
             // There's no space for a IF.  We know upperValue is thus down to a specific
@@ -275,10 +431,11 @@ private:
         }
     }
 
-    void replaceCaseFast(AstCase* nodep) {
+    AstNode* replaceCaseFast(AstCase* nodep) {
         // CASEx(cexpr,....
         // ->  tree of IF(msb,  IF(msb-1, 11, 10)
         //                      IF(msb-1, 01, 00))
+        // Returns the new tree, NULL if none
         AstNode* cexprp = nodep->exprp()->unlinkFrBack();
 
         if (debug() >= 9) {
@@ -304,7 +461,8 @@ private:
         }
         VL_DO_DANGLING(nodep->deleteTree(), nodep);
         VL_DO_DANGLING(cexprp->deleteTree(), cexprp);
-        if (debug() >= 9) ifrootp->dumpTree(cout, "    _simp: ");
+        if (debug() >= 9 && ifrootp) ifrootp->dumpTree(cout, "    _simp: ");
+        return ifrootp;
     }
 
     void replaceCaseComplicated(AstCase* nodep) {
@@ -476,18 +634,36 @@ private:
             // It's a simple priority encoder or complete statement
             // we can make a tree of statements to avoid extra comparisons
             ++m_statCaseFast;
-            VL_DO_DANGLING(replaceCaseFast(nodep), nodep);
+            bool tableable = caseTableTest(nodep);
+            AstNode* ifrootp = replaceCaseFast(nodep);
+            VL_DANGLING(nodep);
+            if (tableable) {
+                if (VN_IS(ifrootp, If)) {
+                    replaceCaseTable(ifrootp);
+                } else {
+                    clearTable();
+                }
+            }
         } else {
             ++m_statCaseSlow;
             VL_DO_DANGLING(replaceCaseComplicated(nodep), nodep);
         }
     }
+    virtual void visit(AstScope* nodep) VL_OVERRIDE {
+        m_scopep = nodep;
+        iterateChildren(nodep);
+        m_scopep = NULL;
+    }
     //--------------------
     virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
 
 public:
     // CONSTRUCTORS
     explicit CaseVisitor(AstNetlist* nodep) {
+        m_scopep = NULL;
+        m_tableNum = 0;
+        m_tableExprp = NULL;
+        m_tableDly = false;
         m_caseWidth = 0;
         m_caseItems = 0;
         m_caseNoOverlapsAllCovered = false;
@@ -497,6 +673,7 @@ public:
     virtual ~CaseVisitor() {
         V3Stats::addStat("Optimizations, Cases parallelized", m_statCaseFast);
         V3Stats::addStat("Optimizations, Cases complex", m_statCaseSlow);
+        V3Stats::addStat("Optimizations, Cases tabled", m_statCaseTable);
     }
 };
 
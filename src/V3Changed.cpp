@@ -24,6 +24,12 @@
 //          module *below*, and it isn't a input to this module,
 //          we need to indicate a new clock has been created.
 //
+// With --activity-gate:
+//      Each combo function called from _eval
+//          If it reads only signals the model writes, and is pure
+//              Add __Vcombact{n}, set before each statement writing what it reads
+//              Call it under IF(__Vcombact{n}), clearing the flag
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -33,10 +39,13 @@
 #include "V3Ast.h"
 #include "V3Changed.h"
 #include "V3EmitCBase.h"
+#include "V3Stats.h"
 
 #include <algorithm>
 #include <cstdarg>
+#include <map>
 #include <set>
+#include <vector>
 
 //######################################################################
 
@@ -49,6 +58,7 @@ public:
     AstCFunc* m_tlChgFuncp;  // Top level change function we're building
     int m_numStmts;  // Number of statements added to m_chgFuncp
     int m_funcNum;  // Number of change functions emitted
+    int m_statVars;  // Number of variables needing change detection
 
     ChangedState() {
         m_topModp = NULL;
@@ -57,6 +67,7 @@ public:
         m_tlChgFuncp = NULL;
         m_numStmts = 0;
         m_funcNum = 0;
+        m_statVars = 0;
     }
     ~ChangedState() {}
 
@@ -240,6 +251,7 @@ private:
 
     void genChangeDet(AstVarScope* vscp) {
         vscp->v3warn(IMPERFECTSCH, "Imperfect scheduling of variable: " << vscp->prettyNameQ());
+        ++m_statep->m_statVars;
         ChangedInsertVisitor visitor(vscp, m_statep);
     }
 
@@ -272,6 +284,18 @@ private:
         m_statep->m_chgFuncp->addStmtsp(new AstChangeDet(nodep->fileline(), NULL, NULL, false));
 
         iterateChildren(nodep);
+
+        if (!m_statep->m_statVars) {
+            // Nothing is circular, so one evaluation always settles, and
+            // the model evaluates without calling the change functions
+            UINFO(4, "  No change detection, eval is a single pass" << endl);
+            if (m_statep->m_chgFuncp != m_statep->m_tlChgFuncp) {
+                VL_DO_DANGLING(m_statep->m_chgFuncp->unlinkFrBack()->deleteTree(),
+                               m_statep->m_chgFuncp);
+            }
+            VL_DO_DANGLING(m_statep->m_tlChgFuncp->unlinkFrBack()->deleteTree(),
+                           m_statep->m_tlChgFuncp);
+        }
     }
     virtual void visit(AstVarScope* nodep) VL_OVERRIDE {
         if (nodep->isCircular()) {
@@ -292,6 +316,204 @@ public:
     virtual ~ChangedVisitor() {}
 };
 
+//######################################################################
+// Activity gating, find what a combo function reads
+
+class ChangedReadVisitor : public AstNVisitor {
+private:
+    // STATE
+    std::set<AstVarScope*> m_reads;  // Variables read
+    std::set<AstCFunc*> m_funcs;  // Functions visited
+    bool m_gateable;  // Only reads variables the model writes, and is pure
+
+    // METHODS
+    static bool simpleDType(AstNodeDType* dtypep) {
+        dtypep = dtypep->skipRefp();
+        if (AstUnpackArrayDType* adtypep = VN_CAST(dtypep, UnpackArrayDType)) {
+            return simpleDType(adtypep->subDTypep());
+        } else if (AstBasicDType* bdtypep = VN_CAST(dtypep, BasicDType)) {
+            return !bdtypep->isOpaque();
+        } else {
+            return VN_IS(dtypep, PackArrayDType) || VN_IS(dtypep, NodeUOrStructDType);
+        }
+    }
+
+    // VISITORS
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        if (nodep->lvalue()) return;
+        AstVarScope* vscp = nodep->varScopep();
+        AstVar* varp = vscp->varp();
+        if (varp->isPrimaryInish() || varp->isSigPublic() || varp->isSigUserRWPublic()
+            || !simpleDType(varp->dtypep())) {
+            // May change without the model writing it
+            UINFO(8, "    Not gateable, reads " << varp << endl);
+            m_gateable = false;
+        }
+        m_reads.insert(vscp);
+    }
+    virtual void visit(AstNodeCCall* nodep) VL_OVERRIDE {
+        iterateChildren(nodep);
+        AstCFunc* funcp = nodep->funcp();
+        if (funcp->dpiImport()) {
+            if (!funcp->pure()) m_gateable = false;
+        } else if (m_funcs.insert(funcp).second) {
+            iterate(funcp);
+        }
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE {
+        if (!nodep->isPure()) m_gateable = false;
+        iterateChildren(nodep);
+    }
+
+public:
+    // CONSTRUCTORS
+    explicit ChangedReadVisitor(AstCFunc* funcp) {
+        m_gateable = true;
+        m_funcs.insert(funcp);
+        iterate(funcp);
+    }
+    virtual ~ChangedReadVisitor() {}
+    // METHODS
+    const std::set<AstVarScope*>& reads() const { return m_reads; }
+    bool gateable() const { return m_gateable; }
+};
+
+//######################################################################
+// Activity gating of combo functions
+
+class ChangedActivityVisitor : public AstNVisitor {
+private:
+    // TYPES
+    typedef std::vector<AstVarScope*> FlagList;
+    typedef std::map<AstVarScope*, FlagList> ReaderMap;
+    typedef std::map<AstCFunc*, std::set<AstVarScope*> > OwnFlagMap;
+
+    // STATE
+    ReaderMap m_readers;  // Per variable, flags of the combo functions reading it
+    OwnFlagMap m_ownFlags;  // Per gated function, its own flags
+    AstCFunc* m_funcp;  // Current function
+    AstNodeStmt* m_stmtp;  // Innermost statement being visited
+    std::vector<std::pair<AstNodeStmt*, AstVarScope*> > m_sets;  // Flags to set, and where
+    std::set<std::pair<AstNodeStmt*, AstVarScope*> > m_setSet;  // Members of m_sets
+    bool m_hasUser;  // Has user $c code, which may write anything
+    VDouble0 m_statGated;  // Statistic tracking
+    VDouble0 m_statUngated;  // Statistic tracking
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    AstVarScope* newFlag(AstCFunc* evalp, AstNode* nodep) {
+        AstNodeModule* topModp = v3Global.rootp()->topModulep();
+        string newvarname = "__Vcombact" + cvtToStr(m_statGated);
+        AstVar* newvarp = new AstVar(nodep->fileline(), AstVarType::MODULETEMP, newvarname,
+                                     VFlagBitPacked(), 1);
+        newvarp->noReset(true);  // Reset by _eval_initial
+        topModp->addStmtp(newvarp);
+        AstVarScope* newvscp = new AstVarScope(nodep->fileline(), evalp->scopep(), newvarp);
+        evalp->scopep()->addVarp(newvscp);
+        return newvscp;
+    }
+    AstCFunc* findInitial(AstCFunc* evalp) {
+        for (AstNode* nodep = evalp->scopep()->blocksp(); nodep; nodep = nodep->nextp()) {
+            AstCFunc* funcp = VN_CAST(nodep, CFunc);
+            if (funcp && funcp->name() == "_eval_initial") return funcp;
+        }
+        return NULL;
+    }
+
+    // VISITORS
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        m_funcp = nodep;
+        iterateChildren(nodep);
+        m_funcp = NULL;
+    }
+    virtual void visit(AstUCStmt* nodep) VL_OVERRIDE { m_hasUser = true; }
+    virtual void visit(AstUCFunc* nodep) VL_OVERRIDE { m_hasUser = true; }
+    virtual void visit(AstNodeStmt* nodep) VL_OVERRIDE {
+        AstNodeStmt* origStmtp = m_stmtp;
+        {
+            m_stmtp = nodep;
+            iterateChildren(nodep);
+        }
+        m_stmtp = origStmtp;
+    }
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        // Before the statement writing a gated function's input, set its flag
+        if (!nodep->lvalue() || !m_stmtp) return;
+        AstVarScope* vscp = nodep->varScopep();
+        ReaderMap::iterator it = m_readers.find(vscp);
+        if (it == m_readers.end()) return;
+        const std::set<AstVarScope*>& ownFlags = m_ownFlags[m_funcp];
+        for (FlagList::iterator fit = it->second.begin(); fit != it->second.end(); ++fit) {
+            // A function's own writes are ordered before its reads, unless circular
+            if (ownFlags.find(*fit) != ownFlags.end() && !vscp->isCircular()) continue;
+            std::pair<AstNodeStmt*, AstVarScope*> set = make_pair(m_stmtp, *fit);
+            if (m_setSet.insert(set).second) m_sets.push_back(set);
+        }
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit ChangedActivityVisitor(AstNetlist* nodep) {
+        m_funcp = NULL;
+        m_stmtp = NULL;
+        m_hasUser = false;
+        AstCFunc* evalp = nodep->evalp();
+        if (!evalp) return;
+        AstCFunc* initp = findInitial(evalp);
+        iterate(nodep);
+        if (m_hasUser || !initp) {
+            UINFO(4, "  No activity gating, user code may write any signal" << endl);
+            return;
+        }
+        // Find the gateable combo functions
+        std::vector<std::pair<AstCCall*, AstVarScope*> > gates;
+        for (AstNode* stmtp = evalp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            AstCCall* callp = VN_CAST(stmtp, CCall);
+            if (!callp) continue;
+            ChangedReadVisitor readVisitor(callp->funcp());
+            if (!readVisitor.gateable()) {
+                ++m_statUngated;
+                continue;
+            }
+            AstVarScope* flagp = newFlag(evalp, callp);
+            ++m_statGated;
+            gates.push_back(make_pair(callp, flagp));
+            m_ownFlags[callp->funcp()].insert(flagp);
+            for (std::set<AstVarScope*>::const_iterator it = readVisitor.reads().begin();
+                 it != readVisitor.reads().end(); ++it) {
+                m_readers[*it].push_back(flagp);
+            }
+        }
+        // Flag at each writer
+        iterate(nodep);
+        for (std::vector<std::pair<AstNodeStmt*, AstVarScope*> >::iterator it = m_sets.begin();
+             it != m_sets.end(); ++it) {
+            FileLine* fl = it->first->fileline();
+            it->first->addHereThisAsNext(
+                new AstAssign(fl, new AstVarRef(fl, it->second, true), new AstConst(fl, 1)));
+        }
+        // Gate each call, and start with every function evaluated once
+        for (std::vector<std::pair<AstCCall*, AstVarScope*> >::iterator it = gates.begin();
+             it != gates.end(); ++it) {
+            AstCCall* callp = it->first;
+            AstVarScope* flagp = it->second;
+            FileLine* fl = callp->fileline();
+            AstIf* ifp = new AstIf(fl, new AstVarRef(fl, flagp, false), NULL, NULL);
+            callp->replaceWith(ifp);
+            ifp->addIfsp(new AstAssign(fl, new AstVarRef(fl, flagp, true), new AstConst(fl, 0)));
+            ifp->addIfsp(callp);
+            initp->addStmtsp(
+                new AstAssign(fl, new AstVarRef(fl, flagp, true), new AstConst(fl, 1)));
+        }
+    }
+    virtual ~ChangedActivityVisitor() {
+        V3Stats::addStat("Optimizations, Activity gated combo functions", m_statGated);
+        V3Stats::addStat("Optimizations, Activity ungated combo functions", m_statUngated);
+    }
+};
+
 //######################################################################
 // Changed class functions
 
@@ -300,6 +522,11 @@ void V3Changed::changedAll(AstNetlist* nodep) {
     {
         ChangedState state;
         ChangedVisitor visitor(nodep, &state);
+        v3Global.needChangeLoop(state.m_statVars != 0);
+        V3Stats::addStat("Scheduling, change detect variables", state.m_statVars);
     }  // Destruct before checking
+    if (v3Global.opt.activityGate() && !v3Global.opt.mtasks()) {
+        ChangedActivityVisitor visitor(nodep);
+    }
     V3Global::dumpCheckGlobalTree("changed", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
@@ -23,7 +23,9 @@
 //                      Add a __Vlast_{clock} for the comparison
 //                      Set the __Vlast_{clock} at the end of the block
 //              Replace UNTILSTABLEs with loops until specified signals become const.
+//              With --eval-clock, gate the IF by a hint of which top clocks changed
 //   Create global calling function for any per-scope functions.  (For FINALs).
+//   With --eval-clock, create evalClock_{clock} functions setting the hint.
 //
 //*************************************************************************
 
@@ -34,9 +36,14 @@
 #include "V3Clock.h"
 #include "V3Ast.h"
 #include "V3EmitCBase.h"
+#include "V3EmitV.h"
+#include "V3Stats.h"
 
 #include <algorithm>
 #include <cstdarg>
+#include <map>
+#include <sstream>
+#include <vector>
 
 //######################################################################
 // Clock state, as a visitor of each AstNode
@@ -50,6 +57,9 @@ private:
 
     // TYPES
     enum { DOUBLE_OR_RATE = 10 };  // How many | per ||, Determined experimentally as best
+    enum { HINT_CLOCKS_MAX = 64 };  // Top clocks with a bit in the --eval-clock hint
+    typedef std::map<AstVarScope*, int> HintBitMap;
+    typedef std::map<string, size_t> DomainIdMap;
 
     // STATE
     AstNodeModule* m_modp;  // Current module
@@ -62,6 +72,11 @@ private:
     AstSenTree* m_lastSenp;  // Last sensitivity match, so we can detect duplicates.
     AstIf* m_lastIfp;  // Last sensitivity if active to add more under
     AstMTaskBody* m_mtaskBodyp;  // Current mtask body
+    AstVarScope* m_hintVscp;  // --eval-clock hint of which top clocks may have changed
+    HintBitMap m_hintBits;  // Hint bit of each top clock
+    std::vector<AstVarScope*> m_hintClocks;  // Top clocks in hint bit order
+    DomainIdMap m_profDomainIds;  // --prof-eval counter of each sensitivity
+    VDouble0 m_statToggleGroups;  // Statistic tracking
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -168,12 +183,106 @@ private:
         }
         return senEqnp;
     }
+    AstConst* newHintConst(AstNode* nodep, vluint64_t value) {
+        V3Number num(nodep, 64, 0);
+        num.setQuad(value);
+        return new AstConst(nodep->fileline(), num);
+    }
+    AstVarScope* makeHintVar() {
+        // Create:  __Vclock_hint, all ones except within evalClock_{clock}
+        AstVar* newvarp = new AstVar(m_topScopep->fileline(), AstVarType::MODULETEMP,
+                                     "__Vclock_hint", VFlagLogicPacked(), 64);
+        newvarp->noReset(true);  // Reset by below assign
+        m_modp->addStmtp(newvarp);
+        AstVarScope* newvscp = new AstVarScope(m_topScopep->fileline(), m_scopep, newvarp);
+        m_scopep->addVarp(newvscp);
+        addToInitial(new AstAssign(m_topScopep->fileline(),
+                                   new AstVarRef(m_topScopep->fileline(), newvscp, true),
+                                   newHintConst(m_topScopep, ~VL_ULL(0))));
+        return newvscp;
+    }
+    int hintBit(AstVarScope* vscp) {
+        // Return the hint bit of a top clock, or -1 if it has none
+        HintBitMap::iterator it = m_hintBits.find(vscp);
+        if (it != m_hintBits.end()) return it->second;
+        if (m_hintClocks.size() >= HINT_CLOCKS_MAX) return -1;
+        const int bit = m_hintClocks.size();
+        m_hintBits.insert(make_pair(vscp, bit));
+        m_hintClocks.push_back(vscp);
+        return bit;
+    }
+    AstNode* createHintEquation(AstSenTree* sensesp) {
+        // Return the test of the hint, or NULL if the sensitivity is always evaluated
+        vluint64_t mask = 0;
+        for (AstNodeSenItem* senp = sensesp->sensesp(); senp;
+             senp = VN_CAST(senp->nextp(), NodeSenItem)) {
+            AstSenItem* itemp = VN_CAST(senp, SenItem);
+            if (!itemp || !itemp->varrefp()) return NULL;
+            if (itemp->edgeType() != VEdgeType::ET_POSEDGE
+                && itemp->edgeType() != VEdgeType::ET_NEGEDGE
+                && itemp->edgeType() != VEdgeType::ET_BOTHEDGE) {
+                return NULL;
+            }
+            AstVarScope* clkvscp = itemp->varrefp()->varScopep();
+            if (!clkvscp->varp()->isPrimaryInish() || clkvscp->scopep() != m_topScopep->scopep()) {
+                return NULL;  // Generated clock, may change with any clock
+            }
+            const int bit = hintBit(clkvscp);
+            if (bit < 0) return NULL;
+            mask |= (VL_ULL(1) << bit);
+        }
+        FileLine* fl = sensesp->fileline();
+        return new AstNeq(fl, newHintConst(sensesp, 0),
+                          new AstAnd(fl, new AstVarRef(fl, m_hintVscp, false),
+                                     newHintConst(sensesp, mask)));
+    }
     AstIf* makeActiveIf(AstSenTree* sensesp) {
         AstNode* senEqnp = createSenseEquation(sensesp->sensesp());
         UASSERT_OBJ(senEqnp, sensesp, "No sense equation, shouldn't be in sequent activation.");
+        if (m_hintVscp) {
+            if (AstNode* hintEqnp = createHintEquation(sensesp)) {
+                senEqnp = new AstLogAnd(sensesp->fileline(), hintEqnp, senEqnp);
+            }
+        }
         AstIf* newifp = new AstIf(sensesp->fileline(), senEqnp, NULL, NULL);
         return newifp;
     }
+    void profEvalCount(AstSenTree* sensesp, AstIf* ifp) {
+        // Count into vlSymsp->__Vm_evalDomains[id]; a domain split across
+        // several ifs counts each part
+        std::ostringstream os;
+        V3EmitV::verilogForTree(sensesp, os);
+        const string desc = os.str();
+        DomainIdMap::iterator it = m_profDomainIds.find(desc);
+        if (it == m_profDomainIds.end()) {
+            it = m_profDomainIds.insert(make_pair(desc, v3Global.profEvalDomainsAdd(desc))).first;
+        }
+        ifp->addIfsp(new AstCStmt(sensesp->fileline(), "++vlSymsp->__Vm_evalDomains["
+                                                           + cvtToStr(it->second) + "];\n"));
+    }
+    void makeEvalClockFuncs() {
+        // Create:  evalClock_{clock}() { __Vclock_hint = {bit}; eval(); __Vclock_hint = ~0; }
+        for (std::vector<AstVarScope*>::iterator it = m_hintClocks.begin();
+             it != m_hintClocks.end(); ++it) {
+            AstVarScope* clkvscp = *it;
+            FileLine* fl = clkvscp->fileline();
+            AstCFunc* funcp = new AstCFunc(fl, "evalClock_" + clkvscp->varp()->name(), m_scopep);
+            funcp->dontCombine(true);
+            funcp->isStatic(false);
+            funcp->entryPoint(true);
+            funcp->protect(false);
+            funcp->addInitsp(new AstCStmt(fl, EmitCBaseVisitor::symClassVar()
+                                                  + " = this->__VlSymsp;\n"));
+            funcp->addInitsp(new AstCStmt(fl, EmitCBaseVisitor::symTopAssign() + "\n"));
+            const vluint64_t bit = VL_ULL(1) << m_hintBits[clkvscp];
+            funcp->addStmtsp(new AstAssign(fl, new AstVarRef(fl, m_hintVscp, true),
+                                           newHintConst(clkvscp, bit)));
+            funcp->addStmtsp(new AstCStmt(fl, "eval();\n"));
+            funcp->addStmtsp(new AstAssign(fl, new AstVarRef(fl, m_hintVscp, true),
+                                           newHintConst(clkvscp, ~VL_ULL(0))));
+            m_scopep->addActivep(funcp);
+        }
+    }
     void clearLastSen() {
         m_lastSenp = NULL;
         m_lastIfp = NULL;
@@ -222,6 +331,8 @@ private:
                                                                  + " = this->__VlSymsp;\n"));
             funcp->addInitsp(
                 new AstCStmt(nodep->fileline(), EmitCBaseVisitor::symTopAssign() + "\n"));
+            funcp->addInitsp(new AstCStmt(nodep->fileline(),
+                                          "Verilated::threadContextp(vlTOPp->__Vm_contextp);\n"));
             m_scopep->addActivep(funcp);
             m_finalFuncp = funcp;
         }
@@ -236,8 +347,11 @@ private:
             m_scopep->addActivep(funcp);
             m_settleFuncp = funcp;
         }
+        if (v3Global.opt.evalClock()) m_hintVscp = makeHintVar();
         // Process the activates
         iterateChildren(nodep);
+        m_scopep = nodep->scopep();
+        if (m_hintVscp) makeEvalClockFuncs();
         // Done, clear so we can detect errors
         UINFO(4, " TOPSCOPEDONE " << nodep << endl);
         clearLastSen();
@@ -282,8 +396,19 @@ private:
         }
         VL_DO_DANGLING(nodep->deleteTree(), nodep);
     }
-    virtual void visit(AstCoverToggle* nodep) VL_OVERRIDE {
-        // nodep->dumpTree(cout, "ct:");
+    static bool toggleBitRefs(AstCoverToggle* nodep, AstVarRef*& origRefpr,
+                              AstVarRef*& chgRefpr) {
+        // True if the toggle is of a constant bit select of a packed signal
+        AstSel* origSelp = VN_CAST(nodep->origp(), Sel);
+        AstSel* chgSelp = VN_CAST(nodep->changep(), Sel);
+        if (!origSelp || !chgSelp || origSelp->widthConst() != 1) return false;
+        origRefpr = VN_CAST(origSelp->fromp(), VarRef);
+        chgRefpr = VN_CAST(chgSelp->fromp(), VarRef);
+        return origRefpr && chgRefpr && VN_IS(origSelp->lsbp(), Const)
+               && !VN_IS(origRefpr->dtypep()->skipRefp(), UnpackArrayDType)
+               && origRefpr->width() == chgRefpr->width();
+    }
+    static AstIf* toggleIf(AstCoverToggle* nodep) {
         // COVERTOGGLE(INC, ORIG, CHANGE) ->
         //   IF(ORIG ^ CHANGE) { INC; CHANGE = ORIG; }
         AstNode* incp = nodep->incp()->unlinkFrBack();
@@ -296,8 +421,48 @@ private:
         // We'll go with the miss.
         newp->addIfsp(
             new AstAssign(nodep->fileline(), changep->cloneTree(false), origp->cloneTree(false)));
-        nodep->replaceWith(newp);
-        VL_DO_DANGLING(nodep->deleteTree(), nodep);
+        return newp;
+    }
+    virtual void visit(AstCoverToggle* nodep) VL_OVERRIDE {
+        // nodep->dumpTree(cout, "ct:");
+        // V3Coverage made a toggle per bit, which V3Order usually leaves
+        // together.  Put each run of bits of the same signal under one word
+        // compare, so an unchanged signal costs one test rather than one per bit:
+        //   IF(ORIG != CHANGE) { IF(ORIG[0] ^ CHANGE[0]) {...} IF(ORIG[1] ^ ...) }
+        std::vector<AstCoverToggle*> runps;
+        runps.push_back(nodep);
+        AstVarRef* origRefp;
+        AstVarRef* chgRefp;
+        if (toggleBitRefs(nodep, origRefp /*ref*/, chgRefp /*ref*/)) {
+            while (AstCoverToggle* nextp = VN_CAST(runps.back()->nextp(), CoverToggle)) {
+                AstVarRef* nextOrigRefp;
+                AstVarRef* nextChgRefp;
+                if (!toggleBitRefs(nextp, nextOrigRefp /*ref*/, nextChgRefp /*ref*/)
+                    || !nextOrigRefp->sameGateTree(origRefp)
+                    || !nextChgRefp->sameGateTree(chgRefp)) {
+                    break;
+                }
+                runps.push_back(nextp);
+            }
+        }
+        if (runps.size() == 1) {
+            AstIf* newp = toggleIf(nodep);
+            nodep->replaceWith(newp);
+            VL_DO_DANGLING(nodep->deleteTree(), nodep);
+            return;
+        }
+        FileLine* fl = nodep->fileline();
+        AstIf* groupp = new AstIf(
+            fl, new AstNeq(fl, origRefp->cloneTree(false), chgRefp->cloneTree(false)), NULL,
+            NULL);
+        nodep->replaceWith(groupp);
+        for (std::vector<AstCoverToggle*>::iterator it = runps.begin(); it != runps.end(); ++it) {
+            AstCoverToggle* togglep = *it;
+            if (togglep != nodep) togglep->unlinkFrBack();
+            groupp->addIfsp(toggleIf(togglep));
+            VL_DO_DANGLING(togglep->deleteTree(), togglep);
+        }
+        ++m_statToggleGroups;
     }
     virtual void visit(AstInitial* nodep) VL_OVERRIDE {
         AstNode* cmtp = new AstComment(nodep->fileline(), nodep->typeName(), true);
@@ -379,6 +544,7 @@ private:
                     m_lastSenp = nodep->sensesp();
                     // Make a new if statement
                     m_lastIfp = makeActiveIf(m_lastSenp);
+                    if (v3Global.opt.profEval()) profEvalCount(m_lastSenp, m_lastIfp);
                     addToEvalLoop(m_lastIfp);
                 }
                 // Move statements to if
@@ -430,13 +596,16 @@ public:
         m_lastIfp = NULL;
         m_scopep = NULL;
         m_mtaskBodyp = NULL;
+        m_hintVscp = NULL;
         //
         iterate(nodep);
         // Allow downstream modules to find _eval()
         // easily without iterating through the tree.
         nodep->evalp(m_evalFuncp);
     }
-    virtual ~ClockVisitor() {}
+    virtual ~ClockVisitor() {
+        V3Stats::addStat("Coverage, Toggle words grouped", m_statToggleGroups);
+    }
 };
 
 //######################################################################
@@ -28,6 +28,12 @@
 //              Move common block to function
 //              Replace each common block ref with funccall
 //
+//      With -Oh, foreach set of functions identical except for which
+//      variables they reference (e.g. the same logic in different instances)
+//          Add an argument to the first function for each differing variable
+//          Reference the arguments instead of the variables
+//          Replace calls to the others with calls passing their variables
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -42,11 +48,14 @@
 #include <algorithm>
 #include <cstdarg>
 #include <map>
+#include <set>
 #include <vector>
 
 //######################################################################
 
 #define COMBINE_MIN_STATEMENTS 50  // Min # of statements to be worth making a function
+#define COMBINE_PARAM_MIN_NODES 50  // Min # of nodes to be worth merging by parameters
+#define COMBINE_PARAM_MAX 8  // Max # of parameters to add to a merged function
 
 //######################################################################
 
@@ -115,6 +124,15 @@ public:
     }
     // METHODS
     void addCall(AstCCall* nodep) { m_callMmap.insert(make_pair(nodep->funcp(), nodep)); }
+    std::vector<AstCCall*> calls(AstCFunc* funcp) const {
+        std::vector<AstCCall*> callps;
+        std::pair<CallMmap::const_iterator, CallMmap::const_iterator> eqrange
+            = m_callMmap.equal_range(funcp);
+        for (CallMmap::const_iterator it = eqrange.first; it != eqrange.second; ++it) {
+            callps.push_back(it->second);
+        }
+        return callps;
+    }
     void deleteCall(AstCCall* nodep) {
         std::pair<CallMmap::iterator, CallMmap::iterator> eqrange
             = m_callMmap.equal_range(nodep->funcp());
@@ -182,7 +200,12 @@ private:
 
     // STATE
     typedef enum { STATE_IDLE, STATE_HASH, STATE_DUP } CombineState;
+    // Variable referenced by a function, as {variable, hiername}
+    typedef std::pair<AstVar*, string> RefKey;
+    typedef std::map<RefKey, RefKey> RefMap;  // Reference in one function -> in other
+    typedef std::map<AstVar*, AstVar*> LocalMap;  // Local in one function -> in other
     VDouble0 m_statCombs;  // Statistic tracking
+    VDouble0 m_statParamCombs;  // Statistic tracking
     CombineState m_state;  // Major state
     AstNodeModule* m_modp;  // Current module
     AstCFunc* m_funcp;  // Current function
@@ -268,6 +291,255 @@ private:
         }
     }
 
+    // Merging functions that differ only in variable references
+    static RefKey refKey(const AstNodeVarRef* refp) {
+        return make_pair(refp->varp(), refp->hiername());
+    }
+    static bool paramRefOk(const AstNodeVarRef* refp) {
+        // Only absolute references can be passed by any caller, without 'this'
+        const string& hier = refp->hiername();
+        return VN_IS(refp, VarRef) && !refp->varp()->isFuncLocal()
+               && VN_IS(refp->varp()->dtypep()->skipRefp(), BasicDType)
+               && (hier == "vlTOPp->" || hier.compare(0, 9, "vlSymsp->") == 0);
+    }
+    static V3Hash shapeHash(const AstNode* nodep, int& nodesr) {
+        // Like V3Hashed, but ignoring which variables are referenced
+        V3Hash hash;
+        for (; nodep; nodep = nodep->nextp()) {
+            ++nodesr;
+            V3Hash nodeHash = (VN_IS(nodep, NodeVarRef) || VN_IS(nodep, Var))
+                                  ? V3Hash()
+                                  : nodep->sameHash();
+            nodeHash = V3Hash(nodeHash, V3Hash(nodep->type() << 6, V3Hash(nodep->dtypep())));
+            nodeHash += shapeHash(nodep->op1p(), nodesr);
+            nodeHash += shapeHash(nodep->op2p(), nodesr);
+            nodeHash += shapeHash(nodep->op3p(), nodesr);
+            nodeHash += shapeHash(nodep->op4p(), nodesr);
+            hash += nodeHash;
+        }
+        return hash;
+    }
+    static bool sameLocal(AstVar* var1p, AstVar* var2p, LocalMap& localsr) {
+        if (var1p->dtypep() != var2p->dtypep() || var1p->varType() != var2p->varType()) {
+            return false;
+        }
+        LocalMap::iterator it = localsr.find(var1p);
+        if (it != localsr.end()) return it->second == var2p;
+        // Two locals must not become one
+        for (it = localsr.begin(); it != localsr.end(); ++it) {
+            if (it->second == var2p) return false;
+        }
+        localsr.insert(make_pair(var1p, var2p));
+        return true;
+    }
+    static bool sameRef(const AstNodeVarRef* ref1p, const AstNodeVarRef* ref2p, RefMap& refsr,
+                        LocalMap& localsr) {
+        if (ref1p->lvalue() != ref2p->lvalue()) return false;
+        if (ref1p->varp()->isFuncLocal() || ref2p->varp()->isFuncLocal()) {
+            if (!ref1p->varp()->isFuncLocal() || !ref2p->varp()->isFuncLocal()) return false;
+            return sameLocal(ref1p->varp(), ref2p->varp(), localsr);
+        }
+        const RefKey key1 = refKey(ref1p);
+        const RefKey key2 = refKey(ref2p);
+        RefMap::iterator it = refsr.find(key1);
+        if (it != refsr.end()) return it->second == key2;
+        if (key1 != key2) {  // Will become a parameter
+            if (!paramRefOk(ref1p) || !paramRefOk(ref2p)
+                || ref1p->varp()->dtypep() != ref2p->varp()->dtypep()) {
+                return false;
+            }
+        }
+        refsr.insert(make_pair(key1, key2));
+        return true;
+    }
+    static bool sameModRefs(const AstNode* node1p, const AstNode* node2p, RefMap& refsr,
+                            LocalMap& localsr) {
+        // Like sameTree, but references may differ, recording how in refsr
+        for (; node1p && node2p; node1p = node1p->nextp(), node2p = node2p->nextp()) {
+            if (!(node1p->type() == node2p->type()) || node1p->dtypep() != node2p->dtypep()) {
+                return false;
+            }
+            if (const AstNodeVarRef* ref1p = VN_CAST_CONST(node1p, NodeVarRef)) {
+                if (!sameRef(ref1p, VN_CAST_CONST(node2p, NodeVarRef), refsr, localsr)) {
+                    return false;
+                }
+            } else if (const AstVar* var1p = VN_CAST_CONST(node1p, Var)) {
+                if (!sameLocal(const_cast<AstVar*>(var1p),
+                               const_cast<AstVar*>(VN_CAST_CONST(node2p, Var)), localsr)) {
+                    return false;
+                }
+            } else if (!node1p->same(node2p)) {
+                return false;
+            } else if (const AstNodeCCall* call1p = VN_CAST_CONST(node1p, NodeCCall)) {
+                if (call1p->hiername() != VN_CAST_CONST(node2p, NodeCCall)->hiername()) {
+                    return false;
+                }
+            }
+            if (!sameModRefs(node1p->op1p(), node2p->op1p(), refsr, localsr)
+                || !sameModRefs(node1p->op2p(), node2p->op2p(), refsr, localsr)
+                || !sameModRefs(node1p->op3p(), node2p->op3p(), refsr, localsr)
+                || !sameModRefs(node1p->op4p(), node2p->op4p(), refsr, localsr)) {
+                return false;
+            }
+        }
+        return !node1p && !node2p;
+    }
+    bool paramFuncOk(AstCFunc* funcp) const {
+        // Function and all its calls can take added arguments
+        if (funcp->dontCombine() || funcp->entryPoint() || funcp->funcPublic()
+            || funcp->isVirtual() || funcp->isConstructor() || funcp->isDestructor()
+            || funcp->dpiImport() || funcp->dpiExport() || funcp->dpiImportWrapper()
+            || funcp->dpiExportWrapper() || funcp->skipDecl()
+            || funcp->funcType() != AstCFuncType::FT_NORMAL || funcp->argsp()) {
+            return false;
+        }
+        const std::vector<AstCCall*> callps = m_call.calls(funcp);
+        if (callps.empty()) return false;
+        for (std::vector<AstCCall*>::const_iterator it = callps.begin(); it != callps.end();
+             ++it) {
+            if ((*it)->argsp()) return false;
+            // Caller must have vlSymsp to pass absolute references
+            AstNode* abovep = *it;
+            while (abovep && !VN_IS(abovep, CFunc)) abovep = abovep->backp();
+            AstCFunc* callerp = VN_CAST(abovep, CFunc);
+            if (!callerp || callerp->argTypes().find("vlSymsp") == string::npos) return false;
+        }
+        return true;
+    }
+    bool sameModParams(AstCFunc* func1p, AstCFunc* func2p, RefMap& refsr) const {
+        if (!func1p->same(func2p) || !(func1p->isStatic() == func2p->isStatic())
+            || func1p->slow() != func2p->slow()) {
+            return false;
+        }
+        LocalMap locals;
+        return sameModRefs(func1p->initsp(), func2p->initsp(), refsr, locals)
+               && sameModRefs(func1p->stmtsp(), func2p->stmtsp(), refsr, locals)
+               && sameModRefs(func1p->finalsp(), func2p->finalsp(), refsr, locals);
+    }
+    static void collectRefs(AstNode* nodep, std::vector<AstVarRef*>& refsr) {
+        for (; nodep; nodep = nodep->nextp()) {
+            if (AstVarRef* refp = VN_CAST(nodep, VarRef)) refsr.push_back(refp);
+            collectRefs(nodep->op1p(), refsr);
+            collectRefs(nodep->op2p(), refsr);
+            collectRefs(nodep->op3p(), refsr);
+            collectRefs(nodep->op4p(), refsr);
+        }
+    }
+    void addParamArgs(AstCFunc* funcp, const std::vector<RefKey>& keys,
+                      const std::vector<bool>& lvalues) {
+        const std::vector<AstCCall*> callps = m_call.calls(funcp);
+        for (std::vector<AstCCall*>::const_iterator it = callps.begin(); it != callps.end();
+             ++it) {
+            AstCCall* callp = *it;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                AstVarRef* argp = new AstVarRef(callp->fileline(), keys[i].first, lvalues[i]);
+                // The caller might not have vlTOPp, but has vlSymsp
+                argp->hiername(keys[i].second == "vlTOPp->" ? "vlSymsp->TOPp->"
+                                                            : keys[i].second);
+                callp->addArgsp(argp);
+            }
+        }
+    }
+    void replaceFuncsWParams(AstCFunc* newfuncp, const std::vector<AstCFunc*>& oldfuncps,
+                             const std::vector<RefMap>& refMaps) {
+        // Which references become parameters, ordered by first use
+        std::set<RefKey> paramSet;
+        for (std::vector<RefMap>::const_iterator it = refMaps.begin(); it != refMaps.end();
+             ++it) {
+            for (RefMap::const_iterator rit = it->begin(); rit != it->end(); ++rit) {
+                if (rit->first != rit->second) paramSet.insert(rit->first);
+            }
+        }
+        std::vector<AstVarRef*> refps;
+        collectRefs(newfuncp->initsp(), refps);
+        collectRefs(newfuncp->stmtsp(), refps);
+        collectRefs(newfuncp->finalsp(), refps);
+        std::map<RefKey, size_t> paramNum;
+        std::vector<RefKey> params;
+        std::vector<bool> lvalues;
+        std::vector<AstVar*> argps;
+        for (std::vector<AstVarRef*>::iterator it = refps.begin(); it != refps.end(); ++it) {
+            AstVarRef* refp = *it;
+            const RefKey key = refKey(refp);
+            if (!paramSet.count(key)) continue;
+            std::map<RefKey, size_t>::iterator pit = paramNum.find(key);
+            if (pit == paramNum.end()) {
+                pit = paramNum.insert(make_pair(key, params.size())).first;
+                AstVar* argp = new AstVar(refp->fileline(), AstVarType::BLOCKTEMP,
+                                          "__Vcombp" + cvtToStr(params.size()),
+                                          refp->varp()->dtypep());
+                argp->funcLocal(true);
+                argp->direction(VDirection::INOUT);
+                newfuncp->addArgsp(argp);
+                params.push_back(key);
+                lvalues.push_back(false);
+                argps.push_back(argp);
+            }
+            if (refp->lvalue()) lvalues[pit->second] = true;
+            refp->varp(argps[pit->second]);
+            refp->hiername("");
+            refp->hierThis(true);
+        }
+        UINFO(5, "     ParamFunc " << newfuncp << " with " << params.size() << " args" << endl);
+        // Pass the variables to the existing calls, then move the others' calls over
+        addParamArgs(newfuncp, params, lvalues);
+        for (size_t f = 0; f < oldfuncps.size(); ++f) {
+            std::vector<RefKey> keys;
+            for (std::vector<RefKey>::const_iterator it = params.begin(); it != params.end();
+                 ++it) {
+                keys.push_back(refMaps[f].find(*it)->second);
+            }
+            addParamArgs(oldfuncps[f], keys, lvalues);
+            replaceFuncWFunc(oldfuncps[f], newfuncp);
+            ++m_statParamCombs;
+        }
+    }
+    void walkParamFuncs() {
+        // Bucket functions by their shape, in module order
+        std::map<V3Hash, size_t> bucketNum;
+        std::vector<std::vector<AstCFunc*> > buckets;
+        for (AstNode* nodep = m_modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+            AstCFunc* funcp = VN_CAST(nodep, CFunc);
+            if (!funcp || !paramFuncOk(funcp)) continue;
+            int nodes = 0;
+            V3Hash hash = shapeHash(funcp->initsp(), nodes);
+            hash += shapeHash(funcp->stmtsp(), nodes);
+            hash += shapeHash(funcp->finalsp(), nodes);
+            if (nodes < COMBINE_PARAM_MIN_NODES) continue;
+            std::map<V3Hash, size_t>::iterator it = bucketNum.find(hash);
+            if (it == bucketNum.end()) {
+                it = bucketNum.insert(make_pair(hash, buckets.size())).first;
+                buckets.push_back(std::vector<AstCFunc*>());
+            }
+            buckets[it->second].push_back(funcp);
+        }
+        for (size_t b = 0; b < buckets.size(); ++b) {
+            std::vector<AstCFunc*>& funcps = buckets[b];
+            for (size_t i = 0; i < funcps.size(); ++i) {
+                AstCFunc* newfuncp = funcps[i];
+                if (!newfuncp) continue;  // Already merged
+                std::vector<AstCFunc*> oldfuncps;
+                std::vector<RefMap> refMaps;
+                std::set<RefKey> params;
+                for (size_t j = i + 1; j < funcps.size(); ++j) {
+                    if (!funcps[j]) continue;
+                    RefMap refs;
+                    if (!sameModParams(newfuncp, funcps[j], refs)) continue;
+                    std::set<RefKey> newParams = params;
+                    for (RefMap::const_iterator it = refs.begin(); it != refs.end(); ++it) {
+                        if (it->first != it->second) newParams.insert(it->first);
+                    }
+                    if (newParams.size() > COMBINE_PARAM_MAX) continue;
+                    params.swap(newParams);
+                    oldfuncps.push_back(funcps[j]);
+                    refMaps.push_back(refs);
+                    funcps[j] = NULL;
+                }
+                if (!oldfuncps.empty()) replaceFuncsWParams(newfuncp, oldfuncps, refMaps);
+            }
+        }
+    }
+
     void walkDupCodeStart(AstNode* node1p) {
         V3Hash hashval(node1p->user4p());
         // UINFO(4,"    STMT " << hashval << " " << node1p << endl);
@@ -411,6 +683,8 @@ private:
         if (emptyFunctionDeletion()) walkEmptyFuncs();
         // Walk the hashes looking for duplicate functions
         if (duplicateFunctionCombine()) walkDupFuncs();
+        // Walk the functions looking for those differing only in references
+        if (v3Global.opt.oCombineParams() && !VN_IS(nodep, Class)) walkParamFuncs();
         // Walk the statements looking for large replicated code sections
         if (statementCombine()) {
             m_state = STATE_DUP;
@@ -462,6 +736,7 @@ public:
     }
     virtual ~CombineVisitor() {  //
         V3Stats::addStat("Optimizations, Combined CFuncs", m_statCombs);
+        V3Stats::addStat("Optimizations, Combined CFuncs with parameters", m_statParamCombs);
     }
 };
 
@@ -121,17 +121,23 @@ class V3ConfigFTask {
     bool m_isolate;  // Isolate function return
     bool m_noinline;  // Don't inline function/task
     bool m_public;  // Public function/task
+    bool m_threadsafe;  // DPI import may be called concurrently
+    bool m_async;  // DPI import calls are queued
 
 public:
     V3ConfigFTask()
         : m_isolate(false)
         , m_noinline(false)
-        , m_public(false) {}
+        , m_public(false)
+        , m_threadsafe(false)
+        , m_async(false) {}
     void update(const V3ConfigFTask& f) {
         // Don't overwrite true with false
         if (f.m_isolate) m_isolate = true;
         if (f.m_noinline) m_noinline = true;
         if (f.m_public) m_public = true;
+        if (f.m_threadsafe) m_threadsafe = true;
+        if (f.m_async) m_async = true;
         m_vars.update(f.m_vars);
     }
 
@@ -140,6 +146,8 @@ public:
     void setIsolate(bool set) { m_isolate = set; }
     void setNoInline(bool set) { m_noinline = set; }
     void setPublic(bool set) { m_public = set; }
+    void setThreadsafe(bool set) { m_threadsafe = set; }
+    void setAsync(bool set) { m_async = set; }
 
     void apply(AstNodeFTask* ftaskp) {
         if (m_noinline)
@@ -148,6 +156,20 @@ public:
             ftaskp->addStmtsp(new AstPragma(ftaskp->fileline(), AstPragmaType::PUBLIC_TASK));
         // Only functions can have isolate (return value)
         if (VN_IS(ftaskp, Func)) ftaskp->attrIsolateAssign(m_isolate);
+        if (m_threadsafe) {
+            if (!ftaskp->dpiImport()) {
+                ftaskp->v3error("threadsafe only applies to DPI import functions/tasks");
+            } else {
+                ftaskp->dpiThreadsafe(true);
+            }
+        }
+        if (m_async) {
+            if (!ftaskp->dpiImport()) {
+                ftaskp->v3error("async only applies to DPI import functions/tasks");
+            } else {
+                ftaskp->dpiAsync(true);
+            }
+        }
     }
 };
 
@@ -420,6 +442,22 @@ void V3Config::addInline(FileLine* fl, const string& module, const string& ftask
     }
 }
 
+void V3Config::addThreadsafe(FileLine* fl, const string& module, const string& ftask) {
+    if (ftask.empty()) {
+        fl->v3error("threadsafe requires -function or -task" << endl);
+    } else {
+        V3ConfigResolver::s().modules().at(module).ftasks().at(ftask).setThreadsafe(true);
+    }
+}
+
+void V3Config::addAsync(FileLine* fl, const string& module, const string& ftask) {
+    if (ftask.empty()) {
+        fl->v3error("async requires -function or -task" << endl);
+    } else {
+        V3ConfigResolver::s().modules().at(module).ftasks().at(ftask).setAsync(true);
+    }
+}
+
 void V3Config::addVarAttr(FileLine* fl, const string& module, const string& ftask,
                           const string& var, AstAttrType attr, AstSenTree* sensep) {
     // Semantics: sensep only if public_flat_rw
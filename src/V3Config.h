@@ -35,6 +35,8 @@ public:
     static void addIgnore(V3ErrorCode code, bool on, const string& filename, int min, int max);
     static void addWaiver(V3ErrorCode code, const string& filename, const string& message);
     static void addInline(FileLine* fl, const string& module, const string& ftask, bool on);
+    static void addAsync(FileLine* fl, const string& module, const string& ftask);
+    static void addThreadsafe(FileLine* fl, const string& module, const string& ftask);
     static void addVarAttr(FileLine* fl, const string& module, const string& ftask,
                            const string& signal, AstAttrType type, AstSenTree* nodep);
     static void applyCase(AstCase* nodep);
@@ -27,6 +27,7 @@
 #include "V3String.h"
 #include "V3Const.h"
 #include "V3Ast.h"
+#include "V3Stats.h"
 #include "V3Width.h"
 #include "V3Simulate.h"
 
@@ -37,6 +38,26 @@
 //######################################################################
 // Utilities
 
+// Return true if any node under nodep (but not its nextp's) was edited
+// after the given AstNode::editCountGbl(), including values of referenced
+// variables, which V3Const may substitute.
+static bool constEditedAfter(const AstNode* nodep, vluint64_t editCnt) {
+    if (nodep->editCount() > editCnt) return true;
+    if (const AstNodeVarRef* refp = VN_CAST_CONST(nodep, NodeVarRef)) {
+        if (refp->varp() && refp->varp()->valuep()
+            && refp->varp()->valuep()->editCount() > editCnt) {
+            return true;
+        }
+    }
+    const AstNode* opps[4] = {nodep->op1p(), nodep->op2p(), nodep->op3p(), nodep->op4p()};
+    for (int i = 0; i < 4; ++i) {
+        for (const AstNode* subp = opps[i]; subp; subp = subp->nextp()) {
+            if (constEditedAfter(subp, editCnt)) return true;
+        }
+    }
+    return false;
+}
+
 class ConstVarMarkVisitor : public AstNVisitor {
     // NODE STATE
     // AstVar::user4p           -> bool, Var marked, 0=not set yet
@@ -103,6 +124,9 @@ private:
     bool m_doV;  // Verilog, not C++ conversion
     bool m_doGenerate;  // Postpone width checking inside generate
     bool m_hasJumpDelay;  // JumpGo or Delay under this while
+    bool m_stmtLevel;  // Directly under a module or scope, may skip unedited statements
+    vluint64_t m_skipEditCnt;  // Skip statements not edited after this count, 0=visit all
+    VDouble0 m_statSkipped;  // Statistic tracking
     AstNodeModule* m_modp;  // Current module
     AstArraySel* m_selp;  // Current select
     AstNode* m_scopep;  // Current scope
@@ -111,6 +135,17 @@ private:
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
 
+    bool skipUnedited(AstNode* nodep) {
+        // A statement that nothing edited, including the last constifyAll,
+        // since the last constifyAll started has nothing more to optimize.
+        // Checking the next statement catches merges with it.
+        if (!m_skipEditCnt || !m_stmtLevel) return false;
+        if (nodep->nextp() && nodep->nextp()->editCount() > m_skipEditCnt) return false;
+        if (constEditedAfter(nodep, m_skipEditCnt)) return false;
+        ++m_statSkipped;
+        return true;
+    }
+
     bool operandConst(AstNode* nodep) { return VN_IS(nodep, Const); }
     bool operandAsvConst(const AstNode* nodep) {
         // BIASV(CONST, BIASV(CONST,...)) -> BIASV( BIASV_CONSTED(a,b), ...)
@@ -1280,27 +1315,51 @@ private:
     }
     virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
         AstNodeModule* origModp = m_modp;
+        bool origStmtLevel = m_stmtLevel;
         {
             m_modp = nodep;
+            m_stmtLevel = true;
             iterateChildren(nodep);
         }
         m_modp = origModp;
+        m_stmtLevel = origStmtLevel;
     }
     virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        if (skipUnedited(nodep)) return;
         // No ASSIGNW removals under funcs, we've long eliminated INITIALs
         // (We should perhaps rename the assignw's to just assigns)
         m_wremove = false;
+        bool origStmtLevel = m_stmtLevel;
+        m_stmtLevel = false;
         iterateChildren(nodep);
+        m_stmtLevel = origStmtLevel;
         m_wremove = true;
     }
     virtual void visit(AstScope* nodep) VL_OVERRIDE {
         // No ASSIGNW removals under scope, we've long eliminated INITIALs
         m_scopep = nodep;
         m_wremove = false;
+        bool origStmtLevel = m_stmtLevel;
+        m_stmtLevel = true;
         iterateChildren(nodep);
+        m_stmtLevel = origStmtLevel;
         m_wremove = true;
         m_scopep = NULL;
     }
+    virtual void visit(AstActive* nodep) VL_OVERRIDE {
+        if (skipUnedited(nodep)) return;
+        bool origStmtLevel = m_stmtLevel;
+        m_stmtLevel = false;
+        iterateChildren(nodep);
+        m_stmtLevel = origStmtLevel;
+    }
+    virtual void visit(AstNodeProcedure* nodep) VL_OVERRIDE {
+        if (skipUnedited(nodep)) return;
+        bool origStmtLevel = m_stmtLevel;
+        m_stmtLevel = false;
+        iterateChildren(nodep);
+        m_stmtLevel = origStmtLevel;
+    }
 
     void swapSides(AstNodeBiCom* nodep) {
         // COMMUTATIVE({a},CONST) -> COMMUTATIVE(CONST,{a})
@@ -1893,7 +1952,11 @@ private:
         // Don't perform any optimizations, the node won't be linked yet
     }
     virtual void visit(AstAssignW* nodep) VL_OVERRIDE {
+        if (skipUnedited(nodep)) return;
+        bool origStmtLevel = m_stmtLevel;
+        m_stmtLevel = false;
         iterateChildren(nodep);
+        m_stmtLevel = origStmtLevel;
         if (m_doNConst && replaceNodeAssign(nodep)) return;
         AstNodeVarRef* varrefp = VN_CAST(
             nodep->lhsp(),
@@ -2593,6 +2656,8 @@ public:
         m_doV = false;
         m_doGenerate = false;  // Inside generate conditionals
         m_hasJumpDelay = false;
+        m_stmtLevel = false;
+        m_skipEditCnt = 0;
         m_warn = false;
         m_wremove = true;  // Overridden in visitors
         m_modp = NULL;
@@ -2615,7 +2680,13 @@ public:
         }
         // clang-format on
     }
-    virtual ~ConstVisitor() {}
+    virtual ~ConstVisitor() {
+        if (m_skipEditCnt) {
+            V3Stats::addStatSum("Optimizations, Const unedited statements skipped",
+                                m_statSkipped);
+        }
+    }
+    void skipEditCnt(vluint64_t editCnt) { m_skipEditCnt = editCnt; }
     AstNode* mainAcceptEdit(AstNode* nodep) {
         // Operate starting at a random place
         return iterateSubtreeReturnEdits(nodep);
@@ -2718,10 +2789,16 @@ void V3Const::constifyAllLive(AstNetlist* nodep) {
 void V3Const::constifyAll(AstNetlist* nodep) {
     // Only call from Verilator.cpp, as it uses user#'s
     UINFO(2, __FUNCTION__ << ": " << endl);
+    // Statements untouched since the previous constifyAll started were
+    // already visited by it without change, so only revisit edited ones
+    static vluint64_t s_lastStartEditCnt = 0;
+    vluint64_t startEditCnt = AstNode::editCountGbl();
     {
         ConstVisitor visitor(ConstVisitor::PROC_V_EXPENSIVE);
+        visitor.skipEditCnt(s_lastStartEditCnt);
         (void)visitor.mainAcceptEdit(nodep);
     }  // Destruct before checking
+    s_lastStartEditCnt = startEditCnt;
     V3Global::dumpCheckGlobalTree("const", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
 
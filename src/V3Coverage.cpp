@@ -120,8 +120,14 @@ private:
 
         AstCoverInc* incp = new AstCoverInc(fl, declp);
         if (!trace_var_name.empty() && v3Global.opt.traceCoverage()) {
+            // Narrower counters wrap, but give smaller traces, as each change
+            // is fewer characters. A width of 1 toggles on each increment.
+            const int width = v3Global.opt.traceCoverageWidth();
+            AstNodeDType* dtypep = width == 32
+                                       ? incp->findUInt32DType()
+                                       : incp->findBitDType(width, width, VSigning::UNSIGNED);
             AstVar* varp = new AstVar(incp->fileline(), AstVarType::MODULETEMP, trace_var_name,
-                                      incp->findUInt32DType());
+                                      dtypep);
             varp->trace(true);
             varp->fileline()->modifyWarnOff(V3ErrorCode::UNUSED, true);
             m_modp->addStmtp(varp);
@@ -129,7 +135,7 @@ private:
             AstAssign* assp = new AstAssign(
                 incp->fileline(), new AstVarRef(incp->fileline(), varp, true),
                 new AstAdd(incp->fileline(), new AstVarRef(incp->fileline(), varp, false),
-                           new AstConst(incp->fileline(), AstConst::WidthedValue(), 32, 1)));
+                           new AstConst(incp->fileline(), AstConst::WidthedValue(), width, 1)));
             incp->addNext(assp);
         }
         return incp;
@@ -46,6 +46,26 @@
 //      ...
 //      ASSIGNW (BITSEL(ARRAYSEL(VARREF(x), __Vdlyvdim_x), __Vdlyvlsb_x), __Vdlyvval_x)
 //
+// With --delayed-queue, a memory with many delayed writes in one always block instead:
+// ->   VAR __Vdlyqcnt__x
+//      VAR __Vdlyqdim0__x[sites]
+//      VAR __Vdlyqlsb__x[sites]
+//      VAR __Vdlyqval__x[sites]
+//      ASSIGNPRE (__Vdlyqcnt__x, 0)
+//      ...
+//      ASSIGN (ARRAYSEL(__Vdlyqdim0__x, __Vdlyqcnt__x), dimension_number)
+//      ASSIGN (ARRAYSEL(__Vdlyqlsb__x, __Vdlyqcnt__x), lsb)
+//      ASSIGN (ARRAYSEL(__Vdlyqval__x, __Vdlyqcnt__x), rhs)
+//      ASSIGN (__Vdlyqcnt__x, __Vdlyqcnt__x + 1)
+//      ...
+//      ALWAYSPOST
+//          ASSIGN (__Vdlyqidx__x, 0)
+//          WHILE (__Vdlyqidx__x < __Vdlyqcnt__x)
+//              ASSIGN (BITSEL(ARRAYSEL(VARREF(x), ARRAYSEL(__Vdlyqdim0__x, __Vdlyqidx__x)),
+//                             ARRAYSEL(__Vdlyqlsb__x, __Vdlyqidx__x)),
+//                      ARRAYSEL(__Vdlyqval__x, __Vdlyqidx__x))
+//              ASSIGN (__Vdlyqidx__x, __Vdlyqidx__x + 1)
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -60,6 +80,97 @@
 #include <cstdarg>
 #include <deque>
 #include <map>
+#include <vector>
+
+//######################################################################
+// Delayed write queue state for one memory
+
+class DelayedQueue {
+public:
+    AstNode* m_alwaysp;  // Always block holding the delayed writes
+    int m_sites;  // Number of delayed write statements
+    int m_selWidth;  // Width of bit-selected writes, 0 = whole element
+    bool m_ok;  // All writes may share a queue
+    AstVarScope* m_cntVscp;  // __Vdlyqcnt__, NULL until first write converted
+    std::vector<AstVarScope*> m_dimVscps;  // __Vdlyqdim*__ for each dimension
+    AstVarScope* m_lsbVscp;  // __Vdlyqlsb__, NULL if not bit-selected
+    AstVarScope* m_valVscp;  // __Vdlyqval__
+    DelayedQueue()
+        : m_alwaysp(NULL)
+        , m_sites(0)
+        , m_selWidth(0)
+        , m_ok(false)
+        , m_cntVscp(NULL)
+        , m_lsbVscp(NULL)
+        , m_valVscp(NULL) {}
+};
+
+typedef std::map<AstVarScope*, DelayedQueue> DelayedQueueMap;
+
+//######################################################################
+// Count delayed writes to each memory, to find those that may use a queue
+
+class DelayedQueueVisitor : public AstNVisitor {
+private:
+    // STATE
+    DelayedQueueMap& m_queues;  // Queue state for each memory
+    AstNode* m_alwaysp;  // Current always block
+    bool m_inLoop;  // True in while loops
+
+    // VISITORS
+    virtual void visit(AstAlways* nodep) VL_OVERRIDE {
+        m_alwaysp = nodep;
+        iterateChildren(nodep);
+        m_alwaysp = NULL;
+    }
+    virtual void visit(AstWhile* nodep) VL_OVERRIDE {
+        bool oldloop = m_inLoop;
+        m_inLoop = true;
+        iterateChildren(nodep);
+        m_inLoop = oldloop;
+    }
+    virtual void visit(AstAssignDly* nodep) VL_OVERRIDE {
+        AstSel* bitselp = VN_CAST(nodep->lhsp(), Sel);
+        AstNode* dimselp = bitselp ? bitselp->fromp() : nodep->lhsp();
+        if (!VN_IS(dimselp, ArraySel)) return;
+        // Loops would write more entries than there are statements
+        bool ok = m_alwaysp && !m_inLoop;
+        AstBasicDType* basicp = nodep->lhsp()->dtypep()->basicp();
+        if (!basicp || basicp->isDouble() || basicp->isString() || basicp->isEventValue()) {
+            ok = false;
+        }
+        if (bitselp && bitselp->lsbp()->width() > 32) ok = false;
+        for (; VN_IS(dimselp, ArraySel); dimselp = VN_CAST(dimselp, ArraySel)->fromp()) {
+            if (VN_CAST(dimselp, ArraySel)->bitp()->width() > 32) ok = false;
+        }
+        AstVarRef* varrefp = VN_CAST(dimselp, VarRef);
+        if (!varrefp || !varrefp->varScopep()) return;  // Reported by DelayedVisitor
+        int selWidth = bitselp ? bitselp->widthConst() : 0;
+        DelayedQueue& queue = m_queues[varrefp->varScopep()];
+        if (!queue.m_sites) {
+            queue.m_alwaysp = m_alwaysp;
+            queue.m_selWidth = selWidth;
+            queue.m_ok = ok;
+        } else if (queue.m_alwaysp != m_alwaysp || queue.m_selWidth != selWidth) {
+            queue.m_ok = false;
+        } else {
+            queue.m_ok = queue.m_ok && ok;
+        }
+        ++queue.m_sites;
+    }
+    virtual void visit(AstNodeMath*) VL_OVERRIDE {}  // Accelerate
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    DelayedQueueVisitor(AstNetlist* nodep, DelayedQueueMap& queues)
+        : m_queues(queues)
+        , m_alwaysp(NULL)
+        , m_inLoop(false) {
+        iterate(nodep);
+    }
+    virtual ~DelayedQueueVisitor() {}
+};
 
 //######################################################################
 // Delayed state, as a visitor of each AstNode
@@ -99,6 +210,8 @@ private:
     typedef std::map<std::pair<AstNodeModule*, string>, AstVar*> VarMap;
     VarMap m_modVarMap;  // Table of new var names created under module
     VDouble0 m_statSharedSet;  // Statistic tracking
+    VDouble0 m_statQueues;  // Statistic tracking
+    DelayedQueueMap m_queues;  // Write queue state for each memory
     typedef std::map<AstVarScope*, int> ScopeVecMap;
     ScopeVecMap m_scopeVecMap;  // Next var number for each scope
 
@@ -144,6 +257,14 @@ private:
         oldvarscp->scopep()->addVarp(varscp);
         return varscp;
     }
+    AstVarScope* createQueueVarSc(AstVarScope* oldvarscp, const string& name,
+                                  AstNodeDType* subDTypep, int sites) {
+        FileLine* fl = oldvarscp->fileline();
+        AstNodeArrayDType* dtypep
+            = new AstUnpackArrayDType(fl, subDTypep, new AstRange(fl, sites - 1, 0));
+        v3Global.rootp()->typeTablep()->addTypesp(dtypep);
+        return createVarSc(oldvarscp, name, 0, dtypep);
+    }
 
     AstActive* createActivePost(AstVarRef* varrefp) {
         AstActive* newactp
@@ -216,6 +337,14 @@ private:
         UASSERT_OBJ(varrefp->varScopep(), varrefp, "Var didn't get varscoped in V3Scope.cpp");
         varrefp->unlinkFrBack();
         AstVar* oldvarp = varrefp->varp();
+        if (v3Global.opt.delayedQueue()) {
+            DelayedQueueMap::iterator it = m_queues.find(varrefp->varScopep());
+            if (it != m_queues.end() && it->second.m_ok
+                && it->second.m_sites >= v3Global.opt.delayedQueue()) {
+                createDlyQueue(nodep, lhsp, varrefp, dimvalp, bitselp, it->second);
+                return NULL;
+            }
+        }
         int modVecNum = m_scopeVecMap[varrefp->varScopep()]++;
         //
         std::deque<AstNode*> dimreadps;  // Read value for each dimension of assignment
@@ -343,6 +472,93 @@ private:
         postLogicp->addIfsp(new AstAssign(nodep->fileline(), selectsp, valreadp));
         return newlhsp;
     }
+    AstNode* newQueueSel(AstVarScope* queueVscp, AstVarScope* idxVscp, bool lvalue) {
+        FileLine* fl = queueVscp->fileline();
+        return new AstArraySel(fl, new AstVarRef(fl, queueVscp, lvalue),
+                               new AstVarRef(fl, idxVscp, false));
+    }
+    AstNode* newQueueIndex(AstNode* valp) {
+        // All indices are queued as 32 bits, see DelayedQueueVisitor
+        if (valp->width() == 32) return valp;
+        return new AstExtend(valp->fileline(), valp, 32);
+    }
+    void createDlyQueue(AstAssignDly* nodep, AstNode* lhsp, AstVarRef* varrefp,
+                        const std::deque<AstNode*>& dimvalp, AstSel* bitselp,
+                        DelayedQueue& queue) {
+        // Append this write to the memory's queue, see top of this file.
+        // Replaces all of the assignment; the caller deletes nodep.
+        FileLine* fl = nodep->fileline();
+        AstVarScope* oldvscp = varrefp->varScopep();
+        const string suffix = "__" + varrefp->varp()->shortName();
+        if (!queue.m_cntVscp) {  // First write to this memory, so create the queue
+            UINFO(4, "AssignDlyQueue: " << oldvscp << endl);
+            ++m_statQueues;
+            AstNodeDType* idxDTypep = nodep->findBitDType(32, 32, VSigning::UNSIGNED);
+            queue.m_cntVscp = createVarSc(oldvscp, "__Vdlyqcnt" + suffix, 32, NULL);
+            for (unsigned dimension = 0; dimension < dimvalp.size(); ++dimension) {
+                queue.m_dimVscps.push_back(createQueueVarSc(
+                    oldvscp, "__Vdlyqdim" + cvtToStr(dimension) + suffix, idxDTypep,
+                    queue.m_sites));
+            }
+            if (bitselp) {
+                queue.m_lsbVscp = createQueueVarSc(oldvscp, "__Vdlyqlsb" + suffix, idxDTypep,
+                                                   queue.m_sites);
+            }
+            queue.m_valVscp = createQueueVarSc(oldvscp, "__Vdlyqval" + suffix, lhsp->dtypep(),
+                                               queue.m_sites);
+            // Commit loop, in the order the writes were queued
+            AstVarScope* idxVscp = createVarSc(oldvscp, "__Vdlyqidx" + suffix, 32, NULL);
+            AstNode* selectsp = new AstVarRef(fl, oldvscp, true);
+            for (unsigned dimension = 0; dimension < dimvalp.size(); ++dimension) {
+                selectsp = new AstArraySel(
+                    fl, selectsp, newQueueSel(queue.m_dimVscps[dimension], idxVscp, false));
+            }
+            if (bitselp) {
+                selectsp = new AstSel(fl, selectsp, newQueueSel(queue.m_lsbVscp, idxVscp, false),
+                                      bitselp->widthp()->cloneTree(false));
+            }
+            AstNode* bodysp
+                = new AstAssign(fl, selectsp, newQueueSel(queue.m_valVscp, idxVscp, false));
+            bodysp->addNext(new AstAssign(
+                fl, new AstVarRef(fl, idxVscp, true),
+                new AstAdd(fl, new AstVarRef(fl, idxVscp, false),
+                           new AstConst(fl, AstConst::WidthedValue(), 32, 1))));
+            AstNode* postsp = new AstAssign(fl, new AstVarRef(fl, idxVscp, true),
+                                            new AstConst(fl, AstConst::WidthedValue(), 32, 0));
+            postsp->addNext(new AstWhile(fl,
+                                         new AstLt(fl, new AstVarRef(fl, idxVscp, false),
+                                                   new AstVarRef(fl, queue.m_cntVscp, false)),
+                                         bodysp));
+            AstAlwaysPost* finalp = new AstAlwaysPost(fl, NULL /*sens*/, postsp);
+            AstActive* newactp = createActivePost(varrefp);
+            newactp->addStmtsp(new AstAssignPre(
+                fl, new AstVarRef(fl, queue.m_cntVscp, true),
+                new AstConst(fl, AstConst::WidthedValue(), 32, 0)));
+            newactp->addStmtsp(finalp);
+        }
+        // Queue this write's index, bit position and value
+        AstNode* stmtsp = NULL;
+        for (unsigned dimension = 0; dimension < dimvalp.size(); ++dimension) {
+            stmtsp = AstNode::addNext(
+                stmtsp, new AstAssign(fl, newQueueSel(queue.m_dimVscps[dimension],
+                                                      queue.m_cntVscp, true),
+                                      newQueueIndex(dimvalp[dimension])));
+        }
+        if (bitselp) {
+            stmtsp = AstNode::addNext(
+                stmtsp, new AstAssign(fl, newQueueSel(queue.m_lsbVscp, queue.m_cntVscp, true),
+                                      newQueueIndex(bitselp->lsbp()->unlinkFrBack())));
+        }
+        stmtsp = AstNode::addNext(
+            stmtsp, new AstAssign(fl, newQueueSel(queue.m_valVscp, queue.m_cntVscp, true),
+                                  nodep->rhsp()->unlinkFrBack()));
+        stmtsp = AstNode::addNext(
+            stmtsp, new AstAssign(fl, new AstVarRef(fl, queue.m_cntVscp, true),
+                                  new AstAdd(fl, new AstVarRef(fl, queue.m_cntVscp, false),
+                                             new AstConst(fl, AstConst::WidthedValue(), 32, 1))));
+        nodep->addNextHere(stmtsp);
+        VL_DO_DANGLING(varrefp->deleteTree(), varrefp);
+    }
 
     // VISITORS
     virtual void visit(AstNetlist* nodep) VL_OVERRIDE {
@@ -481,10 +697,12 @@ public:
         m_inLoop = false;
         m_inInitial = false;
 
+        if (v3Global.opt.delayedQueue()) { DelayedQueueVisitor visitor(nodep, m_queues); }
         iterate(nodep);
     }
     virtual ~DelayedVisitor() {
         V3Stats::addStat("Optimizations, Delayed shared-sets", m_statSharedSet);
+        V3Stats::addStat("Optimizations, Delayed array queues", m_statQueues);
     }
 };
 
@@ -82,13 +82,13 @@ private:
         hierThisr = (scopep == m_scopep);
 
         // It's possible to disable relative references. This is a concession
-        // to older compilers (gcc < 4.5.x) that don't understand __restrict__
+        // to older compilers (gcc < 4.5.x) that don't understand VL_RESTRICT
         // well and emit extra ld/st to guard against pointer aliasing
         // when this-> and vlTOPp-> are mixed in the same function.
         //
         // "vlTOPp" is declared "restrict" so better compilers understand
         // that it won't alias with "this".
-        bool relativeRefOk = v3Global.opt.relativeCFuncs();
+        bool relativeRefOk = v3Global.opt.relativeCFuncs() || v3Global.opt.shareInstances();
         //
         // Static functions can't use this
         if (!m_allowThis) relativeRefOk = false;
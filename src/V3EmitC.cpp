@@ -22,23 +22,52 @@
 #include "V3EmitC.h"
 #include "V3EmitCBase.h"
 #include "V3Number.h"
+#include "V3Os.h"
 #include "V3PartitionGraph.h"
+#include "V3Stats.h"
 #include "V3TSP.h"
 
 #include <algorithm>
 #include <cmath>
 #include <cstdarg>
+#include <list>
 #include <map>
+#include <memory>
 #include <vector>
 #include VL_INCLUDE_UNORDERED_SET
 
 #define VL_VALUE_STRING_MAX_WIDTH 8192  // We use a static char array in VL_VALUE_STRING
 
 #define EMITC_NUM_CONSTW 8  // Number of VL_CONST_W_*X's in verilated.h (IE VL_CONST_W_8X is last)
+#define EMITC_COLD_ARRAY_BYTES 4096  // With --hot-cold-vars, arrays larger than this are cold
+#define EMITC_VAR_TSP_MAX 500  // Max footprints of a thread to order with V3TSP
+#define EMITC_VAR_GREEDY_WINDOW 64  // Footprints considered for each step of greedy order
 
 //######################################################################
 // Emit statements and math operators
 
+// State of the $display-like statement being emitted
+struct EmitDispState {
+    string m_format;  // "%s" and text from user
+    std::vector<char> m_argsChar;  // Format of each argument to be printed
+    std::vector<AstNode*> m_argsp;  // Each argument to be printed
+    std::vector<string> m_argsFunc;  // Function before each argument to be printed
+    EmitDispState() { clear(); }
+    void clear() {
+        m_format = "";
+        m_argsChar.clear();
+        m_argsp.clear();
+        m_argsFunc.clear();
+    }
+    void pushFormat(const string& fmt) { m_format += fmt; }
+    void pushFormat(char fmt) { m_format += fmt; }
+    void pushArg(char fmtChar, AstNode* nodep, const string& func) {
+        m_argsChar.push_back(fmtChar);
+        m_argsp.push_back(nodep);
+        m_argsFunc.push_back(func);
+    }
+};
+
 class EmitCStmts : public EmitCBaseVisitor {
 private:
     typedef std::vector<const AstVar*> VarVec;
@@ -48,8 +77,11 @@ private:
     AstVarRef* m_wideTempRefp;  // Variable that _WW macros should be setting
     VarVec m_ctorVarsVec;  // All variables in constructor order
     int m_labelNum;  // Next label number
+    int m_padNum;  // Next cache line padding number
     int m_splitSize;  // # of cfunc nodes placed into output file
     int m_splitFilenum;  // File number being created, 0 = primary
+    AstCFile* m_splitCFilep;  // File being created, which is charged the split size
+    EmitDispState m_emitDispState;  // Display being emitted
 
 public:
     // METHODS
@@ -62,12 +94,23 @@ public:
         return ++m_splitFilenum;
     }
     int splitSize() const { return m_splitSize; }
-    void splitSizeInc(int count) { m_splitSize += count; }
+    void splitCFilep(AstCFile* cfilep) { m_splitCFilep = cfilep; }
+    void splitSizeInc(int count) {
+        m_splitSize += count;
+        if (m_splitCFilep) {
+            m_splitCFilep->complexityScore(m_splitCFilep->complexityScore() + count);
+        }
+    }
     void splitSizeInc(AstNode* nodep) { splitSizeInc(EmitCBaseCounterVisitor(nodep).count()); }
     bool splitNeeded() {
         return (splitSize() && v3Global.opt.outputSplit()
                 && v3Global.opt.outputSplit() < splitSize());
     }
+    // Is mtaskp emitted as its own function, rather than inline in the
+    // function of the mtask packed before it on the same thread?
+    static bool mtaskHasFunc(const ExecMTask* mtaskp) {
+        return mtaskp->threadRoot() || v3Global.opt.threadsDynamic();
+    }
 
     // METHODS
     void displayNode(AstNode* nodep, AstScopeName* scopenamep, const string& vformat,
@@ -75,6 +118,18 @@ public:
     void displayEmit(AstNode* nodep, bool isScan);
     void displayArg(AstNode* dispp, AstNode** elistp, bool isScan, const string& vfmt,
                     char fmtLetter);
+    static bool refsVar(const AstNode* nodep, const AstVar* varp) {
+        // True if nodep or its following nodes reference varp
+        for (; nodep; nodep = nodep->nextp()) {
+            const AstNodeVarRef* refp = VN_CAST_CONST(nodep, NodeVarRef);
+            if ((refp && refp->varp() == varp) || refsVar(nodep->op1p(), varp)
+                || refsVar(nodep->op2p(), varp) || refsVar(nodep->op3p(), varp)
+                || refsVar(nodep->op4p(), varp)) {
+                return true;
+            }
+        }
+        return false;
+    }
 
     void emitVarDecl(const AstVar* nodep, const string& prefixIfImp);
     typedef enum {
@@ -82,12 +137,14 @@ public:
         EVL_CLASS_SIG,
         EVL_CLASS_TEMP,
         EVL_CLASS_PAR,
+        EVL_CLASS_COLD,
         EVL_CLASS_ALL,
         EVL_FUNC_ALL
     } EisWhich;
     void emitVarList(AstNode* firstp, EisWhich which, const string& prefixIfImp, string& sectionr);
-    static void emitVarSort(const VarSortMap& vmap, VarVec* sortedp);
+    static void emitVarSort(const VarSortMap& vmap, bool padOk, VarVec* sortedp);
     void emitSortedVarList(const VarVec& anons, const VarVec& nonanons, const string& prefixIfImp);
+    void emitVarOrPad(const AstVar* varp, const string& prefixIfImp, string* curVarCmtp);
     void emitVarCtors(bool* firstp);
     void emitCtorSep(bool* firstp);
     bool emitSimpleOk(AstNodeMath* nodep);
@@ -104,6 +161,18 @@ public:
              : (nodep->isScQuad() ? "SQ" : "SI"));
         // clang-format on
     }
+    static bool isScChangeOnly(const AstVar* varp) {
+        // Output set only when changed, see VL_ASSIGN_SII_CHG
+        return varp->isSc() && varp->isWritable() && !varp->isInoutish()
+               && VN_IS(varp->dtypeSkipRefp(), BasicDType);
+    }
+    static bool isScEventOnly(const AstVar* varp) {
+        // Wide input eval() is sensitive to, got only when changed, see VL_ASSIGN_WSW_EVT
+        return varp->isSc() && varp->isNonOutput() && !varp->isInoutish() && varp->isWide()
+               && (varp->isScSensitive() || varp->isUsedClock())
+               && VN_IS(varp->dtypeSkipRefp(), BasicDType);
+    }
+    static string scShadowName(const AstVar* varp) { return "__Vscout__" + varp->nameProtect(); }
     void emitOpName(AstNode* nodep, const string& format, AstNode* lhsp, AstNode* rhsp,
                     AstNode* thsp);
     void emitDeclArrayBrackets(const AstVar* nodep) {
@@ -202,7 +271,7 @@ public:
             for (const V3GraphVertex* vxp = depGraphp->verticesBeginp(); vxp;
                  vxp = vxp->verticesNextp()) {
                 const ExecMTask* mtp = dynamic_cast<const ExecMTask*>(vxp);
-                if (mtp->threadRoot()) {
+                if (mtaskHasFunc(mtp)) {
                     // Emit function declaration for this mtask
                     ofp()->putsPrivate(true);
                     puts("static void ");
@@ -217,8 +286,18 @@ public:
 
     // VISITORS
     virtual void visit(AstNodeAssign* nodep) VL_OVERRIDE {
+        if (AstSFormatF* fmtp = VN_CAST(nodep->rhsp(), SFormatF)) {
+            const AstVarRef* lhsRefp = VN_CAST(nodep->lhsp(), VarRef);
+            if (lhsRefp && lhsRefp->isString() && !refsVar(fmtp->exprsp(), lhsRefp->varp())) {
+                // Format into the string itself, reusing its storage, instead
+                // of copying a formatted temporary
+                displayNode(nodep, fmtp->scopeNamep(), fmtp->text(), fmtp->exprsp(), false);
+                return;
+            }
+        }
         bool paren = true;
         bool decind = false;
+        string argSuffix;  // Arguments after the right hand side
         if (AstSel* selp = VN_CAST(nodep->lhsp(), Sel)) {
             if (selp->widthMin() == 1) {
                 putbs("VL_ASSIGNBIT_");
@@ -254,21 +333,32 @@ public:
             iterateAndNextNull(selp->rhsp());
             puts(", ");
         } else if (AstVar* varp = AstVar::scVarRecurse(nodep->lhsp())) {
+            const AstVarRef* refp = VN_CAST(nodep->lhsp(), VarRef);
+            const bool changeOnly = refp && isScChangeOnly(varp);
             putbs("VL_ASSIGN_");  // Set a systemC variable
             emitScIQW(varp);
             emitIQW(nodep);
+            if (changeOnly) puts("_CHG");
             puts("(");
             puts(cvtToStr(nodep->widthMin()) + ",");
             iterateAndNextNull(nodep->lhsp());
             puts(", ");
+            if (changeOnly) {
+                puts(refp->hiernameProtect() + scShadowName(varp) + ", ");
+                puts(refp->hiernameProtect() + "__Vm_scSynced, ");
+            }
         } else if (AstVar* varp = AstVar::scVarRecurse(nodep->rhsp())) {
+            const AstVarRef* refp = VN_CAST(nodep->rhsp(), VarRef);
+            const bool eventOnly = refp && isScEventOnly(varp);
             putbs("VL_ASSIGN_");  // Get a systemC variable
             emitIQW(nodep);
             emitScIQW(varp);
+            if (eventOnly) puts("_EVT");
             puts("(");
             puts(cvtToStr(nodep->widthMin()) + ",");
             iterateAndNextNull(nodep->lhsp());
             puts(", ");
+            if (eventOnly) argSuffix = ", " + refp->hiernameProtect() + "__Vm_scSynced";
         } else if (nodep->isWide() && VN_IS(nodep->lhsp(), VarRef)  //
                    && !VN_IS(nodep->rhsp(), CMath)  //
                    && !VN_IS(nodep->rhsp(), CMethodHard)  //
@@ -293,6 +383,7 @@ public:
             puts("= ");
         }
         iterateAndNextNull(nodep->rhsp());
+        puts(argSuffix);
         if (paren) puts(")");
         if (decind) ofp()->blockDec();
         if (!m_suppressSemi) puts(";\n");
@@ -381,7 +472,7 @@ public:
     }
     virtual void visit(AstCoverDecl* nodep) VL_OVERRIDE {
         puts("__vlCoverInsert(");  // As Declared in emitCoverageDecl
-        puts("&(vlSymsp->__Vcoverage[");
+        puts(coverPerThread() ? "&(vlSymsp->__Vcoverage[0][" : "&(vlSymsp->__Vcoverage[");
         puts(cvtToStr(nodep->dataDeclThisp()->binNum()));
         puts("])");
         // If this isn't the first instantiation of this module under this
@@ -406,7 +497,12 @@ public:
         puts(");\n");
     }
     virtual void visit(AstCoverInc* nodep) VL_OVERRIDE {
-        if (v3Global.opt.threads()) {
+        if (coverPerThread()) {
+            // This thread's own counters, so no atomic or shared cache line
+            puts("++(vlSymsp->__Vcoverage[Verilated::threadSlot()][");
+            puts(cvtToStr(nodep->declp()->dataDeclThisp()->binNum()));
+            puts("]);\n");
+        } else if (v3Global.opt.threads()) {
             puts("vlSymsp->__Vcoverage[");
             puts(cvtToStr(nodep->declp()->dataDeclThisp()->binNum()));
             puts("].fetch_add(1, std::memory_order_relaxed);\n");
@@ -545,8 +641,10 @@ public:
     virtual void visit(AstNodeReadWriteMem* nodep) VL_OVERRIDE {
         puts(nodep->cFuncPrefixp());
         puts("N(");
-        puts(nodep->isHex() ? "true" : "false");
-        putbs(", ");
+        if (!nodep->isRaw()) {
+            puts(nodep->isHex() ? "true" : "false");
+            putbs(", ");
+        }
         // Need real storage width
         puts(cvtToStr(nodep->memp()->dtypep()->subDTypep()->widthMin()));
         uint32_t array_lsb = 0;
@@ -599,9 +697,9 @@ public:
         } else {
             puts("if (");
             iterateAndNextNull(nodep->filep());
-            puts(") { fflush(VL_CVT_I_FP(");
+            puts(") { VL_FFLUSH_I(");
             iterateAndNextNull(nodep->filep());
-            puts(")); }\n");
+            puts("); }\n");
         }
     }
     virtual void visit(AstFSeek* nodep) VL_OVERRIDE {
@@ -860,6 +958,18 @@ public:
             puts(")");
         }
     }
+    void visitDivConst(AstNodeBiop* nodep, const string& name) {
+        // V3Premit left a wide divisor constant that fits in a word
+        const AstConst* constp = VN_CAST(nodep->rhsp(), Const);
+        if (nodep->isWide() && constp && constp->isWide()) {
+            const string rhs = cvtToStr(constp->num().toUInt()) + "U";
+            emitOpName(nodep, name + "_WWI(%lw, %P, %li, " + rhs + ")", nodep->lhsp(), NULL, NULL);
+        } else {
+            visit(nodep);
+        }
+    }
+    virtual void visit(AstDiv* nodep) VL_OVERRIDE { visitDivConst(nodep, "VL_DIV"); }
+    virtual void visit(AstModDiv* nodep) VL_OVERRIDE { visitDivConst(nodep, "VL_MODDIV"); }
     virtual void visit(AstMulS* nodep) VL_OVERRIDE {
         if (nodep->widthWords() > VL_MULS_MAX_WORDS) {
             nodep->v3error("Unsupported: Signed multiply of "
@@ -939,14 +1049,14 @@ public:
         puts(")");
     }
     virtual void visit(AstCNew* nodep) VL_OVERRIDE {
-        puts("std::make_shared<" + prefixNameProtect(nodep->dtypep()) + ">(");
+        puts("VL_NEW<" + prefixNameProtect(nodep->dtypep()) + ">(");
         puts("vlSymsp");  // TODO make this part of argsp, and eliminate when unnecessary
         if (nodep->argsp()) puts(", ");
         iterateAndNextNull(nodep->argsp());
         puts(")");
     }
     virtual void visit(AstNewCopy* nodep) VL_OVERRIDE {
-        puts("std::make_shared<" + prefixNameProtect(nodep->dtypep()) + ">(");
+        puts("VL_NEW<" + prefixNameProtect(nodep->dtypep()) + ">(");
         puts("*");  // i.e. make into a reference
         iterateAndNextNull(nodep->rhsp());
         puts(")");
@@ -1167,8 +1277,10 @@ public:
         m_suppressSemi = false;
         m_wideTempRefp = NULL;
         m_labelNum = 0;
+        m_padNum = 0;
         m_splitSize = 0;
         m_splitFilenum = 0;
+        m_splitCFilep = NULL;
     }
 
 public:
@@ -1182,6 +1294,129 @@ public:
     virtual ~EmitCStmts() {}
 };
 
+//######################################################################
+// Find variables used on each eval, for --hot-cold-vars
+
+class EmitCHotVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    // Entire netlist:
+    //  AstVar::user4()         -> bool.  Referenced by code run on each eval
+    //  (AstUser4InUse is in V3EmitC::emitc, so the flags last while emitting)
+
+    // VISITORS
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        // Initial, settle and tracing code touches state outside of normal evals
+        if (!nodep->slow() && !nodep->funcType().isTrace()) iterateChildren(nodep);
+    }
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        if (nodep->varp()) nodep->varp()->user4(true);
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit EmitCHotVisitor(AstNetlist* nodep) { iterate(nodep); }
+    virtual ~EmitCHotVisitor() {}
+};
+
+//######################################################################
+// Map each CFunc to the source it was made from, for --prof-sample
+
+class EmitCFuncMapVisitor : public AstNVisitor {
+private:
+    // STATE
+    std::ofstream* m_ofp;  // Output file
+    AstNodeModule* m_modp;  // Current module
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        if (VN_IS(nodep, Class)) return;  // Imped with ClassPackage
+        m_modp = nodep;
+        iterateChildren(nodep);
+        m_modp = NULL;
+    }
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        if (!m_modp || nodep->dpiImport()) return;
+        // Each top level statement came from an always block or similar,
+        // called functions get their own line
+        std::vector<string> locs;
+        vl_unordered_set<string> seen;
+        for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            if (VN_IS(stmtp, CCall) || VN_IS(stmtp, Comment)) continue;
+            const string loc
+                = stmtp->fileline()->filename() + ":" + cvtToStr(stmtp->fileline()->lineno());
+            if (seen.insert(loc).second) locs.push_back(loc);
+        }
+        if (locs.empty()) {
+            locs.push_back(nodep->fileline()->filename() + ":"
+                           + cvtToStr(nodep->fileline()->lineno()));
+        }
+        string name = EmitCBaseVisitor::funcNameProtect(nodep, m_modp);
+        if (nodep->isMethod()) name = EmitCBaseVisitor::prefixNameProtect(m_modp) + "::" + name;
+        *m_ofp << name << "\t" << m_modp->prettyName() << "\t";
+        for (std::vector<string>::const_iterator it = locs.begin(); it != locs.end(); ++it) {
+            if (it != locs.begin()) *m_ofp << " ";
+            *m_ofp << *it;
+        }
+        *m_ofp << endl;
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    EmitCFuncMapVisitor(AstNetlist* nodep, std::ofstream* ofp)
+        : m_ofp(ofp)
+        , m_modp(NULL) {
+        iterate(nodep);
+    }
+    virtual ~EmitCFuncMapVisitor() {}
+};
+
+//######################################################################
+// Functions emitted into each C++ file, for verilator_profcompile
+
+class EmitCFileMap {
+    // TYPES
+    struct Entry {
+        string m_filename;  // Output file, without the directory
+        string m_funcName;  // Function, with its class, as in the C++
+        string m_modNames;  // Verilog modules the function is from
+        int m_nodes;  // Nodes in the function, approximating its compile cost
+    };
+    typedef std::vector<Entry> Entries;
+    // STATE
+    static Entries s_entries;  // Functions, in the order emitted
+
+public:
+    // METHODS
+    static void add(const V3OutFormatter* ofp, const string& funcName, const string& modNames,
+                    AstNode* nodep) {
+        Entry entry;
+        entry.m_filename = V3Os::filenameNonDir(ofp->filename());
+        entry.m_funcName = funcName;
+        entry.m_modNames = modNames;
+        entry.m_nodes = EmitCBaseCounterVisitor(nodep).count();
+        s_entries.push_back(entry);
+    }
+    static void write() {
+        const string filename
+            = v3Global.opt.makeDir() + "/" + v3Global.opt.prefix() + "__cfiles.map";
+        const vl_unique_ptr<std::ofstream> ofp(V3File::new_ofstream(filename));
+        if (ofp->fail()) v3fatal("Can't write " << filename);
+        *ofp << "# Verilator generated file map, see verilator_profcompile" << endl;
+        *ofp << "# C++ file\tC++ function\tVerilog modules\tAST nodes" << endl;
+        for (Entries::const_iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+            *ofp << it->m_filename << "\t" << it->m_funcName << "\t" << it->m_modNames << "\t"
+                 << it->m_nodes << endl;
+        }
+        s_entries.clear();
+    }
+};
+
+EmitCFileMap::Entries EmitCFileMap::s_entries;
+
 //######################################################################
 // Establish mtask variable sort order in mtasks mode
 
@@ -1189,12 +1424,14 @@ class EmitVarTspSorter : public V3TSP::TspStateBase {
 private:
     // MEMBERS
     const MTaskIdSet& m_mtaskIds;  // Mtask we're ordering
+    int m_owner;  // Thread writing the vars, or -1 if several or none
     static unsigned m_serialNext;  // Unique ID to establish serial order
     unsigned m_serial;  // Serial ordering
 public:
     // CONSTRUCTORS
-    explicit EmitVarTspSorter(const MTaskIdSet& mtaskIds)
+    EmitVarTspSorter(const MTaskIdSet& mtaskIds, int owner)
         : m_mtaskIds(mtaskIds)
+        , m_owner(owner)
         , m_serial(++m_serialNext) {}
     virtual ~EmitVarTspSorter() {}
     // METHODS
@@ -1203,12 +1440,15 @@ public:
     }
     bool operator<(const EmitVarTspSorter& other) const { return m_serial < other.m_serial; }
     const MTaskIdSet& mtaskIds() const { return m_mtaskIds; }
+    int owner() const { return m_owner; }
     virtual int cost(const TspStateBase* otherp) const {
         return cost(dynamic_cast<const EmitVarTspSorter*>(otherp));
     }
     virtual int cost(const EmitVarTspSorter* otherp) const {
         int cost = diffs(m_mtaskIds, otherp->m_mtaskIds);
         cost += diffs(otherp->m_mtaskIds, m_mtaskIds);
+        // Keep each thread's writes together, as each switch costs a cache line
+        if (m_owner != otherp->m_owner) cost += 1000;
         return cost;
     }
     // Returns the number of elements in set_a that don't appear in set_b
@@ -1219,6 +1459,30 @@ public:
         }
         return diffs;
     }
+    // Approximate V3TSP::tspSort in linear time, for many states.  States
+    // are made in footprint order, so neighbors usually have similar
+    // footprints; greedily pick the cheapest among the next few unused.
+    static void greedySort(const V3TSP::StateVec& states, V3TSP::StateVec* resultp) {
+        std::list<const TspStateBase*> unused(states.begin(), states.end());
+        while (!unused.empty()) {
+            std::list<const TspStateBase*>::iterator bestit = unused.begin();
+            if (!resultp->empty()) {
+                const TspStateBase* lastp = resultp->back();
+                int bestCost = lastp->cost(*bestit);
+                int window = EMITC_VAR_GREEDY_WINDOW;
+                for (std::list<const TspStateBase*>::iterator it = unused.begin();
+                     it != unused.end() && window-- > 0; ++it) {
+                    int cost = lastp->cost(*it);
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestit = it;
+                    }
+                }
+            }
+            resultp->push_back(*bestit);
+            unused.erase(bestit);
+        }
+    }
 };
 
 unsigned EmitVarTspSorter::m_serialNext = 0;
@@ -1227,9 +1491,13 @@ unsigned EmitVarTspSorter::m_serialNext = 0;
 // Internal EmitC implementation
 
 class EmitCImp : EmitCStmts {
+    // TYPES
+    typedef std::vector<std::pair<AstNodeModule*, AstNode*> > BucketFuncs;
+
     // MEMBERS
     AstNodeModule* m_modp;
     std::vector<AstChangeDet*> m_blkChangeDetVec;  // All encountered changes in block
+    std::vector<BucketFuncs> m_buckets;  // Functions for each --output-split-buckets file
     bool m_slow;  // Creating __Slow file
     bool m_fast;  // Creating non __Slow file (or both)
 
@@ -1286,15 +1554,15 @@ class EmitCImp : EmitCStmts {
             // Unfortunately we have some lint checks here, so we can't just skip processing.
             // We should move them to a different stage.
             string filename = VL_DEV_NULL;
-            newCFile(filename, slow, source);
+            splitCFilep(newCFile(filename, slow, source));
             ofp = new V3OutCFile(filename);
         } else if (optSystemC()) {
             string filename = filenameNoExt + (source ? ".cpp" : ".h");
-            newCFile(filename, slow, source);
+            splitCFilep(newCFile(filename, slow, source));
             ofp = new V3OutScFile(filename);
         } else {
             string filename = filenameNoExt + (source ? ".cpp" : ".h");
-            newCFile(filename, slow, source);
+            splitCFilep(newCFile(filename, slow, source));
             ofp = new V3OutCFile(filename);
         }
 
@@ -1322,19 +1590,65 @@ class EmitCImp : EmitCStmts {
 
     // Returns the number of cross-thread dependencies into mtaskp.
     // If >0, mtaskp must test whether its prereqs are done before starting,
-    // and may need to block.
+    // and may need to block.  With --threads-schedule dynamic any thread may
+    // run any mtask, so every dependency counts.
     static uint32_t packedMTaskMayBlock(const ExecMTask* mtaskp) {
         uint32_t result = 0;
         for (V3GraphEdge* edgep = mtaskp->inBeginp(); edgep; edgep = edgep->inNextp()) {
             const ExecMTask* prevp = dynamic_cast<ExecMTask*>(edgep->fromp());
-            if (prevp->thread() != mtaskp->thread()) ++result;
+            if (v3Global.opt.threadsDynamic() || prevp->thread() != mtaskp->thread()) ++result;
         }
         return result;
     }
+    // MTasks needing a VlMTaskVertex, in the order the vertices are laid
+    // out in the model.  With --threads-vertex-layout grouped, vertices
+    // waited on by the same thread are adjacent.
+    struct MTaskThreadCmp {
+        bool operator()(const ExecMTask* ap, const ExecMTask* bp) const {
+            return ap->thread() < bp->thread();
+        }
+    };
+    static std::vector<const ExecMTask*> mtaskVertices() {
+        std::vector<const ExecMTask*> mtasks;
+        const V3Graph* depGraphp = v3Global.rootp()->execGraphp()->depGraphp();
+        for (const V3GraphVertex* vxp = depGraphp->verticesBeginp(); vxp;
+             vxp = vxp->verticesNextp()) {
+            const ExecMTask* mtp = dynamic_cast<const ExecMTask*>(vxp);
+            if (packedMTaskMayBlock(mtp) > 0) mtasks.push_back(mtp);
+        }
+        if (v3Global.opt.threadsVertexGroup()) {
+            std::stable_sort(mtasks.begin(), mtasks.end(), MTaskThreadCmp());
+        }
+        return mtasks;
+    }
+    // Does finishing mtaskp unblock the fake "final" mtask?
+    static bool mtaskSignalsFinal(const ExecMTask* mtaskp) {
+        if (v3Global.opt.threadsDynamic()) return !mtaskp->outBeginp();
+        // With --threads-pipeline, the last mtask on its thread that
+        // isn't allowed to run past eval()
+        if (mtaskp->tail()) return false;
+        for (const ExecMTask* nextp = mtaskp->packNextp(); nextp; nextp = nextp->packNextp()) {
+            if (!nextp->tail()) return false;
+        }
+        return true;
+    }
+    // Does finishing mtaskp unblock the fake "tail" mtask?
+    static bool mtaskSignalsTail(const ExecMTask* mtaskp) {
+        return v3Global.opt.threadsPipeline() && !v3Global.opt.threadsDynamic()
+               && mtaskp->tail() && !mtaskp->packNextp();
+    }
 
     void emitMTaskBody(AstMTaskBody* nodep) {
         ExecMTask* curExecMTaskp = nodep->execMTaskp();
-        if (packedMTaskMayBlock(curExecMTaskp)) {
+        // Dynamic mtasks are only started once ready, so need not wait
+        const bool waits = !v3Global.opt.threadsDynamic() && packedMTaskMayBlock(curExecMTaskp);
+        const string waitName = "__Vprfwait_" + cvtToStr(curExecMTaskp->id());
+        if (waits && v3Global.opt.profThreads()) {
+            puts("vluint64_t " + waitName + " = 0;\n");
+            puts("if (VL_UNLIKELY(vlTOPp->__Vm_profile_cycle_start)) " + waitName
+                 + " = VL_RDTSC_Q();\n");
+        }
+        if (waits) {
             puts("vlTOPp->__Vm_mt_" + cvtToStr(curExecMTaskp->id())
                  + ".waitUntilUpstreamDone(even_cycle);\n");
         }
@@ -1349,9 +1663,14 @@ class EmitCImp : EmitCStmts {
             puts(recName + "->startRecord(VL_RDTSC_Q() - vlTOPp->__Vm_profile_cycle_start,");
             puts(" " + cvtToStr(curExecMTaskp->id()) + ",");
             puts(" " + cvtToStr(curExecMTaskp->cost()) + ");\n");
+            if (waits) {
+                puts("if (" + waitName + ") " + recName + "->waitRecord(" + waitName
+                     + " - vlTOPp->__Vm_profile_cycle_start);\n");
+            }
             puts("}\n");
         }
         puts("Verilated::mtaskId(" + cvtToStr(curExecMTaskp->id()) + ");\n");
+        puts("Verilated::threadContextp(vlTOPp->__Vm_contextp);\n");
 
         // The actual body of calls to leaf functions
         iterateAndNextNull(nodep->stmtsp());
@@ -1366,28 +1685,53 @@ class EmitCImp : EmitCStmts {
         // Flush message queue
         puts("Verilated::endOfThreadMTask(vlSymsp->__Vm_evalMsgQp);\n");
 
-        // For any downstream mtask that's on another thread, bump its
-        // counter and maybe notify it.
-        for (V3GraphEdge* edgep = curExecMTaskp->outBeginp(); edgep; edgep = edgep->outNextp()) {
-            const ExecMTask* nextp = dynamic_cast<ExecMTask*>(edgep->top());
-            if (nextp->thread() != curExecMTaskp->thread()) {
-                puts("vlTOPp->__Vm_mt_" + cvtToStr(nextp->id())
-                     + ".signalUpstreamDone(even_cycle);\n");
+        if (v3Global.opt.threadsDynamic()) {
+            // Bump every downstream mtask's counter, and hand any that
+            // became ready to the thread pool.
+            for (V3GraphEdge* edgep = curExecMTaskp->outBeginp(); edgep;
+                 edgep = edgep->outNextp()) {
+                const ExecMTask* nextp = dynamic_cast<ExecMTask*>(edgep->top());
+                puts("if (vlTOPp->__Vm_mt_" + cvtToStr(nextp->id())
+                     + ".signalUpstreamDone(even_cycle)) {\n");
+                puts("vlTOPp->__Vm_threadPoolp->enqueueDynamic(" + protect(nextp->cFuncName())
+                     + ", even_cycle, vlSymsp);\n");
+                puts("}\n");
             }
-        }
-
-        // Run the next mtask inline
-        const ExecMTask* nextp = curExecMTaskp->packNextp();
-        if (nextp) {
-            emitMTaskBody(nextp->bodyp());
         } else {
+            // For any downstream mtask that's on another thread, bump its
+            // counter and maybe notify it.
+            for (V3GraphEdge* edgep = curExecMTaskp->outBeginp(); edgep;
+                 edgep = edgep->outNextp()) {
+                const ExecMTask* nextp = dynamic_cast<ExecMTask*>(edgep->top());
+                if (nextp->thread() != curExecMTaskp->thread()) {
+                    puts("vlTOPp->__Vm_mt_" + cvtToStr(nextp->id())
+                         + ".signalUpstreamDone(even_cycle);\n");
+                }
+            }
+
+            // Run the next mtask inline
+            const ExecMTask* nextp = curExecMTaskp->packNextp();
+            if (nextp) emitMTaskBody(nextp->bodyp());
+        }
+        if (mtaskSignalsFinal(curExecMTaskp)) {
             // Unblock the fake "final" mtask
             puts("vlTOPp->__Vm_mt_final.signalUpstreamDone(even_cycle);\n");
         }
+        if (mtaskSignalsTail(curExecMTaskp)) {
+            // Unblock the fake "tail" mtask, which the next eval waits on
+            puts("vlTOPp->__Vm_mt_tail.signalUpstreamDone(even_cycle);\n");
+        }
     }
 
     virtual void visit(AstMTaskBody* nodep) VL_OVERRIDE {
         ExecMTask* mtp = nodep->execMTaskp();
+        string modNames;
+        for (std::set<string>::const_iterator it = mtp->modules().begin();
+             it != mtp->modules().end(); ++it) {
+            modNames += (modNames.empty() ? "" : ",") + protect(*it);
+        }
+        EmitCFileMap::add(ofp(), prefixNameProtect(m_modp) + "::" + protect(mtp->cFuncName()),
+                          modNames, nodep);
         puts("\n");
         puts("void ");
         puts(prefixNameProtect(m_modp) + "::" + protect(mtp->cFuncName()));
@@ -1405,15 +1749,22 @@ class EmitCImp : EmitCStmts {
     //---------------------------------------
     // VISITORS
     using EmitCStmts::visit;  // Suppress hidden overloaded virtual function warning
-    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+    bool funcEmitted(AstCFunc* nodep) const {
         // TRACE_* and DPI handled elsewhere
-        if (nodep->funcType().isTrace()) return;
-        if (nodep->dpiImport()) return;
-        if (!(nodep->slow() ? m_slow : m_fast)) return;
+        if (nodep->funcType().isTrace()) return false;
+        if (nodep->dpiImport()) return false;
+        return nodep->slow() ? m_slow : m_fast;
+    }
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        if (!funcEmitted(nodep)) return;
 
         m_blkChangeDetVec.clear();
 
         splitSizeInc(nodep);
+        EmitCFileMap::add(ofp(),
+                          (nodep->isMethod() ? prefixNameProtect(m_modp) + "::" : string())
+                              + funcNameProtect(nodep, m_modp),
+                          protect(m_modp->prettyName()), nodep);
 
         puts("\n");
         if (nodep->ifdef() != "") puts("#ifdef " + nodep->ifdef() + "\n");
@@ -1523,7 +1874,30 @@ class EmitCImp : EmitCStmts {
         // Don't recurse to children -- this isn't the place to emit
         // function definitions for the nested CFuncs. We'll do that at the
         // end.
+        if (v3Global.opt.threadsPipeline()) {
+            // Mtasks the previous eval left running must finish first
+            puts("vlTOPp->__Vm_mt_tail.waitUntilUpstreamDone(vlTOPp->__Vm_even_cycle);\n");
+        }
         puts("vlTOPp->__Vm_even_cycle = !vlTOPp->__Vm_even_cycle;\n");
+        puts("VlThreadPool::EvalGuard __Vpool_guard(vlTOPp->__Vm_threadPoolp);\n");
+
+        if (v3Global.opt.threadsDynamic()) {
+            // Queue every mtask without dependencies, then steal work
+            // until the final mtask is done.
+            puts("vlTOPp->__Vm_threadPoolp->dynamicBegin(vlTOPp->__Vm_even_cycle);\n");
+            for (const V3GraphVertex* vxp = nodep->depGraphp()->verticesBeginp(); vxp;
+                 vxp = vxp->verticesNextp()) {
+                const ExecMTask* etp = dynamic_cast<const ExecMTask*>(vxp);
+                if (!etp->inBeginp()) {
+                    puts("vlTOPp->__Vm_threadPoolp->enqueueDynamic("
+                         + protect(etp->cFuncName()) + ", vlTOPp->__Vm_even_cycle, vlSymsp);\n");
+                }
+            }
+            puts("vlTOPp->__Vm_threadPoolp->dynamicRun(&vlTOPp->__Vm_mt_final,"
+                 " vlTOPp->__Vm_even_cycle);\n");
+            puts("Verilated::mtaskId(0);\n");
+            return;
+        }
 
         // Build the list of initial mtasks to start
         std::vector<const ExecMTask*> execMTasks;
@@ -1554,6 +1928,12 @@ class EmitCImp : EmitCStmts {
                 }
             }
             puts("vlTOPp->__Vm_mt_final.waitUntilUpstreamDone(vlTOPp->__Vm_even_cycle);\n");
+            if (v3Global.opt.threadsPipeline()) {
+                // Another model sharing the pool must not queue behind us
+                puts("if (VL_UNLIKELY(__Vpool_guard.locked())) {\n");
+                puts("vlTOPp->__Vm_mt_tail.waitUntilUpstreamDone(vlTOPp->__Vm_even_cycle);\n");
+                puts("}\n");
+            }
         }
     }
 
@@ -1610,10 +1990,33 @@ class EmitCImp : EmitCStmts {
             } else {
                 varp->v3fatalSrc("InitArray under non-arrayed var");
             }
+        } else if (varp->attrSparse()) {
+            // Sparse rows start as zero; other resets fill each page when first touched
+            AstNodeDType* leafp = dtypep->skipRefp();
+            while (AstUnpackArrayDType* arrayp = VN_CAST(leafp, UnpackArrayDType)) {
+                leafp = arrayp->subDTypep()->skipRefp();
+            }
+            AstBasicDType* leafBasicp = leafp->basicp();
+            if (leafBasicp && !leafBasicp->isOpaque() && !isResetZero(varp, leafBasicp)) {
+                splitSizeInc(1);
+                // Classes have no instance name, so their arrays are seeded by class
+                string scope = (VN_IS(m_modp, Class)
+                                    ? "\"" + m_modp->nameProtect() + "\""
+                                    : string("name()"));
+                puts(varp->nameProtect() + ".randReset(" + cvtToStr(leafp->widthMin()) + ", "
+                     + scope + ", \"" + varp->nameProtect() + "\");\n");
+            }
         } else {
             puts(emitVarResetRecurse(varp, dtypep, 0, ""));
         }
     }
+    static bool isResetZero(const AstVar* varp, const AstBasicDType* basicp) {
+        return (varp->attrFileDescr()  // Zero so we don't core dump if never $fopen
+                || basicp->isZeroInit()
+                || (v3Global.opt.underlineZero() && !varp->name().empty()
+                    && varp->name()[0] == '_')
+                || (v3Global.opt.xInitial() == "fast" || v3Global.opt.xInitial() == "0"));
+    }
     string emitVarResetRecurse(AstVar* varp, AstNodeDType* dtypep, int depth,
                                const string& suffix) {
         dtypep = dtypep->skipRefp();
@@ -1634,6 +2037,22 @@ class EmitCImp : EmitCStmts {
         } else if (AstUnpackArrayDType* adtypep = VN_CAST(dtypep, UnpackArrayDType)) {
             UASSERT_OBJ(adtypep->msb() >= adtypep->lsb(), varp,
                         "Should have swapped msb & lsb earlier.");
+            if (depth == 0) {
+                // Randomize the whole array with one call, rather than a call per row
+                AstNodeDType* leafp = adtypep;
+                vluint64_t rows = 1;
+                while (AstUnpackArrayDType* arrayp = VN_CAST(leafp, UnpackArrayDType)) {
+                    rows *= arrayp->elementsConst();
+                    leafp = arrayp->subDTypep()->skipRefp();
+                }
+                AstBasicDType* leafBasicp = leafp->basicp();
+                if (leafBasicp && !leafBasicp->isOpaque() && !isResetZero(varp, leafBasicp)
+                    && !(v3Global.opt.xInitialEdge() && varp->isUsedClock())) {
+                    splitSizeInc(1);
+                    return ("VL_RAND_RESET_N(" + cvtToStr(leafp->widthMin()) + ", "
+                            + cvtToStr(rows) + ", " + varp->nameProtect() + ");\n");
+                }
+            }
             string ivar = string("__Vi") + cvtToStr(depth);
             // MSVC++ pre V7 doesn't support 'for (int ...)', so declare in sep block
             string pre = ("{ int " + ivar + "=" + cvtToStr(0) + ";" + " for (; " + ivar + "<"
@@ -1646,12 +2065,7 @@ class EmitCImp : EmitCStmts {
             // String's constructor deals with it
             return "";
         } else if (basicp) {
-            bool zeroit
-                = (varp->attrFileDescr()  // Zero so we don't core dump if never $fopen
-                   || (basicp && basicp->isZeroInit())
-                   || (v3Global.opt.underlineZero() && !varp->name().empty()
-                       && varp->name()[0] == '_')
-                   || (v3Global.opt.xInitial() == "fast" || v3Global.opt.xInitial() == "0"));
+            bool zeroit = isResetZero(varp, basicp);
             splitSizeInc(1);
             if (dtypep->isWide()) {  // Handle unpacked; not basicp->isWide
                 string out;
@@ -1690,9 +2104,11 @@ class EmitCImp : EmitCStmts {
     // Medium level
     void emitCtorImp(AstNodeModule* modp);
     void emitConfigureImp(AstNodeModule* modp);
+    void emitMemoryImp(AstNodeModule* modp);
     void emitCoverageDecl(AstNodeModule* modp);
     void emitCoverageImp(AstNodeModule* modp);
     void emitDestructorImp(AstNodeModule* modp);
+    static bool isSavableImage(const AstVar* varp);
     void emitSavableImp(AstNodeModule* modp);
     void emitTextSection(AstType type);
     // High level
@@ -1700,11 +2116,16 @@ class EmitCImp : EmitCStmts {
     void emitImp(AstNodeModule* modp);
     void emitSettleLoop(const std::string& eval_call, bool initial);
     void emitWrapEval(AstNodeModule* modp);
+    void emitWrapCycles(AstNodeModule* modp, bool withTime);
+    void emitCosimImp(AstNodeModule* modp);
+    void emitScPortState(AstNodeModule* modp);
     void emitMTaskState();
     void emitMTaskVertexCtors(bool* firstp);
     void emitIntTop(AstNodeModule* modp);
     void emitInt(AstNodeModule* modp);
     void maybeSplit(AstNodeModule* modp);
+    void bucketFunc(AstNodeModule* modp, AstNode* nodep, const string& name);
+    void emitBuckets(AstNodeModule* fileModp);
 
 public:
     EmitCImp() {
@@ -1952,31 +2373,8 @@ void EmitCStmts::emitOpName(AstNode* nodep, const string& format, AstNode* lhsp,
 //----------------------------------------------------------------------
 // Mid level - VISITS
 
-// We only do one display at once, so can just use static state
-
-struct EmitDispState {
-    string m_format;  // "%s" and text from user
-    std::vector<char> m_argsChar;  // Format of each argument to be printed
-    std::vector<AstNode*> m_argsp;  // Each argument to be printed
-    std::vector<string> m_argsFunc;  // Function before each argument to be printed
-    EmitDispState() { clear(); }
-    void clear() {
-        m_format = "";
-        m_argsChar.clear();
-        m_argsp.clear();
-        m_argsFunc.clear();
-    }
-    void pushFormat(const string& fmt) { m_format += fmt; }
-    void pushFormat(char fmt) { m_format += fmt; }
-    void pushArg(char fmtChar, AstNode* nodep, const string& func) {
-        m_argsChar.push_back(fmtChar);
-        m_argsp.push_back(nodep);
-        m_argsFunc.push_back(func);
-    }
-} emitDispState;
-
 void EmitCStmts::displayEmit(AstNode* nodep, bool isScan) {
-    if (emitDispState.m_format == ""
+    if (m_emitDispState.m_format == ""
         && VN_IS(nodep, Display)) {  // not fscanf etc, as they need to return value
         // NOP
     } else {
@@ -2013,19 +2411,24 @@ void EmitCStmts::displayEmit(AstNode* nodep, bool isScan) {
             putbs(",");
             iterate(dispp->lhsp());
             putbs(",");
+        } else if (const AstNodeAssign* assignp = VN_CAST(nodep, NodeAssign)) {
+            isStmt = true;  // String = $sformatf(...)
+            puts("VL_SFORMAT_X(0,");
+            iterate(assignp->lhsp());
+            putbs(",");
         } else if (VN_IS(nodep, SFormatF)) {
             isStmt = false;
             puts("VL_SFORMATF_NX(");
         } else {
             nodep->v3fatalSrc("Unknown displayEmit node type");
         }
-        ofp()->putsQuoted(emitDispState.m_format);
+        ofp()->putsQuoted(m_emitDispState.m_format);
         // Arguments
-        for (unsigned i = 0; i < emitDispState.m_argsp.size(); i++) {
+        for (unsigned i = 0; i < m_emitDispState.m_argsp.size(); i++) {
             puts(",");
-            char fmt = emitDispState.m_argsChar[i];
-            AstNode* argp = emitDispState.m_argsp[i];
-            string func = emitDispState.m_argsFunc[i];
+            char fmt = m_emitDispState.m_argsChar[i];
+            AstNode* argp = m_emitDispState.m_argsp[i];
+            string func = m_emitDispState.m_argsFunc[i];
             ofp()->indentInc();
             ofp()->putbs("");
             if (func != "") puts(func);
@@ -2051,7 +2454,7 @@ void EmitCStmts::displayEmit(AstNode* nodep, bool isScan) {
         else
             puts(" ");
         // Prep for next
-        emitDispState.clear();
+        m_emitDispState.clear();
     }
 }
 
@@ -2087,9 +2490,9 @@ void EmitCStmts::displayArg(AstNode* dispp, AstNode** elistp, bool isScan, const
     } else {
         pfmt = string("%") + vfmt + fmtLetter;
     }
-    emitDispState.pushFormat(pfmt);
-    emitDispState.pushArg(' ', NULL, cvtToStr(argp->widthMin()));
-    emitDispState.pushArg(fmtLetter, argp, "");
+    m_emitDispState.pushFormat(pfmt);
+    m_emitDispState.pushArg(' ', NULL, cvtToStr(argp->widthMin()));
+    m_emitDispState.pushArg(fmtLetter, argp, "");
 
     // Next parameter
     *elistp = (*elistp)->nextp();
@@ -2101,7 +2504,7 @@ void EmitCStmts::displayNode(AstNode* nodep, AstScopeName* scopenamep, const str
 
     // Convert Verilog display to C printf formats
     //          "%0t" becomes "%d"
-    emitDispState.clear();
+    m_emitDispState.clear();
     string vfmt;
     string::const_iterator pos = vformat.begin();
     bool inPct = false;
@@ -2111,7 +2514,7 @@ void EmitCStmts::displayNode(AstNode* nodep, AstScopeName* scopenamep, const str
             inPct = true;
             vfmt = "";
         } else if (!inPct) {  // Normal text
-            emitDispState.pushFormat(*pos);
+            m_emitDispState.pushFormat(*pos);
         } else {  // Format character
             inPct = false;
             switch (tolower(pos[0])) {
@@ -2123,7 +2526,7 @@ void EmitCStmts::displayNode(AstNode* nodep, AstScopeName* scopenamep, const str
                 inPct = true;  // Get more digits
                 break;
             case '%':
-                emitDispState.pushFormat("%%");  // We're printf'ing it, so need to quote the %
+                m_emitDispState.pushFormat("%%");  // We're printf'ing it, so need to quote the %
                 break;
             // Special codes
             case '~': displayArg(nodep, &elistp, isScan, vfmt, 'd'); break;  // Signed decimal
@@ -2148,17 +2551,17 @@ void EmitCStmts::displayNode(AstNode* nodep, AstScopeName* scopenamep, const str
                 UASSERT_OBJ(scopenamep, nodep, "Display with %m but no AstScopeName");
                 string suffix = scopenamep->scopePrettySymName();
                 if (suffix == "") {
-                    emitDispState.pushFormat("%S");
+                    m_emitDispState.pushFormat("%S");
                 } else {
-                    emitDispState.pushFormat("%N");  // Add a . when needed
+                    m_emitDispState.pushFormat("%N");  // Add a . when needed
                 }
-                emitDispState.pushArg(' ', NULL, "vlSymsp->name()");
-                emitDispState.pushFormat(suffix);
+                m_emitDispState.pushArg(' ', NULL, "vlSymsp->name()");
+                m_emitDispState.pushFormat(suffix);
                 break;
             }
             case 'l': {
                 // Better than not compiling
-                emitDispState.pushFormat("----");
+                m_emitDispState.pushFormat("----");
                 break;
             }
             default:
@@ -2182,7 +2585,7 @@ void EmitCImp::emitCoverageDecl(AstNodeModule* modp) {
         ofp()->putsPrivate(true);
         putsDecoration("// Coverage\n");
         puts("void __vlCoverInsert(");
-        puts(v3Global.opt.threads() ? "std::atomic<uint32_t>" : "uint32_t");
+        puts(coverCountType());
         puts("* countp, bool enable, const char* filenamep, int lineno, int column,\n");
         puts("const char* hierp, const char* pagep, const char* commentp);\n");
     }
@@ -2193,21 +2596,30 @@ void EmitCImp::emitMTaskVertexCtors(bool* firstp) {
     UASSERT_OBJ(execGraphp, v3Global.rootp(), "Root should have an execGraphp");
     const V3Graph* depGraphp = execGraphp->depGraphp();
 
+    // Same order as the declarations in emitMTaskState
+    const std::vector<const ExecMTask*> mtasks = mtaskVertices();
+    for (std::vector<const ExecMTask*>::const_iterator it = mtasks.begin(); it != mtasks.end();
+         ++it) {
+        emitCtorSep(firstp);
+        puts("__Vm_mt_" + cvtToStr((*it)->id()) + "(" + cvtToStr(packedMTaskMayBlock(*it))
+             + ")");
+    }
     unsigned finalEdgesInCt = 0;
+    unsigned tailEdgesInCt = 0;
     for (const V3GraphVertex* vxp = depGraphp->verticesBeginp(); vxp; vxp = vxp->verticesNextp()) {
         const ExecMTask* mtp = dynamic_cast<const ExecMTask*>(vxp);
-        unsigned edgesInCt = packedMTaskMayBlock(mtp);
-        if (packedMTaskMayBlock(mtp) > 0) {
-            emitCtorSep(firstp);
-            puts("__Vm_mt_" + cvtToStr(mtp->id()) + "(" + cvtToStr(edgesInCt) + ")");
-        }
         // Each mtask with no packed successor will become a dependency
         // for the final node:
-        if (!mtp->packNextp()) ++finalEdgesInCt;
+        if (mtaskSignalsFinal(mtp)) ++finalEdgesInCt;
+        if (mtaskSignalsTail(mtp)) ++tailEdgesInCt;
     }
 
     emitCtorSep(firstp);
     puts("__Vm_mt_final(" + cvtToStr(finalEdgesInCt) + ")");
+    if (v3Global.opt.threadsPipeline()) {
+        emitCtorSep(firstp);
+        puts("__Vm_mt_tail(" + cvtToStr(tailEdgesInCt) + ")");
+    }
 
     // This will flip to 'true' before the start of the 0th cycle.
     emitCtorSep(firstp);
@@ -2240,6 +2652,8 @@ void EmitCImp::emitCtorImp(AstNodeModule* modp) {
     putsDecoration("// Reset internal values\n");
     if (modp->isTop()) {
         if (v3Global.opt.inhibitSim()) puts("__Vm_inhibitSim = false;\n");
+        puts("__Vm_contextp = NULL;\n");
+        if (optSystemC()) puts("__Vm_scSynced = false;\n");
         puts("\n");
     }
     putsDecoration("// Reset structure values\n");
@@ -2247,34 +2661,36 @@ void EmitCImp::emitCtorImp(AstNodeModule* modp) {
     emitTextSection(AstType::atScCtor);
 
     if (modp->isTop() && v3Global.opt.mtasks()) {
-        // TODO-- For now each top module creates its own ThreadPool here,
-        // and deletes it in the destructor. If A and B are each top level
-        // modules, each creates a separate thread pool.  This allows
-        // A.eval() and B.eval() to run concurrently without any
-        // interference -- so long as the physical machine has enough cores
-        // to support both pools and all testbench threads.
-        //
-        // In the future, we might want to let the client provide a
-        // threadpool to the constructor. This would allow two or more
-        // models to share a single threadpool.
+        // Each top module creates its own ThreadPool here, and deletes it
+        // in the destructor, so A.eval() and B.eval() can run concurrently
+        // without interference, so long as the machine has enough cores for
+        // both pools and all testbench threads.
         //
-        // For example: suppose models A and B are each compiled to run on
-        // 4 threads. The client might create a single thread pool with 3
-        // threads and pass it to both models. If the client can ensure that
-        // A.eval() and B.eval() do NOT run concurrently, there will be no
-        // contention for the threads. This mode is missing for now.  (Is
-        // there demand for such a setup?)
-        puts("__Vm_threadPoolp = new VlThreadPool("
+        // Alternatively the client may create one pool and pass it with
+        // VlThreadPool::modelPoolp() to many models, which then take turns
+        // running their mtasks on the same threads.
+        puts("__Vm_threadPoolp = VlThreadPool::modelAttach("
              // Note we create N-1 threads in the thread pool. The thread
              // that calls eval() becomes the final Nth thread for the
              // duration of the eval call.
              + cvtToStr(v3Global.opt.threads() - 1) + ", " + cvtToStr(v3Global.opt.profThreads())
              + ");\n");
+        if (v3Global.opt.coverage() && coverPerThread() && v3Global.opt.threadsDynamic()) {
+            // Dynamic scheduling runs mtasks on every thread of the pool,
+            // but there are only coverage counters for the model's threads
+            puts("if (VL_UNLIKELY(__Vm_threadPoolp->numThreads() >= "
+                 + cvtToStr(v3Global.opt.threads()) + ")) {\n");
+            puts("VL_FATAL_MT(__FILE__, __LINE__, \"\", \"Shared VlThreadPool has more threads"
+                 " than model Verilated with --coverage-per-thread\");\n");
+            puts("}\n");
+        }
 
         if (v3Global.opt.profThreads()) {
             puts("__Vm_profile_cycle_start = 0;\n");
             puts("__Vm_profile_time_finished = 0;\n");
-            puts("__Vm_profile_window_ct = 0;");
+            puts("__Vm_profile_window_ct = 0;\n");
+            puts("__Vm_profile_sample_ticks = 0;\n");
+            puts("__Vm_profile_sample_ct = 0;\n");
         }
     }
     puts("}\n");
@@ -2299,16 +2715,50 @@ void EmitCImp::emitConfigureImp(AstNodeModule* modp) {
     splitSizeInc(10);
 }
 
+void EmitCImp::emitMemoryImp(AstNodeModule* modp) {
+    if (modp->isTop()) {
+        puts("\nvoid " + prefixNameProtect(modp)
+             + "::memoryUsage(VerilatedMemoryUsage& usage) const {\n");
+        puts("__VlSymsp->" + protect("__Vmemory") + "(usage);\n");
+        puts("}\n");
+    }
+    // Sizes of the members, by category, as in V3Stats' memory report
+    std::vector<string> sizes[V3Stats::MEM__MAX];
+    for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+        if (const AstVar* varp = VN_CAST(nodep, Var)) {
+            const V3Stats::MemCategory cat = V3Stats::memCategory(varp);
+            if (cat != V3Stats::MEM__MAX) sizes[cat].push_back(varp->nameProtect());
+        }
+    }
+    puts("\nvoid " + prefixNameProtect(modp) + "::" + protect("__Vmemory")
+         + "(VerilatedMemoryUsage& __Vusage) const {\n");
+    puts("if (false && __Vusage.total()) {}  // Prevent unused\n");
+    for (int cat = 0; cat < V3Stats::MEM__MAX; ++cat) {
+        if (sizes[cat].empty()) continue;
+        puts("__Vusage.add(VerilatedMemoryUsage::");
+        puts(V3Stats::memCategoryEnum(static_cast<V3Stats::MemCategory>(cat)));
+        puts(",");
+        for (std::vector<string>::const_iterator it = sizes[cat].begin(); it != sizes[cat].end();
+             ++it) {
+            puts(string(it == sizes[cat].begin() ? " " : "\n+ ") + "sizeof(" + *it + ")");
+        }
+        puts(");\n");
+        splitSizeInc(static_cast<int>(sizes[cat].size()));
+    }
+    puts("}\n");
+    splitSizeInc(10);
+}
+
 void EmitCImp::emitCoverageImp(AstNodeModule* modp) {
     if (v3Global.opt.coverage()) {
         puts("\n// Coverage\n");
         // Rather than putting out VL_COVER_INSERT calls directly, we do it via this function
         // This gets around gcc slowness constructing all of the template arguments.
         puts("void " + prefixNameProtect(m_modp) + "::__vlCoverInsert(");
-        puts(v3Global.opt.threads() ? "std::atomic<uint32_t>" : "uint32_t");
+        puts(coverCountType());
         puts("* countp, bool enable, const char* filenamep, int lineno, int column,\n");
         puts("const char* hierp, const char* pagep, const char* commentp) {\n");
-        if (v3Global.opt.threads()) {
+        if (v3Global.opt.threads() && !coverPerThread()) {
             puts("assert(sizeof(uint32_t) == sizeof(std::atomic<uint32_t>));\n");
             puts("uint32_t* count32p = reinterpret_cast<uint32_t*>(countp);\n");
         } else {
@@ -2319,7 +2769,15 @@ void EmitCImp::emitCoverageImp(AstNodeModule* modp) {
         // Used for second++ instantiation of identical bin
         puts("if (!enable) count32p = &fake_zero_count;\n");
         puts("*count32p = 0;\n");
-        puts("VL_COVER_INSERT(count32p,");
+        if (coverPerThread()) {
+            // Count is the sum of the point's counter in each thread's block
+            puts("const size_t stride = sizeof(__VlSymsp->__Vcoverage[0]) / sizeof(uint32_t);\n");
+            puts("const int copies = !enable ? 1\n");
+            puts("    : sizeof(__VlSymsp->__Vcoverage) / sizeof(__VlSymsp->__Vcoverage[0]);\n");
+            puts("VL_COVER_INSERT_SUM(count32p, stride, copies,");
+        } else {
+            puts("VL_COVER_INSERT(count32p,");
+        }
         puts("  \"filename\",filenamep,");
         puts("  \"lineno\",lineno,");
         puts("  \"column\",column,\n");
@@ -2333,12 +2791,48 @@ void EmitCImp::emitCoverageImp(AstNodeModule* modp) {
     }
 }
 
+void EmitCImp::emitCosimImp(AstNodeModule* modp) {
+    puts("\nvoid " + prefixNameProtect(modp)
+         + "::cosimPorts(VerilatedCosimLink& link, const char* prefix) {\n");
+    puts("const std::string pre = prefix;\n");
+    for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+        const AstVar* varp = VN_CAST(nodep, Var);
+        if (!varp || !varp->isIO() || varp->isInoutish()) continue;
+        // Unpacked arrays, reals and strings are not boundary signals
+        if (VN_IS(varp->dtypeSkipRefp(), UnpackArrayDType) || varp->isDouble()
+            || varp->isString()) {
+            continue;
+        }
+        puts(varp->isNonOutput() ? "link.addInput((pre + " : "link.addOutput((pre + ");
+        putsQuoted(varp->prettyName());
+        puts(").c_str(), &" + varp->nameProtect() + ", " + cvtToStr(varp->width()) + ");\n");
+    }
+    puts("}\n");
+    splitSizeInc(10);
+}
+
 void EmitCImp::emitDestructorImp(AstNodeModule* modp) {
     puts("\n");
     puts(prefixNameProtect(modp) + "::~" + prefixNameProtect(modp) + "() {\n");
     if (modp->isTop()) {
+        // Don't leave this thread using the context of a deleted model
+        puts("if (__Vm_contextp && Verilated::threadContextp() == __Vm_contextp) {\n");
+        puts("Verilated::threadContextp(NULL);\n");
+        puts("}\n");
         if (v3Global.opt.mtasks()) {
-            puts("VL_DO_CLEAR(delete __Vm_threadPoolp, __Vm_threadPoolp = NULL);\n");
+            if (v3Global.opt.profThreads()) {
+                // Flush whatever sampling collected
+                puts("if (Verilated::profThreadsSample() && __Vm_profile_sample_ticks) {\n");
+                puts("__Vm_threadPoolp->profileDump(Verilated::profThreadsFilenamep(), "
+                     "__Vm_profile_sample_ticks, "
+                     + symClassName() + "::__Vm_profMTaskInfop);\n");
+                puts("}\n");
+            }
+            if (v3Global.opt.threadsPipeline()) {
+                puts("__Vm_mt_tail.waitUntilUpstreamDone(__Vm_even_cycle);\n");
+            }
+            puts("VL_DO_CLEAR(VlThreadPool::modelDetach(__Vm_threadPoolp),"
+                 " __Vm_threadPoolp = NULL);\n");
         }
         // Call via function in __Trace.cpp as this .cpp file does not have trace header
         if (v3Global.needTraceDumper()) {
@@ -2353,32 +2847,58 @@ void EmitCImp::emitDestructorImp(AstNodeModule* modp) {
     splitSizeInc(10);
 }
 
+bool EmitCImp::isSavableImage(const AstVar* varp) {
+    // Unpacked array saved as its image in memory, as has no strings etc
+    AstNodeDType* elementp = varp->dtypeSkipRefp();
+    if (!VN_IS(elementp, UnpackArrayDType)) return false;
+    while (AstUnpackArrayDType* arrayp = VN_CAST(elementp, UnpackArrayDType)) {
+        elementp = arrayp->subDTypep()->skipRefp();
+    }
+    const AstBasicDType* basicp = elementp->basicp();
+    return basicp && basicp->keyword() != AstBasicDTypeKwd::STRING;
+}
+
 void EmitCImp::emitSavableImp(AstNodeModule* modp) {
     if (v3Global.opt.savable()) {
         puts("\n// Savable\n");
         for (int de = 0; de < 2; ++de) {
             string classname = de ? "VerilatedDeserialize" : "VerilatedSerialize";
-            string funcname = de ? "__Vdeserialize" : "__Vserialize";
+            string funcname = de ? "__VdeserializeScope" : "__VserializeScope";
             string op = de ? ">>" : "<<";
+            if (modp->isTop()) {
+                // The symbol table saves each scope, starting with this one
+                string entryname = de ? "__Vdeserialize" : "__Vserialize";
+                // NOLINTNEXTLINE(performance-inefficient-string-concatenation)
+                puts("void " + prefixNameProtect(modp) + "::" + protect(entryname) + "("
+                     + classname + "& os) {\n");
+                puts("__VlSymsp->" + protect(entryname) + "(os);\n");
+                puts("}\n");
+            }
             // NOLINTNEXTLINE(performance-inefficient-string-concatenation)
             puts("void " + prefixNameProtect(modp) + "::" + protect(funcname) + "(" + classname
-                 + "& os) {\n");
-            // Place a computed checksum to ensure proper structure save/restore formatting
-            // OK if this hash includes some things we won't dump, since
-            // just looking for loading the wrong model
+                 + "& os" + (de ? "" : ", const char* namep") + ") {\n");
+            // Place a computed checksum of the scope's layout, so a scope
+            // restores only into a model with the same variables.
+            // OK if this hash includes some things we won't dump.
             VHashSha256 hash;
             for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
-                if (const AstVar* varp = VN_CAST(nodep, Var)) {
+                if (AstVar* varp = VN_CAST(nodep, Var)) {
                     hash.insert(varp->name());
                     hash.insert(varp->dtypep()->width());
+                    hash.insert(varp->dtypep()->arrayUnpackedElements());
                 }
             }
+            if (v3Global.opt.inhibitSim()) hash.insert("__Vm_inhibitSim");
+            if (modp->isTop()) {
+                if (v3Global.opt.trace()) hash.insert("__Vm_activity");
+                hash.insert("__Vm_didInit");
+            }
             ofp()->printf("vluint64_t __Vcheckval = VL_ULL(0x%" VL_PRI64 "x);\n",
                           static_cast<vluint64_t>(hash.digestUInt64()));
             if (de) {
-                puts("os.readAssert(__Vcheckval);\n");
+                puts("if (!os.sectionLayout(__Vcheckval)) return;\n");
             } else {
-                puts("os<<__Vcheckval;\n");
+                puts("os.sectionBegin(namep, __Vcheckval);\n");
             }
 
             // Save all members
@@ -2390,6 +2910,14 @@ void EmitCImp::emitSavableImp(AstNodeModule* modp) {
                         // lower level subinst code does it.
                     } else if (varp->isParam()) {
                     } else if (varp->isStatic() && varp->isConst()) {
+                    } else if (varp->attrSparse()) {
+                        // Saves only the pages that were written
+                        puts("os" + op + varp->nameProtect() + ";\n");
+                    } else if (isSavableImage(varp)) {
+                        // Plain data array; large ones are placed so restore may mmap them
+                        puts("os." + string(de ? "readAligned" : "writeAligned") + "(&"
+                             + varp->nameProtect() + ", sizeof(" + varp->nameProtect()
+                             + "));\n");
                     } else {
                         int vects = 0;
                         AstNodeDType* elementp = varp->dtypeSkipRefp();
@@ -2425,9 +2953,13 @@ void EmitCImp::emitSavableImp(AstNodeModule* modp) {
                 }
             }
 
-            if (modp->isTop()) {  // Save the children
-                puts("__VlSymsp->" + protect(funcname) + "(os);\n");
+            if (modp->isTop()) {  // Symbol table's state
+                if (v3Global.opt.trace()) puts("os" + op + "__VlSymsp->__Vm_activity;\n");
+                puts("os" + op + "__VlSymsp->__Vm_didInit;\n");
+                // Restored values differ from the ports
+                if (de && optSystemC()) puts("__Vm_scSynced = false;\n");
             }
+            puts("os.sectionEnd();\n");
             puts("}\n");
         }
     }
@@ -2506,6 +3038,15 @@ void EmitCImp::emitSensitives() {
 }
 
 void EmitCImp::emitSettleLoop(const std::string& eval_call, bool initial) {
+    if (!v3Global.needChangeLoop()) {
+        putsDecoration("// Evaluate once, as no signals need change detection\n");
+        puts(eval_call + "\n");
+        if (v3Global.opt.profEval()) {
+            puts(initial ? "++vlSymsp->__Vm_evalStats.m_settleIterations;\n"
+                         : "vlSymsp->__Vm_evalStats.countEval(1);\n");
+        }
+        return;
+    }
     putsDecoration("// Evaluate till stable\n");
     puts("int __VclockLoop = 0;\n");
     puts("QData __Vchange = 1;\n");
@@ -2531,6 +3072,71 @@ void EmitCImp::emitSettleLoop(const std::string& eval_call, bool initial) {
     puts("__Vchange = " + protect("_change_request") + "(vlSymsp);\n");
     puts("}\n");
     puts("} while (VL_UNLIKELY(__Vchange));\n");
+    if (v3Global.opt.profEval()) {
+        puts(initial ? "vlSymsp->__Vm_evalStats.m_settleIterations += __VclockLoop;\n"
+                     : "vlSymsp->__Vm_evalStats.countEval(__VclockLoop);\n");
+    }
+}
+
+void EmitCImp::emitWrapCycles(AstNodeModule* modp, bool withTime) {
+    // evalCycles() and runCycles(); without mtasks, the checks eval_step()
+    // makes once per call are made once per loop, as only clk changes
+    puts("\nvluint64_t " + prefixNameProtect(modp));
+    if (withTime) {
+        puts("::evalCycles(CData& clk, vluint64_t cycles, vluint64_t halfPeriod, "
+             "vluint64_t* timep) {\n");
+    } else {
+        puts("::runCycles(CData& clk, vluint64_t cycles) {\n");
+    }
+    const bool hoist = !v3Global.opt.mtasks();
+    if (hoist) {
+        puts(EmitCBaseVisitor::symClassVar() + " = this->__VlSymsp;\n");
+        puts(EmitCBaseVisitor::symTopAssign() + "\n");
+        puts("Verilated::threadContextp(vlTOPp->__Vm_contextp);\n");
+        puts("#ifdef VL_DEBUG\n");
+        puts(protect("_eval_debug_assertions") + "();\n");
+        puts("#endif  // VL_DEBUG\n");
+        puts("if (VL_UNLIKELY(!vlSymsp->__Vm_didInit)) " + protect("_eval_initial_loop")
+             + "(vlSymsp);\n");
+        if (v3Global.opt.inhibitSim()) puts("if (VL_UNLIKELY(__Vm_inhibitSim)) return 0;\n");
+        if (v3Global.opt.threads() == 1) puts("Verilated::mtaskId(0);\n");
+    }
+    puts("for (vluint64_t cycle = 0; cycle < cycles; ++cycle) {\n");
+    puts("for (int edge = 0; edge < 2; ++edge) {\n");
+    if (withTime) {
+        puts("if (timep) {\n");
+        puts("*timep += halfPeriod;\n");
+        puts("} else if (__Vm_contextp) {\n");
+        puts("__Vm_contextp->timeInc(halfPeriod);\n");
+        puts("}\n");
+    }
+    puts("clk = !clk;\n");
+    if (!hoist) {
+        puts("eval();\n");
+    } else {
+        puts("{\n");
+        emitSettleLoop(((v3Global.opt.trace() ? "vlSymsp->__Vm_activity = true;\n" : "")
+                        + protect("_eval") + "(vlSymsp);"),
+                       false);
+        puts("}\n");
+        if (v3Global.opt.profLive()) puts("VerilatedLive::evalDone();\n");
+        if (v3Global.opt.threads() == 1) {
+            puts("Verilated::endOfThreadMTask(vlSymsp->__Vm_evalMsgQp);\n");
+            puts("Verilated::endOfEval(vlSymsp->__Vm_evalMsgQp);\n");
+        }
+        if (v3Global.dpiAsync()) puts("VerilatedDpiAsync::flush();\n");
+        if (v3Global.needTraceDumper()) {
+            puts("#ifdef VM_TRACE\n");
+            puts("if (VL_UNLIKELY(vlSymsp->__Vm_dumping)) _traceDump();\n");
+            puts("#endif  // VM_TRACE\n");
+        }
+    }
+    puts("if (VL_UNLIKELY(Verilated::gotFinish())) return cycle + 1;\n");
+    puts("}\n");
+    puts("}\n");
+    puts("return cycles;\n");
+    puts("}\n");
+    splitSizeInc(10);
 }
 
 void EmitCImp::emitWrapEval(AstNodeModule* modp) {
@@ -2539,6 +3145,7 @@ void EmitCImp::emitWrapEval(AstNodeModule* modp) {
          + "::eval\\n\"); );\n");
     puts(EmitCBaseVisitor::symClassVar() + " = this->__VlSymsp;  // Setup global symbol table\n");
     puts(EmitCBaseVisitor::symTopAssign() + "\n");
+    puts("Verilated::threadContextp(vlTOPp->__Vm_contextp);\n");
     puts("#ifdef VL_DEBUG\n");
     putsDecoration("// Debug assertions\n");
     puts(protect("_eval_debug_assertions") + "();\n");
@@ -2556,7 +3163,24 @@ void EmitCImp::emitWrapEval(AstNodeModule* modp) {
     }
 
     if (v3Global.opt.mtasks() && v3Global.opt.profThreads()) {
-        puts("if (VL_UNLIKELY((Verilated::profThreadsStart() != __Vm_profile_time_finished)\n");
+        // Sampling: profile every Nth eval, stitching the sampled evals
+        // together into one timeline so the bounded per-thread buffers
+        // always hold the most recent samples, ready to dump on request.
+        puts("if (VL_UNLIKELY(Verilated::profThreadsSample())) {\n");
+        puts("if (VL_UNLIKELY(Verilated::profThreadsDumpReq())) {\n");
+        puts("Verilated::profThreadsDumpReq(false);\n");
+        puts("vlTOPp->__Vm_threadPoolp->profileDump(Verilated::profThreadsFilenamep(), "
+             "vlTOPp->__Vm_profile_sample_ticks, "
+             + symClassName() + "::__Vm_profMTaskInfop);\n");
+        puts("}\n");
+        puts("if ((VL_TIME_Q() > Verilated::profThreadsStart())\n");
+        puts(" && (++vlTOPp->__Vm_profile_sample_ct >= Verilated::profThreadsSample())) {\n");
+        puts("vlTOPp->__Vm_profile_sample_ct = 0;\n");
+        puts("vlTOPp->__Vm_profile_cycle_start"
+             " = VL_RDTSC_Q() - vlTOPp->__Vm_profile_sample_ticks;\n");
+        puts("}\n");
+        puts("}\n");
+        puts("else if (VL_UNLIKELY((Verilated::profThreadsStart() != __Vm_profile_time_finished)\n");
         puts(" && (VL_TIME_Q() > Verilated::profThreadsStart())\n");
         puts(" && (Verilated::profThreadsWindow() >= 1))) {\n");
         // Within a profile (either starting, middle, or end)
@@ -2582,7 +3206,8 @@ void EmitCImp::emitWrapEval(AstNodeModule* modp) {
         // Ending file.
         puts("vluint64_t elapsed = VL_RDTSC_Q() - vlTOPp->__Vm_profile_cycle_start;\n");
         puts("vlTOPp->__Vm_threadPoolp->profileDump(Verilated::profThreadsFilenamep(), "
-             "elapsed);\n");
+             "elapsed, "
+             + symClassName() + "::__Vm_profMTaskInfop);\n");
         // This turns off the test to enter the profiling code, but still
         // allows the user to collect another profile by changing
         // profThreadsStart
@@ -2592,14 +3217,36 @@ void EmitCImp::emitWrapEval(AstNodeModule* modp) {
         puts("}\n");
     }
 
+    string mtasksCount;
+    if (v3Global.opt.mtasks() && v3Global.opt.profEval()) {
+        // Every mtask runs on each _eval, so count them here rather than in each thread
+        const V3Graph* depGraphp = v3Global.rootp()->execGraphp()->depGraphp();
+        size_t mtasks = 0;
+        for (const V3GraphVertex* vxp = depGraphp->verticesBeginp(); vxp;
+             vxp = vxp->verticesNextp()) {
+            ++mtasks;
+        }
+        mtasksCount = "\nvlSymsp->__Vm_evalStats.m_mtasks += " + cvtToStr(mtasks) + ";";
+    }
     emitSettleLoop((string("VL_DEBUG_IF(VL_DBG_MSGF(\"+ Clock loop\\n\"););\n")
                     + (v3Global.opt.trace() ? "vlSymsp->__Vm_activity = true;\n" : "")
-                    + protect("_eval") + "(vlSymsp);"),
+                    + protect("_eval") + "(vlSymsp);" + mtasksCount),
                    false);
+    if (v3Global.opt.mtasks() && v3Global.opt.profThreads()) {
+        puts("if (VL_UNLIKELY(Verilated::profThreadsSample()"
+             " && vlTOPp->__Vm_profile_cycle_start)) {\n");
+        puts("vlTOPp->__Vm_profile_sample_ticks"
+             " = VL_RDTSC_Q() - vlTOPp->__Vm_profile_cycle_start;\n");
+        puts("vlTOPp->__Vm_profile_cycle_start = 0;\n");
+        puts("}\n");
+    }
+    if (optSystemC()) puts("__Vm_scSynced = true;\n");
+    if (v3Global.opt.profLive()) puts("VerilatedLive::evalDone();\n");
     if (v3Global.opt.threads() == 1) {
         puts("Verilated::endOfThreadMTask(vlSymsp->__Vm_evalMsgQp);\n");
     }
     if (v3Global.opt.threads()) puts("Verilated::endOfEval(vlSymsp->__Vm_evalMsgQp);\n");
+    if (v3Global.dpiAsync()) puts("VerilatedDpiAsync::flush();\n");
     puts("}\n");
     splitSizeInc(10);
 
@@ -2619,6 +3266,20 @@ void EmitCImp::emitWrapEval(AstNodeModule* modp) {
         puts("}\n");
     }
 
+    if (!optSystemC()) {
+        puts("\nvluint64_t " + prefixNameProtect(modp) + "::nextTimeSlot() {\n");
+        puts("vluint64_t next = Verilated::timeEventNext();\n");
+        if (v3Global.opt.vpi()) {
+            puts("const vluint64_t vpiNext = VerilatedVpi::cbNextDeadline();\n");
+            puts("if (vpiNext < next) next = vpiNext;\n");
+        }
+        puts("return next;\n");
+        puts("}\n");
+
+        emitWrapCycles(modp, true);
+        emitWrapCycles(modp, false);
+    }
+
     //
     puts("\nvoid " + prefixNameProtect(modp) + "::" + protect("_eval_initial_loop") + "("
          + EmitCBaseVisitor::symClassVar() + ") {\n");
@@ -2655,12 +3316,22 @@ void EmitCStmts::emitVarList(AstNode* firstp, EisWhich which, const string& pref
         for (AstNode* nodep = firstp; nodep; nodep = nodep->nextp()) {
             if (const AstVar* varp = VN_CAST(nodep, Var)) {
                 bool doit = true;
+                // With --hot-cold-vars, signals and temporaries that aren't hot are
+                // moved from their sections to a cold section at the end of the class
+                bool cold = (v3Global.opt.hotColdVars() && !varp->isIO()
+                             && (varp->isSignal() || varp->isClassMember() || varp->isTemp())
+                             && (!varp->user4()  // Not referenced by hot code
+                                 || (VN_IS(varp->dtypeSkipRefp(), UnpackArrayDType)
+                                     && varp->dtypeSkipRefp()->widthTotalBytes()
+                                            > EMITC_COLD_ARRAY_BYTES)));
                 switch (which) {
                 case EVL_CLASS_IO: doit = varp->isIO(); break;
                 case EVL_CLASS_SIG:
-                    doit = ((varp->isSignal() || varp->isClassMember()) && !varp->isIO());
+                    doit = ((varp->isSignal() || varp->isClassMember()) && !varp->isIO()
+                            && !cold);
                     break;
-                case EVL_CLASS_TEMP: doit = (varp->isTemp() && !varp->isIO()); break;
+                case EVL_CLASS_TEMP: doit = (varp->isTemp() && !varp->isIO() && !cold); break;
+                case EVL_CLASS_COLD: doit = cold; break;
                 case EVL_CLASS_PAR:
                     doit = (varp->isParam() && !VN_IS(varp->valuep(), Const));
                     break;
@@ -2713,13 +3384,14 @@ void EmitCStmts::emitVarList(AstNode* firstp, EisWhich which, const string& pref
         }
         VarVec anons;
         VarVec nonanons;
-        emitVarSort(varAnonMap, &anons);
-        emitVarSort(varNonanonMap, &nonanons);
+        // Locals are per thread already, so never need padding
+        emitVarSort(varAnonMap, which != EVL_FUNC_ALL, &anons);
+        emitVarSort(varNonanonMap, which != EVL_FUNC_ALL, &nonanons);
         emitSortedVarList(anons, nonanons, prefixIfImp);
     }
 }
 
-void EmitCStmts::emitVarSort(const VarSortMap& vmap, VarVec* sortedp) {
+void EmitCStmts::emitVarSort(const VarSortMap& vmap, bool padOk, VarVec* sortedp) {
     UASSERT(sortedp->empty(), "Sorted should be initially empty");
     if (!v3Global.opt.mtasks()) {
         // Plain old serial mode. Sort by size, from small to large,
@@ -2732,31 +3404,71 @@ void EmitCStmts::emitVarSort(const VarSortMap& vmap, VarVec* sortedp) {
         return;
     }
 
-    // MacroTask mode.  Sort by MTask-affinity group first, size second.
-    typedef std::map<MTaskIdSet, VarSortMap> MTaskVarSortMap;
+    // With --threads-var-layout grouped, find the thread writing each mtask's vars
+    std::map<int, int> mtaskOwner;
+    if (padOk && v3Global.opt.threadsVarGroup()) {
+        const V3Graph* depGraphp = v3Global.rootp()->execGraphp()->depGraphp();
+        for (const V3GraphVertex* vxp = depGraphp->verticesBeginp(); vxp;
+             vxp = vxp->verticesNextp()) {
+            const ExecMTask* mtp = dynamic_cast<const ExecMTask*>(vxp);
+            // Dynamic scheduling may run any mtask on any thread
+            mtaskOwner[mtp->id()] = v3Global.opt.threadsDynamic() ? mtp->id() : mtp->thread();
+        }
+    }
+
+    // MacroTask mode.  Sort by writing thread and MTask-affinity group first, size second.
+    typedef std::map<std::pair<int, MTaskIdSet>, VarSortMap> MTaskVarSortMap;
     MTaskVarSortMap m2v;
     for (VarSortMap::const_iterator it = vmap.begin(); it != vmap.end(); ++it) {
         int size_class = it->first;
         const VarVec& vec = it->second;
         for (VarVec::const_iterator jt = vec.begin(); jt != vec.end(); ++jt) {
             const AstVar* varp = *jt;
-            m2v[varp->mtaskIds()][size_class].push_back(varp);
+            int owner = -1;
+            if (padOk && v3Global.opt.threadsVarGroup()) {
+                for (MTaskIdSet::const_iterator kt = varp->mtaskWriteIds().begin();
+                     kt != varp->mtaskWriteIds().end(); ++kt) {
+                    int thread = mtaskOwner[*kt];
+                    owner = (kt == varp->mtaskWriteIds().begin() || owner == thread) ? thread : -1;
+                    if (owner < 0) break;
+                }
+            }
+            m2v[std::make_pair(owner, varp->mtaskIds())][size_class].push_back(varp);
         }
     }
 
-    // Create a TSP sort state for each MTaskIdSet footprint
-    V3TSP::StateVec states;
+    // Create a TSP sort state for each footprint, separately for each
+    // writing thread, as those are kept apart regardless
+    typedef std::map<int, V3TSP::StateVec> OwnerStates;
+    OwnerStates ownerStates;
     for (MTaskVarSortMap::iterator it = m2v.begin(); it != m2v.end(); ++it) {
-        states.push_back(new EmitVarTspSorter(it->first));
+        ownerStates[it->first.first].push_back(
+            new EmitVarTspSorter(it->first.second, it->first.first));
     }
 
-    // Do the TSP sort
+    // Do the TSP sort, which is superlinear, so approximate it for many footprints
     V3TSP::StateVec sorted_states;
-    V3TSP::tspSort(states, &sorted_states);
+    for (OwnerStates::iterator it = ownerStates.begin(); it != ownerStates.end(); ++it) {
+        if (it->second.size() > EMITC_VAR_TSP_MAX) {
+            UINFO(4, "  Greedy sort of " << it->second.size() << " var footprints" << endl);
+            V3Stats::addStatSum("EmitC, Var footprints greedy sorted", it->second.size());
+            EmitVarTspSorter::greedySort(it->second, &sorted_states);
+        } else {
+            V3TSP::StateVec owner_sorted;
+            V3TSP::tspSort(it->second, &owner_sorted);
+            sorted_states.insert(sorted_states.end(), owner_sorted.begin(), owner_sorted.end());
+        }
+    }
 
+    int lastOwner = -1;
     for (V3TSP::StateVec::iterator it = sorted_states.begin(); it != sorted_states.end(); ++it) {
         const EmitVarTspSorter* statep = dynamic_cast<const EmitVarTspSorter*>(*it);
-        const VarSortMap& localVmap = m2v[statep->mtaskIds()];
+        const VarSortMap& localVmap = m2v[std::make_pair(statep->owner(), statep->mtaskIds())];
+        // NULL marks that another thread's writes start, on a new cache line
+        if (it != sorted_states.begin() && statep->owner() != lastOwner) {
+            sortedp->push_back(NULL);
+        }
+        lastOwner = statep->owner();
         // use rbegin/rend to sort size large->small
         for (VarSortMap::const_reverse_iterator jt = localVmap.rbegin(); jt != localVmap.rend();
              ++jt) {
@@ -2799,9 +3511,7 @@ void EmitCStmts::emitSortedVarList(const VarVec& anons, const VarVec& nonanons,
                 for (int l1 = 0; l1 < anonL1s && it != anons.end(); ++l1) {
                     if (anonL1s != 1) puts("struct {\n");
                     for (int l0 = 0; l0 < lim && it != anons.end(); ++l0) {
-                        const AstVar* varp = *it;
-                        emitVarCmtChg(varp, &curVarCmt);
-                        emitVarDecl(varp, prefixIfImp);
+                        emitVarOrPad(*it, prefixIfImp, &curVarCmt);
                         ++it;
                     }
                     if (anonL1s != 1) puts("};\n");
@@ -2811,39 +3521,76 @@ void EmitCStmts::emitSortedVarList(const VarVec& anons, const VarVec& nonanons,
             if (anonL3s != 1) puts("};\n");
         }
         // Leftovers, just in case off by one error somewhere above
-        for (; it != anons.end(); ++it) {
-            const AstVar* varp = *it;
-            emitVarCmtChg(varp, &curVarCmt);
-            emitVarDecl(varp, prefixIfImp);
-        }
+        for (; it != anons.end(); ++it) emitVarOrPad(*it, prefixIfImp, &curVarCmt);
     }
     // Output nonanons
     for (VarVec::const_iterator it = nonanons.begin(); it != nonanons.end(); ++it) {
-        const AstVar* varp = *it;
-        emitVarCmtChg(varp, &curVarCmt);
+        emitVarOrPad(*it, prefixIfImp, &curVarCmt);
+    }
+}
+
+void EmitCStmts::emitVarOrPad(const AstVar* varp, const string& prefixIfImp,
+                              string* curVarCmtp) {
+    if (varp) {
+        emitVarCmtChg(varp, curVarCmtp);
         emitVarDecl(varp, prefixIfImp);
+    } else {  // From emitVarSort, start a new cache line
+        puts("CData __Vpad" + cvtToStr(m_padNum++)
+             + " VL_ATTR_ALIGNED(VL_CACHE_LINE_BYTES);  // Next thread's writes\n");
     }
 }
 
+void EmitCImp::emitScPortState(AstNodeModule* modp) {
+    // Values last set on each output, so unchanged outputs are not set again
+    ofp()->putsPrivate(true);
+    puts("bool __Vm_scSynced;  ///< All SystemC ports transferred once, see VL_ASSIGN_*_CHG\n");
+    for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+        if (const AstVar* varp = VN_CAST(nodep, Var)) {
+            if (varp->isIO() && isScChangeOnly(varp)) {
+                if (varp->isWide()) {
+                    puts("WData " + scShadowName(varp) + "[" + cvtToStr(varp->widthWords())
+                         + "];\n");
+                } else {
+                    puts(string(varp->isQuad() ? "QData " : "IData ") + scShadowName(varp)
+                         + ";\n");
+                }
+            }
+        }
+    }
+    ofp()->putsPrivate(false);  // public:
+}
+
 void EmitCImp::emitMTaskState() {
     ofp()->putsPrivate(true);
     AstExecGraph* execGraphp = v3Global.rootp()->execGraphp();
     UASSERT_OBJ(execGraphp, v3Global.rootp(), "Root should have an execGraphp");
 
-    const V3Graph* depGraphp = execGraphp->depGraphp();
-    for (const V3GraphVertex* vxp = depGraphp->verticesBeginp(); vxp; vxp = vxp->verticesNextp()) {
-        const ExecMTask* mtp = dynamic_cast<const ExecMTask*>(vxp);
-        if (packedMTaskMayBlock(mtp) > 0) {
-            puts("VlMTaskVertex __Vm_mt_" + cvtToStr(mtp->id()) + ";\n");
-        }
+    // Vertices are signalled by one thread and spun on by another, so
+    // optionally keep unrelated vertices off each others' cache lines
+    const string aligned = " VL_ATTR_ALIGNED(VL_CACHE_LINE_BYTES)";
+    const std::vector<const ExecMTask*> mtasks = mtaskVertices();
+    for (std::vector<const ExecMTask*>::const_iterator it = mtasks.begin(); it != mtasks.end();
+         ++it) {
+        // Grouped starts each thread's vertices on a new line
+        bool align = v3Global.opt.threadsVertexPad()
+                     || (v3Global.opt.threadsVertexGroup()
+                         && (it == mtasks.begin() || (*it)->thread() != (*(it - 1))->thread()));
+        puts("VlMTaskVertex __Vm_mt_" + cvtToStr((*it)->id()) + (align ? aligned : "") + ";\n");
     }
     // This fake mtask depends on all the real ones.  We use it to block
     // eval() until all mtasks are done.
     //
-    // In the future we might allow _eval() to return before the graph is
-    // fully done executing, for "half wave" scheduling. For now we wait
-    // for all mtasks though.
-    puts("VlMTaskVertex __Vm_mt_final;\n");
+    // With --threads-pipeline, it depends only on the mtasks that aren't
+    // tails.  Tail mtasks touch nothing the client or code outside of
+    // mtasks can see, so eval() returns while they still run, and the
+    // fake "tail" mtask blocks the next eval() until they are done.
+    // Overlapping them with the next eval's mtasks instead would need
+    // edges from each tail to next-eval mtasks sharing its variables.
+    bool alignFinal = v3Global.opt.threadsVertexPad() || v3Global.opt.threadsVertexGroup();
+    puts("VlMTaskVertex __Vm_mt_final" + (alignFinal ? aligned : "") + ";\n");
+    if (v3Global.opt.threadsPipeline()) {
+        puts("VlMTaskVertex __Vm_mt_tail" + (alignFinal ? aligned : "") + ";\n");
+    }
     puts("VlThreadPool* __Vm_threadPoolp;\n");
 
     if (v3Global.opt.profThreads()) {
@@ -2853,6 +3600,9 @@ void EmitCImp::emitMTaskState() {
         puts("vluint64_t __Vm_profile_time_finished;\n");
         // Track our position in the cache warmup and actual profile window
         puts("vluint32_t __Vm_profile_window_ct;\n");
+        // Sampled ticks so far, and evals since last sample
+        puts("vluint64_t __Vm_profile_sample_ticks;\n");
+        puts("vluint32_t __Vm_profile_sample_ct;\n");
     }
 
     puts("bool __Vm_even_cycle;\n");
@@ -2871,6 +3621,8 @@ void EmitCImp::emitIntTop(AstNodeModule* modp) {
     }
     if (v3Global.opt.mtasks()) puts("#include \"verilated_threads.h\"\n");
     if (v3Global.opt.savable()) puts("#include \"verilated_save.h\"\n");
+    if (v3Global.opt.profLive()) puts("#include \"verilated_live.h\"\n");
+    if (v3Global.opt.cosim()) puts("#include \"verilated_cosim.h\"\n");
     if (v3Global.opt.coverage()) {
         puts("#include \"verilated_cov.h\"\n");
         if (v3Global.opt.savable()) v3error("--coverage and --savable not supported together");
@@ -2898,7 +3650,11 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
 
     if (AstClass* classp = VN_CAST(modp, Class)) {
         puts("class " + prefixNameProtect(modp));
-        if (classp->extendsp()) puts(" : public " + classp->extendsp()->classp()->nameProtect());
+        if (classp->extendsp()) {
+            puts(" : public " + classp->extendsp()->classp()->nameProtect());
+        } else {
+            puts(" : public VlClass");
+        }
         puts(" {\n");
     } else if (optSystemC() && modp->isTop()) {
         puts("SC_MODULE(" + prefixNameProtect(modp) + ") {\n");
@@ -2954,6 +3710,8 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
         if (v3Global.opt.inhibitSim()) {
             puts("bool __Vm_inhibitSim;  ///< Set true to disable evaluation of module\n");
         }
+        puts("VerilatedContext* __Vm_contextp;  ///< Set by contextp(), or NULL\n");
+        if (optSystemC()) emitScPortState(modp);
         if (v3Global.opt.mtasks()) emitMTaskState();
     }
     emitCoverageDecl(modp);  // may flip public/private
@@ -2994,6 +3752,11 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
         }
     }
 
+    section = "\n// COLD VARIABLES\n";
+    if (modp->isTop()) section += "// Internals rarely used on each eval, after the others\n";
+    ofp()->putsPrivate(false);  // public:
+    emitVarList(modp->stmtsp(), EVL_CLASS_COLD, "", section /*ref*/);
+
     if (!VN_IS(modp, Class)) {
         puts("\n// CONSTRUCTORS\n");
         ofp()->resetPrivate();
@@ -3075,6 +3838,40 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
                  "must call on completion.\n");
         }
         puts("void final();\n");
+        if (!optSystemC()) {
+            puts("/// Add the bytes of memory the model uses, by category, to usage.\n");
+        }
+        puts("void memoryUsage(VerilatedMemoryUsage& usage) const;\n");
+        if (!optSystemC()) {
+            puts("/// Keep time, $finish, errors and random seed in a context, so\n");
+            puts("/// independent models may run on other threads; see VerilatedContext.\n");
+            puts("/// Set before the first eval.\n");
+        }
+        puts("void contextp(VerilatedContext* contextp) { __Vm_contextp = contextp; }\n");
+        puts("VerilatedContext* contextp() const { return __Vm_contextp; }\n");
+        if (!optSystemC()) {
+            puts("/// Earliest time after now the model must next be evaluated at, from\n");
+            puts("/// Verilated::timeEventAdd()");
+            if (v3Global.opt.vpi()) puts(" and VPI cbAfterDelay callbacks");
+            puts(", or ~0 if none.\n");
+            puts("/// An idle testbench may advance time directly to it.\n");
+            puts("vluint64_t nextTimeSlot();\n");
+            puts("/// Toggle clk and eval() on each edge for 'cycles' cycles, stopping\n");
+            puts("/// after $finish.  Each edge first adds halfPeriod to *timep if given,\n");
+            puts("/// else to the contextp() time.  Returns the cycles run, including\n");
+            puts("/// one ended early by $finish.\n");
+            puts("vluint64_t evalCycles(CData& clk, vluint64_t cycles,\n");
+            puts("vluint64_t halfPeriod = 0, vluint64_t* timep = NULL);\n");
+            puts("/// As evalCycles() without advancing time, for the fastest\n");
+            puts("/// free-running clock; inputs other than clk must not change.\n");
+            puts("vluint64_t runCycles(CData& clk, vluint64_t cycles);\n");
+            if (v3Global.opt.cosim()) {
+                puts("/// Register the top ports with a co-simulation link, inputs set\n");
+                puts("/// by the partner's outputs of the same name; see VerilatedCosimLink.\n");
+                puts("/// A partition cut with --cosim-cut passes \"<instance>__\" as prefix.\n");
+                puts("void cosimPorts(VerilatedCosimLink& link, const char* prefix = \"\");\n");
+            }
+        }
         if (v3Global.opt.inhibitSim()) {
             puts("/// Disable evaluation of module (e.g. turn off)\n");
             puts("void inhibitSim(bool flag) { __Vm_inhibitSim = flag; }\n");
@@ -3096,6 +3893,7 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
     if (!VN_IS(modp, Class)) {
         ofp()->putsPrivate(false);  // public:
         puts("void " + protect("__Vconfigure") + "(" + symClassName() + "* symsp, bool first);\n");
+        puts("void " + protect("__Vmemory") + "(VerilatedMemoryUsage& usage) const;\n");
     }
 
     ofp()->putsPrivate(false);  // public:
@@ -3112,8 +3910,13 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
     }
     if (v3Global.opt.savable()) {
         ofp()->putsPrivate(false);  // public:
-        puts("void " + protect("__Vserialize") + "(VerilatedSerialize& os);\n");
-        puts("void " + protect("__Vdeserialize") + "(VerilatedDeserialize& os);\n");
+        if (modp->isTop()) {
+            puts("void " + protect("__Vserialize") + "(VerilatedSerialize& os);\n");
+            puts("void " + protect("__Vdeserialize") + "(VerilatedDeserialize& os);\n");
+        }
+        puts("void " + protect("__VserializeScope")
+             + "(VerilatedSerialize& os, const char* namep);\n");
+        puts("void " + protect("__VdeserializeScope") + "(VerilatedDeserialize& os);\n");
     }
 
     puts("}");
@@ -3146,6 +3949,9 @@ void EmitCImp::emitImpTop(AstNodeModule* fileModp) {
         puts("\n");
         puts("#include \"verilated_dpi.h\"\n");
     }
+    if (v3Global.opt.vpi() && fileModp->isTop() && !optSystemC()) {
+        puts("#include \"verilated_vpi.h\"\n");
+    }
 
     emitModCUse(fileModp, VUseType::IMP_INCLUDE);
     emitModCUse(fileModp, VUseType::IMP_FWD_CLASS);
@@ -3160,6 +3966,8 @@ void EmitCImp::emitImp(AstNodeModule* modp) {
         emitVarList(modp->stmtsp(), EVL_CLASS_ALL, prefixNameProtect(modp), section /*ref*/);
         if (!VN_IS(modp, Class)) emitCtorImp(modp);
         if (!VN_IS(modp, Class)) emitConfigureImp(modp);
+        if (!VN_IS(modp, Class)) emitMemoryImp(modp);
+        if (modp->isTop() && v3Global.opt.cosim()) emitCosimImp(modp);
         if (!VN_IS(modp, Class)) emitDestructorImp(modp);
         emitSavableImp(modp);
         emitCoverageImp(modp);
@@ -3173,14 +3981,42 @@ void EmitCImp::emitImp(AstNodeModule* modp) {
     // Blocks
     for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
         if (AstCFunc* funcp = VN_CAST(nodep, CFunc)) {
-            maybeSplit(modp);
-            mainDoFunc(funcp);
+            if (v3Global.opt.outputSplitBuckets()) {
+                if (funcEmitted(funcp)) bucketFunc(modp, funcp, funcp->name());
+            } else {
+                maybeSplit(modp);
+                mainDoFunc(funcp);
+            }
         }
     }
 }
 
 //######################################################################
 
+void EmitCImp::bucketFunc(AstNodeModule* modp, AstNode* nodep, const string& name) {
+    // The file is chosen by the function's name alone, so changing or
+    // adding other functions doesn't change the files it is emitted into
+    if (m_buckets.empty()) m_buckets.resize(v3Global.opt.outputSplitBuckets());
+    m_buckets[V3Hash(name).hshval() % m_buckets.size()].push_back(std::make_pair(modp, nodep));
+}
+
+void EmitCImp::emitBuckets(AstNodeModule* fileModp) {
+    AstNodeModule* origModp = m_modp;
+    for (size_t bucket = 0; bucket < m_buckets.size(); ++bucket) {
+        if (m_buckets[bucket].empty()) continue;  // No file, rather than an empty one
+        VL_DO_CLEAR(delete m_ofp, m_ofp = NULL);
+        m_ofp = newOutCFile(fileModp, !m_fast, true /*source*/, bucket + 1);
+        emitImpTop(fileModp);
+        for (BucketFuncs::const_iterator it = m_buckets[bucket].begin();
+             it != m_buckets[bucket].end(); ++it) {
+            m_modp = it->first;
+            iterate(it->second);
+        }
+    }
+    m_modp = origModp;
+    m_buckets.clear();
+}
+
 void EmitCImp::maybeSplit(AstNodeModule* fileModp) {
     if (splitNeeded()) {
         // Close old file
@@ -3243,16 +4079,20 @@ void EmitCImp::mainImp(AstNodeModule* modp, bool slow, bool fast) {
         for (const V3GraphVertex* vxp = depGraphp->verticesBeginp(); vxp;
              vxp = vxp->verticesNextp()) {
             const ExecMTask* mtaskp = dynamic_cast<const ExecMTask*>(vxp);
-            if (mtaskp->threadRoot()) {
+            if (mtaskHasFunc(mtaskp) && v3Global.opt.outputSplitBuckets()) {
+                bucketFunc(modp, mtaskp->bodyp(), mtaskp->cFuncName());
+            } else if (mtaskHasFunc(mtaskp)) {
                 maybeSplit(modp);
                 // Only define one function for all the mtasks packed on
                 // a given thread. We'll name this function after the
                 // root mtask though it contains multiple mtasks' worth
-                // of logic.
+                // of logic.  With dynamic scheduling each mtask is its own
+                // function.
                 iterate(mtaskp->bodyp());
             }
         }
     }
+    if (!m_buckets.empty()) emitBuckets(fileModp);
     VL_DO_CLEAR(delete m_ofp, m_ofp = NULL);
 }
 
@@ -3281,6 +4121,7 @@ class EmitCTrace : EmitCStmts {
 
         AstCFile* cfilep = newCFile(filename, m_slow, true /*source*/);
         cfilep->support(true);
+        splitCFilep(cfilep);
 
         if (m_ofp) v3fatalSrc("Previous file not closed");
         if (optSystemC()) {
@@ -3299,6 +4140,14 @@ class EmitCTrace : EmitCStmts {
         // Includes
         puts("#include \"" + v3Global.opt.traceSourceLang() + ".h\"\n");
         puts("#include \"" + symClassName() + ".h\"\n");
+        if (v3Global.opt.symsIndirect()) {
+            // Tracing reads signals from every module
+            for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep;
+                 nodep = VN_CAST(nodep->nextp(), NodeModule)) {
+                if (VN_IS(nodep, Class) || nodep->isTop()) continue;
+                puts("#include \"" + prefixNameProtect(nodep) + ".h\"\n");
+            }
+        }
         puts("\n");
     }
 
@@ -3638,6 +4487,8 @@ class EmitCTrace : EmitCStmts {
             }
 
             splitSizeInc(nodep);
+            EmitCFileMap::add(ofp(), topClassName() + "::" + nodep->nameProtect(), "(trace)",
+                              nodep);
 
             puts("\n");
             puts(nodep->rtnTypeVoid());
@@ -3663,9 +4514,38 @@ class EmitCTrace : EmitCStmts {
                     puts("vluint32_t* oldp = vcdp->oldp(code+" + cvtToStr(m_baseCode) + ");\n");
                     puts("if (false && vcdp && oldp) {}  // Prevent unused\n");
                 }
+                if (nodep->argTypes().find("VerilatedTraceBuffer") == string::npos) {
+                    // Skip the whole function if the runtime filter drops all its codes
+                    uint32_t lo = m_baseCode;
+                    uint32_t hi = m_baseCode;
+                    bool allInc = true;
+                    for (const AstNode* incp = nodep->stmtsp(); incp; incp = incp->nextp()) {
+                        const AstTraceInc* const tincp = VN_CAST_CONST(incp, TraceInc);
+                        if (!tincp) {
+                            allInc = false;
+                            break;
+                        }
+                        lo = std::min(lo, tincp->declp()->code());
+                        hi = std::max(hi, tincp->declp()->code() + tincp->declp()->codeInc());
+                    }
+                    if (allInc) {
+                        puts("if (VL_UNLIKELY(!vcdp->traced(code+" + cvtToStr(lo) + ", code+"
+                             + cvtToStr(hi) + "))) return;\n");
+                    }
+                }
             } else if (nodep->funcType() == AstCFuncType::TRACE_INIT_SUB) {
                 puts("int c = code;\n");
                 puts("if (false && vcdp && c) {}  // Prevent unused\n");
+            } else if (nodep->funcType() == AstCFuncType::TRACE_CHANGE_CHUNK) {
+                // Called by a thread pool worker, see VerilatedTraceChunk
+                puts("VerilatedTraceChunk* const chunkp"
+                     " = static_cast<VerilatedTraceChunk*>(__Vchunkp);\n");
+                puts(EmitCBaseVisitor::symClassVar() + " = static_cast<" + symClassName()
+                     + "*>(chunkp->symsp());\n");
+                puts(EmitCBaseVisitor::symTopAssign() + "\n");
+                puts("VerilatedTraceBuffer* const vcdp = chunkp->bufferp();\n");
+                puts("const uint32_t code = chunkp->code();\n");
+                puts("if (false && vcdp && code) {}  // Prevent unused\n");
             } else {
                 puts("if (false && vcdp) {}  // Prevent unused\n");
             }
@@ -3677,6 +4557,7 @@ class EmitCTrace : EmitCStmts {
             } else if (nodep->funcType() == AstCFuncType::TRACE_FULL_SUB) {
             } else if (nodep->funcType() == AstCFuncType::TRACE_CHANGE) {
             } else if (nodep->funcType() == AstCFuncType::TRACE_CHANGE_SUB) {
+            } else if (nodep->funcType() == AstCFuncType::TRACE_CHANGE_CHUNK) {
             } else {
                 nodep->v3fatalSrc("Bad Case");
             }
@@ -3698,6 +4579,7 @@ class EmitCTrace : EmitCStmts {
                 putsDecoration("// Final\n");
                 iterateAndNextNull(nodep->finalsp());
             }
+            if (nodep->funcType() == AstCFuncType::TRACE_CHANGE_CHUNK) puts("chunkp->done();\n");
             puts("}\n");
         }
         m_funcp = NULL;
@@ -3713,12 +4595,51 @@ class EmitCTrace : EmitCStmts {
             puts("\n");
         }
     }
+    bool emitTraceArrayChanged(AstTraceInc* nodep) {
+        // Emit a test for any change across a whole array to guard the
+        // unrolled per-element changes, or return false if the array's
+        // storage can't be compared directly
+        const bool full = (m_funcp->funcType() == AstCFuncType::TRACE_FULL
+                           || m_funcp->funcType() == AstCFuncType::TRACE_FULL_SUB);
+        // Threaded tracing compares on the trace thread, so can't read oldp here
+        if (full || v3Global.opt.trueTraceThreads()) return false;
+        if (nodep->precondsp() || nodep->dtypep()->basicp()->isDouble()) return false;
+        AstVarRef* varrefp = VN_CAST(nodep->valuep(), VarRef);
+        if (!varrefp || varrefp->varp()->isSc()) return false;
+        // Element storage must be of the traced width, so codes and values line up
+        const int elements = nodep->declp()->arrayRange().elements();
+        const int widthMin = nodep->declp()->widthMin();
+        AstUnpackArrayDType* adtypep
+            = VN_CAST(varrefp->varp()->dtypeSkipRefp(), UnpackArrayDType);
+        if (!adtypep || adtypep->elementsConst() != elements
+            || adtypep->subDTypep()->skipRefp()->width() != widthMin) {
+            return false;
+        }
+        const uint32_t code = nodep->declp()->code();
+        if (widthMin > 16) {
+            puts("if (VL_UNLIKELY(vcdp->changedWords(oldp+" + cvtToStr(code - m_baseCode));
+            puts(",reinterpret_cast<const vluint32_t*>(&");
+            emitTraceValue(nodep, 0);
+            puts("),");
+            puts(cvtToStr(elements * nodep->declp()->widthWords()) + "))) {\n");
+        } else {
+            puts(widthMin > 8 ? "if (VL_UNLIKELY(vcdp->changedSData(oldp+"
+                              : "if (VL_UNLIKELY(vcdp->changedCData(oldp+");
+            puts(cvtToStr(code - m_baseCode) + ",&");
+            emitTraceValue(nodep, 0);
+            puts("," + cvtToStr(elements) + "))) {\n");
+        }
+        return true;
+    }
     virtual void visit(AstTraceInc* nodep) VL_OVERRIDE {
         if (nodep->declp()->arrayRange().ranged()) {
-            // It traces faster if we unroll the loop
+            // Skip the whole array if unchanged, and otherwise trace faster
+            // by unrolling the loop
+            const bool guarded = emitTraceArrayChanged(nodep);
             for (int i = 0; i < nodep->declp()->arrayRange().elements(); i++) {
                 emitTraceChangeOne(nodep, i);
             }
+            if (guarded) puts("}\n");
         } else {
             emitTraceChangeOne(nodep, -1);
         }
@@ -3754,13 +4675,15 @@ public:
 
 void V3EmitC::emitc() {
     UINFO(2, __FUNCTION__ << ": " << endl);
+    AstUser4InUse inuser4;  // Hot variables, see EmitCHotVisitor
+    if (v3Global.opt.hotColdVars()) { EmitCHotVisitor visitor(v3Global.rootp()); }
     // Process each module in turn
     for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep;
          nodep = VN_CAST(nodep->nextp(), NodeModule)) {
         if (VN_IS(nodep, Class)) continue;  // Imped with ClassPackage
         // clang-format off
         { EmitCImp cint; cint.mainInt(nodep); }
-        if (v3Global.opt.outputSplit()) {
+        if (v3Global.opt.outputSplit() || v3Global.opt.outputSplitBuckets()) {
             { EmitCImp fast; fast.mainImp(nodep, false, true); }
             { EmitCImp slow; slow.mainImp(nodep, true, false); }
         } else {
@@ -3768,6 +4691,7 @@ void V3EmitC::emitc() {
         }
         // clang-format on
     }
+    if (!v3Global.opt.lintOnly()) EmitCFileMap::write();
 }
 
 void V3EmitC::emitcTrace() {
@@ -3780,6 +4704,17 @@ void V3EmitC::emitcTrace() {
     }
 }
 
+void V3EmitC::emitcFuncMap() {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    const string filename
+        = v3Global.opt.makeDir() + "/" + v3Global.opt.prefix() + "__cfuncs.map";
+    const vl_unique_ptr<std::ofstream> ofp(V3File::new_ofstream(filename));
+    if (ofp->fail()) v3fatal("Can't write " << filename);
+    *ofp << "# Verilator generated function map, see verilator_profsample" << endl;
+    *ofp << "# C++ function\tVerilog module\tSource file:line of each block" << endl;
+    EmitCFuncMapVisitor visitor(v3Global.rootp(), ofp.get());
+}
+
 void V3EmitC::emitcFiles() {
     UINFO(2, __FUNCTION__ << ": " << endl);
     for (AstNodeFile* filep = v3Global.rootp()->filesp(); filep;
@@ -32,6 +32,7 @@ public:
     static void emitcSyms(bool dpiHdrOnly = false);
     static void emitcTrace();
     static void emitcFiles();
+    static void emitcFuncMap();
 };
 
 #endif  // Guard
@@ -53,9 +53,9 @@ public:
     }
     static string ifNoProtect(const string& in) { return v3Global.opt.protectIds() ? "" : in; }
     static string symClassName() { return v3Global.opt.prefix() + "_" + protect("_Syms"); }
-    static string symClassVar() { return symClassName() + "* __restrict vlSymsp"; }
+    static string symClassVar() { return symClassName() + "* VL_RESTRICT vlSymsp"; }
     static string symTopAssign() {
-        return v3Global.opt.prefix() + "* __restrict vlTOPp VL_ATTR_UNUSED = vlSymsp->TOPp;";
+        return v3Global.opt.prefix() + "* VL_RESTRICT vlTOPp VL_ATTR_UNUSED = vlSymsp->TOPp;";
     }
     static string funcNameProtect(const AstCFunc* nodep, const AstNodeModule* modp) {
         if (nodep->isConstructor()) {
@@ -77,6 +77,13 @@ public:
     static string topClassName() {  // Return name of top wrapper module
         return v3Global.opt.prefix();
     }
+    static bool coverPerThread() {  // Coverage counters are per thread, see --coverage-per-thread
+        return v3Global.opt.threads() && v3Global.opt.coveragePerThread();
+    }
+    static string coverCountType() {  // Type of a coverage counter
+        return (v3Global.opt.threads() && !coverPerThread()) ? "std::atomic<uint32_t>"
+                                                            : "uint32_t";
+    }
     static AstCFile* newCFile(const string& filename, bool slow, bool source) {
         AstCFile* cfilep = new AstCFile(v3Global.rootp()->fileline(), filename);
         cfilep->slow(slow);
@@ -63,6 +63,10 @@ class EmitCInlines : EmitCBaseVisitor {
         v3Global.needHeavy(true);
         iterateChildren(nodep);
     }
+    virtual void visit(AstVar* nodep) VL_OVERRIDE {
+        if (nodep->attrSparse()) v3Global.needHeavy(true);
+        iterateChildren(nodep);
+    }
     virtual void visit(AstValuePlusArgs* nodep) VL_OVERRIDE {
         v3Global.needHeavy(true);
         iterateChildren(nodep);
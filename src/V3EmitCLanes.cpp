@@ -0,0 +1,197 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Emit C++ wrapper of model lanes
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+// V3EmitCLanes's Transformations:
+//
+// Create {prefix}__Lanes.h, a class holding --lanes copies of the model
+//      Each top port becomes an array indexed by lane
+//      eval() copies each lane's inputs in, evaluates it, and copies outputs out
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3Global.h"
+#include "V3EmitC.h"
+#include "V3EmitCBase.h"
+#include "V3EmitCLanes.h"
+
+#include <vector>
+
+//######################################################################
+
+class EmitCLanes : EmitCBaseVisitor {
+    // STATE
+    std::vector<AstVar*> m_ports;  // Top ports, in declaration order
+
+    // METHODS
+    void emitDeclArrayBrackets(const AstVar* nodep) {
+        for (const AstUnpackArrayDType* arrayp
+             = VN_CAST_CONST(nodep->dtypeSkipRefp(), UnpackArrayDType);
+             arrayp; arrayp = VN_CAST_CONST(arrayp->subDTypep()->skipRefp(), UnpackArrayDType)) {
+            puts("[" + cvtToStr(arrayp->elementsConst()) + "]");
+        }
+    }
+    void emitPortDecl(AstVar* varp) {
+        AstBasicDType* basicp = varp->basicp();
+        if (!basicp || basicp->isOpaque()) {
+            varp->v3error("Unsupported: --lanes with port of this data type: "
+                          << varp->prettyNameQ());
+            return;
+        }
+        if (varp->isInoutish()) {
+            puts("VL_INOUT");
+        } else if (varp->isWritable()) {
+            puts("VL_OUT");
+        } else {
+            puts("VL_IN");
+        }
+        if (varp->isQuad()) {
+            puts("64");
+        } else if (varp->widthMin() <= 8) {
+            puts("8");
+        } else if (varp->widthMin() <= 16) {
+            puts("16");
+        } else if (varp->isWide()) {
+            puts("W");
+        }
+        puts("(" + varp->nameProtect() + "[LANES]");
+        emitDeclArrayBrackets(varp);
+        puts("," + cvtToStr(basicp->lsb() + varp->width() - 1) + "," + cvtToStr(basicp->lsb()));
+        if (varp->isWide()) puts("," + cvtToStr(varp->widthWords()));
+        puts(");\n");
+    }
+    void emitCopies(bool toModel, bool allPorts) {
+        // Copy the ports the model reads (toModel) or writes, between lane arrays and model
+        for (std::vector<AstVar*>::iterator it = m_ports.begin(); it != m_ports.end(); ++it) {
+            AstVar* varp = *it;
+            bool in = varp->isInoutish() || !varp->isWritable();
+            bool out = varp->isInoutish() || varp->isWritable();
+            if (!allPorts && (toModel ? !in : !out)) continue;
+            string lanep = varp->nameProtect() + "[lane]";
+            string modelp = "modelp->" + varp->nameProtect();
+            string sizep = "sizeof(" + lanep + ")";
+            if (toModel) {
+                puts("std::memcpy(&" + modelp + ", &" + lanep + ", " + sizep + ");\n");
+            } else {
+                puts("std::memcpy(&" + lanep + ", &" + modelp + ", " + sizep + ");\n");
+            }
+        }
+    }
+
+    // VISITORS
+    virtual void visit(AstVar* nodep) VL_OVERRIDE {
+        if (nodep->isIO()) m_ports.push_back(nodep);
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE {}
+
+public:
+    // CONSTRUCTORS
+    explicit EmitCLanes(AstNetlist* nodep) {
+        iterateChildren(nodep->topModulep());
+        emitInt();
+    }
+
+private:
+    // MAIN METHOD
+    void emitInt() {
+        string filename = v3Global.opt.makeDir() + "/" + topClassName() + "__Lanes.h";
+        newCFile(filename, false /*slow*/, false /*source*/);
+        V3OutCFile hf(filename);
+        m_ofp = &hf;
+        string classname = topClassName() + "__Lanes";
+
+        ofp()->putsHeader();
+        puts("// DESCRIPTION: Verilator output: Wrapper of independent model lanes,"
+             " created with --lanes\n");
+        ofp()->putsGuard();
+        puts("\n");
+
+        puts("#include \"verilated.h\"\n");
+        puts("#include \"" + topClassName() + ".h\"\n");
+        puts("#include <string>\n");
+
+        puts("\n//======================\n\n");
+
+        puts("class " + classname + " {\n");
+        ofp()->resetPrivate();
+        ofp()->putsPrivate(false);  // public:
+        puts("// Number of independent copies of the model\n");
+        puts("enum { LANES = " + cvtToStr(v3Global.opt.lanes()) + " };\n");
+
+        puts("\n// PORTS\n");
+        puts("// The application code writes and reads these signals, each an array\n");
+        puts("// indexed by lane, so stimulus for all lanes is laid out together.\n");
+        for (std::vector<AstVar*>::iterator it = m_ports.begin(); it != m_ports.end(); ++it) {
+            emitPortDecl(*it);
+        }
+
+        puts("\n// INTERNAL VARIABLES\n");
+        ofp()->putsPrivate(true);  // private:
+        puts(topClassName() + "* m_lanesp[LANES];  ///< Model of each lane\n");
+
+        puts("\n// CONSTRUCTORS\n");
+        puts("VL_UNCOPYABLE(" + classname + ");  ///< Copying not allowed\n");
+        ofp()->putsPrivate(false);  // public:
+        puts("/// Construct the models, named {name}_lane{number}; called by application code\n");
+        puts("explicit " + classname + "(const char* name = \"TOP\") {\n");
+        puts("for (int lane = 0; lane < LANES; ++lane) {\n");
+        puts("char suffix[20];\n");
+        puts("VL_SNPRINTF(suffix, sizeof(suffix), \"_lane%d\", lane);\n");
+        puts("m_lanesp[lane] = new " + topClassName()
+             + "((std::string(name) + suffix).c_str());\n");
+        puts(topClassName() + "* modelp = m_lanesp[lane];\n");
+        puts("// Start with each model's initial port values\n");
+        emitCopies(false, true);
+        puts("}\n");
+        puts("}\n");
+        puts("/// Destroy the models; called (often implicitly) by application code\n");
+        puts("~" + classname + "() {\n");
+        puts("for (int lane = 0; lane < LANES; ++lane) {\n");
+        puts("VL_DO_CLEAR(delete m_lanesp[lane], m_lanesp[lane] = NULL);\n");
+        puts("}\n");
+        puts("}\n");
+
+        puts("\n// API METHODS\n");
+        puts("/// Return the model of a lane\n");
+        puts(topClassName() + "* lanep(int lane) const { return m_lanesp[lane]; }\n");
+        puts("/// Evaluate every lane; called by application code each time inputs change\n");
+        puts("void eval() {\n");
+        puts("for (int lane = 0; lane < LANES; ++lane) {\n");
+        puts(topClassName() + "* modelp = m_lanesp[lane];\n");
+        emitCopies(true, false);
+        puts("modelp->eval();\n");
+        emitCopies(false, false);
+        puts("}\n");
+        puts("}\n");
+        puts("/// Simulation complete, run final blocks of every lane\n");
+        puts("void final() {\n");
+        puts("for (int lane = 0; lane < LANES; ++lane) m_lanesp[lane]->final();\n");
+        puts("}\n");
+        puts("};\n");
+
+        puts("\n//======================\n\n");
+        ofp()->putsEndGuard();
+    }
+};
+
+//######################################################################
+// EmitCLanes class functions
+
+void V3EmitCLanes::emit() {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    EmitCLanes(v3Global.rootp());
+}
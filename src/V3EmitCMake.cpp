@@ -110,6 +110,8 @@ class CMakeEmitter {
         cmake_set_raw(*of, name + "_SC", v3Global.opt.systemC() ? "1" : "0");
         *of << "# Coverage output mode?  0/1 (from --coverage)\n";
         cmake_set_raw(*of, name + "_COVERAGE", v3Global.opt.coverage() ? "1" : "0");
+        *of << "# Precompiled headers?  0/1 (from --pch)\n";
+        cmake_set_raw(*of, name + "_PCH", v3Global.opt.pch() ? "1" : "0");
         *of << "# Threaded output mode?  0/1/N threads (from --threads)\n";
         cmake_set_raw(*of, name + "_THREADS", cvtToStr(v3Global.opt.threads()));
         *of << "# VCD Tracing output mode?  0/1 (from --trace)\n";
@@ -158,6 +160,12 @@ class CMakeEmitter {
         if (v3Global.opt.coverage()) {
             global.push_back("${VERILATOR_ROOT}/include/verilated_cov.cpp");
         }
+        if (v3Global.opt.profLive()) {
+            global.push_back("${VERILATOR_ROOT}/include/verilated_live.cpp");
+        }
+        if (v3Global.opt.cosim()) {
+            global.push_back("${VERILATOR_ROOT}/include/verilated_cosim.cpp");
+        }
         if (v3Global.opt.trace()) {
             global.push_back("${VERILATOR_ROOT}/include/" + v3Global.opt.traceSourceBase()
                              + "_c.cpp");
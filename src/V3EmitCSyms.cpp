@@ -21,6 +21,8 @@
 #include "V3EmitC.h"
 #include "V3EmitCBase.h"
 #include "V3LanguageWords.h"
+#include "V3PartitionGraph.h"
+#include "V3VpiChange.h"
 
 #include <algorithm>
 #include <cmath>
@@ -102,6 +104,8 @@ class EmitCSyms : EmitCBaseVisitor {
     std::vector<ScopeModPair> m_scopes;  // Every scope by module
     std::vector<AstCFunc*> m_dpis;  // DPI functions
     std::vector<ModVarPair> m_modVars;  // Each public {mod,var}
+    typedef std::map<std::pair<AstNodeModule*, string>, AstVar*> VpiChangeFlags;
+    VpiChangeFlags m_vpiChangeFlags;  // Each {mod,name} to --vpi-change-hooks flag
     ScopeNames m_scopeNames;  // Each unique AstScopeName
     ScopeFuncs m_scopeFuncs;  // Each {scope,dpi-export-func}
     ScopeVars m_scopeVars;  // Each {scope,public-var}
@@ -123,6 +127,17 @@ class EmitCSyms : EmitCBaseVisitor {
     void emitSymImp();
     void emitDpiHdr();
     void emitDpiImp();
+    void emitPchHdr();
+    static string symCellsClassName() {
+        return v3Global.opt.prefix() + "_" + protect("_SymsCells");
+    }
+    void emitModIncludes() {
+        for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep;
+             nodep = VN_CAST(nodep->nextp(), NodeModule)) {
+            if (VN_IS(nodep, Class)) continue;  // Class included earlier
+            puts("#include \"" + prefixNameProtect(nodep) + ".h\"\n");
+        }
+    }
 
     void nameCheck(AstNode* nodep) {
         // Prevent GCC compile time error; name check all things that reach C++ code
@@ -216,6 +231,9 @@ class EmitCSyms : EmitCBaseVisitor {
                     }
                     // UINFO(9,"For "<<scopep->name()<<" - "<<varp->name()<<"  Scp "<<scpName<<"
                     // Var "<<varBase<<endl);
+                    if (varp->isSigObserve()) {  // C code sees the snapshot as the signal
+                        varBase.erase(varBase.size() - AstVar::observeSuffix().size());
+                    }
                     string varBasePretty = AstNode::prettyName(varBase);
                     string scpPretty = AstNode::prettyName(scpName);
                     string scpSym = scopeSymString(scpName);
@@ -277,6 +295,7 @@ class EmitCSyms : EmitCBaseVisitor {
             emitDpiHdr();
             if (!m_dpiHdrOnly) emitDpiImp();
         }
+        if (!m_dpiHdrOnly && v3Global.opt.pch()) emitPchHdr();
     }
     virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
         nameCheck(nodep);
@@ -342,6 +361,10 @@ class EmitCSyms : EmitCBaseVisitor {
             && !nodep->isParam()) {
             m_modVars.push_back(make_pair(m_modp, nodep));
         }
+        const string flagPrefix = V3VpiChange::flagPrefix();
+        if (nodep->name().compare(0, flagPrefix.size(), flagPrefix) == 0) {
+            m_vpiChangeFlags.insert(make_pair(make_pair(m_modp, nodep->name()), nodep));
+        }
     }
     virtual void visit(AstCoverDecl* nodep) VL_OVERRIDE {
         // Assign numbers to all bins, so we know how big of an array to use
@@ -402,11 +425,20 @@ void EmitCSyms::emitSymHdr() {
         puts("#include \"verilated.h\"\n");
     }
 
-    puts("\n// INCLUDE MODULE CLASSES\n");
-    for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep;
-         nodep = VN_CAST(nodep->nextp(), NodeModule)) {
-        if (VN_IS(nodep, Class)) continue;  // Class included earlier
-        puts("#include \"" + prefixNameProtect(nodep) + ".h\"\n");
+    if (v3Global.opt.symsIndirect()) {
+        // Submodules are held by reference, so only the top need be complete
+        puts("\n// INCLUDE TOP CLASS\n");
+        puts("#include \"" + topClassName() + ".h\"\n");
+        puts("\n// FORWARD MODULE CLASSES\n");
+        for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep;
+             nodep = VN_CAST(nodep->nextp(), NodeModule)) {
+            if (VN_IS(nodep, Class) || nodep->isTop()) continue;
+            puts("class " + prefixNameProtect(nodep) + ";\n");
+        }
+        puts("struct " + symCellsClassName() + ";\n");
+    } else {
+        puts("\n// INCLUDE MODULE CLASSES\n");
+        emitModIncludes();
     }
 
     if (v3Global.dpi()) {
@@ -444,6 +476,27 @@ void EmitCSyms::emitSymHdr() {
         puts("bool __Vm_activity;  ///< Used by trace routines to determine change occurred\n");
     }
     puts("bool __Vm_didInit;\n");
+    if (v3Global.opt.symsIndirect()) {
+        puts(symCellsClassName() + "* __Vm_cellsp;  ///< Storage for the submodules below\n");
+    }
+    if (v3Global.profBranches()) {
+        puts("vluint64_t __Vm_profBranches[" + cvtToStr(v3Global.profBranches())
+             + "][2];  ///< --prof-branches taken/not taken counts\n");
+    }
+    if (!v3Global.profBlocks().empty()) {
+        puts("vluint64_t __Vm_profBlocks[" + cvtToStr(v3Global.profBlocks().size())
+             + "][2];  ///< --prof-blocks cycles and calls\n");
+    }
+    if (v3Global.opt.profEval()) {
+        puts("VerilatedEvalStats __Vm_evalStats;  ///< --prof-eval counters\n");
+        if (!v3Global.profEvalDomains().empty()) {
+            puts("vluint64_t __Vm_evalDomains[" + cvtToStr(v3Global.profEvalDomains().size())
+                 + "];  ///< --prof-eval triggers of each domain\n");
+        }
+    }
+    if (v3Global.opt.mtasks() && v3Global.opt.profThreads()) {
+        puts("static const char* const __Vm_profMTaskInfop;  ///< --prof-threads mtask modules\n");
+    }
 
     puts("\n// SUBCELL STATE\n");
     for (std::vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
@@ -454,17 +507,26 @@ void EmitCSyms::emitSymHdr() {
             ofp()->printf("%-30s ", (prefixNameProtect(modp) + "*").c_str());
             puts(protectIf(scopep->nameDotless() + "p", scopep->protect()) + ";\n");
         } else {
-            ofp()->printf("%-30s ", (prefixNameProtect(modp) + "").c_str());
+            string type = prefixNameProtect(modp) + (v3Global.opt.symsIndirect() ? "&" : "");
+            ofp()->printf("%-30s ", type.c_str());
             puts(protectIf(scopep->nameDotless(), scopep->protect()) + ";\n");
         }
     }
 
     if (m_coverBins) {
         puts("\n// COVERAGE\n");
-        puts(v3Global.opt.threads() ? "std::atomic<uint32_t>" : "uint32_t");
+        puts(coverCountType());
         puts(" __Vcoverage[");
-        puts(cvtToStr(m_coverBins));
-        puts("];\n");
+        if (coverPerThread()) {
+            // A block per thread, each in its own cache lines
+            const int perLine = VL_CACHE_LINE_BYTES / sizeof(uint32_t);
+            puts(cvtToStr(std::max(v3Global.opt.threads(), 1)) + "][");
+            puts(cvtToStr((m_coverBins + perLine - 1) / perLine * perLine));
+            puts("] VL_ATTR_ALIGNED(VL_CACHE_LINE_BYTES);\n");
+        } else {
+            puts(cvtToStr(m_coverBins));
+            puts("];\n");
+        }
     }
 
     if (!m_scopeNames.empty()) {  // Scope names
@@ -481,7 +543,17 @@ void EmitCSyms::emitSymHdr() {
 
     puts("\n// CREATORS\n");
     puts(symClassName() + "(" + topClassName() + "* topp, const char* namep);\n");
-    puts(string("~") + symClassName() + "() {}\n");
+    if (v3Global.opt.symsIndirect() || !v3Global.profBlocks().empty()
+        || v3Global.opt.profEval() || v3Global.opt.profLive()) {
+        puts(string("~") + symClassName() + "();\n");
+    } else if (v3Global.profBranches()) {
+        puts(string("~") + symClassName() + "() {\n");
+        puts("Verilated::profBranchesDump(&__Vm_profBranches[0][0], "
+             + cvtToStr(v3Global.profBranches()) + ");\n");
+        puts("}\n");
+    } else {
+        puts(string("~") + symClassName() + "() {}\n");
+    }
 
     for (std::map<int, bool>::iterator it = m_usesVfinal.begin(); it != m_usesVfinal.end(); ++it) {
         puts("void " + symClassName() + "_" + cvtToStr(it->first) + "(");
@@ -499,10 +571,17 @@ void EmitCSyms::emitSymHdr() {
         puts("inline bool getClearActivity() { bool r=__Vm_activity; "
              "__Vm_activity=false; return r; }\n");
     }
+    if (v3Global.dpi() && !m_scopeVars.empty()) {
+        puts("void " + protect("__Vvars") + "();\n");
+        puts("static void " + protect("__VvarsCb") + "(VerilatedSyms* symsp) {\n");
+        puts("static_cast<" + symClassName() + "*>(symsp)->" + protect("__Vvars") + "();\n");
+        puts("}\n");
+    }
     if (v3Global.opt.savable()) {
         puts("void " + protect("__Vserialize") + "(VerilatedSerialize& os);\n");
         puts("void " + protect("__Vdeserialize") + "(VerilatedDeserialize& os);\n");
     }
+    puts("void " + protect("__Vmemory") + "(VerilatedMemoryUsage& usage) const;\n");
     puts("\n");
     puts("} VL_ATTR_ALIGNED(VL_CACHE_LINE_BYTES);\n");
 
@@ -563,11 +642,7 @@ void EmitCSyms::emitSymImpPreamble() {
 
     // Includes
     puts("#include \"" + symClassName() + ".h\"\n");
-    for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep;
-         nodep = VN_CAST(nodep->nextp(), NodeModule)) {
-        if (VN_IS(nodep, Class)) continue;  // Class included earlier
-        puts("#include \"" + prefixNameProtect(nodep) + ".h\"\n");
-    }
+    emitModIncludes();
 }
 
 void EmitCSyms::emitSymImp() {
@@ -589,28 +664,89 @@ void EmitCSyms::emitSymImp() {
 
     puts("\n");
 
+    if (v3Global.opt.mtasks() && v3Global.opt.profThreads()) {
+        // Modules of each mtask, for verilator_gantt to report with the profile
+        puts("const char* const " + symClassName() + "::__Vm_profMTaskInfop = \"\"");
+        const V3Graph* depGraphp = v3Global.rootp()->execGraphp()->depGraphp();
+        for (const V3GraphVertex* vxp = depGraphp->verticesBeginp(); vxp;
+             vxp = vxp->verticesNextp()) {
+            const ExecMTask* mtaskp = dynamic_cast<const ExecMTask*>(vxp);
+            string line = "VLPROF mtask_modules " + cvtToStr(mtaskp->id());
+            for (std::set<string>::const_iterator it = mtaskp->modules().begin();
+                 it != mtaskp->modules().end(); ++it) {
+                line += " " + protect(*it);
+            }
+            puts("\n");
+            putsQuoted(line + "\n");
+        }
+        puts(";\n");
+    }
+
+    // Memory of every scope, the rest of the symbol table and padding being OTHER
+    puts("\nvoid " + symClassName() + "::" + protect("__Vmemory")
+         + "(VerilatedMemoryUsage& usage) const {\n");
+    puts("VerilatedMemoryUsage model;\n");
+    for (std::vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
+        AstScope* scopep = it->first;
+        AstNodeModule* modp = it->second;
+        if (VN_IS(modp, Class)) continue;
+        puts(modp->isTop() ? string("TOPp->")
+                           : (protectIf(scopep->nameDotless(), scopep->protect()) + "."));
+        puts(protect("__Vmemory") + "(model);\n");
+    }
+    if (m_coverBins) puts("model.add(VerilatedMemoryUsage::COVERAGE, sizeof(__Vcoverage));\n");
+    puts("const size_t bytes = sizeof(*this) + sizeof(*TOPp)");
+    if (v3Global.opt.symsIndirect()) puts(" + sizeof(*__Vm_cellsp)");
+    puts(";\n");
+    puts("if (bytes > model.total()) {\n");
+    puts("model.add(VerilatedMemoryUsage::OTHER, bytes - model.total());\n");
+    puts("}\n");
+    puts("usage.add(model);\n");
+    puts("}\n");
+
     if (v3Global.opt.savable()) {
         puts("\n");
         for (int de = 0; de < 2; ++de) {
             string classname = de ? "VerilatedDeserialize" : "VerilatedSerialize";
             string funcname = de ? "__Vdeserialize" : "__Vserialize";
-            string op = de ? ">>" : "<<";
             // NOLINTNEXTLINE(performance-inefficient-string-concatenation)
             puts("void " + symClassName() + "::" + protect(funcname) + "(" + classname
                  + "& os) {\n");
-            puts("// LOCAL STATE\n");
-            // __Vm_namep presumably already correct
-            if (v3Global.opt.trace()) { puts("os" + op + "__Vm_activity;\n"); }
-            puts("os" + op + "__Vm_didInit;\n");
-            puts("// SUBCELL STATE\n");
-            for (std::vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end();
-                 ++it) {
-                AstScope* scopep = it->first;
-                AstNodeModule* modp = it->second;
-                if (!modp->isTop()) {
-                    puts(protectIf(scopep->nameDotless(), scopep->protect()) + "."
-                         + protect(funcname) + "(os);\n");
+            // A section per scope, named by the scope so a restore can
+            // match sections to a model with different scopes.
+            // __Vm_namep presumably already correct, the local state
+            // is saved in the top module's section
+            puts("os.scopesBegin();\n");
+            if (de) {
+                puts("while (const char* namep = os.sectionNext()) {\n");
+                for (std::vector<ScopeModPair>::iterator it = m_scopes.begin();
+                     it != m_scopes.end(); ++it) {
+                    AstScope* scopep = it->first;
+                    AstNodeModule* modp = it->second;
+                    puts("if (0 == strcmp(namep, ");
+                    putsQuoted(protectWordsIf(scopep->prettyName(), scopep->protect()));
+                    puts(")) { ");
+                    puts(modp->isTop()
+                             ? string("TOPp->")
+                             : (protectIf(scopep->nameDotless(), scopep->protect()) + "."));
+                    puts(protect("__VdeserializeScope") + "(os); continue; }\n");
+                }
+                puts("os.sectionSkip();\n");
+                puts("}\n");
+                puts("os.scopesEnd(" + cvtToStr(m_scopes.size()) + ");\n");
+            } else {
+                for (std::vector<ScopeModPair>::iterator it = m_scopes.begin();
+                     it != m_scopes.end(); ++it) {
+                    AstScope* scopep = it->first;
+                    AstNodeModule* modp = it->second;
+                    puts(modp->isTop()
+                             ? string("TOPp->")
+                             : (protectIf(scopep->nameDotless(), scopep->protect()) + "."));
+                    puts(protect("__VserializeScope") + "(os, ");
+                    putsQuoted(protectWordsIf(scopep->prettyName(), scopep->protect()));
+                    puts(");\n");
                 }
+                puts("os.scopesEnd();\n");
             }
             puts("}\n");
         }
@@ -618,6 +754,77 @@ void EmitCSyms::emitSymImp() {
 
     puts("\n");
 
+    if (v3Global.opt.symsIndirect()) {
+        puts("\n// SUBCELL STORAGE\n");
+        puts("struct " + symCellsClassName() + " {\n");
+        bool anyCells = false;
+        for (std::vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end();
+             ++it) {
+            AstScope* scopep = it->first;
+            AstNodeModule* modp = it->second;
+            if (VN_IS(modp, Class) || modp->isTop()) continue;
+            ofp()->printf("%-30s ", prefixNameProtect(modp).c_str());
+            puts(protectIf(scopep->nameDotless(), scopep->protect()) + ";\n");
+            anyCells = true;
+        }
+        puts(symCellsClassName() + "(" + topClassName() + "*" + (anyCells ? " topp" : "")
+             + ")\n");
+        char comma = ':';
+        for (std::vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end();
+             ++it) {
+            AstScope* scopep = it->first;
+            AstNodeModule* modp = it->second;
+            if (VN_IS(modp, Class) || modp->isTop()) continue;
+            puts(string("    ") + comma + " ");
+            puts(protectIf(scopep->nameDotless(), scopep->protect()));
+            puts("(Verilated::catName(topp->name(), ");
+            // The "." is added by catName
+            putsQuoted(protectWordsIf(scopep->prettyName(), scopep->protect()));
+            puts("))\n");
+            comma = ',';
+        }
+        puts("{}\n");
+        puts("};\n");
+    }
+
+    if (!v3Global.profBlocks().empty()) {
+        puts("\n// Source of each --prof-blocks counter\n");
+        puts("static const char* const __Vm_profBlockNames[] = {\n");
+        const std::vector<string>& blocks = v3Global.profBlocks();
+        for (std::vector<string>::const_iterator it = blocks.begin(); it != blocks.end(); ++it) {
+            putsQuoted(*it);
+            puts(",\n");
+        }
+        puts("};\n");
+    }
+    if (!v3Global.profEvalDomains().empty()) {
+        puts("\n// Sensitivity of each --prof-eval domain counter\n");
+        puts("static const char* const __Vm_evalDomainNames[] = {\n");
+        const std::vector<string>& domains = v3Global.profEvalDomains();
+        for (std::vector<string>::const_iterator it = domains.begin(); it != domains.end();
+             ++it) {
+            putsQuoted(*it);
+            puts(",\n");
+        }
+        puts("};\n");
+    }
+    if (v3Global.opt.symsIndirect() || !v3Global.profBlocks().empty()
+        || v3Global.opt.profEval() || v3Global.opt.profLive()) {
+        puts("\n" + symClassName() + "::~" + symClassName() + "() {\n");
+        if (v3Global.profBranches()) {
+            puts("Verilated::profBranchesDump(&__Vm_profBranches[0][0], "
+                 + cvtToStr(v3Global.profBranches()) + ");\n");
+        }
+        if (!v3Global.profBlocks().empty()) {
+            puts("Verilated::profBlocksDump(&__Vm_profBlocks[0][0], __Vm_profBlockNames, "
+                 + cvtToStr(v3Global.profBlocks().size()) + ");\n");
+        }
+        if (v3Global.opt.profEval()) puts("Verilated::profEvalDump(&__Vm_evalStats);\n");
+        if (v3Global.opt.profLive()) puts("VerilatedLive::close();\n");
+        if (v3Global.opt.symsIndirect()) puts("delete __Vm_cellsp;\n");
+        puts("}\n");
+    }
+
     puts("\n// FUNCTIONS\n");
     puts(symClassName() + "::" + symClassName() + "(" + topClassName()
          + "* topp, const char* namep)\n");
@@ -629,12 +836,20 @@ void EmitCSyms::emitSymImp() {
     }
     if (v3Global.opt.trace()) puts("    , __Vm_activity(false)\n");
     puts("    , __Vm_didInit(false)\n");
+    if (v3Global.opt.symsIndirect()) {
+        puts("    , __Vm_cellsp(new " + symCellsClassName() + "(topp))\n");
+    }
     puts("    // Setup submodule names\n");
     char comma = ',';
     for (std::vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
         AstScope* scopep = it->first;
         AstNodeModule* modp = it->second;
         if (modp->isTop()) {
+        } else if (v3Global.opt.symsIndirect()) {
+            if (VN_IS(modp, Class)) continue;
+            string name = protectIf(scopep->nameDotless(), scopep->protect());
+            puts(string("    ") + comma + " " + name + "(__Vm_cellsp->" + name + ")\n");
+            ++m_numStmts;
         } else {
             puts(string("    ") + comma + " " + protect(scopep->nameDotless()));
             puts("(Verilated::catName(topp->name(), ");
@@ -649,6 +864,27 @@ void EmitCSyms::emitSymImp() {
 
     puts("// Pointer to top level\n");
     puts("TOPp = topp;\n");
+    if (v3Global.profBranches()) {
+        puts("memset(__Vm_profBranches, 0, sizeof(__Vm_profBranches));\n");
+    }
+    if (!v3Global.profBlocks().empty()) {
+        puts("memset(__Vm_profBlocks, 0, sizeof(__Vm_profBlocks));\n");
+    }
+    if (v3Global.opt.profEval()) {
+        if (!v3Global.profEvalDomains().empty()) {
+            puts("__Vm_evalStats.m_domains = " + cvtToStr(v3Global.profEvalDomains().size())
+                 + ";\n");
+            puts("__Vm_evalStats.m_domainNamesp = __Vm_evalDomainNames;\n");
+            puts("__Vm_evalStats.m_domainTriggersp = __Vm_evalDomains;\n");
+            puts("__Vm_evalStats.clear();\n");
+        }
+        puts("Verilated::evalStatsp(&__Vm_evalStats);\n");
+    }
+    if (v3Global.opt.profLive()) {
+        // The thread calling eval is not one of the pool's workers
+        const int workers = std::max(0, v3Global.opt.threads() - 1);
+        puts("VerilatedLive::open(namep, " + cvtToStr(workers) + ");\n");
+    }
     puts("// Setup each module's pointers to their submodules\n");
     for (std::vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
         AstScope* scopep = it->first;
@@ -749,6 +985,21 @@ void EmitCSyms::emitSymImp() {
                 ++m_numStmts;
             }
         }
+        m_ofpBase->puts("}\n");
+        if (!m_scopeVars.empty()) {
+            m_ofpBase->puts("// Insert public variables at the first variable lookup\n");
+            m_ofpBase->puts("VerilatedScope::varsDefer(this, &" + protect("__VvarsCb")
+                            + ");\n");
+        }
+    }
+    m_ofpBase->puts("}\n");
+
+    if (v3Global.dpi() && !m_scopeVars.empty()) {
+        // Variable inserts go into their own function, called on the first lookup
+        // rather than at construction, so start a new split file if needed
+        closeSplit();
+        m_ofpBase->puts("\nvoid " + symClassName() + "::" + protect("__Vvars") + "() {\n");
+        m_ofpBase->puts("const int __Vfinal VL_ATTR_UNUSED = 1;\n");
         // It would be less code if each module inserted its own variables.
         // Someday.  For now public isn't common.
         for (ScopeVars::iterator it = m_scopeVars.begin(); it != m_scopeVars.end(); ++it) {
@@ -803,6 +1054,7 @@ void EmitCSyms::emitSymImp() {
                 puts(".");
             }
             puts(varp->nameProtect());
+            if (varp->attrSparse()) puts("[0]");  // Rows are not stored in the object
             puts("), ");
             puts(varp->vlEnumType());  // VLVT_UINT32 etc
             puts(",");
@@ -812,11 +1064,26 @@ void EmitCSyms::emitSymImp() {
             puts(bounds);
             puts(");\n");
             ++m_numStmts;
+            VpiChangeFlags::const_iterator flagIt
+                = m_vpiChangeFlags.find(make_pair(modp, V3VpiChange::flagPrefix() + varp->name()));
+            if (flagIt != m_vpiChangeFlags.end()) {
+                puts(protect("__Vscope_" + it->second.m_scopeName) + ".varChangeFlag(__Vfinal,");
+                putsQuoted(protect(it->second.m_varBasePretty));
+                puts(", &(");
+                if (modp->isTop()) {
+                    puts(protectIf(scopep->nameDotless() + "p", scopep->protect()));
+                    puts("->");
+                } else {
+                    puts(protectIf(scopep->nameDotless(), scopep->protect()));
+                    puts(".");
+                }
+                puts(flagIt->second->nameProtect());
+                puts("));\n");
+            }
         }
+        closeSplit();
         m_ofpBase->puts("}\n");
     }
-
-    m_ofpBase->puts("}\n");
     closeSplit();
     VL_DO_CLEAR(delete m_ofp, m_ofp = NULL);
 }
@@ -871,6 +1138,31 @@ void EmitCSyms::emitDpiHdr() {
 
 //######################################################################
 
+void EmitCSyms::emitPchHdr() {
+    UINFO(6, __FUNCTION__ << ": " << endl);
+    string filename = v3Global.opt.makeDir() + "/" + topClassName() + "__pch.h";
+    AstCFile* cfilep = newCFile(filename, false /*slow*/, false /*source*/);
+    cfilep->support(true);
+    V3OutCFile hf(filename);
+    m_ofp = &hf;
+
+    m_ofp->putsHeader();
+    puts("// DESCR"
+         "IPTION: Verilator output: Precompiled header for generated files\n");
+    puts("//\n");
+    puts("// The makefiles precompile this header and force it into each generated\n");
+    puts("// .cpp file (from --pch).  Do not include it from user code.\n");
+    m_ofp->putsGuard();
+    puts("\n");
+    puts("#include \"" + symClassName() + ".h\"\n");
+    if (v3Global.dpi()) puts("#include \"" + topClassName() + "__Dpi.h\"\n");
+    puts("\n");
+    m_ofp->putsEndGuard();
+    m_ofp = NULL;
+}
+
+//######################################################################
+
 void EmitCSyms::emitDpiImp() {
     UINFO(6, __FUNCTION__ << ": " << endl);
     string filename = v3Global.opt.makeDir() + "/" + topClassName() + "__Dpi.cpp";
@@ -22,10 +22,20 @@
 #include "V3EmitMk.h"
 #include "V3EmitCBase.h"
 
+#include <algorithm>
+#include <vector>
+
 //######################################################################
 // Emit statements and math operators
 
 class EmitMk {
+    // TYPES
+    struct CFileCostCmp {
+        bool operator()(const AstCFile* lhsp, const AstCFile* rhsp) const {
+            return lhsp->complexityScore() > rhsp->complexityScore();
+        }
+    };
+
 public:
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -55,9 +65,17 @@ public:
         of.puts("VM_COVERAGE = ");
         of.puts(v3Global.opt.coverage() ? "1" : "0");
         of.puts("\n");
-        of.puts("# Parallel builds?  0/1 (from --output-split)\n");
+        of.puts("# Parallel builds?  0/1 (from --output-split or --output-split-buckets)\n");
         of.puts("VM_PARALLEL_BUILDS = ");
-        of.puts(v3Global.opt.outputSplit() ? "1" : "0");
+        of.puts((v3Global.opt.outputSplit() || v3Global.opt.outputSplitBuckets()) ? "1" : "0");
+        of.puts("\n");
+        of.puts("# Precompiled headers?  0/1 (from --pch)\n");
+        of.puts("VM_PCH = ");
+        of.puts(v3Global.opt.pch() ? "1" : "0");
+        of.puts("\n");
+        of.puts("# Build for sampling profilers?  0/1 (from --prof-sample)\n");
+        of.puts("VM_PROF_SAMPLE = ");
+        of.puts(v3Global.opt.profSample() ? "1" : "0");
         of.puts("\n");
         of.puts("# Threaded output mode?  0/1/N threads (from --threads)\n");
         of.puts("VM_THREADS = ");
@@ -75,6 +93,20 @@ public:
         of.puts("VM_TRACE_FST_WRITER_THREAD = ");
         of.puts(v3Global.opt.traceThreads() && v3Global.opt.traceFormat().fst() ? "1" : "0");
         of.puts("\n");
+        of.puts("# Separate VCD writer thread? 0/1 (from --trace with --trace-thread > 1)\n");
+        of.puts("VM_TRACE_VCD_WRITER_THREAD = ");
+        of.puts(v3Global.opt.traceThreads() > 1
+                        && v3Global.opt.traceFormat() == TraceFormat::VCD
+                    ? "1"
+                    : "0");
+        of.puts("\n");
+        of.puts("# FST value change block compression threads? 0/N (from --trace-fst with"
+                " --trace-thread > 2)\n");
+        of.puts("VM_TRACE_FST_COMPRESS_THREADS = ");
+        of.puts(v3Global.opt.traceThreads() > 2 && v3Global.opt.traceFormat().fst()
+                    ? cvtToStr(v3Global.opt.traceThreads() - 1)
+                    : "0");
+        of.puts("\n");
 
         of.puts("\n### Object file lists...\n");
         for (int support = 0; support < 3; ++support) {
@@ -100,6 +132,8 @@ public:
                     if (v3Global.opt.vpi()) { putMakeClassEntry(of, "verilated_vpi.cpp"); }
                     if (v3Global.opt.savable()) { putMakeClassEntry(of, "verilated_save.cpp"); }
                     if (v3Global.opt.coverage()) { putMakeClassEntry(of, "verilated_cov.cpp"); }
+                    if (v3Global.opt.profLive()) { putMakeClassEntry(of, "verilated_live.cpp"); }
+                    if (v3Global.opt.cosim()) { putMakeClassEntry(of, "verilated_cosim.cpp"); }
                     if (v3Global.opt.trace()) {
                         putMakeClassEntry(of, v3Global.opt.traceSourceBase() + "_c.cpp");
                         if (v3Global.opt.systemC()) {
@@ -114,14 +148,23 @@ public:
                     if (v3Global.opt.mtasks()) { putMakeClassEntry(of, "verilated_threads.cpp"); }
                 } else if (support == 2 && slow) {
                 } else {
+                    std::vector<AstCFile*> cfileps;
                     for (AstNodeFile* nodep = v3Global.rootp()->filesp(); nodep;
                          nodep = VN_CAST(nodep->nextp(), NodeFile)) {
                         AstCFile* cfilep = VN_CAST(nodep, CFile);
                         if (cfilep && cfilep->source() && cfilep->slow() == (slow != 0)
                             && cfilep->support() == (support != 0)) {
-                            putMakeClassEntry(of, cfilep->name());
+                            cfileps.push_back(cfilep);
                         }
                     }
+                    // Make starts prerequisites in list order, so with -j put the
+                    // most expensive compiles first, rather than leaving one to
+                    // finish alone at the end of the build
+                    std::stable_sort(cfileps.begin(), cfileps.end(), CFileCostCmp());
+                    for (std::vector<AstCFile*>::const_iterator it = cfileps.begin();
+                         it != cfileps.end(); ++it) {
+                        putMakeClassEntry(of, (*it)->name());
+                    }
                 }
                 of.puts("\n");
             }
@@ -39,6 +39,7 @@ class EmitXmlFileVisitor : public AstNVisitor {
     // MEMBERS
     V3OutFile* m_ofp;
     uint64_t m_id;
+    std::ostream* m_indexp;  // Module offset index output, or NULL
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -122,6 +123,7 @@ class EmitXmlFileVisitor : public AstNVisitor {
         puts("</netlist>\n");
     }
     virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        size_t startOffset = ofp()->tellp();
         outputTag(nodep, "");
         puts(" origName=");
         putsQuoted(nodep->origName());
@@ -130,6 +132,14 @@ class EmitXmlFileVisitor : public AstNVisitor {
             puts(" topModule=\"1\"");  // IEEE vpiTopModule
         if (nodep->modPublic()) puts(" public=\"true\"");
         outputChildrenEnd(nodep, "");
+        if (m_indexp) {
+            *m_indexp << "{\"type\": " << VString::quoteJson(VString::downcase(nodep->typeName()))
+                      << ", \"name\": " << VString::quoteJson(nodep->prettyName())
+                      << ", \"origName\": " << VString::quoteJson(nodep->origName())
+                      << ", \"file\": " << VString::quoteJson(nodep->fileline()->filename())
+                      << ", \"offset\": " << startOffset
+                      << ", \"length\": " << (ofp()->tellp() - startOffset) << "}\n";
+        }
     }
     virtual void visit(AstVar* nodep) VL_OVERRIDE {
         AstVarType typ = nodep->varType();
@@ -157,6 +167,7 @@ class EmitXmlFileVisitor : public AstNVisitor {
         if (nodep->isSigPublic()) puts(" public=\"true\"");
         if (nodep->isSigUserRdPublic()) puts(" public_flat_rd=\"true\"");
         if (nodep->isSigUserRWPublic()) puts(" public_flat_rw=\"true\"");
+        if (nodep->isSigObserve()) puts(" public_observe=\"true\"");
         if (nodep->isGParam())
             puts(" param=\"true\"");
         else if (nodep->isParam())
@@ -249,9 +260,10 @@ class EmitXmlFileVisitor : public AstNVisitor {
     }
 
 public:
-    EmitXmlFileVisitor(AstNode* nodep, V3OutFile* ofp) {
+    EmitXmlFileVisitor(AstNode* nodep, V3OutFile* ofp, std::ostream* indexp) {
         m_ofp = ofp;
         m_id = 0;
+        m_indexp = indexp;
         iterate(nodep);
     }
     virtual ~EmitXmlFileVisitor() {}
@@ -400,6 +412,17 @@ void V3EmitXml::emitxml() {
         HierCellsXmlVisitor cellsVisitor(v3Global.rootp(), sstr);
         of.puts(sstr.str());
     }
-    EmitXmlFileVisitor visitor(v3Global.rootp(), &of);
+    if (v3Global.opt.xmlIndex()) {
+        // One JSON line per module with its byte range, so tools may parse
+        // only the modules they need
+        const string indexFilename = filename + ".idx";
+        std::ofstream* indexp(V3File::new_ofstream(indexFilename));
+        if (indexp->fail()) v3fatal("Can't write " << indexFilename);
+        { EmitXmlFileVisitor visitor(v3Global.rootp(), &of, indexp); }
+        indexp->close();
+        VL_DO_DANGLING(delete indexp, indexp);
+    } else {
+        EmitXmlFileVisitor visitor(v3Global.rootp(), &of, NULL);
+    }
     of.puts("</verilator_xml>\n");
 }
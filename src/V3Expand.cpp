@@ -22,6 +22,8 @@
 //          Note in this case that the widthMin is not correct for the MSW of
 //          the vector.  This must be accounted for if doing later constant
 //          propagation across signals.
+//      With --branchless-words, wide ASSIGN(COND(c, a, b)) becomes
+//          per word (a & m) | (b & ~m), where m = -c, avoiding a branch.
 //
 //*************************************************************************
 
@@ -30,6 +32,7 @@
 
 #include "V3Global.h"
 #include "V3Expand.h"
+#include "V3Stats.h"
 #include "V3Ast.h"
 
 #include <algorithm>
@@ -46,6 +49,7 @@ private:
 
     // STATE
     AstNode* m_stmtp;  // Current statement
+    VDouble0 m_statBranchless;  // Statistic tracking
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -140,17 +144,33 @@ private:
         if (int loffset = VL_BITBIT_E(shift)) {
             AstNode* lhip = newAstWordSelClone(lhsp, othword - 1);
             int nbitsonright = VL_EDATASIZE - loffset;  // bits that end up in lword
+            // Both shifts zero-fill the bits the other supplies, so no masking is needed
             newp = new AstOr(
-                fl,
-                new AstAnd(fl, new AstConst(fl, AstConst::SizedEData(), VL_MASK_E(loffset)),
-                           new AstShiftR(fl, lhip, new AstConst(fl, nbitsonright), VL_EDATASIZE)),
-                new AstAnd(fl, new AstConst(fl, AstConst::SizedEData(), ~VL_MASK_E(loffset)),
-                           new AstShiftL(fl, llowp, new AstConst(fl, loffset), VL_EDATASIZE)));
+                fl, new AstShiftR(fl, lhip, new AstConst(fl, nbitsonright), VL_EDATASIZE),
+                new AstShiftL(fl, llowp, new AstConst(fl, loffset), VL_EDATASIZE));
         } else {
             newp = llowp;
         }
         return newp;
     }
+    AstNode* newWordGrabShiftR(FileLine* fl, int word, AstNode* fromp, int shift) {
+        // Extract the expression to grab the value for the specified word, if it's the
+        // right shift of shift bits from fromp.  Words past the top of fromp are zero.
+        int othword = word + VL_BITWORD_E(shift);
+        AstNode* llowp = newAstWordSelClone(fromp, othword);
+        if (int loffset = VL_BITBIT_E(shift)) {
+            if (othword + 1 >= fromp->widthWords()) {
+                // Nothing above, the upper word term would be zero
+                return new AstShiftR(fl, llowp, new AstConst(fl, loffset), VL_EDATASIZE);
+            }
+            AstNode* lhip = newAstWordSelClone(fromp, othword + 1);
+            int nbitsonleft = VL_EDATASIZE - loffset;  // bits that come from lhip
+            return new AstOr(
+                fl, new AstShiftL(fl, lhip, new AstConst(fl, nbitsonleft), VL_EDATASIZE),
+                new AstShiftR(fl, llowp, new AstConst(fl, loffset), VL_EDATASIZE));
+        }
+        return llowp;
+    }
 
     AstNode* newSelBitWord(AstNode* lsbp, int wordAdder) {
         // Return equation to get the VL_BITWORD of a constant or non-constant
@@ -270,8 +290,60 @@ private:
         return true;
     }
     //-------- Triops
+    static bool branchlessCondOk(AstNode* nodep, int& budgetr) {
+        // Condition is cloned into each word, so must be cheap and side-effect free
+        if (--budgetr < 0 || !nodep->isGateOptimizable() || nodep->isWide()) return false;
+        if (const AstNodeVarRef* refp = VN_CAST(nodep, NodeVarRef)) return !refp->lvalue();
+        if (!VN_IS(nodep, Const) && !VN_IS(nodep, NodeMath)) return false;
+        for (AstNode* subp = nodep->op1p(); subp; subp = subp->nextp()) {
+            if (!branchlessCondOk(subp, budgetr)) return false;
+        }
+        for (AstNode* subp = nodep->op2p(); subp; subp = subp->nextp()) {
+            if (!branchlessCondOk(subp, budgetr)) return false;
+        }
+        for (AstNode* subp = nodep->op3p(); subp; subp = subp->nextp()) {
+            if (!branchlessCondOk(subp, budgetr)) return false;
+        }
+        for (AstNode* subp = nodep->op4p(); subp; subp = subp->nextp()) {
+            if (!branchlessCondOk(subp, budgetr)) return false;
+        }
+        return true;
+    }
+    static bool branchlessValueOk(AstNode* nodep) {
+        // Both values are always read, so only allow plain reads
+        if (const AstNodeVarRef* refp = VN_CAST(nodep, NodeVarRef)) return !refp->lvalue();
+        if (VN_IS(nodep, Const)) return true;
+        if (const AstNodeSel* selp = VN_CAST(nodep, NodeSel)) {
+            return branchlessValueOk(selp->fromp()) && VN_IS(selp->bitp(), Const);
+        }
+        return false;
+    }
+    bool branchlessOk(AstNodeAssign* nodep, AstNodeCond* rhsp) {
+        int budget = 8;  // Most nodes in each copy of the condition
+        return (v3Global.opt.branchlessWords() > 0
+                && nodep->widthWords() >= v3Global.opt.branchlessWords()
+                && VN_IS(rhsp, Cond)  // Not CondBound, which guards the values
+                && branchlessCondOk(rhsp->condp(), budget /*ref*/)
+                && branchlessValueOk(rhsp->expr1p()) && branchlessValueOk(rhsp->expr2p()));
+    }
     bool expandWide(AstNodeAssign* nodep, AstNodeCond* rhsp) {
         UINFO(8, "    Wordize ASSIGN(COND) " << nodep << endl);
+        if (branchlessOk(nodep, rhsp)) {
+            ++m_statBranchless;
+            FileLine* fl = nodep->fileline();
+            for (int w = 0; w < nodep->widthWords(); w++) {
+                // All ones if the condition is true, else zero
+                AstNode* maskp = new AstNegate(
+                    fl, new AstExtend(fl, rhsp->condp()->cloneTree(true), VL_EDATASIZE));
+                addWordAssign(nodep, w,
+                              new AstOr(fl,
+                                        new AstAnd(fl, newAstWordSelClone(rhsp->expr1p(), w),
+                                                   maskp->cloneTree(false)),
+                                        new AstAnd(fl, newAstWordSelClone(rhsp->expr2p(), w),
+                                                   new AstNot(fl, maskp))));
+            }
+            return true;
+        }
         for (int w = 0; w < nodep->widthWords(); w++) {
             addWordAssign(nodep, w,
                           new AstCond(nodep->fileline(), rhsp->condp()->cloneTree(true),
@@ -428,11 +500,13 @@ private:
 
     bool expandWide(AstNodeAssign* nodep, AstSel* rhsp) {
         UASSERT_OBJ(nodep->widthMin() == rhsp->widthConst(), nodep, "Width mismatch");
-        if (VN_IS(rhsp->lsbp(), Const) && VL_BITBIT_E(rhsp->lsbConst()) == 0) {
+        if (VN_IS(rhsp->lsbp(), Const)) {
+            // Aligned becomes word copies, misaligned a pair of constant shifts per word
             int lsb = rhsp->lsbConst();
-            UINFO(8, "    Wordize ASSIGN(SEL,align) " << nodep << endl);
+            UINFO(8, "    Wordize ASSIGN(SEL,const) " << nodep << endl);
             for (int w = 0; w < nodep->widthWords(); w++) {
-                addWordAssign(nodep, w, newAstWordSelClone(rhsp->fromp(), w + VL_BITWORD_E(lsb)));
+                addWordAssign(nodep, w,
+                              newWordGrabShiftR(rhsp->fileline(), w, rhsp->fromp(), lsb));
             }
             return true;
         } else {
@@ -887,7 +961,9 @@ public:
         m_stmtp = NULL;
         iterate(nodep);
     }
-    virtual ~ExpandVisitor() {}
+    virtual ~ExpandVisitor() {
+        V3Stats::addStat("Optimizations, Branchless wide conditionals", m_statBranchless);
+    }
 };
 
 //----------------------------------------------------------------------
@@ -27,15 +27,25 @@
 #include <cerrno>
 #include <cstdarg>
 #include <fcntl.h>
+#include <fstream>
 #include <iomanip>
 #include <map>
 #include <memory>
+#include <sstream>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <vector>
+#if __cplusplus >= 201103L
+# include <atomic>
+# include <condition_variable>
+# include <mutex>
+# include <thread>
+#endif
 
 // clang-format off
 #if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
 # define INFILTER_PIPE  // Allow pipe filtering.  Needs fork()
+# define INFILTER_MMAP  // Allow mapping large files.  Needs mmap()
 #endif
 
 #ifdef HAVE_STAT_NSEC  // i.e. Linux 2.6, from configure
@@ -49,6 +59,9 @@
 #ifdef INFILTER_PIPE
 # include <sys/wait.h>
 #endif
+#ifdef INFILTER_MMAP
+# include <sys/mman.h>
+#endif
 
 #if defined(_WIN32) || defined(__MINGW32__)
 # include <io.h>  // open, read, write, close
@@ -59,6 +72,7 @@
 //#define INFILTER_IPC_BUFSIZ 16
 #define INFILTER_IPC_BUFSIZ (64 * 1024)  // For debug, try this as a small number
 #define INFILTER_CACHE_MAX (64 * 1024)  // Maximum bytes to cache if same file read twice
+#define INFILTER_PREFETCH_AHEAD 256  // Maximum files read ahead of the parser
 
 //######################################################################
 // V3File Internal state
@@ -116,6 +130,15 @@ class V3FileDependImp {
         while ((pos = pretty.find('\n')) != string::npos) pretty.replace(pos, 1, "_");
         return pretty;
     }
+    static string contentsDigest(const string& filename) {
+        // Hash of the file's contents, so a file whose times changed, for
+        // example on a fresh checkout, is still up to date if it is unchanged
+        const vl_unique_ptr<std::ifstream> ifp(V3File::new_ifstream_nodepend(filename));
+        if (ifp->fail()) return "-";
+        std::ostringstream contents;
+        contents << ifp->rdbuf();
+        return VHashSha256(contents.str()).digestHex();
+    }
 
 public:
     // ACCESSOR METHODS
@@ -191,6 +214,7 @@ inline void V3FileDependImp::writeTimes(const string& filename, const string& cm
     *ofp << "# DESCR"
          << "IPTION: Verilator output: Timestamp data for --skip-identical.  Delete at will."
          << endl;
+    // Columns: direction, size, inode, ctime, mtime, contents digest, filename
     *ofp << "C \"" << cmdline << "\"" << endl;
 
     for (std::set<DependFile>::iterator iter = m_filenameList.begin();
@@ -202,9 +226,13 @@ inline void V3FileDependImp::writeTimes(const string& filename, const string& cm
         dfp->loadStats();
         off_t showSize = iter->size();
         ino_t showIno = iter->ino();
+        string showDigest;
         if (dfp->filename() == filename) {
             showSize = 0;
             showIno = 0;  // We're writing it, so need to ignore it
+            showDigest = "-";
+        } else {
+            showDigest = iter->exists() ? contentsDigest(iter->filename()) : "-";
         }
 
         *ofp << (iter->target() ? "T" : "S") << " ";
@@ -214,6 +242,7 @@ inline void V3FileDependImp::writeTimes(const string& filename, const string& cm
         *ofp << " " << std::setw(11) << iter->cnstime();
         *ofp << " " << std::setw(11) << iter->mstime();
         *ofp << " " << std::setw(11) << iter->mnstime();
+        *ofp << " " << showDigest;
         *ofp << " \"" << iter->filename() << "\"";
         *ofp << endl;
     }
@@ -259,8 +288,14 @@ inline bool V3FileDependImp::checkTimes(const string& filename, const string& cm
         *ifp >> chkMstime;
         time_t chkMnstime;
         *ifp >> chkMnstime;
+        string chkDigest;
+        *ifp >> chkDigest;
         char quote;
         *ifp >> quote;
+        if (quote != '"') {
+            UINFO(2, "   --check-times failed: older format " << filename << endl);
+            return false;
+        }
         string chkFilename = V3Os::getline(*ifp, '"');
 
         V3Options::fileNfsFlush(chkFilename);
@@ -287,7 +322,9 @@ inline bool V3FileDependImp::checkTimes(const string& filename, const string& cm
                   && chkStat.st_ctime == chkCstime && VL_STAT_CTIME_NSEC(chkStat) == chkCnstime
                   && chkStat.st_mtime <= (chkMstime + 20)
                   // Not comparing chkMnstime
-                  )) {
+                  )
+                && !(chkDigest != "-" && chkDigest == contentsDigest(chkFilename))) {
+                // Times differ, and so do the contents
                 UINFO(2, "   --check-times failed: out-of-date "
                              << chkFilename << "; " << chkStat.st_size << "=?" << chkSize << " "
                              << chkStat.st_ctime << "." << VL_STAT_CTIME_NSEC(chkStat) << "=?"
@@ -330,6 +367,161 @@ void V3File::createMakeDir() {
     }
 }
 
+//######################################################################
+// VInFilterPrefetch
+
+#if __cplusplus >= 201103L
+// Read a list of files on worker threads, ahead of the parser asking for
+// them. Preprocessing and parsing stay in order on the main thread, so
+// output is unchanged; this only overlaps the reads, which dominate on
+// large designs on network filesystems.  The workers only use open() and
+// read(), as none of the rest of Verilator is thread safe.
+class VInFilterPrefetch {
+    // TYPES
+    struct Slot {
+        bool m_done;  // Worker has finished reading
+        bool m_ok;  // File was read
+        string m_contents;  // File contents
+        Slot()
+            : m_done(false)
+            , m_ok(false) {}
+    };
+    typedef std::map<string, size_t> IndexMap;
+
+    // MEMBERS
+    std::vector<string> m_filenames;  // Files to read, in order
+    std::vector<Slot> m_slots;  // Result of reading each of m_filenames
+    IndexMap m_indexes;  // Filename to index in m_filenames, until taken
+    std::atomic<size_t> m_next;  // Next index a worker should read
+    size_t m_taken;  // Number of files the parser has taken
+    bool m_stopping;  // Destructing, workers should exit
+    std::mutex m_mutex;  // Protects m_slots, m_taken and m_stopping
+    std::condition_variable m_cv;  // Signals m_slots or m_taken changes
+    std::vector<std::thread> m_workers;  // Worker threads
+
+    // METHODS
+    static bool readFile(const string& filename, string& contentsr) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+#ifdef INFILTER_MMAP
+        // Files too large to cache are mapped by mapWholefile instead
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= INFILTER_CACHE_MAX) {
+            close(fd);
+            return false;
+        }
+#endif
+        char buf[INFILTER_IPC_BUFSIZ];
+        while (true) {
+            ssize_t got = read(fd, buf, INFILTER_IPC_BUFSIZ);
+            if (got > 0) {
+                contentsr.append(buf, got);
+            } else if (got < 0 && errno == EINTR) {
+                continue;
+            } else {
+                break;
+            }
+        }
+        close(fd);
+        return true;
+    }
+    void work() {
+        for (size_t i = m_next++; i < m_filenames.size(); i = m_next++) {
+            {
+                // Don't run too far ahead of the parser, to bound memory
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this, i]() {
+                    return m_stopping || i < m_taken + INFILTER_PREFETCH_AHEAD;
+                });
+                if (m_stopping) return;
+            }
+            string contents;
+            bool ok = readFile(m_filenames[i], contents);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slots[i].m_contents.swap(contents);
+            m_slots[i].m_ok = ok;
+            m_slots[i].m_done = true;
+            m_cv.notify_all();
+        }
+    }
+
+public:
+    // CONSTRUCTORS
+    VInFilterPrefetch(const std::vector<string>& filenames, size_t jobs)
+        : m_filenames(filenames)
+        , m_slots(filenames.size())
+        , m_next(0)
+        , m_taken(0)
+        , m_stopping(false) {
+        for (size_t i = 0; i < m_filenames.size(); ++i) {
+            m_indexes.insert(std::make_pair(m_filenames[i], i));
+        }
+        for (size_t t = 0; t < std::min(jobs, m_filenames.size()); ++t) {
+            m_workers.emplace_back([this]() { work(); });
+        }
+    }
+    ~VInFilterPrefetch() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_cv.notify_all();
+        }
+        for (size_t t = 0; t < m_workers.size(); ++t) m_workers[t].join();
+    }
+    // METHODS
+    // If filename was prefetched, wait for it and move its contents into
+    // contentsr. Returns false when not prefetched, or it couldn't be read.
+    bool take(const string& filename, string& contentsr) {
+        IndexMap::iterator it = m_indexes.find(filename);
+        if (it == m_indexes.end()) return false;
+        size_t i = it->second;
+        m_indexes.erase(it);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this, i]() { return m_slots[i].m_done; });
+        ++m_taken;
+        m_cv.notify_all();
+        if (!m_slots[i].m_ok) return false;
+        contentsr.swap(m_slots[i].m_contents);
+        return true;
+    }
+};
+#else
+class VInFilterPrefetch {
+public:
+    VInFilterPrefetch(const std::vector<string>&, size_t) {}
+    bool take(const string&, string&) { return false; }
+};
+#endif
+
+//######################################################################
+// VInFileMap
+
+VInFileMap* VInFileMap::open(const string& filename, size_t minSize) {
+#ifdef INFILTER_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void* datap = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+        && static_cast<size_t>(st.st_size) >= minSize) {
+        datap = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);  // Mapping remains valid
+    if (datap == MAP_FAILED) return NULL;
+    // The preprocessor reads it front to back, so encourage read-ahead
+    madvise(datap, st.st_size, MADV_SEQUENTIAL);
+    return new VInFileMap(static_cast<const char*>(datap), st.st_size);
+#else
+    return NULL;
+#endif
+}
+
+VInFileMap::~VInFileMap() {
+#ifdef INFILTER_MMAP
+    munmap(const_cast<char*>(m_datap), m_size);
+#endif
+}
+
 //######################################################################
 // VInFilterImp
 
@@ -338,6 +530,7 @@ class VInFilterImp {
     typedef VInFilter::StrList StrList;
 
     FileContentsMap m_contentsMap;  // Cache of file contents
+    VInFilterPrefetch* m_prefetchp;  // Files being read ahead, or NULL
     bool m_readEof;  // Received EOF on read
 #ifdef INFILTER_PIPE
     pid_t m_pid;  // fork() process id
@@ -581,7 +774,13 @@ protected:
             outl.push_back(it->second);
             return true;
         }
-        if (!readContents(filename, outl)) return false;
+        string prefetched;
+        if (m_prefetchp && m_prefetchp->take(filename, prefetched)) {
+            outl.push_back(string());
+            outl.back().swap(prefetched);
+        } else if (!readContents(filename, outl)) {
+            return false;
+        }
         if (listSize(outl) < INFILTER_CACHE_MAX) {
             // Cache small files (only to save space)
             // It's quite common to `include "timescale" thousands of times
@@ -590,6 +789,17 @@ protected:
         }
         return true;
     }
+    VInFileMap* mapWholefile(const string& filename) {
+        // A --pipe-filter must see every file, and small files are read to be cached
+        if (m_pid || m_contentsMap.find(filename) != m_contentsMap.end()) return NULL;
+        VInFileMap* mapp = VInFileMap::open(filename, INFILTER_CACHE_MAX);
+        if (mapp && m_prefetchp) {
+            // The prefetcher skipped it, but take it so the prefetcher reads further ahead
+            string skipped;
+            m_prefetchp->take(filename, skipped);
+        }
+        return mapp;
+    }
     size_t listSize(StrList& sl) {
         size_t out = 0;
         for (StrList::iterator it = sl.begin(); it != sl.end(); ++it) out += it->length();
@@ -600,8 +810,14 @@ protected:
         for (StrList::iterator it = sl.begin(); it != sl.end(); ++it) out += *it;
         return out;
     }
+    void prefetch(const std::vector<string>& filenames, size_t jobs) {
+        // A --pipe-filter reads all files through one pipe, so can't read ahead
+        if (m_pid || m_prefetchp) return;
+        m_prefetchp = new VInFilterPrefetch(filenames, jobs);
+    }
     // CONSTRUCTORS
     explicit VInFilterImp(const string& command) {
+        m_prefetchp = NULL;
         m_readEof = false;
         m_pid = 0;
         m_pidExited = false;
@@ -610,7 +826,10 @@ protected:
         m_readFd = 0;
         start(command);
     }
-    ~VInFilterImp() { stop(); }
+    ~VInFilterImp() {
+        if (m_prefetchp) VL_DO_CLEAR(delete m_prefetchp, m_prefetchp = NULL);
+        stop();
+    }
 };
 
 //######################################################################
@@ -627,6 +846,16 @@ bool VInFilter::readWholefile(const string& filename, VInFilter::StrList& outl)
     return m_impp->readWholefile(filename, outl);
 }
 
+VInFileMap* VInFilter::mapWholefile(const string& filename) {
+    if (!m_impp) v3fatalSrc("mapWholefile on invalid filter");
+    return m_impp->mapWholefile(filename);
+}
+
+void VInFilter::prefetch(const std::vector<string>& filenames, size_t jobs) {
+    if (!m_impp) v3fatalSrc("prefetch on invalid filter");
+    m_impp->prefetch(filenames, jobs);
+}
+
 //######################################################################
 // V3OutFormatter: A class for printing to a file, with automatic indentation of C++ code.
 
@@ -712,6 +941,27 @@ int V3OutFormatter::endLevels(const char* strg) {
     return levels;
 }
 
+static bool isPlainChar(char chr) {
+    // True if puts() and putcNoTracking() need only count the column for this character
+    switch (chr) {
+    case '\0':
+    case '\n':
+    case '\t':
+    case ' ':
+    case '/':
+    case '{':
+    case '}':
+    case '(':
+    case ')':
+    case '<':
+    case '>':
+    case '=':
+    case '|':
+    case '&': return false;
+    default: return true;
+    }
+}
+
 void V3OutFormatter::puts(const char* strg) {
     if (m_prependIndent) {
         putsNoTracking(indentSpaces(endLevels(strg)));
@@ -720,6 +970,19 @@ void V3OutFormatter::puts(const char* strg) {
     bool wordstart = true;
     bool equalsForBracket = false;  // Looking for "= {"
     for (const char* cp = strg; *cp; cp++) {
+        if (isPlainChar(*cp) && !(wordstart && m_lang == LA_VERILOG)) {
+            // Output a run of characters needing no tracking in one call
+            const char* endp = cp + 1;
+            while (isPlainChar(*endp)) ++endp;
+            size_t len = endp - cp;
+            m_column += len;
+            m_nobreak = false;
+            putsOutput(cp, len);
+            wordstart = false;
+            equalsForBracket = false;
+            cp = endp - 1;
+            continue;
+        }
         putcNoTracking(*cp);
         switch (*cp) {
         case '\n':
@@ -941,15 +1204,48 @@ void V3OutFormatter::printf(const char* fmt...) {
 // V3OutFormatter: A class for printing to a file, with automatic indentation of C++ code.
 
 V3OutFile::V3OutFile(const string& filename, V3OutFormatter::Language lang)
-    : V3OutFormatter(filename, lang) {
+    : V3OutFormatter(filename, lang)
+    , m_fp(NULL)
+    , m_buffered(v3Global.opt.outputKeepUnchanged())
+    , m_writtenBytes(0) {
+    if (m_buffered) {
+        // Opened in writeIfChanged
+        V3File::createMakeDirFor(filename);
+        V3File::addTgtDepend(filename);
+        return;
+    }
     if ((m_fp = V3File::new_fopen_w(filename)) == NULL) { v3fatal("Cannot write " << filename); }
 }
 
 V3OutFile::~V3OutFile() {
+    if (m_buffered) {
+        writeIfChanged();
+    } else if (m_fp) {
+        writeBlock();
+    }
     if (m_fp) fclose(m_fp);
     m_fp = NULL;
 }
 
+void V3OutFile::writeIfChanged() {
+    {
+        std::ifstream is(filename().c_str(), std::ios::in | std::ios::binary);
+        if (is) {
+            std::ostringstream old;
+            old << is.rdbuf();
+            if (old.str() == m_buffer) {
+                UINFO(4, "Output unchanged, keeping " << filename() << endl);
+                return;
+            }
+        }
+    }
+    if ((m_fp = fopen(filename().c_str(), "w")) == NULL) {
+        v3fatal("Cannot write " << filename());
+        return;
+    }
+    fwrite(m_buffer.data(), 1, m_buffer.size(), m_fp);
+}
+
 void V3OutFile::putsForceIncs() {
     const V3StringList& forceIncs = v3Global.opt.forceIncs();
     for (V3StringList::const_iterator it = forceIncs.begin(); it != forceIncs.end(); ++it) {
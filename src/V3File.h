@@ -71,6 +71,37 @@ public:
     static void createMakeDir();
 };
 
+//============================================================================
+// VInFileMap: Read-only memory map of a whole input file, shared by reference count
+
+class VInFileMap {
+    // MEMBERS
+    const char* m_datap;  // Mapped file contents
+    size_t m_size;  // Bytes at m_datap
+    int m_refs;  // Number of users, deleted when reaches zero
+
+    // CONSTRUCTORS
+    VInFileMap(const char* datap, size_t size)
+        : m_datap(datap)
+        , m_size(size)
+        , m_refs(1) {}
+    ~VInFileMap();
+    VL_UNCOPYABLE(VInFileMap);
+
+public:
+    // Map the file, with one reference for the caller.  Return NULL if
+    // it's smaller than minSize, not a regular file, or can't be mapped.
+    static VInFileMap* open(const string& filename, size_t minSize);
+    // ACCESSORS
+    const char* datap() const { return m_datap; }
+    size_t size() const { return m_size; }
+    // METHODS
+    void incRef() { ++m_refs; }
+    void decRef() {
+        if (--m_refs <= 0) delete this;
+    }
+};
+
 //============================================================================
 // VInFilter: Read a input file, possibly filtering it, and caching contents
 
@@ -94,6 +125,11 @@ public:
     // METHODS
     // Read file contents and return it.  Return true on success.
     bool readWholefile(const string& filename, StrList& outl);
+    // Map a large unfiltered file instead of reading it, with one reference
+    // for the caller.  Return NULL if it should be read with readWholefile.
+    VInFileMap* mapWholefile(const string& filename);
+    // Start reading the given files on jobs threads, for later readWholefile()
+    void prefetch(const std::vector<string>& filenames, size_t jobs);
 };
 
 //============================================================================
@@ -171,23 +207,47 @@ public:
 
     // CALLBACKS - MUST OVERRIDE
     virtual void putcOutput(char chr) = 0;
+    // CALLBACKS - MAY OVERRIDE, for speed
+    virtual void putsOutput(const char* strg, size_t len) {
+        for (size_t i = 0; i < len; ++i) putcOutput(strg[i]);
+    }
 };
 
 //============================================================================
 // V3OutFile: A class for printing to a file, with automatic indentation of C++ code.
 
 class V3OutFile : public V3OutFormatter {
+    // TYPES
+    enum MiscConsts { WRITE_BLOCK_SIZE = 64 * 1024 };  // Bytes to collect before each fwrite
     // MEMBERS
     FILE* m_fp;
+    bool m_buffered;  // Collecting output in m_buffer, see --output-keep-unchanged
+    string m_buffer;  // Output not yet written, or to be written on close if changed
+    size_t m_writtenBytes;  // Bytes written to m_fp so far
 
 public:
     V3OutFile(const string& filename, V3OutFormatter::Language lang);
     virtual ~V3OutFile();
     void putsForceIncs();
+    // Offset in the file of the next character output
+    size_t tellp() const { return m_writtenBytes + m_buffer.size(); }
 
 private:
     // CALLBACKS
-    virtual void putcOutput(char chr) { fputc(chr, m_fp); }
+    virtual void putcOutput(char chr) {
+        m_buffer += chr;
+        if (VL_UNLIKELY(m_buffer.size() >= WRITE_BLOCK_SIZE && !m_buffered)) writeBlock();
+    }
+    virtual void putsOutput(const char* strg, size_t len) {
+        m_buffer.append(strg, len);
+        if (VL_UNLIKELY(m_buffer.size() >= WRITE_BLOCK_SIZE && !m_buffered)) writeBlock();
+    }
+    void writeBlock() {
+        fwrite(m_buffer.data(), 1, m_buffer.size(), m_fp);
+        m_writtenBytes += m_buffer.size();
+        m_buffer.clear();
+    }
+    void writeIfChanged();
 };
 
 class V3OutCFile : public V3OutFile {
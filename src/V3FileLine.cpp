@@ -90,6 +90,18 @@ int VFileContent::debug() {
     return level;
 }
 
+VFileContent::~VFileContent() {
+    if (m_mapp) VL_DO_CLEAR(m_mapp->decRef(), m_mapp = NULL);
+}
+
+void VFileContent::pushMapped(VInFileMap* mapp) {
+    // Referencing the map saves keeping a second copy of large files
+    mapp->incRef();
+    if (m_mapp) m_mapp->decRef();
+    m_mapp = mapp;
+    m_mapLines.clear();
+}
+
 void VFileContent::pushText(const string& text) {
     if (m_lines.size() == 0) {
         m_lines.push_back("");  // no such thing as line [0]
@@ -118,6 +130,20 @@ void VFileContent::pushText(const string& text) {
 }
 
 string VFileContent::getLine(int lineno) const {
+    if (m_mapp) {
+        if (m_mapLines.empty()) {  // Only the first error in the file pays to index it
+            const char* datap = m_mapp->datap();
+            m_mapLines.push_back(0);  // Line 1
+            for (size_t pos = 0; pos < m_mapp->size(); ++pos) {
+                if (datap[pos] == '\n') m_mapLines.push_back(pos + 1);
+            }
+        }
+        // Line [0] is "", and the last line is any leftover after a final newline
+        if (lineno <= 0 || lineno > (int)m_mapLines.size()) return "";
+        size_t start = m_mapLines[lineno - 1];
+        size_t end = lineno < (int)m_mapLines.size() ? m_mapLines[lineno] : m_mapp->size();
+        return string(m_mapp->datap() + start, end - start);
+    }
     // Return error text rather than asserting so the user isn't left without a message
     // cppcheck-suppress negativeContainerIndex
     if (VL_UNCOVERABLE(lineno < 0 || lineno >= (int)m_lines.size())) {
@@ -28,10 +28,12 @@
 #include <map>
 #include <set>
 #include <deque>
+#include <vector>
 
 //######################################################################
 
 class FileLine;
+class VInFileMap;
 
 //! Singleton class with tables of per-file data.
 
@@ -69,14 +71,18 @@ class VFileContent {
     // MEMBERS
     int m_id;  // Content ID number
     std::deque<string> m_lines;  // Source text lines
+    VInFileMap* m_mapp;  // Mapped source text, instead of m_lines, or NULL
+    mutable std::vector<size_t> m_mapLines;  // Offset of each line in m_mapp, made on demand
 public:
-    VFileContent() {
+    VFileContent()
+        : m_mapp(NULL) {
         static int s_id = 0;
         m_id = ++s_id;
     }
-    ~VFileContent() {}
+    ~VFileContent();
     // METHODS
     void pushText(const string& text);  // Add arbitrary text (need not be line-by-line)
+    void pushMapped(VInFileMap* mapp);  // Use whole mapped file, instead of any pushText
     string getLine(int lineno) const;
     string ascii() const { return "ct" + cvtToStr(m_id); }
     static int debug();
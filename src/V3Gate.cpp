@@ -720,6 +720,18 @@ bool GateVisitor::elimLogicOkOutputs(GateLogicVertex* consumeVertexp,
             return false;
         }
     }
+    if (v3Global.opt.shareInstances() && !consumeVertexp->scopep()->isTop()) {
+        // The consumer's function must stay the same in every instance, so
+        // it may only gain references V3Descope can make relative
+        for (VarScopeSet::iterator it = varscopes.begin(); it != varscopes.end(); ++it) {
+            AstScope* scopep = (*it)->scopep();
+            if (scopep != consumeVertexp->scopep()
+                && scopep->aboveScopep() != consumeVertexp->scopep()) {
+                UINFO(9, "    Block-unopt, insertion references other instance " << *it << endl);
+                return false;
+            }
+        }
+    }
     return true;
 }
 
@@ -924,7 +936,8 @@ void GateVisitor::optimizeElimVar(AstVarScope* varscp, AstNode* substp, AstNode*
 class GateDedupeHash : public V3HashedUserSame {
 public:
     // TYPES
-    typedef std::set<AstNode*> NodeSet;
+    typedef vl_unordered_set<AstNode*> NodeSet;
+    typedef std::map<std::pair<AstNode*, AstNode*>, bool> SameMap;
 
 private:
     // NODE STATE
@@ -941,6 +954,7 @@ private:
 
     V3Hashed m_hashed;  // Hash, contains rhs of assigns
     NodeSet m_nodeDeleteds;  // Any node in this hash was deleted
+    SameMap m_sameCache;  // sameHash results, as the same activep's are compared repeatedly
 
     VL_DEBUG_FUNC;  // Declare debug()
 
@@ -949,8 +963,16 @@ private:
         if (nodep && !nodep->sameHash().isIllegal()) m_hashed.hash(nodep);
     }
     bool sameHash(AstNode* node1p, AstNode* node2p) {
-        return (node1p && node2p && !node1p->sameHash().isIllegal()
-                && !node2p->sameHash().isIllegal() && m_hashed.sameNodes(node1p, node2p));
+        if (!node1p || !node2p) return false;
+        if (node2p < node1p) std::swap(node1p, node2p);
+        std::pair<SameMap::iterator, bool> ins
+            = m_sameCache.insert(make_pair(make_pair(node1p, node2p), false));
+        if (ins.second) {
+            ins.first->second = (!node1p->sameHash().isIllegal()
+                                 && !node2p->sameHash().isIllegal()
+                                 && m_hashed.sameNodes(node1p, node2p));
+        }
+        return ins.first->second;
     }
     bool same(AstNode* node1p, AstNode* node2p) {
         return node1p == node2p || sameHash(node1p, node2p);
@@ -973,6 +995,8 @@ public:
         // rehash.  That's complicated and this is rare, so just remove it
         // from consideration.
         m_nodeDeleteds.insert(oldp);
+        // Trees that compared the same may now differ
+        m_sameCache.clear();
     }
     bool isReplaced(AstNode* nodep) {
         // Assignment may have been hashReplaced, if so consider non-match (effectively removed)
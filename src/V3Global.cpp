@@ -49,8 +49,26 @@ void V3Global::readFiles() {
     V3ParseSym parseSyms(v3Global.rootp());  // Symbol table must be common across all parsing
 
     V3Parse parser(v3Global.rootp(), &filter, &parseSyms);
-    // Read top module
     const V3StringList& vFiles = v3Global.opt.vFiles();
+    const V3StringSet& libraryFiles = v3Global.opt.libraryFiles();
+
+    // With --verilate-jobs, read the files on other threads while parsing
+    if (v3Global.opt.verilateJobs() > 1) {
+        FileLine* fl = new FileLine(FileLine::commandLineFilename());
+        std::vector<string> paths;
+        for (V3StringList::const_iterator it = vFiles.begin(); it != vFiles.end(); ++it) {
+            string path = v3Global.opt.filePath(fl, *it, "", "");
+            if (path != "") paths.push_back(path);
+        }
+        for (V3StringSet::const_iterator it = libraryFiles.begin(); it != libraryFiles.end();
+             ++it) {
+            string path = v3Global.opt.filePath(fl, *it, "", "");
+            if (path != "") paths.push_back(path);
+        }
+        filter.prefetch(paths, v3Global.opt.verilateJobs());
+    }
+
+    // Read top module
     for (V3StringList::const_iterator it = vFiles.begin(); it != vFiles.end(); ++it) {
         string filename = *it;
         parser.parseFile(new FileLine(FileLine::commandLineFilename()), filename, false,
@@ -60,7 +78,6 @@ void V3Global::readFiles() {
     // Read libraries
     // To be compatible with other simulators,
     // this needs to be done after the top file is read
-    const V3StringSet& libraryFiles = v3Global.opt.libraryFiles();
     for (V3StringSet::const_iterator it = libraryFiles.begin(); it != libraryFiles.end(); ++it) {
         string filename = *it;
         parser.parseFile(new FileLine(FileLine::commandLineFilename()), filename, true,
@@ -79,4 +96,5 @@ void V3Global::dumpCheckGlobalTree(const string& stagename, int newNumber, bool
     v3Global.rootp()->dumpTreeFile(v3Global.debugFilename(stagename + ".tree", newNumber), false,
                                    doDump);
     if (v3Global.opt.stats()) V3Stats::statsStage(stagename);
+    if (!v3Global.opt.statsJson().empty()) V3Stats::statsPass(stagename);
 }
@@ -31,6 +31,7 @@
 #include "V3Options.h"
 
 #include <string>
+#include <vector>
 
 class AstNetlist;
 
@@ -77,7 +78,12 @@ class V3Global {
     bool m_needHInlines;  // Need __Inlines file
     bool m_needHeavy;  // Need verilated_heavy.h include
     bool m_needTraceDumper;  // Need __Vm_dumperp in symbols
+    bool m_needChangeLoop;  // Need eval loop until change detection settles
     bool m_dpi;  // Need __Dpi include files
+    bool m_dpiAsync;  // Need VerilatedDpiAsync flush at end of eval
+    size_t m_profBranches;  // Number of --prof-branches counters in symbols
+    std::vector<string> m_profBlocks;  // Description of each --prof-blocks counter
+    std::vector<string> m_profEvalDomains;  // Sensitivity of each --prof-eval domain counter
 
 public:
     // Options
@@ -95,7 +101,10 @@ public:
         , m_needHInlines(false)
         , m_needHeavy(false)
         , m_needTraceDumper(false)
-        , m_dpi(false) {}
+        , m_needChangeLoop(true)
+        , m_dpi(false)
+        , m_dpiAsync(false)
+        , m_profBranches(0) {}
     AstNetlist* makeNetlist();
     void boot() {
         UASSERT(!m_rootp, "call once");
@@ -131,8 +140,24 @@ public:
     void needHeavy(bool flag) { m_needHeavy = flag; }
     bool needTraceDumper() const { return m_needTraceDumper; }
     void needTraceDumper(bool flag) { m_needTraceDumper = flag; }
+    size_t profBranches() const { return m_profBranches; }
+    void profBranches(size_t count) { m_profBranches = count; }
+    const std::vector<string>& profBlocks() const { return m_profBlocks; }
+    size_t profBlocksAdd(const string& desc) {
+        m_profBlocks.push_back(desc);
+        return m_profBlocks.size() - 1;
+    }
+    const std::vector<string>& profEvalDomains() const { return m_profEvalDomains; }
+    size_t profEvalDomainsAdd(const string& desc) {
+        m_profEvalDomains.push_back(desc);
+        return m_profEvalDomains.size() - 1;
+    }
+    bool needChangeLoop() const { return m_needChangeLoop; }
+    void needChangeLoop(bool flag) { m_needChangeLoop = flag; }
     bool dpi() const { return m_dpi; }
     void dpi(bool flag) { m_dpi = flag; }
+    bool dpiAsync() const { return m_dpiAsync; }
+    void dpiAsync(bool flag) { m_dpiAsync = flag; }
 };
 
 extern V3Global v3Global;
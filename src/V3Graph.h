@@ -22,6 +22,7 @@
 
 #include "V3Error.h"
 #include "V3List.h"
+#include "V3Pool.h"
 
 #include <algorithm>
 
@@ -219,6 +220,11 @@ public:
         return new V3GraphVertex(graphp, *this);
     }
     virtual ~V3GraphVertex() {}
+#ifndef VL_LEAK_CHECKS
+    // Graphs create and destroy many vertices, so pool them
+    static void* operator new(size_t size) { return vPoolAllocThread().alloc(size); }
+    static void operator delete(void* objp, size_t size) { vPoolAllocThread().free(objp, size); }
+#endif
     void unlinkEdges(V3Graph* graphp);
     void unlinkDelete(V3Graph* graphp);
 
@@ -318,11 +324,17 @@ public:
         return new V3GraphEdge(graphp, fromp, top, *this);
     }
     virtual ~V3GraphEdge() {}
+#ifndef VL_LEAK_CHECKS
+    static void* operator new(size_t size) { return vPoolAllocThread().alloc(size); }
+    static void operator delete(void* objp, size_t size) { vPoolAllocThread().free(objp, size); }
+#endif
     // METHODS
     virtual string name() const { return m_fromp->name() + "->" + m_top->name(); }
     virtual string dotLabel() const { return ""; }
     virtual string dotColor() const { return cutable() ? "yellowGreen" : "red"; }
     virtual string dotStyle() const { return cutable() ? "dashed" : ""; }
+    // Relative cost if acyclic() cuts this edge, to choose among equal weights
+    virtual uint32_t cutCost() const { return 1; }
     virtual int sortCmp(const V3GraphEdge* rhsp) const {
         if (!m_weight || !rhsp->m_weight) return 0;
         return top()->sortCmp(rhsp->top());
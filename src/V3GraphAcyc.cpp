@@ -19,10 +19,12 @@
 
 #include "V3Global.h"
 #include "V3Graph.h"
+#include "V3ThreadPool.h"
 
 #include <algorithm>
 #include <cstdarg>
 #include <list>
+#include <map>
 #include <vector>
 
 //######################################################################
@@ -67,13 +69,26 @@ private:
         return (oEListp->front());
     }
 
+    uint32_t m_cutCost;  // Total cost of cutting the original edges, set by place()
+
 public:
     GraphAcycEdge(V3Graph* graphp, V3GraphVertex* fromp, V3GraphVertex* top, int weight,
                   bool cutable = false)
-        : V3GraphEdge(graphp, fromp, top, weight, cutable) {}
+        : V3GraphEdge(graphp, fromp, top, weight, cutable)
+        , m_cutCost(0) {}
     virtual ~GraphAcycEdge() {}
     // yellow=we might still cut it, else oldEdge: yellowGreen=made uncutable, red=uncutable
     virtual string dotColor() const { return (cutable() ? "yellow" : origEdgep()->dotColor()); }
+    virtual uint32_t cutCost() const { return m_cutCost; }
+    void computeCutCost() {
+        // Cutting this edge cuts every original edge it represents
+        m_cutCost = 0;
+        OrigEdgeList* oEListp = static_cast<OrigEdgeList*>(userp());
+        if (!oEListp) return;
+        for (OrigEdgeList::iterator it = oEListp->begin(); it != oEListp->end(); ++it) {
+            m_cutCost += (*it)->cutCost();
+        }
+    }
 };
 
 //--------------------------------------------------------------------
@@ -82,6 +97,9 @@ struct GraphAcycEdgeCmp {
     inline bool operator()(const V3GraphEdge* lhsp, const V3GraphEdge* rhsp) const {
         if (lhsp->weight() > rhsp->weight()) return 1;  // LHS goes first
         if (lhsp->weight() < rhsp->weight()) return 0;  // RHS goes first
+        // Then try to keep the edges most costly to cut
+        if (lhsp->cutCost() > rhsp->cutCost()) return 1;
+        if (lhsp->cutCost() < rhsp->cutCost()) return 0;
         return 0;
     }
 };
@@ -106,6 +124,8 @@ private:
     std::vector<OrigEdgeList*> m_origEdgeDelp;  // List of deletions to do when done
     V3EdgeFuncP m_origEdgeFuncp;  // Function that says we follow this edge (in original graph)
     uint32_t m_placeStep;  // Number that user() must be equal to to indicate processing
+    bool m_oneLoop;  // Break graph holds only one strongly connected component
+    size_t m_loopVertices;  // Vertices in the m_oneLoop component
 
     static int debug() { return V3Graph::debug(); }
 
@@ -191,6 +211,8 @@ public:
         m_origGraphp = origGraphp;
         m_origEdgeFuncp = edgeFuncp;
         m_placeStep = 0;
+        m_oneLoop = false;
+        m_loopVertices = 0;
     }
     ~GraphAcyc() {
         for (std::vector<OrigEdgeList*>::iterator it = m_origEdgeDelp.begin();
@@ -200,6 +222,17 @@ public:
         m_origEdgeDelp.clear();
     }
     void main();
+    // For breaking each strongly connected component separately
+    void buildLoopVertex(V3GraphVertex* overtexp) {
+        m_oneLoop = true;
+        ++m_loopVertices;
+        overtexp->userp(new GraphAcycVertex(&m_breakGraph, overtexp));
+    }
+    void buildLoopEdges(V3GraphVertex* overtexp) {
+        buildGraphIterate(overtexp, static_cast<GraphAcycVertex*>(overtexp->userp()));
+    }
+    size_t loopSize() const { return m_loopVertices; }
+    void breakLoops();
 };
 
 //--------------------------------------------------------------------
@@ -234,7 +267,9 @@ void GraphAcyc::buildGraphIterate(V3GraphVertex* overtexp, GraphAcycVertex* aver
     for (V3GraphEdge* edgep = overtexp->outBeginp(); edgep; edgep = edgep->outNextp()) {
         if (origFollowEdge(edgep)) {  // not cut
             V3GraphVertex* toVertexp = edgep->top();
-            if (toVertexp->color()) {
+            // Edges between components can't be in a loop
+            if (toVertexp->color()
+                && (!m_oneLoop || toVertexp->color() == overtexp->color())) {
                 GraphAcycVertex* toAVertexp = static_cast<GraphAcycVertex*>(toVertexp->userp());
                 // Replicate the old edge into the new graph
                 // There may be multiple edges between same pairs of vertices
@@ -471,7 +506,10 @@ void GraphAcyc::place() {
          vertexp = vertexp->verticesNextp()) {
         vertexp->user(0);  // Clear in prep of next step
         for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep = edgep->outNextp()) {
-            if (edgep->weight() && edgep->cutable()) edges.push_back(edgep);
+            if (edgep->weight() && edgep->cutable()) {
+                static_cast<GraphAcycEdge*>(edgep)->computeCutCost();
+                edges.push_back(edgep);
+            }
         }
     }
 
@@ -557,6 +595,10 @@ void GraphAcyc::main() {
     // edges (and thus can't represent loops - if we did the unbreakable
     // marking right, anyways)
     buildGraph(m_origGraphp);
+    breakLoops();
+}
+
+void GraphAcyc::breakLoops() {
     if (debug() >= 6) m_breakGraph.dumpDotFilePrefixed("acyc_pre");
 
     // Perform simple optimizations before any cuttings
@@ -581,8 +623,53 @@ void GraphAcyc::main() {
     if (debug() >= 6) m_breakGraph.dumpDotFilePrefixed("acyc_done");
 }
 
+#if __cplusplus >= 201103L
+static void graphAcycParallel(V3Graph* graphp, V3EdgeFuncP edgeFuncp, size_t jobs) {
+    // Break each strongly connected component in its own break graph.
+    // Components share no break edges, so the cuts made don't depend on
+    // which thread handles which component, or when.
+    graphp->stronglyConnected(edgeFuncp);
+    graphp->userClearVertices();
+    graphp->userClearEdges();
+    std::vector<GraphAcyc*> acycs;
+    std::map<uint32_t, GraphAcyc*> colorAcycs;
+    for (V3GraphVertex* vertexp = graphp->verticesBeginp(); vertexp;
+         vertexp = vertexp->verticesNextp()) {
+        if (!vertexp->color()) continue;
+        GraphAcyc*& acycr = colorAcycs[vertexp->color()];
+        if (!acycr) {
+            acycr = new GraphAcyc(graphp, edgeFuncp);
+            acycs.push_back(acycr);
+        }
+        acycr->buildLoopVertex(vertexp);
+    }
+    for (V3GraphVertex* vertexp = graphp->verticesBeginp(); vertexp;
+         vertexp = vertexp->verticesNextp()) {
+        if (vertexp->color()) colorAcycs[vertexp->color()]->buildLoopEdges(vertexp);
+    }
+    UINFO(4, " Breaking " << acycs.size() << " loops on " << jobs << " jobs\n");
+
+    // Biggest first, so one large loop doesn't start last
+    std::stable_sort(acycs.begin(), acycs.end(), [](const GraphAcyc* ap, const GraphAcyc* bp) {
+        return ap->loopSize() > bp->loopSize();
+    });
+    V3ThreadPool::s().parallelFor(jobs, acycs.size(),
+                                  [&acycs](size_t i) { acycs[i]->breakLoops(); });
+    for (size_t i = 0; i < acycs.size(); ++i) delete acycs[i];
+}
+#endif
+
 void V3Graph::acyclic(V3EdgeFuncP edgeFuncp) {
     UINFO(4, "Acyclic\n");
+#if __cplusplus >= 201103L
+    // Debug messages and dumps of the break graph aren't thread safe
+    size_t jobs = v3Global.opt.verilateJobs();
+    if (jobs > 1 && debug() < 4) {
+        graphAcycParallel(this, edgeFuncp, jobs);
+        UINFO(4, "Acyclic done\n");
+        return;
+    }
+#endif
     GraphAcyc acyc(this, edgeFuncp);
     acyc.main();
     UINFO(4, "Acyclic done\n");
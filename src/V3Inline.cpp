@@ -22,6 +22,14 @@
 //              Rename vars to include cell name
 //          Insert cell's module statements into the upper module
 //
+// With --specialize-budget, first, for each CELL of a module not being inlined:
+//      Find input pins connected to constants
+//          Clone the module for each distinct set of constant pins
+//              (or change the module itself if it has only this one cell)
+//          In the clone, make each such input a wire assigned the constant,
+//              and replace its reads with the constant so V3Const/V3Dead can fold it
+//          Remove the constant pins from the cell, and point the cell at the clone
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -233,6 +241,197 @@ public:
     }
 };
 
+//######################################################################
+// Specialize modules that will not be inlined on their constant input pins
+
+class InlineSpecializeVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    // Input:
+    //  AstNodeModule::user1()  // bool. True to inline this module (from InlineMarkVisitor)
+    // Internal state (can be cleared after this visit completes)
+    //  AstNodeModule::user2()  // int. Number of cells referencing this module
+    //  AstVar::user3p()        // AstConst*. Constant replacing reads of this input
+    AstUser2InUse m_inuser2;
+    AstUser3InUse m_inuser3;
+
+    // STATE
+    typedef std::map<string, AstNodeModule*> SpecMap;
+    SpecMap m_specMods;  // Specialized modules, by source module name and constant pins
+    int m_budget;  // Remaining AST nodes that may be cloned
+    int m_specNum;  // Number of clones made, for unique names
+    enum { SM_COUNT, SM_SPECIALIZE, SM_REPLACE } m_mode;  // Current pass
+    VDouble0 m_statCells;  // Statistic tracking
+    VDouble0 m_statClones;  // Statistic tracking
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    static bool pinSpecializable(AstPin* pinp) {
+        AstVar* varp = pinp->modVarp();
+        AstConst* constp = VN_CAST(pinp->exprp(), Const);
+        return (constp && varp && varp->direction() == VDirection::INPUT && !varp->isSigPublic()
+                && !varp->isSc() && varp->dtypep()->basicp() && !varp->isDouble()
+                && !varp->isString() && constp->width() == varp->width());
+    }
+    static bool modSpecializable(AstNodeModule* modp) {
+        if (!VN_IS(modp, Module) || modp->user1() || modp->modPublic()) return false;
+        for (AstNode* stmtp = modp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            if (AstVar* varp = VN_CAST(stmtp, Var)) {
+                if (varp->isIfaceRef()) return false;  // Cloning would need iface relinking
+            }
+        }
+        return true;
+    }
+    static AstVar* findModVar(AstNodeModule* modp, const string& name) {
+        for (AstNode* stmtp = modp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            AstVar* varp = VN_CAST(stmtp, Var);
+            if (varp && varp->name() == name) return varp;
+        }
+        return NULL;
+    }
+    static int nodeCount(AstNode* nodep) {
+        int count = 1;
+        if (nodep->op1p()) count += nodeCountList(nodep->op1p());
+        if (nodep->op2p()) count += nodeCountList(nodep->op2p());
+        if (nodep->op3p()) count += nodeCountList(nodep->op3p());
+        if (nodep->op4p()) count += nodeCountList(nodep->op4p());
+        return count;
+    }
+    static int nodeCountList(AstNode* nodep) {
+        int count = 0;
+        for (; nodep; nodep = nodep->nextp()) count += nodeCount(nodep);
+        return count;
+    }
+    void specializeMod(AstNodeModule* modp, AstCell* cellp) {
+        // Make constant inputs of modp (just cloned or only used by cellp) into wires
+        for (AstPin* pinp = cellp->pinsp(); pinp; pinp = VN_CAST(pinp->nextp(), Pin)) {
+            if (!pinSpecializable(pinp)) continue;
+            AstVar* varp = findModVar(modp, pinp->modVarp()->name());
+            UASSERT_OBJ(varp, pinp, "Specialized pin's variable not in module");
+            UINFO(6, "     Specialize " << varp << endl);
+            AstConst* constp = VN_CAST(pinp->exprp(), Const);
+            varp->direction(VDirection::NONE);
+            varp->varType(AstVarType::WIRE);
+            varp->addNextHere(new AstAssignW(varp->fileline(),
+                                             new AstVarRef(varp->fileline(), varp, true),
+                                             constp->cloneTree(false)));
+            varp->user3p(constp);
+        }
+        // Replace reads with the constants
+        m_mode = SM_REPLACE;
+        iterateChildren(modp);
+        m_mode = SM_SPECIALIZE;
+        for (AstPin* pinp = cellp->pinsp(); pinp; pinp = VN_CAST(pinp->nextp(), Pin)) {
+            if (pinSpecializable(pinp)) pinp->modVarp()->user3p(NULL);
+        }
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        UINFO(4, " MOD   " << nodep << endl);
+        // Modules are in top-down order, so clones inserted below are processed when reached
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstCell* nodep) VL_OVERRIDE {
+        AstNodeModule* modp = nodep->modp();
+        if (m_mode == SM_COUNT) {
+            modp->user2Inc();
+            return;
+        } else if (m_mode == SM_REPLACE) {
+            iterateChildren(nodep);  // Pins may read a replaced input
+            return;
+        }
+        if (!modSpecializable(modp)) return;
+        string key = modp->name();
+        for (AstPin* pinp = nodep->pinsp(); pinp; pinp = VN_CAST(pinp->nextp(), Pin)) {
+            if (pinSpecializable(pinp)) {
+                key += " " + pinp->modVarp()->name() + "="
+                       + VN_CAST(pinp->exprp(), Const)->num().ascii();
+            }
+        }
+        if (key == modp->name()) return;  // No constant pins
+
+        AstNodeModule* specp = NULL;
+        SpecMap::iterator it = m_specMods.find(key);
+        if (it != m_specMods.end()) {
+            specp = it->second;
+        } else if (modp->user2() == 1) {
+            // Only instance, so no need to clone
+            UINFO(4, "   Specialize in place " << nodep << endl);
+            specializeMod(modp, nodep);
+            specp = modp;
+        } else {
+            int nodes = nodeCount(modp);
+            if (nodes > m_budget) {
+                UINFO(4, "   Specialize over budget " << nodes << " " << nodep << endl);
+                return;
+            }
+            m_budget -= nodes;
+            ++m_statClones;
+            specp = modp->cloneTree(false);
+            specp->name(modp->name() + "__Vsp" + cvtToStr(++m_specNum));
+            specp->user2(0);
+            modp->addNextHere(specp);
+            UINFO(4, "   Specialize to new " << specp << endl);
+            specializeMod(specp, nodep);
+            // Submodule cells in the clone are new references
+            m_mode = SM_COUNT;
+            iterateChildren(specp);
+            m_mode = SM_SPECIALIZE;
+            m_specMods.insert(make_pair(key, specp));
+        }
+        ++m_statCells;
+        // Retarget the cell
+        AstPin* nextpinp;
+        for (AstPin* pinp = nodep->pinsp(); pinp; pinp = nextpinp) {
+            nextpinp = VN_CAST(pinp->nextp(), Pin);
+            if (pinSpecializable(pinp)) {
+                VL_DO_DANGLING(pinp->unlinkFrBack()->deleteTree(), pinp);
+            } else if (specp != modp && pinp->modVarp()) {
+                AstVar* varp = findModVar(specp, pinp->modVarp()->name());
+                UASSERT_OBJ(varp, pinp, "Pin's variable not in specialized module");
+                pinp->modVarp(varp);
+            }
+        }
+        if (specp != modp) {
+            modp->user2(modp->user2() - 1);
+            specp->user2Inc();
+            nodep->modp(specp);
+            nodep->modName(specp->name());
+        }
+    }
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        if (m_mode != SM_REPLACE || nodep->lvalue() || !nodep->varp()) return;
+        if (AstConst* constp = VN_CAST(nodep->varp()->user3p(), Const)) {
+            nodep->replaceWith(constp->cloneTree(false));
+            VL_DO_DANGLING(pushDeletep(nodep), nodep);
+        }
+    }
+    virtual void visit(AstNodeStmt* nodep) VL_OVERRIDE {
+        if (m_mode == SM_REPLACE) iterateChildren(nodep);  // Else accelerate, no cells below
+    }
+    virtual void visit(AstNodeMath* nodep) VL_OVERRIDE {
+        if (m_mode == SM_REPLACE) iterateChildren(nodep);  // Else accelerate, no cells below
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit InlineSpecializeVisitor(AstNetlist* nodep) {
+        m_budget = v3Global.opt.specializeBudget();
+        m_specNum = 0;
+        m_mode = SM_COUNT;
+        iterate(nodep);
+        m_mode = SM_SPECIALIZE;
+        iterate(nodep);
+    }
+    virtual ~InlineSpecializeVisitor() {
+        V3Stats::addStat("Optimizations, Inline specialized cells", m_statCells);
+        V3Stats::addStat("Optimizations, Inline specialized clones", m_statClones);
+    }
+};
+
 //######################################################################
 // Using clonep(), find cell cross references.
 // clone() must not be called inside this visitor
@@ -722,6 +921,7 @@ void V3Inline::inlineAll(AstNetlist* nodep) {
                               // input to InlineVisitor.
     // Scoped to clean up temp userN's
     { InlineMarkVisitor mvisitor(nodep); }
+    if (v3Global.opt.specializeBudget()) { InlineSpecializeVisitor svisitor(nodep); }
     { InlineVisitor visitor(nodep); }
     // Remove all modules that were inlined
     // V3Dead will also clean them up, but if we have debug on, it's a good
@@ -0,0 +1,256 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Inline small C functions into their callers
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+// V3InlineCFuncs's Transformations:
+//
+// Each CFunc:
+//      Each CCALL statement to a void function in the same module
+//          If the function has only this call, move its body here
+//          If the function is small and calls nothing, clone its body here
+//      Delete functions that no longer have any calls
+//
+//    V3Order and V3Clock make many small functions; inlining them lets the
+//    C++ compiler keep values in registers across what were calls.
+//    Callers are kept under --output-split-cfuncs.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3Global.h"
+#include "V3InlineCFuncs.h"
+#include "V3EmitCBase.h"
+#include "V3Stats.h"
+#include "V3Ast.h"
+
+#include <cstdarg>
+#include <set>
+#include <vector>
+
+#define INLINE_CFUNCS_SMALL 32  // Most nodes in a function cloned into several callers
+
+//######################################################################
+
+class InlineCFuncsCountVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    // Entire netlist (from InlineCFuncsVisitor):
+    //  AstCFunc::user1()       -> int.  Number of calls from other functions
+    //  AstCFunc::user2()       -> bool.  Called from outside a function, never delete
+    //  AstCFunc::user3p()      -> AstNodeModule*.  Module containing function
+
+    // STATE
+    AstNodeModule* m_modp;  // Current module
+    AstCFunc* m_cfuncp;  // Current function
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        m_modp = nodep;
+        iterateChildren(nodep);
+        m_modp = NULL;
+    }
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        nodep->user3p(m_modp);
+        m_cfuncp = nodep;
+        iterateChildren(nodep);
+        m_cfuncp = NULL;
+    }
+    virtual void visit(AstNodeCCall* nodep) VL_OVERRIDE {
+        if (m_cfuncp && VN_IS(nodep, CCall)) {
+            nodep->funcp()->user1Inc();
+        } else {
+            nodep->funcp()->user2(true);
+        }
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstVar*) VL_OVERRIDE {}  // Accelerate
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit InlineCFuncsCountVisitor(AstNetlist* nodep)
+        : m_modp(NULL)
+        , m_cfuncp(NULL) {
+        iterate(nodep);
+    }
+    virtual ~InlineCFuncsCountVisitor() {}
+};
+
+//######################################################################
+
+class InlineCFuncsVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    // Entire netlist:
+    //  AstCFunc::user1()       -> int.  Number of calls from other functions
+    //  AstCFunc::user2()       -> bool.  Called from outside a function, never delete
+    //  AstCFunc::user3p()      -> AstNodeModule*.  Module containing function
+    //  AstCFunc::user4()       -> bool.  Inlined at least once
+    AstUser1InUse m_inuser1;
+    AstUser2InUse m_inuser2;
+    AstUser3InUse m_inuser3;
+    AstUser4InUse m_inuser4;
+
+    // TYPES
+    typedef std::set<string> NameSet;
+    typedef std::vector<AstCFunc*> CFuncVec;
+
+    // STATE
+    VDouble0 m_statInlined;  // Statistic tracking
+    VDouble0 m_statDeleted;  // Statistic tracking
+    AstCFunc* m_cfuncp;  // Current function
+    int m_cfuncNodes;  // Approximate size of current function
+    NameSet m_localNames;  // Names of current function's locals
+    CFuncVec m_inlinedps;  // Functions that have been inlined somewhere
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    static int nodeCount(AstNode* nodep) {
+        // Same measure as V3Order uses for --output-split-cfuncs
+        EmitCBaseCounterVisitor visitor(nodep);
+        return visitor.count();
+    }
+    static bool hasNoInlineNodes(AstNode* nodep, bool cloning) {
+        // Returns and jumps can't be moved; cloning can't duplicate locals or calls
+        for (; nodep; nodep = nodep->nextp()) {
+            if (VN_IS(nodep, CReturn) || VN_IS(nodep, JumpBlock) || VN_IS(nodep, JumpLabel)
+                || VN_IS(nodep, JumpGo)) {
+                return false;
+            }
+            if (cloning && (VN_IS(nodep, Var) || VN_IS(nodep, NodeCCall))) return false;
+            if (!hasNoInlineNodes(nodep->op1p(), cloning)
+                || !hasNoInlineNodes(nodep->op2p(), cloning)
+                || !hasNoInlineNodes(nodep->op3p(), cloning)
+                || !hasNoInlineNodes(nodep->op4p(), cloning)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool inlineOk(AstCCall* callp, AstCFunc* calleep, bool cloning) {
+        if (calleep == m_cfuncp || calleep->user3p() != m_cfuncp->user3p()) return false;
+        if (calleep->dontInline() || calleep->entryPoint() || calleep->isVirtual()
+            || calleep->isConstructor() || calleep->isDestructor() || calleep->dpiImport()
+            || calleep->dpiExport() || calleep->dpiExportWrapper()
+            || calleep->dpiImportWrapper()) {
+            return false;
+        }
+        if (calleep->rtnTypeVoid() != "void" || calleep->argsp() || callp->argsp()
+            || calleep->finalsp() || calleep->ifdef() != m_cfuncp->ifdef()
+            || calleep->argTypes() != m_cfuncp->argTypes()) {  // So has same vlSymsp
+            return false;
+        }
+        if (!calleep->isStatic().trueKnown()) {
+            // Callee refers to "this", so must have been called on this same object
+            if (m_cfuncp->isStatic().trueKnown()) return false;
+            if (callp->hiername() != "" && callp->hiername() != "this->") return false;
+        }
+        for (AstNode* initp = calleep->initsp(); initp; initp = initp->nextp()) {
+            // Locals only, not clashing with ours
+            AstVar* varp = VN_CAST(initp, Var);
+            if (!varp || m_localNames.find(varp->name()) != m_localNames.end()) return false;
+        }
+        if (v3Global.opt.outputSplitCFuncs()
+            && m_cfuncNodes + nodeCount(calleep) > v3Global.opt.outputSplitCFuncs()) {
+            return false;
+        }
+        return hasNoInlineNodes(calleep->initsp(), cloning)
+               && hasNoInlineNodes(calleep->stmtsp(), cloning);
+    }
+    void inlineCall(AstCCall* callp, AstCFunc* calleep, bool cloning) {
+        UINFO(6, "  Inline " << calleep << " into " << m_cfuncp << endl);
+        ++m_statInlined;
+        m_cfuncNodes += nodeCount(calleep);
+        calleep->user1(calleep->user1() - 1);
+        if (!calleep->user4SetOnce()) m_inlinedps.push_back(calleep);
+        if (calleep->symProlog()) m_cfuncp->symProlog(true);
+        while (AstNode* initp = calleep->initsp()) {
+            m_localNames.insert(initp->name());
+            m_cfuncp->addInitsp(initp->unlinkFrBack());
+        }
+        if (AstNode* bodysp = calleep->stmtsp()) {
+            callp->addNextHere(cloning ? bodysp->cloneTree(true) : bodysp->unlinkFrBackWithNext());
+        }
+        callp->unlinkFrBack();
+        pushDeletep(callp);
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        if (VN_IS(nodep, Class)) return;  // Methods may be called from outside
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        if (nodep->funcType() != AstCFuncType::FT_NORMAL || nodep->dpiImport()) return;
+        m_cfuncp = nodep;
+        m_cfuncNodes = nodeCount(nodep);
+        m_localNames.clear();
+        for (AstNode* initp = nodep->initsp(); initp; initp = initp->nextp()) {
+            m_localNames.insert(initp->name());
+        }
+        iterateChildren(nodep);
+        m_cfuncp = NULL;
+    }
+    virtual void visit(AstCCall* nodep) VL_OVERRIDE {
+        if (!m_cfuncp) return;
+        AstCFunc* calleep = nodep->funcp();
+        if (calleep->user1() == 1 && !calleep->user2() && inlineOk(nodep, calleep, false)) {
+            // Only caller; the inlined statements are visited next, so calls
+            // within them may also be inlined
+            inlineCall(nodep, calleep, false);
+        } else if (nodeCount(calleep) <= INLINE_CFUNCS_SMALL
+                   && inlineOk(nodep, calleep, true)) {
+            inlineCall(nodep, calleep, true);
+        } else {
+            iterateChildren(nodep);
+        }
+    }
+    virtual void visit(AstVar*) VL_OVERRIDE {}  // Accelerate
+    virtual void visit(AstNodeMath*) VL_OVERRIDE {}  // Accelerate
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit InlineCFuncsVisitor(AstNetlist* nodep)
+        : m_cfuncp(NULL)
+        , m_cfuncNodes(0) {
+        { InlineCFuncsCountVisitor countVisitor(nodep); }
+        iterate(nodep);
+        // Remove functions with no calls left
+        for (CFuncVec::iterator it = m_inlinedps.begin(); it != m_inlinedps.end(); ++it) {
+            AstCFunc* funcp = *it;
+            if (!funcp->user1() && !funcp->user2()) {
+                ++m_statDeleted;
+                VL_DO_DANGLING(funcp->unlinkFrBack()->deleteTree(), funcp);
+            }
+        }
+    }
+    virtual ~InlineCFuncsVisitor() {
+        V3Stats::addStat("Optimizations, Inlined CFunc calls", m_statInlined);
+        V3Stats::addStat("Optimizations, Inlined CFuncs deleted", m_statDeleted);
+    }
+};
+
+//######################################################################
+// InlineCFuncs class functions
+
+void V3InlineCFuncs::inlineAll(AstNetlist* nodep) {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    { InlineCFuncsVisitor visitor(nodep); }  // Destruct before checking
+    V3Global::dumpCheckGlobalTree("inlinecfuncs", 0,
+                                  v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
@@ -19,9 +19,12 @@
 #include "verilatedos.h"
 
 #include "V3Ast.h"
+#include "V3File.h"
 #include "V3InstrCount.h"
 
 #include <iomanip>
+#include <memory>
+#include <sstream>
 
 /// Estimate the instruction cost for executing all logic within and below
 /// a given AST node. Note this estimates the number of instructions we'll
@@ -303,3 +306,42 @@ uint32_t V3InstrCount::count(AstNode* nodep, bool assertNoDups, std::ostream* os
     if (osp) InstrCountDumpVisitor dumper(nodep, osp);
     return visitor.instrCount();
 }
+
+void V3InstrCount::loadCosts(const string& filename) {
+    // Each line is a VInstrCost name and its cost, as written by
+    // verilator_instrcost; costs not given keep their defaults
+    const vl_unique_ptr<std::ifstream> ifp(V3File::new_ifstream(filename));
+    if (ifp->fail()) {
+        v3fatal("Cannot open --instr-costs file: " << filename);
+        return;
+    }
+    string line;
+    int lineno = 0;
+    while (std::getline(*ifp, line)) {
+        ++lineno;
+        string::size_type pos = line.find('#');
+        if (pos != string::npos) line.erase(pos);
+        std::istringstream is(line);
+        string name;
+        if (!(is >> name)) continue;  // Blank or comment
+        int cost;
+        string extra;
+        if (!(is >> cost) || (is >> extra) || cost < 1) {
+            v3error(filename << ":" << lineno << ": Expected a name and a positive cost: "
+                             << line);
+            continue;
+        }
+        int i = 0;
+        for (; i < VInstrCost::_ENUM_END; ++i) {
+            VInstrCost costType(i);
+            if (name == costType.ascii()) {
+                UINFO(2, "Instruction cost " << name << " = " << cost << endl);
+                costType.cost(cost);
+                break;
+            }
+        }
+        if (i == VInstrCost::_ENUM_END) {
+            v3error(filename << ":" << lineno << ": Unknown instruction cost name: " << name);
+        }
+    }
+}
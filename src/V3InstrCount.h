@@ -21,6 +21,8 @@
 #include "config_build.h"
 #include "verilatedos.h"
 
+#include "V3Error.h"
+
 class AstNode;
 
 class V3InstrCount {
@@ -39,6 +41,9 @@ public:
     // potentially) raises an error.
     // Optional osp is stream to dump critical path to.
     static uint32_t count(AstNode* nodep, bool assertNoDups, std::ostream* osp = NULL);
+    // Replace the default instruction costs with those from a
+    // verilator_instrcost calibration file
+    static void loadCosts(const string& filename);
 };
 
 #endif  // guard
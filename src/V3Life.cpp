@@ -19,7 +19,10 @@
 //          ASSIGN(x,...), ASSIGN(x,...) => delete first one
 //          We also track across if statements:
 //          ASSIGN(X,...) IF( ..., ASSIGN(X,...), ASSIGN(X,...)) => deletes first
-//          We don't do the opposite yet though (remove assigns in if followed by outside if)
+//          ASSIGN(X,...) in an IF, followed by ASSIGN(X,...) after the IF with no use
+//          of X between => deletes the one in the IF.  As _eval calls the
+//          scheduled blocks in order, this removes writes in one block that
+//          a later block overwrites before any read.
 //
 //*************************************************************************
 
@@ -47,6 +50,7 @@ class LifeState {
     // STATE
 public:
     VDouble0 m_statAssnDel;  // Statistic tracking
+    VDouble0 m_statAssnDelBranch;  // Statistic tracking
     VDouble0 m_statAssnCon;  // Statistic tracking
     std::vector<AstNode*> m_unlinkps;
 
@@ -55,6 +59,8 @@ public:
     LifeState() {}
     ~LifeState() {
         V3Stats::addStatSum("Optimizations, Lifetime assign deletions", m_statAssnDel);
+        V3Stats::addStatSum("Optimizations, Lifetime assign deletions from branches",
+                            m_statAssnDelBranch);
         V3Stats::addStatSum("Optimizations, Lifetime constant prop", m_statAssnCon);
         for (std::vector<AstNode*>::iterator it = m_unlinkps.begin(); it != m_unlinkps.end();
              ++it) {
@@ -70,7 +76,13 @@ public:
 // Structure for each variable encountered
 
 class LifeVarEntry {
+public:
+    typedef std::vector<AstNodeAssign*> AssignList;
+
+private:
     AstNodeAssign* m_assignp;  // Last assignment to this varscope, NULL if no longer relevant
+    // Assignments in branches above, not used since, so dead if there is another
+    AssignList m_branchps;
     AstConst* m_constp;  // Known constant value
     // First access was a set (and thus block above may have a set that can be deleted
     bool m_setBeforeUse;
@@ -110,13 +122,31 @@ public:
     }
     inline void complexAssign() {  // A[x]=... or some complicated assignment
         m_assignp = NULL;
+        m_branchps.clear();
         m_constp = NULL;
         m_everSet = true;
     }
     inline void consumed() {  // Rvalue read of A
         m_assignp = NULL;
+        m_branchps.clear();
+    }
+    // A branch below accessed A.  If it set A before any use, earlier
+    // assignments may still be dead, and its own last assignment may be.
+    inline void branchAssign(const LifeVarEntry& branch) {
+        if (!branch.m_setBeforeUse) {
+            m_branchps.clear();
+        } else if (m_assignp) {
+            m_branchps.push_back(m_assignp);
+        }
+        m_assignp = NULL;
+        m_constp = NULL;
+        m_everSet = true;
+        if (branch.m_assignp) m_branchps.push_back(branch.m_assignp);
+        m_branchps.insert(m_branchps.end(), branch.m_branchps.begin(), branch.m_branchps.end());
     }
+    inline void branchDeleted() { m_branchps.clear(); }
     AstNodeAssign* assignp() const { return m_assignp; }
+    const AssignList& branchps() const { return m_branchps; }
     AstConst* constNodep() const { return m_constp; }
     bool setBeforeUse() const { return m_setBeforeUse; }
     bool everSet() const { return m_everSet; }
@@ -153,6 +183,14 @@ public:
             // Rather than track what sigs AstUCFunc/AstUCStmt may change,
             // we just don't optimize any public sigs
             // Check the var entry, and remove if appropriate
+            for (LifeVarEntry::AssignList::const_iterator bit = entp->branchps().begin();
+                 bit != entp->branchps().end(); ++bit) {
+                UINFO(7, "       BRANCH: " << *bit << endl);
+                if (debug() > 4) (*bit)->dumpTree(cout, "       REMOVE/BRANCH ");
+                m_statep->pushUnlinkDeletep(*bit);
+                ++m_statep->m_statAssnDelBranch;
+            }
+            entp->branchDeleted();
             if (AstNode* oldassp = entp->assignp()) {
                 UINFO(7, "       PREV: " << oldassp << endl);
                 // Redundant assignment, in same level block
@@ -225,12 +263,26 @@ public:
             m_map.insert(make_pair(nodep, LifeVarEntry(LifeVarEntry::CONSUMED())));
         }
     }
-    void lifeToAbove() {
+    void branchAssignFind(AstVarScope* nodep, const LifeVarEntry& branch) {
+        LifeMap::iterator it = m_map.find(nodep);
+        if (it == m_map.end()) {
+            it = m_map.insert(make_pair(nodep, LifeVarEntry(LifeVarEntry::COMPLEXASSIGN()))).first;
+        }
+        UINFO(4, "     branchfind: " << it->first << endl);
+        it->second.branchAssign(branch);
+    }
+    void lifeToAbove(bool branch) {
         // Any varrefs under a if/else branch affect statements outside and after the if/else
+        // If 'branch', the block runs at most once, so its last assignments
+        // are dead if the above block assigns again before any use.
         if (!m_aboveLifep) v3fatalSrc("Pushing life when already at the top level");
         for (LifeMap::iterator it = m_map.begin(); it != m_map.end(); ++it) {
             AstVarScope* nodep = it->first;
-            m_aboveLifep->complexAssignFind(nodep);
+            if (branch) {
+                m_aboveLifep->branchAssignFind(nodep, it->second);
+            } else {
+                m_aboveLifep->complexAssignFind(nodep);
+            }
             if (it->second.everSet()) {
                 // Record there may be an assignment, so we don't constant propagate across the if.
                 complexAssignFind(nodep);
@@ -355,8 +407,8 @@ private:
         // Find sets on both flows
         m_lifep->dualBranch(ifLifep, elseLifep);
         // For the next assignments, clear any variables that were read or written in the block
-        ifLifep->lifeToAbove();
-        elseLifep->lifeToAbove();
+        ifLifep->lifeToAbove(true);
+        elseLifep->lifeToAbove(true);
         VL_DO_DANGLING(delete ifLifep, ifLifep);
         VL_DO_DANGLING(delete elseLifep, elseLifep);
     }
@@ -385,8 +437,8 @@ private:
         m_lifep = prevLifep;
         UINFO(4, "   joinfor" << endl);
         // For the next assignments, clear any variables that were read or written in the block
-        condLifep->lifeToAbove();
-        bodyLifep->lifeToAbove();
+        condLifep->lifeToAbove(false);
+        bodyLifep->lifeToAbove(false);
         VL_DO_DANGLING(delete condLifep, condLifep);
         VL_DO_DANGLING(delete bodyLifep, bodyLifep);
     }
@@ -406,7 +458,7 @@ private:
         }
         UINFO(4, "   joinjump" << endl);
         // For the next assignments, clear any variables that were read or written in the block
-        bodyLifep->lifeToAbove();
+        bodyLifep->lifeToAbove(false);
         VL_DO_DANGLING(delete bodyLifep, bodyLifep);
     }
     virtual void visit(AstNodeCCall* nodep) VL_OVERRIDE {
@@ -21,6 +21,11 @@
 //              ... {no reads or writes of a after the first write to Vdly}
 //              ... {no reads of a after the first write to Vdly}
 //              ASSIGNPOST(Vdly, tmp)
+//          Move array stores, and delete their set flags
+//              ASSIGNPRE(Vdlyvset, 0)
+//              ASSIGN(Vdlyvset, 1) ... {assigns of Vdlyvdim/Vdlyvval}
+//              ... {no accesses of the array or writes of Vdlyvdim/Vdlyvval}
+//              IF(Vdlyvset, ASSIGN(ARRAYSEL(array, Vdlyvdim), Vdlyvval))
 //
 //*************************************************************************
 
@@ -98,6 +103,29 @@ public:
     virtual ~LifePostElimVisitor() {}
 };
 
+//######################################################################
+// Find variables read by a statement
+
+class LifePostReadVisitor : public AstNVisitor {
+private:
+    // STATE
+    std::set<AstVarScope*>& m_readsr;  // Variables read
+
+    // VISITORS
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        if (!nodep->lvalue()) m_readsr.insert(nodep->varScopep());
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    LifePostReadVisitor(AstNode* nodep, std::set<AstVarScope*>& readsr)
+        : m_readsr(readsr) {
+        iterate(nodep);
+    }
+    virtual ~LifePostReadVisitor() {}
+};
+
 //######################################################################
 // Location within the execution graph, identified by an mtask
 // and a sequence number within the mtask:
@@ -148,6 +176,7 @@ private:
     const ExecMTask* m_execMTaskp;  // Current ExecMTask being processed,
     //                                  // or NULL for serial code.
     VDouble0 m_statAssnDel;  // Statistic tracking
+    VDouble0 m_statSetDel;  // Statistic tracking
     bool m_tracingCall;  // Currently tracing a CCall to a CFunc
 
     // Map each varscope to one or more locations where it's accessed.
@@ -160,6 +189,15 @@ private:
     typedef vl_unordered_map<const AstVarScope*, LifePostLocation> PostLocMap;
     PostLocMap m_assignposts;  // AssignPost dly var locations
 
+    // Candidates for delayed array set flags, see squashArraySets
+    std::vector<AstAssignPre*> m_preZeros;  // AssignPre of zero to a var, in visit order
+    typedef vl_unordered_map<const AstVarScope*, std::vector<AstNode*> > NodeMap;
+    NodeMap m_preps;  // AssignPre's of each varscope
+    NodeMap m_constWrites;  // Assigns of a constant to each varscope
+    NodeMap m_condIfs;  // IFs on just the value of each varscope
+    typedef vl_unordered_map<const AstVarRef*, LifeLocation> RefLocMap;
+    RefLocMap m_lvalueLocs;  // Location of each write
+
     const V3Graph* m_mtasksGraphp;  // Mtask tracking graph
     vl_unique_ptr<GraphPathChecker> m_checker;
 
@@ -257,6 +295,103 @@ private:
         }
     }
 
+    void squashArraySets() {
+        std::set<const AstVarScope*> doneArrays;  // Arrays with moved stores, so stale locations
+        for (std::vector<AstAssignPre*>::iterator it = m_preZeros.begin(); it != m_preZeros.end();
+             ++it) {
+            AstAssignPre* prep = *it;
+            AstVarScope* setVscp = VN_CAST(prep->lhsp(), VarRef)->varScopep();
+
+            // Scrunch these:
+            //  X0:  __Vdlyvset__mem__v0 = 0;  // AssignPre
+            //  X1:  __Vdlyvval__mem__v0 = d;
+            //       __Vdlyvset__mem__v0 = 1;
+            //       __Vdlyvdim0__mem__v0 = a;
+            //      ... {no reads or writes of mem, or writes of the store's other vars}
+            //  X2:  if (__Vdlyvset__mem__v0) mem[__Vdlyvdim0__mem__v0] = __Vdlyvval__mem__v0;
+            //
+            // Into just this:
+            //  X1:  __Vdlyvval__mem__v0 = d;
+            //       __Vdlyvdim0__mem__v0 = a;
+            //       mem[__Vdlyvdim0__mem__v0] = __Vdlyvval__mem__v0;
+
+            // The flag must be set once, and only read by the IF
+            const std::vector<AstNode*>& setps = m_constWrites[setVscp];
+            const std::vector<AstNode*>& ifps = m_condIfs[setVscp];
+            if (m_preps[setVscp].size() != 1 || setps.size() != 1 || ifps.size() != 1
+                || m_writes[setVscp].size() != 1 || m_reads[setVscp].size() != 1) {
+                continue;
+            }
+            AstAssign* setp = VN_CAST(setps[0], Assign);
+            if (!VN_CAST(setp->rhsp(), Const)->num().isNeqZero()) continue;
+            AstIf* ifp = VN_CAST(ifps[0], If);
+            AstNodeAssign* storep = VN_CAST(ifp->ifsp(), NodeAssign);
+            if (ifp->elsesp() || !storep || storep->nextp()) continue;
+            AstNode* fromp = storep->lhsp();
+            if (AstSel* selp = VN_CAST(fromp, Sel)) fromp = selp->fromp();
+            if (!VN_IS(fromp, ArraySel)) continue;
+            while (AstArraySel* aselp = VN_CAST(fromp, ArraySel)) fromp = aselp->fromp();
+            AstVarRef* arrayRefp = VN_CAST(fromp, VarRef);
+            if (!arrayRefp || doneArrays.find(arrayRefp->varScopep()) != doneArrays.end()) {
+                continue;
+            }
+            AstVarScope* arrayVscp = arrayRefp->varScopep();
+
+            // The store will follow the assignments computing it
+            std::set<AstVarScope*> storeReads;
+            LifePostReadVisitor(storep, storeReads /*ref*/);
+            AstNode* lastp = setp;
+            std::set<LifeLocation> runLocs;
+            for (AstNode* stmtp = setp->nextp(); stmtp; stmtp = stmtp->nextp()) {
+                AstAssign* assp = VN_CAST(stmtp, Assign);
+                AstVarRef* lhsp = assp ? VN_CAST(assp->lhsp(), VarRef) : NULL;
+                if (!lhsp || storeReads.find(lhsp->varScopep()) == storeReads.end()) break;
+                RefLocMap::iterator locIt = m_lvalueLocs.find(lhsp);
+                if (locIt == m_lvalueLocs.end()) break;
+                runLocs.insert(locIt->second);
+                lastp = stmtp;
+            }
+
+            // Between the flag being set and the IF, the array must be untouched,
+            // and the store's other variables must not change, so it may move.
+            std::set<LifeLocation> setLocs = m_writes[setVscp];
+            LifeLocation ifLoc = *m_reads[setVscp].begin();
+            bool canScrunch = true;
+            for (std::set<AstVarScope*>::iterator vit = storeReads.begin();
+                 canScrunch && vit != storeReads.end(); ++vit) {
+                const std::set<LifeLocation>& locs = m_writes[*vit];
+                for (std::set<LifeLocation>::const_iterator lit = locs.begin(); lit != locs.end();
+                     ++lit) {
+                    if (runLocs.find(*lit) != runLocs.end()) continue;
+                    if (!outsideCriticalArea(*lit, setLocs, ifLoc)) {
+                        canScrunch = false;
+                        break;
+                    }
+                }
+            }
+            for (int write = 0; write < 2 && canScrunch; ++write) {
+                const std::set<LifeLocation>& locs
+                    = write ? m_writes[arrayVscp] : m_reads[arrayVscp];
+                for (std::set<LifeLocation>::const_iterator lit = locs.begin(); lit != locs.end();
+                     ++lit) {
+                    if (!outsideCriticalArea(*lit, setLocs, ifLoc)) {
+                        canScrunch = false;
+                        break;
+                    }
+                }
+            }
+            if (!canScrunch) continue;
+
+            UINFO(4, "    MOVE " << storep << endl);
+            doneArrays.insert(arrayVscp);
+            lastp->addNextHere(storep->unlinkFrBack());
+            VL_DO_DANGLING(ifp->unlinkFrBack()->deleteTree(), ifp);
+            VL_DO_DANGLING(setp->unlinkFrBack()->deleteTree(), setp);
+            VL_DO_DANGLING(prep->unlinkFrBack()->deleteTree(), prep);
+            ++m_statSetDel;
+        }
+    }
+
     // VISITORS
     virtual void visit(AstTopScope* nodep) VL_OVERRIDE {
         AstNode::user4ClearTree();  // user4p() used on entire tree
@@ -278,6 +413,7 @@ private:
         // to indicate we should replace these dly vars with their original
         // variables.
         squashAssignposts();
+        squashArraySets();
 
         // Replace any node4p varscopes with the new scope
         LifePostElimVisitor visitor(nodep);
@@ -290,6 +426,7 @@ private:
         LifeLocation loc(m_execMTaskp, ++m_sequence);
         if (nodep->lvalue()) {
             m_writes[vscp].insert(loc);
+            m_lvalueLocs[nodep] = loc;
         } else {
             m_reads[vscp].insert(loc);
         }
@@ -300,6 +437,24 @@ private:
         // The pre-assignment into the dly var should not count as its
         // first write; we only want to consider reads and writes that
         // would still happen if the dly var were eliminated.
+        if (AstVarRef* lhsp = VN_CAST(nodep->lhsp(), VarRef)) {
+            m_preps[lhsp->varScopep()].push_back(nodep);
+            AstConst* constp = VN_CAST(nodep->rhsp(), Const);
+            if (constp && constp->num().isEqZero()) m_preZeros.push_back(nodep);
+        }
+    }
+    virtual void visit(AstAssign* nodep) VL_OVERRIDE {
+        AstVarRef* lhsp = VN_CAST(nodep->lhsp(), VarRef);
+        if (lhsp && VN_IS(nodep->rhsp(), Const)) {
+            m_constWrites[lhsp->varScopep()].push_back(nodep);
+        }
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstIf* nodep) VL_OVERRIDE {
+        if (AstVarRef* condp = VN_CAST(nodep->condp(), VarRef)) {
+            m_condIfs[condp->varScopep()].push_back(nodep);
+        }
+        iterateChildren(nodep);
     }
     virtual void visit(AstAssignPost* nodep) VL_OVERRIDE {
         // Don't record ASSIGNPOST in the read/write maps, record them in a
@@ -357,6 +512,7 @@ public:
     }
     virtual ~LifePostDlyVisitor() {
         V3Stats::addStat("Optimizations, Lifetime postassign deletions", m_statAssnDel);
+        V3Stats::addStat("Optimizations, Lifetime delayed array set deletions", m_statSetDel);
     }
 };
 
@@ -133,6 +133,75 @@ void V3LinkLevel::timescaling(const ModVec& mods) {
 //######################################################################
 // Wrapping
 
+void V3LinkLevel::cosimCut(AstNetlist* rootp) {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    // Each cut instance under a top module is removed, and its pins become
+    // ports of the top module named <instance>__<port>, with the opposite
+    // direction, so a --cosim link can carry them to the instance's model
+    const V3StringList& cuts = v3Global.opt.cosimCuts();
+    for (V3StringList::const_iterator it = cuts.begin(); it != cuts.end(); ++it) {
+        AstCell* cellp = NULL;
+        AstNodeModule* topmodp = NULL;
+        for (AstNodeModule* modp = rootp->modulesp(); modp && modp->level() <= 2 && !cellp;
+             modp = VN_CAST(modp->nextp(), NodeModule)) {
+            if (VN_IS(modp, Package)) continue;
+            for (AstNode* subnodep = modp->stmtsp(); subnodep; subnodep = subnodep->nextp()) {
+                AstCell* subcellp = VN_CAST(subnodep, Cell);
+                if (subcellp && subcellp->origName() == *it) {
+                    cellp = subcellp;
+                    topmodp = modp;
+                    break;
+                }
+            }
+        }
+        if (!cellp) {
+            v3error("--cosim-cut instance not found directly under the top module: " << *it);
+            continue;
+        }
+        UINFO(4, "  Cut " << cellp << endl);
+        if (cellp->rangep()) {
+            cellp->v3error("Unsupported: --cosim-cut of an array of instances: "
+                           << cellp->prettyNameQ());
+            continue;
+        }
+        for (AstPin* pinp = cellp->pinsp(); pinp; pinp = VN_CAST(pinp->nextp(), Pin)) {
+            AstVar* portp = pinp->modVarp();
+            AstNode* exprp = pinp->exprp();
+            if (!portp || !exprp) continue;  // Unconnected; the partition sees its default
+            FileLine* fl = pinp->fileline();
+            if (!portp->isIO() || portp->isInoutish() || portp->isDouble() || portp->isString()
+                || VN_IS(portp->dtypeSkipRefp(), UnpackArrayDType)) {
+                pinp->v3error("Unsupported: --cosim-cut of an inout, real, string, unpacked"
+                              " array or interface port: "
+                              << portp->prettyNameQ());
+                continue;
+            }
+            if (exprp->width() != portp->width()) {
+                pinp->v3error("Unsupported: --cosim-cut of a port connected to an expression"
+                              " of a different width: "
+                              << portp->prettyNameQ());
+                continue;
+            }
+            AstVar* varp = portp->cloneTree(false);
+            varp->name(cellp->name() + "__" + portp->name());
+            varp->direction(portp->isNonOutput() ? VDirection::OUTPUT : VDirection::INPUT);
+            varp->primaryIO(false);
+            topmodp->addStmtp(varp);
+            if (portp->isNonOutput()) {
+                // Instance input, the partition reads what the top drives
+                topmodp->addStmtp(new AstAssignW(fl, new AstVarRef(fl, varp, true),
+                                                 exprp->unlinkFrBack()));
+            } else {
+                topmodp->addStmtp(new AstAssignW(fl, exprp->unlinkFrBack(),
+                                                 new AstVarRef(fl, varp, false)));
+            }
+        }
+        // The instanced module, if otherwise unused, is later removed by V3Dead
+        VL_DO_DANGLING(cellp->unlinkFrBack()->deleteTree(), cellp);
+    }
+    V3Global::dumpCheckGlobalTree("cosimcut", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
+
 void V3LinkLevel::wrapTop(AstNetlist* rootp) {
     UINFO(2, __FUNCTION__ << ": " << endl);
     // We do ONLY the top module
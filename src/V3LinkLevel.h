@@ -35,6 +35,7 @@ private:
 
 public:
     static void modSortByLevel();
+    static void cosimCut(AstNetlist* rootp);
     static void wrapTop(AstNetlist* rootp);
 };
 
@@ -50,6 +50,7 @@ private:
 
     // STATE
     AstVar* m_varp;  // Variable we're under
+    bool m_varObserve;  // Variable we're under has public_observe
     ImplTypedefMap m_implTypedef;  // Created typedefs for each <container,name>
     FileLineSet m_filelines;  // Filelines that have been seen
     bool m_inAlways;  // Inside an always
@@ -63,6 +64,24 @@ private:
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
 
+    void addObserve(AstVar* nodep) {
+        // Rather than making the signal public, which would stop it being
+        // optimized, C code reads a public copy updated after the signal
+        // changes. Ports and task variables are simply made public.
+        if (!VN_IS(m_modp, Module) || m_ftaskp || nodep->isIO() || !nodep->childDTypep()) {
+            nodep->sigUserRdPublic(true);
+            return;
+        }
+        FileLine* fl = nodep->fileline();
+        AstVar* newp = new AstVar(fl, AstVarType::VAR, nodep->name() + AstVar::observeSuffix(),
+                                  VFlagChildDType(), nodep->childDTypep()->cloneTree(false));
+        newp->sigObserve(true);
+        newp->trace(false);  // The signal itself is traced
+        nodep->addNextHere(newp);
+        newp->addNextHere(new AstAssignW(fl, new AstVarRef(fl, newp->name(), true),
+                                         new AstVarRef(fl, nodep->name(), false)));
+    }
+
     void cleanFileline(AstNode* nodep) {
         if (!nodep->user2SetOnce()) {  // Process once
             // We make all filelines unique per AstNode.  This allows us to
@@ -210,9 +229,11 @@ private:
             nodep->trace(false);
         }
         m_varp = nodep;
+        m_varObserve = false;
 
         iterateChildren(nodep);
         m_varp = NULL;
+        if (m_varObserve) addObserve(nodep);
         // temporaries under an always aren't expected to be blocking
         if (m_inAlways) nodep->fileline()->modifyWarnOff(V3ErrorCode::BLKSEQ, true);
         if (nodep->valuep()) {
@@ -289,6 +310,10 @@ private:
             UASSERT_OBJ(m_varp, nodep, "Attribute not attached to variable");
             m_varp->sigUserRWPublic(true);
             VL_DO_DANGLING(nodep->unlinkFrBack()->deleteTree(), nodep);
+        } else if (nodep->attrType() == AstAttrType::VAR_PUBLIC_OBSERVE) {
+            UASSERT_OBJ(m_varp, nodep, "Attribute not attached to variable");
+            m_varObserve = true;
+            VL_DO_DANGLING(nodep->unlinkFrBack()->deleteTree(), nodep);
         } else if (nodep->attrType() == AstAttrType::VAR_ISOLATE_ASSIGNMENTS) {
             UASSERT_OBJ(m_varp, nodep, "Attribute not attached to variable");
             m_varp->attrIsolateAssign(true);
@@ -297,6 +322,10 @@ private:
             UASSERT_OBJ(m_varp, nodep, "Attribute not attached to variable");
             m_varp->attrSFormat(true);
             VL_DO_DANGLING(nodep->unlinkFrBack()->deleteTree(), nodep);
+        } else if (nodep->attrType() == AstAttrType::VAR_SPARSE) {
+            UASSERT_OBJ(m_varp, nodep, "Attribute not attached to variable");
+            m_varp->attrSparse(true);
+            VL_DO_DANGLING(nodep->unlinkFrBack()->deleteTree(), nodep);
         } else if (nodep->attrType() == AstAttrType::VAR_SPLIT_VAR) {
             UASSERT_OBJ(m_varp, nodep, "Attribute not attached to variable");
             if (!VN_IS(m_modp, Module)) {
@@ -539,6 +568,7 @@ public:
     // CONSTRUCTORS
     explicit LinkParseVisitor(AstNetlist* rootp) {
         m_varp = NULL;
+        m_varObserve = false;
         m_modp = NULL;
         m_ftaskp = NULL;
         m_dtypep = NULL;
@@ -19,6 +19,9 @@
 //             if only referenced in a CFUNC, make it local to that CFUNC
 //          VAR(others
 //             if non-public, set before used, and in single CFUNC, make it local
+//          VAR(any, referenced in several CFUNCs
+//             if set before used in each CFUNC, so no value passes between
+//             them, and none make calls, make a separate local in each
 //
 //*************************************************************************
 
@@ -31,6 +34,8 @@
 #include "V3Ast.h"
 
 #include <cstdarg>
+#include <map>
+#include <set>
 #include <vector>
 
 //######################################################################
@@ -56,6 +61,8 @@ protected:
             int m_notStd : 1;  // NOT optimizable if a non-blocktemp signal
             int m_stdFuncAsn : 1;  // Found simple assignment
             int m_done : 1;  // Removed
+            int m_multiFunc : 1;  // Referenced in more than one function
+            int m_notMulti : 1;  // NOT optimizable if in more than one function
         };
         // cppcheck-suppress unusedStructMember
         uint32_t m_flags;
@@ -100,10 +107,23 @@ private:
     AstUser2InUse m_inuser2;
     AstUser4InUse m_inuser4;
 
+    // TYPES
+    typedef std::pair<const AstVar*, const AstCFunc*> VarFunc;
+    typedef std::map<VarFunc, AstVarRef*> FirstAsnMap;
+    typedef std::map<const AstVar*, std::vector<AstCFunc*> > VarFuncsMap;
+    typedef std::vector<std::pair<AstCFunc*, AstVarRef*> > FuncRefs;
+    typedef std::map<const AstVar*, FuncRefs> VarRefsMap;
+
     // STATE
     VDouble0 m_statLocVars;  // Statistic tracking
+    VDouble0 m_statMultiVars;  // Statistic tracking
     AstCFunc* m_cfuncp;  // Current active function
     std::vector<AstVar*> m_varps;  // List of variables to consider for deletion
+    FirstAsnMap m_firstAsns;  // First simple assignment to each variable in each function
+    std::set<VarFunc> m_varFuncSeen;  // Variable has been referenced in function
+    VarFuncsMap m_varFuncs;  // Functions referencing each variable, in order
+    VarRefsMap m_varRefs;  // References to each variable, with their function
+    std::set<const AstCFunc*> m_callingFuncs;  // Functions that call other functions
 
     // METHODS
     void clearOptimizable(AstVar* nodep, const char* reason) {
@@ -118,6 +138,41 @@ private:
         flags.m_notStd = true;
         flags.setNodeFlags(nodep);
     }
+    void clearMultiOptimizable(AstVar* nodep, const char* reason) {
+        UINFO(4, "       NoMulti " << reason << " " << nodep << endl);
+        VarFlags flags(nodep);
+        flags.m_notMulti = true;
+        flags.setNodeFlags(nodep);
+    }
+    bool multiOptimizable(AstVar* nodep) {
+        // Each function sets it before use, so it never carries a value from
+        // one to another, unless a function it is live in calls another
+        const std::vector<AstCFunc*>& funcps = m_varFuncs[nodep];
+        for (std::vector<AstCFunc*>::const_iterator it = funcps.begin(); it != funcps.end();
+             ++it) {
+            if (m_callingFuncs.find(*it) != m_callingFuncs.end()) return false;
+        }
+        return true;
+    }
+    void moveVarMulti(AstVar* nodep) {
+        // Separate local in each function
+        const std::vector<AstCFunc*>& funcps = m_varFuncs[nodep];
+        UINFO(4, "  ModVar->BlkVars " << funcps.size() << " " << nodep << endl);
+        ++m_statMultiVars;
+        nodep->unlinkFrBack();
+        std::map<const AstCFunc*, AstVar*> newVarps;
+        for (std::vector<AstCFunc*>::const_iterator it = funcps.begin(); it != funcps.end();
+             ++it) {
+            AstVar* newVarp = (it == funcps.begin()) ? nodep : nodep->cloneTree(false);
+            (*it)->addInitsp(newVarp);
+            newVarps[*it] = newVarp;
+        }
+        // Point each reference at its own function's copy
+        const FuncRefs& refs = m_varRefs[nodep];
+        for (FuncRefs::const_iterator it = refs.begin(); it != refs.end(); ++it) {
+            it->second->varp(newVarps[it->first]);
+        }
+    }
     void moveVars() {
         for (std::vector<AstVar*>::iterator it = m_varps.begin(); it != m_varps.end(); ++it) {
             AstVar* nodep = *it;
@@ -125,10 +180,16 @@ private:
             if (!VarFlags(nodep).m_stdFuncAsn) clearStdOptimizable(nodep, "NoStdAssign");
             VarFlags flags(nodep);
 
-            if ((nodep->isMovableToBlock()  // Blocktemp
-                 || !flags.m_notStd)  // Or used only in block
-                && !flags.m_notOpt  // Optimizable
-                && !nodep->isClassMember() && nodep->user1p()) {  // Single cfunc
+            if (flags.m_multiFunc && !flags.m_notOpt && !flags.m_notMulti
+                && !nodep->isClassMember() && multiOptimizable(nodep)) {
+                moveVarMulti(nodep);
+                flags.m_done = true;
+                flags.setNodeFlags(nodep);
+            } else if ((nodep->isMovableToBlock()  // Blocktemp
+                        || !flags.m_notStd)  // Or used only in block
+                       && !flags.m_notOpt  // Optimizable
+                       && !flags.m_multiFunc && !nodep->isClassMember()
+                       && nodep->user1p()) {  // Single cfunc
                 // We don't need to test for tracing; it would be in the tracefunc if it was needed
                 UINFO(4, "  ModVar->BlkVar " << nodep << endl);
                 ++m_statLocVars;
@@ -143,6 +204,10 @@ private:
             }
         }
         m_varps.clear();
+        m_firstAsns.clear();
+        m_varFuncSeen.clear();
+        m_varFuncs.clear();
+        m_varRefs.clear();
     }
 
     // VISITORS
@@ -169,6 +234,9 @@ private:
             if (VN_IS(nodep, NodeAssign)) {
                 if (AstVarRef* varrefp = VN_CAST(VN_CAST(nodep, NodeAssign)->lhsp(), VarRef)) {
                     UASSERT_OBJ(varrefp->lvalue(), varrefp, "LHS assignment not lvalue");
+                    // First assignment in this function
+                    m_firstAsns.insert(
+                        std::make_pair(VarFunc(varrefp->varp(), m_cfuncp), varrefp));
                     if (!varrefp->varp()->user4p()) {
                         UINFO(4, "      FuncAsn " << varrefp << endl);
                         varrefp->varp()->user4p(varrefp);
@@ -205,7 +273,20 @@ private:
                     // Same usage
                 } else {
                     // Used in multiple functions
-                    clearOptimizable(nodep->varp(), "BVmultiF");
+                    UINFO(4, "       MultiF " << nodep->varp() << endl);
+                    VarFlags flags(nodep->varp());
+                    flags.m_multiFunc = true;
+                    flags.setNodeFlags(nodep->varp());
+                }
+                // For multiple functions, first varref in each must be its first assignment
+                m_varRefs[nodep->varp()].push_back(std::make_pair(m_cfuncp, nodep));
+                const VarFunc key(nodep->varp(), m_cfuncp);
+                if (m_varFuncSeen.insert(key).second) {
+                    m_varFuncs[nodep->varp()].push_back(m_cfuncp);
+                    FirstAsnMap::const_iterator it = m_firstAsns.find(key);
+                    if (it == m_firstAsns.end() || it->second != nodep) {
+                        clearMultiOptimizable(nodep->varp(), "notFirstAsnInFunc");
+                    }
                 }
                 // First varref in function must be assignment found earlier
                 AstVarRef* firstasn = static_cast<AstVarRef*>(nodep->varp()->user4p());
@@ -217,6 +298,10 @@ private:
         }
         // No iterate; Don't want varrefs under it
     }
+    virtual void visit(AstNodeCCall* nodep) VL_OVERRIDE {
+        if (m_cfuncp) m_callingFuncs.insert(m_cfuncp);
+        iterateChildren(nodep);
+    }
     virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
 
 public:
@@ -227,6 +312,8 @@ public:
     }
     virtual ~LocalizeVisitor() {
         V3Stats::addStat("Optimizations, Vars localized", m_statLocVars);
+        V3Stats::addStat("Optimizations, Vars localized into multiple functions",
+                         m_statMultiVars);
     }
 };
 
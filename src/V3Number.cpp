@@ -1156,6 +1156,15 @@ V3Number& V3Number::opNot(const V3Number& lhs) {
     NUM_ASSERT_OP_ARGS1(lhs);
     NUM_ASSERT_LOGIC_ARGS1(lhs);
     // op i, L(lhs) bit return
+    if (wordsCover(lhs)) {
+        for (int i = 0; i < words(); ++i) {
+            uint32_t zero = ~lhs.m_value[i] & ~lhs.m_valueX[i];
+            m_value[i] = zero | lhs.m_valueX[i];  // 1 where was 0, x where was x/z
+            m_valueX[i] = lhs.m_valueX[i];
+        }
+        opCleanThis();
+        return *this;
+    }
     setZero();
     for (int bit = 0; bit < this->width(); bit++) {
         if (lhs.bitIs0(bit)) {
@@ -1171,6 +1180,18 @@ V3Number& V3Number::opAnd(const V3Number& lhs, const V3Number& rhs) {
     NUM_ASSERT_OP_ARGS2(lhs, rhs);
     NUM_ASSERT_LOGIC_ARGS2(lhs, rhs);
     // i op j, max(L(lhs),L(rhs)) bit return, careful need to X/Z extend.
+    if (wordsCover(lhs, rhs)) {
+        for (int i = 0; i < words(); ++i) {
+            uint32_t one = lhs.m_value[i] & ~lhs.m_valueX[i] & rhs.m_value[i] & ~rhs.m_valueX[i];
+            uint32_t zero = (~lhs.m_value[i] & ~lhs.m_valueX[i])  //
+                            | (~rhs.m_value[i] & ~rhs.m_valueX[i]);
+            uint32_t x = ~one & ~zero;
+            m_value[i] = one | x;
+            m_valueX[i] = x;
+        }
+        opCleanThis();
+        return *this;
+    }
     setZero();
     for (int bit = 0; bit < this->width(); bit++) {
         if (lhs.bitIs1(bit) && rhs.bitIs1(bit)) {
@@ -1187,6 +1208,19 @@ V3Number& V3Number::opOr(const V3Number& lhs, const V3Number& rhs) {
     NUM_ASSERT_OP_ARGS2(lhs, rhs);
     NUM_ASSERT_LOGIC_ARGS2(lhs, rhs);
     // i op j, max(L(lhs),L(rhs)) bit return, careful need to X/Z extend.
+    if (wordsCover(lhs, rhs)) {
+        for (int i = 0; i < words(); ++i) {
+            uint32_t one = (lhs.m_value[i] & ~lhs.m_valueX[i])  //
+                           | (rhs.m_value[i] & ~rhs.m_valueX[i]);
+            uint32_t zero = ~lhs.m_value[i] & ~lhs.m_valueX[i] & ~rhs.m_value[i]
+                            & ~rhs.m_valueX[i];
+            uint32_t x = ~one & ~zero;
+            m_value[i] = one | x;
+            m_valueX[i] = x;
+        }
+        opCleanThis();
+        return *this;
+    }
     setZero();
     for (int bit = 0; bit < this->width(); bit++) {
         if (lhs.bitIs1(bit) || rhs.bitIs1(bit)) {
@@ -1212,6 +1246,18 @@ V3Number& V3Number::opXor(const V3Number& lhs, const V3Number& rhs) {
     // i op j, max(L(lhs),L(rhs)) bit return, careful need to X/Z extend.
     NUM_ASSERT_OP_ARGS2(lhs, rhs);
     NUM_ASSERT_LOGIC_ARGS2(lhs, rhs);
+    if (wordsCover(lhs, rhs)) {
+        for (int i = 0; i < words(); ++i) {
+            uint32_t lknown = ~lhs.m_valueX[i];
+            uint32_t rknown = ~rhs.m_valueX[i];
+            uint32_t one = (lhs.m_value[i] ^ rhs.m_value[i]) & lknown & rknown;
+            uint32_t x = lhs.m_valueX[i] & rhs.m_valueX[i];  // Else zero, as bit loop below
+            m_value[i] = one | x;
+            m_valueX[i] = x;
+        }
+        opCleanThis();
+        return *this;
+    }
     setZero();
     for (int bit = 0; bit < this->width(); bit++) {
         if (lhs.bitIs1(bit) && rhs.bitIs0(bit)) {
@@ -1467,6 +1513,12 @@ V3Number& V3Number::opEq(const V3Number& lhs, const V3Number& rhs) {
     NUM_ASSERT_OP_ARGS2(lhs, rhs);
     if (lhs.isString()) return opEqN(lhs, rhs);
     if (lhs.isDouble()) return opEqD(lhs, rhs);
+    if (!lhs.isFourState() && !rhs.isFourState()) {
+        for (int i = 0; i < std::max(lhs.words(), rhs.words()); ++i) {
+            if (lhs.cleanWord(i) != rhs.cleanWord(i)) return setSingleBits(0);
+        }
+        return setSingleBits(1);
+    }
     char outc = 1;
     for (int bit = 0; bit < std::max(lhs.width(), rhs.width()); bit++) {
         if (lhs.bitIs1(bit) && rhs.bitIs0(bit)) {
@@ -1489,6 +1541,12 @@ V3Number& V3Number::opNeq(const V3Number& lhs, const V3Number& rhs) {
     NUM_ASSERT_OP_ARGS2(lhs, rhs);
     if (lhs.isString()) return opNeqN(lhs, rhs);
     if (lhs.isDouble()) return opNeqD(lhs, rhs);
+    if (!lhs.isFourState() && !rhs.isFourState()) {
+        for (int i = 0; i < std::max(lhs.words(), rhs.words()); ++i) {
+            if (lhs.cleanWord(i) != rhs.cleanWord(i)) return setSingleBits(1);
+        }
+        return setSingleBits(0);
+    }
     char outc = 0;
     for (int bit = 0; bit < std::max(lhs.width(), rhs.width()); bit++) {
         if (lhs.bitIs1(bit) && rhs.bitIs0(bit)) {
@@ -1576,6 +1634,14 @@ V3Number& V3Number::opGt(const V3Number& lhs, const V3Number& rhs) {
     // i op j, 1 bit return, max(L(lhs),L(rhs)) calculation, careful need to X/Z extend.
     NUM_ASSERT_OP_ARGS2(lhs, rhs);
     NUM_ASSERT_LOGIC_ARGS2(lhs, rhs);
+    if (!lhs.isFourState() && !rhs.isFourState()) {
+        for (int i = std::max(lhs.words(), rhs.words()) - 1; i >= 0; --i) {
+            uint32_t lword = lhs.cleanWord(i);
+            uint32_t rword = rhs.cleanWord(i);
+            if (lword != rword) return setSingleBits(lword > rword);
+        }
+        return setSingleBits(0);
+    }
     char outc = 0;
     for (int bit = 0; bit < std::max(lhs.width(), rhs.width()); bit++) {
         if (lhs.bitIs1(bit) && rhs.bitIs0(bit)) outc = 1;
@@ -1752,6 +1818,17 @@ V3Number& V3Number::opAdd(const V3Number& lhs, const V3Number& rhs) {
     NUM_ASSERT_OP_ARGS2(lhs, rhs);
     NUM_ASSERT_LOGIC_ARGS2(lhs, rhs);
     if (lhs.isFourState() || rhs.isFourState()) return setAllBitsX();
+    if (wordsCover(lhs, rhs)) {
+        vluint64_t carry = 0;
+        for (int i = 0; i < words(); ++i) {
+            carry += static_cast<vluint64_t>(lhs.m_value[i]) + rhs.m_value[i];
+            m_value[i] = static_cast<uint32_t>(carry);
+            m_valueX[i] = 0;
+            carry >>= 32;
+        }
+        opCleanThis();
+        return *this;
+    }
     setZero();
     // Addem
     int carry = 0;
@@ -2083,6 +2160,19 @@ V3Number& V3Number::opAssignNonXZ(const V3Number& lhs, bool ignoreXZ) {
     // to itself; V3Simulate does this when hits "foo=foo;"
     // So no: NUM_ASSERT_OP_ARGS1(lhs);
     if (this != &lhs) {
+        if (!isString() && !lhs.isString() && lhs.width() == width()) {
+            for (int i = 0; i < words(); ++i) {
+                if (ignoreXZ) {
+                    m_value[i] = lhs.m_value[i] & ~lhs.m_valueX[i];
+                    m_valueX[i] = 0;
+                } else {
+                    m_value[i] = lhs.m_value[i];
+                    m_valueX[i] = lhs.m_valueX[i];
+                }
+            }
+            if (!isDouble()) opCleanThis();
+            return *this;
+        }
         setZero();
         if (isString()) {
             m_stringVal = lhs.m_stringVal;
@@ -23,6 +23,7 @@
 #include "V3Error.h"
 
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <vector>
 
@@ -37,6 +38,55 @@ inline bool v3EpsilonEqual(double a, double b) {
 
 class AstNode;
 
+class V3NumberWords {
+    // Storage of a number's words, held inline when small so most numbers
+    // need no heap allocation.  Grows like std::vector, new words are zero.
+    enum { INLINE_WORDS = 3 };  // 64 bits, plus the spare word V3Number keeps
+    uint32_t m_size;  // Words in use
+    uint32_t m_capacity;  // Words allocated
+    uint32_t* m_datap;  // m_inline, or heap storage when larger
+    uint32_t m_inline[INLINE_WORDS];
+
+public:
+    // CONSTRUCTORS
+    V3NumberWords()
+        : m_size(0)
+        , m_capacity(INLINE_WORDS)
+        , m_datap(m_inline) {}
+    V3NumberWords(const V3NumberWords& rhs)
+        : m_size(0)
+        , m_capacity(INLINE_WORDS)
+        , m_datap(m_inline) {
+        *this = rhs;
+    }
+    V3NumberWords& operator=(const V3NumberWords& rhs) {
+        if (this != &rhs) {
+            m_size = 0;
+            resize(rhs.m_size);
+            memcpy(m_datap, rhs.m_datap, rhs.m_size * sizeof(uint32_t));
+        }
+        return *this;
+    }
+    ~V3NumberWords() {
+        if (m_datap != m_inline) delete[] m_datap;
+    }
+    // METHODS
+    size_t size() const { return m_size; }
+    void resize(size_t size) {
+        if (VL_UNLIKELY(size > m_capacity)) {
+            uint32_t* newp = new uint32_t[size];
+            memcpy(newp, m_datap, m_size * sizeof(uint32_t));
+            if (m_datap != m_inline) delete[] m_datap;
+            m_datap = newp;
+            m_capacity = size;
+        }
+        for (size_t i = m_size; i < size; ++i) m_datap[i] = 0;
+        m_size = size;
+    }
+    uint32_t& operator[](size_t i) { return m_datap[i]; }
+    const uint32_t& operator[](size_t i) const { return m_datap[i]; }
+};
+
 class V3Number {
     // Large 4-state number handling
     int m_width;  // Width as specified/calculated.
@@ -48,8 +98,8 @@ class V3Number {
     bool m_autoExtend : 1;  // True if SystemVerilog extend-to-any-width
     FileLine* m_fileline;
     AstNode* m_nodep;  // Parent node
-    std::vector<uint32_t> m_value;  // Value, with bit 0 in bit 0 of this vector (unless X/Z)
-    std::vector<uint32_t> m_valueX;  // Each bit is true if it's X or Z, 10=z, 11=x
+    V3NumberWords m_value;  // Value, with bit 0 in bit 0 of this vector (unless X/Z)
+    V3NumberWords m_valueX;  // Each bit is true if it's X or Z, 10=z, 11=x
     string m_stringVal;  // If isString, the value of the string
     // METHODS
     V3Number& setSingleBits(char value);
@@ -151,6 +201,16 @@ private:
 
     int words() const { return ((width() + 31) / 32); }
     uint32_t hiWordMask() const { return VL_MASK_I(width()); }
+    // True if operands cover every result bit, so ops may work a word at a time
+    bool wordsCover(const V3Number& lhs) const { return lhs.width() >= width(); }
+    uint32_t cleanWord(int word) const {
+        // Word of the value, zero above the width, for numbers not four-state
+        if (word >= words()) return 0;
+        return word == words() - 1 ? (m_value[word] & hiWordMask()) : m_value[word];
+    }
+    bool wordsCover(const V3Number& lhs, const V3Number& rhs) const {
+        return lhs.width() >= width() && rhs.width() >= width();
+    }
 
     V3Number& opModDivGuts(const V3Number& lhs, const V3Number& rhs, bool is_modulus);
 
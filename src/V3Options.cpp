@@ -597,6 +597,23 @@ void V3Options::notify() {
         cmdfl->v3error("--make cannot be used together with --build. Suggest see manual");
     }
 
+    if (m_lanes > 1 && m_systemC) {
+        cmdfl->v3error("Unsupported: --lanes with --sc. Suggest use --cc");
+    }
+
+    if (m_cosim && m_systemC) {
+        cmdfl->v3error("Unsupported: --cosim with --sc. Suggest use --cc");
+    }
+
+    if (m_trace && m_traceFormat == TraceFormat::VBT && m_systemC) {
+        cmdfl->v3error("Unsupported: --trace-vbt with --sc. Suggest use --cc");
+    }
+
+    if (m_threadsPipeline && (m_threadsDynamic || m_savable || m_profThreads)) {
+        cmdfl->v3error("Unsupported: --threads-pipeline with --threads-schedule dynamic,"
+                       " --savable or --prof-threads");
+    }
+
     // Make sure at least one make system is enabled
     if (!m_gmake && !m_cmake) m_gmake = true;
 
@@ -826,15 +843,19 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             else if ( onoffb(sw, "-MMD", bflag/*ref*/))         { m_makeDepend = bflag; }
             else if ( onoff (sw, "-MP", flag/*ref*/))           { m_makePhony = flag; }
             else if (!strcmp(sw, "-P"))                         { m_preprocNoLine = true; }
+            else if ( onoff (sw, "-activity-gate", flag/*ref*/)) { m_activityGate = flag; }
             else if ( onoff (sw, "-assert", flag/*ref*/))       { m_assert = flag; }
+            else if ( onoff (sw, "-assert-scopes", flag/*ref*/)) { m_assertScopes = flag; v3Global.dpi(true); }
             else if ( onoff (sw, "-autoflush", flag/*ref*/))    { m_autoflush = flag; }
             else if ( onoff (sw, "-bbox-sys", flag/*ref*/))     { m_bboxSys = flag; }
             else if ( onoff (sw, "-bbox-unsup", flag/*ref*/))   { m_bboxUnsup = flag; }
             else if (!strcmp(sw, "-build"))                     { m_build = true; }
             else if (!strcmp(sw, "-cc"))                        { m_outFormatOk = true; m_systemC = false; }
             else if ( onoff (sw, "-cdc", flag/*ref*/))          { m_cdc = flag; }
+            else if ( onoff (sw, "-cosim", flag/*ref*/))        { m_cosim = flag; }
             else if ( onoff (sw, "-coverage", flag/*ref*/))     { coverage(flag); }
             else if ( onoff (sw, "-coverage-line", flag/*ref*/)){ m_coverageLine = flag; }
+            else if ( onoff (sw, "-coverage-per-thread", flag/*ref*/)){ m_coveragePerThread = flag; }
             else if ( onoff (sw, "-coverage-toggle", flag/*ref*/)){ m_coverageToggle = flag; }
             else if ( onoff (sw, "-coverage-underscore", flag/*ref*/)){ m_coverageUnderscore = flag; }
             else if ( onoff (sw, "-coverage-user", flag/*ref*/)){ m_coverageUser = flag; }
@@ -853,22 +874,32 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             else if ( onoff (sw, "-dpi-hdr-only", flag/*ref*/)) { m_dpiHdrOnly = flag; }
             else if ( onoff (sw, "-dump-defines", flag/*ref*/)) { m_dumpDefines = flag; }
             else if ( onoff (sw, "-dump-tree", flag/*ref*/))    { m_dumpTree = flag ? 3 : 0; }  // Also see --dump-treei
+            else if ( onoff (sw, "-eval-clock", flag/*ref*/))   { m_evalClock = flag; }
             else if ( onoff (sw, "-exe", flag/*ref*/))          { m_exe = flag; }
             else if ( onoff (sw, "-flatten", flag/*ref*/))      { m_flatten = flag; }
+            else if ( onoff (sw, "-hot-cold-vars", flag/*ref*/)) { m_hotColdVars = flag; }
             else if ( onoff (sw, "-ignc", flag/*ref*/))         { m_ignc = flag; }
             else if ( onoff (sw, "-inhibit-sim", flag/*ref*/))  { m_inhibitSim = flag; }
             else if ( onoff (sw, "-lint-only", flag/*ref*/))    { m_lintOnly = flag; }
             else if ( onoff (sw, "-main", flag/*ref*/))         { m_main = flag; }  // Undocumented future
             else if (!strcmp(sw, "-no-pins64"))                 { m_pinsBv = 33; }
             else if ( onoff (sw, "-order-clock-delay", flag/*ref*/)) { m_orderClockDly = flag; }
+            else if ( onoff (sw, "-order-derived-clocks", flag/*ref*/)) { m_orderDerivedClks = flag; }
+            else if ( onoff (sw, "-output-keep-unchanged", flag/*ref*/)) { m_outputKeepUnchanged = flag; }
+            else if ( onoff (sw, "-pch", flag/*ref*/))          { m_pch = flag; }
             else if (!strcmp(sw, "-pins64"))                    { m_pinsBv = 65; }
             else if ( onoff (sw, "-pins-sc-uint", flag/*ref*/)) { m_pinsScUint = flag; if (!m_pinsScBigUint) m_pinsBv = 65; }
             else if ( onoff (sw, "-pins-sc-biguint", flag/*ref*/)){ m_pinsScBigUint = flag; m_pinsBv = 513; }
             else if ( onoff (sw, "-pins-uint8", flag/*ref*/))   { m_pinsUint8 = flag; }
             else if ( onoff (sw, "-pp-comments", flag/*ref*/))  { m_ppComments = flag; }
             else if (!strcmp(sw, "-private"))                   { m_public = false; }
+            else if ( onoff (sw, "-prof-blocks", flag/*ref*/))       { m_profBlocks = flag; }
+            else if ( onoff (sw, "-prof-branches", flag/*ref*/))     { m_profBranches = flag; }
             else if ( onoff (sw, "-prof-cfuncs", flag/*ref*/))       { m_profCFuncs = flag; }
             else if ( onoff (sw, "-profile-cfuncs", flag/*ref*/))    { m_profCFuncs = flag; }  // Undocumented, for backward compat
+            else if ( onoff (sw, "-prof-eval", flag/*ref*/))         { m_profEval = flag; }
+            else if ( onoff (sw, "-prof-live", flag/*ref*/))         { m_profLive = flag; }
+            else if ( onoff (sw, "-prof-sample", flag/*ref*/))       { m_profSample = flag; }
             else if ( onoff (sw, "-prof-threads", flag/*ref*/))      { m_profThreads = flag; }
             else if ( onoff (sw, "-protect-ids", flag/*ref*/))       { m_protectIds = flag; }
             else if ( onoff (sw, "-public", flag/*ref*/))            { m_public = flag; }
@@ -880,12 +911,20 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             else if ( onoff (sw, "-report-unoptflat", flag/*ref*/))  { m_reportUnoptflat = flag; }
             else if ( onoff (sw, "-savable", flag/*ref*/))           { m_savable = flag; }
             else if (!strcmp(sw, "-sc"))                             { m_outFormatOk = true; m_systemC = true; }
+            else if ( onoff (sw, "-share-instances", flag/*ref*/))   { m_shareInstances = flag; }
             else if ( onoffb(sw, "-skip-identical", bflag/*ref*/))   { m_skipIdentical = bflag; }
+            else if ( onoff (sw, "-split-var-auto", flag/*ref*/))    { m_splitVarAuto = flag; }
+            else if ( onoff (sw, "-split-var-fields", flag/*ref*/))  { m_splitVarFields = flag; }
             else if ( onoff (sw, "-stats", flag/*ref*/))             { m_stats = flag; }
             else if ( onoff (sw, "-stats-vars", flag/*ref*/))        { m_statsVars = flag; m_stats |= flag; }
             else if ( onoff (sw, "-structs-unpacked", flag/*ref*/))  { m_structsPacked = flag; }
             else if (!strcmp(sw, "-sv"))                             { m_defaultLanguage = V3LangCode::L1800_2005; }
+            else if ( onoff (sw, "-syms-indirect", flag/*ref*/))     { m_symsIndirect = flag; }
+            else if ( onoff (sw, "-threads-auto", flag/*ref*/))      { m_threadsAuto = flag; }
             else if ( onoff (sw, "-threads-coarsen", flag/*ref*/))   { m_threadsCoarsen = flag; }  // Undocumented, debug
+            else if ( onoff (sw, "-threads-pipeline", flag/*ref*/))  { m_threadsPipeline = flag; }
+            else if ( onoff (sw, "-threads-recompute", flag/*ref*/)) { m_threadsRecompute = flag; }
+            else if ( onoff (sw, "-threads-stable", flag/*ref*/))    { m_threadsStable = flag; }
             else if ( onoff (sw, "-trace", flag/*ref*/))             { m_trace = flag; }
             else if ( onoff (sw, "-trace-coverage", flag/*ref*/))    { m_traceCoverage = flag; }
             else if ( onoff (sw, "-trace-dups", flag/*ref*/))        { m_traceDups = flag; }
@@ -895,8 +934,10 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             else if ( onoff (sw, "-underline-zero", flag/*ref*/))    { m_underlineZero = flag; }  // Undocumented, old Verilator-2
             else if ( onoff (sw, "-verilate", flag/*ref*/))          { m_verilate = flag; }
             else if ( onoff (sw, "-vpi", flag/*ref*/))               { m_vpi = flag; }
+            else if ( onoff (sw, "-vpi-change-hooks", flag/*ref*/))  { m_vpiChangeHooks = flag; }
             else if ( onoff (sw, "-Wpedantic", flag/*ref*/))         { m_pedantic = flag; }
             else if ( onoff (sw, "-x-initial-edge", flag/*ref*/))    { m_xInitialEdge = flag; }
+            else if ( onoff (sw, "-xml-index", flag/*ref*/))         { m_xmlIndex = flag; }
             else if ( onoff (sw, "-xml-only", flag/*ref*/))          { m_xmlOnly = flag; }
             else { hadSwitchPart1 = false; }
             // clang-format on
@@ -917,7 +958,9 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
                     case 'd': m_oDedupe = flag; break;
                     case 'm': m_oAssemble = flag; break;
                     case 'e': m_oCase = flag; break;
+                    case 'f': m_oInlineCFuncs = flag; break;
                     case 'g': m_oGate = flag; break;
+                    case 'h': m_oCombineParams = flag; break;
                     case 'i': m_oInline = flag; break;
                     case 'k': m_oSubstConst = flag; break;
                     case 'l': m_oLife = flag; break;
@@ -929,6 +972,7 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
                     case 't': m_oLifePost = flag; break;
                     case 'u': m_oSubst = flag; break;
                     case 'v': m_oReloop = flag; break;
+                    case 'w': m_oTempReuse = flag; break;
                     case 'x': m_oExpand = flag; break;
                     case 'y': m_oAcycSimp = flag; break;
                     case 'z': m_oLocalize = flag; break;
@@ -956,10 +1000,20 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             } else if (!strcmp(sw, "-converge-limit") && (i + 1) < argc) {
                 shift;
                 m_convergeLimit = atoi(argv[i]);
+            } else if (!strcmp(sw, "-cosim-cut") && (i + 1) < argc) {
+                shift;
+                m_cosimCuts.push_back(argv[i]);
+                m_cosim = true;
             } else if (!strncmp(sw, "-D", 2)) {
                 addDefine(string(sw + strlen("-D")), false);
             } else if (!strcmp(sw, "-debug")) {
                 setDebugMode(3);
+            } else if (!strcmp(sw, "-debug-check-interval") && (i + 1) < argc) {
+                shift;
+                m_debugCheckInterval = atoi(argv[i]);
+                if (m_debugCheckInterval < 1) {
+                    fl->v3fatal("--debug-check-interval must be >= 1: " << argv[i]);
+                }
             } else if (!strcmp(sw, "-debugi") && (i + 1) < argc) {
                 shift;
                 setDebugMode(atoi(argv[i]));
@@ -967,6 +1021,10 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
                 const char* src = sw + strlen("-debugi-");
                 shift;
                 setDebugSrcLevel(src, atoi(argv[i]));
+            } else if (!strcmp(sw, "-delayed-queue") && (i + 1) < argc) {
+                shift;
+                m_delayedQueue = atoi(argv[i]);
+                if (m_delayedQueue < 0) fl->v3fatal("--delayed-queue must be >= 0: " << argv[i]);
             } else if (!strcmp(sw, "-dump-treei") && (i + 1) < argc) {
                 shift;
                 m_dumpTree = atoi(argv[i]);
@@ -1000,6 +1058,9 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             } else if (!strcmp(sw, "-inline-mult") && (i + 1) < argc) {
                 shift;
                 m_inlineMult = atoi(argv[i]);
+            } else if (!strcmp(sw, "-instr-costs") && (i + 1) < argc) {
+                shift;
+                m_instrCosts = argv[i];
             } else if (!strcmp(sw, "-j")) {
                 if ((i + 1) >= argc || !isdigit(argv[i + 1][0])) {  // No value is given
                     m_buildJobs = 0;  // Unlimited parallelism
@@ -1019,6 +1080,10 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
                 m_l2Name = argv[i];
             } else if (!strcmp(sw, "-l2name")) {  // Historical and undocumented
                 m_l2Name = "v";
+            } else if (!strcmp(sw, "-lanes") && (i + 1) < argc) {
+                shift;
+                m_lanes = atoi(argv[i]);
+                if (m_lanes < 1) fl->v3fatal("--lanes must be >= 1: " << argv[i]);
             } else if (!strcmp(sw, "-make")) {
                 shift;
                 if (!strcmp(argv[i], "cmake")) {
@@ -1055,6 +1120,12 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             } else if (!strcmp(sw, "-output-split") && (i + 1) < argc) {
                 shift;
                 m_outputSplit = atoi(argv[i]);
+            } else if (!strcmp(sw, "-output-split-buckets") && (i + 1) < argc) {
+                shift;
+                m_outputSplitBuckets = atoi(argv[i]);
+                if (m_outputSplitBuckets < 0) {
+                    fl->v3fatal("--output-split-buckets must be >= 0: " << argv[i]);
+                }
             } else if (!strcmp(sw, "-output-split-cfuncs") && (i + 1) < argc) {
                 shift;
                 m_outputSplitCFuncs = atoi(argv[i]);
@@ -1080,11 +1151,26 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
                 fl->v3warn(DEPRECATED, "Option --trace-fst-thread is deprecated. "
                                        "Use --trace-fst with --trace-threads > 0.");
                 if (m_traceThreads == 0) m_traceThreads = 1;
+            } else if (!strcmp(sw, "-trace-vbt")) {
+                m_trace = true;
+                m_traceFormat = TraceFormat::VBT;
             } else if (!strcmp(sw, "-trace-threads")) {
                 shift;
                 m_trace = true;
                 m_traceThreads = atoi(argv[i]);
                 if (m_traceThreads < 0) fl->v3fatal("--trace-threads must be >= 0: " << argv[i]);
+            } else if (!strcmp(sw, "-trace-activity-granularity") && (i + 1) < argc) {
+                shift;
+                m_traceActivityGranularity = atoi(argv[i]);
+                if (m_traceActivityGranularity < 0) {
+                    fl->v3fatal("--trace-activity-granularity must be >= 0: " << argv[i]);
+                }
+            } else if (!strcmp(sw, "-trace-coverage-width") && (i + 1) < argc) {
+                shift;
+                m_traceCoverageWidth = atoi(argv[i]);
+                if (m_traceCoverageWidth < 1 || m_traceCoverageWidth > 32) {
+                    fl->v3fatal("--trace-coverage-width must be 1 to 32: " << argv[i]);
+                }
             } else if (!strcmp(sw, "-trace-depth") && (i + 1) < argc) {
                 shift;
                 m_traceDepth = atoi(argv[i]);
@@ -1207,13 +1293,37 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             } else if (!strcmp(sw, "-pipe-filter") && (i + 1) < argc) {
                 shift;
                 m_pipeFilter = argv[i];
+            } else if (!strcmp(sw, "-pp-cache") && (i + 1) < argc) {
+                shift;
+                m_ppCache = argv[i];
             } else if (!strcmp(sw, "-prefix") && (i + 1) < argc) {
                 shift;
                 m_prefix = argv[i];
                 if (m_modPrefix == "") m_modPrefix = m_prefix;
+            } else if (!strcmp(sw, "-prof-branches-feedback") && (i + 1) < argc) {
+                shift;
+                m_profBranchesFeedback = argv[i];
+            } else if (!strcmp(sw, "-prof-threads-feedback") && (i + 1) < argc) {
+                shift;
+                m_profThreadsFeedback = argv[i];
             } else if (!strcmp(sw, "-protect-key") && (i + 1) < argc) {
                 shift;
                 m_protectKey = argv[i];
+            } else if (!strcmp(sw, "-branchless-words") && (i + 1) < argc) {
+                shift;
+                m_branchlessWords = atoi(argv[i]);
+                if (m_branchlessWords < 0) {
+                    fl->v3fatal("--branchless-words must be >= 0: " << argv[i]);
+                }
+            } else if (!strcmp(sw, "-specialize-budget") && (i + 1) < argc) {
+                shift;
+                m_specializeBudget = atoi(argv[i]);
+                if (m_specializeBudget < 0) {
+                    fl->v3fatal("--specialize-budget must be >= 0: " << argv[i]);
+                }
+            } else if (!strcmp(sw, "-stats-json") && (i + 1) < argc) {
+                shift;
+                m_statsJson = argv[i];
             } else if (!strcmp(sw, "-no-threads")) {
                 m_threads = 0;
             } else if (!strcmp(sw, "-threads") && (i + 1) < argc) {
@@ -1239,6 +1349,50 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
                 m_threadsMaxMTasks = atoi(argv[i]);
                 if (m_threadsMaxMTasks < 1)
                     fl->v3fatal("--threads-max-mtasks must be >= 1: " << argv[i]);
+            } else if (!strcmp(sw, "-threads-min-mtask-cost") && (i + 1) < argc) {
+                shift;
+                m_threadsMinMTaskCost = atoi(argv[i]);
+                if (m_threadsMinMTaskCost < 0) {
+                    fl->v3fatal("--threads-min-mtask-cost must be >= 0: " << argv[i]);
+                }
+            } else if (!strcmp(sw, "-threads-schedule") && (i + 1) < argc) {
+                shift;
+                if (!strcmp(argv[i], "static")) {
+                    m_threadsDynamic = false;
+                } else if (!strcmp(argv[i], "dynamic")) {
+                    m_threadsDynamic = true;
+                } else {
+                    fl->v3fatal("Unknown setting for --threads-schedule: " << argv[i]);
+                }
+            } else if (!strcmp(sw, "-threads-var-layout") && (i + 1) < argc) {
+                shift;
+                if (!strcmp(argv[i], "compact")) {
+                    m_threadsVarGroup = false;
+                } else if (!strcmp(argv[i], "grouped")) {
+                    m_threadsVarGroup = true;
+                } else {
+                    fl->v3fatal("Unknown setting for --threads-var-layout: " << argv[i]);
+                }
+            } else if (!strcmp(sw, "-threads-vertex-layout") && (i + 1) < argc) {
+                shift;
+                if (!strcmp(argv[i], "compact")) {
+                    m_threadsVertexGroup = false;
+                    m_threadsVertexPad = false;
+                } else if (!strcmp(argv[i], "grouped")) {
+                    m_threadsVertexGroup = true;
+                    m_threadsVertexPad = false;
+                } else if (!strcmp(argv[i], "padded")) {
+                    m_threadsVertexGroup = false;
+                    m_threadsVertexPad = true;
+                } else {
+                    fl->v3fatal("Unknown setting for --threads-vertex-layout: " << argv[i]);
+                }
+            } else if (!strcmp(sw, "-threads-xthread-cost") && (i + 1) < argc) {
+                shift;
+                m_threadsXthreadCost = atoi(argv[i]);
+                if (m_threadsXthreadCost < 0) {
+                    fl->v3fatal("--threads-xthread-cost must be >= 0: " << argv[i]);
+                }
             } else if (!strcmp(sw, "-timescale") && (i + 1) < argc) {
                 shift;
                 VTimescale unit;
@@ -1265,6 +1419,10 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
             } else if (!strcmp(sw, "-unused-regexp") && (i + 1) < argc) {
                 shift;
                 m_unusedRegexp = argv[i];
+            } else if (!strcmp(sw, "-verilate-jobs") && (i + 1) < argc) {
+                shift;
+                m_verilateJobs = atoi(argv[i]);
+                if (m_verilateJobs < 1) fl->v3fatal("--verilate-jobs must be >= 1: " << argv[i]);
             } else if (!strcmp(sw, "-x-assign") && (i + 1) < argc) {
                 shift;
                 if (!strcmp(argv[i], "0")) {
@@ -1289,6 +1447,15 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
                 } else {
                     fl->v3fatal("Unknown setting for --x-initial: " << argv[i]);
                 }
+            } else if (!strcmp(sw, "-x-mode") && (i + 1) < argc) {
+                shift;
+                if (!strcmp(argv[i], "fast") || !strcmp(argv[i], "unique")) {
+                    m_xMode = argv[i];
+                    m_xAssign = m_xMode;
+                    m_xInitial = m_xMode;
+                } else {
+                    fl->v3fatal("Unknown setting for --x-mode: " << argv[i]);
+                }
             } else if (!strcmp(sw, "-xml-output") && (i + 1) < argc) {
                 shift;
                 m_xmlOutput = argv[i];
@@ -1524,7 +1691,9 @@ void V3Options::showVersion(bool verbose) {
 V3Options::V3Options() {
     m_impp = new V3OptionsImp;
 
+    m_activityGate = false;
     m_assert = false;
+    m_assertScopes = false;
     m_autoflush = false;
     m_bboxSys = false;
     m_bboxUnsup = false;
@@ -1532,7 +1701,9 @@ V3Options::V3Options() {
     m_cdc = false;
     m_cmake = false;
     m_context = true;
+    m_cosim = false;
     m_coverageLine = false;
+    m_coveragePerThread = false;
     m_coverageToggle = false;
     m_coverageUnderscore = false;
     m_coverageUser = false;
@@ -1546,8 +1717,10 @@ V3Options::V3Options() {
     m_decoration = true;
     m_dpiHdrOnly = false;
     m_dumpDefines = false;
+    m_evalClock = false;
     m_exe = false;
     m_flatten = false;
+    m_hotColdVars = false;
     m_ignc = false;
     m_inhibitSim = false;
     m_lintOnly = false;
@@ -1555,7 +1728,10 @@ V3Options::V3Options() {
     m_makePhony = false;
     m_main = false;
     m_orderClockDly = true;
+    m_orderDerivedClks = false;
+    m_outputKeepUnchanged = false;
     m_outFormatOk = false;
+    m_pch = false;
     m_pedantic = false;
     m_pinsBv = 65;
     m_pinsScUint = false;
@@ -1563,6 +1739,11 @@ V3Options::V3Options() {
     m_pinsUint8 = false;
     m_ppComments = false;
     m_profCFuncs = false;
+    m_profEval = false;
+    m_profLive = false;
+    m_profSample = false;
+    m_profBlocks = false;
+    m_profBranches = false;
     m_profThreads = false;
     m_protectIds = false;
     m_preprocOnly = false;
@@ -1574,15 +1755,29 @@ V3Options::V3Options() {
     m_relativeIncludes = false;
     m_reportUnoptflat = false;
     m_savable = false;
+    m_shareInstances = false;
+    m_splitVarAuto = false;
+    m_splitVarFields = false;
     m_stats = false;
     m_statsVars = false;
     m_structsPacked = true;
+    m_symsIndirect = false;
     m_systemC = false;
     m_threads = 0;
     m_threadsDpiPure = true;
     m_threadsDpiUnpure = false;
+    m_threadsAuto = false;
     m_threadsCoarsen = true;
+    m_threadsDynamic = false;
+    m_threadsPipeline = false;
+    m_threadsRecompute = false;
+    m_threadsStable = false;
     m_threadsMaxMTasks = 0;
+    m_threadsMinMTaskCost = 0;
+    m_threadsXthreadCost = 0;
+    m_threadsVarGroup = false;
+    m_threadsVertexGroup = false;
+    m_threadsVertexPad = false;
     m_trace = false;
     m_traceCoverage = false;
     m_traceDups = false;
@@ -1594,25 +1789,36 @@ V3Options::V3Options() {
     m_underlineZero = false;
     m_verilate = true;
     m_vpi = false;
+    m_vpiChangeHooks = false;
     m_xInitialEdge = false;
+    m_xmlIndex = false;
     m_xmlOnly = false;
 
+    m_branchlessWords = 0;
     m_buildJobs = 1;
     m_convergeLimit = 100;
+    m_debugCheckInterval = 1;
+    m_delayedQueue = 0;
     m_dumpTree = 0;
     m_gateStmts = 100;
     m_ifDepth = 0;
     m_inlineMult = 2000;
+    m_lanes = 1;
     m_maxNumWidth = 65536;
     m_moduleRecursion = 100;
     m_outputSplit = 0;
+    m_outputSplitBuckets = 0;
     m_outputSplitCFuncs = 0;
     m_outputSplitCTrace = 0;
+    m_specializeBudget = 0;
+    m_traceActivityGranularity = 0;
+    m_traceCoverageWidth = 32;
     m_traceDepth = 0;
     m_traceMaxArray = 32;
     m_traceMaxWidth = 256;
     m_unrollCount = 64;
     m_unrollStmts = 30000;
+    m_verilateJobs = 1;
 
     m_compLimitBlocks = 0;
     m_compLimitMembers = 64;
@@ -1709,10 +1915,15 @@ void V3Options::optimize(int level) {
     m_oSubst = flag;
     m_oSubstConst = flag;
     m_oTable = flag;
+    m_oTempReuse = flag;
     m_oDedupe = flag;
     m_oAssemble = flag;
+    m_oInlineCFuncs = false;
+    m_oCombineParams = false;
     // And set specific optimization levels
     if (level >= 3) {
         m_inlineMult = -1;  // Maximum inlining
+        m_oInlineCFuncs = true;
+        m_oCombineParams = true;
     }
 }
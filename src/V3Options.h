@@ -150,7 +150,7 @@ inline std::ostream& operator<<(std::ostream& os, const VTimescale& rhs) {
 
 class TraceFormat {
 public:
-    enum en { VCD = 0, FST } m_e;
+    enum en { VCD = 0, FST, VBT } m_e;
     // cppcheck-suppress noExplicitConstructor
     inline TraceFormat(en _e = VCD)
         : m_e(_e) {}
@@ -159,11 +159,11 @@ public:
     operator en() const { return m_e; }
     bool fst() const { return m_e == FST; }
     string classBase() const {
-        static const char* const names[] = {"VerilatedVcd", "VerilatedFst"};
+        static const char* const names[] = {"VerilatedVcd", "VerilatedFst", "VerilatedVbt"};
         return names[m_e];
     }
     string sourceName() const {
-        static const char* const names[] = {"verilated_vcd", "verilated_fst"};
+        static const char* const names[] = {"verilated_vcd", "verilated_fst", "verilated_vbt"};
         return names[m_e];
     }
 };
@@ -197,6 +197,7 @@ private:
     V3StringSet m_libraryFiles; // argument: Verilog -v files
     V3StringSet m_clockers;     // argument: Verilog -clk signals
     V3StringSet m_noClockers;   // argument: Verilog -noclk signals
+    V3StringList m_cosimCuts;   // argument: --cosim-cut instances
     V3StringList m_vFiles;      // argument: Verilog files to read
     V3StringList m_forceIncs;   // argument: -FI
     DebugSrcMap m_debugSrcs;    // argument: --debugi-<srcfile>=<level>
@@ -206,7 +207,9 @@ private:
     bool        m_preprocOnly;  // main switch: -E
     bool        m_makePhony;    // main switch: -MP
     bool        m_preprocNoLine;// main switch: -P
+    bool        m_activityGate; // main switch: --activity-gate
     bool        m_assert;       // main switch: --assert
+    bool        m_assertScopes; // main switch: --assert-scopes
     bool        m_autoflush;    // main switch: --autoflush
     bool        m_bboxSys;      // main switch: --bbox-sys
     bool        m_bboxUnsup;    // main switch: --bbox-unsup
@@ -214,7 +217,9 @@ private:
     bool        m_cdc;          // main switch: --cdc
     bool        m_cmake;        // main switch: --make cmake
     bool        m_context;      // main switch: --Wcontext
+    bool        m_cosim;        // main switch: --cosim
     bool        m_coverageLine; // main switch: --coverage-block
+    bool        m_coveragePerThread;// main switch: --coverage-per-thread
     bool        m_coverageToggle;// main switch: --coverage-toggle
     bool        m_coverageUnderscore;// main switch: --coverage-underscore
     bool        m_coverageUser; // main switch: --coverage-func
@@ -228,21 +233,31 @@ private:
     bool        m_decoration;   // main switch: --decoration
     bool        m_dpiHdrOnly;   // main switch: --dpi-hdr-only
     bool        m_dumpDefines;  // main switch: --dump-defines
+    bool        m_evalClock;    // main switch: --eval-clock
     bool        m_exe;          // main switch: --exe
     bool        m_flatten;      // main switch: --flatten
+    bool        m_hotColdVars;  // main switch: --hot-cold-vars
     bool        m_ignc;         // main switch: --ignc
     bool        m_inhibitSim;   // main switch: --inhibit-sim
     bool        m_lintOnly;     // main switch: --lint-only
     bool        m_gmake;        // main switch: --make gmake
     bool        m_main;         // main swithc: --main
     bool        m_orderClockDly;// main switch: --order-clock-delay
+    bool        m_orderDerivedClks;  // main switch: --order-derived-clocks
     bool        m_outFormatOk;  // main switch: --cc, --sc or --sp was specified
+    bool        m_outputKeepUnchanged;  // main switch: --output-keep-unchanged
+    bool        m_pch;          // main switch: --pch
     bool        m_pedantic;     // main switch: --Wpedantic
     bool        m_pinsScUint;   // main switch: --pins-sc-uint
     bool        m_pinsScBigUint;// main switch: --pins-sc-biguint
     bool        m_pinsUint8;    // main switch: --pins-uint8
     bool        m_ppComments;   // main switch: --pp-comments
     bool        m_profCFuncs;   // main switch: --prof-cfuncs
+    bool        m_profEval;     // main switch: --prof-eval
+    bool        m_profLive;     // main switch: --prof-live
+    bool        m_profSample;   // main switch: --prof-sample
+    bool        m_profBlocks;   // main switch: --prof-blocks
+    bool        m_profBranches;  // main switch: --prof-branches
     bool        m_profThreads;  // main switch: --prof-threads
     bool        m_protectIds;   // main switch: --protect-ids
     bool        m_public;       // main switch: --public
@@ -252,13 +267,25 @@ private:
     bool        m_relativeIncludes; // main switch: --relative-includes
     bool        m_reportUnoptflat; // main switch: --report-unoptflat
     bool        m_savable;      // main switch: --savable
+    bool        m_shareInstances;  // main switch: --share-instances
+    bool        m_splitVarAuto;  // main switch: --split-var-auto
+    bool        m_splitVarFields;  // main switch: --split-var-fields
     bool        m_structsPacked;  // main switch: --structs-packed
+    bool        m_symsIndirect;  // main switch: --syms-indirect
     bool        m_systemC;      // main switch: --sc: System C instead of simple C++
     bool        m_stats;        // main switch: --stats
     bool        m_statsVars;    // main switch: --stats-vars
+    bool        m_threadsAuto;  // main switch: --threads-auto
     bool        m_threadsCoarsen;  // main switch: --threads-coarsen
     bool        m_threadsDpiPure;  // main switch: --threads-dpi all/pure
     bool        m_threadsDpiUnpure;  // main switch: --threads-dpi all
+    bool        m_threadsDynamic;  // main switch: --threads-schedule dynamic
+    bool        m_threadsPipeline;  // main switch: --threads-pipeline
+    bool        m_threadsRecompute;  // main switch: --threads-recompute
+    bool        m_threadsStable;  // main switch: --threads-stable
+    bool        m_threadsVarGroup;  // main switch: --threads-var-layout grouped
+    bool        m_threadsVertexGroup;  // main switch: --threads-vertex-layout grouped
+    bool        m_threadsVertexPad;  // main switch: --threads-vertex-layout padded
     bool        m_trace;        // main switch: --trace
     bool        m_traceCoverage;  // main switch: --trace-coverage
     bool        m_traceDups;    // main switch: --trace-dups
@@ -268,29 +295,41 @@ private:
     bool        m_underlineZero;// main switch: --underline-zero; undocumented old Verilator 2
     bool        m_verilate;     // main swith: --verilate
     bool        m_vpi;          // main switch: --vpi
+    bool        m_vpiChangeHooks;  // main switch: --vpi-change-hooks
     bool        m_xInitialEdge; // main switch: --x-initial-edge
+    bool        m_xmlIndex;     // main switch: --xml-index
     bool        m_xmlOnly;      // main switch: --xml-only
 
+    int         m_branchlessWords;  // main switch: --branchless-words
     int         m_buildJobs;    // main switch: -j
     int         m_convergeLimit;// main switch: --converge-limit
+    int         m_debugCheckInterval; // main switch: --debug-check-interval
+    int         m_delayedQueue; // main switch: --delayed-queue
     int         m_dumpTree;     // main switch: --dump-tree
     int         m_gateStmts;    // main switch: --gate-stmts
     int         m_ifDepth;      // main switch: --if-depth
     int         m_inlineMult;   // main switch: --inline-mult
+    int         m_lanes;        // main switch: --lanes
     VOptionBool m_makeDepend;  // main switch: -MMD
     int         m_maxNumWidth;  // main switch: --max-num-width
     int         m_moduleRecursion;// main switch: --module-recursion-depth
     int         m_outputSplit;  // main switch: --output-split
+    int         m_outputSplitBuckets;  // main switch: --output-split-buckets
     int         m_outputSplitCFuncs;// main switch: --output-split-cfuncs
     int         m_outputSplitCTrace;// main switch: --output-split-ctrace
     int         m_pinsBv;       // main switch: --pins-bv
     VOptionBool m_skipIdentical;  // main switch: --skip-identical
+    int         m_specializeBudget;  // main switch: --specialize-budget
     int         m_threads;      // main switch: --threads (0 == --no-threads)
     int         m_threadsMaxMTasks;  // main switch: --threads-max-mtasks
+    int         m_threadsMinMTaskCost;  // main switch: --threads-min-mtask-cost
+    int         m_threadsXthreadCost;  // main switch: --threads-xthread-cost
     VTimescale  m_timeDefaultPrec;  // main switch: --timescale
     VTimescale  m_timeDefaultUnit;  // main switch: --timescale
     VTimescale  m_timeOverridePrec;  // main switch: --timescale-override
     VTimescale  m_timeOverrideUnit;  // main switch: --timescale-override
+    int         m_traceActivityGranularity;  // main switch: --trace-activity-granularity
+    int         m_traceCoverageWidth;  // main switch: --trace-coverage-width
     int         m_traceDepth;   // main switch: --trace-depth
     TraceFormat m_traceFormat;  // main switch: --trace or --trace-fst
     int         m_traceMaxArray;// main switch: --trace-max-array
@@ -298,6 +337,7 @@ private:
     int         m_traceThreads; // main switch: --trace-threads
     int         m_unrollCount;  // main switch: --unroll-count
     int         m_unrollStmts;  // main switch: --unroll-stmts
+    int         m_verilateJobs;  // main switch: --verilate-jobs
 
     int         m_compLimitBlocks;  // compiler selection; number of nested blocks
     int         m_compLimitMembers;  // compiler selection; number of members in struct before make anon array
@@ -306,17 +346,23 @@ private:
     string      m_bin;          // main switch: --bin {binary}
     string      m_exeName;      // main switch: -o {name}
     string      m_flags;        // main switch: -f {name}
+    string      m_instrCosts;   // main switch: --instr-costs {file}
     string      m_l2Name;       // main switch: --l2name; "" for top-module's name
     string      m_makeDir;      // main switch: -Mdir
     string      m_modPrefix;    // main switch: --mod-prefix
     string      m_pipeFilter;   // main switch: --pipe-filter
+    string      m_ppCache;      // main switch: --pp-cache {dir}
     string      m_prefix;       // main switch: --prefix
+    string      m_profBranchesFeedback;  // main switch: --prof-branches-feedback {file}
+    string      m_profThreadsFeedback;  // main switch: --prof-threads-feedback {file}
     string      m_protectKey;   // main switch: --protect-key
     string      m_protectLib;   // main switch: --protect-lib {lib_name}
+    string      m_statsJson;    // main switch: --stats-json {file}
     string      m_topModule;    // main switch: --top-module
     string      m_unusedRegexp; // main switch: --unused-regexp
     string      m_xAssign;      // main switch: --x-assign
     string      m_xInitial;     // main switch: --x-initial
+    string      m_xMode;        // main switch: --x-mode
     string      m_xmlOutput;    // main switch: --xml-output
 
     // Language is now held in FileLine, on a per-node basis. However we still
@@ -328,6 +374,7 @@ private:
     bool        m_oAcycSimp;    // main switch: -Oy: acyclic pre-optimizations
     bool        m_oCase;        // main switch: -Oe: case tree conversion
     bool        m_oCombine;     // main switch: -Ob: common icode packing
+    bool        m_oCombineParams;  // main switch: -Oh: merge functions differing in variables
     bool        m_oConst;       // main switch: -Oc: constant folding
     bool        m_oDedupe;      // main switch: -Od: logic deduplication
     bool        m_oAssemble;    // main switch: -Om: assign assemble
@@ -337,12 +384,14 @@ private:
     bool        m_oLifePost;    // main switch: -Ot: delayed assignment elimination
     bool        m_oLocalize;    // main switch: -Oz: convert temps to local variables
     bool        m_oInline;      // main switch: -Oi: module inlining
+    bool        m_oInlineCFuncs;  // main switch: -Of: C function inlining
     bool        m_oReloop;      // main switch: -Ov: reform loops
     bool        m_oReorder;     // main switch: -Or: reorder assignments in blocks
     bool        m_oSplit;       // main switch: -Os: always assignment splitting
     bool        m_oSubst;       // main switch: -Ou: substitute expression temp values
     bool        m_oSubstConst;  // main switch: -Ok: final constant substitution
     bool        m_oTable;       // main switch: -Oa: lookup table creation
+    bool        m_oTempReuse;   // main switch: -Ow: temporary storage reuse
     // clang-format on
 
 private:
@@ -399,10 +448,15 @@ public:
     bool systemC() const { return m_systemC; }
     bool usingSystemCLibs() const { return !lintOnly() && systemC(); }
     bool savable() const { return m_savable; }
+    bool shareInstances() const { return m_shareInstances; }
+    bool splitVarAuto() const { return m_splitVarAuto; }
+    bool splitVarFields() const { return m_splitVarFields; }
     bool stats() const { return m_stats; }
+    bool symsIndirect() const { return m_symsIndirect; }
     bool statsVars() const { return m_statsVars; }
     bool structsPacked() const { return m_structsPacked; }
     bool assertOn() const { return m_assert; }  // assertOn as __FILE__ may be defined
+    bool assertScopes() const { return m_assertScopes; }
     bool autoflush() const { return m_autoflush; }
     bool bboxSys() const { return m_bboxSys; }
     bool bboxUnsup() const { return m_bboxUnsup; }
@@ -410,8 +464,10 @@ public:
     bool cdc() const { return m_cdc; }
     bool cmake() const { return m_cmake; }
     bool context() const { return m_context; }
+    bool cosim() const { return m_cosim; }
     bool coverage() const { return m_coverageLine || m_coverageToggle || m_coverageUser; }
     bool coverageLine() const { return m_coverageLine; }
+    bool coveragePerThread() const { return m_coveragePerThread; }
     bool coverageToggle() const { return m_coverageToggle; }
     bool coverageUnderscore() const { return m_coverageUnderscore; }
     bool coverageUser() const { return m_coverageUser; }
@@ -430,7 +486,15 @@ public:
     bool gmake() const { return m_gmake; }
     bool threadsDpiPure() const { return m_threadsDpiPure; }
     bool threadsDpiUnpure() const { return m_threadsDpiUnpure; }
+    bool threadsAuto() const { return m_threadsAuto; }
     bool threadsCoarsen() const { return m_threadsCoarsen; }
+    bool threadsDynamic() const { return m_threadsDynamic; }
+    bool threadsPipeline() const { return m_threadsPipeline; }
+    bool threadsRecompute() const { return m_threadsRecompute; }
+    bool threadsStable() const { return m_threadsStable; }
+    bool threadsVarGroup() const { return m_threadsVarGroup; }
+    bool threadsVertexGroup() const { return m_threadsVertexGroup; }
+    bool threadsVertexPad() const { return m_threadsVertexPad; }
     bool trace() const { return m_trace; }
     bool traceCoverage() const { return m_traceCoverage; }
     bool traceDups() const { return m_traceDups; }
@@ -439,45 +503,66 @@ public:
     bool traceUnderscore() const { return m_traceUnderscore; }
     bool main() const { return m_main; }
     bool orderClockDly() const { return m_orderClockDly; }
+    bool orderDerivedClks() const { return m_orderDerivedClks; }
+    bool outputKeepUnchanged() const { return m_outputKeepUnchanged; }
     bool outFormatOk() const { return m_outFormatOk; }
     bool keepTempFiles() const { return (V3Error::debugDefault() != 0); }
+    bool pch() const { return m_pch; }
     bool pedantic() const { return m_pedantic; }
     bool pinsScUint() const { return m_pinsScUint; }
     bool pinsScBigUint() const { return m_pinsScBigUint; }
     bool pinsUint8() const { return m_pinsUint8; }
     bool ppComments() const { return m_ppComments; }
+    bool profBlocks() const { return m_profBlocks; }
+    bool profBranches() const { return m_profBranches; }
     bool profCFuncs() const { return m_profCFuncs; }
+    bool profEval() const { return m_profEval; }
+    bool profLive() const { return m_profLive; }
+    bool profSample() const { return m_profSample; }
     bool profThreads() const { return m_profThreads; }
     bool protectIds() const { return m_protectIds; }
     bool allPublic() const { return m_public; }
     bool publicFlatRW() const { return m_publicFlatRW; }
     bool lintOnly() const { return m_lintOnly; }
+    bool hotColdVars() const { return m_hotColdVars; }
     bool ignc() const { return m_ignc; }
     bool inhibitSim() const { return m_inhibitSim; }
+    bool evalClock() const { return m_evalClock; }
+    bool activityGate() const { return m_activityGate; }
     bool quietExit() const { return m_quietExit; }
     bool relativeCFuncs() const { return m_relativeCFuncs; }
     bool reportUnoptflat() const { return m_reportUnoptflat; }
     bool verilate() const { return m_verilate; }
     bool vpi() const { return m_vpi; }
+    bool vpiChangeHooks() const { return m_vpiChangeHooks; }
     bool xInitialEdge() const { return m_xInitialEdge; }
+    bool xmlIndex() const { return m_xmlIndex; }
     bool xmlOnly() const { return m_xmlOnly; }
 
+    int branchlessWords() const { return m_branchlessWords; }
     int buildJobs() const { return m_buildJobs; }
     int convergeLimit() const { return m_convergeLimit; }
+    int debugCheckInterval() const { return m_debugCheckInterval; }
+    int delayedQueue() const { return m_delayedQueue; }
     int dumpTree() const { return m_dumpTree; }
     int gateStmts() const { return m_gateStmts; }
     int ifDepth() const { return m_ifDepth; }
     int inlineMult() const { return m_inlineMult; }
+    int lanes() const { return m_lanes; }
     VOptionBool makeDepend() const { return m_makeDepend; }
     int maxNumWidth() const { return m_maxNumWidth; }
     int moduleRecursionDepth() const { return m_moduleRecursion; }
     int outputSplit() const { return m_outputSplit; }
+    int outputSplitBuckets() const { return m_outputSplitBuckets; }
     int outputSplitCFuncs() const { return m_outputSplitCFuncs; }
     int outputSplitCTrace() const { return m_outputSplitCTrace; }
     int pinsBv() const { return m_pinsBv; }
     VOptionBool skipIdentical() const { return m_skipIdentical; }
+    int specializeBudget() const { return m_specializeBudget; }
     int threads() const { return m_threads; }
     int threadsMaxMTasks() const { return m_threadsMaxMTasks; }
+    int threadsMinMTaskCost() const { return m_threadsMinMTaskCost; }
+    int threadsXthreadCost() const { return m_threadsXthreadCost; }
     bool mtasks() const { return (m_threads > 1); }
     VTimescale timeDefaultPrec() const { return m_timeDefaultPrec; }
     VTimescale timeDefaultUnit() const { return m_timeDefaultUnit; }
@@ -485,6 +570,8 @@ public:
     VTimescale timeOverrideUnit() const { return m_timeOverrideUnit; }
     VTimescale timeComputePrec(const VTimescale& flag) const;
     VTimescale timeComputeUnit(const VTimescale& flag) const;
+    int traceActivityGranularity() const { return m_traceActivityGranularity; }
+    int traceCoverageWidth() const { return m_traceCoverageWidth; }
     int traceDepth() const { return m_traceDepth; }
     TraceFormat traceFormat() const { return m_traceFormat; }
     int traceMaxArray() const { return m_traceMaxArray; }
@@ -495,17 +582,22 @@ public:
     }
     int unrollCount() const { return m_unrollCount; }
     int unrollStmts() const { return m_unrollStmts; }
+    int verilateJobs() const { return m_verilateJobs; }
 
     int compLimitBlocks() const { return m_compLimitBlocks; }
     int compLimitMembers() const { return m_compLimitMembers; }
     int compLimitParens() const { return m_compLimitParens; }
 
     string exeName() const { return m_exeName != "" ? m_exeName : prefix(); }
+    string instrCosts() const { return m_instrCosts; }
     string l2Name() const { return m_l2Name; }
     string makeDir() const { return m_makeDir; }
     string modPrefix() const { return m_modPrefix; }
     string pipeFilter() const { return m_pipeFilter; }
+    string ppCache() const { return m_ppCache; }
     string prefix() const { return m_prefix; }
+    string profBranchesFeedback() const { return m_profBranchesFeedback; }
+    string profThreadsFeedback() const { return m_profThreadsFeedback; }
     string protectKey() const { return m_protectKey; }
     string protectKeyDefaulted();  // Set default key if not set by user
     string protectLib() const { return m_protectLib; }
@@ -518,10 +610,12 @@ public:
         }
         return libName;
     }
+    string statsJson() const { return m_statsJson; }
     string topModule() const { return m_topModule; }
     string unusedRegexp() const { return m_unusedRegexp; }
     string xAssign() const { return m_xAssign; }
     string xInitial() const { return m_xInitial; }
+    string xMode() const { return m_xMode; }
     string xmlOutput() const { return m_xmlOutput; }
 
     const V3StringSet& cppFiles() const { return m_cppFiles; }
@@ -529,6 +623,7 @@ public:
     const V3StringList& ldLibs() const { return m_ldLibs; }
     const V3StringList& makeFlags() const { return m_makeFlags; }
     const V3StringSet& libraryFiles() const { return m_libraryFiles; }
+    const V3StringList& cosimCuts() const { return m_cosimCuts; }
     const V3StringList& vFiles() const { return m_vFiles; }
     const V3StringList& forceIncs() const { return m_forceIncs; }
     const V3LangCode& defaultLanguage() const { return m_defaultLanguage; }
@@ -546,6 +641,7 @@ public:
     bool oAcycSimp() const { return m_oAcycSimp; }
     bool oCase() const { return m_oCase; }
     bool oCombine() const { return m_oCombine; }
+    bool oCombineParams() const { return m_oCombineParams; }
     bool oConst() const { return m_oConst; }
     bool oDedupe() const { return m_oDedupe; }
     bool oAssemble() const { return m_oAssemble; }
@@ -556,12 +652,14 @@ public:
     bool oLifePost() const { return m_oLifePost; }
     bool oLocalize() const { return m_oLocalize; }
     bool oInline() const { return m_oInline; }
+    bool oInlineCFuncs() const { return m_oInlineCFuncs; }
     bool oReloop() const { return m_oReloop; }
     bool oReorder() const { return m_oReorder; }
     bool oSplit() const { return m_oSplit; }
     bool oSubst() const { return m_oSubst; }
     bool oSubstConst() const { return m_oSubstConst; }
     bool oTable() const { return m_oTable; }
+    bool oTempReuse() const { return m_oTempReuse; }
 
     string traceClassBase() const { return m_traceFormat.classBase(); }
     string traceClassLang() const { return m_traceFormat.classBase() + (systemC() ? "Sc" : "C"); }
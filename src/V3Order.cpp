@@ -99,6 +99,7 @@
 #include <iomanip>
 #include <map>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <vector>
 #include VL_INCLUDE_UNORDERED_MAP
@@ -377,6 +378,205 @@ public:
     virtual ~OrderClkMarkVisitor() {}
 };
 
+//######################################################################
+// OrderDerivedClkVisitor, for --order-derived-clocks
+//
+// Finds the derived clocks: those set only by delayed assignments of
+// clocked logic, e.g. clock dividers.  Normally these are circular, so the
+// logic they clock runs in a later pass of the evaluation loop.  Instead a
+// domain clocked only by derived clocks may be ordered after the delayed
+// assignments of the signals it reads from other domains, so it runs in
+// the same pass.  It must only read signals that are up to date then:
+// those delayed-assigned by other domains, its own, and unset signals.
+
+class OrderDerivedClkVisitor : public AstNVisitor {
+private:
+    // TYPES
+    typedef std::set<const AstSenTree*> DomainSet;
+    typedef std::map<const AstVarScope*, DomainSet> VarDomainMap;
+    typedef std::set<const AstVarScope*> VarSet;
+    typedef std::map<const AstSenTree*, VarSet> DomainVarMap;
+
+    // STATE
+    AstActive* m_activep;  // Current activation block
+    bool m_inSenTree;  // Underneath AstSenTree
+    bool m_inPost;  // Underneath AstAssignPost
+    bool m_inCFunc;  // Underneath AstCFunc
+    VarDomainMap m_postWriters;  // Domains setting each variable by delayed assignment
+    VarDomainMap m_writers;  // Domains setting each variable otherwise
+    VarSet m_comboWritten;  // Variables set by combo logic
+    DomainVarMap m_domainReads;  // Variables read by each domain
+    DomainVarMap m_domainClocks;  // Variables clocking each domain
+    VarDomainMap m_clockedDomains;  // Domains clocked by each variable
+    DomainSet m_badDomains;  // Domains clocked by something else
+    DomainSet m_derivedDomains;  // Domains clocked only by derived clocks
+    VarSet m_derivedClocks;  // Clocks only clocking derived domains
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    static bool contains(const VarDomainMap& vmap, const AstVarScope* vscp,
+                         const AstSenTree* domainp) {
+        VarDomainMap::const_iterator it = vmap.find(vscp);
+        return it != vmap.end() && it->second.count(domainp);
+    }
+    static size_t count(const VarDomainMap& vmap, const AstVarScope* vscp) {
+        VarDomainMap::const_iterator it = vmap.find(vscp);
+        return it == vmap.end() ? 0 : it->second.size();
+    }
+    bool readOk(const AstVarScope* vscp, const AstSenTree* domainp) const {
+        // Is the value read by derived domain up to date when it runs?
+        if (m_comboWritten.count(vscp)) return false;
+        const size_t writers = count(m_writers, vscp);
+        const size_t postWriters = count(m_postWriters, vscp);
+        const bool ownWrites
+            = writers == 0 || (writers == 1 && contains(m_writers, vscp, domainp));
+        if (contains(m_postWriters, vscp, domainp)) return postWriters == 1 && ownWrites;
+        if (postWriters) return writers == 0;  // Another domain's flop
+        return ownWrites;  // Unset, or the domain's own temporary
+    }
+    bool clockOk(const AstVarScope* vscp, const AstSenTree* domainp) const {
+        return !m_comboWritten.count(vscp) && !count(m_writers, vscp)
+               && count(m_postWriters, vscp) && !contains(m_postWriters, vscp, domainp);
+    }
+    void findDerived() {
+        // Candidate domains, then drop those with clocks also clocking others
+        for (DomainVarMap::const_iterator it = m_domainClocks.begin();
+             it != m_domainClocks.end(); ++it) {
+            const AstSenTree* domainp = it->first;
+            if (m_badDomains.count(domainp)) continue;
+            bool ok = true;
+            for (VarSet::const_iterator vit = it->second.begin(); ok && vit != it->second.end();
+                 ++vit) {
+                ok = clockOk(*vit, domainp);
+            }
+            DomainVarMap::const_iterator rit = m_domainReads.find(domainp);
+            if (rit != m_domainReads.end()) {
+                for (VarSet::const_iterator vit = rit->second.begin();
+                     ok && vit != rit->second.end(); ++vit) {
+                    ok = readOk(*vit, domainp);
+                }
+            }
+            if (ok) m_derivedDomains.insert(domainp);
+        }
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            m_derivedClocks.clear();
+            for (VarDomainMap::const_iterator it = m_clockedDomains.begin();
+                 it != m_clockedDomains.end(); ++it) {
+                bool ok = true;
+                for (DomainSet::const_iterator dit = it->second.begin();
+                     ok && dit != it->second.end(); ++dit) {
+                    ok = m_derivedDomains.count(*dit);
+                }
+                if (ok) m_derivedClocks.insert(it->first);
+            }
+            for (DomainSet::iterator it = m_derivedDomains.begin();
+                 it != m_derivedDomains.end();) {
+                const VarSet& clocks = m_domainClocks[*it];
+                bool ok = true;
+                for (VarSet::const_iterator vit = clocks.begin(); ok && vit != clocks.end();
+                     ++vit) {
+                    ok = m_derivedClocks.count(*vit);
+                }
+                if (ok) {
+                    ++it;
+                } else {
+                    m_derivedDomains.erase(it++);
+                    changed = true;
+                }
+            }
+        }
+        UINFO(4, "  Derived clock domains: " << m_derivedDomains.size() << endl);
+    }
+
+    // VISITORS
+    virtual void visit(AstActive* nodep) VL_OVERRIDE {
+        m_activep = nodep;
+        m_inSenTree = true;
+        iterate(nodep->sensesp());
+        m_inSenTree = false;
+        iterateChildren(nodep);
+        m_activep = NULL;
+    }
+    virtual void visit(AstSenItem* nodep) VL_OVERRIDE {
+        if (!m_activep || !m_inSenTree) return;  // E.g. TOPSCOPE's SENTREE list
+        const AstSenTree* domainp = m_activep->sensesp();
+        AstNodeVarRef* varrefp = nodep->varrefp();
+        if (!domainp->hasClocked()) return;
+        if (varrefp && varrefp->varScopep()
+            && (nodep->edgeType() == VEdgeType::ET_POSEDGE
+                || nodep->edgeType() == VEdgeType::ET_NEGEDGE
+                || nodep->edgeType() == VEdgeType::ET_BOTHEDGE)) {
+            m_domainClocks[domainp].insert(varrefp->varScopep());
+            m_clockedDomains[varrefp->varScopep()].insert(domainp);
+        } else {
+            m_badDomains.insert(domainp);
+        }
+    }
+    virtual void visit(AstAssignPost* nodep) VL_OVERRIDE {
+        m_inPost = true;
+        iterateChildren(nodep);
+        m_inPost = false;
+    }
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        if (m_inCFunc && nodep->lvalue() && nodep->varScopep()) {
+            // Called from anywhere, so assume from combo logic
+            m_comboWritten.insert(nodep->varScopep());
+        }
+        if (!m_activep || m_inSenTree || !nodep->varScopep()) return;
+        const AstSenTree* domainp = m_activep->sensesp();
+        const AstVarScope* vscp = nodep->varScopep();
+        if (nodep->lvalue()) {
+            if (domainp->hasCombo()) {
+                m_comboWritten.insert(vscp);
+            } else if (domainp->hasClocked()) {
+                (m_inPost ? m_postWriters : m_writers)[vscp].insert(domainp);
+            }
+        } else if (domainp->hasClocked() && !m_inPost) {
+            m_domainReads[domainp].insert(vscp);
+        }
+    }
+    virtual void visit(AstNodeCCall* nodep) VL_OVERRIDE {
+        // What the function reads is unknown here
+        if (m_activep) m_badDomains.insert(m_activep->sensesp());
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        AstActive* oldActivep = m_activep;
+        m_activep = NULL;
+        m_inCFunc = true;
+        iterateChildren(nodep);
+        m_inCFunc = false;
+        m_activep = oldActivep;
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit OrderDerivedClkVisitor(AstNode* nodep)
+        : m_activep(NULL)
+        , m_inSenTree(false)
+        , m_inPost(false)
+        , m_inCFunc(false) {
+        if (v3Global.opt.orderDerivedClks()) {
+            iterate(nodep);
+            findDerived();
+        }
+    }
+    virtual ~OrderDerivedClkVisitor() {}
+    // ACCESSORS
+    bool derivedDomain(const AstSenTree* domainp) const {
+        return m_derivedDomains.count(domainp);
+    }
+    bool derivedClock(const AstVarScope* vscp) const { return m_derivedClocks.count(vscp); }
+    // Is variable read by a derived domain set by another domain?
+    bool otherDomainSets(const AstVarScope* vscp, const AstSenTree* domainp) const {
+        return count(m_postWriters, vscp) && !contains(m_postWriters, vscp, domainp);
+    }
+};
+
 //######################################################################
 // The class checks if the assignment generates a clock.
 
@@ -608,6 +808,66 @@ private:
     VL_UNCOPYABLE(OrderMTaskMoveVertexMaker);
 };
 
+//######################################################################
+// Helpers for recomputing mtasks within their consumers
+
+class OrderRecomputeRefVisitor : public AstNVisitor {
+    // Collect the variables a logic statement reads and writes
+public:
+    typedef std::set<AstVarScope*> VscSet;
+
+private:
+    // MEMBERS
+    VscSet m_reads;  // Variables read
+    VscSet m_writes;  // Variables written
+    bool m_impure;  // Calls a function, so may have side effects or hidden references
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        (nodep->lvalue() ? m_writes : m_reads).insert(nodep->varScopep());
+    }
+    virtual void visit(AstNodeCCall* nodep) VL_OVERRIDE { m_impure = true; }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit OrderRecomputeRefVisitor(AstNode* nodep)
+        : m_impure(false) {
+        iterate(nodep);
+    }
+    virtual ~OrderRecomputeRefVisitor() {}
+    // ACCESSORS
+    const VscSet& reads() const { return m_reads; }
+    const VscSet& writes() const { return m_writes; }
+    bool impure() const { return m_impure; }
+};
+
+class OrderRecomputeRelinkVisitor : public AstNVisitor {
+    // Point references to recomputed variables at the consumer's private copies
+public:
+    typedef std::map<const AstVarScope*, AstVarScope*> VscMap;
+
+private:
+    // MEMBERS
+    const VscMap& m_vscMap;  // Original variable -> private copy
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        VscMap::const_iterator it = m_vscMap.find(nodep->varScopep());
+        if (it == m_vscMap.end()) return;
+        nodep->varScopep(it->second);
+        nodep->varp(it->second->varp());
+        nodep->name(it->second->varp()->name());
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    OrderRecomputeRelinkVisitor(AstNode* nodep, const VscMap& vscMap)
+        : m_vscMap(vscMap) {
+        iterate(nodep);
+    }
+    virtual ~OrderRecomputeRelinkVisitor() {}
+};
+
 class OrderVerticesByDomainThenScope {
     PartPtrIdMap m_ids;
 
@@ -681,6 +941,8 @@ private:
     bool m_inPre;  // Underneath AstAssignPre
     bool m_inPost;  // Underneath AstAssignPost
     OrderLogicVertex* m_activeSenVxp;  // Sensitivity vertex
+    const OrderDerivedClkVisitor* m_derivedp;  // Derived clock domains
+    bool m_inDerived;  // Underneath derived clock domain
     std::deque<OrderUser*> m_orderUserps;  // All created OrderUser's for later deletion.
     // STATE... for inside process
     AstCFunc* m_pomNewFuncp;  // Current function being created
@@ -695,6 +957,9 @@ protected:
 private:
     // STATS
     VDouble0 m_statCut[OrderVEdgeType::_ENUM_END];  // Count of each edge type cut
+    VDouble0 m_statCutCost;  // Total cutCost() of edges cut
+    VDouble0 m_statRecomputed;  // Count of mtasks copied into a consumer
+    VDouble0 m_statDerived;  // Count of derived clocks evaluated in the same pass
 
     // TYPES
     enum VarUsage { VU_NONE = 0, VU_CON = 1, VU_GEN = 2 };
@@ -737,6 +1002,8 @@ private:
 
     void process();
     void processCircular();
+    typedef std::multimap<uint32_t, const OrderVarStdVertex*> CutVarMap;  // Cut signals by cost
+    void reportCutVars(const CutVarMap& cutVars);
     typedef std::deque<OrderEitherVertex*> VertexVec;
     void processInputs();
     void processInputsInIterate(OrderEitherVertex* vertexp, VertexVec& todoVec);
@@ -767,7 +1034,12 @@ private:
             : m_mtaskBodyp(NULL)
             , m_execMTaskp(NULL) {}
     };
+    typedef vl_unordered_map<unsigned /*mtask id*/, MTaskState> MTaskStates;
+    typedef std::set<std::pair<unsigned, unsigned> > MTaskIdPairs;  // Consumer id, producer id
     void processMTasks();
+    void processMTasksRecompute(const V3Graph* mtasksp, MTaskStates& mtaskStates,
+                                V3Graph* logicGraphp, MTaskIdPairs& droppedr,
+                                MTaskIdPairs& addedr);
     typedef enum { LOGIC_INITIAL, LOGIC_SETTLE } InitialLogicE;
     void processMTasksInitial(InitialLogicE logic_type);
 
@@ -1022,6 +1294,7 @@ private:
         m_activep = nodep;
         m_activeSenVxp = NULL;
         m_inClocked = nodep->hasClocked();
+        m_inDerived = m_inClocked && m_derivedp->derivedDomain(nodep->sensesp());
         // Grab the sensitivity list
         UASSERT_OBJ(!nodep->sensesStorep(), nodep,
                     "Senses should have been activeTop'ed to be global!");
@@ -1031,6 +1304,7 @@ private:
         m_activep = NULL;
         m_activeSenVxp = NULL;
         m_inClocked = false;
+        m_inDerived = false;
     }
     virtual void visit(AstVarScope* nodep) VL_OVERRIDE {
         // Create links to all input signals
@@ -1153,7 +1427,13 @@ private:
                         OrderVarVertex* varVxp = newVarUserVertex(varscp, WV_STD);
                         new OrderEdge(&m_graph, m_logicVxp, varVxp, WEIGHT_NORMAL);
                     }
-                    if (con) {
+                    if (con && m_inDerived
+                        && m_derivedp->otherDomainSets(varscp, m_activep->sensesp())) {
+                        // Derived domain, runs after the other domain's delayed assignments
+                        // Add edge logic_consumed_var->logic_vertex (same as if comb)
+                        OrderVarVertex* varVxp = newVarUserVertex(varscp, WV_STD);
+                        new OrderEdge(&m_graph, varVxp, m_logicVxp, WEIGHT_MEDIUM);
+                    } else if (con) {
                         // Add edge logic_vertex->consumed_var_PREVAR
                         // Generation of 'pre' because we want to indicate
                         // it should be before AstAssignPre
@@ -1229,7 +1509,9 @@ private:
 
 public:
     // CONSTRUCTORS
-    OrderVisitor() {
+    explicit OrderVisitor(const OrderDerivedClkVisitor* derivedp) {
+        m_derivedp = derivedp;
+        m_inDerived = false;
         m_topScopep = NULL;
         m_scopetopp = NULL;
         m_modp = NULL;
@@ -1258,6 +1540,13 @@ public:
                 V3Stats::addStat(string("Order, cut, ") + OrderVEdgeType(type).ascii(), count);
             }
         }
+        V3Stats::addStat("Order, cut, total cost", m_statCutCost);
+        if (v3Global.opt.threadsRecompute()) {
+            V3Stats::addStat("Order, mtasks, recomputed in consumers", m_statRecomputed);
+        }
+        if (v3Global.opt.orderDerivedClks()) {
+            V3Stats::addStat("Order, derived clocks in same pass", m_statDerived);
+        }
         // Destruction
         for (std::deque<OrderUser*>::iterator it = m_orderUserps.begin();
              it != m_orderUserps.end(); ++it) {
@@ -1421,8 +1710,10 @@ void OrderVisitor::processInputsOutIterate(OrderEitherVertex* vertexp, VertexVec
 void OrderVisitor::processCircular() {
     // Take broken edges and add circular flags
     // The change detect code will use this to force changedets
+    CutVarMap cutVars;
     for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp = itp->verticesNextp()) {
         if (OrderVarStdVertex* vvertexp = dynamic_cast<OrderVarStdVertex*>(itp)) {
+            uint32_t cutCost = 0;
             if (vvertexp->isClock() && !vvertexp->isFromInput()) {
                 // If a clock is generated internally, we need to do another
                 // loop through the entire evaluation.  This fixes races; see
@@ -1435,6 +1726,9 @@ void OrderVisitor::processCircular() {
                 if (!v3Global.opt.orderClockDly()) {
                     UINFO(5, "Circular Clock, no-order-clock-delay " << vvertexp << endl);
                     nodeMarkCircular(vvertexp, NULL);
+                } else if (vvertexp->isDelayed() && m_derivedp->derivedClock(vvertexp->varScp())) {
+                    UINFO(5, "Derived Clock, delayed " << vvertexp << endl);
+                    ++m_statDerived;
                 } else if (vvertexp->isDelayed()) {
                     UINFO(5, "Circular Clock, delayed " << vvertexp << endl);
                     nodeMarkCircular(vvertexp, NULL);
@@ -1449,6 +1743,7 @@ void OrderVisitor::processCircular() {
                     UASSERT_OBJ(oedgep, vvertexp->varScp(), "Cutable edge not of proper type");
                     UINFO(6, "      CutCircularO: " << vvertexp->name() << endl);
                     nodeMarkCircular(vvertexp, oedgep);
+                    cutCost += oedgep->cutCost();
                 }
             }
             for (V3GraphEdge* edgep = vvertexp->inBeginp(); edgep; edgep = edgep->inNextp()) {
@@ -1457,10 +1752,30 @@ void OrderVisitor::processCircular() {
                     UASSERT_OBJ(oedgep, vvertexp->varScp(), "Cutable edge not of proper type");
                     UINFO(6, "      CutCircularI: " << vvertexp->name() << endl);
                     nodeMarkCircular(vvertexp, oedgep);
+                    cutCost += oedgep->cutCost();
                 }
             }
+            if (cutCost) cutVars.insert(std::make_pair(cutCost, vvertexp));
+            m_statCutCost += cutCost;
         }
     }
+    if (v3Global.opt.reportUnoptflat() && !cutVars.empty()) reportCutVars(cutVars);
+}
+
+void OrderVisitor::reportCutVars(const CutVarMap& cutVars) {
+    // List the signals the loops were broken at, most costly first
+    string filename
+        = v3Global.opt.makeDir() + "/" + v3Global.opt.prefix() + "__unoptflat_cuts.txt";
+    const vl_unique_ptr<std::ofstream> ofp(V3File::new_ofstream(filename));
+    if (ofp->fail()) v3fatal("Can't write " << filename);
+    *ofp << "Circular logic cut signals for " << v3Global.opt.prefix() << endl;
+    *ofp << "Cost is words compared for change detection plus signal fanout" << endl;
+    *ofp << endl;
+    for (CutVarMap::const_reverse_iterator it = cutVars.rbegin(); it != cutVars.rend(); ++it) {
+        const AstVarScope* vscp = it->second->varScp();
+        *ofp << "  cost " << std::setw(6) << it->first << "  " << vscp->prettyName() << "  "
+             << vscp->fileline() << endl;
+    }
 }
 
 void OrderVisitor::processSensitive() {
@@ -1793,7 +2108,19 @@ AstActive* OrderVisitor::processMoveOneLogic(const OrderLogicVertex* lvertexp,
             UINFO(4, " Ordering deleting pre-settled " << nodep << endl);
             VL_DO_DANGLING(pushDeletep(nodep), nodep);
         } else {
-            newFuncpr->addStmtsp(nodep);
+            if (v3Global.opt.profBlocks() && !newFuncpr->slow()) {
+                // Time the block into vlSymsp->__Vm_profBlocks[id]
+                FileLine* fl = nodep->fileline();
+                const size_t id = v3Global.profBlocksAdd(
+                    string(nodep->typeName()) + " " + scopep->prettyName() + " "
+                    + fl->filename() + ":" + cvtToStr(fl->lineno()));
+                const string countsp = "vlSymsp->__Vm_profBlocks[" + cvtToStr(id) + "]";
+                newFuncpr->addStmtsp(new AstCStmt(fl, "VL_PROF_BLOCK_START(" + countsp + ");\n"));
+                newFuncpr->addStmtsp(nodep);
+                newFuncpr->addStmtsp(new AstCStmt(fl, "VL_PROF_BLOCK_END(" + countsp + ");\n"));
+            } else {
+                newFuncpr->addStmtsp(nodep);
+            }
             if (v3Global.opt.outputSplitCFuncs()) {
                 // Add in the number of nodes we're adding
                 EmitCBaseCounterVisitor visitor(nodep);
@@ -1855,7 +2182,7 @@ void OrderVisitor::processMTasks() {
     V3Graph mtasks;
     partitioner.go(&mtasks);
 
-    vl_unordered_map<unsigned /*mtask id*/, MTaskState> mtaskStates;
+    MTaskStates mtaskStates;
 
     // Iterate through the entire logicGraph. For each logic node,
     // attach it to a per-MTask ordered list of logic nodes.
@@ -1893,12 +2220,25 @@ void OrderVisitor::processMTasks() {
                 if (!post_varp) continue;
                 AstVar* varp = post_varp->varScp()->varp();
                 varp->addConsumingMTaskId(mtaskId);
+                // Edges to the standard vertex come from logic generating the var
+                if (dynamic_cast<const OrderVarStdVertex*>(post_varp)) {
+                    varp->addWritingMTaskId(mtaskId);
+                }
             }
             // TODO? We ignore IO vars here, so those will have empty mtask
             // signatures. But we could also give those mtask signatures.
         }
     }
 
+    // Copy cheap combinational mtasks into their consumers, so the consumers
+    // no longer wait on them. Copies of the logic are owned by recomputeGraph.
+    V3Graph recomputeGraph;
+    MTaskIdPairs droppedDeps;  // Dependencies replaced by recomputation
+    MTaskIdPairs addedDeps;  // Dependencies consumers inherit from the copied mtasks
+    if (v3Global.opt.threadsRecompute() && v3Global.opt.threadsXthreadCost()) {
+        processMTasksRecompute(&mtasks, mtaskStates, &recomputeGraph, droppedDeps, addedDeps);
+    }
+
     // Create the AstExecGraph node which represents the execution
     // of the MTask graph.
     FileLine* rootFlp = v3Global.rootp()->fileline();
@@ -1950,17 +2290,177 @@ void OrderVisitor::processMTasks() {
         //  A: One is an AstNode, the other is a GraphVertex,
         //     to combine them would involve multiple inheritance...
         state.m_mtaskBodyp->execMTaskp(state.m_execMTaskp);
+        for (MTaskState::Logics::iterator it = state.m_logics.begin(); it != state.m_logics.end();
+             ++it) {
+            state.m_execMTaskp->addModule((*it)->scopep()->modp()->prettyName());
+        }
+        std::set<unsigned> fromIds;
         for (V3GraphEdge* inp = mtaskp->inBeginp(); inp; inp = inp->inNextp()) {
             const V3GraphVertex* fromVxp = inp->fromp();
             const AbstractLogicMTask* fromp = dynamic_cast<const AbstractLogicMTask*>(fromVxp);
+            if (droppedDeps.count(std::make_pair(mtaskp->id(), fromp->id()))) continue;
+            fromIds.insert(fromp->id());
             MTaskState& fromState = mtaskStates[fromp->id()];
             new V3GraphEdge(execGraphp->mutableDepGraphp(), fromState.m_execMTaskp,
                             state.m_execMTaskp, 1);
         }
+        for (MTaskIdPairs::const_iterator it
+             = addedDeps.lower_bound(std::make_pair(mtaskp->id(), 0U));
+             it != addedDeps.end() && it->first == mtaskp->id(); ++it) {
+            if (!fromIds.insert(it->second).second) continue;
+            MTaskState& fromState = mtaskStates[it->second];
+            new V3GraphEdge(execGraphp->mutableDepGraphp(), fromState.m_execMTaskp,
+                            state.m_execMTaskp, 1);
+        }
         execGraphp->addMTaskBody(bodyp);
     }
 }
 
+void OrderVisitor::processMTasksRecompute(const V3Graph* mtasksp, MTaskStates& mtaskStates,
+                                          V3Graph* logicGraphp, MTaskIdPairs& droppedr,
+                                          MTaskIdPairs& addedr) {
+    // A consumer of a small mtask waits for it to finish on another thread,
+    // which costs about --threads-xthread-cost. When the mtask's own cost is
+    // below that, the consumer can instead run a copy of the logic first,
+    // writing private copies of the variables, and drop the dependency.
+    //
+    // Only mtasks of pure combinational continuous assignments are copied,
+    // as those are run on every evaluation and so the private copies are
+    // never stale. The copied mtask must be the only writer of its outputs,
+    // and all writers of its inputs must be its ancestors, which the
+    // consumer then depends on instead.
+    const uint32_t syncCost = v3Global.opt.threadsXthreadCost();
+
+    // Find the mtasks writing each variable
+    typedef std::map<const AstVarScope*, std::set<unsigned> > WriterMap;
+    WriterMap writers;
+    for (MTaskStates::const_iterator it = mtaskStates.begin(); it != mtaskStates.end(); ++it) {
+        for (MTaskState::Logics::const_iterator lit = it->second.m_logics.begin();
+             lit != it->second.m_logics.end(); ++lit) {
+            OrderRecomputeRefVisitor refs((*lit)->nodep());
+            for (OrderRecomputeRefVisitor::VscSet::const_iterator vit = refs.writes().begin();
+                 vit != refs.writes().end(); ++vit) {
+                writers[*vit].insert(it->first);
+            }
+        }
+    }
+
+    std::set<unsigned> donors;  // Mtasks copied into consumers
+    std::set<unsigned> recipients;  // Mtasks holding copies
+    typedef std::map<std::pair<AstNodeModule*, string>, AstVar*> ModVarMap;
+    ModVarMap modVars;  // Private copy AstVar's, one per module and name
+    for (const V3GraphVertex* vxp = mtasksp->verticesBeginp(); vxp; vxp = vxp->verticesNextp()) {
+        const AbstractLogicMTask* donorp = dynamic_cast<const AbstractLogicMTask*>(vxp);
+        if (donorp->cost() >= syncCost || !donorp->outBeginp()) continue;
+        if (recipients.count(donorp->id())) continue;
+        const MTaskState::Logics& logics = mtaskStates[donorp->id()].m_logics;
+        if (logics.empty()) continue;
+
+        // Check every statement can be copied, and find the outputs and inputs
+        OrderRecomputeRefVisitor::VscSet outputs;
+        OrderRecomputeRefVisitor::VscSet inputs;
+        bool ok = true;
+        for (MTaskState::Logics::const_iterator it = logics.begin(); ok && it != logics.end();
+             ++it) {
+            const AstAssignW* assignp = VN_CAST((*it)->nodep(), AssignW);
+            if (!assignp || !(*it)->domainp()->hasCombo() || !VN_IS(assignp->lhsp(), VarRef)) {
+                ok = false;
+                break;
+            }
+            OrderRecomputeRefVisitor refs((*it)->nodep());
+            if (refs.impure()) ok = false;
+            outputs.insert(refs.writes().begin(), refs.writes().end());
+            inputs.insert(refs.reads().begin(), refs.reads().end());
+        }
+        if (!ok) continue;
+        for (OrderRecomputeRefVisitor::VscSet::const_iterator it = outputs.begin();
+             ok && it != outputs.end(); ++it) {
+            if (writers[*it].size() != 1) ok = false;
+            inputs.erase(*it);
+        }
+        if (!ok) continue;
+        std::set<unsigned> ancestors;
+        std::vector<const V3GraphVertex*> todo(1, vxp);
+        while (!todo.empty()) {
+            const V3GraphVertex* checkp = todo.back();
+            todo.pop_back();
+            for (const V3GraphEdge* edgep = checkp->inBeginp(); edgep; edgep = edgep->inNextp()) {
+                const AbstractLogicMTask* fromp
+                    = dynamic_cast<const AbstractLogicMTask*>(edgep->fromp());
+                if (ancestors.insert(fromp->id()).second) todo.push_back(fromp);
+            }
+        }
+        for (OrderRecomputeRefVisitor::VscSet::const_iterator it = inputs.begin();
+             ok && it != inputs.end(); ++it) {
+            const std::set<unsigned>& inWriters = writers[*it];
+            for (std::set<unsigned>::const_iterator wit = inWriters.begin();
+                 ok && wit != inWriters.end(); ++wit) {
+                if (!ancestors.count(*wit)) ok = false;
+            }
+        }
+        if (!ok) continue;
+
+        for (const V3GraphEdge* edgep = donorp->outBeginp(); edgep; edgep = edgep->outNextp()) {
+            const AbstractLogicMTask* recipientp
+                = dynamic_cast<const AbstractLogicMTask*>(edgep->top());
+            if (donors.count(recipientp->id())) continue;
+            UINFO(4, "Recompute mtask " << donorp->id() << " in mtask " << recipientp->id()
+                                        << endl);
+            donors.insert(donorp->id());
+            recipients.insert(recipientp->id());
+            MTaskState& recipientState = mtaskStates[recipientp->id()];
+
+            // Make the recipient's private copy of each output
+            OrderRecomputeRelinkVisitor::VscMap vscMap;
+            for (OrderRecomputeRefVisitor::VscSet::const_iterator it = outputs.begin();
+                 it != outputs.end(); ++it) {
+                AstVarScope* oldVscp = *it;
+                AstNodeModule* modp = oldVscp->scopep()->modp();
+                const string name = "__Vrecomp" + cvtToStr(recipientp->id()) + "__"
+                                    + oldVscp->varp()->name();
+                AstVar*& varpr = modVars[std::make_pair(modp, name)];
+                if (!varpr) {
+                    varpr = new AstVar(oldVscp->fileline(), AstVarType::BLOCKTEMP, name,
+                                       oldVscp->varp());
+                    varpr->dtypeFrom(oldVscp);
+                    modp->addStmtp(varpr);
+                }
+                varpr->addProducingMTaskId(recipientp->id());
+                varpr->addConsumingMTaskId(recipientp->id());
+                varpr->addWritingMTaskId(recipientp->id());
+                AstVarScope* newVscp
+                    = new AstVarScope(oldVscp->fileline(), oldVscp->scopep(), varpr);
+                oldVscp->scopep()->addVarp(newVscp);
+                vscMap[oldVscp] = newVscp;
+            }
+            // Read the private copies in the recipient's logic
+            for (MTaskState::Logics::const_iterator it = recipientState.m_logics.begin();
+                 it != recipientState.m_logics.end(); ++it) {
+                OrderRecomputeRelinkVisitor relink((*it)->nodep(), vscMap);
+            }
+            // Copy the donor's logic ahead of the recipient's
+            MTaskState::Logics::iterator insertIt = recipientState.m_logics.begin();
+            for (MTaskState::Logics::const_iterator it = logics.begin(); it != logics.end();
+                 ++it) {
+                AstNode* newp = (*it)->nodep()->cloneTree(false);
+                (*it)->nodep()->addNextHere(newp);
+                OrderRecomputeRelinkVisitor relink(newp, vscMap);
+                recipientState.m_logics.insert(
+                    insertIt, new OrderLogicVertex(logicGraphp, (*it)->scopep(),
+                                                   (*it)->domainp(), newp));
+            }
+            // Depend on the donor's parents instead of the donor
+            droppedr.insert(std::make_pair(recipientp->id(), donorp->id()));
+            for (const V3GraphEdge* inp = donorp->inBeginp(); inp; inp = inp->inNextp()) {
+                const AbstractLogicMTask* fromp
+                    = dynamic_cast<const AbstractLogicMTask*>(inp->fromp());
+                addedr.insert(std::make_pair(recipientp->id(), fromp->id()));
+            }
+            ++m_statRecomputed;
+        }
+    }
+}
+
 //######################################################################
 // OrderVisitor - Top processing
 
@@ -2034,7 +2534,8 @@ void V3Order::orderAll(AstNetlist* nodep) {
     UINFO(2, __FUNCTION__ << ": " << endl);
     {
         OrderClkMarkVisitor markVisitor(nodep);
-        OrderVisitor visitor;
+        OrderDerivedClkVisitor derivedVisitor(nodep);
+        OrderVisitor visitor(&derivedVisitor);
         visitor.main(nodep);
     }  // Destruct before checking
     V3Global::dumpCheckGlobalTree("order", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
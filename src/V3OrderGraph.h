@@ -498,6 +498,17 @@ public:
         if (!oedgep) v3fatalSrc("Following edge of non-OrderEdge type");
         return (oedgep->followSequentConnected());
     }
+    // Cutting a loop at a variable makes it change detected, so each eval
+    // compares its words, and a change reevaluates its consumers
+    static uint32_t varCutCost(const V3GraphVertex* vertexp) {
+        const OrderVarVertex* vvertexp = dynamic_cast<const OrderVarVertex*>(vertexp);
+        if (!vvertexp) return 1;
+        uint32_t cost = vvertexp->varScp()->varp()->widthWords();
+        for (const V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep = edgep->outNextp()) {
+            ++cost;
+        }
+        return cost;
+    }
 };
 
 class OrderComboCutEdge : public OrderEdge {
@@ -518,6 +529,7 @@ public:
         return new OrderComboCutEdge(graphp, fromp, top, *this);
     }
     virtual string dotColor() const { return "yellowGreen"; }
+    virtual uint32_t cutCost() const { return varCutCost(top()); }
     virtual bool followComboConnected() const { return true; }
     virtual bool followSequentConnected() const { return true; }
 };
@@ -540,6 +552,7 @@ public:
         return new OrderPostCutEdge(graphp, fromp, top, *this);
     }
     virtual string dotColor() const { return "PaleGreen"; }
+    virtual uint32_t cutCost() const { return varCutCost(top()); }
     virtual bool followComboConnected() const { return false; }
     virtual bool followSequentConnected() const { return true; }
 };
@@ -35,6 +35,7 @@
 
 #include <cerrno>
 #include <climits>
+#include <ctime>
 #include <cstdarg>
 #include <dirent.h>
 #include <fcntl.h>
@@ -298,6 +299,10 @@ uint64_t V3Os::timeUsecs() {
 #endif
 }
 
+uint64_t V3Os::cpuUsecs() {
+    return static_cast<uint64_t>(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+}
+
 uint64_t V3Os::memUsageBytes() {
 #if defined(_WIN32) || defined(__MINGW32__)
     HANDLE process = GetCurrentProcess();
@@ -63,6 +63,8 @@ public:
     static void u_sleep(int64_t usec);  ///< Sleep for a given number of microseconds.
     /// Return wall time since epoch in microseconds, or 0 if not implemented
     static uint64_t timeUsecs();
+    /// Return processor time used by this process in microseconds
+    static uint64_t cpuUsecs();
     static uint64_t memUsageBytes();  ///< Return memory usage in bytes, or 0 if not implemented
 
     // METHODS (sub command)
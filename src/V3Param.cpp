@@ -55,11 +55,13 @@
 #include "V3Width.h"
 #include "V3Unroll.h"
 #include "V3Hashed.h"
+#include "V3Stats.h"
 
 #include <cstdarg>
 #include <deque>
 #include <map>
 #include <vector>
+#include VL_INCLUDE_UNORDERED_MAP
 
 //######################################################################
 // Param state, as a visitor of each AstNode
@@ -92,7 +94,7 @@ private:
     typedef std::map<string, ModInfo> ModNameMap;
     ModNameMap m_modNameMap;  // Hash of created module flavors by name
 
-    typedef std::map<string, string> LongMap;
+    typedef vl_unordered_map<string, string> LongMap;
     LongMap m_longMap;  // Hash of very long names to unique identity number
     int m_longId;
 
@@ -115,6 +117,9 @@ private:
 
     string m_generateHierName;  // Generate portion of hierarchical name
 
+    VDouble0 m_statClones;  // Statistic tracking
+    VDouble0 m_statReused;  // Statistic tracking
+
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
 
@@ -149,6 +154,33 @@ private:
         }
         return st;
     }
+    int paramConvertedWidth(AstVar* modvarp) {
+        // Width an integral override is converted to as the parameter has an
+        // explicit type, or 0 if the parameter instead takes the override's width
+        AstBasicDType* bdtp = VN_CAST(modvarp->subDTypep(), BasicDType);
+        if (!bdtp || bdtp->implicit() || !bdtp->keyword().isIntNumeric()) return 0;
+        if (AstRange* rangep = bdtp->rangep()) {
+            if (!VN_IS(rangep->msbp(), Const) || !VN_IS(rangep->lsbp(), Const)) return 0;
+            return rangep->elementsConst();
+        }
+        return bdtp->keyword().width();
+    }
+    string paramCanonicalValue(AstVar* modvarp, AstConst* constp) {
+        // Value as it will be once converted to the parameter's type, so
+        // overrides that differ only before conversion share one module
+        const V3Number& num = constp->num();
+        int width = paramConvertedWidth(modvarp);
+        if (!width || num.isDouble() || num.isString() || num.isFourState()) {
+            return num.ascii(false);
+        }
+        V3Number canon(constp, width);
+        if (num.isSigned() && width > num.width()) {
+            canon.opExtendS(num, num.width());
+        } else {
+            canon.opAssign(num);
+        }
+        return canon.ascii(false);
+    }
     string paramValueNumber(AstNode* nodep) {
         string key = nodep->name();
         if (AstIfaceRefDType* ifrtp = VN_CAST(nodep, IfaceRefDType)) {
@@ -551,7 +583,10 @@ public:
         //
         iterate(nodep);
     }
-    virtual ~ParamVisitor() {}
+    virtual ~ParamVisitor() {
+        V3Stats::addStat("Param, specialized modules", m_statClones);
+        V3Stats::addStat("Param, specialized modules reused", m_statReused);
+    }
 };
 
 //----------------------------------------------------------------------
@@ -602,7 +637,13 @@ void ParamVisitor::visitCell(AstCell* nodep, const string& hierName) {
                                       << pinp->prettyNameQ() << " of " << nodep->prettyNameQ());
                         pinp->exprp()->replaceWith(new AstConst(
                             pinp->fileline(), AstConst::WidthedValue(), modvarp->width(), 0));
-                    } else if (origp && exprp->sameTree(origp)) {
+                    } else if (origp
+                               && (exprp->sameTree(origp)
+                                   || (paramConvertedWidth(modvarp)
+                                       && !exprp->num().isFourState()
+                                       && !origp->num().isFourState()
+                                       && (paramCanonicalValue(modvarp, exprp)
+                                           == paramCanonicalValue(modvarp, origp))))) {
                         // Setting parameter to its default value.  Just ignore it.
                         // This prevents making additional modules, and makes coverage more
                         // obvious as it won't show up under a unique module page name.
@@ -613,7 +654,7 @@ void ParamVisitor::visitCell(AstCell* nodep, const string& hierName) {
                         any_overrides = true;
                     } else {
                         longname += ("_" + paramSmallName(srcModp, modvarp)
-                                     + exprp->num().ascii(false));
+                                     + paramCanonicalValue(modvarp, exprp));
                         any_overrides = true;
                     }
                 }
@@ -756,6 +797,7 @@ void ParamVisitor::visitCell(AstCell* nodep, const string& hierName) {
                 // Note all module internal variables will be re-linked to the new modules by clone
                 // However links outside the module (like on the upper cells) will not.
                 cellmodp = srcModp->cloneTree(false);
+                ++m_statClones;
                 cellmodp->name(newname);
                 cellmodp->user5(false);  // We need to re-recurse this module once changed
                 cellmodp->recursive(false);
@@ -829,6 +871,7 @@ void ParamVisitor::visitCell(AstCell* nodep, const string& hierName) {
 
             } else {
                 UINFO(4, "     De-parameterize to old: " << cellmodp << endl);
+                ++m_statReused;
             }
 
             // Have child use this module instead.
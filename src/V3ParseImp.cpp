@@ -248,8 +248,14 @@ double V3ParseImp::parseTimenum(const char* textp) {
 
 size_t V3ParseImp::ppInputToLex(char* buf, size_t max_size) {
     size_t got = 0;
-    while (got < max_size  // Haven't got enough
-           && !m_ppBuffers.empty()) {  // And something buffered
+    while (got < max_size) {  // Haven't got enough
+        if (m_ppBuffers.empty()) {  // Pull more from the preprocessor, if streaming
+            if (!m_ppStreaming) break;
+            if (!V3PreShell::preprocLine(this)) {
+                m_ppStreaming = false;
+                break;
+            }
+        }
         string front = m_ppBuffers.front();
         m_ppBuffers.pop_front();
         size_t len = front.length();
@@ -301,9 +307,13 @@ void V3ParseImp::parseFile(FileLine* fileline, const string& modfilename, bool i
     m_fileline->newContent();
     m_inLibrary = inLibrary;
 
-    // Preprocess into m_ppBuffer
-    bool ok = V3PreShell::preproc(fileline, modfilename, m_filterp, this, errmsg);
+    // Preprocess into m_ppBuffer.  Unless the whole output is needed, the
+    // lexer pulls it from the preprocessor, so it's never all buffered.
+    m_ppStreaming = (!v3Global.opt.preprocOnly() && !v3Global.opt.keepTempFiles()
+                     && v3Global.opt.ppCache().empty());
+    bool ok = V3PreShell::preproc(fileline, modfilename, m_filterp, this, errmsg, m_ppStreaming);
     if (!ok) {
+        m_ppStreaming = false;
         if (errmsg != "") return;  // Threw error already
         // Create fake node for later error reporting
         AstNodeModule* nodep = new AstNotFoundModule(fileline, modname);
@@ -123,6 +123,7 @@ class V3ParseImp {
     std::deque<V3Number*> m_numberps;  // Created numbers for later cleanup
     std::deque<FileLine> m_lintState;  // Current lint state for save/restore
     std::deque<string> m_ppBuffers;  // Preprocessor->lex buffer of characters to process
+    bool m_ppStreaming;  // Preprocessor output is pulled into m_ppBuffers as lexed
 
     string m_tag;  // Contents (if any) of current verilator tag
     AstNode* m_tagNodep;  // Points to the node to set to m_tag or NULL to not set.
@@ -247,6 +248,7 @@ public:
         m_lexerp = NULL;
         m_inCellDefine = false;
         m_inLibrary = false;
+        m_ppStreaming = false;
         m_inBeginKwd = 0;
         m_lastVerilogState = stateVerilogRecent();
         m_prevLexToken = 0;
@@ -22,14 +22,19 @@
 #include "V3GraphAlg.h"
 #include "V3GraphPathChecker.h"
 #include "V3GraphStream.h"
+#include "V3Hashed.h"
 #include "V3InstrCount.h"
 #include "V3Partition.h"
 #include "V3PartitionGraph.h"
 #include "V3Scoreboard.h"
 #include "V3Stats.h"
 
+#include <algorithm>
+#include <iomanip>
 #include <list>
+#include <map>
 #include <memory>
+#include <vector>
 #include VL_INCLUDE_UNORDERED_SET
 
 class MergeCandidate;
@@ -139,6 +144,17 @@ class MergeCandidate;
 //  (# of threads * PART_DEFAULT_MAX_MTASKS_PER_THREAD)
 #define PART_DEFAULT_MAX_MTASKS_PER_THREAD 50
 
+// With --threads-xthread-cost, merging the two ends of an edge removes
+// that edge's cross-thread communication cost. The edge's score is
+// lowered by that cost, but by no more than this percent of its critical
+// path, so communication never overrides the critical path limit by much.
+#define PART_XTHREAD_MAX_BONUS_PCT 25
+
+// With --threads-auto, use the fewest threads whose packed schedule is
+// estimated to be within this percent of the fastest schedule. Each extra
+// thread has synchronization costs the estimate doesn't fully capture.
+#define PART_AUTO_THREADS_SLACK_PCT 5
+
 //   end tunables.
 
 //######################################################################
@@ -455,6 +471,10 @@ private:
 
     uint32_t m_serialId;  // Unique MTask ID number
 
+    // Hash of the logic in this mtask, which unlike the ID doesn't change
+    // when unrelated logic is added or removed.
+    uint32_t m_hash;
+
     // Count "generations" which are just operations that scan through the
     // graph. We'll mark each node with the last generation that scanned
     // it. We can use this to avoid recursing through the same node twice
@@ -476,12 +496,17 @@ public:
     LogicMTask(V3Graph* graphp, MTaskMoveVertex* mtmvVxp)
         : AbstractLogicMTask(graphp)
         , m_cost(0)
+        , m_hash(0)
         , m_generation(0) {
         for (int i = 0; i < GraphWay::NUM_WAYS; ++i) m_critPathCost[i] = 0;
         if (mtmvVxp) {  // Else null for test
             m_vertices.push_back(mtmvVxp);
             if (OrderLogicVertex* olvp = mtmvVxp->logicp()) {
                 m_cost += V3InstrCount::count(olvp->nodep(), true);
+                m_hash = V3Hashed::uncachedHash(olvp->nodep()).fullValue();
+                if (mtmvVxp->scopep()) {
+                    m_hash = m_hash * 31 + V3Hash(mtmvVxp->scopep()->name()).fullValue();
+                }
             }
         }
         // Start at 1, so that 0 indicates no mtask ID.
@@ -495,6 +520,7 @@ public:
         // splice() is constant time
         m_vertices.splice(m_vertices.end(), otherp->m_vertices);
         m_cost += otherp->m_cost;
+        m_hash += otherp->m_hash;  // Sum, so independent of merge order
     }
     virtual const VxList* vertexListp() const { return &m_vertices; }
     static vluint64_t incGeneration() {
@@ -508,6 +534,16 @@ public:
     // the final C++ output.
     virtual uint32_t id() const { return m_serialId; }
     void id(uint32_t id) { m_serialId = id; }
+    uint32_t hash() const { return m_hash; }
+    virtual int sortCmp(const V3GraphVertex* rhsp) const {
+        // Break V3Graph's rank and fanout ties by ID, so with --threads-stable
+        // the order follows the logic rather than the order it was created in
+        if (int cmp = V3GraphVertex::sortCmp(rhsp)) return cmp;
+        const LogicMTask* rmtaskp = static_cast<const LogicMTask*>(rhsp);
+        if (m_serialId < rmtaskp->m_serialId) return -1;
+        if (m_serialId > rmtaskp->m_serialId) return 1;
+        return 0;
+    }
     // Abstract cost of every logic mtask
     virtual uint32_t cost() const { return m_cost; }
     void setCost(uint32_t cost) { m_cost = cost; }  // For tests only
@@ -786,10 +822,14 @@ public:
 
 // GraphEdge for the MTask graph
 class MTaskEdge : public V3GraphEdge, public MergeCandidate {
+private:
+    uint32_t m_commCost;  // Estimated cost if the ends run on different threads
+
 public:
     // CONSTRUCTORS
     MTaskEdge(V3Graph* graphp, LogicMTask* fromp, LogicMTask* top, int weight)
-        : V3GraphEdge(graphp, fromp, top, weight) {
+        : V3GraphEdge(graphp, fromp, top, weight)
+        , m_commCost(0) {
         fromp->addRelative(GraphWay::FORWARD, top);
         top->addRelative(GraphWay::REVERSE, fromp);
     }
@@ -798,6 +838,8 @@ public:
         toMTaskp()->removeRelative(GraphWay::REVERSE, fromMTaskp());
     }
     // METHODS
+    uint32_t commCost() const { return m_commCost; }
+    void commCost(uint32_t cost) { m_commCost = cost; }
     LogicMTask* furtherMTaskp(GraphWay way) const {
         return dynamic_cast<LogicMTask*>(this->furtherp(way));
     }
@@ -1034,15 +1076,15 @@ static void partMergeEdgesFrom(V3Graph* mtasksp, LogicMTask* recipientp, LogicMT
         for (V3GraphEdge* edgep = donorp->beginp(way); edgep; edgep = partBlastEdgep(way, edgep)) {
             MTaskEdge* tedgep = MTaskEdge::cast(edgep);
             if (sbp && !tedgep->removedFromSb()) sbp->removeElem(tedgep);
-            // Existing edge; mark it in need of a rescore
+            // Existing edge; it now also carries the donor's communication,
+            // mark it in need of a rescore
             if (recipientp->hasRelative(way, tedgep->furtherMTaskp(way))) {
-                if (sbp) {
-                    MTaskEdge* existMTaskEdgep = MTaskEdge::cast(
-                        recipientp->findConnectingEdgep(way, tedgep->furtherMTaskp(way)));
-                    UASSERT(existMTaskEdgep, "findConnectingEdge didn't find edge");
-                    if (!existMTaskEdgep->removedFromSb()) {
-                        sbp->hintScoreChanged(existMTaskEdgep);
-                    }
+                MTaskEdge* existMTaskEdgep = MTaskEdge::cast(
+                    recipientp->findConnectingEdgep(way, tedgep->furtherMTaskp(way)));
+                UASSERT(existMTaskEdgep, "findConnectingEdge didn't find edge");
+                existMTaskEdgep->commCost(existMTaskEdgep->commCost() + tedgep->commCost());
+                if (sbp && !existMTaskEdgep->removedFromSb()) {
+                    sbp->hintScoreChanged(existMTaskEdgep);
                 }
             } else {
                 // No existing edge into *this, make one.
@@ -1052,6 +1094,7 @@ static void partMergeEdgesFrom(V3Graph* mtasksp, LogicMTask* recipientp, LogicMT
                 } else {
                     newEdgep = new MTaskEdge(mtasksp, recipientp, tedgep->toMTaskp(), 1);
                 }
+                newEdgep->commCost(tedgep->commCost());
                 if (sbp) sbp->addElem(newEdgep);
             }
         }
@@ -1459,7 +1502,7 @@ private:
         return mergedCpCostRev + mergedCpCostFwd + LogicMTask::stepCost(ap->cost() + bp->cost());
     }
 
-    static uint32_t edgeScore(const V3GraphEdge* edgep) {
+    static uint32_t edgeScore(const MTaskEdge* edgep) {
         // Score this edge. Lower is better. The score is the new local CP
         // length if we merge these mtasks.  ("Local" means the longest
         // critical path running through the merged node.)
@@ -1469,8 +1512,12 @@ private:
                                             top->critPathCostWithout(GraphWay::FORWARD, edgep));
         uint32_t mergedCpCostRev = std::max(fromp->critPathCostWithout(GraphWay::REVERSE, edgep),
                                             top->critPathCost(GraphWay::REVERSE));
-        return mergedCpCostRev + mergedCpCostFwd
-               + LogicMTask::stepCost(fromp->cost() + top->cost());
+        uint32_t cp = mergedCpCostRev + mergedCpCostFwd
+                      + LogicMTask::stepCost(fromp->cost() + top->cost());
+        // Favor merges that keep heavy producer/consumer traffic on one thread
+        uint32_t maxBonus = static_cast<uint32_t>(
+            (static_cast<vluint64_t>(cp) * PART_XTHREAD_MAX_BONUS_PCT) / 100);
+        return cp - std::min(edgep->commCost(), maxBonus);
     }
 
     void makeSiblingMC(LogicMTask* ap, LogicMTask* bp) {
@@ -1680,8 +1727,9 @@ private:
         if (!m_tracingCall) return;
         m_tracingCall = false;
         if (nodep->dpiImportWrapper()) {
-            if (nodep->pure() ? !v3Global.opt.threadsDpiPure()
-                              : !v3Global.opt.threadsDpiUnpure()) {
+            // User-declared threadsafe imports are serialized no more than pure ones
+            if ((nodep->pure() || nodep->dpiThreadsafe()) ? !v3Global.opt.threadsDpiPure()
+                                                          : !v3Global.opt.threadsDpiUnpure()) {
                 m_hasDpiHazard = true;
             }
         }
@@ -2038,6 +2086,252 @@ private:
     VL_DEBUG_FUNC;
 };
 
+//######################################################################
+// PartCoarsen
+
+// Cheap first level of coarsening, ahead of PartContraction.
+//
+// When an mtask's only child has no other parent, the two always run back
+// to back. Merging them can't lengthen any critical path, or remove any
+// parallelism. Merging every such chain takes one pass over the graph, so
+// on large designs most of the fine-grained vertices are gone before the
+// contractor's much costlier scoreboard and critical path updates see
+// them.
+//
+// Merged mtasks are kept within the contractor's cost limit, so later
+// packing still has pieces small enough to balance across threads.
+
+class PartCoarsen {
+private:
+    // MEMBERS
+    V3Graph* m_mtasksp;  // Mtask graph
+    uint32_t m_costLimit;  // Largest mtask cost we'll create
+    unsigned m_mergesDone;  // Number of MTasks merged. For stats only.
+
+public:
+    // CONSTRUCTORS
+    PartCoarsen(V3Graph* mtasksp, uint32_t costLimit)
+        : m_mtasksp(mtasksp)
+        , m_costLimit(costLimit)
+        , m_mergesDone(0) {}
+
+    // METHODS
+    void go() {
+        // Snapshot the mtasks, as children are removed from the graph as they merge
+        std::vector<LogicMTask*> mtasks;
+        for (V3GraphVertex* vxp = m_mtasksp->verticesBeginp(); vxp;
+             vxp = vxp->verticesNextp()) {
+            mtasks.push_back(dynamic_cast<LogicMTask*>(vxp));
+        }
+        vl_unordered_set<LogicMTask*> merged;
+        for (std::vector<LogicMTask*>::iterator it = mtasks.begin(); it != mtasks.end(); ++it) {
+            LogicMTask* recipientp = *it;
+            if (merged.find(recipientp) != merged.end()) continue;
+            while (LogicMTask* donorp = chainChildp(recipientp)) {
+                if (recipientp->cost() + donorp->cost() > m_costLimit) break;
+                // Remove the connecting edge, then donorp's children become recipientp's.
+                // Ranks stay valid as recipientp ranks below all of donorp's children.
+                recipientp->outBeginp()->unlinkDelete();
+                recipientp->moveAllVerticesFrom(donorp);
+                partMergeEdgesFrom(m_mtasksp, recipientp, donorp, NULL);
+                merged.insert(donorp);
+                VL_DO_DANGLING(donorp->unlinkDelete(m_mtasksp), donorp);
+                ++m_mergesDone;
+            }
+        }
+        UINFO(4, "PartCoarsen() merged " << m_mergesDone << " chained mtasks\n");
+        V3Stats::addStat("MTask graph, coarsen, chain merges", m_mergesDone);
+    }
+
+private:
+    static LogicMTask* chainChildp(LogicMTask* mtaskp) {
+        // Return mtaskp's only child, if mtaskp is that child's only parent
+        V3GraphEdge* edgep = mtaskp->outBeginp();
+        if (!edgep || edgep->outNextp()) return NULL;
+        LogicMTask* childp = dynamic_cast<LogicMTask*>(edgep->top());
+        if (childp->inBeginp()->inNextp()) return NULL;
+        return childp;
+    }
+
+    VL_UNCOPYABLE(PartCoarsen);
+    VL_DEBUG_FUNC;
+};
+
+//######################################################################
+// PartMergeSmall
+
+// Merge mtasks too small to be worth dispatching, after PartContraction.
+//
+// Small mtasks mostly hold the logic of small clock domains, which the
+// contractor won't merge when it doesn't shorten the critical path. Each
+// one still costs a dependency check and a hand-off at runtime. An mtask
+// below the cost threshold is merged into its only parent, or failing
+// that into its only child. The connecting edge is then the only path
+// between the pair, so merging can't create a cycle. The logic of each
+// domain keeps its own AstActive, so merged logic is still only run when
+// its domain triggers.
+
+class PartMergeSmall {
+private:
+    // MEMBERS
+    V3Graph* m_mtasksp;  // Mtask graph
+    uint32_t m_minCost;  // Mtasks cheaper than this are merged
+    unsigned m_mergesDone;  // Number of MTasks merged. For stats only.
+
+public:
+    // CONSTRUCTORS
+    PartMergeSmall(V3Graph* mtasksp, uint32_t minCost)
+        : m_mtasksp(mtasksp)
+        , m_minCost(minCost)
+        , m_mergesDone(0) {}
+
+    // METHODS
+    void go() {
+        // Snapshot the mtasks, as donors are removed from the graph as they merge
+        std::vector<LogicMTask*> mtasks;
+        for (V3GraphVertex* vxp = m_mtasksp->verticesBeginp(); vxp;
+             vxp = vxp->verticesNextp()) {
+            mtasks.push_back(dynamic_cast<LogicMTask*>(vxp));
+        }
+        vl_unordered_set<LogicMTask*> merged;
+        for (std::vector<LogicMTask*>::iterator it = mtasks.begin(); it != mtasks.end(); ++it) {
+            LogicMTask* donorp = *it;
+            if (merged.find(donorp) != merged.end()) continue;
+            if (donorp->cost() >= m_minCost) continue;
+            V3GraphEdge* edgep = donorp->inBeginp();
+            LogicMTask* recipientp = NULL;
+            if (edgep && !edgep->inNextp()) {
+                recipientp = dynamic_cast<LogicMTask*>(edgep->fromp());
+            } else {
+                edgep = donorp->outBeginp();
+                if (!edgep || edgep->outNextp()) continue;
+                recipientp = dynamic_cast<LogicMTask*>(edgep->top());
+            }
+            // Remove the connecting edge, then donorp's other edges become recipientp's.
+            VL_DO_DANGLING(edgep->unlinkDelete(), edgep);
+            recipientp->moveAllVerticesFrom(donorp);
+            partMergeEdgesFrom(m_mtasksp, recipientp, donorp, NULL);
+            merged.insert(donorp);
+            VL_DO_DANGLING(donorp->unlinkDelete(m_mtasksp), donorp);
+            ++m_mergesDone;
+        }
+        UINFO(4, "PartMergeSmall() merged " << m_mergesDone << " small mtasks\n");
+        V3Stats::addStat("MTask graph, merge small, merges", m_mergesDone);
+    }
+
+private:
+    VL_UNCOPYABLE(PartMergeSmall);
+    VL_DEBUG_FUNC;
+};
+
+//######################################################################
+// PartProfileFeedback
+
+// Read back the profile written by a --prof-threads run, so measured mtask
+// runtimes can replace the V3InstrCount estimates when packing mtasks.
+//
+// The profile only identifies final mtasks by ID, so it is only usable
+// when it came from the same design and options, such that partitioning
+// produces the same mtasks again.  Contraction is therefore left to use
+// the estimates; using measurements there would renumber the mtasks and
+// make the profile unusable for the next iteration.
+class PartProfileFeedback {
+private:
+    // TYPES
+    struct Measured {
+        vluint64_t m_elapsed;  // Sum of elapsed ticks over all samples
+        vluint64_t m_samples;  // Number of times the mtask was recorded
+        Measured()
+            : m_elapsed(0)
+            , m_samples(0) {}
+    };
+    typedef std::map<uint32_t, Measured> MeasuredMap;
+
+    // MEMBERS
+    const string m_filename;  // Profile filename
+    MeasuredMap m_measured;  // Measurements, by mtask ID
+    int m_threads;  // --threads the profile was made with
+
+public:
+    // CONSTRUCTORS
+    explicit PartProfileFeedback(const string& filename)
+        : m_filename(filename)
+        , m_threads(0) {
+        const vl_unique_ptr<std::ifstream> ifp(V3File::new_ifstream(filename));
+        if (ifp->fail()) {
+            v3fatal("Cannot open --prof-threads-feedback file: " << filename);
+            return;
+        }
+        string line;
+        while (std::getline(*ifp, line)) {
+            unsigned id;
+            unsigned threads;
+            vluint64_t start;
+            vluint64_t end;
+            vluint64_t elapsed;
+            if (sscanf(line.c_str(),
+                       "VLPROF mtask %u start %" VL_PRI64 "u end %" VL_PRI64 "u elapsed %" VL_PRI64
+                       "u",
+                       &id, &start, &end, &elapsed)
+                == 4) {
+                Measured& measured = m_measured[id];
+                measured.m_elapsed += elapsed;
+                ++measured.m_samples;
+            } else if (sscanf(line.c_str(), "VLPROF arg --threads %u", &threads) == 1) {
+                m_threads = threads;
+            }
+        }
+    }
+    ~PartProfileFeedback() {}
+
+    // METHODS
+    // Replace the cost of every mtask in the graph with its measured cost,
+    // scaled to the same units.  Returns false, leaving the graph alone, if
+    // the profile does not match the graph.
+    bool apply(V3Graph* execMTaskGraphp) {
+        uint32_t mtasks = 0;
+        double estimateTotal = 0;
+        double measuredTotal = 0;
+        for (V3GraphVertex* vxp = execMTaskGraphp->verticesBeginp(); vxp;
+             vxp = vxp->verticesNextp()) {
+            ExecMTask* mtp = dynamic_cast<ExecMTask*>(vxp);
+            if (!mtp->bodyp()->stmtsp()) continue;  // Will be removed, so never measured
+            ++mtasks;
+            MeasuredMap::const_iterator it = m_measured.find(mtp->id());
+            if (it == m_measured.end()) return outOfDate("mtask " + cvtToStr(mtp->id()));
+            estimateTotal += mtp->cost();
+            measuredTotal += double(it->second.m_elapsed) / it->second.m_samples;
+        }
+        if (m_threads != v3Global.opt.threads()) {
+            return outOfDate("--threads " + cvtToStr(m_threads));
+        }
+        if (mtasks != m_measured.size()) return outOfDate("mtask count");
+        if (measuredTotal <= 0) return outOfDate("no elapsed time");
+
+        // Convert ticks into the same units as the estimates
+        const double scale = estimateTotal / measuredTotal;
+        for (V3GraphVertex* vxp = execMTaskGraphp->verticesBeginp(); vxp;
+             vxp = vxp->verticesNextp()) {
+            ExecMTask* mtp = dynamic_cast<ExecMTask*>(vxp);
+            MeasuredMap::const_iterator it = m_measured.find(mtp->id());
+            if (it == m_measured.end()) continue;
+            double cost = scale * it->second.m_elapsed / it->second.m_samples;
+            UINFO(6, "Feedback " << mtp->name() << " estimate " << mtp->cost() << " measured "
+                                 << cost << endl);
+            mtp->cost(std::max(1U, static_cast<uint32_t>(cost)));
+        }
+        V3Stats::addStat("MTask graph, feedback, mtasks with measured cost", mtasks);
+        return true;
+    }
+
+private:
+    bool outOfDate(const string& what) {
+        v3warn(PROFOUTOFDATE, "--prof-threads-feedback profile does not match design ("
+                                  << what << "), ignoring: " << m_filename);
+        return false;
+    }
+};
+
 //######################################################################
 // PartPackMTasks
 
@@ -2071,6 +2365,7 @@ private:
     uint32_t m_nThreads;  // Number of threads
     uint32_t m_sandbagNumerator;  // Numerator padding for est runtime
     uint32_t m_sandbagDenom;  // Denomerator padding for est runtime
+    uint32_t m_xthreadCost;  // Cost to signal a dependency across threads
 
     typedef vl_unordered_map<const ExecMTask*, MTaskState> MTaskStateMap;
     MTaskStateMap m_mtaskState;  // State for each mtask.
@@ -2084,6 +2379,12 @@ private:
     MTaskVec m_prevMTask;  // Previous mtask scheduled to each thread.
     std::vector<uint32_t> m_busyUntil;  // Time each thread is occupied until
 
+    typedef std::vector<std::pair<const AstVar*, uint32_t> > Footprint;  // Var, cache lines
+    typedef vl_unordered_map<uint32_t, Footprint> FootprintMap;
+    FootprintMap m_footprints;  // Vars used by each mtask id
+    typedef vl_unordered_map<const AstVar*, uint32_t> VarThreadMap;
+    VarThreadMap m_varThread;  // Thread of the last mtask packed that used each var
+
 public:
     // CONSTRUCTORS
     explicit PartPackMTasks(V3Graph* mtasksp, uint32_t nThreads = v3Global.opt.threads(),
@@ -2092,6 +2393,7 @@ public:
         , m_nThreads(nThreads)
         , m_sandbagNumerator(sandbagNumerator)
         , m_sandbagDenom(sandbagDenom)
+        , m_xthreadCost(v3Global.opt.threadsXthreadCost())
         , m_ready(m_mtaskCmp) {}
     ~PartPackMTasks() {}
 
@@ -2105,9 +2407,10 @@ public:
         }
 
         // Add some padding to the estimated runtime when looking from
-        // another thread
-        uint32_t sandbaggedEndTime
-            = state.completionTime + (m_sandbagNumerator * mtaskp->cost()) / m_sandbagDenom;
+        // another thread, plus the time for the dependency to cross over
+        uint32_t sandbaggedEndTime = state.completionTime
+                                     + (m_sandbagNumerator * mtaskp->cost()) / m_sandbagDenom
+                                     + m_xthreadCost;
 
         // If task B is packed after task A on thread 0, don't let thread 1
         // think that A finishes later than thread 0 thinks that B
@@ -2130,6 +2433,45 @@ public:
         state.completionTime = time;
     }
 
+    void buildFootprints() {
+        // V3Order recorded the mtasks using each variable
+        for (const AstNodeModule* modp = v3Global.rootp()->modulesp(); modp;
+             modp = VN_CAST_CONST(modp->nextp(), NodeModule)) {
+            for (const AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+                const AstVar* varp = VN_CAST_CONST(nodep, Var);
+                if (!varp || varp->mtaskIds().empty()) continue;
+                uint32_t bytes = varp->dtypep()->widthTotalBytes();
+                uint32_t lines = (bytes + VL_CACHE_LINE_BYTES - 1) / VL_CACHE_LINE_BYTES;
+                lines = std::min<uint32_t>(std::max<uint32_t>(lines, 1), 64);
+                for (MTaskIdSet::const_iterator it = varp->mtaskIds().begin();
+                     it != varp->mtaskIds().end(); ++it) {
+                    m_footprints[*it].push_back(std::make_pair(varp, lines));
+                }
+            }
+        }
+    }
+
+    uint32_t affinityPenalty(const ExecMTask* mtaskp, uint32_t thread) const {
+        // Time to pull in the mtask's variables that another thread used last,
+        // so consumers are packed where their inputs are already cached
+        FootprintMap::const_iterator fit = m_footprints.find(mtaskp->id());
+        if (fit == m_footprints.end()) return 0;
+        uint32_t lines = 0;
+        for (Footprint::const_iterator it = fit->second.begin(); it != fit->second.end(); ++it) {
+            VarThreadMap::const_iterator vit = m_varThread.find(it->first);
+            if (vit != m_varThread.end() && vit->second != thread) lines += it->second;
+        }
+        return m_xthreadCost * lines;
+    }
+
+    void touchFootprint(const ExecMTask* mtaskp, uint32_t thread) {
+        FootprintMap::const_iterator fit = m_footprints.find(mtaskp->id());
+        if (fit == m_footprints.end()) return;
+        for (Footprint::const_iterator it = fit->second.begin(); it != fit->second.end(); ++it) {
+            m_varThread[it->first] = thread;
+        }
+    }
+
     void go() {
         // Build initial ready list
         for (V3GraphVertex* vxp = m_mtasksp->verticesBeginp(); vxp; vxp = vxp->verticesNextp()) {
@@ -2142,6 +2484,9 @@ public:
         m_busyUntil.clear();
         m_busyUntil.resize(m_nThreads);
 
+        // Data affinity is measured in the same units as cross-thread costs
+        if (m_xthreadCost) buildFootprints();
+
         while (!m_ready.empty()) {
             // For each task in the ready set, compute when it might start
             // on each thread (in that thread's local time frame.)
@@ -2164,6 +2509,7 @@ public:
                         uint32_t priorEndTime = completionTime(priorp, th);
                         if (priorEndTime > timeBegin) timeBegin = priorEndTime;
                     }
+                    timeBegin += affinityPenalty(taskp, th);
                     UINFO(6, "Task " << taskp->name() << " start at " << timeBegin << " on thread "
                                      << th << endl);
                     if ((timeBegin < bestTime)
@@ -2221,6 +2567,7 @@ public:
                 bestMtaskp->threadRoot(true);
             }
             bestMtaskp->thread(bestTh);
+            touchFootprint(bestMtaskp, bestTh);
 
             // Update the thread state
             m_prevMTask[bestTh] = bestMtaskp;
@@ -2228,6 +2575,56 @@ public:
         }
     }
 
+    // Estimated eval time of the packed schedule
+    uint32_t makespan() const {
+        uint32_t result = 0;
+        for (uint32_t th = 0; th < m_busyUntil.size(); ++th) {
+            result = std::max(result, m_busyUntil[th]);
+        }
+        return result;
+    }
+
+    // Forget a previous packing, so the graph can be packed again
+    static void clear(V3Graph* mtasksp) {
+        for (V3GraphVertex* vxp = mtasksp->verticesBeginp(); vxp; vxp = vxp->verticesNextp()) {
+            ExecMTask* mtaskp = dynamic_cast<ExecMTask*>(vxp);
+            mtaskp->thread(0xffffffff);
+            mtaskp->packNextp(NULL);
+            mtaskp->threadRoot(false);
+        }
+    }
+
+    // Pack onto the fewest threads that are nearly as fast as any count
+    static void packAuto(V3Graph* mtasksp) {
+        uint32_t maxThreads = v3Global.opt.threads();
+        std::vector<uint32_t> makespans(maxThreads + 1);
+        uint32_t best = 0xffffffff;
+        for (uint32_t nThreads = 1; nThreads <= maxThreads; ++nThreads) {
+            clear(mtasksp);
+            PartPackMTasks packer(mtasksp, nThreads);
+            packer.go();
+            makespans[nThreads] = packer.makespan();
+            best = std::min(best, makespans[nThreads]);
+            if (v3Global.opt.stats()) {
+                V3Stats::addStat("MTask graph, auto threads, estimate with " + cvtToStr(nThreads)
+                                     + " threads",
+                                 makespans[nThreads]);
+            }
+        }
+        uint32_t selected = maxThreads;
+        for (uint32_t nThreads = 1; nThreads <= maxThreads; ++nThreads) {
+            if (static_cast<vluint64_t>(makespans[nThreads]) * 100
+                <= static_cast<vluint64_t>(best) * (100 + PART_AUTO_THREADS_SLACK_PCT)) {
+                selected = nThreads;
+                break;
+            }
+        }
+        UINFO(4, "Auto threads selected " << selected << " of " << maxThreads << endl);
+        V3Stats::addStat("MTask graph, auto threads, selected", selected);
+        clear(mtasksp);
+        PartPackMTasks(mtasksp, selected).go();
+    }
+
     // SELF TEST
     static void selfTest() {
         V3Graph graph;
@@ -2283,6 +2680,158 @@ private:
     VL_UNCOPYABLE(PartPackMTasks);
 };
 
+//######################################################################
+// PartTailMTasks
+
+// Find the mtasks that may still run after eval() returns, see
+// --threads-pipeline.  Such an mtask has no side effects, and references
+// only variables that no code outside of mtasks references, so neither
+// the client nor the rest of the model can observe it still running.
+// Every mtask depending on it must be such an mtask too, as eval() waits
+// for all the others.
+class PartTailMTasks : public AstNVisitor {
+private:
+    // NODE STATE
+    //  AstCFunc::user1()       // bool. Scanned as code outside of mtasks
+    //  AstCFunc::user2()       // int. 0 if unchecked, 1 if unsafe, 2 if safe in an mtask
+    //  AstVar::user3()         // bool. Referenced outside of mtasks
+    //  AstCFunc::user4()       // bool. Called by an AstNodeCCall
+    AstUser1InUse m_inuser1;
+    AstUser2InUse m_inuser2;
+    AstUser3InUse m_inuser3;
+    AstUser4InUse m_inuser4;
+
+    // TYPES
+    enum Mode { M_CALLED, M_OUTSIDE, M_CHECK };
+
+    // STATE
+    Mode m_mode;  // What we're doing
+    bool m_safe;  // Code checked so far may run after eval() returns
+    VDouble0 m_statTail;  // Statistic tracking
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    static bool initFunc(const AstCFunc* nodep) {
+        // Only runs before the first eval starts any mtasks
+        return nodep->name() == "_eval_initial" || nodep->name() == "_eval_settle"
+               || nodep->name() == "_ctor_var_reset";
+    }
+    void outsideFunc(AstCFunc* nodep) {
+        if (nodep->user1() || initFunc(nodep)) return;
+        nodep->user1(true);
+        iterateChildren(nodep);
+    }
+    bool safeFunc(AstCFunc* nodep) {
+        if (!nodep->user2()) {
+            nodep->user2(1);  // Unsafe if recursive
+            const bool origSafe = m_safe;
+            m_safe = !nodep->dpiImportWrapper();
+            iterateChildren(nodep);
+            nodep->user2(m_safe ? 2 : 1);
+            m_safe = origSafe;
+        }
+        return nodep->user2() == 2;
+    }
+    void unsafe(AstNode* nodep) {
+        if (m_mode != M_CHECK) {
+            iterateChildren(nodep);
+            return;
+        }
+        m_safe = false;
+    }
+
+    // VISITORS
+    virtual void visit(AstExecGraph* nodep) VL_OVERRIDE {
+        if (m_mode == M_CALLED) iterateChildren(nodep);
+    }
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        if (m_mode == M_OUTSIDE && !nodep->user4()) outsideFunc(nodep);
+    }
+    virtual void visit(AstNodeCCall* nodep) VL_OVERRIDE {
+        iterateChildren(nodep);
+        if (m_mode == M_CALLED) {
+            nodep->funcp()->user4(true);
+        } else if (m_mode == M_OUTSIDE) {
+            outsideFunc(nodep->funcp());
+        } else if (!safeFunc(nodep->funcp())) {
+            m_safe = false;
+        }
+    }
+    virtual void visit(AstVar* nodep) VL_OVERRIDE {
+        if (m_mode == M_OUTSIDE && (nodep->isPrimaryIO() || nodep->isSigPublic())) {
+            nodep->user3(true);
+        }
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        AstVar* const varp = nodep->varp();
+        if (m_mode == M_OUTSIDE) {
+            varp->user3(true);
+        } else if (m_mode == M_CHECK
+                   && (varp->user3() || VN_IS(varp->dtypeSkipRefp(), ClassRefDType))) {
+            m_safe = false;
+        }
+        iterateChildren(nodep);
+    }
+    // Side effects, or reading state the client may change
+    virtual void visit(AstCoverInc* nodep) VL_OVERRIDE { unsafe(nodep); }
+    virtual void visit(AstCoverToggle* nodep) VL_OVERRIDE { unsafe(nodep); }
+    virtual void visit(AstCStmt* nodep) VL_OVERRIDE { unsafe(nodep); }
+    virtual void visit(AstDumpCtl* nodep) VL_OVERRIDE { unsafe(nodep); }
+    virtual void visit(AstMemberSel* nodep) VL_OVERRIDE { unsafe(nodep); }
+    virtual void visit(AstRand* nodep) VL_OVERRIDE { unsafe(nodep); }
+    virtual void visit(AstTime* nodep) VL_OVERRIDE { unsafe(nodep); }
+    virtual void visit(AstTimeD* nodep) VL_OVERRIDE { unsafe(nodep); }
+    virtual void visit(AstCMath* nodep) VL_OVERRIDE {
+        if (!nodep->isGateOptimizable()) {
+            unsafe(nodep);
+        } else {
+            iterateChildren(nodep);
+        }
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE {
+        if (m_mode == M_CHECK && !nodep->isPure()) m_safe = false;
+        iterateChildren(nodep);
+    }
+
+public:
+    // CONSTRUCTORS
+    explicit PartTailMTasks(AstExecGraph* execGraphp)
+        : m_safe(true) {
+        AstNetlist* const netlistp = v3Global.rootp();
+        m_mode = M_CALLED;
+        iterate(netlistp);
+        m_mode = M_OUTSIDE;
+        iterate(netlistp);
+        m_mode = M_CHECK;
+        // Downstream mtasks first, as an mtask is a tail only if they all are
+        GraphStreamUnordered ser(execGraphp->mutableDepGraphp(), GraphWay::REVERSE);
+        while (const V3GraphVertex* vxp = ser.nextp()) {
+            ExecMTask* const mtaskp = dynamic_cast<ExecMTask*>(const_cast<V3GraphVertex*>(vxp));
+            bool tail = true;
+            for (V3GraphEdge* edgep = mtaskp->outBeginp(); tail && edgep;
+                 edgep = edgep->outNextp()) {
+                tail = dynamic_cast<ExecMTask*>(edgep->top())->tail();
+            }
+            if (!tail) continue;
+            m_safe = true;
+            iterateChildren(mtaskp->bodyp());
+            if (m_safe) {
+                UINFO(6, "Tail " << mtaskp->name() << endl);
+                mtaskp->tail(true);
+                ++m_statTail;
+            }
+        }
+    }
+    virtual ~PartTailMTasks() {
+        V3Stats::addStat("MTask graph, mtasks running past eval", m_statTail);
+    }
+
+private:
+    VL_UNCOPYABLE(PartTailMTasks);
+};
+
 //######################################################################
 // V3Partition implementation
 
@@ -2362,6 +2911,23 @@ void V3Partition::hashGraphDebug(const V3Graph* graphp, const char* debugName) {
     UINFO(0, "Hash of shape (not contents) of " << debugName << " = " << cvtToStr(hash) << endl);
 }
 
+static uint32_t partDepCommCost(const MTaskMoveVertex* fromp, const MTaskMoveVertex* top) {
+    // Estimated cost of this dependency if its ends run on different
+    // threads: the signalling cost, plus that again for each cache line of
+    // the variable passed through it
+    uint32_t xthreadCost = v3Global.opt.threadsXthreadCost();
+    if (!xthreadCost) return 0;
+    const OrderVarVertex* varVxp = dynamic_cast<const OrderVarVertex*>(fromp->varp());
+    if (!varVxp) varVxp = dynamic_cast<const OrderVarVertex*>(top->varp());
+    uint32_t lines = 0;
+    if (varVxp) {
+        uint32_t bytes = varVxp->varScp()->varp()->dtypep()->widthTotalBytes();
+        lines = (bytes + VL_CACHE_LINE_BYTES - 1) / VL_CACHE_LINE_BYTES;
+    }
+    // Saturate, huge arrays will not be copied entirely anyway
+    return xthreadCost * std::min<uint32_t>(1 + lines, 64);
+}
+
 void V3Partition::setupMTaskDeps(V3Graph* mtasksp, const Vx2MTaskMap* vx2mtaskp) {
     // Look at each mtask
     for (V3GraphVertex* itp = mtasksp->verticesBeginp(); itp; itp = itp->verticesNextp()) {
@@ -2386,15 +2952,101 @@ void V3Partition::setupMTaskDeps(V3Graph* mtasksp, const Vx2MTaskMap* vx2mtaskp)
                 if (mtaskp->hasRelative(GraphWay::FORWARD, otherMTaskp)) {  //
                     continue;
                 }
-                new MTaskEdge(mtasksp, mtaskp, otherMTaskp, 1);
+                MTaskEdge* newEdgep = new MTaskEdge(mtasksp, mtaskp, otherMTaskp, 1);
+                newEdgep->commCost(partDepCommCost(*vit, top));
+            }
+        }
+    }
+}
+
+static void partPhaseTime(const string& stage, uint64_t* lastUsecsp) {
+    // With --stats, record time spent in each partitioning phase
+    if (!v3Global.opt.stats()) return;
+    uint64_t nowUsecs = V3Os::timeUsecs();
+    V3Stats::addStatPerf("MTask graph, " + stage + ", elapsed time (sec)",
+                         (nowUsecs - *lastUsecsp) / 1.0e6);
+    *lastUsecsp = nowUsecs;
+}
+
+static void partStableIds(V3Graph* mtasksp) {
+    // Renumber the initial mtasks in order of the hash of their logic, and
+    // reorder the graph to match. All of the partitioner's tie-breaking
+    // follows IDs or graph order, so an edit then only perturbs the
+    // mtasks whose logic changed, instead of renumbering everything
+    // created after the edit.
+    typedef std::vector<std::pair<std::pair<uint32_t, uint32_t>, LogicMTask*> > HashedVec;
+    HashedVec hashed;  // (hash, old ID), mtask
+    std::vector<uint32_t> ids;
+    for (V3GraphVertex* vxp = mtasksp->verticesBeginp(); vxp; vxp = vxp->verticesNextp()) {
+        LogicMTask* mtaskp = dynamic_cast<LogicMTask*>(vxp);
+        hashed.push_back(std::make_pair(std::make_pair(mtaskp->hash(), mtaskp->id()), mtaskp));
+        ids.push_back(mtaskp->id());
+    }
+    std::sort(hashed.begin(), hashed.end());
+    std::sort(ids.begin(), ids.end());
+    for (size_t i = 0; i < hashed.size(); ++i) hashed[i].second->id(ids[i]);
+    mtasksp->sortVertices();
+}
+
+static void partReport(const V3Graph* mtasksp) {
+    // With --stats, write the predicted critical path and the hash and cost
+    // of each mtask to {prefix}__partition.txt. If the previous build left
+    // a report there, first add stats comparing the two builds.
+    const string filename
+        = v3Global.opt.makeDir() + "/" + v3Global.opt.prefix() + "__partition.txt";
+    typedef std::multiset<std::pair<uint32_t, uint32_t> > MTaskSet;  // hash, cost
+    MTaskSet mtasks;
+    for (const V3GraphVertex* vxp = mtasksp->verticesBeginp(); vxp; vxp = vxp->verticesNextp()) {
+        const LogicMTask* mtaskp = dynamic_cast<const LogicMTask*>(vxp);
+        mtasks.insert(std::make_pair(mtaskp->hash(), mtaskp->cost()));
+    }
+    PartParallelismEst est(mtasksp);
+    est.traverse();
+
+    {
+        const vl_unique_ptr<std::ifstream> ifp(V3File::new_ifstream_nodepend(filename));
+        if (!ifp->fail()) {
+            MTaskSet prevMTasks;
+            unsigned prevCp = 0;
+            unsigned hash;
+            unsigned cost;
+            string line;
+            while (std::getline(*ifp, line)) {
+                if (sscanf(line.c_str(), "mtask hash %x cost %u", &hash, &cost) == 2) {
+                    prevMTasks.insert(std::make_pair(hash, cost));
+                } else {
+                    sscanf(line.c_str(), "critical path cost %u", &prevCp);
+                }
             }
+            unsigned unchanged = 0;
+            for (MTaskSet::const_iterator it = mtasks.begin(); it != mtasks.end(); ++it) {
+                MTaskSet::iterator prevIt = prevMTasks.find(*it);
+                if (prevIt == prevMTasks.end()) continue;
+                prevMTasks.erase(prevIt);
+                ++unchanged;
+            }
+            V3Stats::addStat("MTask graph, previous build, critical path cost", prevCp);
+            V3Stats::addStat("MTask graph, previous build, mtasks unchanged", unchanged);
+            V3Stats::addStat("MTask graph, previous build, mtasks changed",
+                             mtasks.size() - unchanged);
         }
     }
+
+    const vl_unique_ptr<std::ofstream> ofp(V3File::new_ofstream(filename));
+    if (ofp->fail()) v3fatal("Can't write " << filename);
+    *ofp << "critical path cost " << est.longestCritPathCost() << endl;
+    *ofp << "total graph cost " << est.totalGraphCost() << endl;
+    *ofp << "mtask count " << mtasks.size() << endl;
+    for (MTaskSet::const_iterator it = mtasks.begin(); it != mtasks.end(); ++it) {
+        *ofp << "mtask hash " << std::hex << std::setw(8) << std::setfill('0') << it->first
+             << std::dec << " cost " << it->second << endl;
+    }
 }
 
 void V3Partition::go(V3Graph* mtasksp) {
     // Called by V3Order
     hashGraphDebug(m_fineDepsGraphp, "v3partition initial fine-grained deps");
+    uint64_t phaseUsecs = V3Os::timeUsecs();
 
     // Create the first MTasks. Initially, each MTask just wraps one
     // MTaskMoveVertex. Over time, we'll merge MTasks together and
@@ -2417,11 +3069,15 @@ void V3Partition::go(V3Graph* mtasksp) {
             totalGraphCost += mtaskp->cost();
         }
 
+        // Number mtasks by their logic, before anything orders by ID
+        if (v3Global.opt.threadsStable()) partStableIds(mtasksp);
+
         // Create the mtask->mtask dep edges based on vertex deps
         setupMTaskDeps(mtasksp, &vx2mtask);
     }
 
     V3Partition::debugMTaskGraphStats(mtasksp, "initial");
+    partPhaseTime("initial", &phaseUsecs);
 
     // For debug: print out the longest critical path.  This allows us to
     // verify that the costs look reasonable, that we aren't combining
@@ -2436,6 +3092,29 @@ void V3Partition::go(V3Graph* mtasksp) {
         V3Partition::debugMTaskGraphStats(mtasksp, "hazards");
         hashGraphDebug(mtasksp, "mtasksp after fixDataHazards()");
     }
+    partPhaseTime("hazards", &phaseUsecs);
+
+    int targetParFactor = v3Global.opt.threads();
+    if (targetParFactor < 2) { v3fatalSrc("We should not reach V3Partition when --threads <= 1"); }
+
+    // Set cpLimit to roughly totalGraphCost / nThreads
+    //
+    // Actually set it a bit lower, by a hardcoded fudge factor. This
+    // results in more smaller mtasks, which helps reduce fragmentation
+    // when scheduling them.
+    unsigned fudgeNumerator = 3;
+    unsigned fudgeDenominator = 5;
+    uint32_t cpLimit = ((totalGraphCost * fudgeNumerator) / (targetParFactor * fudgeDenominator));
+    UINFO(4, "V3Partition set cpLimit = " << cpLimit << endl);
+
+    // Merge simple chains of mtasks first, as that is cheap and greatly
+    // reduces the graph the contraction below has to work on.
+    if (v3Global.opt.threadsCoarsen()) {
+        PartCoarsen(mtasksp, cpLimit).go();
+        V3Partition::debugMTaskGraphStats(mtasksp, "coarsen");
+        hashGraphDebug(mtasksp, "mtasksp after PartCoarsen");
+        partPhaseTime("coarsen", &phaseUsecs);
+    }
 
     // Setup the critical path into and out of each node.
     partInitCriticalPaths(mtasksp);
@@ -2453,19 +3132,7 @@ void V3Partition::go(V3Graph* mtasksp) {
     // about it, in case it actually helps.  TODO: get more data and maybe
     // remove this later if it doesn't really help.
     mtasksp->orderPreRanked();
-
-    int targetParFactor = v3Global.opt.threads();
-    if (targetParFactor < 2) { v3fatalSrc("We should not reach V3Partition when --threads <= 1"); }
-
-    // Set cpLimit to roughly totalGraphCost / nThreads
-    //
-    // Actually set it a bit lower, by a hardcoded fudge factor. This
-    // results in more smaller mtasks, which helps reduce fragmentation
-    // when scheduling them.
-    unsigned fudgeNumerator = 3;
-    unsigned fudgeDenominator = 5;
-    uint32_t cpLimit = ((totalGraphCost * fudgeNumerator) / (targetParFactor * fudgeDenominator));
-    UINFO(4, "V3Partition set cpLimit = " << cpLimit << endl);
+    partPhaseTime("critical paths", &phaseUsecs);
 
     // Merge MTask nodes together, repeatedly, until the CP budget is
     // reached.  Coarsens the graph, usually by several orders of
@@ -2480,10 +3147,18 @@ void V3Partition::go(V3Graph* mtasksp) {
                         v3Global.opt.debugPartition())
             .go();
         V3Partition::debugMTaskGraphStats(mtasksp, "contraction");
+        partPhaseTime("contraction", &phaseUsecs);
+    }
+    if (v3Global.opt.threadsMinMTaskCost()) {
+        PartMergeSmall(mtasksp, v3Global.opt.threadsMinMTaskCost()).go();
+        V3Partition::debugMTaskGraphStats(mtasksp, "merge small");
+        hashGraphDebug(mtasksp, "mtasksp after PartMergeSmall");
+        partPhaseTime("merge small", &phaseUsecs);
     }
     {
         mtasksp->removeTransitiveEdges();
         V3Partition::debugMTaskGraphStats(mtasksp, "transitive1");
+        partPhaseTime("transitive1", &phaseUsecs);
     }
 
     // Reassign MTask IDs onto smaller numbers, which should be more stable
@@ -2509,6 +3184,8 @@ void V3Partition::go(V3Graph* mtasksp) {
         }
     }
 
+    if (v3Global.opt.stats()) partReport(mtasksp);
+
     // Set color to indicate an mtaskId on every underlying MTaskMoveVertex.
     for (V3GraphVertex* itp = mtasksp->verticesBeginp(); itp; itp = itp->verticesNextp()) {
         LogicMTask* mtaskp = dynamic_cast<LogicMTask*>(itp);
@@ -2521,13 +3198,21 @@ void V3Partition::go(V3Graph* mtasksp) {
 }
 
 void V3Partition::finalizeCosts(V3Graph* execMTaskGraphp) {
+    for (V3GraphVertex* vxp = execMTaskGraphp->verticesBeginp(); vxp;
+         vxp = vxp->verticesNextp()) {
+        ExecMTask* mtp = dynamic_cast<ExecMTask*>(vxp);
+        mtp->cost(V3InstrCount::count(mtp->bodyp(), false));
+    }
+    // Substitute measured costs from a previous run, if we have them
+    if (!v3Global.opt.profThreadsFeedback().empty()) {
+        PartProfileFeedback(v3Global.opt.profThreadsFeedback()).apply(execMTaskGraphp);
+    }
+
     GraphStreamUnordered ser(execMTaskGraphp, GraphWay::REVERSE);
 
     while (const V3GraphVertex* vxp = ser.nextp()) {
         ExecMTask* mtp = dynamic_cast<ExecMTask*>(const_cast<V3GraphVertex*>(vxp));
-        uint32_t costCount = V3InstrCount::count(mtp->bodyp(), false);
-        mtp->cost(costCount);
-        mtp->priority(costCount);
+        mtp->priority(mtp->cost());
 
         // "Priority" is the critical path from the start of the mtask, to
         // the end of the graph reachable from this mtask.  Given the
@@ -2600,7 +3285,13 @@ void V3Partition::finalize() {
 
     // "Pack" the mtasks: statically associate each mtask with a thread,
     // and determine the order in which each thread will runs its mtasks.
-    PartPackMTasks(execGraphp->mutableDepGraphp()).go();
+    if (v3Global.opt.threadsAuto() && !v3Global.opt.threadsDynamic()) {
+        PartPackMTasks::packAuto(execGraphp->mutableDepGraphp());
+    } else {
+        PartPackMTasks(execGraphp->mutableDepGraphp()).go();
+    }
+
+    if (v3Global.opt.threadsPipeline()) PartTailMTasks tails(execGraphp);
 }
 
 void V3Partition::selfTest() {
@@ -24,6 +24,7 @@
 #include "V3OrderGraph.h"
 
 #include <list>
+#include <set>
 
 //*************************************************************************
 // MTasks and graph structures
@@ -65,6 +66,8 @@ private:
     // or 0xffffffff if not yet assigned.
     const ExecMTask* m_packNextp;  // Next for static (pack_mtasks) scheduling
     bool m_threadRoot;  // Is root thread
+    bool m_tail;  // May still run after eval() returns, see --threads-pipeline
+    std::set<string> m_modules;  // Modules with logic in this mtask, for profiling
     VL_UNCOPYABLE(ExecMTask);
 
 public:
@@ -76,7 +79,8 @@ public:
         , m_cost(0)
         , m_thread(0xffffffff)
         , m_packNextp(NULL)
-        , m_threadRoot(false) {}
+        , m_threadRoot(false)
+        , m_tail(false) {}
     AstMTaskBody* bodyp() const { return m_bodyp; }
     virtual uint32_t id() const { return m_id; }
     uint32_t priority() const { return m_priority; }
@@ -89,6 +93,10 @@ public:
     const ExecMTask* packNextp() const { return m_packNextp; }
     bool threadRoot() const { return m_threadRoot; }
     void threadRoot(bool threadRoot) { m_threadRoot = threadRoot; }
+    bool tail() const { return m_tail; }
+    void tail(bool flag) { m_tail = flag; }
+    const std::set<string>& modules() const { return m_modules; }
+    void addModule(const string& name) { m_modules.insert(name); }
     string cFuncName() const {
         // If this MTask maps to a C function, this should be the name
         return string("__Vmtask") + "__" + cvtToStr(m_id);
@@ -99,6 +107,7 @@ public:
         if (priority() || cost()) str << " [pr=" << priority() << " c=" << cvtToStr(cost()) << "]";
         if (thread() != 0xffffffff) str << " th=" << thread();
         if (threadRoot()) str << " [ROOT]";
+        if (tail()) str << " [TAIL]";
         if (packNextp()) str << " nx=" << packNextp()->name();
     }
 };
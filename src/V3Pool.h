@@ -0,0 +1,95 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Pool allocator for small objects
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#ifndef _V3POOL_H_
+#define _V3POOL_H_ 1
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include <new>
+
+//============================================================================
+// VPoolAlloc - Allocates small objects by size class
+//
+// Objects are bump allocated out of large chunks.  A deleted object goes on
+// the free list for its rounded size, and is reused by the next allocation
+// of that size.  Chunks are never returned, so an object may be freed to a
+// different pool (e.g. on another thread) than the one that allocated it.
+
+class VPoolAlloc {
+    // TYPES
+    enum { ALIGN = 16 };  // Alignment and size granularity
+    enum { MAX_SIZE = 512 };  // Larger objects use the global allocator
+    enum { CHUNK_SIZE = 256 * 1024 };  // Bytes requested for each chunk
+    struct FreeEnt {
+        FreeEnt* m_nextp;
+    };
+    // MEMBERS
+    FreeEnt* m_freeps[MAX_SIZE / ALIGN + 1];  // Free lists per size class
+    char* m_curp;  // Next unused byte in current chunk
+    char* m_endp;  // End of current chunk
+    VL_UNCOPYABLE(VPoolAlloc);
+
+public:
+    // CONSTRUCTORS
+    VPoolAlloc()
+        : m_curp(NULL)
+        , m_endp(NULL) {
+        for (size_t i = 0; i <= MAX_SIZE / ALIGN; ++i) m_freeps[i] = NULL;
+    }
+    ~VPoolAlloc() {}  // Chunks are leaked, objects from them may still be alive
+    // METHODS
+    void* alloc(size_t size) {
+        if (VL_UNLIKELY(size > MAX_SIZE)) return ::operator new(size);
+        size_t sizeClass = (size + ALIGN - 1) / ALIGN;
+        if (FreeEnt* entp = m_freeps[sizeClass]) {
+            m_freeps[sizeClass] = entp->m_nextp;
+            return entp;
+        }
+        size_t bytes = sizeClass * ALIGN;
+        if (VL_UNLIKELY(m_curp + bytes > m_endp)) {
+            m_curp = static_cast<char*>(::operator new(CHUNK_SIZE));  // LEAK_OK
+            m_endp = m_curp + CHUNK_SIZE;
+        }
+        void* objp = m_curp;
+        m_curp += bytes;
+        return objp;
+    }
+    void free(void* objp, size_t size) {
+        if (!objp) return;
+        if (VL_UNLIKELY(size > MAX_SIZE)) {
+            ::operator delete(objp);
+            return;
+        }
+        size_t sizeClass = (size + ALIGN - 1) / ALIGN;
+        FreeEnt* entp = static_cast<FreeEnt*>(objp);
+        entp->m_nextp = m_freeps[sizeClass];
+        m_freeps[sizeClass] = entp;
+    }
+};
+
+// Allocation pool for the calling thread
+inline VPoolAlloc& vPoolAllocThread() {
+#if __cplusplus >= 201103L
+    static thread_local VPoolAlloc s_pool;
+#else
+    static VPoolAlloc s_pool;  // No threads without C++11
+#endif
+    return s_pool;
+}
+
+#endif  // Guard
@@ -31,6 +31,7 @@
 
 class V3PreLex;
 class V3PreProcImp;
+class VInFileMap;
 
 // Token codes
 // If changing, see V3PreProc.cpp's V3PreProcImp::tokenName()
@@ -131,6 +132,8 @@ public:
     FileLine* m_curFilelinep;  // Current processing point (see also m_tokFilelinep)
     V3PreLex* m_lexp;  // Lexer, for resource tracking
     std::deque<string> m_buffers;  // Buffer of characters to process
+    VInFileMap* m_mapp;  // Mapped file to process after m_buffers, or NULL
+    size_t m_mapPos;  // Next character in m_mapp to process
     int m_ignNewlines;  // Ignore multiline newlines
     bool m_eof;  // "EOF" buffer
     bool m_file;  // Buffer is start of new file
@@ -138,13 +141,19 @@ public:
     VPreStream(FileLine* fl, V3PreLex* lexp)
         : m_curFilelinep(fl)
         , m_lexp(lexp)
+        , m_mapp(NULL)
+        , m_mapPos(0)
         , m_ignNewlines(0)
         , m_eof(false)
         , m_file(false)
         , m_termState(0) {
         lexStreamDepthAdd(1);
     }
-    ~VPreStream() { lexStreamDepthAdd(-1); }
+    ~VPreStream() {
+        releaseMap();
+        lexStreamDepthAdd(-1);
+    }
+    void releaseMap();
 
 private:
     void lexStreamDepthAdd(int delta);
@@ -220,6 +229,7 @@ public:  // Used only by V3PreLex.cpp and V3PreProc.cpp
     void scanNewFile(FileLine* filelinep);
     void scanBytes(const string& str);
     void scanBytesBack(const string& str);
+    void scanMapBack(VInFileMap* mapp);
     size_t inputToLex(char* buf, size_t max_size);
     /// Called by V3PreProc.cpp to get data from lexer
     YY_BUFFER_STATE currentBuffer();
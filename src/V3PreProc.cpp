@@ -44,22 +44,44 @@
 //*************************************************************************
 
 class VDefine {
+public:
+    // TYPES
+    struct Formal {  // One for each formal parameter
+        string m_name;  // Parameter name, "" if an empty position
+        string m_default;  // Default value
+        bool m_haveDefault;  // Has a default value
+    };
+    struct Segment {  // Piece of the value: text, then a formal's value if m_formal >= 0
+        string m_text;
+        int m_formal;
+    };
+
+private:
     // Define class.  One for each define.
     // string    m_name;         // Name of the define (list is keyed by this)
     FileLine* m_fileline;  // Where it was declared
     string m_value;  // Value of define
     string m_params;  // Parameters
     bool m_cmdline;  // Set on command line, don't `undefineall
+    // Parsed m_params and m_value, made on first substitution
+    bool m_parsed;  // m_formals and m_segments are made
+    std::vector<Formal> m_formals;  // Parsed m_params
+    std::vector<Segment> m_segments;  // Parsed m_value
 public:
     VDefine(FileLine* fl, const string& value, const string& params, bool cmdline)
         : m_fileline(fl)
         , m_value(value)
         , m_params(params)
-        , m_cmdline(cmdline) {}
+        , m_cmdline(cmdline)
+        , m_parsed(false) {}
     FileLine* fileline() const { return m_fileline; }
     string value() const { return m_value; }
     string params() const { return m_params; }
     bool cmdline() const { return m_cmdline; }
+    bool parsed() const { return m_parsed; }
+    void parsed(bool flag) { m_parsed = flag; }
+    std::vector<Formal>& formals() { return m_formals; }
+    std::vector<Segment>& segments() { return m_segments; }
 };
 
 //*************************************************************************
@@ -195,6 +217,7 @@ private:
     // Internal methods
     void endOfOneFile();
     string defineSubst(VDefineRef* refp);
+    void defineParse(VDefine& def);
 
     bool defExists(const string& name);
     string defValue(const string& name);
@@ -248,6 +271,8 @@ public:
     void addLineComment(int enterExit);
     void dumpDefines(std::ostream& os);
     void candidateDefines(VSpellCheck* spellerp);
+    string definesString() const;
+    void definesFromString(FileLine* fl, const string& text);
 
     // METHODS, callbacks
     virtual void comment(const string& text);  // Comment detected (if keepComments==2)
@@ -587,38 +612,23 @@ string V3PreProcImp::trimWhitespace(const string& strg, bool trailing) {
     return out;
 }
 
-string V3PreProcImp::defineSubst(VDefineRef* refp) {
-    // Substitute out defines in a define reference.
-    // (We also need to call here on non-param defines to handle `")
-    // We could push the define text back into the lexer, but that's slow
-    // and would make recursive definitions and parameter handling nasty.
-    //
-    // Note we parse the definition parameters and value here.  If a
-    // parameterized define is used many, many times, we could cache the
-    // parsed result.
-    UINFO(4, "defineSubstIn  `" << refp->name() << " " << refp->params() << endl);
-    for (unsigned i = 0; i < refp->args().size(); i++) {
-        UINFO(4, "defineArg[" << i << "] = '" << refp->args()[i] << "'" << endl);
-    }
-    // Grab value
-    string value = defValue(refp->name());
-    UINFO(4, "defineValue    '" << V3PreLex::cleanDbgStrg(value) << "'" << endl);
-
-    std::map<string, string> argValueByName;
-    {  // Parse argument list into map
-        unsigned numArgs = 0;
+void V3PreProcImp::defineParse(VDefine& def) {
+    // Parse the definition parameters and value, once for all uses of the
+    // define, leaving defineSubst only arguments to substitute.
+    def.parsed(true);
+    std::map<string, int> formalByName;
+    {  // Parse argument list into formals
         string argName;
         int paren = 1;  // (), {} and [] can use same counter, as must be matched pair per spec
         string token;
         bool quote = false;
         bool haveDefault = false;
         // Note there's a leading ( and trailing ), so parens==1 is the base parsing level
-        string params = refp->params();  // Must keep str in scope to get pointer
+        string params = def.params();  // Must keep str in scope to get pointer
         const char* cp = params.c_str();
         if (*cp == '(') cp++;
         for (; *cp; cp++) {
-            // UINFO(4,"   Parse  Paren="<<paren<<"  Arg="<<numArgs<<"  token='"<<token<<"'
-            // Parse="<<cp<<endl);
+            // UINFO(4,"   Parse  Paren="<<paren<<"  token='"<<token<<"' Parse="<<cp<<endl);
             if (!quote && paren == 1) {
                 if (*cp == ')' || *cp == ',') {
                     string valueDef;
@@ -628,24 +638,15 @@ string V3PreProcImp::defineSubst(VDefineRef* refp) {
                         argName = token;
                     }
                     argName = trimWhitespace(argName, true);
-                    UINFO(4, "    Got Arg=" << numArgs << "  argName='" << argName
+                    UINFO(4, "    Got Arg=" << def.formals().size() << "  argName='" << argName
                                             << "'  default='" << valueDef << "'" << endl);
-                    // Parse it
-                    if (argName != "") {
-                        if (refp->args().size() > numArgs) {
-                            // A call `def( a ) must be equivalent to `def(a ), so trimWhitespace
-                            // At one point we didn't trim trailing
-                            // whitespace, but this confuses `"
-                            string arg = trimWhitespace(refp->args()[numArgs], true);
-                            if (arg != "") valueDef = arg;
-                        } else if (!haveDefault) {
-                            error("Define missing argument '" + argName + "' for: " + refp->name()
-                                  + "\n");
-                            return " `" + refp->name() + " ";
-                        }
-                        numArgs++;
-                    }
-                    argValueByName[argName] = valueDef;
+                    VDefine::Formal formal;
+                    formal.m_name = argName;
+                    formal.m_default = valueDef;
+                    formal.m_haveDefault = haveDefault;
+                    // A repeated name substitutes the last
+                    formalByName[argName] = def.formals().size();
+                    def.formals().push_back(formal);
                     // Prepare for next
                     argName = "";
                     token = "";
@@ -674,21 +675,15 @@ string V3PreProcImp::defineSubst(VDefineRef* refp) {
             if (*cp == '"') quote = !quote;
             if (*cp) token += *cp;
         }
-        if (refp->args().size() > numArgs
-            // `define X() is ok to call with nothing
-            && !(refp->args().size() == 1 && numArgs == 0
-                 && trimWhitespace(refp->args()[0], false) == "")) {
-            error("Define passed too many arguments: " + refp->name() + "\n");
-            return " `" + refp->name() + " ";
-        }
     }
 
-    string out;
-    {  // Parse substitution define using arguments
+    string out;  // Text of the segment being built
+    {  // Parse substitution define into text and formal references
         string argName;
         bool quote = false;
         bool backslashesc = false;  // In \.....{space} block
         // Note we go through the loop once more at the NULL end-of-string
+        string value = def.value();  // Must keep str in scope to get pointer
         for (const char* cp = value.c_str(); (*cp) || argName != ""; cp = (*cp ? cp + 1 : cp)) {
             // UINFO(4, "CH "<<*cp<<"  an "<<argName<<endl);
             if (!quote && *cp == '\\') {
@@ -698,26 +693,20 @@ string V3PreProcImp::defineSubst(VDefineRef* refp) {
             }
             // We don't check for quotes; some simulators expand even inside quotes
             if (isalpha(*cp) || *cp == '_'
-                || *cp == '$'  // Won't replace system functions, since no $ in argValueByName
+                || *cp == '$'  // Won't replace system functions, since no $ in formalByName
                 || (argName != "" && (isdigit(*cp) || *cp == '$'))) {
                 argName += *cp;
                 continue;
             }
             if (argName != "") {
                 // Found a possible variable substitution
-                std::map<string, string>::iterator iter = argValueByName.find(argName);
-                if (iter != argValueByName.end()) {
-                    // Substitute
-                    string subst = iter->second;
-                    if (subst == "") {
-                        // Normally `` is removed later, but with no token after, we're otherwise
-                        // stuck, so remove proceeding ``
-                        if (out.size() >= 2 && out.substr(out.size() - 2) == "``") {
-                            out = out.substr(0, out.size() - 2);
-                        }
-                    } else {
-                        out += subst;
-                    }
+                std::map<string, int>::iterator iter = formalByName.find(argName);
+                if (iter != formalByName.end()) {
+                    VDefine::Segment segment;
+                    segment.m_text = out;
+                    segment.m_formal = iter->second;
+                    def.segments().push_back(segment);
+                    out = "";
                 } else {
                     out += argName;
                 }
@@ -732,7 +721,7 @@ string V3PreProcImp::defineSubst(VDefineRef* refp) {
                     } else {
                         out += "``";  // `` must get removed later, as `FOO```BAR must pre-expand
                                       // FOO and BAR
-                        // See also removal in empty substitutes above
+                        // See also removal in empty substitutes in defineSubst
                     }
                     cp++;
                     continue;
@@ -775,6 +764,85 @@ string V3PreProcImp::defineSubst(VDefineRef* refp) {
             if (*cp) out += *cp;
         }
     }
+    VDefine::Segment segment;
+    segment.m_text = out;
+    segment.m_formal = -1;
+    def.segments().push_back(segment);
+}
+
+string V3PreProcImp::defineSubst(VDefineRef* refp) {
+    // Substitute out defines in a define reference.
+    // (We also need to call here on non-param defines to handle `")
+    // We could push the define text back into the lexer, but that's slow
+    // and would make recursive definitions and parameter handling nasty.
+    //
+    // The definition parameters and value are parsed on first use, as
+    // parameterized defines are often used many, many times.
+    UINFO(4, "defineSubstIn  `" << refp->name() << " " << refp->params() << endl);
+    for (unsigned i = 0; i < refp->args().size(); i++) {
+        UINFO(4, "defineArg[" << i << "] = '" << refp->args()[i] << "'" << endl);
+    }
+    // Grab value
+    DefinesMap::iterator defIt = m_defines.find(refp->name());
+    if (defIt == m_defines.end()) {
+        fileline()->v3error("Define or directive not defined: `" + refp->name());
+        return "";
+    }
+    VDefine& def = defIt->second;
+    UINFO(4, "defineValue    '" << V3PreLex::cleanDbgStrg(def.value()) << "'" << endl);
+    if (!def.parsed()) defineParse(def);
+
+    std::vector<string> argValues;
+    {  // Match arguments to formals
+        unsigned numArgs = 0;
+        const std::vector<VDefine::Formal>& formals = def.formals();
+        for (std::vector<VDefine::Formal>::const_iterator it = formals.begin();
+             it != formals.end(); ++it) {
+            string valueDef = it->m_default;
+            if (it->m_name != "") {
+                if (refp->args().size() > numArgs) {
+                    // A call `def( a ) must be equivalent to `def(a ), so trimWhitespace
+                    // At one point we didn't trim trailing
+                    // whitespace, but this confuses `"
+                    string arg = trimWhitespace(refp->args()[numArgs], true);
+                    if (arg != "") valueDef = arg;
+                } else if (!it->m_haveDefault) {
+                    error("Define missing argument '" + it->m_name + "' for: " + refp->name()
+                          + "\n");
+                    return " `" + refp->name() + " ";
+                }
+                numArgs++;
+            }
+            argValues.push_back(valueDef);
+        }
+        if (refp->args().size() > numArgs
+            // `define X() is ok to call with nothing
+            && !(refp->args().size() == 1 && numArgs == 0
+                 && trimWhitespace(refp->args()[0], false) == "")) {
+            error("Define passed too many arguments: " + refp->name() + "\n");
+            return " `" + refp->name() + " ";
+        }
+    }
+
+    string out;
+    {  // Substitute arguments into the parsed value
+        const std::vector<VDefine::Segment>& segments = def.segments();
+        for (std::vector<VDefine::Segment>::const_iterator it = segments.begin();
+             it != segments.end(); ++it) {
+            out += it->m_text;
+            if (it->m_formal < 0) continue;
+            const string& subst = argValues[it->m_formal];
+            if (subst == "") {
+                // Normally `` is removed later, but with no token after, we're otherwise
+                // stuck, so remove proceeding ``
+                if (out.size() >= 2 && out.substr(out.size() - 2) == "``") {
+                    out = out.substr(0, out.size() - 2);
+                }
+            } else {
+                out += subst;
+            }
+        }
+    }
 
     UINFO(4, "defineSubstOut '" << V3PreLex::cleanDbgStrg(out) << "'" << endl);
     return out;
@@ -788,10 +856,11 @@ void V3PreProcImp::openFile(FileLine* fl, VInFilter* filterp, const string& file
     if (m_incError) return;
     V3File::addSrcDepend(filename);
 
-    // Read a list<string> with the whole file.
+    // Map large files, so they're lexed in place rather than copied,
+    // otherwise read a list<string> with the whole file.
+    VInFileMap* mapp = filterp->mapWholefile(filename);
     StrList wholefile;
-    bool ok = filterp->readWholefile(filename, wholefile /*ref*/);
-    if (!ok) {
+    if (!mapp && !filterp->readWholefile(filename, wholefile /*ref*/)) {
         error("File not found: " + filename + "\n");
         return;
     }
@@ -804,6 +873,7 @@ void V3PreProcImp::openFile(FileLine* fl, VInFilter* filterp, const string& file
             // Include might be a tree of includes that is O(n^2) or worse.
             // Once hit this error then, ignore all further includes so can unwind.
             m_incError = true;
+            if (mapp) VL_DO_DANGLING(mapp->decRef(), mapp);
             return;
         }
         // There's already a file active.  Push it to work on the new one.
@@ -814,6 +884,7 @@ void V3PreProcImp::openFile(FileLine* fl, VInFilter* filterp, const string& file
     FileLine* flsp = new FileLine(filename);
     flsp->lineno(1);
     flsp->newContent();
+    if (mapp) flsp->contentp()->pushMapped(mapp);
     for (StrList::iterator it = wholefile.begin(); it != wholefile.end(); ++it) {
         flsp->contentp()->pushText(*it);
     }
@@ -822,6 +893,13 @@ void V3PreProcImp::openFile(FileLine* fl, VInFilter* filterp, const string& file
     m_lexp->scanNewFile(flsp);
     addLineComment(1);  // Enter
 
+    if (mapp) {
+        // The lexer filters CR's as it reads the map
+        m_lexp->scanMapBack(mapp);
+        VL_DO_DANGLING(mapp->decRef(), mapp);
+        return;
+    }
+
     // Filter all DOS CR's en-mass.  This avoids bugs with lexing CRs in the wrong places.
     // This will also strip them from strings, but strings aren't supposed
     // to be multi-line without a "\"
@@ -880,6 +958,40 @@ void V3PreProcImp::dumpDefines(std::ostream& os) {
     }
 }
 
+static string definesField(const string& field) {
+    return cvtToStr(field.length()) + ":" + field;
+}
+
+string V3PreProcImp::definesString() const {
+    // Fields are length prefixed, as a define value may contain any character
+    string out;
+    for (DefinesMap::const_iterator it = m_defines.begin(); it != m_defines.end(); ++it) {
+        out += definesField(it->first);
+        out += definesField(it->second.params());
+        out += definesField(it->second.value());
+        out += it->second.cmdline() ? "c" : "-";
+    }
+    return out;
+}
+
+void V3PreProcImp::definesFromString(FileLine* fl, const string& text) {
+    m_defines.clear();
+    size_t pos = 0;
+    while (pos < text.length()) {
+        string fields[3];
+        for (int i = 0; i < 3; ++i) {
+            size_t colon = text.find(':', pos);
+            if (colon == string::npos) fl->v3fatalSrc("Corrupt --pp-cache defines");
+            size_t len = atoi(text.substr(pos, colon - pos).c_str());
+            fields[i] = text.substr(colon + 1, len);
+            pos = colon + 1 + len;
+        }
+        bool cmdline = pos < text.length() && text[pos] == 'c';
+        ++pos;
+        m_defines.insert(make_pair(fields[0], VDefine(fl, fields[2], fields[1], cmdline)));
+    }
+}
+
 void V3PreProcImp::candidateDefines(VSpellCheck* spellerp) {
     for (DefinesMap::const_iterator it = m_defines.begin(); it != m_defines.end(); ++it) {
         spellerp->pushCandidate(string("`") + it->first);
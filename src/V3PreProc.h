@@ -95,6 +95,8 @@ public:
     void fatal(const string& msg) { fileline()->v3fatalSrc(msg); }  ///< Report a fatal error
     virtual void dumpDefines(std::ostream& os) = 0;  ///< Print list of `defines
     virtual void candidateDefines(VSpellCheck* spellerp) = 0;  ///< Spell check candidate defines
+    virtual string definesString() const = 0;  ///< All `defines, encoded for --pp-cache
+    virtual void definesFromString(FileLine* fl, const string& text) = 0;  ///< Undo definesString
 
 protected:
     // CONSTRUCTORS
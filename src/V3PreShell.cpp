@@ -23,12 +23,17 @@
 #include "V3File.h"
 #include "V3Parse.h"
 #include "V3Os.h"
+#include "V3Stats.h"
+#include "V3String.h"
 
 #include <algorithm>
 #include <cstdarg>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <list>
 #include <set>
+#include <vector>
 
 //######################################################################
 
@@ -39,6 +44,7 @@ protected:
     static V3PreShellImp s_preImp;
     static V3PreProc* s_preprocp;
     static VInFilter* s_filterp;
+    static std::vector<string>* s_includesp;  // --pp-cache files included, or NULL
 
     //---------------------------------------
     // METHODS
@@ -92,7 +98,7 @@ protected:
     }
 
     bool preproc(FileLine* fl, const string& modname, VInFilter* filterp, V3ParseImp* parsep,
-                 const string& errmsg) {  // "" for no error
+                 const string& errmsg, bool stream) {  // "" for no error
         debug(true);  // Recheck if debug on - first check was before command line passed
 
         // Preprocess the given module, putting output in vppFilename
@@ -100,9 +106,41 @@ protected:
 
         // Preprocess
         s_filterp = filterp;
+        if (!v3Global.opt.ppCache().empty()) return preprocCached(fl, modname, parsep, errmsg);
         string modfilename = preprocOpen(fl, s_filterp, modname, "", errmsg);
         if (modfilename.empty()) return false;
+        pushLanguage(parsep, modfilename);
+        if (stream) return true;  // Parser calls preprocLine as it needs text
 
+        while (!s_preprocp->isEof()) {
+            string line = s_preprocp->getline();
+            V3Parse::ppPushText(parsep, line);
+        }
+        return true;
+    }
+    bool preprocLine(V3ParseImp* parsep) {
+        while (!s_preprocp->isEof()) {
+            string line = s_preprocp->getline();
+            if (!line.empty()) {
+                V3Parse::ppPushText(parsep, line);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void preprocInclude(FileLine* fl, const string& modname) {
+        if (modname[0] == '/' || modname[0] == '\\') {
+            fl->v3warn(INCABSPATH,
+                       "Suggest `include with absolute path be made relative, and use +include: "
+                           << modname);
+        }
+        preprocOpen(fl, s_filterp, modname, V3Os::filenameDir(fl->filename()),
+                    "Cannot find include file: ");
+    }
+
+private:
+    void pushLanguage(V3ParseImp* parsep, const string& modfilename) {
         // Set language standard up front
         if (!v3Global.opt.preprocOnly()) {
             // Letting lex parse this saves us from having to specially en/decode
@@ -114,25 +152,134 @@ protected:
             V3Parse::ppPushText(
                 parsep, (string("`begin_keywords \"") + modfileline->language().ascii() + "\"\n"));
         }
+    }
 
+    // --pp-cache
+    // Each cache entry is the output of preprocessing one command line file.
+    // It is keyed on the Verilator version, the command line, the file's
+    // contents and the `defines in effect before the file; it is valid while
+    // each file it included is unchanged.  The entry also holds the `defines
+    // in effect after the file, so later files see the same state.
+    string contentsHash(const string& filename) {
+        VInFilter::StrList contents;
+        if (!s_filterp->readWholefile(filename, contents)) return "";
+        string text;
+        for (VInFilter::StrList::const_iterator it = contents.begin(); it != contents.end();
+             ++it) {
+            text += *it;
+        }
+        return VHashSha256(text).digestHex();
+    }
+    string cacheFilename(const string& modfilename) {
+        string key = "vppcache 1\n";
+        key += V3Options::version() + "\n";
+        key += v3Global.opt.allArgsString() + "\n";
+        key += modfilename + "\n";
+        key += v3Global.opt.fileLanguage(modfilename).ascii() + string("\n");
+        key += contentsHash(modfilename) + "\n";
+        key += s_preprocp->definesString();
+        return v3Global.opt.ppCache() + "/" + VHashSha256(key).digestHex() + ".vpp";
+    }
+    static bool cacheReadSection(std::istream& is, const string& name, string& textr) {
+        // Section is "<name> <length>\n<length bytes>\n"
+        string line = V3Os::getline(is);
+        if (line.compare(0, name.length() + 1, name + " ") != 0) return false;
+        size_t len = atoi(line.substr(name.length() + 1).c_str());
+        textr.resize(len);
+        if (len && !is.read(&textr[0], len)) return false;
+        return is.get() == '\n';
+    }
+    bool cacheRead(const string& filename, const string& modfilename, string& textr) {
+        std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+        if (!is) return false;
+        std::vector<string> includes;
+        while (is.peek() == 'i') {
+            // "include <hash> <filename>"
+            string line = V3Os::getline(is);
+            size_t sp = line.find(' ', 8);
+            if (line.compare(0, 8, "include ") != 0 || sp == string::npos) return false;
+            string incFilename = line.substr(sp + 1);
+            if (contentsHash(incFilename) != line.substr(8, sp - 8)) {
+                UINFO(4, "    --pp-cache stale due to " << incFilename << endl);
+                return false;
+            }
+            includes.push_back(incFilename);
+        }
+        string defines;
+        if (!cacheReadSection(is, "defines", defines)) return false;
+        if (!cacheReadSection(is, "text", textr)) return false;
+        // Hit
+        V3File::addSrcDepend(modfilename);
+        for (std::vector<string>::const_iterator it = includes.begin(); it != includes.end();
+             ++it) {
+            V3File::addSrcDepend(*it);
+        }
+        s_preprocp->definesFromString(new FileLine(modfilename), defines);
+        return true;
+    }
+    void cacheWrite(const string& filename, const std::vector<string>& includes,
+                    const string& text) {
+        V3Os::createDir(v3Global.opt.ppCache());
+        // Write then rename, so parallel runs never see a partial entry
+        string tmpFilename
+            = filename + "." + VHashSha256(V3Os::trueRandom(16)).digestHex() + ".tmp";
+        {
+            std::ofstream os(tmpFilename.c_str(), std::ios::out | std::ios::binary);
+            if (!os) return;  // Cache is only an optimization
+            std::set<string> written;
+            for (std::vector<string>::const_iterator it = includes.begin(); it != includes.end();
+                 ++it) {
+                if (!written.insert(*it).second) continue;
+                os << "include " << contentsHash(*it) << " " << *it << "\n";
+            }
+            string defines = s_preprocp->definesString();
+            os << "defines " << defines.length() << "\n" << defines << "\n";
+            os << "text " << text.length() << "\n" << text << "\n";
+            if (!os) {
+                os.close();
+                remove(tmpFilename.c_str());
+                return;
+            }
+        }
+        if (rename(tmpFilename.c_str(), filename.c_str()) != 0) remove(tmpFilename.c_str());
+    }
+    bool preprocCached(FileLine* fl, const string& modname, V3ParseImp* parsep,
+                       const string& errmsg) {
+        string modfilename = v3Global.opt.filePath(fl, modname, "", "");
+        string cacheFile;
+        if (!modfilename.empty()) {
+            cacheFile = cacheFilename(modfilename);
+            string text;
+            if (cacheRead(cacheFile, modfilename, text)) {
+                UINFO(2, "    Reading " << modfilename << " from " << cacheFile << endl);
+                V3Stats::addStatSum("Preprocessor cache, hits", 1);
+                pushLanguage(parsep, modfilename);
+                V3Parse::ppPushText(parsep, text);
+                return true;
+            }
+        }
+        // Miss; preprocess normally, keeping the output and the included files
+        V3Stats::addStatSum("Preprocessor cache, misses", 1);
+        int problems = V3Error::errorCount() + V3Error::warnCount();
+        std::vector<string> includes;
+        modfilename = preprocOpen(fl, s_filterp, modname, "", errmsg);
+        if (modfilename.empty()) return false;
+        s_includesp = &includes;
+        pushLanguage(parsep, modfilename);
+        string text;
         while (!s_preprocp->isEof()) {
             string line = s_preprocp->getline();
+            text += line;
             V3Parse::ppPushText(parsep, line);
         }
-        return true;
-    }
-
-    void preprocInclude(FileLine* fl, const string& modname) {
-        if (modname[0] == '/' || modname[0] == '\\') {
-            fl->v3warn(INCABSPATH,
-                       "Suggest `include with absolute path be made relative, and use +include: "
-                           << modname);
+        s_includesp = NULL;
+        // Messages would not be repeated on a hit, so only cache clean files
+        if (!cacheFile.empty() && problems == V3Error::errorCount() + V3Error::warnCount()) {
+            cacheWrite(cacheFile, includes, text);
         }
-        preprocOpen(fl, s_filterp, modname, V3Os::filenameDir(fl->filename()),
-                    "Cannot find include file: ");
+        return true;
     }
 
-private:
     string preprocOpen(FileLine* fl, VInFilter* filterp, const string& modname,
                        const string& lastpath,
                        const string& errmsg) {  // Error message or "" to suppress
@@ -149,6 +296,7 @@ private:
         if (filename == "") return "";  // Not found
 
         UINFO(2, "    Reading " << filename << endl);
+        if (s_includesp) s_includesp->push_back(filename);
         s_preprocp->openFile(fl, filterp, filename);
         return filename;
     }
@@ -162,14 +310,18 @@ public:
 V3PreShellImp V3PreShellImp::s_preImp;
 V3PreProc* V3PreShellImp::s_preprocp = NULL;
 VInFilter* V3PreShellImp::s_filterp = NULL;
+std::vector<string>* V3PreShellImp::s_includesp = NULL;
 
 //######################################################################
 // Perl class functions
 
 void V3PreShell::boot(char** env) { V3PreShellImp::s_preImp.boot(env); }
 bool V3PreShell::preproc(FileLine* fl, const string& modname, VInFilter* filterp,
-                         V3ParseImp* parsep, const string& errmsg) {
-    return V3PreShellImp::s_preImp.preproc(fl, modname, filterp, parsep, errmsg);
+                         V3ParseImp* parsep, const string& errmsg, bool stream) {
+    return V3PreShellImp::s_preImp.preproc(fl, modname, filterp, parsep, errmsg, stream);
+}
+bool V3PreShell::preprocLine(V3ParseImp* parsep) {
+    return V3PreShellImp::s_preImp.preprocLine(parsep);
 }
 void V3PreShell::preprocInclude(FileLine* fl, const string& modname) {
     V3PreShellImp::s_preImp.preprocInclude(fl, modname);
@@ -33,8 +33,12 @@ class V3PreShell {
     // Static class for calling preprocessor
 public:
     static void boot(char** env);
+    // With stream, leave the output for the parser to pull with preprocLine,
+    // rather than pushing the whole file's output to the parser first
     static bool preproc(FileLine* fl, const string& modname, VInFilter* filterp,
-                        V3ParseImp* parsep, const string& errmsg);
+                        V3ParseImp* parsep, const string& errmsg, bool stream = false);
+    // Push the next preprocessed text to the parser, return false at end of file
+    static bool preprocLine(V3ParseImp* parsep);
     static void preprocInclude(FileLine* fl, const string& modname);
     static void defineCmdLine(const string& name, const string& value);
     static void undef(const string& name);
@@ -22,6 +22,15 @@
 // Each display (independent transformation; here as Premit is a good point)
 //      If autoflush, insert a flush
 //
+// Temporary reuse (after V3Expand and V3Subst):
+//      Each CFunc:
+//          Number the references to wide statement temporaries in order,
+//          giving each a live range from its first to last reference,
+//          widened to cover any loop it is referenced in.
+//          Temporaries interfere when their ranges overlap; color the
+//          ranges by linear scan, giving temporaries of the same size
+//          that don't interfere the same variable.
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -30,10 +39,12 @@
 #include "V3Global.h"
 #include "V3Premit.h"
 #include "V3Ast.h"
+#include "V3Stats.h"
 
 #include <algorithm>
 #include <cstdarg>
 #include <list>
+#include <vector>
 
 //######################################################################
 // Structure for global state
@@ -110,6 +121,14 @@ private:
         return (VN_IS(nodep->lhsp(), VarRef) && !AstVar::scVarRecurse(nodep->lhsp())
                 && VN_IS(nodep->rhsp(), Const));
     }
+    bool divConstWord(AstNode* nodep) {
+        // Divisor of a wide divide that fits in a word, emitted inline; see VL_DIV_WWI
+        const AstConst* constp = VN_CAST(nodep, Const);
+        const AstNodeBiop* biopp = VN_CAST(nodep->backp(), NodeBiop);
+        return (constp && biopp && biopp->rhsp() == nodep
+                && (VN_IS(biopp, Div) || VN_IS(biopp, ModDiv)) && !constp->num().isFourState()
+                && !constp->num().isEqZero() && constp->num().widthMin() <= VL_IDATASIZE);
+    }
     void checkNode(AstNode* nodep) {
         // Consider adding a temp for this expression.
         // We need to avoid adding temps to the following:
@@ -132,6 +151,8 @@ private:
                     // AstSel::width must remain a constant
                 } else if (nodep->firstAbovep() && VN_IS(nodep->firstAbovep(), ArraySel)) {
                     // ArraySel's are pointer refs, ignore
+                } else if (divConstWord(nodep)) {
+                    // Emitted as a literal
                 } else {
                     UINFO(4, "Cre Temp: " << nodep << endl);
                     createDeepTemp(nodep, false);
@@ -413,6 +434,157 @@ public:
     virtual ~PremitVisitor() {}
 };
 
+//######################################################################
+// Share the storage of temporaries with disjoint lifetimes
+
+class PremitReuseVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    //  AstVar::user1()         // int; 1 + index in m_temps, if a temp to consider
+    //  AstVar::user2p()        // AstVar*; Temp to use instead
+    AstUser1InUse m_inuser1;
+    AstUser2InUse m_inuser2;
+
+    // TYPES
+    struct Temp {
+        AstVar* m_varp;
+        int m_start;  // First reference
+        int m_end;  // Last reference
+        bool operator<(const Temp& rhs) const { return m_start < rhs.m_start; }
+    };
+
+    // STATE
+    std::vector<Temp> m_temps;  // Temps of current function
+    std::vector<size_t> m_loopTemps;  // Temps referenced in the current outer loop
+    bool m_replacing;  // Replacing references, after numbering
+    int m_seq;  // Statement number, of references
+    int m_loopDepth;  // Depth of loops
+    VDouble0 m_statReused;  // Statistic tracking
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    static bool reusable(AstVar* varp) {
+        return varp->isStatementTemp() && varp->isWide()
+               && VN_IS(varp->dtypeSkipRefp(), BasicDType) && !varp->isString();
+    }
+    void reuseTemps(AstCFunc* nodep) {
+        std::sort(m_temps.begin(), m_temps.end());
+        // Temps given to others, and the end of their latest range
+        std::vector<Temp> colors;
+        for (std::vector<Temp>::iterator it = m_temps.begin(); it != m_temps.end(); ++it) {
+            if (it->m_start < 0) continue;  // Unreferenced
+            std::vector<Temp>::iterator cit = colors.begin();
+            for (; cit != colors.end(); ++cit) {
+                if (cit->m_end < it->m_start
+                    && cit->m_varp->widthWords() == it->m_varp->widthWords()) {
+                    break;
+                }
+            }
+            if (cit == colors.end()) {
+                colors.push_back(*it);
+            } else {
+                UINFO(8, "    Reuse " << cit->m_varp << " for " << it->m_varp << endl);
+                it->m_varp->user2p(cit->m_varp);
+                cit->m_end = it->m_end;
+                ++m_statReused;
+            }
+        }
+        if (colors.size() == m_temps.size()) return;
+        m_replacing = true;
+        iterateChildren(nodep);
+        m_replacing = false;
+        for (std::vector<Temp>::iterator it = m_temps.begin(); it != m_temps.end(); ++it) {
+            if (it->m_varp->user2p()) {
+                VL_DO_DANGLING(it->m_varp->unlinkFrBack()->deleteTree(), it->m_varp);
+            }
+        }
+    }
+
+    // VISITORS
+    virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
+        m_temps.clear();
+        for (AstNode* stmtp = nodep->initsp(); stmtp; stmtp = stmtp->nextp()) {
+            AstVar* varp = VN_CAST(stmtp, Var);
+            if (varp && reusable(varp)) {
+                Temp temp;
+                temp.m_varp = varp;
+                temp.m_start = -1;
+                temp.m_end = -1;
+                m_temps.push_back(temp);
+                varp->user1(m_temps.size());
+            }
+        }
+        if (m_temps.size() < 2) return;
+        m_seq = 0;
+        m_loopDepth = 0;
+        iterateChildren(nodep);
+        reuseTemps(nodep);
+    }
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        AstVar* varp = nodep->varp();
+        if (m_replacing) {
+            if (AstVar* newp = VN_CAST(varp->user2p(), Var)) nodep->varp(newp);
+            return;
+        }
+        if (!varp->user1()) return;
+        const size_t index = varp->user1() - 1;
+        Temp& temp = m_temps[index];
+        if (temp.m_start < 0) temp.m_start = m_seq;
+        temp.m_end = m_seq;
+        if (m_loopDepth) m_loopTemps.push_back(index);
+    }
+    virtual void visit(AstNodeStmt* nodep) VL_OVERRIDE {
+        if (m_replacing) {
+            iterateChildren(nodep);
+            return;
+        }
+        // All references in a statement share a number, so a temp read by
+        // the statement never shares storage with a temp it writes, as
+        // the wide math functions may write their output before reading
+        // all of their inputs
+        ++m_seq;
+        iterateChildren(nodep);
+        ++m_seq;
+    }
+    virtual void visit(AstWhile* nodep) VL_OVERRIDE {
+        if (m_replacing) {
+            iterateChildren(nodep);
+            return;
+        }
+        // A value may go around the loop, so a temp referenced inside is
+        // live through the whole outermost loop
+        const int start = m_seq++;
+        ++m_loopDepth;
+        iterateChildren(nodep);
+        --m_loopDepth;
+        const int end = m_seq++;
+        if (!m_loopDepth) {
+            for (std::vector<size_t>::iterator it = m_loopTemps.begin(); it != m_loopTemps.end();
+                 ++it) {
+                Temp& temp = m_temps[*it];
+                temp.m_start = std::min(temp.m_start, start);
+                temp.m_end = std::max(temp.m_end, end);
+            }
+            m_loopTemps.clear();
+        }
+    }
+    virtual void visit(AstVar*) VL_OVERRIDE {}  // Accelerate
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit PremitReuseVisitor(AstNetlist* nodep) {
+        m_replacing = false;
+        m_seq = 0;
+        m_loopDepth = 0;
+        iterate(nodep);
+    }
+    virtual ~PremitReuseVisitor() {
+        V3Stats::addStat("Optimizations, Temporaries reused", m_statReused);
+    }
+};
+
 //----------------------------------------------------------------------
 // Top loop
 
@@ -424,3 +596,10 @@ void V3Premit::premitAll(AstNetlist* nodep) {
     { PremitVisitor visitor(nodep); }  // Destruct before checking
     V3Global::dumpCheckGlobalTree("premit", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
+
+void V3Premit::reuseTempsAll(AstNetlist* nodep) {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    { PremitReuseVisitor visitor(nodep); }  // Destruct before checking
+    V3Global::dumpCheckGlobalTree("premit_reuse", 0,
+                                  v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
@@ -28,6 +28,7 @@
 class V3Premit {
 public:
     static void premitAll(AstNetlist* nodep);
+    static void reuseTempsAll(AstNetlist* nodep);
 };
 
 #endif  // Guard
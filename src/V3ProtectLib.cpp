@@ -33,6 +33,7 @@ class ProtectVisitor : public AstNVisitor {
 private:
     AstVFile* m_vfilep;  // DPI-enabled Verilog wrapper
     AstCFile* m_cfilep;  // C implementation of DPI functions
+    AstCFile* m_hfilep;  // C header for direct, non-DPI use
     // Verilog text blocks
     AstTextBlock* m_modPortsp;  // Module port list
     AstTextBlock* m_comboPortsp;  // Combo function port list
@@ -58,6 +59,11 @@ private:
     AstTextBlock* m_cSeqClksp;  // Sequential clock copy list
     AstTextBlock* m_cSeqOutsp;  // Sequential output copy list
     AstTextBlock* m_cIgnoreParamsp;  // Combo ignore parameter list
+    AstTextBlock* m_cEvalInsp;  // Direct eval input copy list
+    AstTextBlock* m_cEvalOutsp;  // Direct eval output copy list
+    // C header text blocks
+    AstTextBlock* m_hHashValuep;  // CPP hash value
+    AstTextBlock* m_hPortsp;  // Port structure members
     string m_libName;
     string m_topName;
     bool m_foundTop;  // Have seen the top module
@@ -70,6 +76,9 @@ private:
         m_cfilep
             = new AstCFile(nodep->fileline(), v3Global.opt.makeDir() + "/" + m_libName + ".cpp");
         nodep->addFilesp(m_cfilep);
+        m_hfilep = new AstCFile(nodep->fileline(),
+                                v3Global.opt.makeDir() + "/" + m_libName + "_protectlib.h");
+        nodep->addFilesp(m_hfilep);
         iterateChildren(nodep);
     }
 
@@ -82,12 +91,14 @@ private:
         FileLine* fl = nodep->fileline();
         createSvFile(fl);
         createCppFile(fl);
+        createHFile(fl);
 
         iterateChildren(nodep);
 
         V3Hash hash = V3Hashed::uncachedHash(m_cfilep);
         m_hashValuep->addText(fl, cvtToStr(hash.fullValue()) + ";\n");
         m_cHashValuep->addText(fl, cvtToStr(hash.fullValue()) + "U;\n");
+        m_hHashValuep->addText(fl, cvtToStr(hash.fullValue()) + "U;\n");
         m_foundTop = true;
     }
 
@@ -122,6 +133,11 @@ private:
         addComment(txtp, fl, "Evaluates the secret module's final process");
     }
 
+    void evalComment(AstTextBlock* txtp, FileLine* fl) {
+        addComment(txtp, fl, "Updates all inputs including clocks, evaluates once, and");
+        addComment(txtp, fl, "retrieves the results; for C++ callers instead of the DPI wrapper");
+    }
+
     void createSvFile(FileLine* fl) {
         // Comments
         AstTextBlock* txtp = new AstTextBlock(fl);
@@ -273,17 +289,21 @@ private:
 
         // Includes
         txtp->addText(fl, "#include \"" + m_topName + ".h\"\n");
+        txtp->addText(fl, "#include \"" + m_libName + "_protectlib.h\"\n");
         txtp->addText(fl, "#include \"verilated_dpi.h\"\n\n");
         txtp->addText(fl, "#include <cstdio>\n");
-        txtp->addText(fl, "#include <cstdlib>\n\n");
+        txtp->addText(fl, "#include <cstdlib>\n");
+        txtp->addText(fl, "#include <cstring>\n\n");
 
         // Verilated module plus sequence number
         addComment(txtp, fl, "Container class to house verilated object and sequence number");
         txtp->addText(fl, "class " + m_topName + "_container: public " + m_topName + " {\n");
         txtp->addText(fl, "public:\n");
         txtp->addText(fl, "long long m_seqnum;\n");
+        addComment(txtp, fl, "Inputs may have changed since the last eval()");
+        txtp->addText(fl, "bool m_evalNeeded;\n");
         txtp->addText(fl, m_topName + "_container(const char* scopep__V):\n");
-        txtp->addText(fl, m_topName + "(scopep__V) {}\n");
+        txtp->addText(fl, m_topName + "(scopep__V), m_evalNeeded(true) {}\n");
         txtp->addText(fl, "};\n\n");
 
         // Extern C
@@ -322,8 +342,15 @@ private:
         txtp->addText(fl, ")\n");
         m_cComboInsp = new AstTextBlock(fl, "{\n");
         castPtr(fl, m_cComboInsp);
+        m_cComboInsp->addText(fl, "bool changed__V = handlep__V->m_evalNeeded;\n");
         txtp->addNodep(m_cComboInsp);
-        m_cComboOutsp = new AstTextBlock(fl, "handlep__V->eval();\n");
+        addComment(txtp, fl, "The wrapper may be evaluated with unchanged inputs, e.g. on");
+        addComment(txtp, fl, "every evaluation of a Verilated parent, so skip eval() then");
+        m_cComboOutsp = new AstTextBlock(fl,
+                                         "if (changed__V) {\n"
+                                         "handlep__V->m_evalNeeded = false;\n"
+                                         "handlep__V->eval();\n"
+                                         "}\n");
         txtp->addNodep(m_cComboOutsp);
         txtp->addText(fl, "return handlep__V->m_seqnum++;\n");
         txtp->addText(fl, "}\n\n");
@@ -337,7 +364,9 @@ private:
         m_cSeqClksp = new AstTextBlock(fl, "{\n");
         castPtr(fl, m_cSeqClksp);
         txtp->addNodep(m_cSeqClksp);
-        m_cSeqOutsp = new AstTextBlock(fl, "handlep__V->eval();\n");
+        m_cSeqOutsp = new AstTextBlock(fl,
+                                       "handlep__V->m_evalNeeded = false;\n"
+                                       "handlep__V->eval();\n");
         txtp->addNodep(m_cSeqOutsp);
         txtp->addText(fl, "return handlep__V->m_seqnum++;\n");
         txtp->addText(fl, "}\n\n");
@@ -350,6 +379,18 @@ private:
         txtp->addText(fl, ")\n");
         txtp->addText(fl, "{ }\n\n");
 
+        evalComment(txtp, fl);
+        txtp->addText(fl, "void " + m_libName + "_protectlib_eval(void* vhandlep__V, "
+                              + m_libName + "_protectlib_ports* portsp__V) {\n");
+        castPtr(fl, txtp);
+        m_cEvalInsp = new AstTextBlock(fl);
+        txtp->addNodep(m_cEvalInsp);
+        txtp->addText(fl, "handlep__V->m_evalNeeded = false;\n");
+        txtp->addText(fl, "handlep__V->eval();\n");
+        m_cEvalOutsp = new AstTextBlock(fl);
+        txtp->addNodep(m_cEvalOutsp);
+        txtp->addText(fl, "}\n\n");
+
         // Final
         finalComment(txtp, fl);
         txtp->addText(fl, "void " + m_libName + "_protectlib_final(void* vhandlep__V) {\n");
@@ -362,6 +403,59 @@ private:
         m_cfilep->tblockp(txtp);
     }
 
+    void createHFile(FileLine* fl) {
+        // Comments
+        AstTextBlock* txtp = new AstTextBlock(fl);
+        addComment(txtp, fl, "Direct C++ interface to DPI protected library");
+        addComment(txtp, fl, "Link with lib" + m_libName + ".a or lib" + m_libName + ".so, and");
+        addComment(txtp, fl, "use in place of " + m_libName + ".sv when not in a DPI simulator\n");
+
+        const string guard = "_" + VString::upcase(m_libName) + "_PROTECTLIB_H_";
+        txtp->addText(fl, "#ifndef " + guard + "\n");
+        txtp->addText(fl, "#define " + guard + "\n\n");
+        txtp->addText(fl, "#include <stdint.h>\n\n");
+
+        hashComment(txtp, fl);
+        m_hHashValuep = new AstTextBlock(fl, "static const int " + m_libName
+                                                 + "_protectlib_hash = ");
+        txtp->addNodep(m_hHashValuep);
+        txtp->addText(fl, "\n");
+
+        addComment(txtp, fl, "Values of all ports, laid out as in the secret module");
+        m_hPortsp = new AstTextBlock(fl, "struct " + m_libName + "_protectlib_ports {\n");
+        txtp->addNodep(m_hPortsp);
+        txtp->addText(fl, "};\n\n");
+
+        txtp->addText(fl, "extern \"C\" {\n");
+        txtp->addText(fl, "void " + m_libName
+                              + "_protectlib_check_hash(int protectlib_hash__V);\n");
+        txtp->addText(fl, "void* " + m_libName + "_protectlib_create(const char* scopep__V);\n");
+        txtp->addText(fl, "void " + m_libName + "_protectlib_eval(void* vhandlep__V, "
+                              + m_libName + "_protectlib_ports* portsp__V);\n");
+        txtp->addText(fl, "void " + m_libName + "_protectlib_final(void* vhandlep__V);\n");
+        txtp->addText(fl, "}\n\n");
+
+        txtp->addText(fl, "#endif  // Guard\n");
+        m_hfilep->tblockp(txtp);
+    }
+
+    string directPortDecl(AstVar* varp) {
+        // Same size as the model's own port member, but needing no Verilator headers
+        if (varp->isDouble()) return "double " + varp->name() + ";\n";
+        if (varp->isWide()) {
+            return "uint32_t " + varp->name() + "[" + cvtToStr(varp->widthWords()) + "];\n";
+        }
+        if (varp->isQuad()) return "uint64_t " + varp->name() + ";\n";
+        if (varp->width() > 16) return "uint32_t " + varp->name() + ";\n";
+        if (varp->width() > 8) return "uint16_t " + varp->name() + ";\n";
+        return "uint8_t " + varp->name() + ";\n";
+    }
+
+    string directPortCopy(AstVar* varp, const string& tops, const string& froms) {
+        return "memcpy(&" + tops + "->" + varp->name() + ", &" + froms + "->" + varp->name()
+               + ", sizeof(portsp__V->" + varp->name() + "));\n";
+    }
+
     virtual void visit(AstVar* nodep) VL_OVERRIDE {
         if (!nodep->isIO()) return;
         if (VN_IS(nodep->dtypep(), UnpackArrayDType)) {
@@ -411,11 +505,23 @@ private:
         m_comboIgnorePortsp->addNodep(varp->cloneTree(false));
         m_comboIgnoreParamsp->addText(fl, varp->name() + "\n");
         m_cComboParamsp->addText(fl, varp->dpiArgType(true, false) + "\n");
+        // Compare each input with its old value, as only changes need an eval()
+        m_cComboInsp->addText(fl, "{\n");
+        m_cComboInsp->addText(fl, "char prev__V[sizeof(handlep__V->" + varp->name() + ")];\n");
+        m_cComboInsp->addText(fl, "memcpy(prev__V, &handlep__V->" + varp->name()
+                                      + ", sizeof(prev__V));\n");
         m_cComboInsp->addText(fl, cInputConnection(varp));
+        m_cComboInsp->addText(fl, "if (memcmp(prev__V, &handlep__V->" + varp->name()
+                                      + ", sizeof(prev__V))) changed__V = true;\n");
+        m_cComboInsp->addText(fl, "}\n");
         m_cIgnoreParamsp->addText(fl, varp->dpiArgType(true, false) + "\n");
     }
 
-    void handleInput(AstVar* varp) { m_modPortsp->addNodep(varp->cloneTree(false)); }
+    void handleInput(AstVar* varp) {
+        m_modPortsp->addNodep(varp->cloneTree(false));
+        m_hPortsp->addText(varp->fileline(), directPortDecl(varp));
+        m_cEvalInsp->addText(varp->fileline(), directPortCopy(varp, "handlep__V", "portsp__V"));
+    }
 
     void handleOutput(AstVar* varp) {
         FileLine* fl = varp->fileline();
@@ -445,12 +551,15 @@ private:
                                V3Task::assignInternalToDpi(varp, true, "", "", "handlep__V->"));
         m_cSeqParamsp->addText(fl, varp->dpiArgType(true, false) + "\n");
         m_cSeqOutsp->addText(fl, V3Task::assignInternalToDpi(varp, true, "", "", "handlep__V->"));
+        m_hPortsp->addText(fl, directPortDecl(varp));
+        m_cEvalOutsp->addText(fl, directPortCopy(varp, "portsp__V", "handlep__V"));
     }
 
 public:
     explicit ProtectVisitor(AstNode* nodep)
         : m_vfilep(NULL)
         , m_cfilep(NULL)
+        , m_hfilep(NULL)
         , m_modPortsp(NULL)
         , m_comboPortsp(NULL)
         , m_seqPortsp(NULL)
@@ -474,6 +583,10 @@ public:
         , m_cSeqClksp(NULL)
         , m_cSeqOutsp(NULL)
         , m_cIgnoreParamsp(NULL)
+        , m_cEvalInsp(NULL)
+        , m_cEvalOutsp(NULL)
+        , m_hHashValuep(NULL)
+        , m_hPortsp(NULL)
         , m_libName(v3Global.opt.protectLib())
         , m_topName(v3Global.opt.prefix())
         , m_foundTop(false) {
@@ -27,6 +27,23 @@
 //
 //   Likewise vector assign to the same constant converted to a loop.
 //
+//    Then look for a repeating group of assignments that are the same
+//    except for constant select indices, where each index moves by a
+//    fixed stride from one group to the next:
+//
+//      ASSIGN(ARRAYREF(a, 2), ARRAYREF(b, 10))
+//      ASSIGN(ARRAYREF(c, 0), ARRAYREF(a, 2))
+//      ASSIGN(ARRAYREF(a, 4), ARRAYREF(b, 9))
+//      ASSIGN(ARRAYREF(c, 1), ARRAYREF(a, 4))
+//      ...
+//      ->
+//      FOR(__Vilp = 0; __Vilp <= iters-1; ++__Vilp)
+//         ASSIGN(ARRAYREF(a, 2 + 2*__Vilp), ARRAYREF(b, 10 - __Vilp))
+//         ASSIGN(ARRAYREF(c, __Vilp), ARRAYREF(a, 2 + 2*__Vilp))
+//
+//    The statements keep their original order, so no independence
+//    between the groups is required.
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -41,6 +58,7 @@
 #include <cstdarg>
 
 #define RELOOP_MIN_ITERS 40  // Need at least this many loops to do this optimization
+#define RELOOP_MAX_GROUP 8  // Largest number of statements in a repeated group
 
 //######################################################################
 
@@ -48,6 +66,7 @@ class ReloopVisitor : public AstNVisitor {
 private:
     // TYPES
     typedef std::vector<AstNodeAssign*> AssVec;
+    typedef std::vector<std::pair<AstConst*, AstConst*> > SlotVec;
 
     // NODE STATE
     // AstCFunc::user1p      -> Var* for temp var, 0=not set yet
@@ -56,7 +75,10 @@ private:
     // STATE
     VDouble0 m_statReloops;  // Statistic tracking
     VDouble0 m_statReItems;  // Statistic tracking
+    VDouble0 m_statGroups;  // Statistic tracking
+    VDouble0 m_statGroupItems;  // Statistic tracking
     AstCFunc* m_cfuncp;  // Current block
+    bool m_grouping;  // Second phase, looking for repeated groups
 
     AssVec m_mgAssignps;  // List of assignments merging
     AstCFunc* m_mgCfuncp;  // Parent C function
@@ -142,14 +164,175 @@ private:
         }
     }
 
+    // Group reloop
+    static bool sameList(AstNode* ap, AstNode* bp, SlotVec& slots) {
+        for (; ap && bp; ap = ap->nextp(), bp = bp->nextp()) {
+            if (!sameNode(ap, bp, slots)) return false;
+        }
+        return !ap && !bp;
+    }
+    static bool sameNode(AstNode* ap, AstNode* bp, SlotVec& slots) {
+        // Same tree, except constant select indices, which are returned in slots
+        if (ap->type() != bp->type() || ap->dtypep() != bp->dtypep() || !ap->same(bp)) {
+            return false;
+        }
+        if (AstNodeSel* aselp = VN_CAST(ap, NodeSel)) {
+            AstNodeSel* bselp = VN_CAST(bp, NodeSel);
+            AstConst* abitp = VN_CAST(aselp->bitp(), Const);
+            AstConst* bbitp = VN_CAST(bselp->bitp(), Const);
+            if (abitp && bbitp && abitp->width() <= 32 && abitp->width() == bbitp->width()) {
+                slots.push_back(std::make_pair(abitp, bbitp));
+                return sameList(aselp->fromp(), bselp->fromp(), slots);
+            }
+        }
+        return (sameList(ap->op1p(), bp->op1p(), slots) && sameList(ap->op2p(), bp->op2p(), slots)
+                && sameList(ap->op3p(), bp->op3p(), slots)
+                && sameList(ap->op4p(), bp->op4p(), slots));
+    }
+    static bool sameGroup(const AssVec& stmts, size_t ap, size_t bp, size_t size,
+                          SlotVec& slots) {
+        for (size_t i = 0; i < size; ++i) {
+            if (!sameNode(stmts[ap + i], stmts[bp + i], slots)) return false;
+        }
+        return true;
+    }
+    static size_t groupIters(const AssVec& stmts, size_t startp, size_t size,
+                             std::vector<vlsint64_t>& strides) {
+        // Return number of times the group at startp repeats with constant strides
+        SlotVec slots;
+        if (startp + 2 * size > stmts.size()
+            || !sameGroup(stmts, startp, startp + size, size, slots)) {
+            return 1;
+        }
+        strides.clear();
+        bool moved = false;
+        for (SlotVec::iterator it = slots.begin(); it != slots.end(); ++it) {
+            vlsint64_t stride = static_cast<vlsint64_t>(it->second->toUInt())
+                                - static_cast<vlsint64_t>(it->first->toUInt());
+            strides.push_back(stride);
+            if (stride) moved = true;
+        }
+        if (!moved) return 1;  // Identical statements, leave for other optimizations
+        size_t iters = 2;
+        for (; startp + (iters + 1) * size <= stmts.size(); ++iters) {
+            slots.clear();
+            if (!sameGroup(stmts, startp, startp + iters * size, size, slots)) break;
+            bool strided = true;
+            for (size_t i = 0; strided && i < slots.size(); ++i) {
+                vlsint64_t stride = static_cast<vlsint64_t>(slots[i].second->toUInt())
+                                    - static_cast<vlsint64_t>(slots[i].first->toUInt());
+                strided = (stride == strides[i] * static_cast<vlsint64_t>(iters));
+            }
+            if (!strided) break;
+        }
+        return iters;
+    }
+    AstNode* newIndex(FileLine* fl, AstVar* itp, uint32_t base, vlsint64_t stride) {
+        // Return base + stride * itp
+        AstNode* itrefp = new AstVarRef(fl, itp, false);
+        if (stride == -1) return new AstSub(fl, new AstConst(fl, base), itrefp);
+        if (stride != 1) {
+            itrefp = new AstMul(fl, new AstConst(fl, static_cast<uint32_t>(stride)), itrefp);
+        }
+        if (!base) return itrefp;
+        return new AstAdd(fl, new AstConst(fl, base), itrefp);
+    }
+    void groupReloop(const AssVec& stmts, size_t startp, size_t size, size_t iters) {
+        AstNodeAssign* bodyp = stmts[startp];
+        UINFO(6, "Reloop group size=" << size << " iters=" << iters << " " << bodyp << endl);
+        ++m_statGroups;
+        m_statGroupItems += iters;
+        SlotVec slots;
+        sameGroup(stmts, startp, startp + size, size, slots);
+        FileLine* fl = bodyp->fileline();
+        AstVar* itp = findCreateVarTemp(fl, m_cfuncp);
+
+        AstNode* initp = new AstAssign(fl, new AstVarRef(fl, itp, true), new AstConst(fl, 0));
+        AstNode* condp = new AstLte(fl, new AstVarRef(fl, itp, false),
+                                    new AstConst(fl, static_cast<uint32_t>(iters - 1)));
+        AstNode* incp = new AstAssign(
+            fl, new AstVarRef(fl, itp, true),
+            new AstAdd(fl, new AstConst(fl, 1), new AstVarRef(fl, itp, false)));
+        AstWhile* whilep = new AstWhile(fl, condp, NULL, incp);
+        initp->addNext(whilep);
+        bodyp->replaceWith(initp);
+        whilep->addBodysp(bodyp);
+        for (size_t i = 1; i < size; ++i) whilep->addBodysp(stmts[startp + i]->unlinkFrBack());
+
+        // Replace moving constant indices with expressions of the loop index
+        for (SlotVec::iterator it = slots.begin(); it != slots.end(); ++it) {
+            AstConst* bitp = it->first;
+            vlsint64_t stride = static_cast<vlsint64_t>(it->second->toUInt())
+                                - static_cast<vlsint64_t>(bitp->toUInt());
+            if (!stride) continue;
+            bitp->replaceWith(newIndex(fl, itp, bitp->toUInt(), stride));
+            VL_DO_DANGLING(bitp->deleteTree(), bitp);
+        }
+        if (debug() >= 9) whilep->dumpTree(cout, "-new: ");
+
+        // Remove remaining groups
+        for (size_t i = startp + size; i < startp + size * iters; ++i) {
+            AstNodeAssign* assp = stmts[i];
+            VL_DO_DANGLING(assp->unlinkFrBack()->deleteTree(), assp);
+        }
+    }
+    void groupRun(const AssVec& stmts) {
+        size_t startp = 0;
+        while (startp < stmts.size()) {
+            // Choose the group size covering the most statements
+            size_t bestSize = 0;
+            size_t bestIters = 0;
+            std::vector<vlsint64_t> strides;
+            for (size_t size = 1; size <= RELOOP_MAX_GROUP; ++size) {
+                size_t iters = groupIters(stmts, startp, size, strides);
+                if (iters > 1 && iters * size > bestIters * bestSize) {
+                    bestSize = size;
+                    bestIters = iters;
+                }
+            }
+            if (bestIters * bestSize >= RELOOP_MIN_ITERS) {
+                groupReloop(stmts, startp, bestSize, bestIters);
+                startp += bestSize * bestIters;
+            } else {
+                ++startp;
+            }
+        }
+    }
+    void groupList(AstNode* stmtsp) {
+        // Find runs of assignments in this statement list
+        AssVec stmts;
+        for (AstNode* nodep = stmtsp; nodep;) {
+            AstNode* nextp = nodep->nextp();  // groupRun may relink nodep
+            AstNodeAssign* assp = VN_CAST(nodep, NodeAssign);
+            if (assp) stmts.push_back(assp);
+            if (!assp || !nextp) {
+                groupRun(stmts);
+                stmts.clear();
+            }
+            nodep = nextp;
+        }
+    }
+
     // VISITORS
     virtual void visit(AstCFunc* nodep) VL_OVERRIDE {
         m_cfuncp = nodep;
         iterateChildren(nodep);
+        if (m_grouping) groupList(nodep->stmtsp());
         m_cfuncp = NULL;
     }
+    virtual void visit(AstNodeIf* nodep) VL_OVERRIDE {
+        iterateChildren(nodep);
+        if (m_grouping && m_cfuncp) {
+            groupList(nodep->ifsp());
+            groupList(nodep->elsesp());
+        }
+    }
+    virtual void visit(AstWhile* nodep) VL_OVERRIDE {
+        iterateChildren(nodep);
+        if (m_grouping && m_cfuncp) groupList(nodep->bodysp());
+    }
     virtual void visit(AstNodeAssign* nodep) VL_OVERRIDE {
-        if (!m_cfuncp) return;
+        if (!m_cfuncp || m_grouping) return;
 
         // Left select WordSel or ArraySel
         AstNodeSel* lselp = VN_CAST(nodep->lhsp(), NodeSel);
@@ -241,6 +424,7 @@ public:
     // CONSTRUCTORS
     explicit ReloopVisitor(AstNetlist* nodep) {
         m_cfuncp = NULL;
+        m_grouping = false;
         m_mgCfuncp = NULL;
         m_mgNextp = NULL;
         m_mgSelLp = NULL;
@@ -251,10 +435,14 @@ public:
         m_mgIndexLo = 0;
         m_mgIndexHi = 0;
         iterate(nodep);
+        m_grouping = true;
+        iterate(nodep);
     }
     virtual ~ReloopVisitor() {
         V3Stats::addStat("Optimizations, Reloops", m_statReloops);
         V3Stats::addStat("Optimizations, Reloop iterations", m_statReItems);
+        V3Stats::addStat("Optimizations, Reloop groups", m_statGroups);
+        V3Stats::addStat("Optimizations, Reloop group iterations", m_statGroupItems);
     }
 };
 
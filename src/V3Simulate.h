@@ -41,10 +41,89 @@
 #include "V3Task.h"
 
 #include <deque>
+#include <map>
+#include <set>
 #include <sstream>
 
 //============================================================================
 
+//######################################################################
+// Key for memoizing constant function results
+
+class SimConstFuncKeyVisitor : public AstNVisitor {
+    // Describes a function, and all it calls, as a string that differs if
+    // its code or variable widths differ, e.g. in another parameterization.
+    // Impure if the result may depend on more than the arguments, or the
+    // function has side effects, so must not be memoized.
+    // Uses no user fields, as SimulateVisitor has them in use.
+private:
+    // STATE
+    std::ostringstream m_key;  // Key text
+    std::set<const AstVar*> m_varps;  // Variables declared in the functions
+    std::vector<const AstVar*> m_refVarps;  // Variables referenced
+    std::set<const AstNodeFTask*> m_ftaskps;  // Functions visited
+    bool m_impure;  // Result may depend on non-arguments
+
+    // VISITORS
+    virtual void visit(AstVar* nodep) VL_OVERRIDE {
+        if (!nodep->dtypep()) {  // Not widthed yet
+            m_impure = true;
+            return;
+        }
+        m_varps.insert(nodep);
+        m_key << " " << nodep->name() << ":" << nodep->width()
+              << (nodep->isSigned() ? "s" : "u") << ":"
+              << nodep->dtypep()->arrayUnpackedElements();
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        if (!VN_IS(nodep, VarRef) || !nodep->varp()) {
+            m_impure = true;
+            return;
+        }
+        m_refVarps.push_back(nodep->varp());
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstNodeFTaskRef* nodep) VL_OVERRIDE {
+        if (!nodep->taskp()) {
+            m_impure = true;
+            return;
+        }
+        if (m_ftaskps.insert(nodep->taskp()).second) {
+            m_key << " " << nodep->taskp()->fileline()->ascii() << " " << nodep->name() << "(";
+            iterate(nodep->taskp());
+            m_key << ")";
+        }
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstConst* nodep) VL_OVERRIDE { m_key << " " << nodep->num().ascii(); }
+    // Side effects
+    virtual void visit(AstDisplay* nodep) VL_OVERRIDE { m_impure = true; }
+    virtual void visit(AstStop* nodep) VL_OVERRIDE { m_impure = true; }
+    virtual void visit(AstFinish* nodep) VL_OVERRIDE { m_impure = true; }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE {
+        if (m_impure) return;  // Accelerate
+        iterateChildren(nodep);
+    }
+
+public:
+    // CONSTRUCTORS
+    explicit SimConstFuncKeyVisitor(AstNodeFTask* nodep)
+        : m_impure(false) {
+        m_ftaskps.insert(nodep);
+        m_key << nodep->fileline()->ascii() << " " << nodep->name() << "(";
+        iterate(nodep);
+        m_key << ")";
+        for (std::vector<const AstVar*>::iterator it = m_refVarps.begin();
+             it != m_refVarps.end(); ++it) {
+            if (m_varps.find(*it) == m_varps.end()) m_impure = true;  // E.g. a parameter
+        }
+    }
+    virtual ~SimConstFuncKeyVisitor() {}
+    // METHODS
+    string key() const { return m_impure ? "" : m_key.str(); }
+};
+
 //######################################################################
 // Simulate class functions
 
@@ -62,6 +141,7 @@ public:
 
 typedef std::deque<AstConst*> ConstDeque;
 typedef std::map<AstNodeDType*, ConstDeque> ConstPile;
+typedef std::map<string, V3Number> ConstFuncResults;
 
 class SimulateVisitor : public AstNVisitor {
     // Simulate a node tree, returning value of variables
@@ -114,6 +194,29 @@ private:
     // Note level 8&9 include debugging each simulation value
     VL_DEBUG_FUNC;  // Declare debug()
 
+    static ConstFuncResults& constFuncResults() {
+        // Results of constant function calls, by function and argument
+        // values.  Kept across visitors, as V3Param makes many module copies
+        // that call the same functions.
+        static ConstFuncResults s_results;
+        return s_results;
+    }
+    string constFuncKey(AstNodeFTask* funcp, const V3TaskConnects& tconnects) {
+        // Key for memoizing a call's result, or "" if it can't be
+        if (!VN_IS(funcp, Func)) return "";
+        std::ostringstream key;
+        for (V3TaskConnects::const_iterator it = tconnects.begin(); it != tconnects.end();
+             ++it) {
+            AstNode* pinp = it->second->exprp();
+            AstConst* constp = pinp ? fetchConstNull(pinp) : NULL;
+            if (!constp) return "";  // Missing argument or not a simple value
+            key << constp->num().ascii() << " ";
+        }
+        string funcKey = SimConstFuncKeyVisitor(funcp).key();
+        if (funcKey.empty()) return "";
+        return key.str() + funcKey;
+    }
+
     // Potentially very slow, intended for debugging
     string prettyNumber(const V3Number* nump, AstNodeDType* dtypep) {
         if (AstRefDType* refdtypep = VN_CAST(dtypep, RefDType)) {  //
@@ -956,6 +1059,18 @@ private:
                 iterate(pinp);
             }
         }
+        // Constant functions are often called many times with the same
+        // arguments, e.g. by each instance for its parameters
+        string memoKey;
+        if (!m_checkOnly && optimizable()) memoKey = constFuncKey(funcp, tconnects);
+        if (!memoKey.empty()) {
+            ConstFuncResults::const_iterator it = constFuncResults().find(memoKey);
+            if (it != constFuncResults().end()) {
+                UINFO(5, "   FUNCREF memoized " << nodep << endl);
+                newConst(nodep)->num().opAssign(it->second);
+                return;
+            }
+        }
         for (V3TaskConnects::iterator it = tconnects.begin(); it != tconnects.end(); ++it) {
             AstVar* portp = it->first;
             AstNode* pinp = it->second->exprp();
@@ -973,6 +1088,12 @@ private:
             // Grab return value from output variable (if it's a function)
             UASSERT_OBJ(funcp->fvarp(), nodep, "Function reference points at non-function");
             newValue(nodep, fetchValue(funcp->fvarp()));
+            AstConst* constp = fetchConstNull(nodep);
+            if (!memoKey.empty() && constp) {
+                V3Number num = constp->num();
+                num.nodep(NULL);  // Outlives the node
+                constFuncResults().insert(std::make_pair(memoKey, num));
+            }
         }
     }
 
@@ -75,6 +75,19 @@
 //
 //  Also vars must not be "public" and we also scoreboard nodep->isPure()
 //
+// With --threads, splitAlwaysAll() also splits groups of statements that
+// only share a blocking temporary, so V3Partition may run them in
+// parallel:
+//      ALWAYS
+//              ASSIGN (t = {inputs})     // Cheap, and t used only here
+//              ASSIGN (a <= f(t))
+//              ASSIGN (b <= g(t))
+//      =>
+//      ALWAYS  ASSIGN (t = {inputs})  ASSIGN (a <= f(t))
+//      ALWAYS  ASSIGN (t2 = {inputs})  ASSIGN (b <= g(t2))
+//  The temporary's assignment must be at the top of the block, the only
+//  write of it, before any read, and read only from the block's inputs.
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -625,6 +638,155 @@ private:
 
 typedef vl_unordered_set<uint32_t> ColorSet;
 typedef std::vector<AstAlways*> AlwaysVec;
+// Temporary's assignment, to the split blocks that will each get a copy
+typedef vl_unordered_map<AstNode*, ColorSet> ReplicaMap;
+typedef vl_unordered_map<const AstVarScope*, int> SplitRefCountMap;
+
+//######################################################################
+// Blocking temporaries that split blocks may each compute
+
+class SplitRefCountVisitor : public AstNVisitor {
+    // MEMBERS
+    SplitRefCountMap* m_countsp;  // References to each variable in the netlist
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        if (nodep->varScopep()) ++(*m_countsp)[nodep->varScopep()];
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    SplitRefCountVisitor(AstNetlist* nodep, SplitRefCountMap* countsp)
+        : m_countsp(countsp) {
+        iterate(nodep);
+    }
+    virtual ~SplitRefCountVisitor() {}
+};
+
+class SplitTempVisitor : public AstNVisitor {
+public:
+    // TYPES
+    typedef std::vector<AstAssign*> AssignVec;
+
+private:
+    enum { MAX_NODES = 32 };  // Largest expression worth computing in each block
+    struct VarInfo {
+        int m_refs;  // References in the block
+        int m_writes;  // Writes in the block
+        bool m_readBeforeWrite;  // Read before the first write
+        AstAssign* m_writerp;  // Top level assignment that is the first write
+        VarInfo()
+            : m_refs(0)
+            , m_writes(0)
+            , m_readBeforeWrite(false)
+            , m_writerp(NULL) {}
+    };
+    typedef vl_unordered_map<const AstVarScope*, VarInfo> InfoMap;
+
+    // MEMBERS
+    InfoMap m_infos;  // Each variable referenced in the block
+    AssignVec m_writersp;  // Top level assignments to a whole variable, in order
+    AssignVec m_tempsp;  // Result: assignments of the temporaries
+    // Checking an expression
+    bool m_cheap;  // Expression is pure, small, and reads only inputs
+    int m_nodes;  // Nodes in expression
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    bool cheapInputs(AstNode* nodep) {
+        m_cheap = true;
+        m_nodes = 0;
+        iterate(nodep);
+        m_nodes = -1;
+        return m_cheap;
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        if (m_nodes >= 0) {  // Checking an expression
+            ++m_nodes;
+            InfoMap::const_iterator it = m_infos.find(nodep->varScopep());
+            if (it != m_infos.end() && it->second.m_writes) m_cheap = false;
+            return;
+        }
+        VarInfo& info = m_infos[nodep->varScopep()];
+        ++info.m_refs;
+        if (nodep->lvalue()) {
+            ++info.m_writes;
+        } else if (!info.m_writes) {
+            info.m_readBeforeWrite = true;
+        }
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE {
+        if (m_nodes >= 0) {  // Checking an expression
+            if (!nodep->isPure() || ++m_nodes > MAX_NODES) m_cheap = false;
+            if (!m_cheap) return;
+        }
+        iterateChildren(nodep);
+    }
+
+public:
+    // CONSTRUCTORS
+    SplitTempVisitor(AstNode* bodysp, const SplitRefCountMap& counts)
+        : m_cheap(false)
+        , m_nodes(-1) {
+        for (AstNode* stmtp = bodysp; stmtp; stmtp = stmtp->nextp()) {
+            AstAssign* assp = VN_CAST(stmtp, Assign);
+            AstVarRef* lhsp = assp ? VN_CAST(assp->lhsp(), VarRef) : NULL;
+            if (!lhsp) {
+                iterate(stmtp);
+                continue;
+            }
+            iterate(assp->rhsp());
+            VarInfo& info = m_infos[lhsp->varScopep()];
+            if (!info.m_writes) info.m_writerp = assp;
+            iterate(lhsp);
+            m_writersp.push_back(assp);
+        }
+        for (AssignVec::iterator it = m_writersp.begin(); it != m_writersp.end(); ++it) {
+            AstVarRef* lhsp = VN_CAST((*it)->lhsp(), VarRef);
+            const VarInfo& info = m_infos[lhsp->varScopep()];
+            AstVar* varp = lhsp->varp();
+            SplitRefCountMap::const_iterator cit = counts.find(lhsp->varScopep());
+            if (info.m_writes == 1 && info.m_writerp == *it && !info.m_readBeforeWrite
+                && info.m_refs > 1 && cit != counts.end() && cit->second == info.m_refs
+                && !varp->isSigPublic() && !varp->isIO() && !varp->isConst()
+                && cheapInputs((*it)->rhsp())) {
+                UINFO(8, "    Replicable temp " << lhsp->varScopep() << endl);
+                m_tempsp.push_back(*it);
+            }
+        }
+    }
+    virtual ~SplitTempVisitor() {}
+    // METHODS
+    const AssignVec& tempsp() const { return m_tempsp; }
+};
+
+class SplitRenameVisitor : public AstNVisitor {
+    // MEMBERS
+    const AstVarScope* m_fromp;  // Variable to replace
+    AstVarScope* m_top;  // Replacement
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        if (nodep->varScopep() != m_fromp) return;
+        nodep->varScopep(m_top);
+        nodep->varp(m_top->varp());
+        nodep->name(m_top->varp()->name());
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    SplitRenameVisitor(AstNode* nodep, const AstVarScope* fromp, AstVarScope* top)
+        : m_fromp(fromp)
+        , m_top(top) {
+        iterate(nodep);
+    }
+    virtual ~SplitRenameVisitor() {}
+};
+
+//######################################################################
 
 class IfColorVisitor : public AstNVisitor {
     // MEMBERS
@@ -637,11 +799,16 @@ class IfColorVisitor : public AstNVisitor {
     IfColorMap m_ifColors;  // Map each if-statement to the set of colors (split blocks)
     // that will get a copy of that if-statement
 
+    const ReplicaMap* m_replicasp;  // Statements copied to their readers' colors instead
+
     // CONSTRUCTORS
 public:
     // Visit through *nodep and map each AstNodeIf within to the set of
     // colors it will participate in. Also find the whole set of colors.
-    explicit IfColorVisitor(AstAlways* nodep) { iterate(nodep); }
+    IfColorVisitor(AstAlways* nodep, const ReplicaMap* replicasp)
+        : m_replicasp(replicasp) {
+        iterate(nodep);
+    }
     virtual ~IfColorVisitor() {}
 
     // METHODS
@@ -654,7 +821,7 @@ public:
 
 private:
     void trackNode(AstNode* nodep) {
-        if (nodep->user3p()) {
+        if (nodep->user3p() && !m_replicasp->count(nodep)) {
             SplitLogicVertex* vertexp = reinterpret_cast<SplitLogicVertex*>(nodep->user3p());
             uint32_t color = vertexp->color();
             m_colors.insert(color);
@@ -694,16 +861,20 @@ class EmitSplitVisitor : public AstNVisitor {
     LocMap m_addAfter;
 
     AlwaysVec* m_newBlocksp;  // Split always blocks we have generated
+    const ReplicaMap* m_replicasp;  // Statements to copy into several colors
+    vl_unordered_map<uint32_t, AstAlways*> m_colorAlwaysps;  // New always for each color
 
     // CONSTRUCTORS
 public:
     // EmitSplitVisitor visits through always block *nodep
     // and generates its split blocks, writing the split blocks
     // into *newBlocksp.
-    EmitSplitVisitor(AstAlways* nodep, const IfColorVisitor* ifColorp, AlwaysVec* newBlocksp)
+    EmitSplitVisitor(AstAlways* nodep, const IfColorVisitor* ifColorp, AlwaysVec* newBlocksp,
+                     const ReplicaMap* replicasp)
         : m_origAlwaysp(nodep)
         , m_ifColorp(ifColorp)
-        , m_newBlocksp(newBlocksp) {
+        , m_newBlocksp(newBlocksp)
+        , m_replicasp(replicasp) {
         UINFO(6, "  splitting always " << nodep << endl);
     }
 
@@ -724,12 +895,14 @@ public:
             alwaysp->addStmtp(placeholderp);
             m_addAfter[*color] = placeholderp;
             m_newBlocksp->push_back(alwaysp);
+            m_colorAlwaysps[*color] = alwaysp;
         }
         // Scan the body of the always. We'll handle if/else
         // specially, everything else is a leaf node that we can
         // just clone into one of the split always blocks.
         iterateAndNextNull(m_origAlwaysp->bodysp());
     }
+    AstAlways* alwaysp(uint32_t color) const { return m_colorAlwaysps.find(color)->second; }
 
 protected:
     VL_DEBUG_FUNC;  // Declare debug()
@@ -752,6 +925,18 @@ protected:
         // Each leaf must have a user3p
         UASSERT_OBJ(nodep->user3p(), nodep, "null user3p in V3Split leaf");
 
+        // A temporary's assignment goes into each block that reads it
+        ReplicaMap::const_iterator rit = m_replicasp->find(nodep);
+        if (rit != m_replicasp->end()) {
+            for (ColorSet::const_iterator color = rit->second.begin();
+                 color != rit->second.end(); ++color) {
+                AstNode* clonedp = nodep->cloneTree(false);
+                m_addAfter[*color]->addNextHere(clonedp);
+                m_addAfter[*color] = clonedp;
+            }
+            return;
+        }
+
         // Clone the leaf into its new always block
         SplitLogicVertex* vxp = reinterpret_cast<SplitLogicVertex*>(nodep->user3p());
         uint32_t color = vxp->color();
@@ -832,10 +1017,17 @@ private:
     // AstNodeIf* whose condition we're currently visiting
     AstNode* m_curIfConditional;
 
+    // Splitting temporaries, with --threads
+    SplitRefCountMap m_refCounts;  // References to each variable in the netlist
+    typedef std::map<std::pair<AstNodeModule*, string>, AstVar*> VarMap;
+    VarMap m_modVarMap;  // Copies of temporaries made for each module
+    VDouble0 m_statTemps;  // Statistic tracking
+
     // CONSTRUCTORS
 public:
     explicit SplitVisitor(AstNetlist* nodep)
         : m_curIfConditional(NULL) {
+        if (v3Global.opt.mtasks()) SplitRefCountVisitor counter(nodep, &m_refCounts);
         iterate(nodep);
 
         // Splice newly-split blocks into the tree. Remove placeholders
@@ -854,7 +1046,9 @@ public:
         }
     }
 
-    virtual ~SplitVisitor() {}
+    virtual ~SplitVisitor() {
+        V3Stats::addStat("Optimizations, Split always temps copied", m_statTemps);
+    }
 
     // METHODS
 protected:
@@ -868,7 +1062,80 @@ protected:
         }
     }
 
-    void colorAlwaysGraph() {
+    void pruneDepsOnTemps(const SplitTempVisitor::AssignVec& tempsp) {
+        // Each split block reading a temporary will compute its own, so
+        // the temporary doesn't hold its readers together
+        for (SplitTempVisitor::AssignVec::const_iterator it = tempsp.begin(); it != tempsp.end();
+             ++it) {
+            AstVarScope* vscp = VN_CAST((*it)->lhsp(), VarRef)->varScopep();
+            V3GraphVertex* vstdp = reinterpret_cast<SplitVarStdVertex*>(vscp->user1p());
+            for (V3GraphEdge* edgep = vstdp->inBeginp(); edgep; edgep = edgep->inNextp()) {
+                static_cast<SplitEdge*>(edgep)->setIgnoreThisStep();
+            }
+            for (V3GraphEdge* edgep = vstdp->outBeginp(); edgep; edgep = edgep->outNextp()) {
+                static_cast<SplitEdge*>(edgep)->setIgnoreThisStep();
+            }
+        }
+    }
+
+    AstVarScope* copyTempVarScope(AstVarScope* vscp, int copy) {
+        const string name = "__Vsplit" + cvtToStr(copy) + "__" + vscp->varp()->name();
+        AstNodeModule* addmodp = vscp->scopep()->modp();
+        AstVar* varp;
+        VarMap::iterator it = m_modVarMap.find(make_pair(addmodp, name));
+        if (it != m_modVarMap.end()) {
+            varp = it->second;  // Made earlier for another scope of the module
+        } else {
+            varp = new AstVar(vscp->fileline(), AstVarType::BLOCKTEMP, name, vscp->varp());
+            varp->dtypeFrom(vscp);
+            addmodp->addStmtp(varp);
+            m_modVarMap.insert(make_pair(make_pair(addmodp, name), varp));
+        }
+        AstVarScope* newp = new AstVarScope(vscp->fileline(), vscp->scopep(), varp);
+        vscp->scopep()->addVarp(newp);
+        return newp;
+    }
+
+    void findTempReaders(const SplitTempVisitor::AssignVec& tempsp, const IfColorVisitor& ifColor,
+                         ReplicaMap* replicasp) {
+        // Each temporary is copied into the colors that read it
+        for (SplitTempVisitor::AssignVec::const_iterator it = tempsp.begin(); it != tempsp.end();
+             ++it) {
+            AstVarScope* vscp = VN_CAST((*it)->lhsp(), VarRef)->varScopep();
+            V3GraphVertex* vstdp = reinterpret_cast<SplitVarStdVertex*>(vscp->user1p());
+            ColorSet& colors = (*replicasp)[*it];
+            for (V3GraphEdge* edgep = vstdp->inBeginp(); edgep; edgep = edgep->inNextp()) {
+                SplitLogicVertex* logicp = dynamic_cast<SplitLogicVertex*>(edgep->fromp());
+                if (!logicp) continue;
+                if (AstNodeIf* ifp = VN_CAST(logicp->nodep(), NodeIf)) {
+                    const ColorSet& ifColors = ifColor.colors(ifp);
+                    colors.insert(ifColors.begin(), ifColors.end());
+                } else {
+                    colors.insert(logicp->color());
+                }
+            }
+        }
+    }
+
+    void renameTemps(const SplitTempVisitor::AssignVec& tempsp, const ReplicaMap& replicas,
+                     const EmitSplitVisitor& emitSplit) {
+        // Give each split block reading a temporary its own copy, so the
+        // blocks don't depend on each other
+        for (SplitTempVisitor::AssignVec::const_iterator it = tempsp.begin(); it != tempsp.end();
+             ++it) {
+            AstVarScope* vscp = VN_CAST((*it)->lhsp(), VarRef)->varScopep();
+            const ColorSet& colorSet = replicas.find(*it)->second;
+            std::vector<uint32_t> colors(colorSet.begin(), colorSet.end());
+            std::sort(colors.begin(), colors.end());  // Stable names
+            for (size_t i = 1; i < colors.size(); ++i) {
+                AstVarScope* newp = copyTempVarScope(vscp, i);
+                SplitRenameVisitor visitor(emitSplit.alwaysp(colors[i]), vscp, newp);
+                ++m_statTemps;
+            }
+        }
+    }
+
+    void colorAlwaysGraph(const SplitTempVisitor::AssignVec& tempsp) {
         // Color the graph to indicate subsets, each of which
         // we can split into its own always block.
         m_graph.removeRedundantEdges(&V3GraphEdge::followAlwaysTrue);
@@ -880,6 +1147,7 @@ protected:
         // must be kept together.
         SplitEdge::incrementStep();
         pruneDepsOnInputs();
+        pruneDepsOnTemps(tempsp);
 
         // For any 'if' node whose deps have all been pruned
         // (meaning, its conditional expression only looks at primary
@@ -944,14 +1212,27 @@ protected:
             return;
         }
 
+        // With threads, find temporaries each split block can compute
+        SplitTempVisitor::AssignVec tempsp;
+        if (v3Global.opt.mtasks()) {
+            SplitTempVisitor temps(nodep->bodysp(), m_refCounts);
+            tempsp = temps.tempsp();
+        }
+
         // Look across the entire tree of if/else blocks in the always,
         // and color regions that must be kept together.
         UINFO(5, "SplitVisitor @ " << nodep << endl);
-        colorAlwaysGraph();
+        colorAlwaysGraph(tempsp);
 
         // Map each AstNodeIf to the set of colors (split always blocks)
         // it must participate in. Also find the whole set of colors.
-        IfColorVisitor ifColor(nodep);
+        ReplicaMap replicas;
+        for (SplitTempVisitor::AssignVec::const_iterator it = tempsp.begin(); it != tempsp.end();
+             ++it) {
+            replicas[*it];
+        }
+        IfColorVisitor ifColor(nodep, &replicas);
+        findTempReaders(tempsp, ifColor, &replicas);
 
         if (ifColor.colors().size() > 1) {
             // Counting original always blocks rather than newly-split
@@ -961,8 +1242,9 @@ protected:
 
             // Visit through the original always block one more time,
             // and emit the split always blocks into m_replaceBlocks:
-            EmitSplitVisitor emitSplit(nodep, &ifColor, &(m_replaceBlocks[nodep]));
+            EmitSplitVisitor emitSplit(nodep, &ifColor, &(m_replaceBlocks[nodep]), &replicas);
             emitSplit.go();
+            renameTemps(tempsp, replicas, emitSplit);
         }
     }
     virtual void visit(AstNodeIf* nodep) VL_OVERRIDE {
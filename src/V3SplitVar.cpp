@@ -1289,11 +1289,415 @@ const char* SplitVarImpl::cannotSplitPackedVarReason(const AstVar* varp) {
     return SplitPackedVarVisitor::cannotSplitReason(varp, true);
 }
 
+//######################################################################
+//  Find packed variables to split without split_var metacomment
+
+class SplitAutoVarVisitor : public AstNVisitor, public SplitVarImpl {
+    // A variable makes a false combinational loop when the same
+    // combinational logic writes some bits of it and reads other bits.
+    // Such variables are marked with attrSplitVar, as if the user had
+    // written split_var, when every reference has a constant bit range,
+    // so the split will succeed without SPLITVAR warnings.
+    // TYPES
+    typedef std::vector<std::pair<int, int> > RangeVec;  // lsb, msb
+    struct ProcRefs {
+        RangeVec m_writes;  // Bits written by this combinational logic
+        RangeVec m_reads;  // Bits read by this combinational logic
+    };
+    struct VarInfo {
+        bool m_ok;  // Can be split, all references so far are constant ranges
+        vl_unordered_map<const AstNode*, ProcRefs> m_procs;  // Combinational logic using it
+        VarInfo()
+            : m_ok(false) {}
+    };
+    // MEMBERS
+    AstNodeModule* m_modp;  // Current module
+    AstNode* m_procp;  // Current combinational logic, or NULL
+    bool m_inUnsplittable;  // Under a pin or task, references can't be split here
+    std::vector<AstVar*> m_varps;  // Variables referenced in module, in order found
+    vl_unordered_map<AstVar*, VarInfo> m_vars;  // Information on each of m_varps
+    VDouble0 m_statAuto;  // Variables marked for split
+
+    // METHODS
+    VarInfo* infop(AstVar* varp) {
+        vl_unordered_map<AstVar*, VarInfo>::iterator it = m_vars.find(varp);
+        if (it != m_vars.end()) return &it->second;
+        VarInfo& info = m_vars[varp];
+        m_varps.push_back(varp);
+        info.m_ok = !varp->attrSplitVar() && !varp->isIO() && !cannotSplitPackedVarReason(varp);
+        return &info;
+    }
+    void addRef(AstVar* varp, int lsb, int width, bool lvalue) {
+        VarInfo* const infop = this->infop(varp);
+        if (!infop->m_ok) return;
+        if (m_inUnsplittable) {
+            infop->m_ok = false;
+        } else if (m_procp) {
+            ProcRefs& refs = infop->m_procs[m_procp];
+            RangeVec& ranges = lvalue ? refs.m_writes : refs.m_reads;
+            ranges.push_back(std::make_pair(lsb, lsb + width - 1));
+        }
+    }
+    static bool overlaps(const RangeVec& as, const RangeVec& bs) {
+        for (RangeVec::const_iterator ait = as.begin(); ait != as.end(); ++ait) {
+            for (RangeVec::const_iterator bit = bs.begin(); bit != bs.end(); ++bit) {
+                if (ait->first <= bit->second && bit->first <= ait->second) return true;
+            }
+        }
+        return false;
+    }
+    static bool hasFalseLoop(const VarInfo& info) {
+        for (vl_unordered_map<const AstNode*, ProcRefs>::const_iterator it = info.m_procs.begin();
+             it != info.m_procs.end(); ++it) {
+            const ProcRefs& refs = it->second;
+            if (!refs.m_writes.empty() && !refs.m_reads.empty()
+                && !overlaps(refs.m_writes, refs.m_reads)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    void iterateProc(AstNode* nodep, bool combo) {
+        AstNode* const origProcp = m_procp;
+        m_procp = combo ? nodep : NULL;
+        iterateChildren(nodep);
+        m_procp = origProcp;
+    }
+    void iterateUnsplittable(AstNode* nodep) {
+        const bool origInUnsplittable = m_inUnsplittable;
+        m_inUnsplittable = true;
+        iterateChildren(nodep);
+        m_inUnsplittable = origInUnsplittable;
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        if (!VN_IS(nodep, Module)) return;
+        m_modp = nodep;
+        iterateChildren(nodep);
+        for (std::vector<AstVar*>::const_iterator it = m_varps.begin(); it != m_varps.end();
+             ++it) {
+            const VarInfo& info = m_vars[*it];
+            if (info.m_ok && hasFalseLoop(info)) {
+                UINFO(4, "Auto split_var " << (*it)->prettyNameQ() << " in "
+                                           << nodep->prettyNameQ() << endl);
+                (*it)->attrSplitVar(true);
+                ++m_statAuto;
+            }
+        }
+        m_varps.clear();
+        m_vars.clear();
+        m_modp = NULL;
+    }
+    virtual void visit(AstAlways* nodep) VL_OVERRIDE {
+        iterateProc(nodep, !nodep->sensesp() || !nodep->sensesp()->hasClocked());
+    }
+    virtual void visit(AstAssignW* nodep) VL_OVERRIDE { iterateProc(nodep, true); }
+    virtual void visit(AstInitial* nodep) VL_OVERRIDE { iterateProc(nodep, false); }
+    virtual void visit(AstFinal* nodep) VL_OVERRIDE { iterateProc(nodep, false); }
+    virtual void visit(AstNodeFTask* nodep) VL_OVERRIDE { iterateUnsplittable(nodep); }
+    virtual void visit(AstPin* nodep) VL_OVERRIDE { iterateUnsplittable(nodep); }
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        AstVar* const varp = nodep->varp();
+        addRef(varp, 0, varp->width(), nodep->lvalue());
+    }
+    virtual void visit(AstSel* nodep) VL_OVERRIDE {
+        AstVarRef* const vrefp = VN_CAST(nodep->fromp(), VarRef);
+        const AstConst* const lsbp = VN_CAST(nodep->lsbp(), Const);
+        const AstConst* const widthp = VN_CAST(nodep->widthp(), Const);
+        if (vrefp && lsbp && widthp) {
+            addRef(vrefp->varp(), lsbp->toSInt(), widthp->toSInt(), vrefp->lvalue());
+        } else {
+            if (vrefp && !m_inUnsplittable) infop(vrefp->varp())->m_ok = false;
+            iterateChildren(nodep);
+        }
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit SplitAutoVarVisitor(AstNetlist* nodep)
+        : m_modp(NULL)
+        , m_procp(NULL)
+        , m_inUnsplittable(false) {
+        iterate(nodep);
+    }
+    virtual ~SplitAutoVarVisitor() {
+        V3Stats::addStat("SplitVar, Automatically split candidates", m_statAuto);
+    }
+    VL_DEBUG_FUNC;  // Declare debug()
+};
+
+//######################################################################
+//  Split unpacked arrays of packed structs into an array per field
+
+class SplitFieldsVarVisitor : public AstNVisitor, public SplitVarImpl {
+    // An unpacked array of packed structs is stored as an array of whole
+    // entries, so logic reading one field of every entry strides across
+    // the other fields.  When references to single fields outnumber
+    // references to whole entries, each field is stored as its own array:
+    //     entry_t mem[N];  mem[i].valid       =>  mem__Vfld__valid[i]
+    //     rd = mem[i];                        =>  rd = {mem__Vfld__data[i], ...};
+    //     mem[i] <= wr;                       =>  mem__Vfld__data[i] <= wr[..]; ...
+    // NODE STATE
+    //  AstVar::user1()         -> bool.  Referenced hierarchically, can't split
+    AstUser1InUse m_inuser1;
+
+    // TYPES
+    struct VarInfo {
+        bool m_declared;  // Declared in a module, outside any task
+        bool m_ok;  // Can be split, all references so far are supported
+        int m_fieldRefs;  // References to bits within one field
+        int m_entryRefs;  // References to whole entries
+        std::vector<AstNode*> m_refps;  // Sel of a field, or ArraySel of an entry
+        VarInfo()
+            : m_declared(false)
+            , m_ok(false)
+            , m_fieldRefs(0)
+            , m_entryRefs(0) {}
+    };
+    // MEMBERS
+    AstNetlist* m_netp;
+    AstNodeModule* m_modp;  // Current module, or NULL if not in a module
+    AstNodeFTask* m_ftaskp;  // Current task
+    bool m_inSenItem;  // Under a sensitivity item
+    std::vector<AstVar*> m_varps;  // Variables referenced, in order found
+    vl_unordered_map<AstVar*, VarInfo> m_vars;  // Information on each of m_varps
+    VDouble0 m_statSplit;  // Variables split
+
+    // METHODS
+    // Return the element type if the variable is an array of packed structs
+    static AstStructDType* structDTypep(const AstVar* varp) {
+        const AstUnpackArrayDType* const arrayp
+            = VN_CAST(varp->dtypeSkipRefp(), UnpackArrayDType);
+        if (!arrayp) return NULL;
+        AstStructDType* const structp = VN_CAST(arrayp->subDTypep()->skipRefp(), StructDType);
+        if (!structp || !structp->packed()) return NULL;
+        return structp;
+    }
+    static AstMemberDType* findMember(AstStructDType* structp, int lsb, int width) {
+        for (AstMemberDType* memberp = structp->membersp(); memberp;
+             memberp = VN_CAST(memberp->nextp(), MemberDType)) {
+            if (memberp->lsb() <= lsb && lsb + width <= memberp->lsb() + memberp->width()) {
+                return memberp;
+            }
+        }
+        return NULL;
+    }
+    // Whether an expression may be duplicated for each field
+    static bool cloneOk(const AstNode* nodep) {
+        if (!nodep) return true;
+        if (!nodep->isGateOptimizable()) return false;
+        if (const AstNodeVarRef* const vrefp = VN_CAST_CONST(nodep, NodeVarRef)) {
+            // The reference may itself be split, so must not be copied
+            if (!vrefp->varp() || structDTypep(vrefp->varp())) return false;
+        }
+        return cloneOk(nodep->op1p()) && cloneOk(nodep->op2p()) && cloneOk(nodep->op3p())
+               && cloneOk(nodep->op4p());
+    }
+    VarInfo* infop(AstVar* varp) {
+        vl_unordered_map<AstVar*, VarInfo>::iterator it = m_vars.find(varp);
+        if (it != m_vars.end()) return &it->second;
+        VarInfo& info = m_vars[varp];
+        m_varps.push_back(varp);
+        info.m_ok = structDTypep(varp) && !varp->attrSplitVar() && !varp->isIO()
+                    && !varp->isTrace() && !varp->valuep() && !cannotSplitVarCommonReason(varp);
+        return &info;
+    }
+    // Return information on a variable that may be split, or NULL
+    VarInfo* candidatep(AstVarRef* vrefp) {
+        if (!m_modp) return NULL;
+        VarInfo* const infop = this->infop(vrefp->varp());
+        if (infop->m_ok && (m_inSenItem || vrefp->packagep())) infop->m_ok = false;
+        return infop->m_ok ? infop : NULL;
+    }
+    AstVar* newFieldVar(AstVar* varp, AstMemberDType* memberp) {
+        const AstUnpackArrayDType* const arrayp = VN_CAST(varp->dtypeSkipRefp(), UnpackArrayDType);
+        AstUnpackArrayDType* const dtypep = new AstUnpackArrayDType(
+            varp->fileline(), memberp->subDTypep(), arrayp->rangep()->cloneTree(false));
+        m_netp->typeTablep()->addTypesp(dtypep);
+        AstVar* const newp = new AstVar(varp->fileline(), AstVarType::VAR,
+                                        varp->name() + "__Vfld__" + memberp->name(), dtypep);
+        newp->propagateAttrFrom(varp);
+        varp->addNextHere(newp);
+        UINFO(4, newp->prettyNameQ() << " is added for " << varp->prettyNameQ() << endl);
+        return newp;
+    }
+    static AstNode* newFieldSel(FileLine* fl, AstVar* fieldVarp, AstNode* bitp, bool lvalue) {
+        return new AstArraySel(fl, new AstVarRef(fl, fieldVarp, lvalue), bitp);
+    }
+    void split(AstVar* varp, const VarInfo& info) {
+        AstStructDType* const structp = structDTypep(varp);
+        typedef std::map<const AstMemberDType*, AstVar*> FieldMap;
+        FieldMap fields;
+        for (AstMemberDType* memberp = structp->membersp(); memberp;
+             memberp = VN_CAST(memberp->nextp(), MemberDType)) {
+            fields[memberp] = newFieldVar(varp, memberp);
+        }
+        for (std::vector<AstNode*>::const_iterator it = info.m_refps.begin();
+             it != info.m_refps.end(); ++it) {
+            FileLine* const fl = (*it)->fileline();
+            if (AstSel* selp = VN_CAST(*it, Sel)) {  // One field
+                AstArraySel* const aselp = VN_CAST(selp->fromp(), ArraySel);
+                const bool lvalue = VN_CAST(aselp->fromp(), VarRef)->lvalue();
+                const int lsb = VN_CAST(selp->lsbp(), Const)->toSInt();
+                const int width = selp->widthConst();
+                AstMemberDType* const memberp = findMember(structp, lsb, width);
+                AstNode* newp = newFieldSel(fl, fields[memberp], aselp->bitp()->unlinkFrBack(),
+                                            lvalue);
+                if (width != memberp->width()) {
+                    newp = new AstSel(fl, newp, lsb - memberp->lsb(), width);
+                }
+                selp->replaceWith(newp);
+                VL_DO_DANGLING(pushDeletep(selp), selp);
+                continue;
+            }
+            AstArraySel* aselp = VN_CAST(*it, ArraySel);
+            if (VN_CAST(aselp->fromp(), VarRef)->lvalue()) {
+                // Whole entry written, write each field
+                AstNodeAssign* assignp = VN_CAST(aselp->backp(), NodeAssign);
+                for (AstMemberDType* memberp = structp->membersp(); memberp;
+                     memberp = VN_CAST(memberp->nextp(), MemberDType)) {
+                    AstNode* const lhsp
+                        = newFieldSel(fl, fields[memberp], aselp->bitp()->cloneTree(false), true);
+                    AstNode* const rhsp = new AstSel(fl, assignp->rhsp()->cloneTree(false),
+                                                     memberp->lsb(), memberp->width());
+                    assignp->addHereThisAsNext(assignp->cloneType(lhsp, rhsp));
+                }
+                VL_DO_DANGLING(pushDeletep(assignp->unlinkFrBack()), assignp);
+            } else {  // Whole entry read, concatenate the fields
+                AstNode* newp = NULL;
+                for (AstMemberDType* memberp = structp->membersp(); memberp;
+                     memberp = VN_CAST(memberp->nextp(), MemberDType)) {
+                    AstNode* const fieldp = newFieldSel(fl, fields[memberp],
+                                                        aselp->bitp()->cloneTree(false), false);
+                    // Members are listed from the most significant
+                    newp = newp ? new AstConcat(fl, newp, fieldp) : fieldp;
+                }
+                aselp->replaceWith(newp);
+                VL_DO_DANGLING(pushDeletep(aselp), aselp);
+            }
+        }
+        UINFO(3, "Split " << varp->prettyNameQ() << " into " << fields.size() << " fields\n");
+        VL_DO_DANGLING(pushDeletep(varp->unlinkFrBack()), varp);
+        ++m_statSplit;
+    }
+    void iterateNotModule(AstNode* nodep) {
+        AstNodeModule* const origModp = m_modp;
+        m_modp = NULL;
+        iterateChildren(nodep);
+        m_modp = origModp;
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        AstNodeModule* const origModp = m_modp;
+        m_modp = VN_IS(nodep, Module) ? nodep : NULL;
+        iterateChildren(nodep);
+        m_modp = origModp;
+    }
+    virtual void visit(AstNodeFTask* nodep) VL_OVERRIDE {
+        if (cannotSplitTaskReason(nodep)) {
+            iterateNotModule(nodep);
+        } else {
+            m_ftaskp = nodep;
+            iterateChildren(nodep);
+            m_ftaskp = NULL;
+        }
+    }
+    virtual void visit(AstPin* nodep) VL_OVERRIDE { iterateNotModule(nodep); }
+    virtual void visit(AstSenItem* nodep) VL_OVERRIDE {
+        m_inSenItem = true;
+        iterateChildren(nodep);
+        m_inSenItem = false;
+    }
+    virtual void visit(AstVar* nodep) VL_OVERRIDE {
+        if (m_modp && !m_ftaskp && structDTypep(nodep)) infop(nodep)->m_declared = true;
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstVarXRef* nodep) VL_OVERRIDE {
+        if (nodep->varp()) nodep->varp()->user1(true);
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        // Whole array referenced, or referenced outside a module
+        if (!structDTypep(nodep->varp())) return;
+        if (m_modp) {
+            infop(nodep->varp())->m_ok = false;
+        } else {
+            nodep->varp()->user1(true);
+        }
+    }
+    virtual void visit(AstSel* nodep) VL_OVERRIDE {
+        AstArraySel* const aselp = VN_CAST(nodep->fromp(), ArraySel);
+        AstVarRef* const vrefp = aselp ? VN_CAST(aselp->fromp(), VarRef) : NULL;
+        if (VarInfo* const infop = vrefp ? candidatep(vrefp) : NULL) {
+            const AstConst* const lsbp = VN_CAST(nodep->lsbp(), Const);
+            const AstConst* const widthp = VN_CAST(nodep->widthp(), Const);
+            if (lsbp && widthp
+                && findMember(structDTypep(vrefp->varp()), lsbp->toSInt(), widthp->toSInt())) {
+                ++infop->m_fieldRefs;
+                infop->m_refps.push_back(nodep);
+                iterate(aselp->bitp());
+                return;
+            }
+        }
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstArraySel* nodep) VL_OVERRIDE {
+        AstVarRef* const vrefp = VN_CAST(nodep->fromp(), VarRef);
+        if (VarInfo* const infop = vrefp ? candidatep(vrefp) : NULL) {
+            bool ok = cloneOk(nodep->bitp());
+            if (vrefp->lvalue()) {
+                // Only a simple assignment of the whole entry can be split
+                const AstNodeAssign* const assignp = VN_CAST(nodep->backp(), NodeAssign);
+                ok = ok && assignp && assignp->lhsp() == nodep && cloneOk(assignp->rhsp());
+            }
+            if (ok) {
+                ++infop->m_entryRefs;
+                infop->m_refps.push_back(nodep);
+            } else {
+                infop->m_ok = false;
+            }
+            iterate(nodep->bitp());
+            return;
+        }
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit SplitFieldsVarVisitor(AstNetlist* nodep)
+        : m_netp(nodep)
+        , m_modp(NULL)
+        , m_ftaskp(NULL)
+        , m_inSenItem(false) {
+        iterate(nodep);
+        // Split after visiting all modules, as hierarchical references
+        // from later modules prevent the split
+        for (std::vector<AstVar*>::const_iterator it = m_varps.begin(); it != m_varps.end();
+             ++it) {
+            const VarInfo& info = m_vars[*it];
+            if (info.m_declared && info.m_ok && !(*it)->user1()
+                && info.m_fieldRefs > info.m_entryRefs) {
+                split(*it, info);
+            }
+        }
+    }
+    virtual ~SplitFieldsVarVisitor() {
+        V3Stats::addStat("SplitVar, Split struct arrays into fields", m_statSplit);
+    }
+    VL_DEBUG_FUNC;  // Declare debug()
+};
+
 //######################################################################
 // Split class functions
 
 void V3SplitVar::splitVariable(AstNetlist* nodep) {
     UINFO(2, __FUNCTION__ << ": " << endl);
+    if (v3Global.opt.splitVarAuto()) { SplitAutoVarVisitor visitor(nodep); }
+    if (v3Global.opt.splitVarFields()) { SplitFieldsVarVisitor visitor(nodep); }
     SplitVarRefsMap refs;
     {
         SplitUnpackedVarVisitor visitor(nodep);
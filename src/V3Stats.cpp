@@ -25,9 +25,11 @@
 // This visitor does not edit nodes, and is called at error-exit, so should use constant iterators
 #include "V3AstConstOnly.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <iomanip>
 #include <map>
+#include <vector>
 
 //######################################################################
 // Stats class functions
@@ -287,7 +289,241 @@ void V3Stats::statsStageAll(AstNetlist* nodep, const string& stage, bool fast) {
     StatsVisitor visitor(nodep, stage, fast);
 }
 
+//######################################################################
+// Model memory footprint, per category, module and scope
+
+V3Stats::MemCategory V3Stats::memCategory(const AstVar* varp) {
+    const bool member = (varp->isIO() || varp->isSignal() || varp->isClassMember()
+                         || varp->isTemp()
+                         || (varp->isParam() && !VN_IS(varp->valuep(), Const)));
+    if (!member || varp->isStatic()) return MEM__MAX;
+    const string& name = varp->name();
+    if (name.compare(0, 6, "__Vdly") == 0) return MEM_DELAYED;
+    if (name.compare(0, 12, "__Vchglast__") == 0 || name.compare(0, 12, "__Vclklast__") == 0) {
+        return MEM_CHANGE_DETECT;
+    }
+    const AstNodeDType* dtypep = varp->dtypeSkipRefp();
+    if (VN_IS(dtypep, UnpackArrayDType) || VN_IS(dtypep, AssocArrayDType)
+        || VN_IS(dtypep, DynArrayDType) || VN_IS(dtypep, QueueDType)) {
+        return MEM_MEMORIES;
+    }
+    if (varp->isTemp() || name.compare(0, 3, "__V") == 0) return MEM_TEMPS;
+    return MEM_DESIGN;
+}
+
+const char* V3Stats::memCategoryEnum(MemCategory cat) {
+    static const char* const names[] = {"DESIGN", "MEMORIES", "DELAYED", "CHANGE_DETECT",
+                                        "TEMPS",  "COVERAGE", "TRACE",   "OTHER"};
+    return names[cat];
+}
+
+const char* V3Stats::memCategoryName(MemCategory cat) {
+    static const char* const names[]
+        = {"design state", "memories",  "delayed assignments", "change detection",
+           "temporaries",  "coverage",  "trace",               "other"};
+    return names[cat];
+}
+
+class StatsMemoryVisitor : public AstNVisitor {
+    // TYPES
+    struct ModInfo {
+        const AstNodeModule* m_modp;
+        double m_bytes[V3Stats::MEM__MAX];  // Bytes per instance
+        double m_total;  // Bytes per instance, all categories
+        int m_instances;
+        ModInfo()
+            : m_modp(NULL)
+            , m_total(0)
+            , m_instances(0) {
+            for (int i = 0; i < V3Stats::MEM__MAX; ++i) m_bytes[i] = 0;
+        }
+    };
+    struct ScopeInfo {
+        string m_name;
+        const AstNodeModule* m_modp;
+        double m_own;  // Bytes of this scope
+        double m_subtree;  // Bytes of this scope and those below
+    };
+    typedef std::map<const AstNodeModule*, ModInfo> ModMap;
+    static bool modMore(const ModInfo* ap, const ModInfo* bp) {
+        const double atotal = ap->m_total * ap->m_instances;
+        const double btotal = bp->m_total * bp->m_instances;
+        if (atotal != btotal) return atotal > btotal;
+        return ap->m_modp->prettyName() < bp->m_modp->prettyName();
+    }
+    static bool scopeMore(const ScopeInfo& a, const ScopeInfo& b) {
+        if (a.m_subtree != b.m_subtree) return a.m_subtree > b.m_subtree;
+        return a.m_name < b.m_name;
+    }
+
+    // STATE
+    ModMap m_mods;  // Member storage of each module
+    std::vector<ScopeInfo> m_scopes;  // Every scope
+    double m_totals[V3Stats::MEM__MAX];  // Bytes of the model by category
+    int m_coverBins;  // Coverage counters
+    uint32_t m_traceCodes;  // Trace codes, each with a previous value word
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
+        if (VN_IS(nodep, Class)) return;  // Objects are allocated by the design
+        ModInfo& info = m_mods[nodep];
+        info.m_modp = nodep;
+        for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            const AstVar* varp = VN_CAST(stmtp, Var);
+            if (!varp) continue;
+            const V3Stats::MemCategory cat = V3Stats::memCategory(varp);
+            if (cat == V3Stats::MEM__MAX) continue;
+            const double bytes = varp->dtypeSkipRefp()->widthTotalBytes();
+            info.m_bytes[cat] += bytes;
+            info.m_total += bytes;
+        }
+        iterateChildrenConst(nodep);
+    }
+    virtual void visit(AstScope* nodep) VL_OVERRIDE {
+        ScopeInfo info;
+        info.m_name = nodep->prettyName();
+        info.m_modp = nodep->modp();
+        info.m_own = 0;
+        info.m_subtree = 0;
+        m_scopes.push_back(info);
+        iterateChildrenConst(nodep);
+    }
+    virtual void visit(AstCoverDecl* nodep) VL_OVERRIDE {
+        m_coverBins = std::max(m_coverBins, nodep->binNum() + 1);
+    }
+    virtual void visit(AstTraceDecl* nodep) VL_OVERRIDE {
+        m_traceCodes = std::max(m_traceCodes, nodep->code() + nodep->codeInc());
+    }
+    virtual void visit(AstNodeMath*) VL_OVERRIDE {}  // Accelerate
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildrenConst(nodep); }
+
+    // METHODS
+    void tally() {
+        for (std::vector<ScopeInfo>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
+            ModMap::iterator mit = m_mods.find(it->m_modp);
+            if (mit == m_mods.end()) continue;
+            ++mit->second.m_instances;
+            it->m_own = mit->second.m_total;
+            for (int i = 0; i < V3Stats::MEM__MAX; ++i) m_totals[i] += mit->second.m_bytes[i];
+        }
+        // Each scope's bytes are also under every scope above it
+        std::map<string, ScopeInfo*> byName;
+        for (std::vector<ScopeInfo>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
+            byName[it->m_name] = &(*it);
+        }
+        for (std::vector<ScopeInfo>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
+            string name = it->m_name;
+            while (true) {
+                std::map<string, ScopeInfo*>::iterator nit = byName.find(name);
+                if (nit != byName.end()) nit->second->m_subtree += it->m_own;
+                const string::size_type pos = name.rfind('.');
+                if (pos == string::npos) break;
+                name.erase(pos);
+            }
+        }
+        int threads = 1;
+        if (v3Global.opt.threads() && v3Global.opt.coveragePerThread()) {
+            threads = v3Global.opt.threads();
+        }
+        m_totals[V3Stats::MEM_COVERAGE] = static_cast<double>(m_coverBins) * 4 * threads;
+        m_totals[V3Stats::MEM_TRACE] = static_cast<double>(m_traceCodes) * 4;
+    }
+    void report(std::ostream& os) {
+        os << "Verilator Memory Footprint Report\n";
+        os << endl;
+        os << "Information:" << endl;
+        os << "  " << V3Options::version() << endl;
+        os << "  Arguments: " << v3Global.opt.allArgsString() << endl;
+        os << "  Bytes are of fixed storage, excluding padding, and the contents of strings,"
+           << endl;
+        os << "  queues and associative arrays.  memoryUsage() of the generated model gives"
+           << endl;
+        os << "  the measured sizes while running." << endl;
+        os << endl;
+
+        os << "Totals, bytes:" << endl;
+        double total = 0;
+        for (int i = 0; i < V3Stats::MEM_OTHER; ++i) {
+            const V3Stats::MemCategory cat = static_cast<V3Stats::MemCategory>(i);
+            os << "  " << std::left << std::setw(24) << V3Stats::memCategoryName(cat)
+               << std::right << std::setw(16) << std::fixed << std::setprecision(0)
+               << m_totals[i] << endl;
+            total += m_totals[i];
+        }
+        os << "  " << std::left << std::setw(24) << "total" << std::right << std::setw(16)
+           << total << endl;
+        os << endl;
+
+        os << "Modules, by bytes of all instances:" << endl;
+        os << "  " << std::setw(10) << "instances" << std::setw(14) << "design"
+           << std::setw(14) << "memories" << std::setw(14) << "delayed" << std::setw(14)
+           << "change" << std::setw(14) << "temps" << std::setw(14) << "per_inst"
+           << std::setw(16) << "total"
+           << "  module" << endl;
+        std::vector<const ModInfo*> mods;
+        for (ModMap::const_iterator it = m_mods.begin(); it != m_mods.end(); ++it) {
+            if (it->second.m_instances) mods.push_back(&it->second);
+        }
+        std::stable_sort(mods.begin(), mods.end(), modMore);
+        for (std::vector<const ModInfo*>::const_iterator it = mods.begin(); it != mods.end();
+             ++it) {
+            const ModInfo* infop = *it;
+            os << "  " << std::setw(10) << infop->m_instances;
+            for (int i = 0; i <= V3Stats::MEM_TEMPS; ++i) {
+                os << std::setw(14) << infop->m_bytes[i];
+            }
+            os << std::setw(14) << infop->m_total << std::setw(16)
+               << infop->m_total * infop->m_instances << "  "
+               << infop->m_modp->prettyName() << endl;
+        }
+        os << endl;
+
+        os << "Scopes, by bytes of the scope and those below (top 50):" << endl;
+        os << "  " << std::setw(16) << "subtree" << std::setw(14) << "own"
+           << "  scope (module)" << endl;
+        std::vector<ScopeInfo> scopes = m_scopes;
+        std::stable_sort(scopes.begin(), scopes.end(), scopeMore);
+        int ct = 0;
+        for (std::vector<ScopeInfo>::const_iterator it = scopes.begin(); it != scopes.end();
+             ++it) {
+            if (++ct > 50) break;
+            os << "  " << std::setw(16) << it->m_subtree << std::setw(14) << it->m_own << "  "
+               << it->m_name << " (" << it->m_modp->prettyName() << ")" << endl;
+        }
+    }
+
+public:
+    // CONSTRUCTORS
+    explicit StatsMemoryVisitor(AstNetlist* nodep)
+        : m_coverBins(0)
+        , m_traceCodes(0) {
+        for (int i = 0; i < V3Stats::MEM__MAX; ++i) m_totals[i] = 0;
+        iterate(nodep);
+        tally();
+        for (int i = 0; i < V3Stats::MEM_OTHER; ++i) {
+            const V3Stats::MemCategory cat = static_cast<V3Stats::MemCategory>(i);
+            V3Stats::addStat(string("Model memory, ") + V3Stats::memCategoryName(cat)
+                                 + ", bytes",
+                             m_totals[i]);
+        }
+        const string filename
+            = v3Global.opt.makeDir() + "/" + v3Global.opt.prefix() + "__stats_memory.txt";
+        std::ofstream* ofp(V3File::new_ofstream(filename));
+        if (ofp->fail()) v3fatal("Can't write " << filename);
+        report(*ofp);
+        ofp->close();
+        VL_DO_DANGLING(delete ofp, ofp);
+    }
+    virtual ~StatsMemoryVisitor() {}
+};
+
+void V3Stats::statsMemoryReport(AstNetlist* nodep) {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    StatsMemoryVisitor visitor(nodep);
+}
+
 void V3Stats::statsFinalAll(AstNetlist* nodep) {
     statsStageAll(nodep, "Final");
     statsStageAll(nodep, "Final_Fast", true);
+    V3Stats::addStat("Interned name strings", VStringIntern::internedCount());
 }
@@ -23,6 +23,7 @@
 #include "V3Error.h"
 
 class AstNetlist;
+class AstVar;
 
 //============================================================================
 
@@ -103,6 +104,25 @@ public:
 
 class V3Stats {
 public:
+    /// Memory categories of model members, as in VerilatedMemoryUsage::Category
+    enum MemCategory {
+        MEM_DESIGN,
+        MEM_MEMORIES,
+        MEM_DELAYED,
+        MEM_CHANGE_DETECT,
+        MEM_TEMPS,
+        MEM_COVERAGE,
+        MEM_TRACE,
+        MEM_OTHER,
+        MEM__MAX
+    };
+    /// Category of the storage of a variable in each instance of its
+    /// module's class, or MEM__MAX if it has none
+    static MemCategory memCategory(const AstVar* varp);
+    /// Name of a category's VerilatedMemoryUsage::Category enum
+    static const char* memCategoryEnum(MemCategory cat);
+    /// Name of a category, for reports
+    static const char* memCategoryName(MemCategory cat);
     static void addStat(const V3Statistic&);
     static void addStat(const string& stage, const string& name, double count) {
         addStat(V3Statistic(stage, name, count));
@@ -118,11 +138,17 @@ public:
     }
     /// Called each stage
     static void statsStage(const string& name);
+    /// Called after each pass to record its time and memory for --stats-json
+    static void statsPassBegin();
+    static void statsPass(const string& name);
+    static void statsPassReport();
     /// Called by the top level to collect statistics
     static void statsStageAll(AstNetlist* nodep, const string& stage, bool fast = false);
     static void statsFinalAll(AstNetlist* nodep);
     /// Called by the top level to dump the statistics
     static void statsReport();
+    /// Called by the top level to write the model memory footprint report
+    static void statsMemoryReport(AstNetlist* nodep);
 };
 
 #endif  // Guard
@@ -242,3 +242,111 @@ void V3Stats::statsReport() {
     ofp->close();
     VL_DO_DANGLING(delete ofp, ofp);
 }
+
+//######################################################################
+// Per-pass time and memory, for --stats-json
+
+class StatsPassCountVisitor : public AstNVisitor {
+    // STATE
+    vluint64_t m_count;  // Nodes seen
+    // VISITORS
+    virtual void visit(AstNode* nodep) VL_OVERRIDE {
+        ++m_count;
+        iterateChildrenConst(nodep);
+    }
+
+public:
+    // CONSTRUCTORS
+    explicit StatsPassCountVisitor(AstNetlist* nodep)
+        : m_count(0) {
+        if (nodep) iterate(nodep);
+    }
+    virtual ~StatsPassCountVisitor() {}
+    vluint64_t count() const { return m_count; }
+};
+
+class StatsPasses {
+public:
+    // TYPES
+    struct Sample {
+        uint64_t m_wallUsecs;
+        uint64_t m_cpuUsecs;
+        uint64_t m_memBytes;
+        vluint64_t m_nodes;
+        Sample()
+            : m_wallUsecs(0)
+            , m_cpuUsecs(0)
+            , m_memBytes(0)
+            , m_nodes(0) {}
+        static Sample now() {
+            Sample sample;
+            sample.m_wallUsecs = V3Os::timeUsecs();
+            sample.m_cpuUsecs = V3Os::cpuUsecs();
+            sample.m_memBytes = V3Os::memUsageBytes();
+            sample.m_nodes = StatsPassCountVisitor(v3Global.rootp()).count();
+            return sample;
+        }
+    };
+    struct Pass {
+        string m_name;
+        Sample m_begin;
+        Sample m_end;
+    };
+    typedef std::vector<Pass> PassList;
+    // STATE
+    static PassList s_passes;  // Passes recorded so far
+    static Sample s_last;  // Sample at end of the last pass
+};
+
+StatsPasses::PassList StatsPasses::s_passes;
+StatsPasses::Sample StatsPasses::s_last;
+
+void V3Stats::statsPassBegin() { StatsPasses::s_last = StatsPasses::Sample::now(); }
+
+void V3Stats::statsPass(const string& name) {
+    StatsPasses::Pass pass;
+    pass.m_name = name;
+    pass.m_begin = StatsPasses::s_last;
+    StatsPasses::s_passes.push_back(pass);
+    // Time spent counting nodes here is charged to the following pass
+    StatsPasses::s_passes.back().m_end = StatsPasses::s_last = StatsPasses::Sample::now();
+}
+
+void V3Stats::statsPassReport() {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    const string filename = v3Global.opt.statsJson();
+    std::ofstream* ofp(V3File::new_ofstream(filename));
+    if (ofp->fail()) v3fatal("Can't write " << filename);
+    std::ofstream& os = *ofp;
+
+    uint64_t memPeak = 0;
+    os << "{\n";
+    os << "  \"version\": " << VString::quoteJson(V3Options::version()) << ",\n";
+    os << "  \"passes\": [";
+    int index = 0;
+    for (StatsPasses::PassList::const_iterator it = StatsPasses::s_passes.begin();
+         it != StatsPasses::s_passes.end(); ++it) {
+        const StatsPasses::Sample& begin = it->m_begin;
+        const StatsPasses::Sample& end = it->m_end;
+        if (end.m_memBytes > memPeak) memPeak = end.m_memBytes;
+        os << (index ? ",\n" : "\n");
+        os << "    {\"index\": " << ++index;
+        os << ", \"name\": " << VString::quoteJson(it->m_name);
+        os << ", \"wall_us\": " << (end.m_wallUsecs - begin.m_wallUsecs);
+        os << ", \"cpu_us\": " << (end.m_cpuUsecs - begin.m_cpuUsecs);
+        os << ", \"mem_bytes\": " << end.m_memBytes;
+        os << ", \"mem_delta_bytes\": "
+           << (static_cast<vlsint64_t>(end.m_memBytes)
+               - static_cast<vlsint64_t>(begin.m_memBytes));
+        os << ", \"nodes\": " << end.m_nodes;
+        os << ", \"nodes_delta\": "
+           << (static_cast<vlsint64_t>(end.m_nodes) - static_cast<vlsint64_t>(begin.m_nodes));
+        os << "}";
+    }
+    os << "\n  ],\n";
+    os << "  \"mem_peak_bytes\": " << memPeak << "\n";
+    os << "}\n";
+
+    ofp->close();
+    VL_DO_DANGLING(delete ofp, ofp);
+}
@@ -22,6 +22,7 @@
 #include "V3Error.h"
 
 #include <algorithm>
+#include VL_INCLUDE_UNORDERED_SET
 
 size_t VName::s_minLength = 32;
 size_t VName::s_maxLength = 0;  // Disabled
@@ -97,6 +98,23 @@ string VString::quotePercent(const string& str) {
     return out;
 }
 
+string VString::quoteJson(const string& str) {
+    string out = "\"";
+    for (string::const_iterator pos = str.begin(); pos != str.end(); ++pos) {
+        if (*pos == '"' || *pos == '\\') {
+            out += '\\';
+            out += *pos;
+        } else if (static_cast<unsigned char>(*pos) < 0x20) {
+            char hex[10];
+            sprintf(hex, "\\u%04x", static_cast<unsigned char>(*pos));
+            out += hex;
+        } else {
+            out += *pos;
+        }
+    }
+    return out + "\"";
+}
+
 string VString::spaceUnprintable(const string& str) {
     string out;
     for (string::const_iterator pos = str.begin(); pos != str.end(); ++pos) {
@@ -344,6 +362,27 @@ void VHashSha256::selfTest() {
                 "ncNWdKAkso6EQAgLUzFlLphfLWHXofyoCmSLf5B6");
 }
 
+//######################################################################
+// VStringIntern
+
+// Set elements are never erased, so pointers to them remain valid
+typedef vl_unordered_set<string> VStringInternSet;
+static VStringInternSet& stringInternSet() {
+    static VStringInternSet s_set;
+    return s_set;
+}
+
+const string* VStringIntern::intern(const string& str) {
+    return &*stringInternSet().insert(str).first;
+}
+
+const string* VStringIntern::emptyp() {
+    static const string* s_emptyp = intern("");
+    return s_emptyp;
+}
+
+size_t VStringIntern::internedCount() { return stringInternSet().size(); }
+
 //######################################################################
 // VName
 
@@ -84,6 +84,8 @@ public:
     static string upcase(const string& str);
     // Replace any %'s with %%
     static string quotePercent(const string& str);
+    // Return str as a double quoted JSON string
+    static string quoteJson(const string& str);
     // Replace any unprintable with space
     // This includes removing tabs, so column tracking is correct
     static string spaceUnprintable(const string& str);
@@ -176,6 +178,46 @@ public:
     static size_t maxLength() { return s_maxLength; }
 };
 
+//######################################################################
+// VStringIntern - handle to a string shared by every equal string
+// Copying is a pointer copy, and handles compare equal by pointer only.
+// Interned strings are never freed.  Not thread safe; create on the main thread.
+
+class VStringIntern {
+    const string* m_strp;  // Interned string
+    static const string* intern(const string& str);
+    static const string* emptyp();
+
+public:
+    // CONSTRUCTORS
+    VStringIntern()
+        : m_strp(emptyp()) {}
+    VStringIntern(const string& str)  // Implicit, so may assign strings
+        : m_strp(intern(str)) {}
+    VStringIntern(const char* strp)
+        : m_strp(intern(strp)) {}
+    ~VStringIntern() {}
+    // METHODS
+    const string& str() const { return *m_strp; }
+    operator const string&() const { return *m_strp; }
+    bool empty() const { return m_strp->empty(); }
+    size_t length() const { return m_strp->length(); }
+    bool operator==(const VStringIntern& rhs) const { return m_strp == rhs.m_strp; }
+    bool operator!=(const VStringIntern& rhs) const { return m_strp != rhs.m_strp; }
+    bool operator==(const string& rhs) const { return *m_strp == rhs; }
+    bool operator!=(const string& rhs) const { return *m_strp != rhs; }
+    bool operator==(const char* rhsp) const { return *m_strp == rhsp; }
+    bool operator!=(const char* rhsp) const { return *m_strp != rhsp; }
+    static size_t internedCount();  // Number of distinct strings
+};
+inline string operator+(const VStringIntern& lhs, const string& rhs) { return lhs.str() + rhs; }
+inline string operator+(const string& lhs, const VStringIntern& rhs) { return lhs + rhs.str(); }
+inline string operator+(const VStringIntern& lhs, const char* rhsp) { return lhs.str() + rhsp; }
+inline string operator+(const char* lhsp, const VStringIntern& rhs) { return lhsp + rhs.str(); }
+inline std::ostream& operator<<(std::ostream& os, const VStringIntern& rhs) {
+    return os << rhs.str();
+}
+
 //######################################################################
 // VSpellCheck - Find near-match spelling suggestions given list of possibilities
 
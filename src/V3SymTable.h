@@ -29,6 +29,7 @@
 #include <map>
 #include <iomanip>
 #include <memory>
+#include VL_INCLUDE_UNORDERED_MAP
 
 class VSymGraph;
 class VSymEnt;
@@ -43,7 +44,13 @@ class VSymEnt {
     // Symbol table that can have a "superior" table for resolving upper references
     // MEMBERS
     typedef std::multimap<string, VSymEnt*> IdNameMap;
-    IdNameMap m_idNameMap;  // Hash of variables by name
+    typedef vl_unordered_map<string, VSymEnt*> IdHashMap;
+    IdNameMap m_idNameMap;  // Variables by name, sorted for stable iteration
+    IdHashMap m_idHashMap;  // Same as m_idNameMap, hashed for fast lookup
+    // Cache of findIdFallback results found above this table; valid while
+    // m_fallbackGen equals generation(), which any insert or relink changes
+    mutable IdHashMap m_fallbackCache;
+    mutable vluint64_t m_fallbackGen;
     AstNode* m_nodep;  // Node that entry belongs to
     VSymEnt* m_fallbackp;  // Table "above" this one in name scope, for fallback resolution
     VSymEnt* m_parentp;  // Table that created this table, dot notation needed to resolve into it
@@ -60,6 +67,11 @@ class VSymEnt {
 #else
     static inline int debug() { return 0; }  // NOT runtime, too hot of a function
 #endif
+    static vluint64_t& generation() {
+        static vluint64_t s_generation = 1;
+        return s_generation;
+    }
+
 public:
     typedef IdNameMap::const_iterator const_iterator;
     const_iterator begin() const { return m_idNameMap.begin(); }
@@ -108,7 +120,10 @@ public:
     // For testing, leak so above destructor 1 assignments work
     void operator delete(void* objp, size_t size) {}
 #endif
-    void fallbackp(VSymEnt* entp) { m_fallbackp = entp; }
+    void fallbackp(VSymEnt* entp) {
+        m_fallbackp = entp;
+        ++generation();
+    }
     void parentp(VSymEnt* entp) { m_parentp = entp; }
     VSymEnt* parentp() const { return m_parentp; }
     void packagep(AstNodeModule* entp) { m_packagep = entp; }
@@ -123,7 +138,7 @@ public:
     void insert(const string& name, VSymEnt* entp) {
         UINFO(9, "     SymInsert se" << cvtToHex(this) << " '" << name << "' se" << cvtToHex(entp)
                                      << "  " << entp->nodep() << endl);
-        if (name != "" && m_idNameMap.find(name) != m_idNameMap.end()) {
+        if (name != "" && m_idHashMap.find(name) != m_idHashMap.end()) {
             if (!V3Error::errorCount()) {  // Else may have just reported warning
                 if (debug() >= 9 || V3Error::debugDefault()) dump(cout, "- err-dump: ", 1);
                 entp->nodep()->v3fatalSrc("Inserting two symbols with same name: " << name
@@ -131,14 +146,18 @@ public:
             }
         } else {
             m_idNameMap.insert(make_pair(name, entp));
+            m_idHashMap.insert(make_pair(name, entp));
+            ++generation();
         }
     }
     void reinsert(const string& name, VSymEnt* entp) {
-        IdNameMap::iterator it = m_idNameMap.find(name);
-        if (name != "" && it != m_idNameMap.end()) {
+        IdHashMap::iterator it = m_idHashMap.find(name);
+        if (name != "" && it != m_idHashMap.end()) {
             UINFO(9, "     SymReinsert se" << cvtToHex(this) << " '" << name << "' se"
                                            << cvtToHex(entp) << "  " << entp->nodep() << endl);
             it->second = entp;  // Replace
+            m_idNameMap.find(name)->second = entp;
+            ++generation();
         } else {
             insert(name, entp);
         }
@@ -146,14 +165,14 @@ public:
     VSymEnt* findIdFlat(const string& name) const {
         // Find identifier without looking upward through symbol hierarchy
         // First, scan this begin/end block or module for the name
-        IdNameMap::const_iterator it = m_idNameMap.find(name);
+        IdHashMap::const_iterator it = m_idHashMap.find(name);
         UINFO(9, "     SymFind   se"
                      << cvtToHex(this) << " '" << name << "' -> "
-                     << (it == m_idNameMap.end()
+                     << (it == m_idHashMap.end()
                              ? "NONE"
                              : "se" + cvtToHex(it->second) + " n=" + cvtToHex(it->second->nodep()))
                      << endl);
-        if (it != m_idNameMap.end()) return (it->second);
+        if (it != m_idHashMap.end()) return (it->second);
         return NULL;
     }
     VSymEnt* findIdFallback(const string& name) const {
@@ -161,8 +180,16 @@ public:
         // First, scan this begin/end block or module for the name
         if (VSymEnt* entp = findIdFlat(name)) return entp;
         // Then scan the upper begin/end block or module for the name
-        if (m_fallbackp) return m_fallbackp->findIdFallback(name);
-        return NULL;
+        if (!m_fallbackp) return NULL;
+        if (m_fallbackGen != generation()) {
+            m_fallbackCache.clear();
+            m_fallbackGen = generation();
+        }
+        IdHashMap::const_iterator it = m_fallbackCache.find(name);
+        if (it != m_fallbackCache.end()) return it->second;
+        VSymEnt* entp = m_fallbackp->findIdFallback(name);
+        m_fallbackCache.insert(make_pair(name, entp));
+        return entp;
     }
     void candidateIdFlat(VSpellCheck* spellerp, const VNodeMatcher* matcherp) const {
         // Suggest alternative symbol candidates without looking upward through symbol hierarchy
@@ -202,8 +229,8 @@ public:
     void importFromPackage(VSymGraph* graphp, const VSymEnt* srcp, const string& id_or_star) {
         // Import tokens from source symbol table into this symbol table
         if (id_or_star != "*") {
-            IdNameMap::const_iterator it = srcp->m_idNameMap.find(id_or_star);
-            if (it != srcp->m_idNameMap.end()) importOneSymbol(graphp, it->first, it->second);
+            IdHashMap::const_iterator it = srcp->m_idHashMap.find(id_or_star);
+            if (it != srcp->m_idHashMap.end()) importOneSymbol(graphp, it->first, it->second);
         } else {
             for (IdNameMap::const_iterator it = srcp->m_idNameMap.begin();
                  it != srcp->m_idNameMap.end(); ++it) {
@@ -214,8 +241,8 @@ public:
     void exportFromPackage(VSymGraph* graphp, const VSymEnt* srcp, const string& id_or_star) {
         // Export tokens from source symbol table into this symbol table
         if (id_or_star != "*") {
-            IdNameMap::const_iterator it = srcp->m_idNameMap.find(id_or_star);
-            if (it != srcp->m_idNameMap.end()) exportOneSymbol(graphp, it->first, it->second);
+            IdHashMap::const_iterator it = srcp->m_idHashMap.find(id_or_star);
+            if (it != srcp->m_idHashMap.end()) exportOneSymbol(graphp, it->first, it->second);
         } else {
             for (IdNameMap::const_iterator it = srcp->m_idNameMap.begin();
                  it != srcp->m_idNameMap.end(); ++it) {
@@ -330,6 +357,7 @@ inline VSymEnt::VSymEnt(VSymGraph* graphp, AstNode* nodep)
     m_packagep = NULL;
     m_exported = true;
     m_imported = false;
+    m_fallbackGen = 0;
     graphp->pushNewEnt(this);
 }
 
@@ -340,6 +368,7 @@ inline VSymEnt::VSymEnt(VSymGraph* graphp, const VSymEnt* symp)
     m_packagep = symp->m_packagep;
     m_exported = symp->m_exported;
     m_imported = symp->m_imported;
+    m_fallbackGen = 0;
     graphp->pushNewEnt(this);
 }
 
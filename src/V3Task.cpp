@@ -20,6 +20,8 @@
 //          Insert task's statements into the referrer
 //      Look for TASKs
 //          Remove them, they're inlined
+//      Look for calls to non-inlined functions with constant arguments
+//          Call a copy of the function with those arguments replaced by constants
 //
 //*************************************************************************
 
@@ -34,9 +36,13 @@
 #include "V3EmitCBase.h"
 #include "V3Graph.h"
 #include "V3LinkLValue.h"
+#include "V3Stats.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <map>
+#include <set>
+#include <vector>
 
 //######################################################################
 // Graph subclasses
@@ -111,13 +117,16 @@ private:
     // TYPES
     typedef std::map<std::pair<AstScope*, AstVar*>, AstVarScope*> VarToScopeMap;
     typedef std::vector<AstInitial*> Initials;
+    typedef std::map<string, int> DpiExportCounts;
     // MEMBERS
     VarToScopeMap m_varToScopeMap;  // Map for Var -> VarScope mappings
+    DpiExportCounts m_dpiExportCounts;  // Number of scopes with each DPI export C name
     AstAssignW* m_assignwp;  // Current assignment
     AstNodeFTask* m_ctorp;  // Class constructor
     V3Graph m_callGraph;  // Task call graph
     TaskBaseVertex* m_curVxp;  // Current vertex we're adding to
     Initials m_initialps;  // Initial blocks to move
+    std::set<AstCFunc*> m_specializableps;  // Non-inlined functions that may be specialized
 
 public:
     // METHODS
@@ -132,10 +141,16 @@ public:
         return iter->second;
     }
     bool ftaskNoInline(AstNodeFTask* nodep) { return getFTaskVertex(nodep)->noInline(); }
+    int dpiExportScopes(const string& cname) const {
+        DpiExportCounts::const_iterator it = m_dpiExportCounts.find(cname);
+        return it == m_dpiExportCounts.end() ? 0 : it->second;
+    }
     AstCFunc* ftaskCFuncp(AstNodeFTask* nodep) { return getFTaskVertex(nodep)->cFuncp(); }
     void ftaskCFuncp(AstNodeFTask* nodep, AstCFunc* cfuncp) {
         getFTaskVertex(nodep)->cFuncp(cfuncp);
     }
+    void specializable(AstCFunc* cfuncp) { m_specializableps.insert(cfuncp); }
+    const std::set<AstCFunc*>& specializables() const { return m_specializableps; }
     void checkPurity(AstNodeFTask* nodep) { checkPurity(nodep, getFTaskVertex(nodep)); }
     void checkPurity(AstNodeFTask* nodep, TaskBaseVertex* vxp) {
         if (!vxp->pure()) {
@@ -177,7 +192,10 @@ private:
         }
         // Likewise, all FTask->scope mappings
         for (AstNode* stmtp = nodep->blocksp(); stmtp; stmtp = stmtp->nextp()) {
-            if (AstNodeFTask* taskp = VN_CAST(stmtp, NodeFTask)) { taskp->user3p(nodep); }
+            if (AstNodeFTask* taskp = VN_CAST(stmtp, NodeFTask)) {
+                taskp->user3p(nodep);
+                if (taskp->dpiExport()) ++m_dpiExportCounts[taskp->cname()];
+            }
         }
         iterateChildren(nodep);
     }
@@ -346,6 +364,7 @@ private:
     AstNode* m_insStmtp;  // Where to insert statement
     int m_modNCalls;  // Incrementing func # for making symbols
     DpiNames m_dpiNames;  // Map of all created DPI functions
+    std::set<string> m_dpiAsyncNames;  // DPI import C names with async call thunks
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -697,20 +716,35 @@ private:
             // but the compare is only done on first call then memoized, so
             // it's not worth optimizing.
             string stmt;
+            string cbtype
+                = VIdProtect::protect(v3Global.opt.prefix() + "__Vcb_" + nodep->cname() + "_t");
+            stmt += "const VerilatedScope* __Vscopep = Verilated::dpiScope();\n";
+            // If the export exists in only one scope of this model, the callee is known at
+            // Verilation time.  Calls on that scope go to it directly, others (including a
+            // null scope) fall back to the table lookup, which reports any error.
+            bool direct = m_statep->dpiExportScopes(nodep->cname()) == 1;
+            if (direct) {
+                AstScopeName* snp = nodep->scopeNamep();
+                UASSERT_OBJ(snp, nodep, "Missing scoping context");
+                stmt += cbtype + " __Vcb = &"
+                        + EmitCBaseVisitor::prefixNameProtect(m_scopep->modp())
+                        + "::" + VIdProtect::protect(userFuncName(nodep, false)) + ";\n";
+                stmt += "if (VL_UNLIKELY(!__Vscopep || __Vscopep != &(("
+                        + EmitCBaseVisitor::symClassName() + "*)(__Vscopep->symsp()))->"
+                        + VIdProtect::protect("__Vscope_" + snp->scopeSymName()) + ")) {\n";
+            }
             // Static doesn't need save-restore as if below will re-fill proper value
             stmt += "static int __Vfuncnum = -1;\n";
             // First time init (faster than what the compiler does if we did a singleton
             stmt += "if (VL_UNLIKELY(__Vfuncnum==-1)) { __Vfuncnum = Verilated::exportFuncNum(\""
                     + nodep->cname() + "\"); }\n";
             // If the find fails, it will throw an error
-            stmt += "const VerilatedScope* __Vscopep = Verilated::dpiScope();\n";
             // If dpiScope is fails and is null; the exportFind function throws and error
-            string cbtype
-                = VIdProtect::protect(v3Global.opt.prefix() + "__Vcb_" + nodep->cname() + "_t");
-            stmt += cbtype + " __Vcb = (" + cbtype
+            stmt += (direct ? "__Vcb" : cbtype + " __Vcb") + " = (" + cbtype
                     + ")(VerilatedScope::exportFind(__Vscopep, __Vfuncnum));\n";  // Can't use
                                                                                   // static_cast
             // If __Vcb is null the exportFind function throws and error
+            if (direct) stmt += "}\n";
             dpip->addStmtsp(new AstCStmt(nodep->fileline(), stmt));
         }
 
@@ -794,6 +828,84 @@ private:
         makePortList(nodep, dpip);
     }
 
+    static string dpiAsyncThunkName(AstNodeFTask* nodep) { return "__Vdpiasync_" + nodep->cname(); }
+
+    bool checkDpiAsync(AstNodeFTask* nodep, AstVar* rtnvarp) {
+        // Async calls are made later by another thread, so may only take
+        // inputs that fit in a queue word, and have nothing to return
+        if (rtnvarp) {
+            nodep->v3error("async DPI import must be a task or void function: "
+                           << nodep->prettyNameQ());
+            return false;
+        }
+        if (nodep->dpiContext()) {
+            nodep->v3error("async DPI import may not be 'context': " << nodep->prettyNameQ());
+            return false;
+        }
+        int nargs = 0;
+        for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            if (AstVar* portp = VN_CAST(stmtp, Var)) {
+                if (!portp->isIO()) continue;
+                ++nargs;
+                AstBasicDType* basicp = portp->basicp();
+                bool ok = portp->direction() == VDirection::INPUT && !portp->isDpiOpenArray()
+                          && basicp && basicp->keyword() != AstBasicDTypeKwd::STRING;
+                if (ok && basicp->isDpiBitVec()) ok = portp->width() <= 64;
+                if (ok && basicp->isDpiLogicVec()) ok = portp->width() <= 32;
+                if (!ok) {
+                    portp->v3error("async DPI import arguments must be inputs of a basic type"
+                                   " other than string, or bit vectors of up to 64 bits,"
+                                   " or logic vectors of up to 32 bits: "
+                                   << portp->prettyNameQ());
+                    return false;
+                }
+            }
+        }
+        if (nargs > VL_DPI_ASYNC_ARGS_MAX) {
+            nodep->v3error("async DPI import has more than " << VL_DPI_ASYNC_ARGS_MAX
+                                                             << " arguments: "
+                                                             << nodep->prettyNameQ());
+            return false;
+        }
+        return true;
+    }
+
+    void makeDpiAsyncThunk(AstNodeFTask* nodep) {
+        // Function the VerilatedDpiAsync consumer calls with the queued arguments
+        if (m_dpiAsyncNames.find(nodep->cname()) != m_dpiAsyncNames.end()) return;
+        m_dpiAsyncNames.insert(nodep->cname());
+        v3Global.dpiAsync(true);
+        AstCFunc* thunkp
+            = new AstCFunc(nodep->fileline(), dpiAsyncThunkName(nodep), m_topScopep->scopep());
+        thunkp->argTypes("const vluint64_t* __Vargsp");
+        thunkp->dontCombine(true);
+        thunkp->entryPoint(true);
+        thunkp->isStatic(true);
+        thunkp->protect(false);
+        string stmt;
+        string args;
+        int argn = 0;
+        for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            if (AstVar* portp = VN_CAST(stmtp, Var)) {
+                if (!portp->isIO()) continue;
+                string name = "__Va" + cvtToStr(argn);
+                stmt += portp->dpiArgType(false, true) + " " + name;
+                if (!portp->basicp()->isDpiPrimitive()) {
+                    stmt += "[" + cvtToStr(portp->widthWords()) + "]";
+                }
+                stmt += ";\n";
+                stmt += "VerilatedDpiAsync::unpack(__Vargsp[" + cvtToStr(argn) + "], " + name
+                        + ");\n";
+                if (args != "") args += ", ";
+                args += name;
+                ++argn;
+            }
+        }
+        stmt += nodep->cname() + "(" + args + ");\n";
+        thunkp->addStmtsp(new AstCStmt(nodep->fileline(), stmt));
+        m_topScopep->scopep()->addActivep(thunkp);
+    }
+
     void makeDpiImportProto(AstNodeFTask* nodep, AstVar* rtnvarp) {
         if (nodep->cname() != AstNode::prettyName(nodep->cname())) {
             nodep->v3error("DPI function has illegal characters in C identifier name: "
@@ -864,6 +976,7 @@ private:
     void bodyDpiImportFunc(AstNodeFTask* nodep, AstVarScope* rtnvscp, AstCFunc* cfuncp) {
         // Convert input/inout arguments to DPI types
         string args;
+        std::vector<string> asyncArgs;  // DPI temporaries, in argument order
         for (AstNode* stmtp = cfuncp->argsp(); stmtp; stmtp = stmtp->nextp()) {
             if (AstVar* portp = VN_CAST(stmtp, Var)) {
                 AstVarScope* portvscp
@@ -904,6 +1017,7 @@ private:
                         }
 
                         args += portp->name() + "__Vcvt";
+                        asyncArgs.push_back(portp->name() + "__Vcvt");
 
                         cfuncp->addStmtsp(createDpiTemp(portp, "__Vcvt"));
                         if (portp->isNonOutput()) {
@@ -915,6 +1029,23 @@ private:
             }
         }
 
+        if (nodep->dpiAsync()) {  // Queue the arguments for a consumer thread to make the call
+            string stmt;
+            string argsName = "__Vasyncargs";
+            stmt += "vluint64_t " + argsName + "[" + cvtToStr(std::max<size_t>(1, asyncArgs.size()))
+                    + "];\n";
+            for (size_t i = 0; i < asyncArgs.size(); ++i) {
+                stmt += argsName + "[" + cvtToStr(i) + "] = VerilatedDpiAsync::pack("
+                        + asyncArgs[i] + ");\n";
+            }
+            stmt += "VerilatedDpiAsync::push(&"
+                    + EmitCBaseVisitor::prefixNameProtect(m_topScopep->scopep()->modp())
+                    + "::" + dpiAsyncThunkName(nodep) + ", " + cvtToStr(asyncArgs.size()) + ", "
+                    + argsName + ");\n";
+            cfuncp->addStmtsp(new AstCStmt(nodep->fileline(), stmt));
+            return;
+        }
+
         // Store context, if needed
         if (nodep->dpiContext()) {
             string stmt = "Verilated::dpiContext(__Vscopep, __Vfilenamep, __Vlineno);\n";
@@ -947,6 +1078,22 @@ private:
         }
     }
 
+    string userFuncName(AstNodeFTask* nodep, bool ftaskNoInline) const {
+        string prefix;
+        if (nodep->dpiImport()) {
+            prefix = "__Vdpiimwrap_";
+        } else if (nodep->dpiExport()) {
+            prefix = "__Vdpiexp_";
+        } else if (ftaskNoInline) {
+            prefix = "__VnoInFunc_";
+        }
+        // Unless public, v3Descope will not uniquify function names even if duplicate per-scope,
+        // so make it unique now.
+        string suffix;  // So, make them unique
+        if (!nodep->taskPublic()) suffix = "_" + m_scopep->nameDotless();
+        return ((nodep->name() == "new") ? "new" : prefix + nodep->name() + suffix);
+    }
+
     AstCFunc* makeUserFunc(AstNodeFTask* nodep, bool ftaskNoInline) {
         // Given a already cloned node, make a public C function, or a non-inline C function
         // Probably some of this work should be done later, but...
@@ -997,6 +1144,13 @@ private:
             } else {  // Parent or not open child, make wrapper
                 string dpiproto = dpiprotoName(nodep, rtnvarp);
                 if (!duplicatedDpiProto(nodep, dpiproto)) makeDpiImportProto(nodep, rtnvarp);
+                if (nodep->dpiAsync()) {
+                    if (checkDpiAsync(nodep, rtnvarp)) {
+                        makeDpiAsyncThunk(nodep);
+                    } else {
+                        nodep->dpiAsync(false);
+                    }
+                }
                 if (nodep->dpiOpenParent()) {
                     // No need to make more than just the c prototype, children will
                     VL_DO_DANGLING(pushDeletep(nodep), nodep);
@@ -1016,19 +1170,7 @@ private:
             rtnvarp->user2p(rtnvscp);
         }
 
-        string prefix;
-        if (nodep->dpiImport()) {
-            prefix = "__Vdpiimwrap_";
-        } else if (nodep->dpiExport()) {
-            prefix = "__Vdpiexp_";
-        } else if (ftaskNoInline) {
-            prefix = "__VnoInFunc_";
-        }
-        // Unless public, v3Descope will not uniquify function names even if duplicate per-scope,
-        // so make it unique now.
-        string suffix;  // So, make them unique
-        if (!nodep->taskPublic()) suffix = "_" + m_scopep->nameDotless();
-        string name = ((nodep->name() == "new") ? "new" : prefix + nodep->name() + suffix);
+        string name = userFuncName(nodep, ftaskNoInline);
         AstCFunc* cfuncp = new AstCFunc(
             nodep->fileline(), name, m_scopep,
             ((nodep->taskPublic() && rtnvarp) ? rtnvarp->cPubArgType(true, true) : ""));
@@ -1039,6 +1181,9 @@ private:
         cfuncp->funcPublic(nodep->taskPublic());
         cfuncp->dpiExport(nodep->dpiExport());
         cfuncp->dpiImportWrapper(nodep->dpiImport());
+        // Async imports only queue their arguments, which is safe from any thread
+        cfuncp->dpiThreadsafe(nodep->dpiImport()
+                              && (nodep->dpiThreadsafe() || nodep->dpiAsync()));
         cfuncp->isStatic(!(nodep->dpiImport() || nodep->taskPublic() || nodep->classMethod()));
         cfuncp->pure(nodep->pure());
         cfuncp->isConstructor(nodep->name() == "new");
@@ -1289,6 +1434,9 @@ private:
                     if (nodep->dpiImport() || m_statep->ftaskNoInline(nodep)) {
                         m_statep->ftaskCFuncp(nodep, cfuncp);
                     }
+                    if (modes == 0 && m_statep->ftaskNoInline(nodep)) {
+                        m_statep->specializable(cfuncp);
+                    }
                     iterateIntoFTask(clonedFuncp);  // Do the clone too
                 }
             }
@@ -1368,6 +1516,177 @@ public:
     virtual ~TaskVisitor() {}
 };
 
+//######################################################################
+// Specialize non-inlined functions for constant arguments
+
+// Most specialized copies made of each function
+#define TASK_SPECIALIZE_MAX 4
+
+class TaskSpecializeVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    //  to TaskRelinkVisitor:
+    //    AstVar::user2p        // AstVarScope* to replace varref with
+    AstUser2InUse m_inuser2;
+
+    // TYPES
+    enum Mode { M_COLLECT, M_SUBST, M_SCOPE };
+    typedef std::vector<AstCCall*> CallList;
+    typedef std::map<string, CallList> KeyCalls;  // Calls with each constant argument set
+    typedef std::map<AstCFunc*, KeyCalls> FuncKeyCalls;
+    typedef std::map<const AstVar*, AstConst*> VarConsts;
+
+    // STATE
+    const std::set<AstCFunc*>& m_funcps;  // Functions that may be specialized
+    FuncKeyCalls m_funcCalls;  // Calls to each function, by constant argument set
+    std::set<const AstVar*> m_writtenps;  // Variables assigned somewhere
+    Mode m_mode;  // What visiting is doing
+    VarConsts m_substs;  // In M_SUBST, constant to replace each argument with
+    AstScope* m_scopep;  // In M_SCOPE, scope for new variables
+    VDouble0 m_statFuncs;  // Statistic tracking
+    VDouble0 m_statCalls;  // Statistic tracking
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    bool argConstOk(AstNode* argp, AstNode* portp) {
+        // Argument can be replaced by its constant value
+        AstConst* constp = VN_CAST(argp, Const);
+        AstVar* varp = VN_CAST(portp, Var);
+        return constp && varp && varp->isNonOutput() && !varp->isWritable()
+               && m_writtenps.find(varp) == m_writtenps.end() && !constp->num().isFourState()
+               && constp->width() == varp->width();
+    }
+    string callKey(AstCCall* callp) {
+        // Constant argument positions and values, empty if none
+        string key;
+        AstNode* argp = callp->argsp();
+        AstNode* portp = callp->funcp()->argsp();
+        for (int pos = 0; argp || portp; ++pos) {
+            if (!argp || !portp) return "";  // Argument mismatch, leave alone
+            if (argConstOk(argp, portp)) {
+                key += cvtToStr(pos) + "=" + VN_CAST(argp, Const)->num().ascii() + ";";
+            }
+            argp = argp->nextp();
+            portp = portp->nextp();
+        }
+        return key;
+    }
+    void specialize(AstCFunc* funcp, const CallList& calls, int num) {
+        UINFO(4, "  Specialize x" << calls.size() << " " << funcp << endl);
+        AstCFunc* newp = funcp->cloneTree(false);
+        newp->name(funcp->name() + "__Vspec" + cvtToStr(num));
+        ++m_statFuncs;
+        // Drop the constant arguments, replacing their references with the values
+        std::vector<bool> dropArgs;
+        m_substs.clear();
+        AstNode* argp = calls.front()->argsp();
+        AstNode* origPortp = funcp->argsp();
+        for (AstNode *nextp, *portp = newp->argsp(); portp; portp = nextp) {
+            nextp = portp->nextp();
+            // Positions match the original, as the key matched
+            dropArgs.push_back(argConstOk(argp, origPortp));
+            if (dropArgs.back()) {
+                m_substs[VN_CAST(portp, Var)] = VN_CAST(argp, Const);
+                pushDeletep(portp->unlinkFrBack());
+            }
+            argp = argp->nextp();
+            origPortp = origPortp->nextp();
+        }
+        m_mode = M_SUBST;
+        iterate(newp);
+        // Remaining variables need their own scopes
+        m_mode = M_SCOPE;
+        m_scopep = funcp->scopep();
+        iterate(newp);
+        {
+            // Iteration requires a back, so put under temporary node
+            AstBegin* tempp = new AstBegin(newp->fileline(), "[EditWrapper]", newp);
+            TaskRelinkVisitor visitor(tempp);
+            newp->unlinkFrBack();
+            VL_DO_DANGLING(tempp->deleteTree(), tempp);
+        }
+        funcp->addNextHere(newp);
+        m_mode = M_COLLECT;
+        // Retarget the calls
+        for (CallList::const_iterator it = calls.begin(); it != calls.end(); ++it) {
+            AstCCall* callp = *it;
+            AstCCall* newcallp = new AstCCall(callp, newp);  // Takes arguments
+            int pos = 0;
+            for (AstNode *nextp, *cargp = newcallp->argsp(); cargp; cargp = nextp, ++pos) {
+                nextp = cargp->nextp();
+                if (dropArgs[pos]) pushDeletep(cargp->unlinkFrBack());
+            }
+            callp->replaceWith(newcallp);
+            VL_DO_DANGLING(pushDeletep(callp), callp);
+            ++m_statCalls;
+        }
+    }
+    static bool keyMoreCalls(const KeyCalls::value_type* ap, const KeyCalls::value_type* bp) {
+        return ap->second.size() > bp->second.size();
+    }
+    void specializeAll() {
+        for (FuncKeyCalls::iterator it = m_funcCalls.begin(); it != m_funcCalls.end(); ++it) {
+            // Most called argument sets first
+            std::vector<const KeyCalls::value_type*> keys;
+            for (KeyCalls::const_iterator kit = it->second.begin(); kit != it->second.end();
+                 ++kit) {
+                keys.push_back(&*kit);
+            }
+            std::stable_sort(keys.begin(), keys.end(), keyMoreCalls);
+            for (size_t i = 0; i < keys.size() && i < TASK_SPECIALIZE_MAX; ++i) {
+                specialize(it->first, keys[i]->second, i);
+            }
+        }
+    }
+
+    // VISITORS
+    virtual void visit(AstCCall* nodep) VL_OVERRIDE {
+        iterateChildren(nodep);
+        if (m_mode == M_COLLECT && m_funcps.find(nodep->funcp()) != m_funcps.end()) {
+            string key = callKey(nodep);
+            if (!key.empty()) m_funcCalls[nodep->funcp()][key].push_back(nodep);
+        }
+    }
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        if (m_mode == M_COLLECT) {
+            if (nodep->lvalue()) m_writtenps.insert(nodep->varp());
+        } else if (m_mode == M_SUBST) {
+            VarConsts::const_iterator it = m_substs.find(nodep->varp());
+            if (it != m_substs.end()) {
+                nodep->replaceWith(it->second->cloneTree(false));
+                VL_DO_DANGLING(pushDeletep(nodep), nodep);
+            }
+        }
+    }
+    virtual void visit(AstVar* nodep) VL_OVERRIDE {
+        iterateChildren(nodep);
+        if (m_mode == M_SCOPE) {
+            AstVarScope* newvscp = new AstVarScope(nodep->fileline(), m_scopep, nodep);
+            m_scopep->addVarp(newvscp);
+            nodep->user2p(newvscp);
+        }
+    }
+    //--------------------
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    TaskSpecializeVisitor(AstNetlist* nodep, const std::set<AstCFunc*>& funcps)
+        : m_funcps(funcps)
+        , m_mode(M_COLLECT)
+        , m_scopep(NULL) {
+        if (!m_funcps.empty()) {
+            iterate(nodep);
+            specializeAll();
+        }
+    }
+    virtual ~TaskSpecializeVisitor() {
+        V3Stats::addStat("Optimizations, Specialized functions", m_statFuncs);
+        V3Stats::addStat("Optimizations, Specialized function calls", m_statCalls);
+    }
+};
+
 //######################################################################
 // Task class functions
 
@@ -1569,7 +1888,10 @@ void V3Task::taskAll(AstNetlist* nodep) {
     UINFO(2, __FUNCTION__ << ": " << endl);
     {
         TaskStateVisitor visitors(nodep);
-        TaskVisitor visitor(nodep, &visitors);
+        { TaskVisitor visitor(nodep, &visitors); }
+        if (v3Global.opt.oConst()) {
+            TaskSpecializeVisitor specializer(nodep, visitors.specializables());
+        }
     }  // Destruct before checking
     V3Global::dumpCheckGlobalTree("task", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
@@ -0,0 +1,133 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Pool of worker threads for parallel passes
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#ifndef _V3THREADPOOL_H_
+#define _V3THREADPOOL_H_ 1
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include <vector>
+
+#if __cplusplus >= 201103L
+# include <atomic>
+# include <condition_variable>
+# include <functional>
+# include <mutex>
+# include <thread>
+#endif
+
+//============================================================================
+// V3ThreadPool - Worker threads shared by all parallel phases
+//
+// Threads are started on first use and reused by later calls, so a pass
+// may go parallel without paying for thread creation each time.  Most of
+// Verilator is not thread safe (AstNode user fields, edit counts, UINFO
+// and the error state are all global), so the work given to parallelFor
+// must only touch data private to each item.
+
+#if __cplusplus >= 201103L
+class V3ThreadPool {
+    // MEMBERS
+    std::mutex m_mutex;  // Protects below, except for m_next
+    std::condition_variable m_workCv;  // Signals a new batch, or stopping
+    std::condition_variable m_doneCv;  // Signals a worker finished the batch
+    std::vector<std::thread> m_workers;  // Worker threads
+    std::function<void(size_t)> m_func;  // Body of the current batch
+    size_t m_count;  // Number of items in the current batch
+    std::atomic<size_t> m_next;  // Next item of the current batch to run
+    size_t m_generation;  // Count of batches started
+    size_t m_wanted;  // Number of workers to help with the current batch
+    size_t m_running;  // Number of workers still in the current batch
+    bool m_stopping;  // Destructing, workers should exit
+    VL_UNCOPYABLE(V3ThreadPool);
+
+    // METHODS
+    void runItems() {
+        for (size_t i = m_next++; i < m_count; i = m_next++) m_func(i);
+    }
+    void work(size_t id) {
+        size_t seenGeneration = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_workCv.wait(lock, [this, id, seenGeneration]() {
+                return m_stopping || (m_generation != seenGeneration && id < m_wanted);
+            });
+            if (m_stopping) return;
+            seenGeneration = m_generation;
+            lock.unlock();
+            runItems();
+            lock.lock();
+            if (--m_running == 0) m_doneCv.notify_all();
+        }
+    }
+
+public:
+    // CONSTRUCTORS
+    V3ThreadPool()
+        : m_count(0)
+        , m_next(0)
+        , m_generation(0)
+        , m_wanted(0)
+        , m_running(0)
+        , m_stopping(false) {}
+    ~V3ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_workCv.notify_all();
+        }
+        for (size_t t = 0; t < m_workers.size(); ++t) m_workers[t].join();
+    }
+    static V3ThreadPool& s() {
+        static V3ThreadPool s_pool;
+        return s_pool;
+    }
+
+    // METHODS
+    // Call func(i) for each i in [0, count), using up to jobs threads
+    // including the calling thread, and return when all calls are done.
+    // Items are taken in index order, so put the largest first.
+    // Not reentrant; func must not call parallelFor.
+    void parallelFor(size_t jobs, size_t count, const std::function<void(size_t)>& func) {
+        if (jobs > count) jobs = count;
+        if (jobs <= 1) {
+            for (size_t i = 0; i < count; ++i) func(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (m_workers.size() < jobs - 1) {
+                size_t id = m_workers.size();
+                m_workers.emplace_back([this, id]() { work(id); });
+            }
+            m_func = func;
+            m_count = count;
+            m_next = 0;
+            m_wanted = jobs - 1;
+            m_running = jobs - 1;
+            ++m_generation;
+            m_workCv.notify_all();
+        }
+        runItems();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCv.wait(lock, [this]() { return m_running == 0; });
+        m_func = nullptr;
+    }
+};
+#endif
+
+#endif  // Guard
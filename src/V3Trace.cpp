@@ -194,8 +194,10 @@ private:
     AstCFunc* m_chgSubFuncp;  // Trace function we add statements to (under full)
     AstNode* m_chgSubParentp;  // Which node has call to m_chgSubFuncp
     int m_chgSubStmts;  // Statements under function being built
+    std::map<const AstCFunc*, uint32_t> m_chgSubWords;  // Trace buffer words per change sub
     AstVarScope* m_activityVscp;  // Activity variable
     uint32_t m_activityNumber;  // Count of fields in activity variable
+    AstVarScope* m_groupVscp;  // Group activity variable, for --trace-activity-granularity
     uint32_t m_code;  // Trace ident code# being assigned
     V3Graph m_graph;  // Var/CFunc tracking
     TraceActivityVertex* m_alwaysVtxp;  // "Always trace" vertex
@@ -205,6 +207,7 @@ private:
     VDouble0 m_statChgSigs;  // Statistic tracking
     VDouble0 m_statUniqSigs;  // Statistic tracking
     VDouble0 m_statUniqCodes;  // Statistic tracking
+    VDouble0 m_statActGroups;  // Statistic tracking
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -329,6 +332,24 @@ private:
             }
         }
 
+        m_activityVscp = newActivityVar("__Vm_traceActivity", m_activityNumber);
+
+        // Insert activity setter
+        for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp = itp->verticesNextp()) {
+            if (TraceActivityVertex* vvertexp = dynamic_cast<TraceActivityVertex*>(itp)) {
+                if (!vvertexp->activityAlways()) {
+                    FileLine* fl = vvertexp->insertp()->fileline();
+                    uint32_t acode = vvertexp->activityCode();
+                    vvertexp->insertp()->addNextHere(
+                        new AstAssign(fl, selectActivity(fl, m_activityVscp, acode, true),
+                                      new AstConst(fl, AstConst::LogicTrue())));
+                }
+            }
+        }
+    }
+
+    AstVarScope* newActivityVar(const string& name, uint32_t entries) {
+        FileLine* fl = m_chgFuncp->fileline();
         AstVar* newvarp;
         if (v3Global.opt.mtasks()) {
             // Create a vector of bytes, not bits, for the tracing vector,
@@ -338,52 +359,73 @@ private:
             // chain of packed MTasks, but we haven't packed the MTasks yet.
             // If we support fully threaded tracing in the future, it would
             // make sense to improve this at that time.
-            AstNodeDType* newScalarDtp
-                = new AstBasicDType(m_chgFuncp->fileline(), VFlagLogicPacked(), 1);
+            AstNodeDType* newScalarDtp = new AstBasicDType(fl, VFlagLogicPacked(), 1);
             v3Global.rootp()->typeTablep()->addTypesp(newScalarDtp);
             AstNodeDType* newArrDtp = new AstUnpackArrayDType(
-                m_chgFuncp->fileline(), newScalarDtp,
-                new AstRange(m_chgFuncp->fileline(), VNumRange(m_activityNumber - 1, 0, false)));
+                fl, newScalarDtp, new AstRange(fl, VNumRange(entries - 1, 0, false)));
             v3Global.rootp()->typeTablep()->addTypesp(newArrDtp);
-            newvarp = new AstVar(m_chgFuncp->fileline(), AstVarType::MODULETEMP,
-                                 "__Vm_traceActivity", newArrDtp);
+            newvarp = new AstVar(fl, AstVarType::MODULETEMP, name, newArrDtp);
         } else {
             // For tighter code; round to next word point.
-            int activityBits = VL_WORDS_I(m_activityNumber) * VL_EDATASIZE;
-            newvarp = new AstVar(m_chgFuncp->fileline(), AstVarType::MODULETEMP,
-                                 "__Vm_traceActivity", VFlagBitPacked(), activityBits);
+            int activityBits = VL_WORDS_I(entries) * VL_EDATASIZE;
+            newvarp = new AstVar(fl, AstVarType::MODULETEMP, name, VFlagBitPacked(),
+                                 activityBits);
         }
         m_topModp->addStmtp(newvarp);
         AstVarScope* newvscp = new AstVarScope(newvarp->fileline(), m_highScopep, newvarp);
         m_highScopep->addVarp(newvscp);
-        m_activityVscp = newvscp;
+        return newvscp;
+    }
 
-        // Insert activity setter
-        for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp = itp->verticesNextp()) {
-            if (TraceActivityVertex* vvertexp = dynamic_cast<TraceActivityVertex*>(itp)) {
-                if (!vvertexp->activityAlways()) {
-                    FileLine* fl = vvertexp->insertp()->fileline();
-                    uint32_t acode = vvertexp->activityCode();
-                    vvertexp->insertp()->addNextHere(
-                        new AstAssign(fl, selectActivity(fl, acode, true),
-                                      new AstConst(fl, AstConst::LogicTrue())));
-                }
-            }
+    AstNode* selectActivity(FileLine* flp, AstVarScope* vscp, uint32_t acode, bool lvalue) {
+        if (v3Global.opt.mtasks()) {
+            return new AstArraySel(flp, new AstVarRef(flp, vscp, lvalue), acode);
+        } else {
+            return new AstSel(flp, new AstVarRef(flp, vscp, lvalue), acode, 1);
         }
     }
 
-    AstNode* selectActivity(FileLine* flp, uint32_t acode, bool lvalue) {
+    void clearActivityVar(AstVarScope* vscp, uint32_t entries) {
+        // Clear activity after tracing completes
+        FileLine* fl = m_chgFuncp->fileline();
         if (v3Global.opt.mtasks()) {
-            return new AstArraySel(flp, new AstVarRef(flp, m_activityVscp, lvalue), acode);
+            for (uint32_t i = 0; i < entries; ++i) {
+                AstNode* clrp = new AstAssign(fl, selectActivity(fl, vscp, i, true),
+                                              new AstConst(fl, AstConst::LogicFalse()));
+                m_fullFuncp->addFinalsp(clrp->cloneTree(true));
+                m_chgFuncp->addFinalsp(clrp);
+            }
         } else {
-            return new AstSel(flp, new AstVarRef(flp, m_activityVscp, lvalue), acode, 1);
+            AstNode* clrp
+                = new AstAssign(fl, new AstVarRef(fl, vscp, true),
+                                new AstConst(fl, AstConst::WidthedValue(), vscp->width(), 0));
+            m_fullFuncp->addFinalsp(clrp->cloneTree(true));
+            m_chgFuncp->addFinalsp(clrp);
         }
     }
 
+    static bool chgChunked() {
+        // Change dumps are split into chunks dumped in parallel by the thread
+        // pool, filling the trace buffer then processed on the trace thread
+        return v3Global.opt.mtasks() && v3Global.opt.trueTraceThreads();
+    }
+    static uint32_t chgWords(const AstTraceInc* nodep) {
+        // Trace buffer words a change dump of nodep may write, see
+        // VerilatedTraceBuffer::chg*: a command and code, then the value
+        const AstTraceDecl* declp = nodep->declp();
+        const uint32_t elements
+            = declp->arrayRange().ranged() ? declp->arrayRange().elements() : 1;
+        return elements * (2 + declp->widthWords());
+    }
+
     AstCFunc* newCFunc(AstCFuncType type, const string& name, AstCFunc* basep) {
         AstCFunc* funcp = new AstCFunc(basep->fileline(), name, basep->scopep());
         funcp->slow(basep->slow());
-        funcp->argTypes(EmitCBaseVisitor::symClassVar() + ", " + v3Global.opt.traceClassBase()
+        // Chunked change subs are called with the chunk's part of the buffer
+        const string vcdType = (type == AstCFuncType::TRACE_CHANGE_SUB && chgChunked())
+                                   ? "VerilatedTraceBuffer"
+                                   : v3Global.opt.traceClassBase();
+        funcp->argTypes(EmitCBaseVisitor::symClassVar() + ", " + vcdType
                         + "* vcdp, uint32_t code");
         funcp->funcType(type);
         funcp->symProlog(true);
@@ -422,6 +464,118 @@ private:
         }
         m_chgSubFuncp->addStmtsp(stmtsp);
         m_chgSubStmts += EmitCBaseCounterVisitor(stmtsp).count();
+        m_chgSubWords[m_chgSubFuncp] += chgWords(VN_CAST(stmtsp, TraceInc));
+    }
+
+    uint32_t chgStmtWords(AstNode* stmtp) {
+        // Trace buffer words of a top level statement of the change function
+        uint32_t words = 0;
+        if (AstCCall* ccallp = VN_CAST(stmtp, CCall)) {
+            words += m_chgSubWords[ccallp->funcp()];
+        } else if (AstIf* ifp = VN_CAST(stmtp, If)) {
+            // Activity IF, or activity group IF of activity IFs
+            for (AstNode* nodep = ifp->ifsp(); nodep; nodep = nodep->nextp()) {
+                words += chgStmtWords(nodep);
+            }
+        }
+        return words;
+    }
+
+    void putChunksIntoTree() {
+        // Split the change function into chunks, each filling its own region of
+        // the trace buffer on a thread pool worker, see VerilatedTraceChunk.
+        // Statements are kept in order (so in activity and code order), with
+        // about the same buffer words in each chunk.
+        std::vector<AstNode*> stmts;
+        std::vector<uint32_t> stmtWords;
+        vluint64_t totalWords = 0;
+        for (AstNode* stmtp = m_chgFuncp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            stmts.push_back(stmtp);
+            stmtWords.push_back(chgStmtWords(stmtp));
+            totalWords += stmtWords.back();
+        }
+        const size_t chunks = std::min<size_t>(v3Global.opt.threads(), stmts.size());
+        if (chunks < 2) return;
+
+        FileLine* fl = m_chgFuncp->fileline();
+        std::vector<AstCFunc*> chunkFuncps;
+        std::vector<uint32_t> chunkWords;
+        vluint64_t doneWords = 0;
+        bool newChunk = true;
+        for (size_t i = 0; i < stmts.size(); ++i) {
+            if (newChunk) {
+                newChunk = false;
+                const string name
+                    = m_chgFuncp->name() + "__Vchunk" + cvtToStr(chunkFuncps.size());
+                AstCFunc* funcp = new AstCFunc(fl, name, m_chgFuncp->scopep());
+                funcp->slow(m_chgFuncp->slow());
+                funcp->argTypes("bool, void* __Vchunkp");
+                funcp->funcType(AstCFuncType::TRACE_CHANGE_CHUNK);
+                m_chgFuncp->addNext(funcp);
+                UINFO(5, "  Newfunc " << funcp << endl);
+                chunkFuncps.push_back(funcp);
+                chunkWords.push_back(0);
+            }
+            chunkFuncps.back()->addStmtsp(stmts[i]->unlinkFrBack());
+            chunkWords.back() += stmtWords[i];
+            doneWords += stmtWords[i];
+            // Close the chunk once it has its share, leaving at least a
+            // statement for each of the remaining chunks
+            const size_t stmtsLeft = stmts.size() - i - 1;
+            const size_t chunksLeft = chunks - chunkFuncps.size();
+            if (chunksLeft
+                && (doneWords * chunks >= totalWords * chunkFuncps.size()
+                    || stmtsLeft == chunksLeft)) {
+                newChunk = true;
+            }
+        }
+
+        // Dispatch the chunks, running the first on this thread
+        m_chgFuncp->addStmtsp(new AstCStmt(
+            fl, "VlThreadPool::EvalGuard __Vpool_guard(vlTOPp->__Vm_threadPoolp);\n"));
+        m_chgFuncp->addStmtsp(
+            new AstCStmt(fl, "VerilatedTraceChunk __Vchunks[" + cvtToStr(chunks) + "];\n"));
+        for (size_t c = 0; c < chunks; ++c) {
+            m_chgFuncp->addStmtsp(new AstCStmt(fl, "vcdp->chunkBegin(&__Vchunks[" + cvtToStr(c)
+                                                       + "], vlSymsp, code, "
+                                                       + cvtToStr(chunkWords[c]) + ");\n"));
+        }
+        for (size_t c = 1; c < chunks; ++c) {
+            m_chgFuncp->addStmtsp(new AstCStmt(
+                fl, "vlTOPp->__Vm_threadPoolp->workerp(" + cvtToStr(c - 1) + ")->addTask(&"
+                        + chunkFuncps[c]->nameProtect() + ", false, &__Vchunks[" + cvtToStr(c)
+                        + "]);\n"));
+        }
+        m_chgFuncp->addStmtsp(
+            new AstCStmt(fl, chunkFuncps[0]->nameProtect() + "(false, &__Vchunks[0]);\n"));
+        for (size_t c = 0; c < chunks; ++c) {
+            m_chgFuncp->addStmtsp(
+                new AstCStmt(fl, "vcdp->chunkEnd(&__Vchunks[" + cvtToStr(c) + "]);\n"));
+        }
+        // Reserve buffer space for closing each chunk
+        m_initFuncp->addStmtsp(
+            new AstCStmt(fl, "vcdp->declChunks(" + cvtToStr(chunks) + ");\n"));
+    }
+
+    static string activityGroup(const TraceTraceVertex* vvertexp,
+                                const std::set<uint32_t>& actset) {
+        // Activity group of a trace with --trace-activity-granularity, the
+        // first levels of its hierarchical name, or "" if not grouped
+        const int levels = v3Global.opt.traceActivityGranularity();
+        if (!levels) return "";
+        if (actset.find(TraceActivityVertex::ACTIVITY_ALWAYS) != actset.end()
+            || actset.find(TraceActivityVertex::ACTIVITY_NEVER) != actset.end()) {
+            return "";
+        }
+        // Hierarchy is separated by spaces, the last component is the signal
+        const string& name = vvertexp->nodep()->declp()->showname();
+        string::size_type pos = 0;
+        for (int level = 0; level < levels; ++level) {
+            const string::size_type spacePos = name.find(' ', pos);
+            if (spacePos == string::npos) break;
+            pos = spacePos + 1;
+        }
+        return name.substr(0, pos);
     }
 
     void putTracesIntoTree() {
@@ -429,7 +583,8 @@ private:
         UINFO(9, "Making trees\n");
 
         typedef std::set<uint32_t> ActCodeSet;  // All activity numbers applying to a given trace
-        typedef std::multimap<ActCodeSet, TraceTraceVertex*>
+        typedef std::pair<string, ActCodeSet> TraceKey;  // Activity group, and activity set
+        typedef std::multimap<TraceKey, TraceTraceVertex*>
             TraceVec;  // For activity set, what traces apply
         TraceVec traces;
 
@@ -462,20 +617,81 @@ private:
                 // We put constants and non-changers last, as then the
                 // prevvalue vector is more compacted
                 if (actset.empty()) actset.insert(TraceActivityVertex::ACTIVITY_NEVER);
-                traces.insert(make_pair(actset, vvertexp));
+                traces.insert(make_pair(make_pair(activityGroup(vvertexp, actset), actset),
+                                        vvertexp));
             }
         }
 
-        // Our keys are now sorted to have same activity number adjacent,
-        // then by trace order.  (Better would be execution order for cache efficiency....)
+        // Our keys are now sorted to have same activity group, then same
+        // activity number adjacent, then by trace order.  (Better would be
+        // execution order for cache efficiency....)
         // Last are constants and non-changers, as then the last value vector is more compact
 
+        // Number the groups worth an activity flag of their own: those
+        // testing more than one activity set
+        typedef std::map<string, uint32_t> GroupMap;
+        GroupMap groupNumbers;  // Activity group name to group activity number
+        std::map<uint32_t, std::set<uint32_t> > codeGroups;  // Groups each activity code sets
+        {
+            const TraceKey* lastkeyp = NULL;
+            ActCodeSet groupCodes;
+            int groupSets = 0;
+            for (TraceVec::iterator it = traces.begin();; ++it) {
+                if (lastkeyp && (it == traces.end() || it->first.first != lastkeyp->first)) {
+                    if (groupSets > 1) {
+                        const uint32_t groupNum = groupNumbers.size();
+                        groupNumbers[lastkeyp->first] = groupNum;
+                        for (ActCodeSet::const_iterator csit = groupCodes.begin();
+                             csit != groupCodes.end(); ++csit) {
+                            codeGroups[*csit].insert(groupNum);
+                        }
+                    }
+                    groupCodes.clear();
+                    groupSets = 0;
+                }
+                if (it == traces.end()) break;
+                if (it->first.first != "" && (!lastkeyp || it->first != *lastkeyp)) {
+                    groupCodes.insert(it->first.second.begin(), it->first.second.end());
+                    ++groupSets;
+                }
+                lastkeyp = &it->first;
+            }
+        }
+        const uint32_t groupNumber = groupNumbers.size();
+        m_statActGroups += groupNumber;
+        if (groupNumber) {
+            m_groupVscp = newActivityVar("__Vm_traceActivityGroup", groupNumber);
+            // Set the group flags along with each activity flag feeding them
+            for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp;
+                 itp = itp->verticesNextp()) {
+                if (TraceActivityVertex* vvertexp = dynamic_cast<TraceActivityVertex*>(itp)) {
+                    if (vvertexp->activityAlways()) continue;
+                    const std::set<uint32_t>& groups = codeGroups[vvertexp->activityCode()];
+                    for (std::set<uint32_t>::const_iterator git = groups.begin();
+                         git != groups.end(); ++git) {
+                        FileLine* fl = vvertexp->insertp()->fileline();
+                        vvertexp->insertp()->addNextHere(
+                            new AstAssign(fl, selectActivity(fl, m_groupVscp, *git, true),
+                                          new AstConst(fl, AstConst::LogicTrue())));
+                    }
+                }
+            }
+        }
+
         // Put TRACEs back into the tree
         const ActCodeSet* lastactp = NULL;
         AstNode* ifnodep = NULL;
+        const string* lastgroupp = NULL;
+        AstIf* groupIfp = NULL;
         for (TraceVec::iterator it = traces.begin(); it != traces.end(); ++it) {
-            const ActCodeSet& actset = it->first;
+            const ActCodeSet& actset = it->first.second;
             TraceTraceVertex* vvertexp = it->second;
+            if (!lastgroupp || it->first.first != *lastgroupp) {
+                // New activity group; the group's IF is built with its first trace
+                lastgroupp = &it->first.first;
+                groupIfp = NULL;
+                lastactp = NULL;
+            }
             UINFO(9, "  Done sort: " << vvertexp << endl);
             bool needChg = true;
             if (actset.find(TraceActivityVertex::ACTIVITY_NEVER) != actset.end()) {
@@ -500,7 +716,7 @@ private:
                     for (ActCodeSet::const_iterator csit = actset.begin(); csit != actset.end();
                          ++csit) {
                         uint32_t acode = *csit;
-                        AstNode* selp = selectActivity(fl, acode, false);
+                        AstNode* selp = selectActivity(fl, m_activityVscp, acode, false);
                         if (condp)
                             condp = new AstOr(fl, condp, selp);
                         else
@@ -508,7 +724,19 @@ private:
                     }
                     AstIf* ifp = new AstIf(fl, condp, NULL, NULL);
                     ifp->branchPred(VBranchPred::BP_UNLIKELY);
-                    m_chgFuncp->addStmtsp(ifp);
+                    GroupMap::const_iterator git = groupNumbers.find(*lastgroupp);
+                    if (git == groupNumbers.end()) {
+                        m_chgFuncp->addStmtsp(ifp);
+                    } else {
+                        if (!groupIfp) {
+                            groupIfp = new AstIf(
+                                fl, selectActivity(fl, m_groupVscp, git->second, false), NULL,
+                                NULL);
+                            groupIfp->branchPred(VBranchPred::BP_UNLIKELY);
+                            m_chgFuncp->addStmtsp(groupIfp);
+                        }
+                        groupIfp->addIfsp(ifp);
+                    }
                     lastactp = &actset;
                     ifnodep = ifp;
 
@@ -520,21 +748,8 @@ private:
         // Set in initializer
 
         // Clear activity after tracing completes
-        FileLine* fl = m_chgFuncp->fileline();
-        if (v3Global.opt.mtasks()) {
-            for (uint32_t i = 0; i < m_activityNumber; ++i) {
-                AstNode* clrp = new AstAssign(fl, selectActivity(fl, i, true),
-                                              new AstConst(fl, AstConst::LogicFalse()));
-                m_fullFuncp->addFinalsp(clrp->cloneTree(true));
-                m_chgFuncp->addFinalsp(clrp);
-            }
-        } else {
-            AstNode* clrp = new AstAssign(
-                fl, new AstVarRef(fl, m_activityVscp, true),
-                new AstConst(fl, AstConst::WidthedValue(), m_activityVscp->width(), 0));
-            m_fullFuncp->addFinalsp(clrp->cloneTree(true));
-            m_chgFuncp->addFinalsp(clrp);
-        }
+        clearActivityVar(m_activityVscp, m_activityNumber);
+        if (m_groupVscp) clearActivityVar(m_groupVscp, groupNumber);
     }
 
     uint32_t assignDeclCode(AstTraceDecl* nodep) {
@@ -646,6 +861,7 @@ private:
         // Create new TRACEINCs
         assignActivity();
         putTracesIntoTree();
+        if (chgChunked()) putChunksIntoTree();
     }
     virtual void visit(AstNodeModule* nodep) VL_OVERRIDE {
         if (nodep->isTop()) m_topModp = nodep;
@@ -749,6 +965,7 @@ public:
         m_highScopep = NULL;
         m_finding = false;
         m_activityVscp = NULL;
+        m_groupVscp = NULL;
         m_alwaysVtxp = NULL;
         m_initFuncp = NULL;
         m_fullFuncp = NULL;
@@ -767,6 +984,7 @@ public:
         V3Stats::addStat("Tracing, Unique changing signals", m_statChgSigs);
         V3Stats::addStat("Tracing, Unique traced signals", m_statUniqSigs);
         V3Stats::addStat("Tracing, Unique trace codes", m_statUniqCodes);
+        V3Stats::addStat("Tracing, Activity groups", m_statActGroups);
     }
 };
 
@@ -35,10 +35,73 @@
 #include "V3Unknown.h"
 #include "V3Ast.h"
 #include "V3Const.h"
+#include "V3File.h"
 #include "V3Stats.h"
 
 #include <algorithm>
 #include <cstdarg>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+//######################################################################
+// Find variables driven only by one assignment of a whole wire
+
+class UnknownDriverVisitor : public AstNVisitor {
+public:
+    typedef std::map<const AstVar*, AstNode*> Drivers;
+
+private:
+    // STATE
+    Drivers m_drivers;  // Variable -> rhs of its only AssignW, or NULL if driven otherwise
+
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        const AstVar* varp = nodep->varp();
+        if (!nodep->lvalue() || !varp) return;
+        const AstAssignW* assp = VN_CAST(nodep->backp(), AssignW);
+        const bool sole = assp && assp->lhsp() == nodep && !m_drivers.count(varp)
+                          && !varp->isIO() && !varp->isSigPublic();
+        m_drivers[varp] = sole ? assp->rhsp() : NULL;
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit UnknownDriverVisitor(AstNetlist* nodep) { iterate(nodep); }
+    virtual ~UnknownDriverVisitor() {}
+    const Drivers& drivers() const { return m_drivers; }
+};
+
+//######################################################################
+// Find variables that may be written under a statement list
+
+class UnknownWrittenVisitor : public AstNVisitor {
+private:
+    // STATE
+    std::set<const AstVar*> m_written;  // Variables written
+    bool m_calls;  // Calls a task or function, that may write any variable
+
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        if (nodep->lvalue()) m_written.insert(nodep->varp());
+    }
+    virtual void visit(AstNodeFTaskRef* nodep) VL_OVERRIDE {
+        m_calls = true;
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit UnknownWrittenVisitor(AstNode* nodep)
+        : m_calls(false) {
+        iterateAndNextNull(nodep);
+    }
+    virtual ~UnknownWrittenVisitor() {}
+    bool written(const AstVar* varp) const { return m_calls || m_written.count(varp); }
+};
 
 //######################################################################
 
@@ -52,16 +115,171 @@ private:
     AstUser1InUse m_inuser1;
     AstUser2InUse m_inuser2;
 
+    // TYPES
+    typedef std::map<const AstVar*, vluint64_t> VarBounds;
+
     // STATE
     AstNodeModule* m_modp;  // Current module
+    VarBounds m_guards;  // Upper bounds of variables from enclosing if conditions
+    VarBounds m_wireMax;  // Upper bounds of wires from their only assignment
     bool m_constXCvt;  // Convert X's
     VDouble0 m_statUnkVars;  // Statistic tracking
+    VDouble0 m_statBoundsProven;  // Statistic tracking
+    VDouble0 m_statBoundsGuarded;  // Statistic tracking
+    VDouble0 m_statBoundsKept;  // Statistic tracking
+    std::vector<string> m_boundsKept;  // Bound checks kept, for --x-mode fast report
     AstAssignW* m_assignwp;  // Current assignment
     AstAssignDly* m_assigndlyp;  // Current assignment
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
 
+    vluint64_t maxValue(const AstNode* nodep) const {
+        // Upper bound of an index expression's value, or ~0 if unknown
+        if (nodep->width() >= 64) return ~VL_ULL(0);
+        const vluint64_t widthMax = (VL_ULL(1) << nodep->width()) - 1;
+        if (const AstConst* constp = VN_CAST_CONST(nodep, Const)) {
+            return constp->num().isFourState() ? widthMax : constp->toUQuad();
+        } else if (const AstNodeVarRef* refp = VN_CAST_CONST(nodep, NodeVarRef)) {
+            vluint64_t max = widthMax;
+            VarBounds::const_iterator it = m_guards.find(refp->varp());
+            if (it != m_guards.end()) max = std::min(max, it->second);
+            it = m_wireMax.find(refp->varp());
+            if (it != m_wireMax.end()) max = std::min(max, it->second);
+            return max;
+        } else if (const AstAdd* addp = VN_CAST_CONST(nodep, Add)) {
+            // Operands are under 64 bits, so the sum can't wrap a vluint64_t
+            return std::min(widthMax, maxValue(addp->lhsp()) + maxValue(addp->rhsp()));
+        } else if (const AstConcat* concatp = VN_CAST_CONST(nodep, Concat)) {
+            return (maxValue(concatp->lhsp()) << concatp->rhsp()->width())
+                   + maxValue(concatp->rhsp());
+        } else if (const AstAnd* andp = VN_CAST_CONST(nodep, And)) {
+            return std::min(maxValue(andp->lhsp()), maxValue(andp->rhsp()));
+        } else if (const AstNodeCond* condp = VN_CAST_CONST(nodep, NodeCond)) {
+            return std::max(maxValue(condp->expr1p()), maxValue(condp->expr2p()));
+        } else if (VN_IS(nodep, Extend)) {
+            return std::min(widthMax, maxValue(VN_CAST_CONST(nodep, Extend)->lhsp()));
+        } else if (const AstShiftR* shiftp = VN_CAST_CONST(nodep, ShiftR)) {
+            const AstConst* amountp = VN_CAST_CONST(shiftp->rhsp(), Const);
+            if (amountp && !amountp->num().isFourState() && amountp->toUQuad() < 64) {
+                return std::min(widthMax, maxValue(shiftp->lhsp()) >> amountp->toUQuad());
+            }
+        } else if (const AstModDiv* modp = VN_CAST_CONST(nodep, ModDiv)) {
+            const AstConst* divp = VN_CAST_CONST(modp->rhsp(), Const);
+            if (divp && !divp->num().isFourState() && divp->toUQuad() != 0) {
+                return std::min(divp->toUQuad() - 1, maxValue(modp->lhsp()));
+            }
+        } else if (const AstDiv* divp = VN_CAST_CONST(nodep, Div)) {
+            const AstConst* byp = VN_CAST_CONST(divp->rhsp(), Const);
+            if (byp && !byp->num().isFourState() && byp->toUQuad() != 0) {
+                return maxValue(divp->lhsp()) / byp->toUQuad();
+            }
+        }
+        return widthMax;
+    }
+    bool boundProven(AstNode* nodep, AstNode* condp, AstNode* indexp, vluint64_t maxIndex) {
+        // True if the bound check 'condp' on 'indexp' is not needed
+        if (condp->isOne() || maxValue(indexp) <= maxIndex) {
+            ++m_statBoundsProven;
+            if (!condp->isOne() && !m_guards.empty()) {
+                VarBounds guards;
+                guards.swap(m_guards);
+                if (maxValue(indexp) > maxIndex) ++m_statBoundsGuarded;
+                guards.swap(m_guards);
+            }
+            return true;
+        }
+        ++m_statBoundsKept;
+        if (v3Global.opt.xMode() == "fast") {
+            m_boundsKept.push_back(nodep->fileline()->ascii() + ": " + nodep->prettyTypeName()
+                                   + " index may exceed " + cvtToStr(maxIndex));
+        }
+        return false;
+    }
+    void guardFacts(AstNode* condp, VarBounds& facts) const {
+        // Add upper bounds of variables implied by condp being true
+        if (VN_IS(condp, LogAnd) || (VN_IS(condp, And) && condp->width() == 1)) {
+            guardFacts(VN_CAST(condp, NodeBiop)->lhsp(), facts);
+            guardFacts(VN_CAST(condp, NodeBiop)->rhsp(), facts);
+            return;
+        }
+        // Unsigned var < const, var <= const, const > var or const >= var
+        AstNodeBiop* cmpp = VN_CAST(condp, NodeBiop);
+        const bool varLeft = VN_IS(condp, Lt) || VN_IS(condp, Lte);
+        if (!cmpp || !(varLeft || VN_IS(condp, Gt) || VN_IS(condp, Gte))) return;
+        AstNode* sidep = varLeft ? cmpp->lhsp() : cmpp->rhsp();
+        const AstConst* constp = VN_CAST(varLeft ? cmpp->rhsp() : cmpp->lhsp(), Const);
+        while (VN_IS(sidep, Extend)) sidep = VN_CAST(sidep, Extend)->lhsp();
+        const AstNodeVarRef* refp = VN_CAST(sidep, NodeVarRef);
+        if (!refp || !constp || constp->num().isFourState() || constp->width() > 64) return;
+        vluint64_t max = constp->toUQuad();
+        if (VN_IS(condp, Lt) || VN_IS(condp, Gt)) {
+            if (max == 0) return;  // Never true
+            --max;
+        }
+        VarBounds::iterator it = facts.find(refp->varp());
+        if (it == facts.end() || max < it->second) facts[refp->varp()] = max;
+    }
+    void iterateGuarded(AstNode* condp, AstNode* nodesp) {
+        // Iterate nodesp, executed only when condp is true
+        VarBounds facts;
+        guardFacts(condp, facts);
+        if (!facts.empty() && nodesp) {
+            const UnknownWrittenVisitor writes(nodesp);
+            for (VarBounds::iterator it = facts.begin(); it != facts.end();) {
+                if (writes.written(it->first)) {
+                    facts.erase(it++);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        if (facts.empty()) {
+            iterateAndNextNull(nodesp);
+            return;
+        }
+        const VarBounds origGuards = m_guards;
+        for (VarBounds::const_iterator it = facts.begin(); it != facts.end(); ++it) {
+            VarBounds::iterator git = m_guards.find(it->first);
+            if (git == m_guards.end() || it->second < git->second) {
+                m_guards[it->first] = it->second;
+            }
+        }
+        iterateAndNextNull(nodesp);
+        m_guards = origGuards;
+    }
+    void findWireBounds(AstNetlist* nodep) {
+        // Bound each wire by its only assignment, before any are edited.  Each
+        // pass starts from valid bounds so is valid; a few passes follow chains.
+        // Unless wires reset to zero, a read before the assignment first
+        // settles, e.g. in an initial block, could see any value.
+        if (v3Global.opt.xInitial() != "fast" && v3Global.opt.xInitial() != "0") return;
+        const UnknownDriverVisitor driverVisitor(nodep);
+        const UnknownDriverVisitor::Drivers& drivers = driverVisitor.drivers();
+        for (int pass = 0; pass < 3; ++pass) {
+            for (UnknownDriverVisitor::Drivers::const_iterator it = drivers.begin();
+                 it != drivers.end(); ++it) {
+                if (!it->second || it->first->width() >= 64) continue;
+                const vluint64_t widthMax = (VL_ULL(1) << it->first->width()) - 1;
+                const vluint64_t max = std::min(widthMax, maxValue(it->second));
+                if (max < widthMax) m_wireMax[it->first] = max;
+            }
+        }
+    }
+    void writeBoundsReport() {
+        const string filename
+            = v3Global.opt.makeDir() + "/" + v3Global.opt.prefix() + "__xbounds.txt";
+        const vl_unique_ptr<std::ofstream> ofp(V3File::new_ofstream(filename));
+        if (ofp->fail()) v3fatal("Can't write " << filename);
+        *ofp << "# Verilator --x-mode fast, bound checks that could not be removed" << endl;
+        *ofp << "# Proven in range: " << m_statBoundsProven << ", kept: " << m_statBoundsKept
+             << endl;
+        for (std::vector<string>::const_iterator it = m_boundsKept.begin();
+             it != m_boundsKept.end(); ++it) {
+            *ofp << *it << endl;
+        }
+    }
+
     void replaceBoundLvalue(AstNode* nodep, AstNode* condp) {
         // Spec says a out-of-range LHS SEL results in a NOP.
         // This is a PITA.  We could:
@@ -155,6 +373,16 @@ private:
         VL_DO_DANGLING(iterateChildren(nodep), nodep);  // May delete nodep.
         m_assignwp = NULL;
     }
+    virtual void visit(AstNodeIf* nodep) VL_OVERRIDE {
+        iterateAndNextNull(nodep->condp());
+        iterateGuarded(nodep->condp(), nodep->ifsp());
+        iterateAndNextNull(nodep->elsesp());
+    }
+    virtual void visit(AstNodeCond* nodep) VL_OVERRIDE {
+        iterateAndNextNull(nodep->condp());
+        iterateGuarded(nodep->condp(), nodep->expr1p());
+        iterateAndNextNull(nodep->expr2p());
+    }
     virtual void visit(AstCaseItem* nodep) VL_OVERRIDE {
         m_constXCvt = false;  // Avoid losing the X's in casex
         iterateAndNextNull(nodep->condsp());
@@ -329,7 +557,7 @@ private:
             // See if the condition is constant true (e.g. always in bound due to constant select)
             // Note below has null backp(); the Edit function knows how to deal with that.
             condp = V3Const::constifyEdit(condp);
-            if (condp->isOne()) {
+            if (boundProven(nodep, condp, nodep->lsbp(), maxmsb)) {
                 // We don't need to add a conditional; we know the existing expression is ok
                 VL_DO_DANGLING(condp->deleteTree(), condp);
             } else if (!lvalue) {
@@ -386,7 +614,7 @@ private:
                                         nodep->bitp()->cloneTree(false));
             // Note below has null backp(); the Edit function knows how to deal with that.
             condp = V3Const::constifyEdit(condp);
-            if (condp->isOne()) {
+            if (declElements > 0 && boundProven(nodep, condp, nodep->bitp(), declElements - 1)) {
                 // We don't need to add a conditional; we know the existing expression is ok
                 VL_DO_DANGLING(condp->deleteTree(), condp);
             } else if (!lvalue
@@ -434,10 +662,15 @@ public:
         m_assigndlyp = NULL;
         m_assignwp = NULL;
         m_constXCvt = false;
+        findWireBounds(nodep);
         iterate(nodep);
     }
     virtual ~UnknownVisitor() {  //
         V3Stats::addStat("Unknowns, variables created", m_statUnkVars);
+        V3Stats::addStat("Unknowns, bound checks proven", m_statBoundsProven);
+        V3Stats::addStat("Unknowns, bound checks proven by if guards", m_statBoundsGuarded);
+        V3Stats::addStat("Unknowns, bound checks kept", m_statBoundsKept);
+        if (v3Global.opt.xMode() == "fast") writeBoundsReport();
     }
 };
 
@@ -21,6 +21,8 @@
 //      Look for "FOR" loops and unroll them if <= 32 loops.
 //      (Eventually, a better way would be to simulate the entire loop; ala V3Table.)
 //      Convert remaining FORs to WHILEs
+//      Loops too large to unroll, with a small body and a known trip count,
+//      are partially unrolled so the loop overhead is paid less often.
 //
 //*************************************************************************
 
@@ -32,6 +34,7 @@
 #include "V3Stats.h"
 #include "V3Const.h"
 #include "V3Ast.h"
+#include "V3InstrCount.h"
 #include "V3Simulate.h"
 
 #include <algorithm>
@@ -40,6 +43,13 @@
 //######################################################################
 // Unroll state, as a visitor of each AstNode
 
+// Most iterations simulated to find a trip count for partial unrolling
+#define UNROLL_TRIPS_MAX 4096
+// Most copies of the body in a partially unrolled loop
+#define UNROLL_PARTIAL_MAX 8
+// Most instructions in a partially unrolled loop body
+#define UNROLL_PARTIAL_INSTRS 64
+
 class UnrollVisitor : public AstNVisitor {
 private:
     // STATE
@@ -54,6 +64,9 @@ private:
     string m_beginName;  // What name to give begin iterations
     VDouble0 m_statLoops;  // Statistic tracking
     VDouble0 m_statIters;  // Statistic tracking
+    VDouble0 m_statPartialLoops;  // Statistic tracking
+    VDouble0 m_statPartialIters;  // Statistic tracking
+    VDouble0 m_statKeptLoops;  // Statistic tracking
 
     // METHODS
     VL_DEBUG_FUNC;  // Declare debug()
@@ -85,6 +98,56 @@ private:
         return bodySizeOverRecurse(nodep->nextp(), bodySize, bodyLimit);
     }
 
+    bool instrCountable(AstNode* nodep) {
+        // V3InstrCount can't cost slice or member selects, still present before V3Slice
+        for (; nodep; nodep = nodep->nextp()) {
+            if (VN_IS(nodep, SliceSel) || VN_IS(nodep, MemberSel)) return false;
+            if (!instrCountable(nodep->op1p()) || !instrCountable(nodep->op2p())
+                || !instrCountable(nodep->op3p()) || !instrCountable(nodep->op4p())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t listCost(AstNode* listp, AstNode* skipp) {
+        // Estimated instructions to execute the statements in listp, except skipp
+        uint32_t cost = 0;
+        for (AstNode* stmtp = listp; stmtp; stmtp = stmtp->nextp()) {
+            if (stmtp != skipp) cost += V3InstrCount::count(stmtp, false);
+        }
+        return cost;
+    }
+
+    int partialFactor(int loops, uint32_t iterCost) {
+        // Largest number of body copies that divides the trip count and still fits
+        int maxFactor = std::min(static_cast<int>(UNROLL_PARTIAL_MAX), unrollCount());
+        for (int factor = maxFactor; factor > 1; --factor) {
+            if (loops > factor && loops % factor == 0
+                && iterCost * factor <= UNROLL_PARTIAL_INSTRS) {
+                return factor;
+            }
+        }
+        return 1;
+    }
+
+    void partialUnroller(AstWhile* nodep, int factor) {
+        // Trip count is a multiple of factor, so test the condition once per factor
+        // iterations.  The rest of the loop control is unchanged; each copy of the
+        // body still ends by incrementing the loop variable.
+        UINFO(4, "   Partial unroll x" << factor << " " << nodep << endl);
+        AstNode* bodysp = nodep->bodysp()->unlinkFrBackWithNext();
+        AstNode* newp = NULL;
+        for (int copy = 1; copy < factor; ++copy) {
+            newp = AstNode::addNextNull(newp, bodysp->cloneTree(true));
+            if (nodep->incsp()) newp = AstNode::addNextNull(newp, nodep->incsp()->cloneTree(true));
+        }
+        newp = AstNode::addNextNull(newp, bodysp);
+        nodep->addBodysp(newp);
+        ++m_statPartialLoops;
+        m_statPartialIters += factor;
+    }
+
     bool
     forUnrollCheck(AstNode* nodep,
                    AstNode* initp,  // Maybe under nodep (no nextp), or standalone (ignore nextp)
@@ -163,8 +226,10 @@ private:
             if (!canSimulate(condp)) return cantUnroll(condp, "Unable to simulate condition");
 
             // Check whether to we actually want to try and unroll.
+            // Count past unrollCount, as a loop too long to unroll fully may unroll partially
             int loops;
-            if (!countLoops(initAssp, condp, incp, unrollCount(), loops)) {
+            if (!countLoops(initAssp, condp, incp,
+                            std::max(unrollCount(), static_cast<int>(UNROLL_TRIPS_MAX)), loops)) {
                 return cantUnroll(nodep, "Unable to simulate loop");
             }
 
@@ -172,11 +237,41 @@ private:
             int bodySize = 0;
             int bodyLimit = v3Global.opt.unrollStmts();
             if (loops > 0) bodyLimit = v3Global.opt.unrollStmts() / loops;
-            if (bodySizeOverRecurse(precondsp, bodySize /*ref*/, bodyLimit)
-                || bodySizeOverRecurse(bodysp, bodySize /*ref*/, bodyLimit)
-                || bodySizeOverRecurse(incp, bodySize /*ref*/, bodyLimit)) {
-                return cantUnroll(nodep, "too many statements");
+            // Estimated instructions per iteration, wide operations cost more than their nodes
+            bool costKnown = instrCountable(precondsp) && instrCountable(bodysp)
+                             && instrCountable(incp);
+            uint32_t iterCost = 0;
+            if (costKnown) {
+                iterCost = listCost(precondsp, NULL) + listCost(bodysp, incp)
+                           + V3InstrCount::count(incp, false);
+            }
+            const char* reason = NULL;
+            if (loops > unrollCount()) {
+                reason = "too many iterations";
+            } else if (bodySizeOverRecurse(precondsp, bodySize /*ref*/, bodyLimit)
+                       || bodySizeOverRecurse(bodysp, bodySize /*ref*/, bodyLimit)
+                       || bodySizeOverRecurse(incp, bodySize /*ref*/, bodyLimit)) {
+                reason = "too many statements";
+            } else if (costKnown && loops > 0 && iterCost > static_cast<uint32_t>(bodyLimit)) {
+                reason = "too many instructions";
+            }
+            if (reason) {
+                // Keep the loop, but maybe with several iterations per trip
+                AstWhile* whilep = VN_CAST(nodep, While);
+                int factor = partialFactor(loops, iterCost);
+                if (costKnown && whilep && !precondsp && bodysp && factor > 1) {
+                    UINFO(4, "   Unroll decision: partial, " << loops << " loops, cost "
+                                                             << iterCost << endl);
+                    partialUnroller(whilep, factor);
+                    return false;
+                }
+                UINFO(4, "   Unroll decision: keep, " << loops << " loops, cost " << iterCost
+                                                      << endl);
+                ++m_statKeptLoops;
+                return cantUnroll(nodep, reason);
             }
+            UINFO(4, "   Unroll decision: full, " << loops << " loops, cost " << iterCost
+                                                  << endl);
         }
         // Finally, we can do it
         if (!forUnroller(nodep, initAssp, condp, precondsp, incp, bodysp)) {
@@ -472,6 +567,10 @@ public:
     virtual ~UnrollVisitor() {
         V3Stats::addStatSum("Optimizations, Unrolled Loops", m_statLoops);
         V3Stats::addStatSum("Optimizations, Unrolled Iterations", m_statIters);
+        V3Stats::addStatSum("Optimizations, Unrolled Loops partially", m_statPartialLoops);
+        V3Stats::addStatSum("Optimizations, Unrolled Iterations partially",
+                            m_statPartialIters);
+        V3Stats::addStatSum("Unrolling kept loops", m_statKeptLoops);
     }
     // METHODS
     void init(bool generate, const string& beginName) {
@@ -0,0 +1,126 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Flag writes of VPI signals for value callbacks
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+// V3VpiChange's Transformations:
+//
+// Each module:
+//      For each public_flat_rw variable, except top level ports
+//          Create a __Vvpichg flag variable
+// Each statement:
+//      If it writes a flagged variable, set the flag after the statement
+//
+// The VPI runtime then only compares flagged variables against their
+// previous values when calling cbValueChange callbacks.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3Global.h"
+#include "V3VpiChange.h"
+#include "V3Ast.h"
+
+#include <set>
+
+//######################################################################
+
+class VpiChangeVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    //  AstVar::user1p()        -> AstVar*.  Change flag of hooked variable
+    AstUser1InUse m_inuser1;
+
+    // STATE
+    AstNode* m_stmtp;  // Current statement
+    typedef std::set<std::pair<AstNode*, AstVar*> > StmtFlags;
+    StmtFlags m_stmtFlags;  // Statements and the flags they need set
+    std::vector<std::pair<AstNode*, AstVarRef*> > m_sets;  // Flags to set, in order found
+
+    // METHODS
+    VL_DEBUG_FUNC;  // Declare debug()
+
+    void createFlags(AstNodeModule* modp) {
+        for (AstNode* stmtp = modp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            AstVar* varp = VN_CAST(stmtp, Var);
+            if (!varp || !varp->isSigUserRWPublic() || varp->isParam()) continue;
+            // Top ports are written by the application, not the model
+            if (modp->isTop() && varp->isIO()) continue;
+            AstVar* flagp = new AstVar(varp->fileline(), AstVarType::MODULETEMP,
+                                       V3VpiChange::flagPrefix() + varp->name(),
+                                       VFlagBitPacked(), 1);
+            varp->addNextHere(flagp);
+            varp->user1p(flagp);
+            UINFO(8, "  Hook " << varp << endl);
+        }
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeStmt* nodep) VL_OVERRIDE {
+        if (!nodep->isStatement()) {  // Function call in an expression
+            iterateChildren(nodep);
+            return;
+        }
+        AstNode* lastStmtp = m_stmtp;
+        m_stmtp = nodep;
+        iterateChildren(nodep);
+        m_stmtp = lastStmtp;
+    }
+    virtual void visit(AstVarRef* nodep) VL_OVERRIDE {
+        if (!nodep->lvalue() || !m_stmtp) return;
+        AstVar* flagp = VN_CAST(nodep->varp()->user1p(), Var);
+        if (!flagp) return;
+        // Once per statement, even if it writes the variable in several places
+        if (m_stmtFlags.insert(std::make_pair(m_stmtp, flagp)).second) {
+            m_sets.push_back(std::make_pair(m_stmtp, nodep));
+        }
+    }
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit VpiChangeVisitor(AstNetlist* nodep) {
+        m_stmtp = NULL;
+        for (AstNodeModule* modp = nodep->modulesp(); modp;
+             modp = VN_CAST(modp->nextp(), NodeModule)) {
+            createFlags(modp);
+        }
+        iterate(nodep);
+        // Add after iterating, so the new statements aren't visited
+        for (size_t i = 0; i < m_sets.size(); ++i) {
+            AstNode* stmtp = m_sets[i].first;
+            AstVarRef* writep = m_sets[i].second;
+            FileLine* fl = writep->fileline();
+            AstVarRef* flagRefp
+                = new AstVarRef(fl, VN_CAST(writep->varp()->user1p(), Var), true);
+            // Same module as the variable, so same way to reach it
+            flagRefp->hiername(writep->hiername());
+            flagRefp->hierThis(writep->hierThis());
+            flagRefp->packagep(writep->packagep());
+            stmtp->addNextStmt(new AstAssign(fl, flagRefp, new AstConst(fl, AstConst::LogicTrue())),
+                               NULL);
+        }
+    }
+    virtual ~VpiChangeVisitor() {}
+};
+
+//######################################################################
+// VpiChange class functions
+
+void V3VpiChange::vpiChangeAll(AstNetlist* nodep) {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    { VpiChangeVisitor visitor(nodep); }  // Destruct before checking
+    V3Global::dumpCheckGlobalTree("vpichange", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
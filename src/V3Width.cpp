@@ -1580,6 +1580,14 @@ private:
                         || VN_IS(nodep->dtypeSkipRefp(), NodeUOrStructDType))) {
             nodep->v3error("Unsupported: Inputs and outputs must be simple data types");
         }
+        if (nodep->attrSparse()
+            && (nodep->isIO() || nodep->isFuncLocal() || nodep->isParam()
+                || !VN_IS(nodep->dtypeSkipRefp(), UnpackArrayDType))) {
+            nodep->v3error("Unsupported: sparse metacomment on other than an unpacked array"
+                           " module variable: "
+                           << nodep->prettyNameQ());
+            nodep->attrSparse(false);
+        }
         if (VN_IS(nodep->dtypep()->skipRefToConstp(), ConstDType)) nodep->isConst(true);
         // Parameters if implicit untyped inherit from what they are assigned to
         AstBasicDType* bdtypep = VN_CAST(nodep->dtypep(), BasicDType);
@@ -3397,7 +3405,10 @@ private:
         if (AstAssocArrayDType* adtypep
             = VN_CAST(nodep->memp()->dtypep()->skipRefp(), AssocArrayDType)) {
             subp = adtypep->subDTypep();
-            if (!adtypep->keyDTypep()->skipRefp()->basicp()
+            if (nodep->isRaw()) {
+                nodep->memp()->v3error("Unsupported: " << nodep->verilogKwd()
+                                                       << " into associative array");
+            } else if (!adtypep->keyDTypep()->skipRefp()->basicp()
                 || !adtypep->keyDTypep()->skipRefp()->basicp()->keyword().isIntNumeric()) {
                 nodep->memp()->v3error(nodep->verilogKwd()
                                        << " address/key must be integral (IEEE 1800-2017 21.4.1)");
@@ -5272,6 +5283,66 @@ public:
     virtual ~WidthVisitor() {}
 };
 
+//######################################################################
+// Associative array implementation selection
+
+class WidthAssocVisitor : public AstNVisitor {
+    // Mark associative arrays that are only element selected, sized,
+    // tested or deleted; these may use an unordered hash table.
+private:
+    // NODE STATE
+    // AstVar::user1()          -> bool.  True if needs ordered container
+    AstUser1InUse m_inuser1;
+
+    // STATE
+    std::vector<AstVar*> m_varps;  // Associative array variables
+
+    // METHODS
+    static bool assocPlainVar(const AstVar* varp) {
+        return VN_IS(varp->dtypeSkipRefp(), AssocArrayDType) && !varp->isIO()
+               && !varp->isSigPublic() && !varp->isDpiOpenArray();
+    }
+    static bool unorderedUse(const AstNodeVarRef* nodep) {
+        const AstNode* backp = nodep->backp();
+        if (const AstAssocSel* selp = VN_CAST_CONST(backp, AssocSel)) {
+            return selp->fromp() == nodep;
+        } else if (const AstCMethodHard* methodp = VN_CAST_CONST(backp, CMethodHard)) {
+            return (methodp->fromp() == nodep
+                    && (methodp->name() == "size" || methodp->name() == "exists"
+                        || methodp->name() == "clear" || methodp->name() == "erase"));
+        }
+        return false;  // Whole-array copy, iteration, $display, etc.
+    }
+
+    // VISITORS
+    virtual void visit(AstVar* nodep) VL_OVERRIDE {
+        if (assocPlainVar(nodep)) m_varps.push_back(nodep);
+    }
+    virtual void visit(AstNodeVarRef* nodep) VL_OVERRIDE {
+        if (nodep->varp() && !unorderedUse(nodep)) nodep->varp()->user1(true);
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstMemberSel* nodep) VL_OVERRIDE {
+        if (nodep->varp()) nodep->varp()->user1(true);
+        iterateChildren(nodep);
+    }
+    virtual void visit(AstNodeDType*) VL_OVERRIDE {}  // Accelerate
+    virtual void visit(AstNode* nodep) VL_OVERRIDE { iterateChildren(nodep); }
+
+public:
+    // CONSTRUCTORS
+    explicit WidthAssocVisitor(AstNetlist* nodep) {
+        iterate(nodep);
+        for (std::vector<AstVar*>::iterator it = m_varps.begin(); it != m_varps.end(); ++it) {
+            if (!(*it)->user1()) {
+                UINFO(4, "  Assoc hash: " << *it << endl);
+                (*it)->isAssocHash(true);
+            }
+        }
+    }
+    virtual ~WidthAssocVisitor() {}
+};
+
 //######################################################################
 // Width class functions
 
@@ -5290,6 +5361,7 @@ void V3Width::width(AstNetlist* nodep) {
         (void)visitor.mainAcceptEdit(nodep);
         WidthRemoveVisitor rvisitor;
         (void)rvisitor.mainAcceptEdit(nodep);
+        WidthAssocVisitor avisitor(nodep);
     }  // Destruct before checking
     V3Global::dumpCheckGlobalTree("width", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
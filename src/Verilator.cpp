@@ -42,6 +42,7 @@
 #include "V3DepthBlock.h"
 #include "V3Descope.h"
 #include "V3EmitC.h"
+#include "V3EmitCLanes.h"
 #include "V3EmitCMain.h"
 #include "V3EmitCMake.h"
 #include "V3EmitMk.h"
@@ -53,7 +54,9 @@
 #include "V3GenClk.h"
 #include "V3Graph.h"
 #include "V3Inline.h"
+#include "V3InlineCFuncs.h"
 #include "V3Inst.h"
+#include "V3InstrCount.h"
 #include "V3Life.h"
 #include "V3LifePost.h"
 #include "V3LinkCells.h"
@@ -93,6 +96,7 @@
 #include "V3Undriven.h"
 #include "V3Unknown.h"
 #include "V3Unroll.h"
+#include "V3VpiChange.h"
 #include "V3Width.h"
 
 #include <ctime>
@@ -101,6 +105,9 @@
 V3Global v3Global;
 
 static void process() {
+    // Before anything estimates costs
+    if (!v3Global.opt.instrCosts().empty()) V3InstrCount::loadCosts(v3Global.opt.instrCosts());
+
     // Sort modules by level so later algorithms don't need to care
     V3LinkLevel::modSortByLevel();
     V3Error::abortIfErrors();
@@ -162,6 +169,8 @@ static void process() {
     V3Assert::assertAll(v3Global.rootp());
 
     if (!(v3Global.opt.xmlOnly() && !v3Global.opt.flatten())) {
+        // Replace --cosim-cut instances with top level ports to their partition
+        if (!v3Global.opt.cosimCuts().empty()) V3LinkLevel::cosimCut(v3Global.rootp());
         // Add top level wrapper with instance pointing to old top
         // Move packages to under new top
         // Must do this after we know parameters and dtypes (as don't clone dtype decls)
@@ -378,7 +387,12 @@ static void process() {
         if (v3Global.opt.oLocalize()) V3Localize::localizeAll(v3Global.rootp());
 
         // Icache packing; combine common code in each module's functions into subroutines
-        if (v3Global.opt.oCombine()) V3Combine::combineAll(v3Global.rootp());
+        if (v3Global.opt.oCombine() || v3Global.opt.shareInstances()) {
+            V3Combine::combineAll(v3Global.rootp());
+        }
+
+        // Inline small and single-caller functions, after combining
+        if (v3Global.opt.oInlineCFuncs()) V3InlineCFuncs::inlineAll(v3Global.rootp());
     }
 
     V3Error::abortIfErrors();
@@ -419,6 +433,11 @@ static void process() {
         V3Dead::deadifyAll(v3Global.rootp());
     }
 
+    if (!v3Global.opt.lintOnly() && !v3Global.opt.xmlOnly() && v3Global.opt.oTempReuse()) {
+        // Share temporaries' storage, once substitution has removed those it can
+        V3Premit::reuseTempsAll(v3Global.rootp());
+    }
+
     if (!v3Global.opt.lintOnly() && !v3Global.opt.xmlOnly() && v3Global.opt.oReloop()) {
         // Reform loops to reduce code size
         // Must be after all Sel/array index based optimizations
@@ -439,6 +458,12 @@ static void process() {
     }
 
     V3Error::abortIfErrors();
+    if (!v3Global.opt.lintOnly() && !v3Global.opt.xmlOnly() && v3Global.opt.vpi()
+        && v3Global.opt.vpiChangeHooks()) {
+        // Flag writes for VPI value callbacks, after all statements are final
+        // and before V3CCtors which resets the new flags
+        V3VpiChange::vpiChangeAll(v3Global.rootp());
+    }
     if (!v3Global.opt.lintOnly() && !v3Global.opt.xmlOnly()) {  //
         V3CCtors::cctorsAll();
     }
@@ -466,6 +491,7 @@ static void process() {
     if (!v3Global.opt.xmlOnly()
         && !v3Global.opt.dpiHdrOnly()) {  // Unfortunately we have some lint checks in emitc.
         V3EmitC::emitc();
+        if (v3Global.opt.profSample()) V3EmitC::emitcFuncMap();
     }
     if (v3Global.opt.xmlOnly()
         // Check XML when debugging to make sure no missing node types
@@ -483,11 +509,13 @@ static void process() {
     // Statistics
     if (v3Global.opt.stats()) {
         V3Stats::statsFinalAll(v3Global.rootp());
+        V3Stats::statsMemoryReport(v3Global.rootp());
         V3Stats::statsReport();
     }
 
     if (!v3Global.opt.lintOnly() && !v3Global.opt.xmlOnly() && !v3Global.opt.dpiHdrOnly()) {
         // Makefile must be after all other emitters
+        if (v3Global.opt.lanes() > 1) V3EmitCLanes::emit();
         if (v3Global.opt.main()) V3EmitCMain::emit();
         if (v3Global.opt.cmake()) V3EmitCMake::emit();
         if (v3Global.opt.gmake()) V3EmitMk::emitmk();
@@ -532,6 +560,8 @@ static void verilate(const string& argString) {
         V3Partition::selfTest();
     }
 
+    if (!v3Global.opt.statsJson().empty()) V3Stats::statsPassBegin();
+
     // Read first filename
     v3Global.readFiles();
 
@@ -542,6 +572,7 @@ static void verilate(const string& argString) {
 
     // Final steps
     V3Global::dumpCheckGlobalTree("final", 990, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+    if (!v3Global.opt.statsJson().empty()) V3Stats::statsPassReport();
     V3Error::abortIfWarnings();
 
     if (v3Global.opt.makeDepend().isTrue()) {
@@ -551,7 +582,9 @@ static void verilate(const string& argString) {
         VIdProtect::writeMapFile(v3Global.opt.makeDir() + "/" + v3Global.opt.prefix()
                                  + "__idmap.xml");
     }
-    if (v3Global.opt.skipIdentical().isTrue() || v3Global.opt.makeDepend().isTrue()) {
+    if ((v3Global.opt.skipIdentical().isTrue() || v3Global.opt.makeDepend().isTrue())
+        // Linting must repeat any warnings, so only skip clean lints
+        && !(v3Global.opt.lintOnly() && V3Error::warnCount())) {
         V3File::writeTimes(v3Global.opt.makeDir() + "/" + v3Global.opt.prefix() + "__verFiles.dat",
                            argString);
     }
@@ -579,7 +612,11 @@ static void execBuildJob() {
     cmd << v3Global.opt.getenvMAKE();
     cmd << " -C " << v3Global.opt.makeDir();
     cmd << " -f " << v3Global.opt.prefix() << ".mk";
-    if (jobs == 0) {
+    if (jobs == 0 && V3Os::getenvStr("MAKEFLAGS", "").find("-jobserver-") != string::npos) {
+        // Run from a parallel make; the sub-make takes job slots from its
+        // jobserver, where an unlimited -j would oversubscribe the machine
+        UINFO(1, "Using jobserver of parent make\n");
+    } else if (jobs == 0) {
         cmd << " -j";
     } else if (jobs > 1) {
         cmd << " -j " << jobs;
@@ -20,6 +20,8 @@
 #include "config_build.h"
 #include "verilatedos.h"
 
+#include <algorithm>
+
 //********************************************************************
 // VlcBuckets - Container of all coverage point hits for a given test
 // This is a bitmap array - we store a single bit to indicate a test
@@ -35,6 +37,17 @@ private:
 private:
     static inline vluint64_t covBit(vluint64_t point) { return 1ULL << (point & 63); }
     inline vluint64_t allocSize() const { return sizeof(vluint64_t) * m_dataSize / 64; }
+    inline vluint64_t words() const { return m_dataSize / 64; }
+    static inline vluint64_t wordPopCount(vluint64_t word) {
+#ifdef __GNUC__
+        return __builtin_popcountll(word);
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        return (word * 0x0101010101010101ULL) >> 56;
+#endif
+    }
     void allocate(vluint64_t point) {
         vluint64_t oldsize = m_dataSize;
         if (m_dataSize < point) m_dataSize = (point + 64) & ~63ULL;  // Keep power of two
@@ -97,24 +110,25 @@ public:
             return (m_datap[point / 64] & covBit(point)) ? 1 : 0;
         }
     }
+    // The word loops below are simple enough for the compiler to vectorize
     vluint64_t popCount() const {
         vluint64_t pop = 0;
-        for (vluint64_t i = 0; i < m_dataSize; i++) {
-            if (hits(i)) pop++;
-        }
+        for (vluint64_t w = 0; w < words(); ++w) pop += wordPopCount(m_datap[w]);
         return pop;
     }
-    vluint64_t dataPopCount(const VlcBuckets& remaining) {
+    /// Number of points hit both here and in remaining
+    vluint64_t dataPopCount(const VlcBuckets& remaining) const {
+        const vluint64_t nwords = std::min(words(), remaining.words());
+        const vluint64_t* ap = m_datap;
+        const vluint64_t* bp = remaining.m_datap;
         vluint64_t pop = 0;
-        for (vluint64_t i = 0; i < m_dataSize; i++) {
-            if (hits(i) && remaining.hits(i)) pop++;
-        }
+        for (vluint64_t w = 0; w < nwords; ++w) pop += wordPopCount(ap[w] & bp[w]);
         return pop;
     }
+    /// Clear points that are hit in ordata
     void orData(const VlcBuckets& ordata) {
-        for (vluint64_t i = 0; i < m_dataSize; i++) {
-            if (hits(i) && ordata.hits(i)) clearHits(i);
-        }
+        const vluint64_t nwords = std::min(words(), ordata.words());
+        for (vluint64_t w = 0; w < nwords; ++w) m_datap[w] &= ~ordata.m_datap[w];
     }
 
     void dump() const {
@@ -84,6 +84,8 @@ void VlcOptions::parseOptsList(int argc, char** argv) {
                 m_annotateAll = flag;
             } else if (onoff(sw, "-rank", flag /*ref*/)) {
                 m_rank = flag;
+            } else if (onoff(sw, "-stats", flag /*ref*/)) {
+                m_stats = flag;
             } else if (onoff(sw, "-unlink", flag /*ref*/)) {
                 m_unlink = flag;
             }
@@ -99,6 +101,10 @@ void VlcOptions::parseOptsList(int argc, char** argv) {
             } else if (!strcmp(sw, "-debugi") && (i + 1) < argc) {
                 shift;
                 V3Error::debugDefault(atoi(argv[i]));
+            } else if (!strcmp(sw, "-threads") && (i + 1) < argc) {
+                shift;
+                m_threads = atoi(argv[i]);
+                if (m_threads < 1) v3fatal("--threads must be positive: " << argv[i]);
             } else if (!strcmp(sw, "-V")) {
                 showVersion(true);
                 exit(0);
@@ -149,7 +155,10 @@ int main(int argc, char** argv, char** /*env*/) {
 
     if (top.opt.readFiles().empty()) top.opt.addReadFile("vlt_coverage.dat");
 
-    {
+    // Ranking needs each test's points, so only plain merges are parallel
+    if (top.opt.threads() > 1 && !top.opt.rank()) {
+        top.readCoverageParallel(top.opt.readFiles());
+    } else {
         const VlStringSet& readFiles = top.opt.readFiles();
         for (VlStringSet::const_iterator it = readFiles.begin(); it != readFiles.end(); ++it) {
             string filename = *it;
@@ -40,6 +40,8 @@ class VlcOptions {
     int m_annotateMin;          // main switch: --annotate-min I<count>
     VlStringSet m_readFiles;    // main switch: --read
     bool m_rank;                // main switch: --rank
+    bool m_stats;               // main switch: --stats
+    int m_threads;              // main switch: --threads
     bool m_unlink;              // main switch: --unlink
     string m_writeFile;         // main switch: --write
     // clang-format on
@@ -55,6 +57,8 @@ public:
         m_annotateAll = false;
         m_annotateMin = 10;
         m_rank = false;
+        m_stats = false;
+        m_threads = 1;
         m_unlink = false;
     }
     ~VlcOptions() {}
@@ -70,6 +74,8 @@ public:
     bool annotateAll() const { return m_annotateAll; }
     int annotateMin() const { return m_annotateMin; }
     bool rank() const { return m_rank; }
+    bool stats() const { return m_stats; }
+    int threads() const { return m_threads; }
     bool unlink() const { return m_unlink; }
     string writeFile() const { return m_writeFile; }
 
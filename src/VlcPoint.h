@@ -123,6 +123,7 @@ public:
         }
     }
     VlcPoint& pointNumber(vluint64_t num) { return m_points[num]; }
+    vluint64_t size() const { return m_numPoints; }
     vluint64_t findAddPoint(const string& name, vluint64_t count) {
         vluint64_t pointnum;
         NameMap::const_iterator iter = m_nameMap.find(name);
@@ -16,26 +16,106 @@
 
 #include "V3Error.h"
 #include "V3Os.h"
+#include "V3ThreadPool.h"
 #include "VlcOptions.h"
 #include "VlcTop.h"
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <queue>
 #include <sys/stat.h>
+#include <vector>
+#if __cplusplus >= 201103L
+# include <atomic>
+# include <functional>
+# include <thread>
+#endif
 
 //######################################################################
+// Coverage file parsing, shared by serial and parallel reading
 
-void VlcTop::readCoverage(const string& filename, bool nonfatal) {
-    UINFO(2, "readCoverage " << filename << endl);
+// Receives each point read from a coverage file
+class VlcPointSink {
+public:
+    virtual ~VlcPointSink() {}
+    virtual void point(const string& name, vluint64_t hits) = 0;
+};
 
-    std::ifstream is(filename.c_str());
-    if (!is) {
-        if (!nonfatal) v3fatal("Can't read " << filename);
-        return;
+// Read a number from a binary file, or mark the file bad if it is truncated
+static vluint64_t vlcBinaryGet(const string& data, size_t& pos, size_t size, bool& ok) {
+    if (!ok || data.size() - pos < size) {
+        ok = false;
+        return 0;
+    }
+    vluint64_t value = 0;
+    if (size == sizeof(vluint32_t)) {
+        vluint32_t value32;
+        memcpy(&value32, data.data() + pos, size);
+        value = value32;
+    } else {
+        memcpy(&value, data.data() + pos, size);
     }
+    pos += size;
+    return value;
+}
 
-    // Testrun and computrons argument unsupported as yet
-    VlcTest* testp = tests().newTest(filename, 0, 0);
+// Read a binary file from VerilatedCov::writeBinary, the magic has been read.
+// See verilated_cov.cpp for the format.  Returns false if corrupt.
+static bool vlcParseBinary(std::istream& is, VlcPointSink& sink) {
+    string data((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    size_t pos = 0;
+    bool ok = true;
+
+    const vluint64_t nstrings = vlcBinaryGet(data, pos, sizeof(vluint32_t), ok);
+    std::vector<string> strings;
+    strings.reserve(ok ? std::min<vluint64_t>(nstrings, data.size()) : 0);
+    for (vluint64_t i = 0; ok && i < nstrings; ++i) {
+        const vluint64_t len = vlcBinaryGet(data, pos, sizeof(vluint32_t), ok);
+        if (!ok || data.size() - pos < len) {
+            ok = false;
+            break;
+        }
+        strings.push_back(data.substr(pos, len));
+        pos += len;
+    }
+
+    // Names are needed as the counts follow all of them
+    const vluint64_t npoints = vlcBinaryGet(data, pos, sizeof(vluint64_t), ok);
+    std::vector<string> names;
+    names.reserve(ok ? std::min<vluint64_t>(npoints, data.size()) : 0);
+    for (vluint64_t i = 0; ok && i < npoints; ++i) {
+        const vluint64_t npairs = vlcBinaryGet(data, pos, sizeof(vluint32_t), ok);
+        string name;
+        for (vluint64_t p = 0; ok && p < npairs; ++p) {
+            const vluint64_t key = vlcBinaryGet(data, pos, sizeof(vluint32_t), ok);
+            const vluint64_t val = vlcBinaryGet(data, pos, sizeof(vluint32_t), ok);
+            if (!ok || key >= strings.size() || val >= strings.size()) {
+                ok = false;
+                break;
+            }
+            name += "\001" + strings[key] + "\002" + strings[val];
+        }
+        names.push_back(name);
+    }
+    for (vluint64_t i = 0; ok && i < npoints; ++i) {
+        const vluint64_t hits = vlcBinaryGet(data, pos, sizeof(vluint64_t), ok);
+        if (ok) sink.point(names[i], hits);
+    }
+    return ok;
+}
+
+// Read an opened coverage file, either text or binary.  Returns false if corrupt.
+static bool vlcParseCoverage(std::istream& is, VlcPointSink& sink) {
+    // Binary files from VerilatedCov::writeBinary
+    char magic[8];
+    if (is.read(magic, sizeof(magic)) && 0 == memcmp(magic, "VLCOVB01", sizeof(magic))) {
+        return vlcParseBinary(is, sink);
+    }
+    is.clear();
+    is.seekg(0);
 
     while (!is.eof()) {
         string line = V3Os::getline(is);
@@ -48,19 +128,207 @@ void VlcTop::readCoverage(const string& filename, bool nonfatal) {
             string point = line.substr(3, secspace - 3);
             vluint64_t hits = atoll(line.c_str() + secspace + 1);
             // UINFO(9,"   point '"<<point<<"'"<<" "<<hits<<endl);
+            sink.point(point, hits);
+        }
+    }
+    return true;
+}
 
-            vluint64_t pointnum = points().findAddPoint(point, hits);
-            if (pointnum) {}  // Prevent unused
-            if (opt.rank()) {  // Only if ranking - uses a lot of memory
-                if (hits >= VlcBuckets::sufficient()) {
-                    points().pointNumber(pointnum).testsCoveringInc();
-                    testp->buckets().addData(pointnum, hits);
-                }
+//######################################################################
+// Serial reading
+
+class VlcTopSink : public VlcPointSink {
+    VlcTop& m_top;
+    VlcTest* m_testp;
+
+public:
+    VlcTopSink(VlcTop& top, VlcTest* testp)
+        : m_top(top)
+        , m_testp(testp) {}
+    virtual void point(const string& name, vluint64_t hits) VL_OVERRIDE {
+        m_top.addCoverage(name, hits, m_testp);
+    }
+};
+
+void VlcTop::readCoverage(const string& filename, bool nonfatal) {
+    UINFO(2, "readCoverage " << filename << endl);
+
+    std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!is) {
+        if (!nonfatal) v3fatal("Can't read " << filename);
+        return;
+    }
+
+    // Testrun and computrons argument unsupported as yet
+    VlcTest* testp = tests().newTest(filename, 0, 0);
+
+    VlcTopSink sink(*this, testp);
+    if (!vlcParseCoverage(is, sink)) v3fatal("Corrupt binary coverage file: " << filename);
+}
+
+void VlcTop::addCoverage(const string& point, vluint64_t hits, VlcTest* testp) {
+    vluint64_t pointnum = points().findAddPoint(point, hits);
+    if (pointnum) {}  // Prevent unused
+    if (opt.rank()) {  // Only if ranking - uses a lot of memory
+        if (hits >= VlcBuckets::sufficient()) {
+            points().pointNumber(pointnum).testsCoveringInc();
+            testp->buckets().addData(pointnum, hits);
+        }
+    }
+}
+
+//######################################################################
+// Parallel reading
+//
+// Each worker thread takes the next unread file, and adds its points to
+// the worker's own table, so memory grows with the number of unique
+// points and threads, not with the number of files.  The worker tables
+// are then merged pairwise in parallel, and the result added to the
+// points in name order, so point numbers don't depend on thread timing.
+
+#if __cplusplus >= 201103L
+
+// Points merged by one worker thread
+class VlcMergeTable : public VlcPointSink {
+    typedef vl_unordered_map<string, vluint64_t> CountMap;
+    CountMap m_counts;  // Hits of each point
+
+public:
+    virtual void point(const string& name, vluint64_t hits) VL_OVERRIDE {
+        m_counts[name] += hits;
+    }
+    void merge(VlcMergeTable& other) {
+        // Add the smaller table into the larger one
+        if (other.m_counts.size() > m_counts.size()) m_counts.swap(other.m_counts);
+        for (CountMap::const_iterator it = other.m_counts.begin(); it != other.m_counts.end();
+             ++it) {
+            m_counts[it->first] += it->second;
+        }
+        CountMap().swap(other.m_counts);  // Free memory now
+    }
+    size_t size() const { return m_counts.size(); }
+    void addTo(VlcPoints& points) {
+        std::vector<CountMap::const_iterator> sorted;
+        sorted.reserve(m_counts.size());
+        for (CountMap::const_iterator it = m_counts.begin(); it != m_counts.end(); ++it) {
+            sorted.push_back(it);
+        }
+        std::sort(sorted.begin(), sorted.end(), lessName);
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            points.findAddPoint(sorted[i]->first, sorted[i]->second);
+        }
+    }
+
+private:
+    static bool lessName(const CountMap::const_iterator& a, const CountMap::const_iterator& b) {
+        return a->first < b->first;
+    }
+};
+
+// Files shared by all worker threads
+class VlcMergeFiles {
+public:
+    const std::vector<string>& m_filenames;  // Files to read
+    std::vector<string> m_errors;  // Error of each file, written by the thread reading it
+    std::atomic<size_t> m_next;  // Next file to read
+    std::atomic<size_t> m_filesDone;  // Files read, for statistics
+    std::atomic<vluint64_t> m_bytesDone;  // Bytes read, for statistics
+    explicit VlcMergeFiles(const std::vector<string>& filenames)
+        : m_filenames(filenames)
+        , m_errors(filenames.size())
+        , m_next(0)
+        , m_filesDone(0)
+        , m_bytesDone(0) {}
+};
+
+static void vlcMergeWorker(VlcMergeFiles* filesp, VlcMergeTable* tablep) {
+    while (true) {
+        const size_t i = filesp->m_next++;
+        if (i >= filesp->m_filenames.size()) break;
+        const string& filename = filesp->m_filenames[i];
+        std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+        if (!is) {
+            filesp->m_errors[i] = "Can't read " + filename;
+        } else if (!vlcParseCoverage(is, *tablep)) {
+            filesp->m_errors[i] = "Corrupt binary coverage file: " + filename;
+        }
+        struct stat sstat;
+        if (0 == stat(filename.c_str(), &sstat)) filesp->m_bytesDone += sstat.st_size;
+        ++filesp->m_filesDone;
+    }
+}
+
+static void vlcMergeStats(const VlcMergeFiles& files, vluint64_t startUsecs, bool final) {
+    const double secs = (V3Os::timeUsecs() - startUsecs) / 1.0e6;
+    const double mbytes = files.m_bytesDone / (1024.0 * 1024.0);
+    cout << (final ? "Read " : "  Reading ") << files.m_filesDone << " of "
+         << files.m_filenames.size() << " files, " << std::fixed << std::setprecision(1)
+         << mbytes << " MB in " << secs << " s";
+    if (secs > 0) cout << ", " << mbytes / secs << " MB/s";
+    cout << endl;
+}
+
+void VlcTop::readCoverageParallel(const VlStringSet& filenames) {
+    const std::vector<string> filelist(filenames.begin(), filenames.end());
+    const size_t threads = std::max<size_t>(1, std::min<size_t>(opt.threads(), filelist.size()));
+    UINFO(2, "readCoverageParallel " << filelist.size() << " files on " << threads << " threads"
+                                     << endl);
+    const vluint64_t startUsecs = V3Os::timeUsecs();
+
+    VlcMergeFiles files(filelist);
+    std::vector<VlcMergeTable> tables(threads);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) workers.emplace_back(vlcMergeWorker, &files, &tables[t]);
+    if (opt.stats()) {
+        vluint64_t lastUsecs = startUsecs;
+        while (files.m_filesDone < filelist.size()) {
+            V3Os::u_sleep(10000);
+            if (V3Os::timeUsecs() - lastUsecs >= 1000000) {
+                lastUsecs = V3Os::timeUsecs();
+                vlcMergeStats(files, startUsecs, false);
             }
         }
     }
+    for (size_t t = 0; t < threads; ++t) workers[t].join();
+
+    // Report the same error as reading in order would
+    for (size_t i = 0; i < filelist.size(); ++i) {
+        if (!files.m_errors[i].empty()) v3fatal(files.m_errors[i]);
+    }
+    // Testrun and computrons argument unsupported as yet
+    for (size_t i = 0; i < filelist.size(); ++i) tests().newTest(filelist[i], 0, 0);
+
+    // Tree reduction of the worker tables
+    for (size_t step = 1; step < tables.size(); step *= 2) {
+        std::vector<std::thread> mergers;
+        for (size_t i = 0; i + step < tables.size(); i += 2 * step) {
+            mergers.emplace_back(&VlcMergeTable::merge, &tables[i], std::ref(tables[i + step]));
+        }
+        for (size_t m = 0; m < mergers.size(); ++m) mergers[m].join();
+    }
+
+    tables[0].addTo(points());
+    if (opt.stats()) {
+        vlcMergeStats(files, startUsecs, true);
+        cout << "Merged " << points().size() << " unique points";
+        const vluint64_t memBytes = V3Os::memUsageBytes();
+        if (memBytes) cout << ", " << memBytes / (1024 * 1024) << " MB memory";
+        cout << endl;
+    }
 }
 
+#else
+
+void VlcTop::readCoverageParallel(const VlStringSet& filenames) {
+    // Threads need C++11, so read serially
+    for (VlStringSet::const_iterator it = filenames.begin(); it != filenames.end(); ++it) {
+        readCoverage(*it);
+    }
+}
+
+#endif
+
+
 void VlcTop::writeCoverage(const string& filename) {
     UINFO(2, "writeCoverage " << filename << endl);
 
@@ -88,6 +356,21 @@ struct CmpComputrons {
     }
 };
 
+// A test in the ranking queue, highest count first, then earliest by time
+struct RankEntry {
+    vluint64_t m_remain;  // Remaining points covered, exact as of ranking m_round tests
+    size_t m_index;  // Index of test ordered by time
+    vluint64_t m_round;  // Number of tests ranked when m_remain was counted
+    RankEntry(vluint64_t remain, size_t index, vluint64_t round)
+        : m_remain(remain)
+        , m_index(index)
+        , m_round(round) {}
+    bool operator<(const RankEntry& rhs) const {
+        if (m_remain != rhs.m_remain) return m_remain < rhs.m_remain;
+        return m_index > rhs.m_index;
+    }
+};
+
 void VlcTop::rank() {
     UINFO(2, "rank...\n");
     vluint64_t nextrank = 1;
@@ -109,34 +392,52 @@ void VlcTop::rank() {
         if (pointp->testsCovering()) remaining.addData(pointp->pointNum(), 1);
     }
 
-    // Additional Greedy algorithm
-    // O(n^2) Ouch.  Probably the thing to do is randomize the order of data
-    // then hierarchically solve a small subset of tests, and take resulting
-    // solution and move up to larger subset of tests.  (Aka quick sort.)
-    while (true) {
+    // Additional Greedy algorithm, evaluated lazily.  A test's remaining
+    // points can only shrink as other tests are ranked, so its last count
+    // is an upper bound.  The test with the highest bound is recounted, and
+    // is the best test if its count is still at least every other bound.
+    // Ties go to the earliest test by time, as with a full rescan.
+    std::vector<vluint64_t> remains(bytime.size());
+    rankCountAll(bytime, remaining, remains);
+    std::priority_queue<RankEntry> queue;
+    for (size_t i = 0; i < bytime.size(); ++i) {
+        if (remains[i]) queue.push(RankEntry(remains[i], i, 0));
+    }
+    while (!queue.empty()) {
         if (debug()) {
             UINFO(9, "Left on iter" << nextrank << ": ");
             remaining.dump();
         }
-        VlcTest* bestTestp = NULL;
-        vluint64_t bestRemain = 0;
-        for (std::vector<VlcTest*>::iterator it = bytime.begin(); it != bytime.end(); ++it) {
-            VlcTest* testp = *it;
-            if (!testp->rank()) {
-                vluint64_t remain = testp->buckets().dataPopCount(remaining);
-                if (remain > bestRemain) {
-                    bestTestp = testp;
-                    bestRemain = remain;
-                }
-            }
-        }
-        if (VlcTest* testp = bestTestp) {
-            testp->rank(nextrank++);
-            testp->rankPoints(bestRemain);
-            remaining.orData(bestTestp->buckets());
-        } else {
-            break;  // No test covering more stuff found
+        RankEntry entry = queue.top();
+        queue.pop();
+        if (entry.m_round != nextrank - 1) {  // Stale bound, recount
+            entry.m_remain = bytime[entry.m_index]->buckets().dataPopCount(remaining);
+            entry.m_round = nextrank - 1;
+            if (entry.m_remain) queue.push(entry);
+            continue;
         }
+        VlcTest* testp = bytime[entry.m_index];
+        testp->rank(nextrank++);
+        testp->rankPoints(entry.m_remain);
+        remaining.orData(testp->buckets());
+    }
+}
+
+void VlcTop::rankCountAll(const std::vector<VlcTest*>& tests, const VlcBuckets& remaining,
+                          std::vector<vluint64_t>& remains) {
+    // First counts of all tests, which is most of the work, so use threads
+    size_t threads = std::max(1, opt.threads());
+#if __cplusplus >= 201103L
+    threads = std::min(threads, tests.size());
+    if (threads > 1) {
+        V3ThreadPool::s().parallelFor(threads, tests.size(), [&](size_t i) {
+            remains[i] = tests[i]->buckets().dataPopCount(remaining);
+        });
+        return;
+    }
+#endif
+    for (size_t i = 0; i < tests.size(); ++i) {
+        remains[i] = tests[i]->buckets().dataPopCount(remaining);
     }
 }
 
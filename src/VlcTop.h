@@ -43,6 +43,8 @@ private:
     void annotateCalc();
     void annotateCalcNeeded();
     void annotateOutputFiles(const string& dirname);
+    void rankCountAll(const std::vector<VlcTest*>& tests, const VlcBuckets& remaining,
+                      std::vector<vluint64_t>& remains);
 
 public:
     // CONSTRUCTORS
@@ -57,6 +59,8 @@ public:
     // METHODS
     void annotate(const string& dirname);
     void readCoverage(const string& filename, bool nonfatal = false);
+    void readCoverageParallel(const VlStringSet& filenames);
+    void addCoverage(const string& point, vluint64_t hits, VlcTest* testp);
     void writeCoverage(const string& filename);
 
     void rank();
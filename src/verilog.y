@@ -276,6 +276,7 @@ class AstSenTree;
 %token<strp>		yaSCCTOR	"`systemc_implementation BLOCK"
 %token<strp>		yaSCDTOR	"`systemc_imp_header BLOCK"
 
+%token<fl>		yVLT_ASYNC                  "async"
 %token<fl>		yVLT_CLOCKER                "clocker"
 %token<fl>		yVLT_CLOCK_ENABLE           "clock_enable"
 %token<fl>		yVLT_COVERAGE_BLOCK_OFF     "coverage_block_off"
@@ -294,9 +295,12 @@ class AstSenTree;
 %token<fl>		yVLT_PUBLIC_FLAT_RD         "public_flat_rd"
 %token<fl>		yVLT_PUBLIC_FLAT_RW         "public_flat_rw"
 %token<fl>		yVLT_PUBLIC_MODULE          "public_module"
+%token<fl>		yVLT_PUBLIC_OBSERVE         "public_observe"
 %token<fl>		yVLT_SC_BV                  "sc_bv"
 %token<fl>		yVLT_SFORMAT                "sformat"
+%token<fl>		yVLT_SPARSE                 "sparse"
 %token<fl>		yVLT_SPLIT_VAR              "split_var"
+%token<fl>		yVLT_THREADSAFE             "threadsafe"
 %token<fl>		yVLT_TRACING_OFF            "tracing_off"
 %token<fl>		yVLT_TRACING_ON             "tracing_on"
 
@@ -610,6 +614,7 @@ class AstSenTree;
 %token<fl>		yD_RANDOM	"$random"
 %token<fl>		yD_READMEMB	"$readmemb"
 %token<fl>		yD_READMEMH	"$readmemh"
+%token<fl>		yD_READMEMRAW	"$readmemraw"
 %token<fl>		yD_REALTIME	"$realtime"
 %token<fl>		yD_REALTOBITS	"$realtobits"
 %token<fl>		yD_REWIND	"$rewind"
@@ -649,6 +654,7 @@ class AstSenTree;
 %token<fl>		yD_WRITEB	"$writeb"
 %token<fl>		yD_WRITEH	"$writeh"
 %token<fl>		yD_WRITEMEMH	"$writememh"
+%token<fl>		yD_WRITEMEMRAW	"$writememraw"
 %token<fl>		yD_WRITEO	"$writeo"
 
 %token<fl>		yVL_CLOCK		"/*verilator sc_clock*/"
@@ -663,12 +669,14 @@ class AstSenTree;
 %token<fl>		yVL_NO_INLINE_TASK	"/*verilator no_inline_task*/"
 %token<fl>		yVL_SC_BV		"/*verilator sc_bv*/"
 %token<fl>		yVL_SFORMAT		"/*verilator sformat*/"
+%token<fl>		yVL_SPARSE		"/*verilator sparse*/"
 %token<fl>		yVL_PARALLEL_CASE	"/*verilator parallel_case*/"
 %token<fl>		yVL_PUBLIC		"/*verilator public*/"
 %token<fl>		yVL_PUBLIC_FLAT		"/*verilator public_flat*/"
 %token<fl>		yVL_PUBLIC_FLAT_RD	"/*verilator public_flat_rd*/"
 %token<fl>		yVL_PUBLIC_FLAT_RW	"/*verilator public_flat_rw*/"
 %token<fl>		yVL_PUBLIC_MODULE	"/*verilator public_module*/"
+%token<fl>		yVL_PUBLIC_OBSERVE	"/*verilator public_observe*/"
 %token<fl>		yVL_SPLIT_VAR		"/*verilator split_var*/"
 
 %token<fl>		yP_TICK		"'"
@@ -2373,9 +2381,11 @@ sigAttr<nodep>:
 	|	yVL_PUBLIC_FLAT_RW			{ $$ = new AstAttrOf($1,AstAttrType::VAR_PUBLIC_FLAT_RW); v3Global.dpi(true); }
 	|	yVL_PUBLIC_FLAT_RW attr_event_control	{ $$ = new AstAttrOf($1,AstAttrType::VAR_PUBLIC_FLAT_RW); v3Global.dpi(true);
 							  $$ = $$->addNext(new AstAlwaysPublic($1,$2,NULL)); }
+	|	yVL_PUBLIC_OBSERVE			{ $$ = new AstAttrOf($1,AstAttrType::VAR_PUBLIC_OBSERVE); v3Global.dpi(true); }
 	|	yVL_ISOLATE_ASSIGNMENTS			{ $$ = new AstAttrOf($1,AstAttrType::VAR_ISOLATE_ASSIGNMENTS); }
 	|	yVL_SC_BV				{ $$ = new AstAttrOf($1,AstAttrType::VAR_SC_BV); }
 	|	yVL_SFORMAT				{ $$ = new AstAttrOf($1,AstAttrType::VAR_SFORMAT); }
+	|	yVL_SPARSE				{ $$ = new AstAttrOf($1,AstAttrType::VAR_SPARSE); }
 	|	yVL_SPLIT_VAR				{ $$ = new AstAttrOf($1,AstAttrType::VAR_SPLIT_VAR); }
 	;
 
@@ -3353,10 +3363,16 @@ system_t_call<nodep>:		// IEEE: system_tf_call (as task)
 	|	yD_READMEMH '(' expr ',' idClassSel ')'				{ $$ = new AstReadMem($1,true, $3,$5,NULL,NULL); }
 	|	yD_READMEMH '(' expr ',' idClassSel ',' expr ')'		{ $$ = new AstReadMem($1,true, $3,$5,$7,NULL); }
 	|	yD_READMEMH '(' expr ',' idClassSel ',' expr ',' expr ')'	{ $$ = new AstReadMem($1,true, $3,$5,$7,$9); }
+	|	yD_READMEMRAW '(' expr ',' idClassSel ')'			{ $$ = new AstReadMem($1,false,$3,$5,NULL,NULL,true); }
+	|	yD_READMEMRAW '(' expr ',' idClassSel ',' expr ')'		{ $$ = new AstReadMem($1,false,$3,$5,$7,NULL,true); }
+	|	yD_READMEMRAW '(' expr ',' idClassSel ',' expr ',' expr ')'	{ $$ = new AstReadMem($1,false,$3,$5,$7,$9,true); }
 	//
 	|	yD_WRITEMEMH '(' expr ',' idClassSel ')'			{ $$ = new AstWriteMem($1,$3,$5,NULL,NULL); }
 	|	yD_WRITEMEMH '(' expr ',' idClassSel ',' expr ')'		{ $$ = new AstWriteMem($1,$3,$5,$7,NULL); }
 	|	yD_WRITEMEMH '(' expr ',' idClassSel ',' expr ',' expr ')'	{ $$ = new AstWriteMem($1,$3,$5,$7,$9); }
+	|	yD_WRITEMEMRAW '(' expr ',' idClassSel ')'			{ $$ = new AstWriteMem($1,$3,$5,NULL,NULL,true); }
+	|	yD_WRITEMEMRAW '(' expr ',' idClassSel ',' expr ')'		{ $$ = new AstWriteMem($1,$3,$5,$7,NULL,true); }
+	|	yD_WRITEMEMRAW '(' expr ',' idClassSel ',' expr ',' expr ')'	{ $$ = new AstWriteMem($1,$3,$5,$7,$9,true); }
 	//
 	// Any system function as a task
 	|	system_f_call_or_t			{ $$ = new AstSysFuncAsTask($<fl>1, $1); }
@@ -5839,6 +5855,10 @@ vltItem:
 			{ V3Config::addVarAttr($<fl>1, *$2, *$3, *$4, $1, $5); }
 	|	vltInlineFront vltDModuleE vltDFTaskE
 			{ V3Config::addInline($<fl>1, *$2, *$3, $1); }
+	|	yVLT_THREADSAFE vltDModuleE vltDFTaskE
+			{ V3Config::addThreadsafe($1, *$2, *$3); }
+	|	yVLT_ASYNC vltDModuleE vltDFTaskE
+			{ V3Config::addAsync($1, *$2, *$3); }
 	|	yVLT_COVERAGE_BLOCK_OFF yVLT_D_FILE yaSTRING
 			{ V3Config::addCoverageBlockOff(*$3, 0); }
 	|	yVLT_COVERAGE_BLOCK_OFF yVLT_D_FILE yaSTRING yVLT_D_LINES yaINTNUM
@@ -5911,8 +5931,10 @@ vltVarAttrFront<attrtypeen>:
 	|	yVLT_PUBLIC_FLAT            { $$ = AstAttrType::VAR_PUBLIC_FLAT; v3Global.dpi(true); }
 	|	yVLT_PUBLIC_FLAT_RD         { $$ = AstAttrType::VAR_PUBLIC_FLAT_RD; v3Global.dpi(true); }
 	|	yVLT_PUBLIC_FLAT_RW         { $$ = AstAttrType::VAR_PUBLIC_FLAT_RW; v3Global.dpi(true); }
+	|	yVLT_PUBLIC_OBSERVE         { $$ = AstAttrType::VAR_PUBLIC_OBSERVE; v3Global.dpi(true); }
 	|	yVLT_SC_BV                  { $$ = AstAttrType::VAR_SC_BV; }
 	|	yVLT_SFORMAT                { $$ = AstAttrType::VAR_SFORMAT; }
+	|	yVLT_SPARSE                 { $$ = AstAttrType::VAR_SPARSE; }
 	|	yVLT_SPLIT_VAR              { $$ = AstAttrType::VAR_SPLIT_VAR; }
 	;
 
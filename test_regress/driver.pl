@@ -838,8 +838,10 @@ sub compile_vlt_flags {
                           @{$param{verilator_flags3}});
     $self->{sc} = 1 if ($checkflags =~ /-sc\b/);
     $self->{trace} = ($opt_trace || $checkflags =~ /-trace\b/
-                      || $checkflags =~ /-trace-fst\b/);
+                      || $checkflags =~ /-trace-fst\b/
+                      || $checkflags =~ /-trace-vbt\b/);
     $self->{trace_format} = (($checkflags =~ /-trace-fst/ && 'fst-c')
+                             || ($checkflags =~ /-trace-vbt/ && 'vbt-c')
                              || ($self->{sc} && 'vcd-sc')
                              || (!$self->{sc} && 'vcd-c'));
     $self->{savable} = 1 if ($checkflags =~ /-savable\b/);
@@ -1404,6 +1406,7 @@ sub cmake_version {
 sub trace_filename {
     my $self = shift;
     return "$self->{obj_dir}/simx.fst" if $self->{trace_format} =~ /^fst/;
+    return "$self->{obj_dir}/simx.vbt" if $self->{trace_format} =~ /^vbt/;
     return "$self->{obj_dir}/simx.vcd";
 }
 
@@ -1632,6 +1635,7 @@ sub _make_main {
     print $fh "#include \"verilated.h\"\n";
     print $fh "#include \"systemc.h\"\n" if $self->sc;
     print $fh "#include \"verilated_fst_c.h\"\n" if $self->{trace} && $self->{trace_format} eq 'fst-c';
+    print $fh "#include \"verilated_vbt_c.h\"\n" if $self->{trace} && $self->{trace_format} eq 'vbt-c';
     print $fh "#include \"verilated_vcd_c.h\"\n" if $self->{trace} && $self->{trace_format} eq 'vcd-c';
     print $fh "#include \"verilated_vcd_sc.h\"\n" if $self->{trace} && $self->{trace_format} eq 'vcd-sc';
     print $fh "#include \"verilated_save.h\"\n" if $self->{savable};
@@ -1702,6 +1706,7 @@ sub _make_main {
         $fh->print("#if VM_TRACE\n");
         $fh->print("    Verilated::traceEverOn(true);\n");
         $fh->print("    VerilatedFstC* tfp = new VerilatedFstC;\n") if $self->{trace_format} eq 'fst-c';
+        $fh->print("    VerilatedVbtC* tfp = new VerilatedVbtC;\n") if $self->{trace_format} eq 'vbt-c';
         $fh->print("    VerilatedVcdC* tfp = new VerilatedVcdC;\n") if $self->{trace_format} eq 'vcd-c';
         $fh->print("    VerilatedVcdSc* tfp = new VerilatedVcdSc;\n") if $self->{trace_format} eq 'vcd-sc';
         $fh->print("    topp->trace(tfp, 99);\n");
@@ -0,0 +1,55 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc = 0;
+   reg [63:0] crc = 64'h5aef0c8d_d70a4497;
+
+   // Busy bank, loaded every cycle
+   reg [31:0] busy = 32'h0;
+   // Idle bank, loaded only every 16th cycle
+   reg [31:0] idle = 32'h0;
+
+   function [31:0] f_busy(input [31:0] in);
+      f_busy = in ^ {in[15:0], in[31:16]};
+      if (in[0]) f_busy = f_busy + 32'h1234;
+   endfunction
+   function [31:0] f_idle(input [31:0] in);
+      f_idle = in * 32'd3;
+      case (in[1:0])
+        2'd0: f_idle = f_idle ^ 32'h0f0f;
+        2'd1: f_idle = f_idle + {in[7:0], in[31:8]};
+        default: f_idle = ~f_idle;
+      endcase
+   endfunction
+
+   reg [31:0] busy_f;
+   reg [31:0] idle_f;
+   always @* busy_f = f_busy(busy);
+   always @* idle_f = f_idle(idle);
+
+   always @ (posedge clk) begin
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc==%0d busy_f=%x idle_f=%x\n", $time, cyc, busy_f, idle_f);
+`endif
+      // Gated logic must match the values recomputed from its inputs
+      if (busy_f !== f_busy(busy)) $stop;
+      if (idle_f !== f_idle(idle)) $stop;
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+      busy <= crc[31:0];
+      if (cyc[3:0] == 4'd0) idle <= crc[63:32];
+      if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,43 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc; initial cyc=1;
+
+   reg [15:0] m_din;
+   reg [15:0] last_din;
+
+   // Split into three blocks, each computing its own copy of tmp
+   reg [15:0] tmp;
+   reg [15:0] x1, x2, x3;
+   always @ (posedge clk) begin
+      tmp = m_din ^ 16'h1234;
+      x1 <= tmp + 16'h1;
+      x2 <= {tmp[7:0], tmp[15:8]};
+      if (tmp[0]) x3 <= tmp;
+      else x3 <= ~tmp;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      m_din <= cyc[15:0] * 16'h3f1;
+      last_din <= m_din;
+      if (cyc > 3) begin
+         if (x1 != ((last_din ^ 16'h1234) + 16'h1)) $stop;
+         if (x2 != {last_din[7:0] ^ 8'h34, last_din[15:8] ^ 8'h12}) $stop;
+         if (x3 != (last_din[0] ? (last_din ^ 16'h1234) : ~(last_din ^ 16'h1234))) $stop;
+      end
+      if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
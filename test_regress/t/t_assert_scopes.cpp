@@ -0,0 +1,50 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include VM_PREFIX_INCLUDE
+#include "verilated.h"
+
+double main_time = 0;
+double sc_time_stamp() { return main_time; }
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+
+    VM_PREFIX* topp = new VM_PREFIX("top");
+
+    if (Verilated::assertScopeOn("top.t.b", false) != 1) {
+        Verilated::scopesDump();
+        vl_fatal(__FILE__, __LINE__, "main", "No scope top.t.b");
+    }
+    if (Verilated::assertScopeOn("top.t.nomatch*", false) != 0) {
+        vl_fatal(__FILE__, __LINE__, "main", "Matched top.t.nomatch*");
+    }
+    // Disabling covers leaves assertions on
+    if (Verilated::coverScopeOn("top.t.?", false) != 2) {
+        vl_fatal(__FILE__, __LINE__, "main", "Didn't match top.t.?");
+    }
+
+    topp->clk = 0;
+    topp->eval();
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+        main_time += 1;
+        topp->clk = !topp->clk;
+        topp->eval();
+    }
+    if (!Verilated::gotFinish()) {
+        vl_fatal(__FILE__, __LINE__, "main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+
+    VL_DO_DANGLING(delete topp, topp);
+    exit(0L);
+}
@@ -0,0 +1,35 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+
+   sub a (.clk, .cyc);
+   sub b (.clk, .cyc);
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 10) begin
+         // Main turned off only b's assertions
+         if (a.fails == 0) $stop;
+         if (b.fails != 0) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+module sub (input clk, input integer cyc);
+   integer fails = 0;
+   always @ (posedge clk) begin
+      assert (cyc[0] == 1'b0) else fails <= fails + 1;
+   end
+endmodule
@@ -0,0 +1,30 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(simulator => 1);
+
+compile(
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+if ($Self->{vlt_all}) {
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h",
+              qr/VlAssocHashArray<QData, IData>\s+t__DOT__scoreboard;/);
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h",
+              qr/VlAssocHashArray<std::string, IData>\s+t__DOT__names;/);
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h",
+              qr/VlAssocArray<IData, IData>\s+t__DOT__ordered;/);
+}
+
+ok(1);
+1;
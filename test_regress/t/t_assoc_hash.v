@@ -0,0 +1,73 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+`define checkh(gotv,expv) do if ((gotv) !== (expv)) begin $write("%%Error: %s:%0d:  got='h%x exp='h%x\n", `__FILE__,`__LINE__, (gotv), (expv)); $stop; end while(0);
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+
+   // Only selected, sized, tested and deleted: unordered
+   int scoreboard [longint unsigned];
+   int names [string];
+   // Iterated: ordered
+   int ordered [int];
+
+   int     i;
+   int     k;
+   longint unsigned addr;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 0) begin
+         // Many entries so the table grows and deletes shift entries
+         for (i = 0; i < 5000; i = i + 1) begin
+            addr = 64'h1000_0000_0000 + ({32'b0, i} << 6);
+            scoreboard[addr] = i;
+         end
+         `checkh(scoreboard.size(), 5000);
+         for (i = 0; i < 5000; i = i + 2) begin
+            addr = 64'h1000_0000_0000 + ({32'b0, i} << 6);
+            scoreboard.delete(addr);
+         end
+         `checkh(scoreboard.num(), 2500);
+         for (i = 0; i < 5000; i = i + 1) begin
+            addr = 64'h1000_0000_0000 + ({32'b0, i} << 6);
+            `checkh(scoreboard.exists(addr), i % 2);
+            if (i % 2 == 1) `checkh(scoreboard[addr], i);
+         end
+         // Missing entry reads as default, but isn't created
+         `checkh(scoreboard[64'h5], 0);
+         `checkh(scoreboard.size(), 2500);
+         scoreboard[64'h5] += 3;
+         `checkh(scoreboard[64'h5], 3);
+         scoreboard.delete();
+         `checkh(scoreboard.size(), 0);
+
+         names["alpha"] = 1;
+         names["beta"] = 2;
+         names["alpha"] = names["alpha"] + 10;
+         `checkh(names["alpha"], 11);
+         `checkh(names.exists("gamma"), 0);
+         `checkh(names.size(), 2);
+
+         ordered[30] = 3;
+         ordered[10] = 1;
+         ordered[20] = 2;
+         i = ordered.first(k); `checkh(k, 10);
+         i = ordered.next(k); `checkh(k, 20);
+         i = ordered.last(k); `checkh(k, 30);
+      end
+      else if (cyc == 1) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
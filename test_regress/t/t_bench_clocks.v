@@ -0,0 +1,46 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Benchmark of many clock domains; also run by nodist/verilator_bench
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+`ifdef TEST_BENCHMARK
+   localparam CYCLES = `TEST_BENCHMARK;
+`else
+   localparam CYCLES = 100;
+`endif
+
+   integer cyc = 0;
+   reg [7:0] div = 8'h0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      div <= div + 8'h1;
+      if (cyc == CYCLES) begin
+         $write("[%0t] cnt=%x %x %x %x %x %x %x %x\n", $time,
+                g[0].cnt, g[1].cnt, g[2].cnt, g[3].cnt,
+                g[4].cnt, g[5].cnt, g[6].cnt, g[7].cnt);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+
+   // Each bit of the divider clocks its own domain, on both edges
+   genvar i;
+   generate
+      for (i = 0; i < 8; i = i + 1) begin : g
+         reg [31:0] cnt = 32'h0;
+         reg [31:0] ncnt = 32'h0;
+         always @ (posedge div[i]) cnt <= cnt + ncnt + i + 1;
+         always @ (negedge div[i]) ncnt <= {ncnt[30:0], ncnt[31]} ^ cnt;
+      end
+   endgenerate
+endmodule
@@ -0,0 +1,59 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Benchmark of a deep hierarchy; also run by nodist/verilator_bench
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+`ifdef TEST_BENCHMARK
+   localparam CYCLES = `TEST_BENCHMARK;
+`else
+   localparam CYCLES = 100;
+`endif
+
+   integer cyc = 0;
+   reg [31:0] seed = 32'h5aef0c8d;
+   wire [31:0] out;
+
+   node #(.DEPTH(7)) root (.clk(clk), .in(seed), .out(out));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      seed <= {seed[30:0], seed[31] ^ seed[21] ^ seed[1] ^ seed[0]};
+      if (cyc == CYCLES) begin
+         $write("[%0t] out=%x\n", $time, out);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+// Binary tree of instances, 2**DEPTH leaves
+module node #(parameter DEPTH = 0)
+   (input clk,
+    input [31:0] in,
+    output [31:0] out);
+
+   reg [31:0] r = 32'h0;
+   assign out = r;
+
+   generate
+      if (DEPTH == 0) begin : leaf
+         always @ (posedge clk) r <= {in[7:0], in[31:8]} + 32'h9e3779b9;
+      end
+      else begin : branch
+         wire [31:0] a;
+         wire [31:0] b;
+         node #(.DEPTH(DEPTH - 1)) left (.clk(clk), .in(in ^ 32'h1), .out(a));
+         node #(.DEPTH(DEPTH - 1)) right (.clk(clk), .in(in + 32'h3), .out(b));
+         always @ (posedge clk) r <= a ^ {b[15:0], b[31:16]};
+      end
+   endgenerate
+endmodule
@@ -0,0 +1,47 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Benchmark of large memories; also run by nodist/verilator_bench
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+`ifdef TEST_BENCHMARK
+   localparam CYCLES = `TEST_BENCHMARK;
+`else
+   localparam CYCLES = 100;
+`endif
+
+   integer cyc = 0;
+   reg [15:0] waddr = 16'h1234;
+   reg [15:0] raddr = 16'h4321;
+   reg [31:0] rdata = 32'h0;
+   reg [63:0] rwide = 64'h0;
+   reg [31:0] sum = 32'h0;
+
+   reg [31:0] mem [0:65535];
+   reg [63:0] mwide [0:16383];
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      // Pseudo-random addresses, so accesses have little locality
+      waddr <= waddr * 16'd25173 + 16'd13849;
+      raddr <= raddr * 16'd20077 + 16'd12345;
+      mem[waddr] <= {waddr, raddr} ^ sum;
+      mwide[waddr[13:0]] <= {sum, rdata} + rwide;
+      rdata <= mem[raddr];
+      rwide <= mwide[raddr[15:2]];
+      sum <= sum + rdata + rwide[63:32];
+      if (cyc == CYCLES) begin
+         $write("[%0t] sum=%x\n", $time, sum);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,40 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Benchmark of wide datapath operations; also run by nodist/verilator_bench
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+`ifdef TEST_BENCHMARK
+   localparam CYCLES = `TEST_BENCHMARK;
+`else
+   localparam CYCLES = 100;
+`endif
+
+   integer cyc = 0;
+   reg [511:0] lfsr = {16{32'h5aef0c8d}};
+   reg [511:0] acc = 512'h0;
+   reg [127:0] prod = 128'h0;
+
+   wire [511:0] mixed = {lfsr[255:0], lfsr[511:256]} ^ (lfsr << 7) ^ (lfsr >> 13);
+   wire [511:0] masked = (acc & ~mixed) | (~acc & mixed);
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      lfsr <= {lfsr[510:0], lfsr[511] ^ lfsr[509] ^ lfsr[508] ^ lfsr[505]};
+      prod <= {64'h0, lfsr[63:0]} * {64'h0, acc[127:64]};
+      acc <= acc + masked + {384'h0, prod} - {lfsr[0 +: 256], lfsr[256 +: 256]};
+      if (cyc == CYCLES) begin
+         $write("[%0t] acc=%x\n", $time, acc[63:0]);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,53 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [63:0] crc;
+   reg [127:0] a;
+   reg [127:0] b;
+   reg [127:0] sel_cond;
+   reg [127:0] sel_if;
+   reg [63:0] crc_d1;
+   reg [127:0] a_d1;
+   reg [127:0] b_d1;
+
+   always @ (posedge clk) begin
+      sel_cond <= crc[0] ? a : b;
+      if (crc[1]) sel_if <= b;
+      else sel_if <= a;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+      a <= {crc, ~crc};
+      b <= {~crc, crc};
+      if (cyc == 0) begin
+         crc <= 64'h5aef0c8d_d70a4497;
+      end
+      else if (cyc > 3 && cyc < 90) begin
+         // Check the values chosen from the previous cycle's inputs
+         if (sel_cond !== (crc_d1[0] ? a_d1 : b_d1)) $stop;
+         if (sel_if !== (crc_d1[1] ? b_d1 : a_d1)) $stop;
+      end
+      else if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+
+   always @ (posedge clk) begin
+      crc_d1 <= crc;
+      a_d1 <= a;
+      b_d1 <= b;
+   end
+endmodule
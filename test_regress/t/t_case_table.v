@@ -0,0 +1,72 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+
+   integer cyc = 0;
+   reg [4:0] op;
+
+   // Decoder that only sets constants, so becomes a lookup table
+   reg [7:0] dec_a;
+   reg [4:0] dec_b;
+   always @* begin
+      case (op)
+        5'd0: begin dec_a = 8'h0b; dec_b = 5'h15; end
+        5'd1: begin dec_a = 8'h30; dec_b = 5'h14; end
+        5'd2: begin dec_a = 8'h55; dec_b = 5'h17; end
+        5'd3: begin dec_a = 8'h7a; dec_b = 5'h16; end
+        5'd4: begin dec_a = 8'h9f; dec_b = 5'h11; end
+        5'd5: begin dec_a = 8'hc4; dec_b = 5'h10; end
+        5'd6: begin dec_a = 8'he9; dec_b = 5'h13; end
+        5'd7: begin dec_a = 8'h0e; dec_b = 5'h12; end
+        5'd8: begin dec_a = 8'h33; dec_b = 5'h1d; end
+        5'd9: begin dec_a = 8'h58; dec_b = 5'h1c; end
+        5'd10: begin dec_a = 8'h7d; dec_b = 5'h1f; end
+        5'd11: begin dec_a = 8'ha2; dec_b = 5'h1e; end
+        5'd12: begin dec_a = 8'hc7; dec_b = 5'h19; end
+        5'd13: begin dec_a = 8'hec; dec_b = 5'h18; end
+        5'd14: begin dec_a = 8'h11; dec_b = 5'h1b; end
+        5'd15: begin dec_a = 8'h36; dec_b = 5'h1a; end
+        5'd16: begin dec_a = 8'h5b; dec_b = 5'h05; end
+        5'd17: begin dec_a = 8'h80; dec_b = 5'h04; end
+        5'd18: begin dec_a = 8'ha5; dec_b = 5'h07; end
+        5'd19: begin dec_a = 8'hca; dec_b = 5'h06; end
+        5'd20: begin dec_a = 8'hef; dec_b = 5'h01; end
+        5'd21: begin dec_a = 8'h14; dec_b = 5'h00; end
+        5'd22: begin dec_a = 8'h39; dec_b = 5'h03; end
+        5'd23: begin dec_a = 8'h5e; dec_b = 5'h02; end
+        5'd24: begin dec_a = 8'h83; dec_b = 5'h0d; end
+        5'd25: begin dec_a = 8'ha8; dec_b = 5'h0c; end
+        5'd26: begin dec_a = 8'hcd; dec_b = 5'h0f; end
+        5'd27: begin dec_a = 8'hf2; dec_b = 5'h0e; end
+        5'd28: begin dec_a = 8'h17; dec_b = 5'h09; end
+        5'd29: begin dec_a = 8'h3c; dec_b = 5'h08; end
+        5'd30: begin dec_a = 8'h61; dec_b = 5'h0b; end
+        5'd31: begin dec_a = 8'h86; dec_b = 5'h0a; end
+      endcase
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      op <= op + 5'd7;
+      if (cyc == 0) begin
+         op <= 5'd0;
+      end
+      else if (cyc < 99) begin
+         if (dec_a !== op * 8'd37 + 8'd11) $stop;
+         if (dec_b !== (op ^ 5'h15)) $stop;
+      end
+      else begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
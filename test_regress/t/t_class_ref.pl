@@ -0,0 +1,32 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(simulator => 1);
+
+compile(
+    );
+
+if ($Self->{vlt_all}) {
+    # Objects must come from the class pools, with intrusive counts
+    my $text = "";
+    foreach my $file (glob("$Self->{obj_dir}/*.cpp"), glob("$Self->{obj_dir}/*.h")) {
+        $text .= file_contents($file);
+    }
+    $text =~ /VL_NEW</ or error("No VL_NEW found in generated code");
+    $text =~ /: public VlClass\b/ or error("No class derived from VlClass");
+    $text !~ /std::make_shared/ or error("Generated code still uses std::make_shared");
+}
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,46 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+class Txn;
+   int data;
+   Txn next;
+endclass
+
+module t (/*AUTOARG*/);
+   initial begin
+      Txn head;
+      Txn t;
+      Txn keep;
+      int sum;
+      // Build and drop many objects, so freed objects are reused
+      for (int i = 0; i < 1000; i++) begin
+         t = new;
+         t.data = i;
+         t.next = head;
+         head = t;
+         if (i == 500) keep = t;
+         if (i % 100 == 99) head = null;
+      end
+      if (keep == null) $stop;
+      if (keep.data != 500) $stop;
+      if (keep.next.data != 499) $stop;
+      // Shallow copy shares the members' objects
+      t = new keep;
+      if (t == keep) $stop;
+      if (t.next != keep.next) $stop;
+      t.data = 1;
+      if (keep.data != 500) $stop;
+      sum = 0;
+      for (t = keep; t != null; t = t.next) sum += t.data;
+      if (sum != 45450) $stop;
+      t = null;
+      keep = null;
+      head = null;
+      if (t != null) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
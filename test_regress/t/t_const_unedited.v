@@ -0,0 +1,35 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [7:0] a = 0;
+   reg [7:0] b = 0;
+   wire [7:0] c = (a & 8'hf0) | (b & 8'h0f);
+
+   sub sub (.clk(clk), .in(c));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= a + 8'h11;
+      b <= b ^ 8'h5a;
+      if (cyc == 9) begin
+         if (c !== 8'h9a) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+module sub (input clk, input [7:0] in);
+   reg [7:0] last = 0;
+   always @ (posedge clk) last <= in + 8'd1 + 8'd2;
+endmodule
@@ -0,0 +1,50 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test driver/expect definition
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+#include <verilated.h>
+#include <cstdio>
+#include "Vt_context_destroy.h"
+
+// Unused, as the model has its own time
+double sc_time_stamp() { return 0; }
+
+static void runModel(bool deleteModelFirst) {
+    VerilatedContext* contextp = new VerilatedContext;
+    Vt_context_destroy* topp = new Vt_context_destroy;
+    topp->contextp(contextp);
+    topp->limit = 10;
+    topp->clk = 0;
+    topp->eval();
+    while (!contextp->gotFinish()) {
+        contextp->timeInc(1);
+        topp->clk = !topp->clk;
+        topp->eval();
+    }
+    if (!Verilated::gotFinish()) vl_fatal(__FILE__, __LINE__, "", "No $finish via context");
+    topp->final();
+    if (deleteModelFirst) {
+        delete topp;
+        delete contextp;
+    } else {
+        delete contextp;
+        delete topp;
+    }
+    // Must not use the deleted context
+    if (Verilated::threadContextp()) vl_fatal(__FILE__, __LINE__, "", "Context left set");
+    if (Verilated::gotFinish()) vl_fatal(__FILE__, __LINE__, "", "$finish not per context");
+    if (Verilated::errorCount()) vl_fatal(__FILE__, __LINE__, "", "Errors not per context");
+}
+
+int main(int argc, char** argv, char** env) {
+    runModel(false);
+    runModel(true);
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
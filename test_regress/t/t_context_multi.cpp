@@ -0,0 +1,64 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test driver/expect definition
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+#include <verilated.h>
+#include <cstdio>
+#include <thread>
+#include "Vt_context_multi.h"
+
+// Unused, as each model has its own time
+double sc_time_stamp() { return 0; }
+
+static const int MODELS = 4;
+
+static vluint32_t s_rnds[MODELS];
+static vluint64_t s_finishedAt[MODELS];
+static vluint64_t s_times[MODELS];
+
+static void runModel(int index) {
+    VerilatedContext context;
+    context.randSeed(index < 2 ? 5 : 7);
+    Vt_context_multi* topp = new Vt_context_multi;
+    topp->contextp(&context);
+    topp->limit = 100 + 10 * index;
+    topp->clk = 0;
+    topp->eval();
+    while (!context.gotFinish()) {
+        context.timeInc(1);
+        topp->clk = !topp->clk;
+        topp->eval();
+        if (context.time() == 50) s_rnds[index] = topp->rnd;
+    }
+    topp->final();
+    s_finishedAt[index] = topp->finished_at;
+    s_times[index] = context.time();
+    delete topp;
+}
+
+int main(int argc, char** argv, char** env) {
+    std::thread threads[MODELS];
+    for (int i = 0; i < MODELS; ++i) threads[i] = std::thread(runModel, i);
+    for (int i = 0; i < MODELS; ++i) threads[i].join();
+
+    for (int i = 0; i < MODELS; ++i) {
+        const vluint64_t limit = 100 + 10 * i;
+        if (s_finishedAt[i] < limit || s_finishedAt[i] > limit + 1
+            || s_finishedAt[i] != s_times[i]) {
+            vl_fatal(__FILE__, __LINE__, "", "Model did not finish at its own time");
+        }
+    }
+    // Same seeds give the same numbers
+    if (s_rnds[0] != s_rnds[1] || s_rnds[2] != s_rnds[3] || s_rnds[0] == s_rnds[2]) {
+        vl_fatal(__FILE__, __LINE__, "", "Random seeds not per context");
+    }
+    if (Verilated::gotFinish()) vl_fatal(__FILE__, __LINE__, "", "$finish not per context");
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
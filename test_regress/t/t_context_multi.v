@@ -0,0 +1,24 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   rnd, finished_at,
+   // Inputs
+   clk, limit
+   );
+   input clk;
+   input [63:0] limit;
+   output reg [31:0] rnd = 0;
+   output reg [63:0] finished_at = 0;
+
+   always @(posedge clk) begin
+      rnd <= rnd ^ $random;
+      if ($time >= limit) begin
+         finished_at = $time;
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,95 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test driver/expect definition
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+#include <verilated.h>
+#include <verilated_cosim.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Vt_cosim.h"
+
+double sc_time_stamp() { return 0; }
+
+static const int CYCLES = 100;
+
+// Two copies of the model pass values back and forth, each adding one.
+// Side A uses the generated port list; side B crosses its ports over by name.
+static int runSide(bool sideA, const char* transport, const std::string& where, int lookahead) {
+    Vt_cosim* topp = new Vt_cosim;
+    VerilatedCosimLink link;
+    if (sideA) {
+        topp->cosimPorts(link);
+    } else {
+        link.addOutput("ping", &topp->pong, 32);
+        link.addOutput("win", &topp->wout, 100);
+        link.addInput("pong", &topp->ping, 32);
+        link.addInput("wout", &topp->win, 100);
+    }
+    link.lookahead(lookahead);
+    if (std::string(transport) == "shm") {
+        link.openShm(where.c_str(), sideA);
+    } else if (sideA) {
+        link.listenTcp(atoi(where.c_str()));
+    } else {
+        link.connectTcp("127.0.0.1", atoi(where.c_str()));
+    }
+
+    // Expected output after each exchange: out[k] = out[k - 1 - lookahead] + 1
+    std::vector<vluint32_t> expect;
+    topp->clk = 0;
+    topp->eval();
+    for (int cycle = 0; cycle < CYCLES; ++cycle) {
+        topp->runCycles(topp->clk, 1);
+        const int from = cycle - 1 - lookahead;
+        expect.push_back(from < 0 ? 1 : expect[from] + 1);
+        if (topp->pong != expect.back() || topp->wout[0] != expect.back()) {
+            printf("%%Error: %s side %c cycle %d: pong %u wout %u, expected %u\n", transport,
+                   sideA ? 'A' : 'B', cycle, topp->pong, topp->wout[0], expect.back());
+            return 1;
+        }
+        if (!link.exchange()) {
+            printf("%%Error: %s side %c cycle %d: partner closed\n", transport,
+                   sideA ? 'A' : 'B', cycle);
+            return 1;
+        }
+    }
+    if (link.exchanges() != CYCLES) return 1;
+    link.close();
+    topp->final();
+    delete topp;
+    return 0;
+}
+
+static int runPair(const char* transport, const std::string& where, int lookahead) {
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) _exit(runSide(false, transport, where, lookahead));
+    const int err = runSide(true, transport, where, lookahead);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (err || !WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+    printf("%s lookahead %d: ok\n", transport, lookahead);
+    return 0;
+}
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    const std::string shmFile = std::string(VL_STRINGIFY(TEST_OBJ_DIR)) + "/cosim";
+    char port[20];
+    sprintf(port, "%d", 20000 + static_cast<int>(getpid() % 20000));
+    if (runPair("shm", shmFile + "0.shm", 0)) return 1;
+    if (runPair("shm", shmFile + "3.shm", 3)) return 1;
+    if (runPair("tcp", port, 0)) return 1;
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
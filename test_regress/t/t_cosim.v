@@ -0,0 +1,22 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   pong, wout,
+   // Inputs
+   clk, ping, win
+   );
+   input clk;
+   input [31:0] ping;
+   input [99:0] win;
+   output reg [31:0] pong = 0;
+   output reg [99:0] wout = 0;
+
+   always @(posedge clk) begin
+      pong <= ping + 1;
+      wout <= win + 1;
+   end
+endmodule
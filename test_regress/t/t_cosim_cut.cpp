@@ -0,0 +1,71 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test driver/expect definition
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+#include <verilated.h>
+#include <verilated_cosim.h>
+#include <cstdio>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Vt_cosim_cut.h"
+
+double sc_time_stamp() { return 0; }
+
+static const int CYCLES = 100;
+
+// Stands in for the cut instance's own model, which would call
+// cosimPorts(link, "u_sub__"); as u_sub, out is in plus one
+static int runPartition(const std::string& filename) {
+    vluint32_t in = 0;
+    vluint32_t out = 0;
+    VerilatedCosimLink link;
+    link.addInput("u_sub__in", &in, 32);
+    link.addOutput("u_sub__out", &out, 32);
+    link.openShm(filename.c_str(), false);
+    for (int cycle = 0; cycle < CYCLES; ++cycle) {
+        if (!link.exchange()) return 1;
+        out = in + 1;
+    }
+    link.close();
+    return 0;
+}
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    const std::string filename = std::string(VL_STRINGIFY(TEST_OBJ_DIR)) + "/cosim.shm";
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) _exit(runPartition(filename));
+
+    Vt_cosim_cut* topp = new Vt_cosim_cut;
+    VerilatedCosimLink link;
+    topp->cosimPorts(link);
+    link.openShm(filename.c_str(), true);
+    topp->clk = 0;
+    topp->eval();
+    for (int cycle = 0; cycle < CYCLES; ++cycle) {
+        topp->runCycles(topp->clk, 1);
+        // The result is u_sub's output from the batch of the cycle before
+        const vluint32_t expect = cycle >= 2 ? cycle : 0;
+        if (topp->result != expect) {
+            printf("%%Error: cycle %d: result %u, expected %u\n", cycle, topp->result, expect);
+            return 1;
+        }
+        if (!link.exchange()) return 1;
+    }
+    link.close();
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+    topp->final();
+    delete topp;
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
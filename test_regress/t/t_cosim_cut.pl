@@ -0,0 +1,27 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--exe --cosim-cut u_sub $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/VL_OUT\(u_sub__in,31,0\);/);
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/VL_IN\(u_sub__out,31,0\);/);
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
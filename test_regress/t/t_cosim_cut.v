@@ -0,0 +1,33 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   result,
+   // Inputs
+   clk
+   );
+   input clk;
+   output [31:0] result;
+
+   reg [31:0] cnt = 0;
+   always @(posedge clk) cnt <= cnt + 1;
+
+   // Cut by --cosim-cut, simulated by the partner process
+   sub u_sub (.clk(clk), .in(cnt), .out(result));
+endmodule
+
+module sub (/*AUTOARG*/
+   // Outputs
+   out,
+   // Inputs
+   clk, in
+   );
+   input clk;
+   input [31:0] in;
+   output reg [31:0] out = 0;
+
+   always @(posedge clk) out <= in + 1;
+endmodule
@@ -0,0 +1,45 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_cover_line.v");
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--coverage-line --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+run(cmd => ["../bin/verilator_coverage",
+            "--annotate", "$Self->{obj_dir}/annotated",
+            "$Self->{obj_dir}/coverage.bin",
+    ]);
+
+files_identical("$Self->{obj_dir}/annotated/t_cover_line.v", "t/t_cover_line.out");
+
+# Binary and text files have the same points
+run(cmd => ["../bin/verilator_coverage",
+            "--write", "$Self->{obj_dir}/from_bin.dat",
+            "$Self->{obj_dir}/coverage.bin",
+    ]);
+run(cmd => ["../bin/verilator_coverage",
+            "--write", "$Self->{obj_dir}/from_text.dat",
+            "$Self->{obj_dir}/coverage.dat",
+    ]);
+
+files_identical("$Self->{obj_dir}/from_bin.dat", "$Self->{obj_dir}/from_text.dat");
+
+ok(1);
+1;
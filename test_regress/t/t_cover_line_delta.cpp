@@ -0,0 +1,48 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+#include <verilated_cov.h>
+
+#include VM_PREFIX_INCLUDE
+
+#define FILENAME(name) VL_STRINGIFY(TEST_OBJ_DIR) "/" name
+
+VM_PREFIX* topp;
+vluint64_t main_time = 0;
+double sc_time_stamp() { return (double)main_time; }
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    topp = new VM_PREFIX("top");
+
+    VerilatedCovSnapshot start;
+    VerilatedCovSnapshot middle;
+    VerilatedCov::snapshot(start);
+
+    topp->clk = 0;
+    topp->eval();
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+        if (main_time == 8) {
+            VerilatedCov::snapshot(middle);
+            VerilatedCov::writeDelta(FILENAME("phase1.dat"), start, middle);
+        }
+        topp->clk = !topp->clk;
+        topp->eval();
+        ++main_time;
+    }
+    if (!Verilated::gotFinish()) {
+        vl_fatal(__FILE__, __LINE__, "main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+    VerilatedCov::writeDelta(FILENAME("phase2.dat"), middle);
+    VerilatedCov::write(FILENAME("coverage.dat"));
+    VL_DO_DANGLING(delete topp, topp);
+    return 0;
+}
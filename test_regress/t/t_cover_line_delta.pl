@@ -0,0 +1,45 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_cover_line.v");
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--coverage-line --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+# Deltas have only points hit in their phase
+foreach my $phase ("phase1", "phase2") {
+    file_grep("$Self->{obj_dir}/$phase.dat", qr/^C '/m);
+    file_grep_not("$Self->{obj_dir}/$phase.dat", qr/' 0$/m);
+}
+
+# And the phases total the whole run
+sub total_count {
+    my $filename = shift;
+    my $total = 0;
+    foreach my $line (split /\n/, file_contents($filename)) {
+        $total += $1 if $line =~ /^C '.*' (\d+)$/;
+    }
+    return $total;
+}
+my $phases = total_count("$Self->{obj_dir}/phase1.dat") + total_count("$Self->{obj_dir}/phase2.dat");
+my $whole = total_count("$Self->{obj_dir}/coverage.dat");
+$phases == $whole or error("Phase totals $phases != whole run total $whole");
+
+ok(1);
+1;
@@ -0,0 +1,38 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_cover_line.v");
+
+compile(
+    verilator_flags2 => ['--cc --coverage-line --threads 2 --coverage-per-thread'
+                         .' +define+ATTRIBUTE'],
+    );
+
+# A block of counters for each thread
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__Syms.h", qr/__Vcoverage\[2\]\[/);
+
+execute(
+    check_finished => 1,
+    );
+
+# Read the input .v file and do any CHECK_COVER requests
+inline_checks();
+
+run(cmd => ["../bin/verilator_coverage",
+            "--annotate", "$Self->{obj_dir}/annotated",
+            "$Self->{obj_dir}/coverage.dat",
+    ]);
+
+files_identical("$Self->{obj_dir}/annotated/t_cover_line.v", "t/t_cover_line.out");
+
+ok(1);
+1;
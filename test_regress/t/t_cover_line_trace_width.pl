@@ -0,0 +1,35 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(simulator => 1);
+
+top_filename("t/t_cover_line.v");
+
+compile(
+    verilator_flags2 => ['--cc --coverage-line --trace --trace-coverage --trace-coverage-width 1 +define+ATTRIBUTE'],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+run(cmd => ["../bin/verilator_coverage",
+            "--annotate", "$Self->{obj_dir}/annotated",
+            "$Self->{obj_dir}/coverage.dat",
+    ]);
+
+files_identical("$Self->{obj_dir}/annotated/t_cover_line.v", "t/t_cover_line.out");
+# Counters toggle rather than count, the counts are in coverage.dat
+file_grep("$Self->{obj_dir}/simx.vcd",
+          qr/\$var wire  1 \S+ vlCoverageLineTrace_t_cover_line__45_if \$end/);
+file_grep_not("$Self->{obj_dir}/simx.vcd", qr/\$var wire 32 \S+ vlCoverageLineTrace/);
+
+ok(1);
+1;
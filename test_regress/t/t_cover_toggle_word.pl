@@ -0,0 +1,32 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(simulator => 1);
+
+top_filename("t/t_cover_toggle.v");
+
+compile(
+    verilator_flags2 => ['--cc --coverage-toggle --stats'],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+# Same counts as without the word compares
+inline_checks();
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/Coverage, Toggle words grouped\s+[1-9]/i);
+    file_grep($Self->{stats}, qr/Coverage, Toggle points joined\s+(\d+)/i, 25);
+}
+
+ok(1);
+1;
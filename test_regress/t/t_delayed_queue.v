@@ -0,0 +1,76 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+
+   integer cyc;
+   reg [63:0] crc;
+
+   // Whole element writes
+   reg [31:0] mem [0:15];
+   reg [31:0] mem_exp [0:15];
+   // Bit-selected writes
+   reg [71:0] bmem [0:7];
+   reg [71:0] bmem_exp [0:7];
+
+   integer i;
+   initial begin
+      cyc = 0;
+      crc = 64'h5aef0c8d_d70a4497;
+      for (i = 0; i < 16; i = i + 1) begin
+         mem[i] = 0;
+         mem_exp[i] = 0;
+      end
+      for (i = 0; i < 8; i = i + 1) begin
+         bmem[i] = 0;
+         bmem_exp[i] = 0;
+      end
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+      // Delayed writes from last cycle must now be visible
+      if (mem[crc[7:4]] !== mem_exp[crc[7:4]]) $stop;
+      if (bmem[crc[22:20]] !== bmem_exp[crc[22:20]]) $stop;
+      // Several write ports, possibly to the same address; last write wins
+      if (crc[8]) begin
+         mem[crc[3:0]] <= crc[63:32];
+         mem_exp[crc[3:0]] = crc[63:32];
+      end
+      if (crc[9]) begin
+         mem[crc[13:10]] <= crc[31:0];
+         mem_exp[crc[13:10]] = crc[31:0];
+      end
+      mem[crc[17:14]] <= crc[47:16];
+      mem_exp[crc[17:14]] = crc[47:16];
+      if (crc[18]) begin
+         mem[crc[3:0]] <= ~crc[31:0];
+         mem_exp[crc[3:0]] = ~crc[31:0];
+      end
+      if (crc[19]) begin
+         bmem[crc[2:0]][crc[26:24]*8 +: 8] <= crc[39:32];
+         bmem_exp[crc[2:0]][crc[26:24]*8 +: 8] = crc[39:32];
+      end
+      bmem[crc[5:3]][crc[29:27]*8 +: 8] <= crc[47:40];
+      bmem_exp[crc[5:3]][crc[29:27]*8 +: 8] = crc[47:40];
+      if (crc[30]) begin
+         bmem[crc[2:0]][64 +: 8] <= crc[55:48];
+         bmem_exp[crc[2:0]][64 +: 8] = crc[55:48];
+      end
+      bmem[crc[33:31]][crc[36:34]*8 +: 8] <= crc[63:56];
+      bmem_exp[crc[33:31]][crc[36:34]*8 +: 8] = crc[63:56];
+      if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,33 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   // Made asynchronous by t_dpi_async.vlt
+   import "DPI-C" function void dpii_beat(input int n, input bit [47:0] data, input byte b);
+   import "DPI-C" task dpii_task_beat(input int n);
+   // Called directly, drains the queued calls and checks them
+   import "DPI-C" function int dpii_check(input int n);
+
+   integer cyc = 0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      dpii_beat(cyc, {16'h1234, cyc}, 8'h5a);
+      dpii_task_beat(cyc);
+      if (cyc == 99) begin
+         if (dpii_check(100) != 0) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
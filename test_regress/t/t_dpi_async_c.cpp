@@ -0,0 +1,53 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include <cstdio>
+
+#include "svdpi.h"
+#include "verilated_dpi.h"
+
+#include "Vt_dpi_async__Dpi.h"
+
+//======================================================================
+
+static int s_beats = 0;
+static int s_taskBeats = 0;
+static int s_errors = 0;
+
+void dpii_beat(int n, const svBitVecVal* data, char b) {
+    // Calls are made in order, with the values at the time of the call
+    if (n != s_beats || data[0] != static_cast<svBitVecVal>(n) || data[1] != 0x1234
+        || b != 0x5a) {
+        printf("%%Error: dpii_beat %d got n=%d data=%x_%08x b=%x\n", s_beats, n, data[1],
+               data[0], b);
+        ++s_errors;
+    }
+    ++s_beats;
+}
+
+int dpii_task_beat(int n) {
+    if (n != s_taskBeats) {
+        printf("%%Error: dpii_task_beat %d got n=%d\n", s_taskBeats, n);
+        ++s_errors;
+    }
+    ++s_taskBeats;
+    return 0;
+}
+
+int dpii_check(int n) {
+    VerilatedDpiAsync::drain();
+    if (s_beats != n || s_taskBeats != n) {
+        printf("%%Error: dpii_check got %d and %d calls, expected %d\n", s_beats, s_taskBeats,
+               n);
+        ++s_errors;
+    }
+    return s_errors;
+}
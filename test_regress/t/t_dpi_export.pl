@@ -18,6 +18,14 @@ compile(
     verilator_flags2 => ["-Wall -Wno-DECLFILENAME -no-l2name"],
     );
 
+if ($Self->{vlt_all}) {
+    # Exports in a single scope are called directly, others use the export table
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp",
+              qr/__Vcb = &\w+::__Vdpiexp_dpix_int123_/);
+    file_grep_not("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp",
+                  qr/__Vcb = &\w+::__Vdpiexp_dpix_sub_inst/);
+}
+
 execute(
     check_finished => 1,
     );
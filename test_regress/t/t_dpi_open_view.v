@@ -0,0 +1,50 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+`define checkh(gotv,expv) do if ((gotv) !== (expv)) begin $write("%%Error: %s:%0d:  got='h%x exp='h%x\n", `__FILE__,`__LINE__, (gotv), (expv)); $stop; end while(0);
+
+module t (/*AUTOARG*/);
+
+   import "DPI-C" function int dpii_view_check1(input int h []);
+   import "DPI-C" function int dpii_view_check2(input int h [][]);
+   import "DPI-C" function int dpii_view_check3(input byte h [][][]);
+   import "DPI-C" function void dpii_view_fill2(output int h [][]);
+   import "DPI-C" function void dpii_view_fillw(output reg [95:0] h [][]);
+
+   // verilator lint_off UNDRIVEN
+   int        a1 [4:1];
+   int        a2 [1:-1][2:4];
+   byte       a3 [0:1][3:1][-1:1];
+   // verilator lint_on UNDRIVEN
+   int        o2 [1:-1][2:4];
+   reg [95:0] ow [1:0][-1:0];
+
+   initial begin
+      `checkh(dpii_view_check1(a1), 0);
+      `checkh(dpii_view_check2(a2), 0);
+      `checkh(dpii_view_check3(a3), 0);
+
+      dpii_view_fill2(o2);
+      for (int i = -1; i <= 1; ++i) begin
+         for (int j = 2; j <= 4; ++j) begin
+            `checkh(o2[i][j], i * 10 + j);
+         end
+      end
+
+      dpii_view_fillw(ow);
+      for (int i = 0; i <= 1; ++i) begin
+         for (int j = -1; j <= 0; ++j) begin
+            `checkh(ow[i][j], {32'habc, j, i});
+         end
+      end
+
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+
+endmodule
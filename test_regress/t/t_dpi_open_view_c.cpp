@@ -0,0 +1,78 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include <cstdio>
+
+#include "svdpi.h"
+#include "verilated_dpi.h"
+
+#include "Vt_dpi_open_view__Dpi.h"
+
+//======================================================================
+
+// Element pointers from the view must match the standard accessors
+int dpii_view_check1(const svOpenArrayHandle h) {
+    VerilatedDpiOpenArrayView view(h);
+    if (!view.ok() || view.dims() != 1 || view.entSize() != sizeof(int)) return 1;
+    int errors = 0;
+    for (int i = svLow(h, 1); i <= svHigh(h, 1); ++i) {
+        if (view.elemp(i) != svGetArrElemPtr1(h, i)) ++errors;
+    }
+    return errors;
+}
+
+int dpii_view_check2(const svOpenArrayHandle h) {
+    VerilatedDpiOpenArrayView view(h);
+    if (!view.ok() || view.dims() != 2) return 1;
+    if (view.stride(2) != sizeof(int) || view.stride(1) != 3 * sizeof(int)) return 1;
+    int errors = 0;
+    for (int i = svLow(h, 1); i <= svHigh(h, 1); ++i) {
+        for (int j = svLow(h, 2); j <= svHigh(h, 2); ++j) {
+            if (view.elemp(i, j) != svGetArrElemPtr2(h, i, j)) ++errors;
+        }
+    }
+    return errors;
+}
+
+int dpii_view_check3(const svOpenArrayHandle h) {
+    VerilatedDpiOpenArrayView view(h);
+    if (!view.ok() || view.dims() != 3 || view.entSize() != 1) return 1;
+    int errors = 0;
+    for (int i = svLow(h, 1); i <= svHigh(h, 1); ++i) {
+        for (int j = svLow(h, 2); j <= svHigh(h, 2); ++j) {
+            for (int k = svLow(h, 3); k <= svHigh(h, 3); ++k) {
+                if (view.elemp(i, j, k) != svGetArrElemPtr3(h, i, j, k)) ++errors;
+            }
+        }
+    }
+    return errors;
+}
+
+void dpii_view_fill2(const svOpenArrayHandle h) {
+    VerilatedDpiOpenArrayView view(h);
+    for (int i = svLow(h, 1); i <= svHigh(h, 1); ++i) {
+        for (int j = svLow(h, 2); j <= svHigh(h, 2); ++j) {
+            *static_cast<IData*>(view.elemp(i, j)) = i * 10 + j;
+        }
+    }
+}
+
+void dpii_view_fillw(const svOpenArrayHandle h) {
+    VerilatedDpiOpenArrayView view(h);
+    for (int i = svLow(h, 1); i <= svHigh(h, 1); ++i) {
+        for (int j = svLow(h, 2); j <= svHigh(h, 2); ++j) {
+            EData* datap = static_cast<EData*>(view.elemp(i, j));
+            datap[0] = i;
+            datap[1] = j;
+            datap[2] = 0xabc;
+        }
+    }
+}
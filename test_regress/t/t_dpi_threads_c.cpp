@@ -18,8 +18,10 @@
 //======================================================================
 
 #if defined(VERILATOR)
-# ifdef T_DPI_THREADS_COLLIDE
+# if defined(T_DPI_THREADS_COLLIDE)
 #  include "Vt_dpi_threads_collide__Dpi.h"
+# elif defined(T_DPI_THREADS_THREADSAFE)
+#  include "Vt_dpi_threads_threadsafe__Dpi.h"
 # else
 #  include "Vt_dpi_threads__Dpi.h"
 # endif
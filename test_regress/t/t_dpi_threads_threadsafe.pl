@@ -0,0 +1,30 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+$Self->skip_if_too_few_cores();
+
+scenarios(vltmt => 1);
+
+top_filename("t/t_dpi_threads.v");
+
+compile(
+    v_flags2 => ["t/t_dpi_threads_c.cpp t/t_dpi_threads_threadsafe.vlt --no-threads-coarsen"],
+    );
+
+# Like t_dpi_threads_collide, but only the non-pure import marked
+# threadsafe in the configuration file is run concurrently, under the
+# default --threads-dpi pure.  The DPI C code detects the overlap.
+#
+execute(
+    fails => 1,
+    );
+
+ok(1);
+1;
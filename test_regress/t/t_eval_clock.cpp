@@ -0,0 +1,66 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+#include VM_PREFIX_INCLUDE
+
+double sc_time_stamp() { return 0; }
+
+#define CHECK(got, exp) \
+    do { \
+        if ((got) != (exp)) { \
+            VL_PRINTF("%%Error: %s:%d: GOT = %u  EXP = %u\n", __FILE__, __LINE__, (got), \
+                      (exp)); \
+            exit(1); \
+        } \
+    } while (0)
+
+int main(int argc, char* argv[]) {
+    VM_PREFIX* topp = new VM_PREFIX;
+    topp->clk_a = 0;
+    topp->clk_b = 1;
+    topp->rst = 0;
+    topp->eval();
+    topp->rst = 1;
+    topp->eval();
+    topp->rst = 0;
+    topp->eval();
+    CHECK(topp->count_a, 0);
+
+    for (int i = 0; i < 10; ++i) {
+        topp->clk_a = !topp->clk_a;
+        topp->evalClock_clk_a();
+    }
+    CHECK(topp->count_a, 5);
+    CHECK(topp->count_b, 0);
+    CHECK(topp->sum, 5);
+    for (int i = 0; i < 6; ++i) {
+        topp->clk_b = !topp->clk_b;
+        topp->evalClock_clk_b();
+    }
+    CHECK(topp->count_a, 5);
+    CHECK(topp->count_b, 3);
+    CHECK(topp->sum, 8);
+    // Generated clocks are evaluated whichever clock changed
+    CHECK(topp->count_ab, 8);
+    // Reset is a clock, so must use eval()
+    topp->rst = 1;
+    topp->eval();
+    CHECK(topp->count_a, 0);
+    topp->rst = 0;
+    topp->clk_a = !topp->clk_a;
+    topp->clk_b = !topp->clk_b;
+    topp->eval();
+    CHECK(topp->count_a, 1);
+    CHECK(topp->count_b, 4);
+
+    topp->final();
+    VL_DO_DANGLING(delete topp, topp);
+    VL_PRINTF("*-* All Finished *-*\n");
+    return 0;
+}
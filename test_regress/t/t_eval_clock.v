@@ -0,0 +1,38 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   count_a, count_b, count_ab, sum,
+   // Inputs
+   clk_a, clk_b, rst
+   );
+   input clk_a;
+   input clk_b;
+   input rst;
+   output reg [31:0] count_a;
+   output reg [31:0] count_b;
+   output reg [31:0] count_ab;
+   output [31:0]     sum;
+
+   assign sum = count_a + count_b;
+
+   always @ (posedge clk_a or posedge rst) begin
+      if (rst) count_a <= 0;
+      else count_a <= count_a + 1;
+   end
+   always @ (negedge clk_b) begin
+      count_b <= count_b + 1;
+   end
+   wire clk_ab = clk_a ^ clk_b;
+   always @ (posedge clk_ab) begin
+      count_ab <= count_ab + 1;
+   end
+   initial begin
+      count_b = 0;
+      count_ab = 0;
+   end
+endmodule
@@ -0,0 +1,52 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [63:0] crc = 64'h5aef0c8d_d70a4497;
+   reg [1023:0] bus;
+
+   // Constant selects, aligned and not, including ones reaching the top word
+   wire [127:0] sel0 = bus[127:0];
+   wire [127:0] sel1 = bus[160 +: 128];
+   wire [127:0] sel2 = bus[37 +: 128];
+   wire [99:0] sel3 = bus[1023:924];
+   wire [200:0] sel4 = bus[1023:823];
+   wire [95:0] sel5 = bus[999 -: 96];
+   // Concatenations at misaligned offsets
+   wire [1023:0] cat0 = {bus[1002:0], bus[1023:1003]};
+   wire [170:0] cat1 = {sel2[40:0], sel3, sel5[29:0]};
+   wire [191:0] cat2 = {3{bus[63:0]}};
+
+   reg [1023:0] shr;
+   always @* shr = bus >> 37;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+      bus <= {bus[959:0], crc};
+      if (cyc > 20) begin
+         if (sel0 != bus[127:0]) $stop;
+         if (sel1 != 128'(bus >> 160)) $stop;
+         if (sel2 != shr[127:0]) $stop;
+         if (sel3 != 100'(bus >> 924)) $stop;
+         if (sel4 != 201'(bus >> 823)) $stop;
+         if (sel5 != 96'(bus >> 904)) $stop;
+         if (cat0 != ((bus << 21) | (bus >> 1003))) $stop;
+         if (cat1 != {shr[40:0], 100'(bus >> 924), 30'(bus >> 904)}) $stop;
+         if (cat2 != {bus[63:0], bus[63:0], bus[63:0]}) $stop;
+      end
+      if (cyc == 40) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
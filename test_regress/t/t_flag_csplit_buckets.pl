@@ -0,0 +1,34 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_flag_csplit.v");
+
+compile(
+    verilator_flags2 => ["--output-split-buckets 8 --output-split-cfuncs 1"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+my $got = 0;
+foreach my $file (glob("$Self->{obj_dir}/$Self->{VM_PREFIX}__[0-9]*.cpp")) {
+    $got = 1;
+    $file =~ /__([0-9]+)(__Slow)?\.cpp$/ or error("Unexpected split file name: $file");
+    ($1 >= 1 && $1 <= 8) or error("Bucket file number out of range: $file");
+}
+$got or error("No bucket split file found");
+
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}_classes.mk", qr/VM_PARALLEL_BUILDS = 1/);
+
+ok(1);
+1;
@@ -17,6 +17,9 @@ foreach my $prog (
     "../bin/verilator_difftree",
     "../bin/verilator_gantt",
     "../bin/verilator_profcfunc",
+    "../bin/verilator_profcompile",
+    "../bin/verilator_profsample",
+    "../bin/verilator_top",
     ) {
     run(fails => 0,
         cmd => ["perl", $prog,
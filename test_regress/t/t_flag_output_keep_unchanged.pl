@@ -0,0 +1,43 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+{
+    compile(
+        verilator_flags2 => ["--no-skip-identical --output-keep-unchanged"],
+        );
+
+    my $outfile = "$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp";
+    my @oldstats = stat($outfile);
+    print "Old mtime=",$oldstats[9],"\n";
+    $oldstats[9] or error("No output file found: $outfile\n");
+
+    sleep(2);  # Or else it might take < 1 second to compile and see no diff.
+
+    compile(
+        verilator_flags2 => ["--no-skip-identical --output-keep-unchanged"],
+        );
+
+    my @newstats = stat($outfile);
+    print "New mtime=",$newstats[9],"\n";
+
+    ($oldstats[9] == $newstats[9])
+        or error("--output-keep-unchanged rewrote an unchanged file\n");
+}
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
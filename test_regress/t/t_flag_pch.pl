@@ -0,0 +1,29 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_flag_csplit.v");
+
+compile(
+    verilator_flags2 => ["--pch --output-split 1"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__pch.h", qr/#include "$Self->{VM_PREFIX}__Syms.h"/);
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}_classes.mk", qr/VM_PCH = 1/);
+-r "$Self->{obj_dir}/$Self->{VM_PREFIX}__pch__fast.h.gch"
+    or error("Missing precompiled header");
+
+ok(1);
+1;
@@ -0,0 +1,41 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    make_flags => "VM_PGO=generate",
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__pgo_lto.stamp", qr/-fprofile-generate=/);
+
+# GCC writes .gcda files, which -fprofile-use reads directly; Clang's
+# .profraw files would first need merging with llvm-profdata
+my @gcdas = glob("$Self->{obj_dir}/pgo/*.gcda");
+if (@gcdas) {
+    compile(
+        make_flags => "VM_PGO=use",
+        );
+
+    execute(
+        check_finished => 1,
+        );
+
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__pgo_lto.stamp", qr/-fprofile-use=/);
+}
+
+ok(1);
+1;
@@ -0,0 +1,39 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+use File::Copy;
+
+scenarios(vlt => 1);
+
+# Source is copied so its dates can be changed
+mkdir $Self->{obj_dir};
+copy("t/t_flag_skipidentical.v", "$Self->{obj_dir}/t_flag_skipidentical_hash.v");
+top_filename("$Self->{obj_dir}/t_flag_skipidentical_hash.v");
+
+{
+    compile();
+
+    my $outfile = "$Self->{obj_dir}/V".$Self->{name}.".cpp";
+    -r $outfile or error("No output file found: $outfile\n");
+
+    # As if freshly checked out: every date changes, but no contents
+    my $newtime = time() + 1000;
+    utime($newtime, $newtime, $Self->{top_filename}, glob("$Self->{obj_dir}/*"));
+
+    $ENV{VERILATOR_DEBUG_SKIP_IDENTICAL} = 1;
+    compile();
+
+    my @newstats = stat($outfile);
+    ($newstats[9] == $newtime)
+        or error("--skip-identical was ignored after only dates changed -- recompiled\n");
+}
+
+ok(1);
+1;
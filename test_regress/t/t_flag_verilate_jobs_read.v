@@ -0,0 +1,15 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/);
+   wire [7:0] out;
+   sub sub (.out(out));
+   initial begin
+      if (out != 8'h5a) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
@@ -15,10 +15,14 @@ compile(
     );
 
 execute(
+    all_run_flags => ["+verilator+rand+reset+2"],
     check_finished => 1,
     );
 
 file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/VL_RAND_RESET/);
+# Arrays are randomized with one call
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/VL_RAND_RESET_N\(5, 64, t__DOT__mem\);/);
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/VL_RAND_RESET_N\(100, 8, t__DOT__wide\);/);
 
 ok(1);
 1;
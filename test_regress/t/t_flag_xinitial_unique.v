@@ -11,7 +11,23 @@ module t (/*AUTOARG*/
 
    output reg [63:0] value;
 
+   reg [4:0]  mem [0:15][0:3];
+   reg [99:0] wide [0:7];
+
+   integer    i;
+   integer    j;
+   integer    same;
+
    initial begin
+      // Randomized with +verilator+rand+reset+2, so rows should differ
+      same = 0;
+      for (i = 0; i < 16; i = i + 1) begin
+         for (j = 0; j < 4; j = j + 1) begin
+            if (mem[i][j] == mem[0][0]) same = same + 1;
+         end
+      end
+      if (same == 64) $stop;
+      if (wide[1] == wide[2]) $stop;
       $write("*-* All Finished *-*\n");
       $finish;
    end
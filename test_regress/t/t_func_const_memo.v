@@ -0,0 +1,67 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   // Many instances calling the same constant functions, some with the
+   // same arguments, and some whose results depend on their parameters
+   genvar g;
+   generate
+      for (g = 1; g <= 8; g = g + 1) begin : gen
+         sub #(.W(g)) u_diff ();
+         sub #(.W(4)) u_same ();
+      end
+   endgenerate
+
+   always @ (posedge clk) begin
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
+
+module sub;
+   parameter W = 1;
+
+   function automatic integer clog2_loop(input integer value);
+      integer i;
+      clog2_loop = 0;
+      for (i = value - 1; i > 0; i = i >> 1) clog2_loop = clog2_loop + 1;
+   endfunction
+
+   function automatic integer sum_to(input integer n);
+      integer i;
+      sum_to = 0;
+      for (i = 1; i <= n; i = i + 1) sum_to = sum_to + i;
+   endfunction
+
+   // Depends on the parameter, so not the same in each instance
+   function automatic integer add_w(input integer value);
+      add_w = value + W;
+   endfunction
+
+   // Width depends on the parameter
+   function automatic [W-1:0] all_ones(input integer n);
+      integer i;
+      all_ones = '0;
+      for (i = 0; i < n; i = i + 1) all_ones[i] = 1'b1;
+   endfunction
+
+   localparam LOG = clog2_loop(W * 1000);
+   localparam SUM = sum_to(500);
+   localparam ADDW = add_w(10);
+   localparam [W-1:0] ONES = all_ones(8);
+
+   initial begin
+      if (LOG != $clog2(W * 1000)) $stop;
+      if (SUM != 125250) $stop;
+      if (ADDW != 10 + W) $stop;
+      if (ONES != {W{1'b1}}) $stop;
+   end
+endmodule
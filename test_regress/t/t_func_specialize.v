@@ -0,0 +1,49 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [31:0] a, b, c, d, e;
+
+   function [31:0] op;
+      input [1:0] mode;
+      input [31:0] x;
+      input [31:0] y;
+      /*verilator no_inline_task*/
+      begin
+         case (mode)
+           2'd0: op = x + y;
+           2'd1: op = x - y;
+           2'd2: op = x ^ y;
+           default: op = x & y;
+         endcase
+      end
+   endfunction
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= op(2'd0, cyc, 32'd10);  // mode and y constant
+      b <= op(2'd0, cyc, 32'd10);  // same set as above
+      c <= op(2'd1, cyc, 32'd3);
+      d <= op(2'd2, 32'h55, cyc);
+      e <= op(cyc[1:0], cyc, 32'd7);  // Nothing constant but y
+      if (cyc > 1) begin
+         if (a != cyc - 1 + 10) $stop;
+         if (b != a) $stop;
+         if (c != cyc - 1 - 3) $stop;
+         if (d != (32'h55 ^ (cyc - 1))) $stop;
+      end
+      if (cyc == 9) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
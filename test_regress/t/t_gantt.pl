@@ -69,6 +69,12 @@ if ($global_mtask_ct == 0) { error("wrong number of mtasks, should be > 0"); }
 print "Found $gantt_line_ct lines of gantt data with $global_mtask_ct mtasks\n"
     if $Self->{verbose};
 
+# Predicted vs measured cost, with the modules Verilator recorded
+file_grep("$Self->{obj_dir}/profile_threads.dat", qr/VLPROF mtask_modules \d+ .*\bt\b/);
+file_grep("$Self->{obj_dir}/profile_threads.dat", qr/VLPROF mtask \d+ .* wait \d+/);
+file_grep("$Self->{obj_dir}/gantt.log", qr/Predicted vs measured mtask cost/);
+file_grep("$Self->{obj_dir}/gantt.log", qr/^ +\d+ +\d+ +\d+ +[0-9.]+ +\d+ +[0-9.]+ +[0-9.]+[* ] +\S/m);
+
 # Diff to itself, just to check parsing
 vcd_identical("$Self->{obj_dir}/profile_threads.vcd", "$Self->{obj_dir}/profile_threads.vcd");
 
@@ -0,0 +1,44 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+# Test +verilator+prof+threads+counters and its verilator_gantt report.
+# Counters may be unavailable (they then read as zero), so only the
+# format is checked.
+#
+# Only needed in multithreaded regression.
+scenarios(vltmt => 1);
+
+top_filename("t/t_gen_alw.v");
+
+compile(
+    v_flags2 => ["--prof-threads --threads 2"]
+    );
+
+execute(
+    all_run_flags => ["+verilator+prof+threads+start+2",
+                      " +verilator+prof+threads+window+2",
+                      " +verilator+prof+threads+counters+1",
+                      " +verilator+prof+threads+file+$Self->{obj_dir}/profile_threads.dat",
+                      ],
+    check_finished => 1,
+    );
+
+file_grep("$Self->{obj_dir}/profile_threads.dat",
+          qr/VLPROF mtask \d+ .* cycles \d+ instrs \d+ llc_misses \d+ branch_misses \d+/);
+
+run(cmd => ["$ENV{VERILATOR_ROOT}/bin/verilator_gantt",
+            "$Self->{obj_dir}/profile_threads.dat",
+            "--no-vcd",
+            "> $Self->{obj_dir}/gantt.log"]);
+
+file_grep("$Self->{obj_dir}/gantt.log", qr/Hardware counters/);
+
+ok(1);
+1;
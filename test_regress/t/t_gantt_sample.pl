@@ -0,0 +1,38 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+# Test +verilator+prof+threads+sample, dumped at model destruction
+#
+# Only needed in multithreaded regression.
+scenarios(vltmt => 1);
+
+top_filename("t/t_gen_alw.v");
+
+compile(
+    v_flags2 => ["--prof-threads --threads 2"]
+    );
+
+execute(
+    all_run_flags => ["+verilator+prof+threads+start+2",
+                      " +verilator+prof+threads+sample+3",
+                      " +verilator+prof+threads+file+$Self->{obj_dir}/profile_threads.dat",
+                      ],
+    check_finished => 1,
+    );
+
+file_grep("$Self->{obj_dir}/profile_threads.dat", qr/VLPROF arg \+verilator\+prof\+threads\+sample\+3/);
+file_grep("$Self->{obj_dir}/profile_threads.dat", qr/VLPROF mtask \d+ start/);
+
+run(cmd => ["$ENV{VERILATOR_ROOT}/bin/verilator_gantt",
+            "$Self->{obj_dir}/profile_threads.dat",
+            "> $Self->{obj_dir}/gantt.log"]);
+
+ok(1);
+1;
@@ -0,0 +1,26 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+compile(
+    verilator_flags2 => ["--hot-cold-vars"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+# Cold variables follow all the hot ones
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/COLD VARIABLES[\s\S]*t__DOT__bigmem/);
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/COLD VARIABLES[\s\S]*t__DOT__initonly/);
+
+ok(1);
+1;
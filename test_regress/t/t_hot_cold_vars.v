@@ -0,0 +1,43 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc = 0;
+   reg [63:0] crc = 64'h5aef0c8d_d70a4497;
+   reg [63:0] sum = 64'h0;
+
+   // Large memory, cold as over a page
+   reg [31:0] bigmem [2047:0];
+   // Only used by initial code, so cold; public so it is kept as a member
+   integer initonly /*verilator public*/;
+
+   integer i;
+   initial begin
+      initonly = 0;
+      for (i = 0; i < 2048; i = i + 1) begin
+         bigmem[i] = i * 3;
+         initonly = initonly + 1;
+      end
+      if (initonly != 2048) $stop;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+      sum <= sum ^ {32'h0, bigmem[crc[10:0]]} ^ crc;
+      bigmem[crc[20:10]] <= crc[31:0];
+      if (cyc == 99) begin
+         $write("[%0t] sum=%x\n", $time, sum);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
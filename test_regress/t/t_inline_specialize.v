@@ -0,0 +1,55 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+
+   integer cyc = 0;
+   reg [7:0] in;
+
+   wire [7:0] out0, out1, out2;
+
+   // Each distinct set of tie-offs gets its own copy of sub
+   sub u0 (.mode(1'b0), .in(in), .out(out0));
+   sub u1 (.mode(1'b1), .in(in), .out(out1));
+   sub u2 (.mode(1'b1), .in(in), .out(out2));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      in <= in + 8'd3;
+      if (cyc == 0) begin
+         in <= 8'd5;
+      end
+      else if (cyc < 99) begin
+         if (out0 !== in + 8'd1) $stop;
+         if (out1 !== ~in) $stop;
+         if (out2 !== out1) $stop;
+      end
+      else begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+module sub (/*AUTOARG*/
+   // Outputs
+   out,
+   // Inputs
+   mode, in
+   );
+   /*verilator no_inline_module*/
+
+   input mode;
+   input [7:0] in;
+   output [7:0] out;
+
+   assign out = mode ? ~in : in + 8'd1;
+endmodule
@@ -0,0 +1,33 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+my $costs = "$Self->{obj_dir}/instr_costs.txt";
+run(cmd => ["$ENV{VERILATOR_ROOT}/bin/verilator_instrcost",
+            "--quick", "-o", $costs],
+    check_finished => 0);
+
+file_grep($costs, qr/^branch +\d+$/m);
+file_grep($costs, qr/^dpi +\d+$/m);
+file_grep($costs, qr/^wide +\d+$/m);
+
+compile(
+    verilator_flags2 => ["--instr-costs", $costs],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,66 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+#include "Vt_lanes.h"
+#include "Vt_lanes__Lanes.h"
+
+double sc_time_stamp() { return 0; }
+
+#define CHECK(got, exp) \
+    do { \
+        if ((got) != (exp)) { \
+            VL_PRINTF("%%Error: %s:%d: GOT = %" VL_PRI64 "x  EXP = %" VL_PRI64 "x\n", __FILE__, \
+                      __LINE__, (vluint64_t)(got), (vluint64_t)(exp)); \
+            exit(1); \
+        } \
+    } while (0)
+
+int main(int argc, char* argv[]) {
+    Vt_lanes__Lanes* lanesp = new Vt_lanes__Lanes;
+    if (Vt_lanes__Lanes::LANES != 4) {
+        VL_PRINTF("%%Error: %s:%d: Wrong lane count\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    // Reference model, run separately for each lane's seed
+    Vt_lanes* refsp[Vt_lanes__Lanes::LANES];
+    for (int lane = 0; lane < Vt_lanes__Lanes::LANES; ++lane) {
+        refsp[lane] = new Vt_lanes("ref");
+        lanesp->seed[lane] = refsp[lane]->seed = 0x1000 + lane;
+        lanesp->load[lane] = refsp[lane]->load = 1;
+        lanesp->clk[lane] = refsp[lane]->clk = 0;
+    }
+
+    for (int cyc = 0; cyc < 40; ++cyc) {
+        for (int lane = 0; lane < Vt_lanes__Lanes::LANES; ++lane) {
+            lanesp->clk[lane] = refsp[lane]->clk = !refsp[lane]->clk;
+            if (cyc == 2) lanesp->load[lane] = refsp[lane]->load = 0;
+            refsp[lane]->eval();
+        }
+        lanesp->eval();
+        for (int lane = 0; lane < Vt_lanes__Lanes::LANES; ++lane) {
+            CHECK(lanesp->crc[lane], refsp[lane]->crc);
+            CHECK(lanesp->lanep(lane)->crc, refsp[lane]->crc);
+            for (int w = 0; w < 3; ++w) CHECK(lanesp->wide[lane][w], refsp[lane]->wide[w]);
+        }
+    }
+    // Lanes are independent
+    if (lanesp->crc[0] == lanesp->crc[1]) {
+        VL_PRINTF("%%Error: %s:%d: Lanes not independent\n", __FILE__, __LINE__);
+        exit(1);
+    }
+
+    lanesp->final();
+    for (int lane = 0; lane < Vt_lanes__Lanes::LANES; ++lane) {
+        refsp[lane]->final();
+        VL_DO_DANGLING(delete refsp[lane], refsp[lane]);
+    }
+    VL_DO_DANGLING(delete lanesp, lanesp);
+    VL_PRINTF("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,30 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   crc, wide,
+   // Inputs
+   clk, seed, load
+   );
+
+   input clk;
+   input [31:0] seed;
+   input load;
+   output reg [63:0] crc;
+   output reg [95:0] wide;
+
+   always @ (posedge clk) begin
+      if (load) begin
+         crc <= {32'h5aef0c8d, seed};
+         wide <= 96'h0;
+      end
+      else begin
+         crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+         wide <= {wide[31:0], wide[95:32]} ^ {crc, crc[31:0]};
+      end
+   end
+endmodule
@@ -0,0 +1,38 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc = 0;
+   reg [63:0] crc = 64'h5aef0c8d_d70a4497;
+   reg [63:0] sum = 64'h0;
+   reg [31:0] q = 32'h0;
+
+   reg [31:0] mem [15:0];
+   integer i;
+   initial begin
+      for (i = 0; i < 16; i = i + 1) mem[i] = i * 32'h01010101;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+      // Read before the delayed write, so the write needs no set flag
+      q <= mem[crc[3:0]];
+      mem[crc[7:4]] <= crc[31:0] ^ q;
+      sum <= {sum[62:0], sum[63] ^ sum[2] ^ sum[0]} ^ {32'h0, q};
+      if (cyc == 99) begin
+         $write("[%0t] sum=%x\n", $time, sum);
+         if (sum !== 64'hdaf9ef34116edecd) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,32 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_lint_only.v");
+
+{
+    lint(
+        verilator_flags2 => ["--skip-identical"],
+        );
+
+    my $datfile = "$Self->{obj_dir}/V".$Self->{name}."__verFiles.dat";
+    -r $datfile or error("No dependency file found: $datfile\n");
+
+    # Fails if the lint isn't skipped
+    $ENV{VERILATOR_DEBUG_SKIP_IDENTICAL} = 1;
+    lint(
+        verilator_flags2 => ["--skip-identical"],
+        );
+    delete $ENV{VERILATOR_DEBUG_SKIP_IDENTICAL};
+}
+
+ok(1);
+1;
@@ -0,0 +1,41 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [31:0] tmp;  // Temporary set before use in each block
+   reg [31:0] pos;
+   reg [31:0] neg;
+
+   always @ (posedge clk) begin
+      tmp = cyc * 3;
+      tmp = tmp + 1;
+      pos <= tmp;
+   end
+
+   always @ (negedge clk) begin
+      tmp = cyc * 5;
+      tmp = tmp ^ 32'h55;
+      neg <= tmp;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc > 2) begin
+         if (pos != (cyc - 1) * 3 + 1) $stop;
+         if (neg != ((cyc * 5) ^ 32'h55)) $stop;
+      end
+      if (cyc == 9) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,28 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    make_flags => "VM_LIBVERILATED_DIR=$Self->{obj_dir}/libverilated",
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+my @objs = glob("$Self->{obj_dir}/libverilated/*/verilated.o");
+@objs == 1 or error("Expected one shared verilated.o, found " . scalar(@objs));
+!-e "$Self->{obj_dir}/verilated.o" or error("verilated.o was also compiled per model");
+
+ok(1);
+1;
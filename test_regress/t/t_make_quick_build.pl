@@ -0,0 +1,30 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    make_flags => "VM_QUICK_BUILD=1 OPT_FAST=-O3",
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__pgo_lto.stamp", qr/^-O0$/);
+file_grep("$Self->{obj_dir}/vlt_gcc.log", qr/-O0/);
+file_grep_not("$Self->{obj_dir}/vlt_gcc.log", qr/-O3/);
+# Files are compiled separately, not included into one
+!-e "$Self->{obj_dir}/$Self->{VM_PREFIX}__ALLfast.cpp" or error("Expected no __ALLfast.cpp");
+
+ok(1);
+1;
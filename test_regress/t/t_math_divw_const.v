@@ -0,0 +1,75 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+
+   integer cyc = 0;
+   reg [63:0] crc;
+
+   reg [2047:0] a;
+   reg [2047:0] b;
+   reg [31:0]   d10;
+   reg [31:0]   dbig;
+
+   // Constant divisors that fit in a word
+   wire [2047:0] q10 = a / 10;
+   wire [2047:0] r10 = a % 10;
+   wire [2047:0] qbig = a / 32'hfffffffb;
+   wire [2047:0] rbig = a % 32'hfffffffb;
+   // Same division with a variable divisor
+   wire [2047:0] vq10 = a / d10;
+   wire [2047:0] vr10 = a % d10;
+   wire [2047:0] vqbig = a / dbig;
+   wire [2047:0] vrbig = a % dbig;
+
+   // Large multiply and divide
+   wire [4095:0] prod = a * b;
+   wire [4095:0] pq = prod / b;
+   wire [4095:0] pr = prod % a;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63]^crc[2]^crc[0]};
+      a <= {32{crc ^ {32'b0, cyc}}};
+      b <= {32{~crc}} >> cyc;
+      d10 <= 32'd10;
+      dbig <= 32'hfffffffb;
+      if (cyc == 0) begin
+         crc <= 64'h5aef0c8d_d70a4497;
+         a <= '0;
+         b <= 2048'd1;
+      end
+      else if (cyc > 1) begin
+`ifdef TEST_VERBOSE
+         $write("[%0t] cyc==%0d a=%x r10=%x rbig=%x\n", $time, cyc, a[63:0], r10[31:0],
+                rbig[31:0]);
+`endif
+         if (q10 !== vq10) $stop;
+         if (r10 !== vr10) $stop;
+         if (qbig !== vqbig) $stop;
+         if (rbig !== vrbig) $stop;
+         if (q10 * 10 + r10 !== a) $stop;
+         if (qbig * 32'hfffffffb + rbig !== a) $stop;
+         if (r10 >= 10) $stop;
+         if (rbig >= 32'hfffffffb) $stop;
+         if (b != 0) begin
+            if (pq !== {2048'b0, a}) $stop;
+         end
+         if (a != 0) begin
+            if (pr !== '0) $stop;
+         end
+      end
+      if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
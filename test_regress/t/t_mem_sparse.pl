@@ -0,0 +1,30 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(simulator => 1);
+
+compile(
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+if ($Self->{vlt_all}) {
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h",
+              qr/VlSparseArray<IData\/\*31:0\*\/, 1073741824>\s+t__DOT__mem;/);
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h",
+              qr/VlSparseArray<WData\/\*69:0\*\/\[3\], 16777216>\s+t__DOT__wide;/);
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h",
+              qr/VlSparseArray<CData\/\*7:0\*\/\[4\], 1048576>\s+t__DOT__multi;/);
+}
+
+ok(1);
+1;
@@ -0,0 +1,49 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+`define checkh(gotv,expv) do if ((gotv) !== (expv)) begin $write("%%Error: %s:%0d:  got='h%x exp='h%x\n", `__FILE__,`__LINE__, (gotv), (expv)); $stop; end while(0);
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   // 4GB address space, only the written pages take memory
+   reg [31:0] mem [0:(1<<30)-1] /*verilator sparse*/;
+   reg [69:0] wide [0:(1<<24)-1] /*verilator sparse*/;
+   reg [7:0]  multi [0:(1<<20)-1][0:3] /*verilator sparse*/;
+
+   integer    cyc = 0;
+   reg [29:0] addr;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      addr = {cyc[9:0], 20'h0} + 30'h12345;
+      if (cyc < 8) begin
+         mem[addr] <= {2'b0, addr};
+         wide[addr[23:0]] <= {6'h2a, 32'hfeed_0000 + cyc, 32'h0 + cyc};
+         multi[addr[19:0]][cyc[1:0]] <= cyc[7:0];
+      end
+      else if (cyc < 16) begin
+         addr = {cyc[9:0] - 10'd8, 20'h0} + 30'h12345;
+         `checkh(mem[addr], {2'b0, addr});
+         `checkh(mem[addr + 1], 32'h0);
+         `checkh(wide[addr[23:0]], {6'h2a, 32'hfeed_0000 + cyc - 8, 32'h0 + cyc - 8});
+         `checkh(multi[addr[19:0]][cyc[1:0]], cyc[7:0] - 8'd8);
+      end
+      else if (cyc == 16) begin
+         `checkh(mem[30'h3fff_ffff], 32'h0);
+         $readmemh("t/t_sys_readmem_eof.mem", mem, 30'h2000_0000);
+         `checkh(mem[30'h2000_0000], 32'h10);
+         `checkh(mem[30'h2000_0006], 32'h12345678);
+      end
+      else if (cyc == 17) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,13 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   in
+   );
+   input [7:0] in [0:3] /*verilator sparse*/;
+   reg [7:0] scalar /*verilator sparse*/;
+endmodule
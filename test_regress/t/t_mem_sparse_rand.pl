@@ -0,0 +1,42 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+compile(
+    verilator_flags2 => ["--x-initial unique"],
+    );
+
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp",
+          qr/t__DOT__mem.randReset\(5, name\(\), "t__DOT__mem"\);/);
+
+# The same seed gives the same values, whichever order pages are touched
+my %sums;
+foreach my $seed (5, 5, 6) {
+    execute(
+        all_run_flags => ["+verilator+rand+reset+2 +verilator+seed+${seed}"],
+        check_finished => 1,
+        );
+    my $log = file_contents("$Self->{obj_dir}/vlt_sim.log");
+    if ($log =~ /sum=([0-9a-f]+)/) {
+        push @{$sums{$seed}}, $1;
+    } else {
+        error("No sum in log");
+    }
+}
+if ($sums{5}[0] ne $sums{5}[1]) {
+    error("Same seed gave different values: $sums{5}[0] $sums{5}[1]");
+}
+if ($sums{5}[0] eq $sums{6}[0]) {
+    error("Different seeds gave the same values: $sums{5}[0]");
+}
+
+ok(1);
+1;
@@ -0,0 +1,63 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+`define checkh(gotv,expv) do if ((gotv) !== (expv)) begin $write("%%Error: %s:%0d:  got='h%x exp='h%x\n", `__FILE__,`__LINE__, (gotv), (expv)); $stop; end while(0);
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   // Each page is randomized when first touched
+   reg [4:0]  mem [0:(1<<30)-1] /*verilator sparse*/;
+   reg [69:0] wide [0:(1<<20)-1] /*verilator sparse*/;
+
+   integer    cyc = 0;
+   integer    i;
+   integer    nonzero;
+   reg [4:0]  first [0:63];
+   reg [69:0] firstWide [0:7];
+   reg [31:0] sum;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 0) begin
+         nonzero = 0;
+         sum = 0;
+         for (i = 0; i < 64; i = i + 1) begin
+            first[i] = mem[i * 30'h0100_0001];
+            if (first[i] != 0) nonzero = nonzero + 1;
+            sum = {sum[26:0], sum[31:27]} ^ {27'h0, first[i]};
+         end
+         for (i = 0; i < 8; i = i + 1) begin
+            firstWide[i] = wide[i * 20'h1_0001];
+            sum = sum ^ firstWide[i][31:0] ^ firstWide[i][63:32] ^ {26'h0, firstWide[i][69:64]};
+         end
+         if (nonzero < 8) $stop;
+      end
+      else if (cyc == 1) begin
+         mem[5] <= 5'h1f;
+         wide[3] <= {6'h2a, 64'hfeed_0000_beef_0000};
+      end
+      else if (cyc == 2) begin
+         // Rows keep their values, including rows sharing a page with a write
+         for (i = 0; i < 64; i = i + 1) begin
+            `checkh(mem[i * 30'h0100_0001], first[i]);
+         end
+         for (i = 0; i < 8; i = i + 1) begin
+            `checkh(wide[i * 20'h1_0001], firstWide[i]);
+         end
+         `checkh(mem[5], 5'h1f);
+         `checkh(wide[3], {6'h2a, 64'hfeed_0000_beef_0000});
+      end
+      else if (cyc == 3) begin
+         $write("sum=%x\n", sum);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,34 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [63:0] crc = 64'h5aef0c8d_d70a4497;
+
+   task report_error;
+      /*verilator no_inline_task*/
+      $write("%%Error: cyc=%0d crc=%x\n", cyc, crc);
+   endtask
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+      if (crc == 64'h0) begin
+         // Never happens; the call is only in an unlikely branch
+         report_error();
+         $stop;
+      end
+      if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,72 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+package pkg;
+   function automatic [31:0] step(input [31:0] s, input [31:0] in);
+      step = ({s[30:0], s[31] ^ s[21] ^ s[1] ^ s[0]} ^ (in * 32'h9e37_79b1))
+        + ((s >> 5) ^ (in << 3)) - ((s & in) | (~s & 32'h0f0f_0f0f))
+        + ((in[7:0] == 8'h3c) ? s : ~in);
+   endfunction
+endpackage
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc; initial cyc=0;
+
+   reg [31:0] a;
+   reg [31:0] b;
+   wire [31:0] qa;
+   wire [31:0] qb;
+   reg [31:0]  ra; initial ra = 32'h0;
+   reg [31:0]  rb; initial rb = 32'h0;
+
+   // Same logic in each instance, referencing different variables
+   sub ua (.clk, .in(a), .q(qa));
+   sub ub (.clk, .in(b), .q(qb));
+
+   always @ (posedge clk) begin
+      ra <= pkg::step(ra, a);
+      rb <= pkg::step(rb, b);
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= {a[30:0], a[31] ^ a[21] ^ a[1] ^ a[0]};
+      b <= a ^ 32'h5a5a_a5a5;
+      if (cyc == 0) begin
+         a <= 32'h1234_5678;
+      end
+      else if (cyc > 1) begin
+         if (qa !== ra) $stop;
+         if (qb !== rb) $stop;
+      end
+      if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+module sub (/*AUTOARG*/
+   // Outputs
+   q,
+   // Inputs
+   clk, in
+   );
+   /*verilator no_inline_module*/
+   input clk;
+   input [31:0] in;
+   output reg [31:0] q;
+   initial q = 32'h0;
+
+   always @ (posedge clk) begin
+      q <= pkg::step(q, in);
+   end
+endmodule
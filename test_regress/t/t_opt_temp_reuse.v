@@ -0,0 +1,52 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc; initial cyc=0;
+
+   reg [127:0] a;
+   reg [127:0] b;
+   reg [127:0] r1;
+   reg [127:0] r2;
+   reg [127:0] r3;
+   reg [127:0] r4;
+   reg [63:0]  crc;
+
+   // Each wide shift needs a temporary, with lifetimes that don't overlap
+   always @ (posedge clk) begin
+      r1 <= (a << cyc[6:0]) ^ (b >> 3);
+      r2 <= (b << cyc[5:0]) ^ (a >> 5);
+      r3 <= (a >> cyc[6:0]) ^ (b << 7);
+      r4 <= (b >> cyc[5:0]) ^ (a << 9);
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= {a[126:0], a[127] ^ a[100] ^ a[3]};
+      b <= {b[0] ^ b[64], b[127:1]};
+      if (cyc == 0) begin
+         a <= 128'h0123456789abcdef_fedcba9876543210;
+         b <= 128'h5a5a5a5a_a5a5a5a5_0f0f0f0f_f0f0f0f0;
+         crc <= 64'h0;
+      end
+      else if (cyc > 1) begin
+         crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]}
+                ^ r1[63:0] ^ r1[127:64] ^ r2[63:0] ^ r2[127:64]
+                ^ r3[63:0] ^ r3[127:64] ^ r4[63:0] ^ r4[127:64];
+      end
+      if (cyc == 99) begin
+         $write("[%0t] crc=%x\n", $time, crc);
+         if (crc !== 64'h4d8003fe1723671f) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,62 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc; initial cyc=0;
+
+   reg [127:0] a;
+   reg [127:0] b;
+   reg [127:0] c;
+   reg [127:0] d;
+   reg [127:0] m1;
+   reg [127:0] m2;
+   reg [127:0] s1;
+   reg [127:0] s2;
+   reg [127:0] chain_mul;
+   reg [127:0] staged_mul;
+   reg [127:0] chain_shift;
+   reg [127:0] staged_shift;
+
+   // Each operation of a chain reads the temporary written by the one
+   // before, so the two temporaries must not share storage
+   always @ (posedge clk) begin
+      chain_mul <= ((a * b) * c) * d;
+      chain_shift <= ((a << cyc[6:0]) << cyc[3:0]) >> cyc[5:0];
+      m1 = a * b;
+      m2 = m1 * c;
+      staged_mul <= m2 * d;
+      s1 = a << cyc[6:0];
+      s2 = s1 << cyc[3:0];
+      staged_shift <= s2 >> cyc[5:0];
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= {a[126:0], a[127] ^ a[100] ^ a[3]};
+      b <= {b[0] ^ b[64], b[127:1]};
+      c <= c + a;
+      d <= d ^ {b[63:0], a[127:64]};
+      if (cyc == 0) begin
+         a <= 128'h0123456789abcdef_fedcba9876543210;
+         b <= 128'h5a5a5a5a_a5a5a5a5_0f0f0f0f_f0f0f0f0;
+         c <= 128'h13579bdf_2468ace0_fdb97531_0eca8642;
+         d <= 128'h00000001_00000000_ffffffff_12345678;
+      end
+      else if (cyc > 2) begin
+         if (chain_mul !== staged_mul) $stop;
+         if (chain_shift !== staged_shift) $stop;
+      end
+      if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
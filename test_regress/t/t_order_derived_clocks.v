@@ -0,0 +1,46 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc; initial cyc=0;
+
+   // verilator lint_off GENCLK
+   reg        div2; initial div2 = 1'b0;
+   reg        div4; initial div4 = 1'b0;
+   reg [31:0] cnt; initial cnt = 32'h0;
+   reg [31:0] cnt2; initial cnt2 = 32'h0;
+   reg [31:0] cnt4; initial cnt4 = 32'h0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      cnt <= cnt + 1;
+      div2 <= ~div2;
+      if (cyc == 99) begin
+         if (cnt4 != 32'd97) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+
+   // Runs after cnt has its value for this edge of clk, odd
+   always @ (posedge div2) begin
+      div4 <= ~div4;
+      cnt2 <= cnt;
+      if (cnt[0] != 1'b1) $stop;
+   end
+
+   // Runs after cnt2 has its value for this edge of div2
+   always @ (posedge div4) begin
+      cnt4 <= cnt2;
+      if (cnt2[1:0] != 2'b01) $stop;
+   end
+
+endmodule
@@ -0,0 +1,38 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/);
+
+   wire [7:0] o_default;
+   wire [7:0] o_same;
+   wire [7:0] o_ones_a;
+   wire [7:0] o_ones_b;
+   wire [7:0] o_ones_c;
+
+   // Same value as the default, once converted to 8 bits
+   sub #(.P(5)) u_default (.o(o_default));
+   sub #(.P(8'd5)) u_same (.o(o_same));
+   // All convert to 8'hff, so share one specialized module
+   sub #(.P(-1)) u_ones_a (.o(o_ones_a));
+   sub #(.P(8'hff)) u_ones_b (.o(o_ones_b));
+   sub #(.P(32'h1ff)) u_ones_c (.o(o_ones_c));
+
+   initial begin
+      if (o_default !== 8'd5) $stop;
+      if (o_same !== 8'd5) $stop;
+      if (o_ones_a !== 8'hff) $stop;
+      if (o_ones_b !== 8'hff) $stop;
+      if (o_ones_c !== 8'hff) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
+
+module sub
+  #(parameter [7:0] P = 8'd5)
+   (output wire [7:0] o);
+   assign o = P;
+endmodule
@@ -0,0 +1,17 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+`define T_PP_CACHE_VALUE 8'h5a
+`define T_PP_CACHE_ADD(a, b) ((a) + (b))
+
+module t (/*AUTOARG*/);
+   initial begin
+      if (`T_PP_CACHE_VALUE != 8'h5a) $stop;
+      if (`T_PP_CACHE_ADD(2, 3) != 5) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
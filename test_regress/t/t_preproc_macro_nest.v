@@ -0,0 +1,41 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+// Each level uses the one below twice, so `NEST8 expands `INC 256 times
+`define INC(a, b = 1) ((a) + (b))
+`define NEST0(a) `INC(a)
+`define NEST1(a) `NEST0(`NEST0(a))
+`define NEST2(a) `NEST1(`NEST1(a))
+`define NEST3(a) `NEST2(`NEST2(a))
+`define NEST4(a) `NEST3(`NEST3(a))
+`define NEST5(a) `NEST4(`NEST4(a))
+`define NEST6(a) `NEST5(`NEST5(a))
+`define NEST7(a) `NEST6(`NEST6(a))
+`define NEST8(a) `NEST7(`NEST7(a))
+
+// Register map style, with pasted names
+`define REG(nm, addr) localparam int ADDR_``nm = addr;
+`define REGS(pre, base) `REG(pre``_ctrl, base) `REG(pre``_stat, (base) + 4)
+
+module t (/*AUTOARG*/);
+
+   localparam int N8 = `NEST8(0);
+   localparam int N6 = `NEST6(`NEST2(10));
+
+   `REGS(uart, 'h100)
+   `REGS(spi, 'h200)
+
+   initial begin
+      if (N8 != 256) $stop;
+      if (N6 != 10 + 256) $stop;
+      if (`INC(3, 4) != 7) $stop;
+      if (ADDR_uart_ctrl != 'h100) $stop;
+      if (ADDR_uart_stat != 'h104) $stop;
+      if (ADDR_spi_stat != 'h204) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
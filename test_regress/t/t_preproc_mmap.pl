@@ -0,0 +1,40 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("$Self->{obj_dir}/$Self->{name}.v");
+
+# A file too large to cache is mapped and lexed in place, so check DOS
+# CR's are still stripped and errors still show the source line.
+{
+    my $lines = 3000;
+    my $wholefile = "`define ADD(a, b) ((a) + (b))\n";
+    $wholefile .= "module t;\n";
+    for (my $i = 0; $i < $lines; ++$i) {
+        $wholefile .= "   localparam int P$i = `ADD($i, 1);\n";
+    }
+    $wholefile .= "   initial if (P" . ($lines - 1) . " != $lines) \$stop;\n";
+    $wholefile .= "   wire x = undefined_sig;\n";
+    $wholefile .= "endmodule\n";
+    $wholefile =~ s/\n/\r\n/og;
+    write_wholefile($Self->{top_filename}, $wholefile);
+}
+
+lint(
+    fails => 1,
+    );
+
+file_grep("$Self->{obj_dir}/vlt_compile.log",
+          qr/$Self->{name}.v:3004:\d+: Can't find definition of variable: 'undefined_sig'/);
+file_grep("$Self->{obj_dir}/vlt_compile.log", qr/3004 \|    wire x = undefined_sig;\n/);
+
+ok(1);
+1;
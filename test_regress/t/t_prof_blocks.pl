@@ -0,0 +1,37 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    verilator_flags2 => ["--prof-blocks"],
+    );
+
+execute(
+    all_run_flags => ["+verilator+prof+blocks+file+$Self->{obj_dir}/profile_blocks.dat"],
+    check_finished => 1,
+    );
+
+file_grep("$Self->{obj_dir}/profile_blocks.dat", qr/^VLPROF blocks [1-9]/m);
+file_grep("$Self->{obj_dir}/profile_blocks.dat",
+          qr/^VLPROF block 0 cycles \d+ calls \d+ \S+ \S+ \S*t_EXAMPLE\.v:\d+$/m);
+
+run(cmd => ["$ENV{VERILATOR_ROOT}/bin/verilator_profcfunc",
+            "$Self->{obj_dir}/profile_blocks.dat",
+            "> $Self->{obj_dir}/blocks.out"],
+    check_finished => 0);
+
+file_grep("$Self->{obj_dir}/blocks.out", qr/Verilog block profile/);
+file_grep("$Self->{obj_dir}/blocks.out", qr/ALWAYS\s+\S+ \S*t_EXAMPLE\.v:\d+/);
+
+ok(1);
+1;
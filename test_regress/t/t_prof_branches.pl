@@ -0,0 +1,36 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    verilator_flags2 => ["--prof-branches"],
+    );
+
+execute(
+    all_run_flags => ["+verilator+prof+branches+file+$Self->{obj_dir}/profile_branches.dat"],
+    check_finished => 1,
+    );
+
+file_grep("$Self->{obj_dir}/profile_branches.dat", qr/^VLPROF branches \d+/m);
+file_grep("$Self->{obj_dir}/profile_branches.dat", qr/^VLPROF branch 0 taken \d+ nottaken \d+/m);
+
+# Feed the profile back; same design and options so it must match
+compile(
+    verilator_flags2 => ["--prof-branches --stats",
+                         "--prof-branches-feedback $Self->{obj_dir}/profile_branches.dat"],
+    );
+
+file_grep($Self->{stats}, qr/Optimizations, Branch feedback predictions changed\s+\d+/i);
+
+ok(1);
+1;
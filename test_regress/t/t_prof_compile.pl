@@ -0,0 +1,46 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+my $map = "$Self->{obj_dir}/$Self->{VM_PREFIX}__cfiles.map";
+file_grep($map, qr/^# C\+\+ file\tC\+\+ function\tVerilog modules\tAST nodes$/m);
+file_grep($map, qr/^$Self->{VM_PREFIX}\S*\.cpp\t\S+::_eval\t\S+\t\d+$/m);
+
+# clang may not be the compiler here, so time a hand written trace
+my ($file, $eval, $mod) = (file_contents($map) =~ /^(\S+)\.cpp\t(\S+::_eval)\t(\S+)\t/m);
+mkdir "$Self->{obj_dir}/trace";
+write_wholefile("$Self->{obj_dir}/trace/${file}.json",
+                '{"traceEvents":['
+                .'{"ph":"X","name":"Total ExecuteCompiler","ts":0,"dur":2000000},'
+                .'{"ph":"X","name":"OptFunction","ts":100,"dur":500000,'
+                .'"args":{"detail":"'.$eval.'"}}]}'."\n");
+
+run(cmd => ["$ENV{VERILATOR_ROOT}/bin/verilator_profcompile",
+            "--map", $map,
+            "$Self->{obj_dir}/trace/${file}.json",
+            "> $Self->{obj_dir}/profcompile.log"],
+    check_finished => 0);
+
+file_grep("$Self->{obj_dir}/profcompile.log", qr/Total 2.00 s in 1 translation units/);
+file_grep("$Self->{obj_dir}/profcompile.log", qr/^ +\d+\.\d+ +\S+% +0\.500 +\S+ +\Q$mod\E$/m);
+file_grep("$Self->{obj_dir}/profcompile.log", qr/^ +0\.500 +25\.0% +\Q$eval\E /m);
+
+ok(1);
+1;
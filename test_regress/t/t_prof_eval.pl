@@ -0,0 +1,36 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    verilator_flags2 => ["--prof-eval"],
+    );
+
+execute(
+    all_run_flags => ["+verilator+prof+eval+file+$Self->{obj_dir}/profile_eval.dat"],
+    check_finished => 1,
+    );
+
+my $dat = "$Self->{obj_dir}/profile_eval.dat";
+file_grep($dat, qr/^VLPROF eval evals [1-9]/m);
+file_grep($dat, qr/^VLPROF eval iterations 1 count [1-9]/m);
+file_grep($dat, qr/^VLPROF eval iterations 16\+ count \d+/m);
+file_grep($dat, qr/^VLPROF eval settle_iterations [1-9]/m);
+if ($Self->{vltmt}) {
+    file_grep($dat, qr/^VLPROF eval mtasks [1-9]/m);
+} else {
+    file_grep($dat, qr/^VLPROF eval domain 0 triggers [1-9]\d* \@\(posedge \S*clk\)/m);
+}
+
+ok(1);
+1;
@@ -0,0 +1,36 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    verilator_flags2 => ["--prof-live"],
+    );
+
+execute(
+    all_run_flags => ["+verilator+prof+live+file+$Self->{obj_dir}/profile_live.dat"],
+    check_finished => 1,
+    );
+
+run(cmd => ["$ENV{VERILATOR_ROOT}/bin/verilator_top", "--once",
+            "$Self->{obj_dir}/profile_live.dat",
+            "> $Self->{obj_dir}/live.out"],
+    check_finished => 0);
+
+file_grep("$Self->{obj_dir}/live.out", qr/profile_live\.dat  top  pid \d+  finished/);
+file_grep("$Self->{obj_dir}/live.out", qr/^  evals\s+[1-9]\d*\s+evals\/s/m);
+if ($Self->{vltmt}) {
+    file_grep("$Self->{obj_dir}/live.out", qr/^  workers\s+[1-9]/m);
+}
+
+ok(1);
+1;
@@ -0,0 +1,43 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_EXAMPLE.v");
+
+compile(
+    verilator_flags2 => ["--prof-sample"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+my $map = "$Self->{obj_dir}/$Self->{VM_PREFIX}__cfuncs.map";
+file_grep($map, qr/^\S+::_eval\t\S+\t\S*t_EXAMPLE\.v:\d+/m);
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}_classes.mk", qr/^VM_PROF_SAMPLE = 1/m);
+
+# perf itself may not be permitted here, so map a hand written sample
+my $eval = (file_contents($map) =~ /^(\S+::_eval)\t/m)[0];
+write_wholefile("$Self->{obj_dir}/perf.txt",
+                "$Self->{VM_PREFIX} 100 [000] 1.000: 1 cpu-clock:\n"
+                ."\t    401000 ${eval}($Self->{VM_PREFIX}__Syms*)+0x10 (/bin/model)\n"
+                ."\t    400000 main+0x20 (/bin/model)\n\n");
+
+run(cmd => ["$ENV{VERILATOR_ROOT}/bin/verilator_profsample",
+            "--map", $map,
+            "$Self->{obj_dir}/perf.txt",
+            "> $Self->{obj_dir}/perf.folded"],
+    check_finished => 0);
+
+file_grep("$Self->{obj_dir}/perf.folded", qr/^main;\S+ \S*t_EXAMPLE\.v:\d+ 1$/m);
+
+ok(1);
+1;
@@ -0,0 +1,23 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vltmt => 1);
+
+top_filename("t/t_threads_counter.v");
+
+compile(
+    verilator_flags2 => ["--cc --threads 2 --prof-threads-feedback t/$Self->{name}.dat"],
+    fails => 1,
+    expect =>
+'%Warning-PROFOUTOFDATE: --prof-threads-feedback profile does not match design .*',
+    );
+
+ok(1);
+1;
@@ -0,0 +1,58 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "secret_protectlib.h"
+
+//======================================================================
+
+#define CHECK_RESULT_HEX(got, exp) \
+    do { \
+        if ((got) != (exp)) { \
+            std::printf("%%Error: %s:%d: GOT = %llx   EXP = %llx\n", __FILE__, __LINE__, \
+                        static_cast<unsigned long long>(got), \
+                        static_cast<unsigned long long>(exp)); \
+            std::exit(1); \
+        } \
+    } while (0)
+
+int main(int argc, char** argv, char** env) {
+    secret_protectlib_check_hash(secret_protectlib_hash);
+    void* handlep = secret_protectlib_create("top.secret");
+
+    secret_protectlib_ports ports;
+    std::memset(&ports, 0, sizeof(ports));
+    ports.accum_in = 1;
+    ports.s8_in = 0xa5;
+    ports.s64_in = 0x0123456789abcdefULL;
+    ports.s129_in[0] = 0x11111111;
+    ports.s129_in[4] = 0x1;
+
+    for (int cyc = 0; cyc < 10; ++cyc) {
+        ports.clk = 0;
+        secret_protectlib_eval(handlep, &ports);
+        ports.clk = 1;
+        secret_protectlib_eval(handlep, &ports);
+        // Each posedge adds accum_in plus the secret value of 7
+        CHECK_RESULT_HEX(ports.accum_out, (cyc + 1) * 8);
+    }
+    CHECK_RESULT_HEX(ports.s8_out, 0xa5);
+    CHECK_RESULT_HEX(ports.s64_out, 0x0123456789abcdefULL);
+    CHECK_RESULT_HEX(ports.s129_out[0], 0x11111111);
+    CHECK_RESULT_HEX(ports.s129_out[4], 0x1);
+
+    secret_protectlib_final(handlep);
+    std::printf("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,75 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include VM_PREFIX_INCLUDE
+#include "verilated.h"
+#include "verilated_syms.h"
+
+#include <cstdio>
+
+double main_time = 0;
+double sc_time_stamp() { return main_time; }
+
+static void* observed(const VerilatedScope* scopep, const char* namep, VerilatedVarType vltype) {
+    const VerilatedVar* varp = scopep->varFind(namep);
+    if (!varp) vl_fatal(__FILE__, __LINE__, "main", (std::string("No var ") + namep).c_str());
+    if (varp->vltype() != vltype) {
+        vl_fatal(__FILE__, __LINE__, "main", (std::string("Wrong type for ") + namep).c_str());
+    }
+    return varp->datap();
+}
+
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) { \
+        std::printf("%%Error: %s:%d: cyc=%d GOT = %x  EXP = %x\n", __FILE__, __LINE__, cyc, \
+                    (got), (exp)); \
+        exit(1); \
+    }
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+
+    VM_PREFIX* topp = new VM_PREFIX("");  // Note null name - we're flattening it out
+
+    const VerilatedScope* scopep = Verilated::scopeFind("t.sub");
+    if (!scopep) {
+        Verilated::scopesDump();
+        vl_fatal(__FILE__, __LINE__, "main", "No scope t.sub");
+    }
+    const vluint32_t* sqp = static_cast<vluint32_t*>(observed(scopep, "sq", VLVT_UINT32));
+    const vluint32_t* lastp = static_cast<vluint32_t*>(observed(scopep, "last", VLVT_UINT32));
+    const vluint32_t* widep = static_cast<vluint32_t*>(observed(scopep, "wide", VLVT_WDATA));
+
+    topp->clk = 0;
+    topp->eval();
+    int prev = 0;
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+        main_time += 1;
+        topp->clk = !topp->clk;
+        topp->eval();
+        int cyc = topp->cyc;
+        // Each observed signal is up to date after every eval()
+        CHECK_RESULT(*sqp, static_cast<vluint32_t>(cyc * cyc));
+        CHECK_RESULT(widep[0], static_cast<vluint32_t>(cyc));
+        CHECK_RESULT(widep[1], ~static_cast<vluint32_t>(cyc));
+        CHECK_RESULT(widep[2], static_cast<vluint32_t>(cyc));
+        if (topp->clk && cyc > 0) CHECK_RESULT(*lastp, static_cast<vluint32_t>(prev));
+        prev = cyc;
+    }
+    if (!Verilated::gotFinish()) {
+        vl_fatal(__FILE__, __LINE__, "main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+
+    VL_DO_DANGLING(delete topp, topp);
+    exit(0L);
+}
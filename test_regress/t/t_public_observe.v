@@ -0,0 +1,47 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   cyc,
+   // Inputs
+   clk
+   );
+   input clk;
+   output int cyc;
+
+   initial cyc = 0;
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 20) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+
+   sub sub (/*AUTOINST*/
+            // Inputs
+            .clk                        (clk),
+            .cyc                        (cyc));
+endmodule
+
+module sub (/*AUTOARG*/
+   // Inputs
+   clk, cyc
+   );
+   input clk;
+   input int cyc;
+
+   // None of these are read in the design, so without observing they'd be removed
+   int sq /*verilator public_observe*/;
+   int last /*verilator public_observe*/;
+   logic [99:0] wide /*verilator public_observe*/;
+
+   assign sq = cyc * cyc;
+   assign wide = {4'h0, cyc, ~cyc, cyc};
+   initial last = 0;
+   always @ (posedge clk) last <= cyc;
+endmodule
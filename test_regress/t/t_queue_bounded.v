@@ -7,6 +7,9 @@
 module t (/*AUTOARG*/);
 
    int q[$ : 2];  // Shall not go higher than [2], i.e. size 3
+   int u[$];
+   int i;
+   string s;
 
    initial begin
       q.push_front(3);
@@ -32,6 +35,31 @@ module t (/*AUTOARG*/);
       if (q[1] != 1) $stop;
       if (q[2] != 2) $stop;
 
+      // Wrap around the end of the storage
+      for (i = 3; i < 10; i = i + 1) begin
+         if (q.pop_front() != i - 3) $stop;
+         q.push_back(i);
+         if (q.size() != 3) $stop;
+         if (q[2] != i) $stop;
+      end
+      q.push_front(6);
+      s = $sformatf("%p", q);
+      if (s != "'{6, 7, 8} ") $stop;
+
+      // Unbounded grows past its initial storage, keeping order
+      for (i = 0; i < 100; i = i + 1) begin
+         if (i % 2 == 0) u.push_back(i);
+         else u.push_front(i);
+      end
+      if (u.size() != 100) $stop;
+      if (u[0] != 99) $stop;
+      if (u[49] != 1) $stop;
+      if (u[50] != 0) $stop;
+      if (u[99] != 98) $stop;
+      if (u.pop_back() != 98) $stop;
+      if (u.pop_front() != 99) $stop;
+      if (u.size() != 98) $stop;
+
       $write("*-* All Finished *-*\n");
       $finish;
    end
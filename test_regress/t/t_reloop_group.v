@@ -0,0 +1,39 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+
+   reg [31:0] src [0:63];
+   reg [31:0] dbl [0:127];
+   reg [31:0] mix [0:63];
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      for (int i = 0; i < 64; ++i) begin
+         // Two statements per iteration, with different index strides
+         dbl[i * 2] = src[63 - i] + cyc;
+         mix[i] = dbl[i * 2] ^ src[i];
+      end
+      if (cyc == 0) begin
+         for (int i = 0; i < 64; ++i) src[i] <= i * 3;
+      end
+      else if (cyc == 2) begin
+         // mix[i] = (3 * (63 - i) + cyc) ^ (3 * i)
+         if (mix[0] !== 32'd191) $stop;
+         if (mix[63] !== (32'd2 ^ 32'd189)) $stop;
+      end
+      else if (cyc == 9) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,48 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test driver/expect definition
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+#include <verilated.h>
+#include <cstdio>
+#include "Vt_run_cycles.h"
+
+double sc_time_stamp() { return 0; }
+
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) { \
+        printf("%%Error: %s:%d: GOT = %llu  EXP = %llu\n", __FILE__, __LINE__, \
+               static_cast<unsigned long long>(got), static_cast<unsigned long long>(exp)); \
+        return 10; \
+    }
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Vt_run_cycles* topp = new Vt_run_cycles;
+    topp->clk = 0;
+    topp->stop = 0;
+
+    // Initializes the model on the first call
+    CHECK_RESULT(topp->runCycles(topp->clk, 1000), 1000);
+    CHECK_RESULT(topp->count, 1000);
+    CHECK_RESULT(topp->clk, 0);
+    CHECK_RESULT(topp->runCycles(topp->clk, 0), 0);
+    CHECK_RESULT(topp->runCycles(topp->clk, 24), 24);
+    CHECK_RESULT(topp->count, 1024);
+
+    // Stops at the edge with $finish
+    topp->stop = 1;
+    CHECK_RESULT(topp->runCycles(topp->clk, 100), 1);
+    CHECK_RESULT(topp->count, 1025);
+    CHECK_RESULT(Verilated::gotFinish(), true);
+
+    topp->final();
+    delete topp;
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
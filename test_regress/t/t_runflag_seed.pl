@@ -14,12 +14,12 @@ compile(
     );
 
 execute(
-    all_run_flags => ["+verilator+seed+5 +SEED=fffffff4"],
+    all_run_flags => ["+verilator+seed+5 +SEED=ca54cf69"],
     fails => 0,
     );
 
 execute(
-    all_run_flags => ["+verilator+seed+6 +SEED=fffffff2"],
+    all_run_flags => ["+verilator+seed+6 +SEED=b226f385"],
     fails => 0,
     );
 
@@ -0,0 +1,73 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+#include <verilated_save.h>
+
+#include VM_PREFIX_INCLUDE
+
+#define FILENAME(name) VL_STRINGIFY(TEST_OBJ_DIR) "/" name
+
+VM_PREFIX* topp;
+vluint64_t main_time = 0;
+double sc_time_stamp() { return (double)main_time; }
+
+// Kept open after save_model, so the background write overlaps simulation
+VerilatedSave* asyncp = NULL;
+
+static void save_model(VerilatedSave& os, const char* filenamep) {
+    VL_PRINTF("Saving model to '%s'\n", filenamep);
+    os.open(filenamep);
+    os << main_time;
+    os << *topp;
+    os.close();
+}
+
+static void restore_model(const char* filenamep) {
+    VL_PRINTF("Restoring model from '%s'\n", filenamep);
+    VerilatedRestore os;
+    os.open(filenamep);
+    os >> main_time;
+    os >> *topp;
+    os.close();
+}
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    topp = new VM_PREFIX("top");
+
+    const bool save_restore = Verilated::commandArgsPlusMatch("save_restore")[0];
+    if (save_restore) {
+        restore_model(FILENAME("saved.vltsv"));
+    } else {
+        topp->clk = 0;
+        topp->eval();
+    }
+
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+        if (!save_restore && main_time == 40) {
+            VerilatedSave os;
+            save_model(os, FILENAME("saved_plain.vltsv"));
+            asyncp = new VerilatedSave;
+            asyncp->compress(true);
+            asyncp->async(true);
+            save_model(*asyncp, FILENAME("saved.vltsv"));
+        }
+        topp->clk = !topp->clk;
+        topp->eval();
+        ++main_time;
+    }
+    if (!Verilated::gotFinish()) {
+        vl_fatal(__FILE__, __LINE__, "main", "%Error: Timeout; never got a $finish");
+    }
+    if (asyncp) VL_DO_DANGLING(delete asyncp, asyncp);  // Waits for the write
+    topp->final();
+    VL_DO_DANGLING(delete topp, topp);
+    return 0;
+}
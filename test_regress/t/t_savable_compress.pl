@@ -0,0 +1,37 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_savable_delta.v");
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--savable --threads 1 --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+my $plain = -s "$Self->{obj_dir}/saved_plain.vltsv";
+my $comp = -s "$Self->{obj_dir}/saved.vltsv";
+$plain or error("saved_plain.vltsv not created\n");
+$comp or error("saved.vltsv not created\n");
+($plain && $comp && $comp < $plain) or error("saved.vltsv not smaller than uncompressed\n");
+
+execute(
+    all_run_flags => ['+save_restore'],
+    check_finished => 1,
+    );
+
+ok(1);
+1;
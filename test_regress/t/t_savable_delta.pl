@@ -0,0 +1,38 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--savable --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+my $base = -s "$Self->{obj_dir}/saved_0.vltsv";
+$base or error("saved_0.vltsv not created\n");
+foreach my $delta ("saved_1.vltsv", "saved_2.vltsv") {
+    my $size = -s "$Self->{obj_dir}/$delta";
+    $size or error("$delta not created\n");
+    # Only a few pages of the memory change between checkpoints
+    ($size && $size * 4 < $base) or error("$delta not smaller than first checkpoint\n");
+}
+
+execute(
+    all_run_flags => ['+save_restore'],
+    check_finished => 1,
+    );
+
+ok(1);
+1;
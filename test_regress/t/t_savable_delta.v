@@ -0,0 +1,42 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer      cyc = 0;
+   integer      i;
+   // Large enough that the deltas are much smaller than the first checkpoint
+   reg [31:0]   mem [262143:0];
+
+   initial begin
+      for (i = 0; i < 262144; i = i + 1) mem[i] = i;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      mem[(cyc * 97) % 262144] <= mem[(cyc * 97) % 262144] + cyc;
+      if (cyc == 1) begin
+         if ($test$plusargs("save_restore") != 0) begin
+            // Don't allow the restored model to run from time 0, it must run from a restore
+            $write("%%Error: didn't really restore\n");
+            $stop;
+         end
+      end
+      else if (cyc == 99) begin
+         if (mem[0] !== 0) $stop;
+         if (mem[1] !== 1) $stop;
+         for (i = 1; i < 99; i = i + 1) begin
+            if (mem[i * 97] !== i * 97 + i) $stop;
+         end
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
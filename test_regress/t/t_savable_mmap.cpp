@@ -0,0 +1,78 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+#include <verilated_save.h>
+
+#include <fstream>
+#include <string>
+
+#include VM_PREFIX_INCLUDE
+
+#define FILENAME(name) VL_STRINGIFY(TEST_OBJ_DIR) "/" name
+
+VM_PREFIX* topp;
+vluint64_t main_time = 0;
+double sc_time_stamp() { return (double)main_time; }
+
+static void save_model(const char* filenamep) {
+    VL_PRINTF("Saving model to '%s'\n", filenamep);
+    VerilatedSave os;
+    os.open(filenamep);
+    os << main_time;
+    os << *topp;
+    os.close();
+}
+
+static void restore_model(const char* filenamep) {
+    VL_PRINTF("Restoring model from '%s'\n", filenamep);
+    VerilatedRestore os;
+    os.open(filenamep);
+    os >> main_time;
+    os >> *topp;
+    os.close();
+}
+
+static bool is_mapped(const char* filenamep) {
+    // Linux lists the checkpoint in the process mappings while mapped
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    const std::string name = std::string(filenamep).substr(std::string(filenamep).rfind('/'));
+    while (std::getline(maps, line)) {
+        if (line.find(name) != std::string::npos) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    topp = new VM_PREFIX("top");
+
+    const bool save_restore = Verilated::commandArgsPlusMatch("save_restore")[0];
+    if (save_restore) {
+        restore_model(FILENAME("saved.vltsv"));
+        VL_PRINTF("Memory mapped: %d\n", is_mapped(FILENAME("saved.vltsv")));
+    } else {
+        topp->clk = 0;
+        topp->eval();
+    }
+
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+        if (!save_restore && main_time == 40) save_model(FILENAME("saved.vltsv"));
+        topp->clk = !topp->clk;
+        topp->eval();
+        ++main_time;
+    }
+    if (!Verilated::gotFinish()) {
+        vl_fatal(__FILE__, __LINE__, "main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+    VL_DO_DANGLING(delete topp, topp);
+    return 0;
+}
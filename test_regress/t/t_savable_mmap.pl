@@ -0,0 +1,38 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_savable_delta.v");
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--savable --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+# The array is saved as one block, not element by element
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/writeAligned\(&t__DOT__mem, sizeof\(t__DOT__mem\)\)/);
+
+execute(
+    check_finished => 1,
+    );
+
+execute(
+    all_run_flags => ['+save_restore'],
+    check_finished => 1,
+    );
+
+if ($^O eq 'linux') {
+    file_grep($Self->{run_log_filename}, qr/Memory mapped: 1/);
+}
+
+ok(1);
+1;
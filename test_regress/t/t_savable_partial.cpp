@@ -0,0 +1,58 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+#include <verilated_save.h>
+
+#include VM_PREFIX_INCLUDE
+
+#define FILENAME(name) VL_STRINGIFY(TEST_OBJ_DIR) "/" name
+
+VM_PREFIX* topp;
+vluint64_t main_time = 0;
+double sc_time_stamp() { return (double)main_time; }
+
+static void save_model(const char* filenamep) {
+    VL_PRINTF("Saving model to '%s'\n", filenamep);
+    VerilatedSave os;
+    os.open(filenamep);
+    os << *topp;
+    os.close();
+}
+
+static void restore_scope(const char* filenamep, const char* scopep) {
+    VL_PRINTF("Restoring scope '%s' from '%s'\n", scopep, filenamep);
+    VerilatedRestore os;
+    os.scopePrefix(scopep);
+    os.open(filenamep);
+    os >> *topp;
+    VL_PRINTF("Skipped %d scopes\n", static_cast<int>(os.sectionsSkipped()));
+    os.close();
+}
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    topp = new VM_PREFIX("top");
+
+    topp->clk = 0;
+    topp->eval();
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+        if (main_time == 40) save_model(FILENAME("saved.vltsv"));
+        if (main_time == 80) restore_scope(FILENAME("saved.vltsv"), "t.a");
+        topp->clk = !topp->clk;
+        topp->eval();
+        ++main_time;
+    }
+    if (!Verilated::gotFinish()) {
+        vl_fatal(__FILE__, __LINE__, "main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+    VL_DO_DANGLING(delete topp, topp);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--savable --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+# Each scope is saved in its own section
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__Syms.cpp", qr/__VserializeScope\(os, "t.a"\)/);
+
+execute(
+    check_finished => 1,
+    );
+
+# TOP and t.b are skipped
+file_grep($Self->{run_log_filename}, qr/Skipped 2 scopes/);
+
+ok(1);
+1;
@@ -0,0 +1,42 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer      cyc = 0;
+
+   sub a (.clk(clk));
+   sub b (.clk(clk));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      // Only t.a is restored, 20 cycles back, at cycle 40
+      if (b.cnt !== cyc) $stop;
+      if (cyc == 60) begin
+         if (a.cnt !== 40) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+module sub (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+   /*verilator no_inline_module*/  // So each instance is a scope
+
+   integer      cnt = 0;
+
+   always @ (posedge clk) begin
+      cnt <= cnt + 1;
+   end
+endmodule
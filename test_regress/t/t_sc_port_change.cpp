@@ -0,0 +1,81 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include VM_PREFIX_INCLUDE
+
+bool pass = true;
+
+#define CHECK(got, exp) \
+    if ((got) != (exp)) { \
+        VL_PRINTF("%%Error: %s:%d: %s mismatch, got=%s, exp=%s\n", __FILE__, __LINE__, #got, \
+                  (got).to_string().c_str(), (exp).to_string().c_str()); \
+        pass = false; \
+    }
+
+int sc_main(int, char**) {
+    Verilated::debug(0);
+    VM_PREFIX* tb = new VM_PREFIX("tb");
+
+    sc_signal<bool> clk;
+    sc_signal<vluint32_t> i8;
+    sc_signal<vluint32_t> o8;
+    sc_signal<sc_biguint<130> > i130;
+    sc_signal<sc_biguint<130> > o130;
+    sc_signal<sc_bv<520> > i520;
+    sc_signal<sc_bv<520> > o520;
+    sc_signal<sc_bv<520> > oc520;
+    tb->clk(clk);
+    tb->i8(i8);
+    tb->o8(o8);
+    tb->i130(i130);
+    tb->o130(o130);
+    tb->i520(i520);
+    tb->o520(o520);
+    tb->oc520(oc520);
+
+    sc_biguint<130> flip = 1;
+    flip[129] = 1;
+    flip[128] = 1;
+    vluint64_t seed = 1;
+    for (int cyc = 0; cyc < 40; ++cyc) {
+        // Every third cycle keeps the inputs, and so the outputs
+        if (cyc % 3 != 2) {
+            sc_biguint<130> v130;
+            sc_bv<520> v520;
+            for (int i = 0; i < 520; i += 26) {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                const vluint32_t bits = static_cast<vluint32_t>(seed >> 38);
+                v520.range(i + 25, i) = bits;
+                if (i < 130) v130.range(i + 25, i) = bits;
+            }
+            i8.write(cyc & 0xff);
+            i130.write(v130);
+            i520.write(v520);
+        }
+        sc_start(1, SC_NS);
+        CHECK(oc520.read(), ~i520.read());
+        clk.write(true);
+        sc_start(1, SC_NS);
+        clk.write(false);
+        sc_start(1, SC_NS);
+        if (o8.read() != ((i8.read() + 1) & 0xff)) {
+            VL_PRINTF("%%Error: o8 mismatch, got=%x\n", o8.read());
+            pass = false;
+        }
+        CHECK(o130.read(), i130.read() ^ flip);
+        CHECK(o520.read(), i520.read());
+        CHECK(oc520.read(), ~i520.read());
+    }
+
+    tb->final();
+    delete tb;
+    if (pass) {
+        VL_PRINTF("*-* All Finished *-*\n");
+    } else {
+        vl_fatal(__FILE__, __LINE__, "top", "Unexpected results from test\n");
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--exe $Self->{t_dir}/$Self->{name}.cpp --sc --pins-sc-biguint"],
+    );
+
+if ($Self->{vlt_all}) {
+    my $cpp = "$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp";
+    file_grep($cpp, qr/VL_ASSIGN_SII_CHG\(8,/);
+    file_grep($cpp, qr/VL_ASSIGN_SBW_CHG\(130,/);
+    file_grep($cpp, qr/VL_ASSIGN_SWW_CHG\(520,/);
+    file_grep($cpp, qr/VL_ASSIGN_WSW_EVT\(520,/);
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/__Vscout__o520\[17\];/);
+}
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,30 @@
+// DESCRIPTION: Verilator: SystemC ports set only when changed
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   o8, o130, o520, oc520,
+   // Inputs
+   clk, i8, i130, i520
+   );
+   input clk;
+   input [7:0] i8;
+   input [129:0] i130;
+   input [519:0] i520;
+   output reg [7:0] o8;
+   output reg [129:0] o130;
+   output reg [519:0] o520;
+   output [519:0] oc520;
+
+   // Combinational, so eval() is sensitive to i520
+   assign oc520 = ~i520;
+
+   always @(posedge clk) begin
+      o8 <= i8 + 8'd1;
+      o130 <= i130 ^ {2'b11, 127'd0, 1'b1};
+      o520 <= i520;
+   end
+endmodule
@@ -0,0 +1,53 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [31:0] in;
+   wire [31:0] out0, out1, out2, out3;
+
+   core c0 (.clk, .in(in), .out(out0));
+   core c1 (.clk, .in(in + 32'd1), .out(out1));
+   core c2 (.clk, .in(in + 32'd2), .out(out2));
+   core c3 (.clk, .in(in + 32'd3), .out(out3));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      in <= cyc;
+      if (cyc == 5) begin
+         // in, then mid, then out each add a cycle of delay
+         if (out0 !== ((32'd2 ^ 32'h5a) + 32'd2)) $stop;
+         if (out3 !== ((32'd5 ^ 32'h5a) + 32'd5)) $stop;
+      end
+      else if (cyc == 9) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+module core (/*AUTOARG*/
+   // Outputs
+   out,
+   // Inputs
+   clk, in
+   );
+   /*verilator no_inline_module*/
+   input clk;
+   input [31:0] in;
+   output reg [31:0] out;
+
+   reg [31:0] mid;
+   always @ (posedge clk) begin
+      mid <= in;
+      out <= (mid ^ 32'h5a) + mid;
+   end
+endmodule
@@ -0,0 +1,51 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+
+#include VM_PREFIX_INCLUDE
+
+VM_PREFIX* topp;
+vluint64_t main_time = 0;
+double sc_time_stamp() { return (double)main_time; }
+
+static void run(int cycles) {
+    for (int i = 0; i < cycles * 2; ++i) {
+        topp->clk = !topp->clk;
+        topp->eval();
+        ++main_time;
+    }
+}
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    topp = new VM_PREFIX("top");
+    topp->clk = 0;
+    topp->in = 1;
+    topp->eval();
+    run(5);
+
+    // Try each stimulus from the same point; memory is rewound with the
+    // rest of the process, so the trial number is passed by rewind()
+    const int id = Verilated::snapshot();
+    const int trial = (id < 0) ? Verilated::rewindValue() : 0;
+    if (id < 0 && main_time != 10) {
+        vl_fatal(__FILE__, __LINE__, "main", "%Error: Rewound to wrong time");
+    }
+    topp->in = 2 + trial;
+    run(5);
+    VL_PRINTF("Trial %d sum %d\n", trial, topp->sum);
+    if (trial < 2) Verilated::rewind(id < 0 ? -id : id, trial + 1);
+
+    if (topp->sum != 5 + 5 * 4) vl_fatal(__FILE__, __LINE__, "main", "%Error: Bad sum");
+    topp->final();
+    VL_DO_DANGLING(delete topp, topp);
+    VL_PRINTF("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,28 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   sum,
+   // Inputs
+   clk, in
+   );
+   input clk;
+   input [7:0] in;
+   output reg [31:0] sum;
+
+   integer fd;
+
+   initial begin
+      sum = 0;
+      fd = $fopen({`STRINGIFY(`TEST_OBJ_DIR), "/sums.log"}, "w");
+   end
+
+   always @ (posedge clk) begin
+      sum <= sum + {24'b0, in};
+      $fwrite(fd, "%0d\n", sum + {24'b0, in});
+   end
+endmodule
@@ -0,0 +1,33 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   logic [3:0] in;
+   logic [3:0] chain;  // Each bit computed from the previous one
+
+   always_comb begin
+      chain[0] = in[0];
+      chain[1] = chain[0] ^ in[1];
+      chain[2] = chain[1] ^ in[2];
+      chain[3] = chain[2] ^ in[3];
+   end
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      in <= cyc[3:0];
+      if (cyc > 1 && chain[3] != ^in) $stop;
+      if (cyc == 20) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,96 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+typedef struct packed {
+   logic       valid;
+   logic [7:0] tag;
+   logic [15:0] data;
+} entry_t;
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [63:0] crc = 64'h5aef0c8d_d70a4497;
+
+   entry_t cam [0:15];  // Split into an array per field
+   logic [24:0] flat [0:15];  // Same contents, for checking
+   entry_t whole [0:3];  // Mostly referenced whole, not split
+
+   wire [3:0]  wr_idx = crc[3:0];
+   wire [7:0]  wr_tag = {4'h0, crc[7:4]};
+   wire [15:0] wr_data = crc[31:16];
+   wire [7:0]  key = {4'h0, crc[11:8]};
+
+   logic       hit;
+   logic [15:0] hit_data;
+   logic       flat_hit;
+   logic [15:0] flat_hit_data;
+
+   always_comb begin
+      hit = 1'b0;
+      hit_data = 16'h0;
+      for (int i = 0; i < 16; i++) begin
+         if (cam[i].valid && cam[i].tag == key) begin
+            hit = 1'b1;
+            hit_data = cam[i].data;
+         end
+      end
+   end
+
+   always_comb begin
+      flat_hit = 1'b0;
+      flat_hit_data = 16'h0;
+      for (int i = 0; i < 16; i++) begin
+         if (flat[i][24] && flat[i][23:16] == key) begin
+            flat_hit = 1'b1;
+            flat_hit_data = flat[i][15:0];
+         end
+      end
+   end
+
+   entry_t rd;
+   entry_t prev_rd;
+   assign rd = cam[crc[15:12]];
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63] ^ crc[2] ^ crc[0]};
+      if (cyc < 5) begin
+         for (int i = 0; i < 16; i++) begin
+            cam[i] <= '0;
+            flat[i] <= '0;
+         end
+      end
+      else begin
+         if (crc[32]) begin
+            cam[wr_idx] <= {1'b1, wr_tag, wr_data};
+            flat[wr_idx] <= {1'b1, wr_tag, wr_data};
+         end
+         else if (crc[33]) begin
+            cam[wr_idx].valid <= 1'b0;
+            flat[wr_idx][24] <= 1'b0;
+         end
+         if (hit !== flat_hit || hit_data !== flat_hit_data) $stop;
+         if (rd !== flat[crc[15:12]]) $stop;
+      end
+      whole[cyc[1:0]] <= rd;
+      prev_rd <= rd;
+      if (cyc > 6 && whole[cyc[1:0] - 2'd1] !== prev_rd) $stop;
+      if (cyc > 6 && whole[cyc[1:0] - 2'd1].valid !== prev_rd.valid) $stop;
+`ifdef TEST_VERBOSE
+      $write("[%0t] hit=%b data=%x\n", $time, hit, hit_data);
+`endif
+      if (cyc == 99) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+
+endmodule
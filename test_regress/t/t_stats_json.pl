@@ -0,0 +1,28 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+my $json = "$Self->{obj_dir}/passes.json";
+
+compile(
+    verilator_flags2 => ["--stats-json $json"],
+    );
+
+file_grep($json, qr/"name": "linkparse", "wall_us": \d+, "cpu_us": \d+/);
+file_grep($json, qr/"name": "const", .*"nodes_delta": -?\d+\}/);
+file_grep($json, qr/"mem_peak_bytes": \d+/);
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
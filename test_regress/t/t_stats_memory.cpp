@@ -0,0 +1,39 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+
+#include VM_PREFIX_INCLUDE
+
+unsigned long long main_time = 0;
+double sc_time_stamp() { return (double)main_time; }
+
+int main(int argc, char** argv, char** env) {
+    VM_PREFIX* top = new VM_PREFIX("top");
+
+    top->clk = 0;
+    while (!Verilated::gotFinish() && main_time < 100) {
+        top->clk = !top->clk;
+        top->eval();
+        ++main_time;
+    }
+
+    VerilatedMemoryUsage usage;
+    top->memoryUsage(usage);
+    usage.print();
+    // 256 words of mem, and 16 double words of state in each sub
+    if (usage.bytes(VerilatedMemoryUsage::MEMORIES) < 256 * 4 + 2 * 16 * 8) {
+        vl_fatal(__FILE__, __LINE__, "main", "Memories too small");
+    }
+    if (usage.total() < sizeof(*top)) vl_fatal(__FILE__, __LINE__, "main", "Total too small");
+
+    top->final();
+    VL_DO_DANGLING(delete top, top);
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
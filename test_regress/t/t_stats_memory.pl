@@ -0,0 +1,33 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--stats --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute(
+    check_finished => 1,
+    expect => qr/memories +\d+ bytes.*total +\d+ bytes/s,
+    );
+
+my $report = "$Self->{obj_dir}/$Self->{VM_PREFIX}__stats_memory.txt";
+file_grep($report, qr/^Verilator Memory Footprint Report$/m);
+file_grep($report, qr/^  memories +\d+$/m);
+# Both instances of sub, 16 64-bit words of state each
+file_grep($report, qr/^ +2 +\d+ +128 +.* sub$/m);
+file_grep($report, qr/^ +\d+ +\d+  TOP\.t\.u_a \(sub\)$/m);
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__stats.txt", qr/Model memory, memories, bytes/);
+
+ok(1);
+1;
@@ -0,0 +1,45 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [31:0] mem [0:255];
+
+   sub u_a (.clk(clk));
+   sub u_b (.clk(clk));
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      mem[cyc[7:0]] <= cyc;
+      if (cyc == 9) begin
+         $write("mem[3] = %0d\n", mem[3]);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+module sub (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   /*verilator no_inline_module*/
+   input clk;
+
+   reg [63:0] state [0:15];
+   integer    i = 0;
+
+   always @(posedge clk) begin
+      i <= i + 1;
+      state[i[3:0]] <= state[i[3:0]] + 64'h1;
+      if (i == 9) $write("state[1] = %0d\n", state[1]);
+   end
+endmodule
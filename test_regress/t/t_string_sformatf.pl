@@ -0,0 +1,28 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(simulator => 1);
+
+compile(
+    );
+
+if ($Self->{vlt_all}) {
+    # Strings are formatted in place, except the one the format reads
+    file_grep_not("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/ = VL_SFORMATF_NX\("cycle/);
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/VL_SFORMAT_X\(0,/);
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/ = VL_SFORMATF_NX\("%@/);
+}
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,32 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   string s;
+   string log = "";
+   reg [99:0] wide = 100'h1_2345_6789_abcd_ef01_2345_6789;
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      // Formatted in place
+      s = $sformatf("cycle %0d of a message long enough to need the heap", cyc);
+      // Reads the string it formats
+      log = $sformatf("%s%0d,", log, cyc);
+      if (cyc == 3) begin
+         if (s != "cycle 3 of a message long enough to need the heap") $stop;
+         if (log != "0,1,2,3,") $stop;
+         s = $sformatf("%0d|%-5d|%5.2f|%0h", wide, 12, 3.14159, wide);
+         if (s != "90144042682896311822508713865|12   | 3.14|123456789abcdef0123456789") $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
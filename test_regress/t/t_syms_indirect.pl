@@ -0,0 +1,29 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_func_dotted.v");
+
+compile(
+    v_flags2 => ['+define+ATTRIBUTES', '+define+NOUSE_INLINE',],
+    verilator_flags2 => ["--syms-indirect --trace"],
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+my $syms = "$Self->{obj_dir}/$Self->{VM_PREFIX}__Syms.h";
+file_grep($syms, qr/^class $Self->{VM_PREFIX}_ma;/m);
+file_grep_not($syms, qr/#include "$Self->{VM_PREFIX}_ma.h"/);
+
+ok(1);
+1;
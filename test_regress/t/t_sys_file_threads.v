@@ -0,0 +1,61 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   integer fa;
+   integer fb;
+   reg [31:0] ra = 32'h1;
+   reg [31:0] rb = 32'h2;
+
+   initial begin
+      fa = $fopen({`STRINGIFY(`TEST_OBJ_DIR),"/t_sys_file_threads_a.log"}, "w");
+      fb = $fopen({`STRINGIFY(`TEST_OBJ_DIR),"/t_sys_file_threads_b.log"}, "w");
+      $fwrite(fa, "a start\n");
+      $fwrite(fb, "b start\n");
+   end
+
+   // Independent blocks so each may be in a different mtask
+   always @ (posedge clk) begin
+      if (cyc < 8) begin
+         ra <= ra * 3;
+         $fwrite(fa, "a[%0d] %x", cyc, ra);
+         $fwrite(fa, " +%0d\n", cyc * 2);
+      end
+      else if (cyc == 8) begin
+         $fflush(fa);
+         $fwrite(fa, "a end\n");
+         $fclose(fa);
+      end
+   end
+
+   always @ (posedge clk) begin
+      if (cyc < 8) begin
+         rb <= rb * 5;
+         $fwrite(fb, "b[%0d] %x\n", cyc, rb);
+         $fwrite(fb, "b[%0d] %b\n", cyc, rb[7:0]);
+      end
+      else if (cyc == 8) begin
+         $fwrite(fb, "b end\n");
+         $fclose(fb);
+      end
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 10) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -8,10 +8,12 @@ module t;
 
    reg [5:0] assoc_bad_key[real];
    real assoc_bad_value[int];
+   reg [5:0] assoc_raw[int];
 
    initial begin
       $readmemb("not", assoc_bad_key);
       $readmemb("not", assoc_bad_value);
+      $readmemraw("not", assoc_raw);
       $write("*-* All Finished *-*\n");
       $finish;
    end
@@ -0,0 +1,26 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t;
+
+   reg [31:0] hex [7:0];
+
+   integer   i;
+
+   initial begin
+      for (i = 0; i < 8; i = i + 1) hex[i] = 32'h0;
+      // File's final value has no trailing newline
+      $readmemh("t/t_sys_readmem_eof.mem", hex);
+      if (hex[0] !== 32'h10) $stop;
+      if (hex[1] !== 32'h11) $stop;
+      if (hex[2] !== 32'h0) $stop;
+      if (hex[4] !== 32'hdeadbeef) $stop;
+      if (hex[5] !== 32'hc0decafe) $stop;
+      if (hex[6] !== 32'h12345678) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
@@ -0,0 +1,65 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+`define STRINGIFY(x) `"x`"
+`define checkh(gotv,expv) do if ((gotv) !== (expv)) begin $write("%%Error: %s:%0d:  got='h%x exp='h%x\n", `__FILE__,`__LINE__, (gotv), (expv)); $stop; end while(0);
+
+module t;
+
+   reg [7:0]  rom8 [0:15];
+   reg [7:0]  got8 [0:15];
+   reg [11:0] rom12 [2:5];
+   reg [11:0] got12 [2:5];
+   reg [69:0] rom70 [0:3];
+   reg [69:0] got70 [0:3];
+
+   integer    i;
+   integer    fd;
+
+   initial begin
+      for (i = 0; i < 16; i = i + 1) begin
+         rom8[i] = 8'h10 + i[7:0];
+         got8[i] = 8'h0;
+      end
+      for (i = 2; i <= 5; i = i + 1) begin
+         rom12[i] = 12'habc + i[11:0];
+         got12[i] = 12'h0;
+      end
+      for (i = 0; i < 4; i = i + 1) begin
+         rom70[i] = {i[5:0], 64'hfedcba98_76543210};
+         got70[i] = 70'h0;
+      end
+
+      $writememraw({`STRINGIFY(`TEST_OBJ_DIR),"/rom8.bin"}, rom8);
+      $writememraw({`STRINGIFY(`TEST_OBJ_DIR),"/rom12.bin"}, rom12);
+      $writememraw({`STRINGIFY(`TEST_OBJ_DIR),"/rom70.bin"}, rom70);
+
+      // Rows are little endian, rounded up to whole bytes
+      fd = $fopen({`STRINGIFY(`TEST_OBJ_DIR),"/rom12.bin"}, "r");
+      `checkh($fgetc(fd), 'hbc + 2);
+      `checkh($fgetc(fd), 'h0a);
+      `checkh($fgetc(fd), 'hbc + 3);
+      $fclose(fd);
+
+      $readmemraw({`STRINGIFY(`TEST_OBJ_DIR),"/rom8.bin"}, got8);
+      for (i = 0; i < 16; i = i + 1) `checkh(got8[i], rom8[i]);
+      $readmemraw({`STRINGIFY(`TEST_OBJ_DIR),"/rom12.bin"}, got12);
+      for (i = 2; i <= 5; i = i + 1) `checkh(got12[i], rom12[i]);
+      $readmemraw({`STRINGIFY(`TEST_OBJ_DIR),"/rom70.bin"}, got70);
+      for (i = 0; i < 4; i = i + 1) `checkh(got70[i], rom70[i]);
+
+      // Start and finish addresses
+      for (i = 0; i < 16; i = i + 1) got8[i] = 8'h0;
+      $readmemraw({`STRINGIFY(`TEST_OBJ_DIR),"/rom8.bin"}, got8, 4, 5);
+      `checkh(got8[3], 8'h0);
+      `checkh(got8[4], 8'h10);
+      `checkh(got8[5], 8'h11);
+      `checkh(got8[6], 8'h0);
+
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
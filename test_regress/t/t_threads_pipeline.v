@@ -0,0 +1,61 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+
+   // Two copies of the same state machine.  Their next-state logic only
+   // feeds their flops, so may still run after eval() returns.
+   reg [63:0] state_a = 64'h1234_5678_9abc_def0;
+   reg [63:0] state_b = 64'h1234_5678_9abc_def0;
+   wire [63:0] next_a;
+   wire [63:0] next_b;
+
+   t_next next_a_i (.in(state_a), .out(next_a));
+   t_next next_b_i (.in(state_b), .out(next_b));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      state_a <= next_a;
+      state_b <= next_b;
+      if (next_a != next_b) $stop;
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc=%0d state=%x\n", $time, cyc, state_a);
+`endif
+      if (cyc == 99) begin
+         if (state_a == 64'h1234_5678_9abc_def0) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
+
+module t_next (/*AUTOARG*/
+   // Outputs
+   out,
+   // Inputs
+   in
+   );
+   input [63:0] in;
+   output [63:0] out;
+
+   reg [63:0] mix [0:8];
+   integer    i;
+
+   always @* begin
+      mix[0] = in;
+      for (i = 0; i < 8; i = i + 1) begin
+         mix[i+1] = {mix[i][50:0], mix[i][63:51]} ^ (mix[i] * 64'h9e37_79b9_7f4a_7c15)
+                    ^ {32'h0, mix[i][63:32] + mix[i][31:0]};
+      end
+   end
+   assign out = mix[8];
+endmodule
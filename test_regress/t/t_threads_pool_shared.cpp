@@ -0,0 +1,57 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test driver/expect definition
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+#include <verilated.h>
+#include <verilated_threads.h>
+#include <cstdio>
+#include <thread>
+#include "Vt_threads_pool_shared.h"
+
+double sc_time_stamp() { return 0; }
+
+static const int CYCLES = 100;
+static const int MODELS = 4;
+
+static vluint32_t s_sums[MODELS];
+
+static void runModel(int index) {
+    // Construct on the thread that calls eval()
+    Vt_threads_pool_shared* topp = new Vt_threads_pool_shared;
+    topp->clk = 0;
+    topp->eval();
+    for (int i = 0; i < CYCLES; ++i) {
+        topp->clk = 1;
+        topp->eval();
+        topp->clk = 0;
+        topp->eval();
+    }
+    if (topp->cnt != CYCLES) {
+        vl_fatal(__FILE__, __LINE__, "", "Model did not count every cycle");
+    }
+    s_sums[index] = topp->sum;
+    delete topp;
+}
+
+int main(int argc, char** argv, char** env) {
+    // One worker thread serves all the models, Verilated with --threads 2
+    VlThreadPool pool(1, false);
+    VlThreadPool::modelPoolp(&pool);
+
+    std::thread threads[MODELS];
+    for (int i = 0; i < MODELS; ++i) threads[i] = std::thread(runModel, i);
+    for (int i = 0; i < MODELS; ++i) threads[i].join();
+    VlThreadPool::modelPoolp(NULL);
+
+    for (int i = 1; i < MODELS; ++i) {
+        if (s_sums[i] != s_sums[0]) vl_fatal(__FILE__, __LINE__, "", "Models diverged");
+    }
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,28 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   cnt, sum,
+   // Inputs
+   clk
+   );
+   input clk;
+   output reg [31:0] cnt = 0;
+   output reg [31:0] sum = 0;
+
+   reg [31:0] a = 0;
+   reg [31:0] b = 0;
+
+   // Independent logic, so there are mtasks for more than one thread
+   always @(posedge clk) begin
+      cnt <= cnt + 1;
+      a <= a + cnt * 3;
+   end
+   always @(posedge clk) begin
+      b <= b ^ (cnt << 1);
+      sum <= a + b;
+   end
+endmodule
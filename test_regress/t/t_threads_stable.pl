@@ -0,0 +1,34 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vltmt => 1);
+
+top_filename("t/t_threads_counter.v");
+
+compile(
+    verilator_flags2 => ['--cc --threads 2 --threads-stable --stats'],
+    );
+
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__partition.txt", qr/critical path cost \d+/);
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__partition.txt", qr/mtask hash [0-9a-f]+ cost \d+/);
+
+# Rebuilding the same design must reproduce every mtask
+compile(
+    verilator_flags2 => ['--cc --threads 2 --threads-stable --stats'],
+    );
+
+file_grep($Self->{stats}, qr/MTask graph, previous build, mtasks changed\s+0/i);
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,36 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+
+   // Independent lanes, so each is its own mtask, and each lane's
+   // variables have their own footprint
+   genvar i;
+   generate
+      for (i = 0; i < 1024; i = i + 1) begin : lane
+         reg [31:0] r = i;
+         always @ (posedge clk) r <= (r * 32'h9e37_79b1) ^ (r >> 7) ^ i;
+      end
+   endgenerate
+
+   reg [31:0] expect5 = 5;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      expect5 <= (expect5 * 32'h9e37_79b1) ^ (expect5 >> 7) ^ 5;
+      if (lane[5].r != expect5) $stop;
+      if (cyc == 20) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,41 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc = 0;
+   reg [63:0] src = 64'h1;
+   wire [63:0] sum;
+
+   always @ (posedge clk) src <= {src[62:0], src[63] ^ src[60]};
+
+   // Independent state, each written by its own logic
+   genvar n;
+   generate
+      for (n = 0; n < 16; n = n + 1) begin : lane
+         reg [63:0] v = 64'h0;
+         always @ (posedge clk) v <= (v ^ (src * (n * 2 + 1))) + n;
+      end
+   endgenerate
+
+   assign sum = lane[0].v ^ lane[1].v ^ lane[2].v ^ lane[3].v
+                ^ lane[4].v ^ lane[5].v ^ lane[6].v ^ lane[7].v
+                ^ lane[8].v ^ lane[9].v ^ lane[10].v ^ lane[11].v
+                ^ lane[12].v ^ lane[13].v ^ lane[14].v ^ lane[15].v;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 99) begin
+         $write("sum=%x\n", sum);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
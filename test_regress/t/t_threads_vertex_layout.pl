@@ -0,0 +1,89 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+use IO::File;
+use strict;
+use vars qw($Self);
+
+# Wide fan-out design, for --threads-vertex-layout.  To compare layouts:
+#   VERILATOR_TEST_VERTEX_LAYOUT=compact t/t_threads_vertex_layout.pl --benchmark
+#   VERILATOR_TEST_VERTEX_LAYOUT=padded t/t_threads_vertex_layout.pl --benchmark
+#   VERILATOR_TEST_VERTEX_LAYOUT=grouped t/t_threads_vertex_layout.pl --benchmark
+scenarios(vltmt => 1);
+
+my $layout = $ENV{VERILATOR_TEST_VERTEX_LAYOUT} || "padded";
+my $fanout = 64;
+
+$Self->{cycles} = ($Self->{benchmark} ? 1_000_000 : 100);
+$Self->{sim_time} = $Self->{cycles} * 10 + 1000;
+
+sub gen {
+    my $filename = shift;
+
+    my $fh = IO::File->new(">$filename");
+    $fh->print("// Generated by t_threads_vertex_layout.pl\n");
+    $fh->print("module t (clk);\n");
+    $fh->print("  input clk;\n");
+    $fh->print("\n");
+    $fh->print("  integer cyc = 0;\n");
+    $fh->print("  reg [63:0] src = 64'h1;\n");
+    for (my $n=0; $n<$fanout; $n++) {
+        $fh->print("  reg [63:0] v${n} = 0;\n");
+    }
+    $fh->print("  reg [63:0] sum = 0;\n");
+
+    # One source fanning out to independent logic, then back in
+    $fh->print("\n");
+    $fh->print("  always @ (posedge clk) src <= {src[62:0], src[63] ^ src[60]};\n");
+    for (my $n=0; $n<$fanout; $n++) {
+        $fh->print("  always @ (posedge clk) v${n} <= (v${n} ^ (src * 64'd".($n*2+1)."))"
+                   ." + 64'd${n};\n");
+    }
+    $fh->print("  always @ (posedge clk) sum <= 64'd0");
+    for (my $n=0; $n<$fanout; $n++) {
+        $fh->print(" ^ v${n}");
+    }
+    $fh->print(";\n");
+
+    $fh->print("\n");
+    $fh->print("  always @ (posedge clk) begin\n");
+    $fh->print("    cyc <= cyc + 1;\n");
+    $fh->print("`ifndef SIM_CYCLES\n");
+    $fh->print(" `define SIM_CYCLES 99\n");
+    $fh->print("`endif\n");
+    $fh->print("    if (cyc == `SIM_CYCLES) begin\n");
+    $fh->print("      \$write(\"FANOUT=${fanout} sum=%x\\n\", sum);\n");
+    $fh->print('      $write("*-* All Finished *-*\n");',"\n");
+    $fh->print('      $finish;',"\n");
+    $fh->print("    end\n");
+    $fh->print("  end\n");
+    $fh->print("endmodule\n");
+}
+
+top_filename("$Self->{obj_dir}/t_threads_vertex_layout.v");
+
+gen($Self->{top_filename});
+
+compile(
+    v_flags2 => ["+define+SIM_CYCLES=$Self->{cycles}",],
+    verilator_flags2 => ["--threads-vertex-layout $layout --threads 4",
+                         "-Wno-UNOPTTHREADS"],
+    );
+
+if ($layout ne "compact") {
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.h",
+              qr/VlMTaskVertex __Vm_mt_\d+ VL_ATTR_ALIGNED\(VL_CACHE_LINE_BYTES\);/);
+}
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
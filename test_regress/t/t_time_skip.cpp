@@ -0,0 +1,84 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test driver/expect definition
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+#include <verilated.h>
+#include <verilated_vpi.h>
+#include <cstdio>
+#include "Vt_time_skip.h"
+
+static vluint64_t main_time = 0;
+double sc_time_stamp() { return main_time; }
+
+static int s_vpiCalls = 0;
+
+static PLI_INT32 afterDelayCb(p_cb_data) {
+    ++s_vpiCalls;
+    return 0;
+}
+
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) { \
+        printf("%%Error: %s:%d: GOT = %llu  EXP = %llu\n", __FILE__, __LINE__, \
+               static_cast<unsigned long long>(got), static_cast<unsigned long long>(exp)); \
+        return 10; \
+    }
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Vt_time_skip* topp = new Vt_time_skip;
+    topp->clk = 0;
+    topp->stop = 0;
+    topp->eval();
+
+    // Nothing is waiting
+    CHECK_RESULT(topp->nextTimeSlot(), ~VL_ULL(0));
+
+    Verilated::timeEventAdd(1000);
+    Verilated::timeEventAdd(400);
+    s_cb_data cb;
+    s_vpi_time t;
+    t.type = vpiSimTime;
+    t.high = 0;
+    t.low = 700;
+    cb.reason = cbAfterDelay;
+    cb.cb_rtn = afterDelayCb;
+    cb.obj = NULL;
+    cb.time = &t;
+    cb.value = NULL;
+    cb.user_data = NULL;
+    vpi_register_cb(&cb);
+
+    // Run up to the first interesting time in one call
+    CHECK_RESULT(topp->nextTimeSlot(), 400);
+    CHECK_RESULT(topp->evalCycles(topp->clk, 40, 5, &main_time), 40);
+    CHECK_RESULT(main_time, 400);
+    CHECK_RESULT(topp->count, 40);
+
+    // Skip the idle time to the VPI callback, then the last event
+    CHECK_RESULT(topp->nextTimeSlot(), 700);
+    main_time = topp->nextTimeSlot();
+    VerilatedVpi::callTimedCbs();
+    CHECK_RESULT(s_vpiCalls, 1);
+    CHECK_RESULT(topp->nextTimeSlot(), 1000);
+    main_time = topp->nextTimeSlot();
+    CHECK_RESULT(topp->nextTimeSlot(), ~VL_ULL(0));
+
+    // Stops at the edge with $finish
+    topp->stop = 1;
+    CHECK_RESULT(topp->evalCycles(topp->clk, 100, 5, &main_time), 1);
+    CHECK_RESULT(main_time, 1005);
+    CHECK_RESULT(topp->count, 41);
+    CHECK_RESULT(Verilated::gotFinish(), true);
+
+    topp->final();
+    delete topp;
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
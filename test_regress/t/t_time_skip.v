@@ -0,0 +1,20 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Outputs
+   count,
+   // Inputs
+   clk, stop
+   );
+   input clk;
+   input stop;
+   output reg [31:0] count = 0;
+
+   always @(posedge clk) begin
+      count <= count + 1;
+      if (stop) $finish;
+   end
+endmodule
@@ -0,0 +1,29 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_trace_complex.v");
+$Self->{golden_filename} = "t/t_trace_complex.out";
+
+compile(
+    verilator_flags2 => ['--cc --trace --trace-activity-granularity 2 --stats']
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+file_grep($Self->{stats}, qr/Tracing, Activity groups\s+\d+/i);
+
+vcd_identical ("$Self->{obj_dir}/simx.vcd", $Self->{golden_filename});
+
+ok(1);
+1;
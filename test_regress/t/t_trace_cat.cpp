@@ -29,6 +29,9 @@ int main(int argc, char** argv, char** env) {
     VerilatedVcdC* tfp = new VerilatedVcdC;
     top->trace(tfp, 99);
 
+#if defined(T_TRACE_CAT_COMPRESS)
+    tfp->rolloverCompress("gzip");
+#endif
     tfp->open(trace_name());
 
     top->clk = 0;
@@ -38,7 +41,7 @@ int main(int argc, char** argv, char** env) {
         top->eval();
 
         if ((main_time % 100) == 0) {
-#if defined(T_TRACE_CAT)
+#if defined(T_TRACE_CAT) || defined(T_TRACE_CAT_COMPRESS)
             tfp->openNext(true);
 #elif defined(T_TRACE_CAT_REOPEN)
             tfp->close();
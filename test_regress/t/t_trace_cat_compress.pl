@@ -0,0 +1,43 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_trace_cat.v");
+
+if (system("gzip --version >/dev/null 2>&1") != 0) {
+    skip("No gzip installed");
+} else {
+    compile(
+        make_top_shell => 0,
+        make_main => 0,
+        v_flags2 => ["--trace --exe $Self->{t_dir}/t_trace_cat.cpp"],
+        );
+
+    execute(
+        check_finished => 1,
+        );
+
+    # Each closed file was compressed, so none are left uncompressed
+    my @left = glob("$Self->{obj_dir}/simpart_*.vcd");
+    error("Uncompressed files left: @left") if @left;
+
+    system("gzip -dc $Self->{obj_dir}/simpart_0000.vcd.gz"
+           ." $Self->{obj_dir}/simpart_0000_cat*.vcd.gz > $Self->{obj_dir}/simall.vcd");
+
+    vcd_identical("$Self->{obj_dir}/simall.vcd",
+                  "t/t_trace_cat.out");
+
+    file_grep("$Self->{obj_dir}/simpart_0000.vcd.idx",
+              qr/^\S*simpart_0000_cat0000.vcd 0 99\n\S*simpart_0000_cat0001.vcd 100 189\n$/);
+}
+
+ok(1);
+1;
@@ -0,0 +1,36 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003-2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_trace_complex.v");
+$Self->{golden_filename} = "t/t_trace_complex.out";
+
+compile(
+    verilator_flags2 => ['--cc --trace-vbt']
+    );
+
+execute(
+    check_finished => 1,
+    );
+
+run(cmd => ["c++ -I$ENV{VERILATOR_ROOT}/include"
+            ." $ENV{VERILATOR_ROOT}/include/verilated_vbt_convert.cpp"
+            ." $ENV{VERILATOR_ROOT}/include/verilated_vbt_reader.cpp"
+            ." -lz -o $Self->{obj_dir}/vbt_convert"],
+    check_finished => 0);
+
+run(cmd => ["$Self->{obj_dir}/vbt_convert $Self->{obj_dir}/simx.vbt $Self->{obj_dir}/simx.vcd"],
+    check_finished => 0);
+
+vcd_identical ("$Self->{obj_dir}/simx.vcd", $Self->{golden_filename});
+
+ok(1);
+1;
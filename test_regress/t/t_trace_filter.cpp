@@ -0,0 +1,43 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+
+#include VM_PREFIX_INCLUDE
+
+unsigned long long main_time = 0;
+double sc_time_stamp() { return (double)main_time; }
+
+int main(int argc, char** argv, char** env) {
+    VM_PREFIX* top = new VM_PREFIX("top");
+
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    VerilatedVcdC* tfp = new VerilatedVcdC;
+    top->trace(tfp, 99);
+
+    // Trace only the narrow signals under t
+    tfp->filterGlob("top.t.*");
+    tfp->filterMaxWidth(8);
+    tfp->open(VL_STRINGIFY(TEST_OBJ_DIR) "/simx.vcd");
+
+    top->clk = 0;
+
+    while (main_time < 100) {
+        top->clk = !top->clk;
+        top->eval();
+        tfp->dump((unsigned int)(main_time));
+        ++main_time;
+    }
+    tfp->close();
+    top->final();
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,57 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+
+#include <ctime>
+
+#include VM_PREFIX_INCLUDE
+
+unsigned long long main_time = 0;
+double sc_time_stamp() { return (double)main_time; }
+
+// Count the bytes written
+class CountingFile : public VerilatedVcdFile {
+public:
+    vluint64_t m_bytes;
+    CountingFile()
+        : m_bytes(0) {}
+    virtual ssize_t write(const char* bufp, ssize_t len) {
+        ssize_t got = VerilatedVcdFile::write(bufp, len);
+        if (got > 0) m_bytes += got;
+        return got;
+    }
+};
+
+int main(int argc, char** argv, char** env) {
+    VM_PREFIX* top = new VM_PREFIX("top");
+
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    CountingFile file;
+    VerilatedVcdC* tfp = new VerilatedVcdC(&file);
+    top->trace(tfp, 99);
+    tfp->open(VL_STRINGIFY(TEST_OBJ_DIR) "/simx.vcd");
+
+    top->clk = 0;
+
+    const std::clock_t start = std::clock();
+    while (!Verilated::gotFinish()) {
+        top->clk = !top->clk;
+        top->eval();
+        tfp->dump((unsigned int)(main_time));
+        ++main_time;
+    }
+    tfp->close();
+    const double secs = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    printf("VCD bytes/s: %.0f\n", secs > 0 ? file.m_bytes / secs : 0.0);
+    top->final();
+    return 0;
+}
@@ -0,0 +1,83 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2003 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+use IO::File;
+use strict;
+use vars qw($Self);
+
+# Signals of many widths changing every cycle, reporting VCD bytes/second.
+# To compare VCD formatting between trees, run in each:
+#   t/t_trace_vcd_bench.pl --benchmark
+# and to measure the formatting used without vector instructions:
+#   VERILATOR_TEST_NO_INTRINSICS=1 t/t_trace_vcd_bench.pl --benchmark
+scenarios(vlt_all => 1);
+
+my @widths = (1, 5, 8, 13, 16, 31, 32, 47, 64, 100, 128, 255);
+my $copies = 8;
+
+$Self->{cycles} = ($Self->{benchmark} ? 200_000 : 100);
+
+sub gen {
+    my $filename = shift;
+
+    my $fh = IO::File->new(">$filename");
+    $fh->print("// Generated by t_trace_vcd_bench.pl\n");
+    $fh->print("module t (clk);\n");
+    $fh->print("  input clk;\n");
+    $fh->print("\n");
+    $fh->print("  integer cyc = 0;\n");
+    $fh->print("  reg [63:0] lfsr = 64'h1;\n");
+    foreach my $w (@widths) {
+        for (my $n=0; $n<$copies; $n++) {
+            $fh->print("  reg [".($w-1).":0] v${w}_${n} = 0;\n");
+        }
+    }
+
+    $fh->print("\n");
+    $fh->print("  always @ (posedge clk) begin\n");
+    $fh->print("    lfsr <= {lfsr[62:0], lfsr[63] ^ lfsr[62] ^ lfsr[60] ^ lfsr[59]};\n");
+    foreach my $w (@widths) {
+        for (my $n=0; $n<$copies; $n++) {
+            my $reps = int(($w + 63) / 64);
+            $fh->print("    v${w}_${n} <= ${w}'({${reps}{lfsr ^ 64'd".($n*7919)."}});\n");
+        }
+    }
+    $fh->print("    cyc <= cyc + 1;\n");
+    $fh->print("`ifndef SIM_CYCLES\n");
+    $fh->print(" `define SIM_CYCLES 99\n");
+    $fh->print("`endif\n");
+    $fh->print("    if (cyc == `SIM_CYCLES) begin\n");
+    $fh->print('      $write("*-* All Finished *-*\n");',"\n");
+    $fh->print('      $finish;',"\n");
+    $fh->print("    end\n");
+    $fh->print("  end\n");
+    $fh->print("endmodule\n");
+}
+
+top_filename("$Self->{obj_dir}/t_trace_vcd_bench.v");
+
+gen($Self->{top_filename});
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["+define+SIM_CYCLES=$Self->{cycles}",
+                 "--trace --exe $Self->{t_dir}/$Self->{name}.cpp",
+                 ($ENV{VERILATOR_TEST_NO_INTRINSICS} ? "-CFLAGS -DVL_DISABLE_INTRINSICS" : "")],
+    );
+
+execute(
+    check_finished => 1,
+    expect => qr/VCD bytes\/s:/,
+    );
+
+file_grep("$Self->{obj_dir}/simx.vcd", qr/ v255_7 \[254:0\] /);
+
+ok(1);
+1;
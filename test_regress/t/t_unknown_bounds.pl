@@ -0,0 +1,28 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+compile(
+    verilator_flags2 => ["--x-initial fast --stats"],
+    );
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/Unknowns, bound checks proven by if guards\s+(\d+)/i, 2);
+    # Only the initial loop's write, whose index is a loop variable, is kept
+    file_grep($Self->{stats}, qr/Unknowns, bound checks kept\s+(\d+)/i, 1);
+}
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
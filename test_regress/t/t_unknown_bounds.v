@@ -0,0 +1,41 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [7:0] mem [0:9];
+   reg [3:0] idx = 0;
+   reg [7:0] sum = 0;
+   reg [7:0] data;
+
+   // Bounded through the wire's only assignment
+   wire [3:0] half = {1'b0, idx[3:1]};
+
+   initial begin
+      for (int i = 0; i < 10; i = i + 1) mem[i] = i[7:0] + 8'd1;
+   end
+
+   always @* begin
+      data = 0;
+      // Bounded by the guard
+      if (idx < 10) data = mem[idx];
+   end
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      idx <= idx + 1;
+      sum <= sum + data + (idx <= 9 ? mem[idx] : 8'd0) + mem[half];
+      if (cyc == 20) begin
+         if (sum != 8'd208) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -12,11 +12,19 @@ scenarios(simulator => 1);
 
 compile(
     v_flags2 => ['+define+ALLOW_UNOPT'],
+    verilator_flags2 => ["--stats"],
     );
 
 execute(
     check_finished => 1,
     );
 
+if ($Self->{vlt_all}) {
+    # The loop's signals need change detection, so eval repeats until settled
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__stats.txt",
+              qr/Scheduling, change detect variables\s+[1-9]/);
+    file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/_change_request\(vlSymsp\)/);
+}
+
 ok(1);
 1;
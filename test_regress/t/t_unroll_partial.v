@@ -0,0 +1,49 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [7:0] mem [0:255];
+   reg [31:0] sum;
+   integer    i;
+
+   // 256 iterations is beyond the default --unroll-count, so these loops stay,
+   // but with several copies of their small bodies per trip
+   always @* begin
+      for (i = 0; i < 256; i = i + 1) begin
+         mem[i] = 8'(i * cyc);
+      end
+      sum = 0;
+      for (i = 0; i < 256; i = i + 1) begin
+         sum = sum + {24'h0, mem[i]};
+      end
+   end
+
+   reg [31:0] expect_sum;
+   integer    j;
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc > 1) begin
+         expect_sum = 0;
+         for (j = 0; j < 251; j = j + 1) begin  // Prime trip count, kept as is
+            expect_sum = expect_sum + {24'h0, 8'(j * cyc)};
+         end
+         for (j = 251; j < 256; j = j + 1) begin
+            expect_sum = expect_sum + {24'h0, 8'(j * cyc)};
+         end
+         if (sum != expect_sum) $stop;
+      end
+      if (cyc == 9) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,54 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc; initial cyc=1;
+
+   reg [7:0] x;
+   reg [7:0] y;
+   reg [7:0] z;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      // Set in a branch, then set again before any use
+      if (cyc == 3) begin
+         x = 8'h11;  // Dropped
+         if (cyc == 99) $display("Prevent ?: optimization a");
+      end
+      x = cyc[7:0] + 8'h1;
+      // Set in both branches, then set again before any use
+      if (cyc[0]) begin
+         y = 8'h22;  // Dropped
+         if (cyc == 99) $display("Prevent ?: optimization b");
+      end
+      else begin
+         y = 8'h33;  // Dropped
+         if (cyc == 99) $display("Prevent ?: optimization c");
+      end
+      y = x + 8'h2;
+      // Used after the branch
+      if (cyc == 5) begin
+         z = 8'h44;  // Not dropped
+         if (cyc == 99) $display("Prevent ?: optimization d");
+      end
+      if (cyc == 5 && z != 8'h44) $stop;
+      z = y;
+      if (cyc == 4) begin
+         if (x != 8'h05) $stop;
+         if (y != 8'h07) $stop;
+         if (z != 8'h07) $stop;
+      end
+      if (cyc == 9) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,149 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include "Vt_vpi_batch.h"
+#include "verilated.h"
+#include "verilated_vpi.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include "TestSimulator.h"
+#include "TestVpi.h"
+
+// __FILE__ is too long
+#define FILENM "t_vpi_batch.cpp"
+
+unsigned int main_time = 0;
+
+//======================================================================
+
+#define CHECK_RESULT_NZ(got) \
+    if (!(got)) { \
+        printf("%%Error: %s:%d: GOT = NULL  EXP = !NULL\n", FILENM, __LINE__); \
+        return __LINE__; \
+    }
+
+// Use cout to avoid issues with %d/%lx etc
+#define CHECK_RESULT_HEX(got, exp) \
+    if ((got) != (exp)) { \
+        cout << dec << "%Error: " << FILENM << ":" << __LINE__ << hex << ": GOT = " << (got) \
+             << "   EXP = " << (exp) << endl; \
+        return __LINE__; \
+    }
+
+static VerilatedVpiBatch s_batch;
+static int s_ia, s_ib, s_ic, s_id, s_ie, s_imem, s_iro, s_igo;
+
+static int addSignal(const char* name) {
+    TestVpiHandle h = VPI_HANDLE(name);
+    if (!h) return -1;
+    return s_batch.add(h);
+}
+
+int batch_setup() {
+    s_igo = addSignal("go");
+    s_ia = addSignal("a");
+    s_ib = addSignal("b");
+    s_ic = addSignal("c");
+    s_id = addSignal("d");
+    s_ie = addSignal("e");
+    s_iro = addSignal("ro");
+    {
+        TestVpiHandle mem_h = VPI_HANDLE("mem");
+        CHECK_RESULT_NZ(mem_h);
+        TestVpiHandle word_h = vpi_handle_by_index(mem_h, 2);
+        CHECK_RESULT_NZ(word_h);
+        s_imem = s_batch.add(word_h);
+        // A whole memory may not be added
+        CHECK_RESULT_HEX(s_batch.add(mem_h), -1);
+    }
+    CHECK_RESULT_HEX(s_batch.size(), 8);
+    CHECK_RESULT_HEX(s_imem, 7);
+    // Entries are aligned to their native size
+    CHECK_RESULT_HEX(s_batch.offset(s_ib) % sizeof(SData), 0);
+    CHECK_RESULT_HEX(s_batch.offset(s_ic) % sizeof(IData), 0);
+    CHECK_RESULT_HEX(s_batch.offset(s_id) % sizeof(QData), 0);
+    CHECK_RESULT_HEX(s_batch.offset(s_ie) % sizeof(QData), 0);
+    return 0;
+}
+
+int batch_put_get() {
+    vector<vluint8_t> buf(s_batch.bytes());
+    s_batch.get(&buf[0]);
+    CHECK_RESULT_HEX(static_cast<int>(buf[s_batch.offset(s_iro)]), 0x5a);
+
+    *reinterpret_cast<CData*>(&buf[s_batch.offset(s_igo)]) = 1;
+    *reinterpret_cast<CData*>(&buf[s_batch.offset(s_ia)]) = 0x12;
+    *reinterpret_cast<SData*>(&buf[s_batch.offset(s_ib)]) = 0x3456;
+    *reinterpret_cast<IData*>(&buf[s_batch.offset(s_ic)]) = 0x789abcde;
+    // Bits above the declared width are cleared on put
+    *reinterpret_cast<QData*>(&buf[s_batch.offset(s_id)]) = VL_ULL(0xffffff0101234567);
+    EData* ep = reinterpret_cast<EData*>(&buf[s_batch.offset(s_ie)]);
+    ep[0] = 0x89abcdef;
+    ep[1] = 0x01234567;
+    ep[2] = 0x89abcdef;
+    ep[3] = 0xffffffff;
+    *reinterpret_cast<CData*>(&buf[s_batch.offset(s_imem)]) = 0x77;
+    // Read-only signals are not written
+    *reinterpret_cast<CData*>(&buf[s_batch.offset(s_iro)]) = 0;
+    s_batch.put(&buf[0]);
+
+    vector<vluint8_t> back(s_batch.bytes());
+    s_batch.get(&back[0]);
+    CHECK_RESULT_HEX(*reinterpret_cast<QData*>(&back[s_batch.offset(s_id)]),
+                     VL_ULL(0x0000010101234567));
+    CHECK_RESULT_HEX(reinterpret_cast<EData*>(&back[s_batch.offset(s_ie)])[3], 0xf);
+    CHECK_RESULT_HEX(static_cast<int>(back[s_batch.offset(s_iro)]), 0x5a);
+    CHECK_RESULT_HEX(static_cast<int>(back[s_batch.offset(s_imem)]), 0x77);
+    return 0;
+}
+
+//======================================================================
+
+double sc_time_stamp() { return main_time; }
+int main(int argc, char** argv, char** env) {
+    double sim_time = 100;
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    // we're going to be checking for these errors do don't crash out
+    Verilated::fatalOnVpiError(0);
+
+    VM_PREFIX* topp = new VM_PREFIX("");  // Note null name - we're flattening it out
+
+    topp->eval();
+    topp->clk = 0;
+    main_time += 10;
+
+    if (int status = batch_setup()) {
+        vl_fatal(FILENM, status, "main", "%Error: batch_setup failed");
+    }
+    if (int status = batch_put_get()) {
+        vl_fatal(FILENM, status, "main", "%Error: batch_put_get failed");
+    }
+
+    while (sc_time_stamp() < sim_time && !Verilated::gotFinish()) {
+        main_time += 1;
+        topp->eval();
+        VerilatedVpi::callValueCbs();
+        topp->clk = !topp->clk;
+    }
+    if (!Verilated::gotFinish()) {
+        vl_fatal(FILENM, __LINE__, "main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+
+    VL_DO_DANGLING(delete topp, topp);
+    exit(0L);
+}
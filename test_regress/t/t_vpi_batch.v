@@ -0,0 +1,47 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2020 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+
+   reg         go       /*verilator public_flat_rw @(posedge clk) */;
+   reg [7:0]   a        /*verilator public_flat_rw @(posedge clk) */;
+   reg [15:0]  b        /*verilator public_flat_rw @(posedge clk) */;
+   reg [31:0]  c        /*verilator public_flat_rw @(posedge clk) */;
+   reg [40:0]  d        /*verilator public_flat_rw @(posedge clk) */;
+   reg [99:0]  e        /*verilator public_flat_rw @(posedge clk) */;
+   reg [7:0]   mem[3:0] /*verilator public_flat_rw @(posedge clk) */;
+   reg [7:0]   ro       /*verilator public_flat_rd */;
+
+   initial begin
+      go = 1'b0;
+      ro = 8'h5a;
+   end
+
+   always @(posedge clk) begin
+      if (go) begin
+`ifdef TEST_VERBOSE
+         $write("a=%x b=%x c=%x d=%x e=%x mem[2]=%x ro=%x\n", a, b, c, d, e, mem[2], ro);
+`endif
+         if (a !== 8'h12) $stop;
+         if (b !== 16'h3456) $stop;
+         if (c !== 32'h789abcde) $stop;
+         if (d !== 41'h1_01234567) $stop;
+         if (e !== 100'hf_89abcdef_01234567_89abcdef) $stop;
+         if (mem[2] !== 8'h77) $stop;
+         if (ro !== 8'h5a) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+
+endmodule : t
@@ -0,0 +1,34 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+top_filename("t/t_vpi_var.v");
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    make_pli => 1,
+    v_flags2 => ["+define+USE_VPI_NOT_DPI"],
+    verilator_flags2 => ["-CFLAGS '-DVL_DEBUG -ggdb' --exe --vpi --vpi-change-hooks --no-l2name"
+                         . " $Self->{t_dir}/t_vpi_var.cpp"],
+    );
+
+# public_flat_rw signals get written flags, public_flat_rd are always compared
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}__Syms.cpp", qr/varChangeFlag\(__Vfinal, "onebit"/);
+file_grep_not("$Self->{obj_dir}/$Self->{VM_PREFIX}__Syms.cpp", qr/varChangeFlag\(__Vfinal, "count"/);
+
+execute(
+    check_finished => 1,
+    all_run_flags => ['+PLUS +INT=1234 +STRSTR']
+    );
+
+ok(1);
+1;
@@ -0,0 +1,29 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+compile(
+    verilator_flags2 => ["--x-mode fast"],
+    );
+
+if ($Self->{vlt_all}) {
+    my $report = "$Self->{obj_dir}/$Self->{VM_PREFIX}__xbounds.txt";
+    file_grep($report, qr/t_x_mode_fast.v:26: ARRAYSEL index may exceed 5/);
+    my @kept = grep { !/^#/ } split /\n/, file_contents($report);
+    (scalar(@kept) == 1) or error("Expected one kept bound check, got: @kept");
+}
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,40 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2020 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [7:0] mem [0:5];
+   reg [3:0] idx;
+   reg [7:0] sum = 0;
+
+   initial begin
+      mem[0] = 0; mem[1] = 3; mem[2] = 6; mem[3] = 9; mem[4] = 12; mem[5] = 15;
+   end
+
+   // Proven in range, no bound checks
+   wire [7:0] masked = mem[idx & 4'h3];
+   wire [7:0] modded = mem[idx % 6];
+   wire       bit3 = sum[idx >> 1];
+   // Kept, idx may exceed 5
+   wire [7:0] unproven = mem[idx];
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      idx <= cyc[3:0];
+      if (cyc > 0) sum <= sum + masked + modded + {7'b0, bit3};
+      // Out of range reads are zero with --x-mode fast
+      if ((cyc == 3 || cyc == 9) && unproven != (idx < 6 ? idx * 3 : 0)) $stop;
+      if (cyc == 20) begin
+         if (sum != 8'd208) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
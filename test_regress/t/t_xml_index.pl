@@ -0,0 +1,41 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2020 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_xml_first.v");
+
+my $out_filename = "$Self->{obj_dir}/V$Self->{name}.xml";
+my $idx_filename = "$out_filename.idx";
+
+compile(
+    verilator_flags2 => ['--xml-only --xml-index'],
+    verilator_make_gmake => 0,
+    make_top_shell => 0,
+    make_main => 0,
+    );
+
+my $xml = file_contents($out_filename);
+my $mods = 0;
+foreach my $line (split /\n/, file_contents($idx_filename)) {
+    if ($line !~ /^\{"type": "module", "name": "(\w+)", .*"offset": (\d+), "length": (\d+)\}$/) {
+        error("Bad index line: $line");
+        next;
+    }
+    my ($name, $offset, $length) = ($1, $2, $3);
+    my $elem = substr($xml, $offset, $length);
+    $elem =~ /^\s*<module .*name="$name".*<\/module>\n$/s
+        or error("Index for $name does not point to its module element");
+    ++$mods;
+}
+$mods == 3 or error("Expected 3 modules in index, got $mods");
+
+ok(1);
+1;